@@ -111,11 +111,17 @@ void libmv_solveRefineIntrinsics(
 
   progress_update_callback(callback_customdata, 1.0, "Refining solution");
 
+  ReconstructUpdateCallback update_callback =
+    ReconstructUpdateCallback(progress_update_callback,
+                              callback_customdata);
+
   EuclideanBundleCommonIntrinsics(tracks,
                                   bundle_intrinsics,
                                   bundle_constraints,
                                   reconstruction,
-                                  intrinsics);
+                                  intrinsics,
+                                  NULL,
+                                  &update_callback);
 }
 
 void finishReconstruction(
@@ -365,7 +371,9 @@ libmv_Reconstruction *libmv_solveModal(
                                   libmv::BUNDLE_NO_INTRINSICS,
                                   libmv::BUNDLE_NO_TRANSLATION,
                                   &reconstruction,
-                                  &empty_intrinsics);
+                                  &empty_intrinsics,
+                                  NULL,
+                                  &update_callback);
 
   /* Refinement. */
   if (libmv_reconstruction_options->refine_intrinsics) {
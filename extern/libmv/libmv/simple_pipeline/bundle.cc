@@ -20,6 +20,8 @@
 
 #include "libmv/simple_pipeline/bundle.h"
 
+#include <algorithm>
+#include <cstdio>
 #include <map>
 
 #include "ceres/ceres.h"
@@ -29,6 +31,7 @@
 #include "libmv/multiview/fundamental.h"
 #include "libmv/multiview/projection.h"
 #include "libmv/numeric/numeric.h"
+#include "libmv/simple_pipeline/callbacks.h"
 #include "libmv/simple_pipeline/camera_intrinsics.h"
 #include "libmv/simple_pipeline/reconstruction.h"
 #include "libmv/simple_pipeline/tracks.h"
@@ -375,6 +378,34 @@ void EuclideanBundlerPerformEvaluation(const Tracks &tracks,
 //
 // At this point we only need to bundle points positions, cameras
 // are to be totally still here.
+// Forwards per-iteration statistics of the minimizer to the progress
+// callback, so long solves don't look stalled.
+class BundleIterationCallback : public ceres::IterationCallback {
+ public:
+  BundleIterationCallback(ProgressUpdateCallback *update_callback,
+                          int max_num_iterations)
+    : update_callback_(update_callback),
+      max_num_iterations_(max_num_iterations) {}
+
+  ceres::CallbackReturnType operator()(
+      const ceres::IterationSummary &summary) {
+    char message[256];
+    snprintf(message, sizeof(message),
+             "Bundling iteration %d, cost %g, %.1fs",
+             summary.iteration,
+             summary.cost,
+             summary.cumulative_time_in_seconds);
+    update_callback_->invoke(
+        std::min(1.0, (double) summary.iteration / max_num_iterations_),
+        message);
+    return ceres::SOLVER_CONTINUE;
+  }
+
+ private:
+  ProgressUpdateCallback *update_callback_;
+  int max_num_iterations_;
+};
+
 void EuclideanBundlePointsOnly(const DistortionModelType distortion_model,
                                const vector<Marker> &markers,
                                vector<Vec6> &all_cameras_R_t,
@@ -460,7 +491,8 @@ void EuclideanBundleCommonIntrinsics(
     const int bundle_constraints,
     EuclideanReconstruction *reconstruction,
     CameraIntrinsics *intrinsics,
-    BundleEvaluation *evaluation) {
+    BundleEvaluation *evaluation,
+    ProgressUpdateCallback *update_callback) {
   LG << "Original intrinsics: " << *intrinsics;
   vector<Marker> markers = tracks.AllMarkers();
 
@@ -603,6 +635,13 @@ void EuclideanBundleCommonIntrinsics(
   options.num_linear_solver_threads = omp_get_max_threads();
 #endif
 
+  BundleIterationCallback iteration_callback(update_callback,
+                                             options.max_num_iterations);
+  if (update_callback) {
+    options.callbacks.push_back(&iteration_callback);
+    options.update_state_every_iteration = false;
+  }
+
   // Solve!
   ceres::Solver::Summary summary;
   ceres::Solve(options, &problem, &summary);
@@ -27,6 +27,7 @@ namespace libmv {
 
 class CameraIntrinsics;
 class EuclideanReconstruction;
+class ProgressUpdateCallback;
 class ProjectiveReconstruction;
 class Tracks;
 
@@ -95,6 +96,9 @@ void EuclideanBundle(const Tracks &tracks,
     there, plus all the requested additional information (like jacobian) is
     also calculating there. Also see comments for BundleEvaluation.
 
+    If update_callback is not null, it is invoked after every iteration of
+    the minimizer with the iteration number, current cost and elapsed time.
+
     \note This assumes an outlier-free set of markers.
 
     \sa EuclideanResect, EuclideanIntersect, EuclideanReconstructTwoFrames
@@ -120,7 +124,8 @@ void EuclideanBundleCommonIntrinsics(
     const int bundle_constraints,
     EuclideanReconstruction *reconstruction,
     CameraIntrinsics *intrinsics,
-    BundleEvaluation *evaluation = NULL);
+    BundleEvaluation *evaluation = NULL,
+    ProgressUpdateCallback *update_callback = NULL);
 
 /*!
     Refine camera poses and 3D coordinates using bundle adjustment.
@@ -98,6 +98,10 @@ ATOMIC_INLINE unsigned atomic_add_u(unsigned *p, unsigned x);
 ATOMIC_INLINE unsigned atomic_sub_u(unsigned *p, unsigned x);
 ATOMIC_INLINE unsigned atomic_cas_u(unsigned *v, unsigned old, unsigned _new);
 
+ATOMIC_INLINE void *atomic_cas_ptr(void **v, void *old, void *_new);
+
+ATOMIC_INLINE float atomic_add_fl(float *p, const float x);
+
 /******************************************************************************/
 /* 64-bit operations. */
 #if (LG_SIZEOF_PTR == 3 || LG_SIZEOF_INT == 3)
@@ -465,4 +469,40 @@ atomic_cas_u(unsigned *v, unsigned old, unsigned _new)
 #endif
 }
 
+/******************************************************************************/
+/* pointer operations. */
+ATOMIC_INLINE void *
+atomic_cas_ptr(void **v, void *old, void *_new)
+{
+	assert(sizeof(void *) == 1 << LG_SIZEOF_PTR);
+
+#if (LG_SIZEOF_PTR == 3)
+	return (void *)atomic_cas_uint64((uint64_t *)v,
+	                                 (uint64_t)old,
+	                                 (uint64_t)_new);
+#elif (LG_SIZEOF_PTR == 2)
+	return (void *)atomic_cas_uint32((uint32_t *)v,
+	                                 (uint32_t)old,
+	                                 (uint32_t)_new);
+#endif
+}
+
+/******************************************************************************/
+/* float operations. */
+ATOMIC_INLINE float
+atomic_add_fl(float *p, const float x)
+{
+	union { float f; uint32_t u; } oldval, newval;
+
+	assert(sizeof(float) == sizeof(uint32_t));
+
+	/* collisions are unlikely, so the loop nearly always runs once */
+	do {
+		oldval.f = *p;
+		newval.f = oldval.f + x;
+	} while (atomic_cas_uint32((uint32_t *)p, oldval.u, newval.u) != oldval.u);
+
+	return newval.f;
+}
+
 #endif /* __ATOMIC_OPS_H__ */
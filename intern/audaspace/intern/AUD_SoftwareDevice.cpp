@@ -39,6 +39,12 @@
 #include <cmath>
 #include <limits>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
@@ -53,6 +59,12 @@ typedef enum
 
 #define AUD_PITCH_MAX 10
 
+/// Minimum count of playing sounds to read them in parallel.
+#define AUD_MIX_THREADED_MIN 4
+
+/// Maximum count of worker threads reading sounds.
+#define AUD_MIX_THREADS_MAX 16
+
 /******************************************************************************/
 /********************** AUD_SoftwareHandle Handle Code ************************/
 /******************************************************************************/
@@ -92,7 +104,7 @@ AUD_SoftwareDevice::AUD_SoftwareHandle::AUD_SoftwareHandle(AUD_SoftwareDevice* d
 	m_reader(reader), m_pitch(pitch), m_resampler(resampler), m_mapper(mapper), m_keep(keep), m_user_pitch(1.0f), m_user_volume(1.0f), m_user_pan(0.0f), m_volume(1.0f), m_loopcount(0),
 	m_relative(true), m_volume_max(1.0f), m_volume_min(0), m_distance_max(std::numeric_limits<float>::max()),
 	m_distance_reference(1.0f), m_attenuation(1.0f), m_cone_angle_outer(M_PI), m_cone_angle_inner(M_PI), m_cone_volume_outer(0),
-	m_flags(AUD_RENDER_CONE), m_stop(NULL), m_stop_data(NULL), m_status(AUD_STATUS_PLAYING), m_device(device)
+	m_flags(AUD_RENDER_CONE), m_stop(NULL), m_stop_data(NULL), m_status(AUD_STATUS_PLAYING), m_device(device), m_mix_length(0), m_mix_eos(false)
 {
 }
 
@@ -248,6 +260,39 @@ void AUD_SoftwareDevice::AUD_SoftwareHandle::update()
 		m_mapper->setMonoAngle(m_relative ? m_user_pan * M_PI / 2.0 : 0);
 }
 
+void AUD_SoftwareDevice::AUD_SoftwareHandle::read(int length)
+{
+	m_mix_buffer.assureSize(length * AUD_SAMPLE_SIZE(m_device->m_specs));
+
+	sample_t* buf = m_mix_buffer.getBuffer();
+	int pos = 0;
+	int len = length;
+	bool eos;
+
+	m_reader->read(len, eos, buf);
+
+	// in case of looping
+	while(pos + len < length && m_loopcount && eos)
+	{
+		pos += len;
+
+		if(m_loopcount > 0)
+			m_loopcount--;
+
+		m_reader->seek(0);
+
+		len = length - pos;
+		m_reader->read(len, eos, buf + pos * m_device->m_specs.channels);
+
+		// prevent endless loop
+		if(!len)
+			break;
+	}
+
+	m_mix_length = pos + len;
+	m_mix_eos = eos;
+}
+
 void AUD_SoftwareDevice::AUD_SoftwareHandle::setSpecs(AUD_Specs specs)
 {
 	m_mapper->setChannels(specs.channels);
@@ -718,6 +763,16 @@ void AUD_SoftwareDevice::create()
 	pthread_mutex_init(&m_mutex, &attr);
 
 	pthread_mutexattr_destroy(&attr);
+
+	m_mix_next = 0;
+	m_mix_pending = 0;
+	m_mix_length = 0;
+	m_mix_started = false;
+	m_mix_exit = false;
+
+	pthread_mutex_init(&m_mix_mutex, NULL);
+	pthread_cond_init(&m_mix_cond, NULL);
+	pthread_cond_init(&m_mix_done_cond, NULL);
 }
 
 void AUD_SoftwareDevice::destroy()
@@ -731,68 +786,154 @@ void AUD_SoftwareDevice::destroy()
 	while(!m_pausedSounds.empty())
 		m_pausedSounds.front()->stop();
 
+	stopMixThreads();
+
+	pthread_cond_destroy(&m_mix_done_cond);
+	pthread_cond_destroy(&m_mix_cond);
+	pthread_mutex_destroy(&m_mix_mutex);
+
 	pthread_mutex_destroy(&m_mutex);
 }
 
-void AUD_SoftwareDevice::mix(data_t* buffer, int length)
+void AUD_SoftwareDevice::startMixThreads()
+{
+	m_mix_started = true;
+
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	long processors = info.dwNumberOfProcessors;
+#else
+	long processors = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+	// the mixing thread reads sounds too
+	int count = AUD_MIN(processors - 1, AUD_MIX_THREADS_MAX);
+
+	for(int i = 0; i < count; i++)
+	{
+		pthread_t thread;
+
+		if(pthread_create(&thread, NULL, runMixThread, this))
+			break;
+
+		m_mix_threads.push_back(thread);
+	}
+}
+
+void AUD_SoftwareDevice::stopMixThreads()
 {
-	m_buffer.assureSize(length * AUD_SAMPLE_SIZE(m_specs));
+	if(m_mix_threads.empty())
+		return;
+
+	pthread_mutex_lock(&m_mix_mutex);
+	m_mix_exit = true;
+	pthread_cond_broadcast(&m_mix_cond);
+	pthread_mutex_unlock(&m_mix_mutex);
 
+	for(unsigned int i = 0; i < m_mix_threads.size(); i++)
+		pthread_join(m_mix_threads[i], NULL);
+
+	m_mix_threads.clear();
+}
+
+void AUD_SoftwareDevice::readMixSounds()
+{
+	while(m_mix_next < m_mix_sounds.size())
+	{
+		AUD_SoftwareHandle* sound = m_mix_sounds[m_mix_next++];
+
+		pthread_mutex_unlock(&m_mix_mutex);
+		sound->read(m_mix_length);
+		pthread_mutex_lock(&m_mix_mutex);
+
+		if(--m_mix_pending == 0)
+			pthread_cond_signal(&m_mix_done_cond);
+	}
+}
+
+void* AUD_SoftwareDevice::runMixThread(void* device)
+{
+	AUD_SoftwareDevice* dev = (AUD_SoftwareDevice*)device;
+
+	pthread_mutex_lock(&dev->m_mix_mutex);
+
+	while(!dev->m_mix_exit)
+	{
+		if(dev->m_mix_next < dev->m_mix_sounds.size())
+			dev->readMixSounds();
+		else
+			pthread_cond_wait(&dev->m_mix_cond, &dev->m_mix_mutex);
+	}
+
+	pthread_mutex_unlock(&dev->m_mix_mutex);
+
+	return NULL;
+}
+
+void AUD_SoftwareDevice::mix(data_t* buffer, int length)
+{
 	AUD_MutexLock lock(*this);
 
 	{
 		boost::shared_ptr<AUD_SoftwareDevice::AUD_SoftwareHandle> sound;
-		int len;
-		int pos;
-		bool eos;
 		std::list<boost::shared_ptr<AUD_SoftwareDevice::AUD_SoftwareHandle> > stopSounds;
 		std::list<boost::shared_ptr<AUD_SoftwareDevice::AUD_SoftwareHandle> > pauseSounds;
-		sample_t* buf = m_buffer.getBuffer();
 
 		m_mixer->clear(length);
 
-		// for all sounds
-		AUD_HandleIterator it = m_playingSounds.begin();
-		while(it != m_playingSounds.end())
-		{
-			sound = *it;
-			// increment the iterator to make sure it's valid,
-			// in case the sound gets deleted after stopping
-			++it;
+		// update 3D Info
+		for(AUD_HandleIterator it = m_playingSounds.begin(); it != m_playingSounds.end(); it++)
+			(*it)->update();
 
-			// get the buffer from the source
-			pos = 0;
-			len = length;
+		// get the buffers from the sources, in parallel for many sounds:
+		// each handle reads through its own reader chain into its own buffer
+		if(m_playingSounds.size() >= AUD_MIX_THREADED_MIN && !m_mix_started)
+			startMixThreads();
 
-			// update 3D Info
-			sound->update();
+		if(m_playingSounds.size() >= AUD_MIX_THREADED_MIN && !m_mix_threads.empty())
+		{
+			pthread_mutex_lock(&m_mix_mutex);
 
-			sound->m_reader->read(len, eos, buf);
+			m_mix_sounds.clear();
+			for(AUD_HandleIterator it = m_playingSounds.begin(); it != m_playingSounds.end(); it++)
+				m_mix_sounds.push_back(it->get());
 
-			// in case of looping
-			while(pos + len < length && sound->m_loopcount && eos)
-			{
-				m_mixer->mix(buf, pos, len, sound->m_volume);
+			m_mix_next = 0;
+			m_mix_pending = m_mix_sounds.size();
+			m_mix_length = length;
 
-				pos += len;
+			pthread_cond_broadcast(&m_mix_cond);
 
-				if(sound->m_loopcount > 0)
-					sound->m_loopcount--;
+			readMixSounds();
 
-				sound->m_reader->seek(0);
+			while(m_mix_pending)
+				pthread_cond_wait(&m_mix_done_cond, &m_mix_mutex);
 
-				len = length - pos;
-				sound->m_reader->read(len, eos, buf);
+			m_mix_sounds.clear();
+			m_mix_next = 0;
 
-				// prevent endless loop
-				if(!len)
-					break;
-			}
+			pthread_mutex_unlock(&m_mix_mutex);
+		}
+		else
+		{
+			for(AUD_HandleIterator it = m_playingSounds.begin(); it != m_playingSounds.end(); it++)
+				(*it)->read(length);
+		}
+
+		// for all sounds, mixing in a fixed order so the result doesn't depend on threading
+		AUD_HandleIterator it = m_playingSounds.begin();
+		while(it != m_playingSounds.end())
+		{
+			sound = *it;
+			// increment the iterator to make sure it's valid,
+			// in case the sound gets deleted after stopping
+			++it;
 
-			m_mixer->mix(buf, pos, len, sound->m_volume);
+			m_mixer->mix(sound->m_mix_buffer.getBuffer(), 0, sound->m_mix_length, sound->m_volume);
 
 			// in case the end of the sound is reached
-			if(eos && !sound->m_loopcount)
+			if(sound->m_mix_eos && !sound->m_loopcount)
 			{
 				if(sound->m_stop)
 					sound->m_stop(sound->m_stop_data);
@@ -41,6 +41,7 @@
 #include "AUD_ChannelMapperReader.h"
 
 #include <list>
+#include <vector>
 #include <pthread.h>
 
 /**
@@ -139,6 +140,15 @@ protected:
 		/// Own device.
 		AUD_SoftwareDevice* m_device;
 
+		/// The buffer the source is read into before mixing.
+		AUD_Buffer m_mix_buffer;
+
+		/// The length in samples that was read into the mix buffer.
+		int m_mix_length;
+
+		/// Whether the end of the source was reached while reading.
+		bool m_mix_eos;
+
 		bool pause(bool keep);
 
 	public:
@@ -159,6 +169,14 @@ protected:
 		 */
 		void update();
 
+		/**
+		 * Reads the next samples of the source into the mix buffer,
+		 * handling looping. Only touches the handle itself, so different
+		 * handles can be read in parallel.
+		 * \param length The length in samples to be read.
+		 */
+		void read(int length);
+
 		/**
 		 * Sets the audio output specification of the readers.
 		 * \param sepcs The output specification.
@@ -256,9 +274,75 @@ protected:
 
 private:
 	/**
-	 * The reading buffer.
+	 * The worker threads reading the playing sounds in parallel.
+	 */
+	std::vector<pthread_t> m_mix_threads;
+
+	/**
+	 * The sounds being read by the current mix.
+	 */
+	std::vector<AUD_SoftwareHandle*> m_mix_sounds;
+
+	/**
+	 * The index of the next sound of the current mix to read.
+	 */
+	unsigned int m_mix_next;
+
+	/**
+	 * The number of sounds of the current mix not read yet.
+	 */
+	unsigned int m_mix_pending;
+
+	/**
+	 * The length in samples of the current mix.
+	 */
+	int m_mix_length;
+
+	/**
+	 * Whether the worker threads were started, they are started on demand.
+	 */
+	bool m_mix_started;
+
+	/**
+	 * Whether the worker threads should exit.
+	 */
+	bool m_mix_exit;
+
+	/**
+	 * The mutex for the mix worker state.
+	 */
+	pthread_mutex_t m_mix_mutex;
+
+	/**
+	 * Signals the workers that there are sounds to read or that they should exit.
+	 */
+	pthread_cond_t m_mix_cond;
+
+	/**
+	 * Signals the mixing thread that all sounds are read.
+	 */
+	pthread_cond_t m_mix_done_cond;
+
+	/**
+	 * Reads the sounds of the current mix until none are left.
+	 * Expects m_mix_mutex to be locked.
+	 */
+	void readMixSounds();
+
+	/**
+	 * Starts the worker threads, if there are multiple processors.
+	 */
+	void startMixThreads();
+
+	/**
+	 * Stops and joins the worker threads.
+	 */
+	void stopMixThreads();
+
+	/**
+	 * The main function of the worker threads.
 	 */
-	AUD_Buffer m_buffer;
+	static void* runMixThread(void* device);
 
 	/**
 	 * The list of sounds that are currently playing.
@@ -26,6 +26,7 @@
 #include "util_args.h"
 #include "util_foreach.h"
 #include "util_function.h"
+#include "util_guarded_allocator.h"
 #include "util_logging.h"
 #include "util_path.h"
 #include "util_progress.h"
@@ -45,6 +46,8 @@ struct Options {
 	Session *session;
 	Scene *scene;
 	string filepath;
+	string benchmark_path;
+	double sync_time;
 	int width, height;
 	SceneParams scene_params;
 	SessionParams session_params;
@@ -119,11 +122,15 @@ static void session_init()
 
 static void scene_init()
 {
+	double sync_start_time = time_dt();
+
 	options.scene = new Scene(options.scene_params, options.session_params.device);
 
 	/* Read XML */
 	xml_read_file(options.scene, options.filepath.c_str());
 
+	options.sync_time = time_dt() - sync_start_time;
+
 	/* Camera width/height override? */
 	if(!(options.width == 0 || options.height == 0)) {
 		options.scene->camera->width = options.width;
@@ -138,6 +145,44 @@ static void scene_init()
 	options.scene->camera->compute_auto_viewplane();
 }
 
+/* Write timings of the finished render as JSON, so runs can be compared between builds. */
+static void session_write_benchmark()
+{
+	Session *session = options.session;
+	const TimingStats& timing = session->stats.timing;
+	const int samples = session->progress.get_sample();
+	double total_time, render_time;
+
+	session->progress.get_time(total_time, render_time);
+
+	FILE *f = fopen(options.benchmark_path.c_str(), "w");
+	if(!f) {
+		fprintf(stderr, "Failed to write benchmark report: %s\n", options.benchmark_path.c_str());
+		return;
+	}
+
+	fprintf(f, "{\n");
+	fprintf(f, "    \"scene\": \"%s\",\n", path_filename(options.filepath).c_str());
+	fprintf(f, "    \"device\": \"%s\",\n", Device::string_from_type(options.session_params.device.type).c_str());
+	fprintf(f, "    \"device_description\": \"%s\",\n", options.session_params.device.description.c_str());
+	fprintf(f, "    \"threads\": %d,\n", options.session_params.threads);
+	fprintf(f, "    \"width\": %d,\n", options.width);
+	fprintf(f, "    \"height\": %d,\n", options.height);
+	fprintf(f, "    \"samples\": %d,\n", samples);
+	fprintf(f, "    \"sync_time\": %f,\n", options.sync_time);
+	fprintf(f, "    \"scene_update_time\": %f,\n", timing.scene_update);
+	fprintf(f, "    \"bvh_build_time\": %f,\n", timing.bvh_build);
+	fprintf(f, "    \"device_upload_time\": %f,\n", max(timing.scene_update - timing.bvh_build, 0.0));
+	fprintf(f, "    \"path_trace_time\": %f,\n", timing.path_trace);
+	fprintf(f, "    \"time_per_sample\": %f,\n", (samples > 0)? timing.path_trace / samples: 0.0);
+	fprintf(f, "    \"render_time\": %f,\n", render_time);
+	fprintf(f, "    \"device_mem_peak\": %lu,\n", (unsigned long)session->stats.mem_peak);
+	fprintf(f, "    \"host_mem_peak\": %lu\n", (unsigned long)util_guarded_get_mem_peak());
+	fprintf(f, "}\n");
+
+	fclose(f);
+}
+
 static void session_exit()
 {
 	if(options.session) {
@@ -331,6 +376,8 @@ static void options_parse(int argc, const char **argv)
 	options.width = 0;
 	options.height = 0;
 	options.filepath = "";
+	options.benchmark_path = "";
+	options.sync_time = 0.0;
 	options.session = NULL;
 	options.quiet = false;
 
@@ -375,6 +422,10 @@ static void options_parse(int argc, const char **argv)
 		"--width  %d", &options.width, "Window width in pixel",
 		"--height %d", &options.height, "Window height in pixel",
 		"--list-devices", &list, "List information about all available devices",
+		"--benchmark %s", &options.benchmark_path, "Write timings and memory usage of the render as JSON to this file path",
+#ifdef WITH_CYCLES_DEBUG
+		"--profile", &options.session_params.use_profiling, "Print kernel ray and shader counters after rendering",
+#endif
 #ifdef WITH_CYCLES_LOGGING
 		"--debug", &debug, "Enable debug logging",
 		"--verbose %d", &verbosity, "Set verbosity of the logger",
@@ -483,6 +534,8 @@ int main(int argc, const char **argv)
 #endif
 		session_init();
 		options.session->wait();
+		if(options.benchmark_path != "")
+			session_write_benchmark();
 		session_exit();
 #ifdef WITH_CYCLES_STANDALONE_GUI
 	}
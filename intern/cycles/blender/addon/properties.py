@@ -21,7 +21,8 @@ from bpy.props import (BoolProperty,
                        EnumProperty,
                        FloatProperty,
                        IntProperty,
-                       PointerProperty)
+                       PointerProperty,
+                       StringProperty)
 
 # enums
 
@@ -51,6 +52,17 @@ enum_bvh_types = (
     ('STATIC_BVH', "Static BVH", "Any object modification requires a complete BVH rebuild, but renders faster"),
     )
 
+enum_texture_limit = (
+    ('OFF', "No Limit", "No texture size limit", 0),
+    ('128', "128", "Limit texture size to 128 pixels", 1),
+    ('256', "256", "Limit texture size to 256 pixels", 2),
+    ('512', "512", "Limit texture size to 512 pixels", 3),
+    ('1024', "1024", "Limit texture size to 1024 pixels", 4),
+    ('2048', "2048", "Limit texture size to 2048 pixels", 5),
+    ('4096', "4096", "Limit texture size to 4096 pixels", 6),
+    ('8192', "8192", "Limit texture size to 8192 pixels", 7),
+    )
+
 enum_filter_types = (
     ('BOX', "Box", "Box filter"),
     ('GAUSSIAN', "Gaussian", "Gaussian filter"),
@@ -266,6 +278,47 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
                 default=True,
                 )
 
+        cls.use_adaptive_sampling = BoolProperty(
+                name="Adaptive Sampling",
+                description="Stop sampling pixels once their estimated noise is below the threshold "
+                            "(final renders on the CPU only)",
+                default=False,
+                )
+        cls.adaptive_threshold = FloatProperty(
+                name="Adaptive Threshold",
+                description="Noise level at which a pixel is considered converged, "
+                            "lower values give less noise but render slower",
+                min=0.0001, max=1.0,
+                default=0.01,
+                precision=4,
+                )
+        cls.adaptive_min_samples = IntProperty(
+                name="Adaptive Min Samples",
+                description="Number of samples every pixel receives before adaptive sampling "
+                            "is allowed to stop it",
+                min=2, max=2097151,
+                default=32,
+                )
+
+        cls.use_light_tree = BoolProperty(
+                name="Light Tree",
+                description="Pick emissive triangles to sample based on their distance and orientation "
+                            "to the shading point, reduces noise in scenes with many mesh lights",
+                default=False,
+                )
+        cls.use_light_sample_learning = BoolProperty(
+                name="Learn Lamp Samples",
+                description="Redistribute lamp samples by their measured contribution after the first samples, "
+                            "keeping the total number of lamp samples (progressive renders on the CPU only)",
+                default=False,
+                )
+        cls.light_learning_samples = IntProperty(
+                name="Learning Samples",
+                description="Number of samples used to measure the contribution of lamps",
+                min=1, max=2097151,
+                default=4,
+                )
+
         cls.caustics_reflective = BoolProperty(
                 name="Reflective Caustics",
                 description="Use reflective caustics, resulting in a brighter image (more noise but added realism)",
@@ -464,6 +517,36 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
                 description="Use BVH spatial splits: longer builder time, faster render",
                 default=False,
                 )
+        cls.debug_use_bvh_cache = BoolProperty(
+                name="Cache BVH",
+                description="Store BVH in a disk cache and reuse it for final renders of unchanged geometry",
+                default=False,
+                )
+        cls.debug_bvh_cache_path = StringProperty(
+                name="BVH Cache Path",
+                description="Directory to store cached BVH files in, leave empty to use the user configuration directory",
+                subtype='DIR_PATH',
+                default="",
+                )
+        cls.debug_use_profiling = BoolProperty(
+                name="Profiling",
+                description="Count rays, BVH nodes, closures and shader nodes per shader and print them "
+                            "to the console after rendering (CPU only, debug builds)",
+                default=False,
+                )
+        cls.texture_limit = EnumProperty(
+                name="Texture Limit",
+                description="Limit the maximum texture size used by final renders, "
+                            "larger images are downscaled when loaded to save memory",
+                items=enum_texture_limit,
+                default='OFF',
+                )
+        cls.use_compact_textures = BoolProperty(
+                name="Compact Textures",
+                description="Store float images as half floats and grayscale images with a single channel, "
+                            "to reduce memory usage (CPU only)",
+                default=False,
+                )
         cls.tile_order = EnumProperty(
                 name="Tile Order",
                 description="Tile order for rendering",
@@ -896,6 +979,13 @@ class CyclesMeshSettings(bpy.types.PropertyGroup):
                 min=0.001, max=1000.0,
                 default=1.0,
                 )
+        cls.dicing_max_triangles = IntProperty(
+                name="Max Triangles",
+                description="Coarsen the dicing rate so the subdivided mesh stays below this number of triangles "
+                            "(0 for no limit)",
+                min=0, max=2147483647,
+                default=0,
+                )
 
     @classmethod
     def unregister(cls):
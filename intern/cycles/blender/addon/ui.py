@@ -176,6 +176,23 @@ class CyclesRender_PT_sampling(CyclesButtonsPanel, Panel):
         if use_cpu(context) or cscene.feature_set == 'EXPERIMENTAL':
             layout.row().prop(cscene, "sampling_pattern", text="Pattern")
 
+        layout.row().prop(cscene, "use_light_tree")
+
+        if use_cpu(context):
+            row = layout.row(align=True)
+            row.prop(cscene, "use_adaptive_sampling", text="Adaptive")
+            sub = row.row(align=True)
+            sub.active = cscene.use_adaptive_sampling
+            sub.prop(cscene, "adaptive_threshold", text="Threshold")
+            sub.prop(cscene, "adaptive_min_samples", text="Min Samples")
+
+        if use_cpu(context) and use_branched_path(context):
+            row = layout.row(align=True)
+            row.prop(cscene, "use_light_sample_learning", text="Learn Lamp Samples")
+            sub = row.row(align=True)
+            sub.active = cscene.use_light_sample_learning
+            sub.prop(cscene, "light_learning_samples", text="Samples")
+
         for rl in scene.render.layers:
             if rl.samples > 0:
                 layout.separator()
@@ -355,11 +372,22 @@ class CyclesRender_PT_performance(CyclesButtonsPanel, Panel):
 
         col.label(text="Final Render:")
         col.prop(rd, "use_persistent_data", text="Persistent Images")
+        col.prop(cscene, "texture_limit", text="Texture Limit")
+        col.prop(cscene, "use_compact_textures")
 
         col.separator()
 
         col.label(text="Acceleration structure:")
         col.prop(cscene, "debug_use_spatial_splits")
+        col.prop(cscene, "debug_use_bvh_cache")
+        sub = col.column()
+        sub.active = cscene.debug_use_bvh_cache
+        sub.prop(cscene, "debug_bvh_cache_path", text="")
+
+        # only functional with kernel debug, same as debug passes
+        if hasattr(rd, "debug_pass_type"):
+            col.separator()
+            col.prop(cscene, "debug_use_profiling")
 
 
 class CyclesRender_PT_layer_options(CyclesButtonsPanel, Panel):
@@ -660,6 +688,7 @@ class Cycles_PT_mesh_displacement(CyclesButtonsPanel, Panel):
         layout.prop(cdata, "displacement_method", text="Method")
         layout.prop(cdata, "use_subdivision")
         layout.prop(cdata, "dicing_rate")
+        layout.prop(cdata, "dicing_max_triangles")
 
 
 class CyclesObject_PT_motion_blur(CyclesButtonsPanel, Panel):
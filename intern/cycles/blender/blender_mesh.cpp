@@ -18,6 +18,7 @@
 #include "mesh.h"
 #include "object.h"
 #include "scene.h"
+#include "vertex_cache.h"
 
 #include "blender_sync.h"
 #include "blender_session.h"
@@ -585,6 +586,7 @@ static void create_subd_mesh(Scene *scene, Mesh *mesh, BL::Mesh b_mesh, PointerR
 
 	SubdParams sdparams(mesh, used_shaders[0], true, need_ptex);
 	sdparams.dicing_rate = RNA_float_get(cmesh, "dicing_rate");
+	sdparams.max_triangles = RNA_int_get(cmesh, "dicing_max_triangles");
 	//scene->camera->update();
 	//sdparams.camera = scene->camera;
 
@@ -593,6 +595,103 @@ static void create_subd_mesh(Scene *scene, Mesh *mesh, BL::Mesh b_mesh, PointerR
 	sdmesh.tessellate(&dsplit);
 }
 
+/* Vertex Cache
+ *
+ * Objects only deformed by a Mesh Cache modifier get their vertex positions
+ * read directly from the cache file once their topology was synced, which
+ * avoids evaluating the modifier stack and converting the mesh every frame. */
+
+static BL::MeshCacheModifier object_vertex_cache_modifier(BL::Object b_ob, bool preview)
+{
+	if(b_ob.modifiers.length() != 1)
+		return BL::MeshCacheModifier(PointerRNA_NULL);
+
+	BL::Modifier b_mod = b_ob.modifiers[0];
+
+	if(b_mod.type() != BL::Modifier::type_MESH_CACHE ||
+	   !((preview)? b_mod.show_viewport(): b_mod.show_render()))
+	{
+		return BL::MeshCacheModifier(PointerRNA_NULL);
+	}
+
+	/* only plain playback of the cache at the scene frame, anything else
+	 * goes through the modifier */
+	BL::MeshCacheModifier b_cache(b_mod);
+
+	if(b_cache.play_mode() != BL::MeshCacheModifier::play_mode_SCENE ||
+	   b_cache.time_mode() != BL::MeshCacheModifier::time_mode_FRAME ||
+	   b_cache.deform_mode() != BL::MeshCacheModifier::deform_mode_OVERWRITE ||
+	   b_cache.factor() != 1.0f ||
+	   b_cache.forward_axis() != BL::MeshCacheModifier::forward_axis_POS_Y ||
+	   b_cache.up_axis() != BL::MeshCacheModifier::up_axis_POS_Z ||
+	   b_cache.flip_axis() != 0)
+	{
+		return BL::MeshCacheModifier(PointerRNA_NULL);
+	}
+
+	return b_cache;
+}
+
+bool BlenderSync::sync_mesh_vertex_cache(BL::Object b_ob, Mesh *mesh)
+{
+	/* topology and all other attributes must be valid from a previous sync,
+	 * and vertices must map one to one to the cache */
+	if(mesh->verts.size() == 0 || mesh->transform_applied || mesh->curves.size() ||
+	   mesh->has_motion_blur())
+	{
+		return false;
+	}
+
+	BL::MeshCacheModifier b_cache = object_vertex_cache_modifier(b_ob, preview);
+
+	if(!b_cache || b_ob.type() != BL::Object::type_MESH)
+		return false;
+
+	BL::Mesh b_mesh(b_ob.data());
+	PointerRNA cmesh = RNA_pointer_get(&b_mesh.ptr, "cycles");
+
+	if(b_mesh.use_auto_smooth() ||
+	   (cmesh.data && experimental && RNA_boolean_get(&cmesh, "use_subdivision")))
+	{
+		return false;
+	}
+
+	if(mesh->attributes.find(ATTR_STD_POINTINESS) ||
+	   mesh->attributes.find(ATTR_STD_MOTION_VERTEX_POSITION))
+	{
+		return false;
+	}
+
+	foreach(uint shader, mesh->used_shaders)
+		if(scene->shaders[shader]->need_update_attributes)
+			return false;
+
+	VertexCacheFile cache;
+	string filepath = blender_absolute_path(b_data, b_ob, b_cache.filepath());
+	VertexCacheFile::Format format = (b_cache.cache_format() == BL::MeshCacheModifier::cache_format_PC2)?
+		VertexCacheFile::FORMAT_PC2: VertexCacheFile::FORMAT_MDD;
+
+	if(!cache.open(filepath, format) || cache.num_verts() != (int)mesh->verts.size())
+		return false;
+
+	float frame = b_scene.frame_current() + b_scene.frame_subframe();
+	frame = b_cache.frame_scale()*frame - b_cache.frame_start();
+
+	bool interpolate = (b_cache.interpolation() != BL::MeshCacheModifier::interpolation_NONE);
+
+	if(!cache.read(frame, interpolate, &mesh->verts[0]))
+		return false;
+
+	/* normals are recomputed from the new positions on device update */
+	mesh->attributes.remove(ATTR_STD_VERTEX_NORMAL);
+	mesh->attributes.remove(ATTR_STD_FACE_NORMAL);
+
+	VLOG(1) << "Streamed " << mesh->verts.size() << " vertices of "
+	        << mesh->name.c_str() << " from " << filepath.c_str() << ".";
+
+	return true;
+}
+
 /* Sync */
 
 Mesh *BlenderSync::sync_mesh(BL::Object b_ob, bool object_updated, bool hide_tris)
@@ -665,14 +764,23 @@ Mesh *BlenderSync::sync_mesh(BL::Object b_ob, bool object_updated, bool hide_tri
 	
 	mesh_synced.insert(mesh);
 
+	/* only vertex positions changed */
+	if(mesh->used_shaders == used_shaders &&
+	   mesh->geometry_flags == requested_geometry_flags &&
+	   sync_mesh_vertex_cache(b_ob, mesh))
+	{
+		mesh->tag_update(scene, false);
+		return mesh;
+	}
+
 	/* create derived mesh */
 	PointerRNA cmesh = RNA_pointer_get(&b_ob_data.ptr, "cycles");
 
+	/* compare topology only, when just positions change the BVH is refitted,
+	 * with a rebuild when refitting degrades the tree too much */
 	vector<Mesh::Triangle> oldtriangle = mesh->triangles;
-	
-	/* compares curve_keys rather than strands in order to handle quick hair
-	 * adjustments in dynamic BVH - other methods could probably do this better*/
-	vector<float4> oldcurve_keys = mesh->curve_keys;
+	vector<Mesh::Curve> oldcurves = mesh->curves;
+	size_t oldnum_curve_keys = mesh->curve_keys.size();
 
 	mesh->clear();
 	mesh->used_shaders = used_shaders;
@@ -736,10 +844,12 @@ Mesh *BlenderSync::sync_mesh(BL::Object b_ob, bool object_updated, bool hide_tri
 			rebuild = true;
 	}
 
-	if(oldcurve_keys.size() != mesh->curve_keys.size())
+	if(oldnum_curve_keys != mesh->curve_keys.size())
+		rebuild = true;
+	else if(oldcurves.size() != mesh->curves.size())
 		rebuild = true;
-	else if(oldcurve_keys.size()) {
-		if(memcmp(&oldcurve_keys[0], &mesh->curve_keys[0], sizeof(float4)*oldcurve_keys.size()) != 0)
+	else if(oldcurves.size()) {
+		if(memcmp(&oldcurves[0], &mesh->curves[0], sizeof(Mesh::Curve)*oldcurves.size()) != 0)
 			rebuild = true;
 	}
 	
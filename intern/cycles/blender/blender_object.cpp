@@ -514,25 +514,67 @@ static bool object_render_hide_duplis(BL::Object b_ob)
 	return (parent && object_render_hide_original(b_ob.type(), parent.dupli_type()));
 }
 
+bool BlenderSync::object_can_sync_updated(BL::Object b_ob)
+{
+	/* objects which only affect the scene through their own base, others
+	 * generate or are used by duplis, which requires visiting their parents */
+	if(b_ob.is_duplicator() || object_render_hide_duplis(b_ob))
+		return false;
+	if(synced_dupli_objects.find(b_ob.ptr.data) != synced_dupli_objects.end())
+		return false;
+
+	BL::Object::particle_systems_iterator b_psys;
+	b_ob.particle_systems.begin(b_psys);
+
+	return (b_psys == b_ob.particle_systems.end());
+}
+
 /* Object Loop */
 
+void BlenderSync::sync_objects_visibility(vector<ObjectVisibility>& visibility)
+{
+	visibility.clear();
+
+	/* layer settings affecting all objects */
+	visibility.push_back(ObjectVisibility(NULL, render_layer.scene_layer));
+	visibility.push_back(ObjectVisibility(NULL, render_layer.layer));
+	visibility.push_back(ObjectVisibility(NULL, render_layer.holdout_layer));
+	visibility.push_back(ObjectVisibility(NULL, render_layer.exclude_layer));
+	visibility.push_back(ObjectVisibility(render_layer.material_override.ptr.data,
+	                                      (render_layer.use_surfaces? 1: 0) |
+	                                      (render_layer.use_hair? 2: 0)));
+
+	/* visible objects with their layers, same tests as the object loop */
+	BL::Scene::object_bases_iterator b_base;
+	BL::Scene b_sce = b_scene;
+	uint layer_override = get_layer(b_engine.layer_override());
+
+	for(; b_sce; b_sce = b_sce.background_set()) {
+		uint scene_layers = layer_override ? layer_override : get_layer(b_scene.layers());
+
+		for(b_sce.object_bases.begin(b_base); b_base != b_sce.object_bases.end(); ++b_base) {
+			BL::Object b_ob = b_base->object();
+			bool hide = (render_layer.use_viewport_visibility)? b_ob.hide(): b_ob.hide_render();
+			uint ob_layer = get_layer(b_base->layers(),
+			                          b_base->layers_local_view(),
+			                          render_layer.use_localview,
+			                          object_is_light(b_ob),
+			                          scene_layers);
+
+			if(!hide && (ob_layer & render_layer.scene_layer))
+				visibility.push_back(ObjectVisibility(b_ob.ptr.data, ob_layer));
+		}
+	}
+}
+
 void BlenderSync::sync_objects(BL::SpaceView3D b_v3d, float motion_time)
 {
 	/* layer data */
 	uint scene_layer = render_layer.scene_layer;
 	bool motion = motion_time != 0.0f;
-	
-	if(!motion) {
-		/* prepare for sync */
-		light_map.pre_sync();
-		mesh_map.pre_sync();
-		object_map.pre_sync();
-		particle_system_map.pre_sync();
-		motion_times.clear();
-	}
-	else {
+
+	if(motion)
 		mesh_motion_synced.clear();
-	}
 
 	bool allow_camera_cull = false;
 	float camera_cull_margin = 0.0f;
@@ -558,6 +600,38 @@ void BlenderSync::sync_objects(BL::SpaceView3D b_v3d, float motion_time)
 	bool cancel = false;
 	bool use_portal = false;
 
+	/* for interactive updates only sync objects tagged as updated, camera
+	 * culling and motion depend on all objects so they need a full sync */
+	bool only_updated = preview &&
+	                    !motion &&
+	                    !allow_camera_cull &&
+	                    !objects_need_full_sync &&
+	                    !synced_visibility.empty() &&
+	                    scene->need_motion() == Scene::MOTION_NONE;
+
+	/* objects being added, removed, hidden or moved between layers are not
+	 * tagged as updated, detect it by comparing visibility of all objects */
+	vector<ObjectVisibility> visibility;
+
+	if(!motion) {
+		sync_objects_visibility(visibility);
+
+		if(only_updated && visibility != synced_visibility) {
+			VLOG(1) << "Object visibility changed, synchronizing all objects.";
+			only_updated = false;
+		}
+	}
+
+	if(!motion && !only_updated) {
+		/* prepare for sync */
+		light_map.pre_sync();
+		mesh_map.pre_sync();
+		object_map.pre_sync();
+		particle_system_map.pre_sync();
+		motion_times.clear();
+		synced_dupli_objects.clear();
+	}
+
 	uint layer_override = get_layer(b_engine.layer_override());
 	for(; b_sce && !cancel; b_sce = b_sce.background_set()) {
 		/* Render layer's scene_layer is affected by local view already,
@@ -574,6 +648,11 @@ void BlenderSync::sync_objects(BL::SpaceView3D b_v3d, float motion_time)
 			                          scene_layers);
 			hide = hide || !(ob_layer & scene_layer);
 
+			if(only_updated && objects_updated.find(b_ob.ptr.data) == objects_updated.end()) {
+				cancel = progress.get_cancel();
+				continue;
+			}
+
 			if(!hide) {
 				progress.set_sync_status("Synchronizing object", b_ob.name());
 
@@ -596,6 +675,9 @@ void BlenderSync::sync_objects(BL::SpaceView3D b_v3d, float motion_time)
 						bool in_dupli_group = (b_dup->type() == BL::DupliObject::type_GROUP);
 						bool hide_tris;
 
+						if(!motion)
+							synced_dupli_objects.insert(b_dup_ob.ptr.data);
+
 						if(!(b_dup->hide() || dup_hide || object_render_hide(b_dup_ob, false, in_dupli_group, hide_tris))) {
 							/* the persistent_id allows us to match dupli objects
 							 * between frames and updates */
@@ -651,17 +733,35 @@ void BlenderSync::sync_objects(BL::SpaceView3D b_v3d, float motion_time)
 	progress.set_sync_status("");
 
 	if(!cancel && !motion) {
-		sync_background_light(use_portal);
-
-		/* handle removed data and modified pointers */
-		if(light_map.post_sync())
-			scene->light_manager->tag_update(scene);
-		if(mesh_map.post_sync())
-			scene->mesh_manager->tag_update(scene);
-		if(object_map.post_sync())
-			scene->object_manager->tag_update(scene);
-		if(particle_system_map.post_sync())
-			scene->particle_system_manager->tag_update(scene);
+		if(only_updated) {
+			VLOG(1) << "Synchronized " << objects_updated.size() << " updated objects.";
+
+			/* lights which are not updated keep their portal state */
+			sync_background_light(use_portal || synced_use_portal);
+
+			light_map.post_sync_updated();
+			mesh_map.post_sync_updated();
+			object_map.post_sync_updated();
+			particle_system_map.post_sync_updated();
+		}
+		else {
+			sync_background_light(use_portal);
+			synced_use_portal = use_portal;
+
+			/* handle removed data and modified pointers */
+			if(light_map.post_sync())
+				scene->light_manager->tag_update(scene);
+			if(mesh_map.post_sync())
+				scene->mesh_manager->tag_update(scene);
+			if(object_map.post_sync())
+				scene->object_manager->tag_update(scene);
+			if(particle_system_map.post_sync())
+				scene->particle_system_manager->tag_update(scene);
+		}
+
+		synced_visibility = visibility;
+		objects_updated.clear();
+		objects_need_full_sync = false;
 	}
 
 	if(motion)
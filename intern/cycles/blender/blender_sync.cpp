@@ -52,6 +52,8 @@ BlenderSync::BlenderSync(BL::RenderEngine b_engine_, BL::BlendData b_data_, BL::
   particle_system_map(&scene_->particle_systems),
   world_map(NULL),
   world_recalc(false),
+  objects_need_full_sync(true),
+  synced_use_portal(false),
   experimental(false),
   progress(progress_)
 {
@@ -94,34 +96,52 @@ bool BlenderSync::sync_recalc()
 	BL::BlendData::objects_iterator b_ob;
 
 	for(b_data.objects.begin(b_ob); b_ob != b_data.objects.end(); ++b_ob) {
+		bool object_updated = false;
+
 		if(b_ob->is_updated()) {
 			object_map.set_recalc(*b_ob);
 			light_map.set_recalc(*b_ob);
+			object_updated = true;
 		}
 
 		if(object_is_mesh(*b_ob)) {
 			if(b_ob->is_updated_data() || b_ob->data().is_updated()) {
 				BL::ID key = BKE_object_is_modified(*b_ob)? *b_ob: b_ob->data();
 				mesh_map.set_recalc(key);
+				object_updated = true;
 			}
 		}
 		else if(object_is_light(*b_ob)) {
-			if(b_ob->is_updated_data() || b_ob->data().is_updated())
+			if(b_ob->is_updated_data() || b_ob->data().is_updated()) {
 				light_map.set_recalc(*b_ob);
+				object_updated = true;
+			}
 		}
 		
 		if(b_ob->is_updated_data()) {
 			BL::Object::particle_systems_iterator b_psys;
 			for(b_ob->particle_systems.begin(b_psys); b_psys != b_ob->particle_systems.end(); ++b_psys)
 				particle_system_map.set_recalc(*b_ob);
+			object_updated = true;
+		}
+
+		if(object_updated) {
+			objects_updated.insert(b_ob->ptr.data);
+
+			if(!object_can_sync_updated(*b_ob))
+				objects_need_full_sync = true;
 		}
 	}
 
 	BL::BlendData::meshes_iterator b_mesh;
 
-	for(b_data.meshes.begin(b_mesh); b_mesh != b_data.meshes.end(); ++b_mesh)
-		if(b_mesh->is_updated())
+	for(b_data.meshes.begin(b_mesh); b_mesh != b_data.meshes.end(); ++b_mesh) {
+		if(b_mesh->is_updated()) {
 			mesh_map.set_recalc(*b_mesh);
+			/* users of the mesh are not known here */
+			objects_need_full_sync = true;
+		}
+	}
 
 	BL::BlendData::worlds_iterator b_world;
 
@@ -130,6 +150,7 @@ bool BlenderSync::sync_recalc()
 		   (b_world->is_updated() || (b_world->node_tree() && b_world->node_tree().is_updated())))
 		{
 			world_recalc = true;
+			objects_need_full_sync = true;
 		}
 	}
 
@@ -235,6 +256,18 @@ void BlenderSync::sync_integrator()
 	integrator->sample_all_lights_direct = get_boolean(cscene, "sample_all_lights_direct");
 	integrator->sample_all_lights_indirect = get_boolean(cscene, "sample_all_lights_indirect");
 
+	/* adaptive sampling is only supported for final renders */
+	integrator->use_adaptive_sampling = !preview && get_boolean(cscene, "use_adaptive_sampling");
+	integrator->adaptive_min_samples = get_int(cscene, "adaptive_min_samples");
+	integrator->adaptive_threshold = get_float(cscene, "adaptive_threshold");
+
+	integrator->use_light_tree = get_boolean(cscene, "use_light_tree");
+	if(integrator->use_light_tree != previntegrator.use_light_tree)
+		scene->light_manager->tag_update(scene);
+
+	integrator->use_light_sample_learning = get_boolean(cscene, "use_light_sample_learning");
+	integrator->light_learning_samples = get_int(cscene, "light_learning_samples");
+
 	int diffuse_samples = get_int(cscene, "diffuse_samples");
 	int glossy_samples = get_int(cscene, "glossy_samples");
 	int transmission_samples = get_int(cscene, "transmission_samples");
@@ -416,7 +449,10 @@ void BlenderSync::sync_images()
 
 /* Scene Parameters */
 
-SceneParams BlenderSync::get_scene_params(BL::Scene b_scene, bool background, bool is_cpu)
+SceneParams BlenderSync::get_scene_params(BL::BlendData b_data,
+                                          BL::Scene b_scene,
+                                          bool background,
+                                          bool is_cpu)
 {
 	BL::RenderSettings r = b_scene.render();
 	SceneParams params;
@@ -435,6 +471,23 @@ SceneParams BlenderSync::get_scene_params(BL::Scene b_scene, bool background, bo
 
 	params.use_bvh_spatial_split = RNA_boolean_get(&cscene, "debug_use_spatial_splits");
 
+	/* disk cache is only useful for final renders, viewport geometry changes
+	 * all the time */
+	if(background) {
+		params.use_bvh_cache = RNA_boolean_get(&cscene, "debug_use_bvh_cache");
+		params.bvh_cache_path = blender_absolute_path(b_data,
+		                                              b_scene,
+		                                              get_string(cscene, "debug_bvh_cache_path"));
+	}
+
+	params.use_compact_textures = RNA_boolean_get(&cscene, "use_compact_textures");
+
+	/* texture limit enum items map to powers of two starting at 128 */
+	if(background) {
+		int texture_limit = get_enum(cscene, "texture_limit");
+		params.texture_limit = (texture_limit > 0)? (64 << texture_limit): 0;
+	}
+
 	if(background && params.shadingsystem != SHADINGSYSTEM_OSL)
 		params.persistent_data = r.use_persistent_data();
 	else
@@ -575,6 +628,8 @@ SessionParams BlenderSync::get_session_params(BL::RenderEngine b_engine,
 
 	params.progressive_refine = get_boolean(cscene, "use_progressive_refine");
 
+	params.use_profiling = get_boolean(cscene, "debug_use_profiling");
+
 	if(background) {
 		if(params.progressive_refine)
 			params.progressive = true;
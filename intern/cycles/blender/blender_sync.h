@@ -67,7 +67,10 @@ public:
 	int get_layer_bound_samples() { return render_layer.bound_samples; }
 
 	/* get parameters */
-	static SceneParams get_scene_params(BL::Scene b_scene, bool background, bool is_cpu);
+	static SceneParams get_scene_params(BL::BlendData b_data,
+	                                    BL::Scene b_scene,
+	                                    bool background,
+	                                    bool is_cpu);
 	static SessionParams get_session_params(BL::RenderEngine b_engine,
 	                                        BL::UserPreferences b_userpref,
 	                                        BL::Scene b_scene,
@@ -76,10 +79,14 @@ public:
 	static BufferParams get_buffer_params(BL::RenderSettings b_render, BL::SpaceView3D b_v3d, BL::RegionView3D b_rv3d, Camera *cam, int width, int height);
 
 private:
+	/* visible object and its layers, or layer settings for NULL */
+	typedef std::pair<void*, uint> ObjectVisibility;
+
 	/* sync */
 	void sync_lamps(bool update_all);
 	void sync_materials(bool update_all);
 	void sync_objects(BL::SpaceView3D b_v3d, float motion_time = 0.0f);
+	void sync_objects_visibility(vector<ObjectVisibility>& visibility);
 	void sync_motion(BL::RenderSettings b_render,
 	                 BL::SpaceView3D b_v3d,
 	                 BL::Object b_override,
@@ -93,6 +100,7 @@ private:
 
 	void sync_nodes(Shader *shader, BL::ShaderNodeTree b_ntree);
 	Mesh *sync_mesh(BL::Object b_ob, bool object_updated, bool hide_tris);
+	bool sync_mesh_vertex_cache(BL::Object b_ob, Mesh *mesh);
 	void sync_curves(Mesh *mesh, BL::Mesh b_mesh, BL::Object b_ob, bool motion, int time_index = 0);
 	Object *sync_object(BL::Object b_parent,
 	                    int persistent_id[OBJECT_PERSISTENT_ID_SIZE],
@@ -123,6 +131,7 @@ private:
 	bool BKE_object_is_modified(BL::Object b_ob);
 	bool object_is_mesh(BL::Object b_ob);
 	bool object_is_light(BL::Object b_ob);
+	bool object_can_sync_updated(BL::Object b_ob);
 
 	/* variables */
 	BL::RenderEngine b_engine;
@@ -140,6 +149,14 @@ private:
 	void *world_map;
 	bool world_recalc;
 
+	/* Interactive object sync only visits objects tagged by the depsgraph,
+	 * as long as the visible objects and their layers stay the same. */
+	set<void*> objects_updated;
+	bool objects_need_full_sync;
+	vector<ObjectVisibility> synced_visibility;
+	set<void*> synced_dupli_objects;
+	bool synced_use_portal;
+
 	Scene *scene;
 	bool preview;
 	bool experimental;
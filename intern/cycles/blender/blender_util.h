@@ -606,6 +606,13 @@ public:
 		return deleted;
 	}
 
+	void post_sync_updated()
+	{
+		/* finish a sync which only visited updated data, nothing is removed */
+		used_set.clear();
+		b_recalc.clear();
+	}
+
 protected:
 	vector<T*> *scene_data;
 	map<K, T*> b_map;
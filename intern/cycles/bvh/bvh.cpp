@@ -25,11 +25,14 @@
 #include "bvh_node.h"
 #include "bvh_params.h"
 
+#include "util_cache.h"
 #include "util_debug.h"
 #include "util_foreach.h"
 #include "util_logging.h"
 #include "util_map.h"
+#include "util_md5.h"
 #include "util_progress.h"
+#include "util_set.h"
 #include "util_system.h"
 #include "util_types.h"
 #include "util_math.h"
@@ -69,10 +72,205 @@ BVH *BVH::create(const BVHParams& params, const vector<Object*>& objects)
 		return new RegularBVH(params, objects);
 }
 
+/* Cache */
+
+/* Bump when the packed BVH layout changes, so old cache files are ignored. */
+#define BVH_CACHE_VERSION 2
+
+template<typename T> static void cache_hash_append(MD5Hash& hash, const T& data)
+{
+	hash.append((const uint8_t*)&data, sizeof(T));
+}
+
+static void cache_hash_append_bytes(MD5Hash& hash, const void *data, size_t size)
+{
+	/* MD5Hash takes int sizes, split up huge buffers. */
+	const uint8_t *bytes = (const uint8_t*)data;
+	const size_t chunk_size = 1 << 30;
+
+	cache_hash_append(hash, size);
+
+	while(size > 0) {
+		size_t chunk = (size < chunk_size)? size: chunk_size;
+		hash.append(bytes, (int)chunk);
+		bytes += chunk;
+		size -= chunk;
+	}
+}
+
+static void cache_hash_append_float3(MD5Hash& hash, const float3 *data, size_t size)
+{
+	/* Only XYZ components are hashed, W is padding and not guaranteed to be
+	 * initialized, so it would give a different key for the same geometry. */
+	float buffer[3*1024];
+	size_t num = 0;
+
+	cache_hash_append(hash, size);
+
+	for(size_t i = 0; i < size; i++) {
+		buffer[num*3 + 0] = data[i].x;
+		buffer[num*3 + 1] = data[i].y;
+		buffer[num*3 + 2] = data[i].z;
+
+		if(++num == 1024) {
+			hash.append((const uint8_t*)buffer, sizeof(buffer));
+			num = 0;
+		}
+	}
+
+	if(num)
+		hash.append((const uint8_t*)buffer, num*3*sizeof(float));
+}
+
+void BVH::cache_key(CacheData& key)
+{
+	MD5Hash hash;
+
+	cache_hash_append(hash, (int)BVH_CACHE_VERSION);
+	cache_hash_append(hash, system_cpu_bits());
+
+	/* build parameters, field by field to avoid hashing padding */
+	cache_hash_append(hash, (int)params.use_spatial_split);
+	cache_hash_append(hash, params.spatial_split_alpha);
+	cache_hash_append(hash, params.sah_node_cost);
+	cache_hash_append(hash, params.sah_primitive_cost);
+	cache_hash_append(hash, params.min_leaf_size);
+	cache_hash_append(hash, params.max_triangle_leaf_size);
+	cache_hash_append(hash, params.max_curve_leaf_size);
+	cache_hash_append(hash, (int)params.top_level);
+	cache_hash_append(hash, (int)params.use_qbvh);
+	cache_hash_append(hash, params.num_motion_steps);
+
+	/* geometry, meshes shared by multiple instances are only hashed once */
+	map<Mesh*, int> mesh_index;
+
+	foreach(Object *ob, objects) {
+		Mesh *mesh = ob->mesh;
+
+		cache_hash_append_float3(hash, &ob->bounds.min, 1);
+		cache_hash_append_float3(hash, &ob->bounds.max, 1);
+		cache_hash_append(hash, ob->visibility);
+		cache_hash_append(hash, (int)mesh->transform_applied);
+
+		map<Mesh*, int>::iterator it = mesh_index.find(mesh);
+		if(it != mesh_index.end()) {
+			cache_hash_append(hash, it->second);
+			continue;
+		}
+
+		int index = (int)mesh_index.size();
+		mesh_index[mesh] = index;
+		cache_hash_append(hash, index);
+
+		cache_hash_append_float3(hash,
+		                         mesh->verts.size()? &mesh->verts[0]: NULL,
+		                         mesh->verts.size());
+		cache_hash_append_bytes(hash,
+		                        mesh->triangles.size()? &mesh->triangles[0]: NULL,
+		                        mesh->triangles.size()*sizeof(Mesh::Triangle));
+		cache_hash_append_bytes(hash,
+		                        mesh->curve_keys.size()? &mesh->curve_keys[0]: NULL,
+		                        mesh->curve_keys.size()*sizeof(float4));
+		cache_hash_append_bytes(hash,
+		                        mesh->curves.size()? &mesh->curves[0]: NULL,
+		                        mesh->curves.size()*sizeof(Mesh::Curve));
+
+		if(mesh->has_motion_blur()) {
+			Attribute *attr = mesh->attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
+			if(attr) {
+				cache_hash_append_float3(hash,
+				                         attr->data_float3(),
+				                         attr->buffer.size()/sizeof(float3));
+			}
+
+			attr = mesh->curve_attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
+			if(attr)
+				cache_hash_append_bytes(hash, attr->data(), attr->buffer.size());
+		}
+	}
+
+	cache_hash = hash.get_hex();
+	key.add(cache_hash.c_str(), cache_hash.size());
+}
+
+bool BVH::cache_read(CacheData& key)
+{
+	CacheData value;
+
+	if(!Cache::global.lookup(key, value))
+		return false;
+
+	if(!(value.read(pack.root_index) &&
+	     value.read(pack.SAH) &&
+	     value.read(pack.nodes) &&
+	     value.read(pack.leaf_nodes) &&
+	     value.read(pack.object_node) &&
+	     value.read(pack.tri_woop) &&
+	     value.read(pack.prim_type) &&
+	     value.read(pack.prim_visibility) &&
+	     value.read(pack.prim_index) &&
+	     value.read(pack.prim_object) &&
+	     value.read(pack.motion_nodes)))
+	{
+		/* Clear the pack if load failed, it will be built from scratch. */
+		pack.root_index = 0;
+		pack.SAH = 0.0f;
+		pack.nodes.clear();
+		pack.leaf_nodes.clear();
+		pack.object_node.clear();
+		pack.tri_woop.clear();
+		pack.prim_type.clear();
+		pack.prim_visibility.clear();
+		pack.prim_index.clear();
+		pack.prim_object.clear();
+		pack.motion_nodes.clear();
+
+		VLOG(1) << "Failed to read BVH cache " << key.get_filename() << ".";
+		return false;
+	}
+
+	VLOG(1) << "Loaded BVH from cache " << key.get_filename() << ".";
+	return true;
+}
+
+void BVH::cache_write(CacheData& key)
+{
+	CacheData value;
+
+	value.add(pack.root_index);
+	value.add(pack.SAH);
+
+	value.add(pack.nodes);
+	value.add(pack.leaf_nodes);
+	value.add(pack.object_node);
+	value.add(pack.tri_woop);
+	value.add(pack.prim_type);
+	value.add(pack.prim_visibility);
+	value.add(pack.prim_index);
+	value.add(pack.prim_object);
+	value.add(pack.motion_nodes);
+
+	Cache::global.insert(key, value);
+
+	VLOG(1) << "Wrote BVH cache " << key.get_filename() << ".";
+}
+
 /* Building */
 
 void BVH::build(Progress& progress)
 {
+	/* cache read */
+	CacheData key("bvh");
+
+	if(params.use_cache) {
+		progress.set_substatus("Looking in BVH cache");
+
+		cache_key(key);
+
+		if(cache_read(key))
+			return;
+	}
+
 	progress.set_substatus("Building BVH");
 
 	/* build nodes */
@@ -89,15 +287,6 @@ void BVH::build(Progress& progress)
 		return;
 	}
 
-	/* compute SAH */
-	if(!params.top_level)
-		pack.SAH = root->computeSubtreeSAHCost(params);
-
-	if(progress.get_cancel()) {
-		root->deleteSubtree();
-		return;
-	}
-
 	/* pack triangles */
 	progress.set_substatus("Packing BVH triangles and strands");
 	pack_primitives();
@@ -111,21 +300,176 @@ void BVH::build(Progress& progress)
 	progress.set_substatus("Packing BVH nodes");
 	pack_nodes(root);
 
+	/* pack per motion step bounds */
+	if(params.num_motion_steps) {
+		progress.set_substatus("Packing BVH motion nodes");
+		pack_motion_nodes();
+	}
+
 	/* free build nodes */
 	root->deleteSubtree();
+
+	if(progress.get_cancel()) return;
+
+	/* cache write */
+	if(params.use_cache) {
+		progress.set_substatus("Writing BVH cache");
+		cache_write(key);
+	}
 }
 
 /* Refitting */
 
-void BVH::refit(Progress& progress)
+bool BVH::refit(Progress& progress)
 {
 	progress.set_substatus("Packing BVH primitives");
 	pack_primitives();
 
-	if(progress.get_cancel()) return;
+	if(progress.get_cancel()) return true;
 
 	progress.set_substatus("Refitting BVH nodes");
-	refit_nodes();
+	float SAH = refit_nodes();
+
+	if(params.num_motion_steps)
+		pack_motion_nodes();
+
+	VLOG(1) << "BVH refit SAH cost " << SAH << ", after build " << pack.SAH << ".";
+
+	/* refit keeps the topology, which becomes less efficient when primitives
+	 * move far away from their original position */
+	if(SAH > pack.SAH * params.refit_max_sah_growth) {
+		VLOG(1) << "BVH degraded too much after refit, needs rebuild.";
+		return false;
+	}
+
+	return true;
+}
+
+/* SAH cost of the packed nodes, normalized by the root area. */
+static float normalized_sah(float sah, const BoundBox& root_bounds)
+{
+	float root_area = root_bounds.safe_area();
+	return (root_area > 0.0f)? sah / root_area: 0.0f;
+}
+
+/* Motion Nodes
+ *
+ * The regular node bounds cover the whole shutter interval. For deformation
+ * motion blur we additionally store the child bounds of every inner node at
+ * each motion step. Vertices move linearly between steps, so interpolating
+ * the bounds of two steps at the ray time still bounds the primitives, with
+ * much less empty space for fast moving geometry. */
+
+void BVH::motion_step_bounds_grow(int prim, int step, BoundBox& bbox)
+{
+	int pidx = pack.prim_index[prim];
+	int tob = pack.prim_object[prim];
+	Object *ob = objects[tob];
+
+	if(pidx == -1) {
+		/* object instance, bounds include the object motion */
+		bbox.grow(ob->bounds);
+		return;
+	}
+
+	const Mesh *mesh = ob->mesh;
+	int center_step = params.num_motion_steps/2;
+	/* index into the motion attribute, which skips the center step */
+	int attr_step = (step > center_step)? step - 1: step;
+	bool use_step = (step != center_step &&
+	                 mesh->use_motion_blur &&
+	                 mesh->motion_steps == params.num_motion_steps);
+
+	if(pack.prim_type[prim] & PRIMITIVE_ALL_CURVE) {
+		int str_offset = (params.top_level)? mesh->curve_offset: 0;
+		const Mesh::Curve& curve = mesh->curves[pidx - str_offset];
+		int k = PRIMITIVE_UNPACK_SEGMENT(pack.prim_type[prim]);
+		const float4 *keys = &mesh->curve_keys[0];
+
+		if(use_step) {
+			Attribute *attr = mesh->curve_attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
+			if(attr)
+				keys = attr->data_float4() + attr_step*mesh->curve_keys.size();
+		}
+
+		curve.bounds_grow(k, keys, bbox);
+	}
+	else {
+		int tri_offset = (params.top_level)? mesh->tri_offset: 0;
+		const Mesh::Triangle& triangle = mesh->triangles[pidx - tri_offset];
+		const float3 *vpos = &mesh->verts[0];
+
+		if(use_step) {
+			Attribute *attr = mesh->attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
+			if(attr)
+				vpos = attr->data_float3() + attr_step*mesh->verts.size();
+		}
+
+		triangle.bounds_grow(vpos, bbox);
+	}
+}
+
+void BVH::pack_motion_instances(size_t nsize, size_t nsize_motion)
+{
+	/* copy motion nodes of instanced meshes to the place of their merged nodes,
+	 * using their static bounds for every step if they were built without */
+	size_t num_steps = params.num_motion_steps;
+	set<Mesh*> packed_meshes;
+
+	for(size_t i = 0; i < objects.size(); i++) {
+		Mesh *mesh = objects[i]->mesh;
+		BVH *bvh = mesh->bvh;
+
+		if(mesh->transform_applied || !bvh || bvh->pack.root_index == -1)
+			continue;
+		if(packed_meshes.find(mesh) != packed_meshes.end())
+			continue;
+
+		packed_meshes.insert(mesh);
+
+		size_t noffset = pack.object_node[i];
+		size_t num_nodes = bvh->pack.nodes.size()/nsize;
+		float4 *motion_nodes = &pack.motion_nodes[noffset*num_steps*nsize_motion];
+
+		if(bvh->pack.motion_nodes.size() == num_nodes*num_steps*nsize_motion) {
+			memcpy(motion_nodes, &bvh->pack.motion_nodes[0],
+			       num_nodes*num_steps*nsize_motion*sizeof(float4));
+		}
+		else {
+			for(size_t n = 0; n < num_nodes; n++) {
+				const float4 *bounds = (const float4*)&bvh->pack.nodes[n*nsize];
+
+				for(size_t step = 0; step < num_steps; step++) {
+					memcpy(motion_nodes, bounds, nsize_motion*sizeof(float4));
+					motion_nodes += nsize_motion;
+				}
+			}
+		}
+	}
+}
+
+void BVH::pack_motion_nodes()
+{
+	size_t nsize = (params.use_qbvh)? BVH_QNODE_SIZE: BVH_NODE_SIZE;
+	size_t nsize_motion = (params.use_qbvh)? BVH_QMOTION_NODE_SIZE: BVH_MOTION_NODE_SIZE;
+	size_t num_nodes = pack.nodes.size()/nsize;
+
+	pack.motion_nodes.clear();
+	pack.motion_nodes.resize(num_nodes*params.num_motion_steps*nsize_motion);
+
+	if(num_nodes == 0)
+		return;
+
+	if(params.top_level)
+		pack_motion_instances(nsize, nsize_motion);
+
+	if(pack.root_index == -1)
+		return;
+
+	for(int step = 0; step < params.num_motion_steps; step++) {
+		BoundBox bbox = BoundBox::empty;
+		pack_motion_node(0, false, step, bbox);
+	}
 }
 
 /* Triangles */
@@ -448,6 +792,7 @@ void RegularBVH::pack_nodes(const BVHNode *root)
 	}
 
 	int nextNodeIdx = 0, nextLeafNodeIdx = 0;
+	float sah = 0.0f;
 
 	vector<BVHStackEntry> stack;
 	stack.reserve(BVHParams::MAX_DEPTH*2);
@@ -464,6 +809,8 @@ void RegularBVH::pack_nodes(const BVHNode *root)
 			/* leaf node */
 			const LeafNode* leaf = reinterpret_cast<const LeafNode*>(e.node);
 			pack_leaf(e, leaf);
+
+			sah += leaf->m_bounds.safe_area() * params.primitive_cost(leaf->num_triangles());
 		}
 		else {
 			/* innner node */
@@ -473,23 +820,29 @@ void RegularBVH::pack_nodes(const BVHNode *root)
 			stack.push_back(BVHStackEntry(e.node->get_child(1), idx1));
 
 			pack_inner(e, stack[stack.size()-2], stack[stack.size()-1]);
+
+			sah += e.node->m_bounds.safe_area() * params.node_cost(2);
 		}
 	}
 
 	/* root index to start traversal at, to handle case of single leaf node */
 	pack.root_index = (root->is_leaf())? -1: 0;
+	pack.SAH = normalized_sah(sah, root->m_bounds);
 }
 
-void RegularBVH::refit_nodes()
+float RegularBVH::refit_nodes()
 {
 	assert(!params.top_level);
 
 	BoundBox bbox = BoundBox::empty;
 	uint visibility = 0;
-	refit_node(0, (pack.root_index == -1)? true: false, bbox, visibility);
+	float sah = 0.0f;
+	refit_node(0, (pack.root_index == -1)? true: false, bbox, visibility, sah);
+
+	return normalized_sah(sah, bbox);
 }
 
-void RegularBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility)
+void RegularBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility, float& sah)
 {
 	if(leaf) {
 		int4 *data = &pack.leaf_nodes[idx*BVH_NODE_LEAF_SIZE];
@@ -569,6 +922,8 @@ void RegularBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility
 		memcpy(&pack.leaf_nodes[idx * BVH_NODE_LEAF_SIZE],
 		       leaf_data,
 		       sizeof(float4)*BVH_NODE_LEAF_SIZE);
+
+		sah += bbox.safe_area() * params.primitive_cost(c1 - c0);
 	}
 	else {
 		int4 *data = &pack.nodes[idx*BVH_NODE_SIZE];
@@ -578,14 +933,51 @@ void RegularBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility
 		BoundBox bbox0 = BoundBox::empty, bbox1 = BoundBox::empty;
 		uint visibility0 = 0, visibility1 = 0;
 
-		refit_node((c0 < 0)? -c0-1: c0, (c0 < 0), bbox0, visibility0);
-		refit_node((c1 < 0)? -c1-1: c1, (c1 < 0), bbox1, visibility1);
+		refit_node((c0 < 0)? -c0-1: c0, (c0 < 0), bbox0, visibility0, sah);
+		refit_node((c1 < 0)? -c1-1: c1, (c1 < 0), bbox1, visibility1, sah);
 
 		pack_node(idx, bbox0, bbox1, c0, c1, visibility0, visibility1);
 
 		bbox.grow(bbox0);
 		bbox.grow(bbox1);
 		visibility = visibility0|visibility1;
+
+		sah += bbox.safe_area() * params.node_cost(2);
+	}
+}
+
+void RegularBVH::pack_motion_node(int idx, bool leaf, int step, BoundBox& bbox)
+{
+	if(leaf) {
+		int4 *data = &pack.leaf_nodes[idx*BVH_NODE_LEAF_SIZE];
+		int c0 = data[0].x;
+		int c1 = data[0].y;
+
+		if(c0 < 0) {
+			/* object instance */
+			motion_step_bounds_grow(~c0, step, bbox);
+		}
+		else {
+			for(int prim = c0; prim < c1; prim++)
+				motion_step_bounds_grow(prim, step, bbox);
+		}
+	}
+	else {
+		int4 *data = &pack.nodes[idx*BVH_NODE_SIZE];
+		int c0 = data[3].x;
+		int c1 = data[3].y;
+		BoundBox b0 = BoundBox::empty, b1 = BoundBox::empty;
+
+		pack_motion_node((c0 < 0)? -c0-1: c0, (c0 < 0), step, b0);
+		pack_motion_node((c1 < 0)? -c1-1: c1, (c1 < 0), step, b1);
+
+		float4 *motion_data = &pack.motion_nodes[(idx*params.num_motion_steps + step)*BVH_MOTION_NODE_SIZE];
+		motion_data[0] = make_float4(b0.min.x, b1.min.x, b0.max.x, b1.max.x);
+		motion_data[1] = make_float4(b0.min.y, b1.min.y, b0.max.y, b1.max.y);
+		motion_data[2] = make_float4(b0.min.z, b1.min.z, b0.max.z, b1.max.z);
+
+		bbox.grow(b0);
+		bbox.grow(b1);
 	}
 }
 
@@ -679,6 +1071,7 @@ void QBVH::pack_nodes(const BVHNode *root)
 	}
 
 	int nextNodeIdx = 0, nextLeafNodeIdx = 0;
+	float sah = 0.0f;
 
 	vector<BVHStackEntry> stack;
 	stack.reserve(BVHParams::MAX_DEPTH*2);
@@ -697,6 +1090,8 @@ void QBVH::pack_nodes(const BVHNode *root)
 			/* leaf node */
 			const LeafNode* leaf = reinterpret_cast<const LeafNode*>(e.node);
 			pack_leaf(e, leaf);
+
+			sah += leaf->m_bounds.safe_area() * params.primitive_cost(leaf->num_triangles());
 		}
 		else {
 			/* inner node */
@@ -738,23 +1133,29 @@ void QBVH::pack_nodes(const BVHNode *root)
 
 			/* set node */
 			pack_inner(e, &stack[stack.size()-numnodes], numnodes);
+
+			sah += node->m_bounds.safe_area() * params.node_cost(numnodes);
 		}
 	}
 
 	/* root index to start traversal at, to handle case of single leaf node */
 	pack.root_index = (root->is_leaf())? -1: 0;
+	pack.SAH = normalized_sah(sah, root->m_bounds);
 }
 
-void QBVH::refit_nodes()
+float QBVH::refit_nodes()
 {
 	assert(!params.top_level);
 
 	BoundBox bbox = BoundBox::empty;
 	uint visibility = 0;
-	refit_node(0, (pack.root_index == -1)? true: false, bbox, visibility);
+	float sah = 0.0f;
+	refit_node(0, (pack.root_index == -1)? true: false, bbox, visibility, sah);
+
+	return normalized_sah(sah, bbox);
 }
 
-void QBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility)
+void QBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility, float& sah)
 {
 	if(leaf) {
 		int4 *data = &pack.leaf_nodes[idx*BVH_QNODE_LEAF_SIZE];
@@ -842,6 +1243,8 @@ void QBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility)
 		memcpy(&pack.leaf_nodes[idx * BVH_QNODE_LEAF_SIZE],
 		       leaf_data,
 		       sizeof(float4)*BVH_QNODE_LEAF_SIZE);
+
+		sah += bbox.safe_area() * params.primitive_cost(c.y - c.x);
 	}
 	else {
 		int4 *data = &pack.nodes[idx*BVH_QNODE_SIZE];
@@ -857,7 +1260,7 @@ void QBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility)
 		for(int i = 0; i < 4; ++i) {
 			if(c[i] != 0) {
 				refit_node((c[i] < 0)? -c[i]-1: c[i], (c[i] < 0),
-				           child_bbox[i], child_visibility[i]);
+				           child_bbox[i], child_visibility[i], sah);
 				++num_nodes;
 				bbox.grow(child_bbox[i]);
 				visibility |= child_visibility[i];
@@ -879,6 +1282,48 @@ void QBVH::refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility)
 		memcpy(&pack.nodes[idx * BVH_QNODE_SIZE],
 		       inner_data,
 		       sizeof(float4)*BVH_QNODE_SIZE);
+
+		sah += bbox.safe_area() * params.node_cost(num_nodes);
+	}
+}
+
+void QBVH::pack_motion_node(int idx, bool leaf, int step, BoundBox& bbox)
+{
+	if(leaf) {
+		int4 *data = &pack.leaf_nodes[idx*BVH_QNODE_LEAF_SIZE];
+		int c0 = data[0].x;
+		int c1 = data[0].y;
+
+		if(c0 < 0) {
+			/* Object instance. */
+			motion_step_bounds_grow(~c0, step, bbox);
+		}
+		else {
+			for(int prim = c0; prim < c1; prim++)
+				motion_step_bounds_grow(prim, step, bbox);
+		}
+	}
+	else {
+		int4 *data = &pack.nodes[idx*BVH_QNODE_SIZE];
+		int4 c = data[6];
+		float4 *motion_data = &pack.motion_nodes[(idx*params.num_motion_steps + step)*BVH_QMOTION_NODE_SIZE];
+
+		for(int i = 0; i < 4; ++i) {
+			/* Empty children keep inverted bounds, same as in pack_inner(). */
+			BoundBox child_bbox = BoundBox::empty;
+
+			if(c[i] != 0) {
+				pack_motion_node((c[i] < 0)? -c[i]-1: c[i], (c[i] < 0), step, child_bbox);
+				bbox.grow(child_bbox);
+			}
+
+			motion_data[0][i] = child_bbox.min.x;
+			motion_data[1][i] = child_bbox.max.x;
+			motion_data[2][i] = child_bbox.min.y;
+			motion_data[3][i] = child_bbox.max.y;
+			motion_data[4][i] = child_bbox.min.z;
+			motion_data[5][i] = child_bbox.max.z;
+		}
 	}
 }
 
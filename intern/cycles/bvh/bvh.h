@@ -20,6 +20,7 @@
 
 #include "bvh_params.h"
 
+#include "util_string.h"
 #include "util_types.h"
 #include "util_vector.h"
 
@@ -29,6 +30,7 @@ class BVHNode;
 struct BVHStackEntry;
 class BVHParams;
 class BoundBox;
+class CacheData;
 class LeafNode;
 class Object;
 class Progress;
@@ -37,6 +39,8 @@ class Progress;
 #define BVH_NODE_LEAF_SIZE	1
 #define BVH_QNODE_SIZE	7
 #define BVH_QNODE_LEAF_SIZE	1
+#define BVH_MOTION_NODE_SIZE	3
+#define BVH_QMOTION_NODE_SIZE	6
 #define BVH_ALIGN		4096
 #define TRI_NODE_SIZE	3
 
@@ -63,11 +67,15 @@ struct PackedBVH {
 	array<int> prim_index;
 	/* mapping from BVH primitive index, to the object id of that primitive. */
 	array<int> prim_object;
+	/* child bounds of inner nodes for each motion step, laid out like the
+	 * bounds part of the nodes, empty when motion steps are not used */
+	array<float4> motion_nodes;
 
 	/* index of the root node. */
 	int root_index;
 
-	/* surface area heuristic, for building top level BVH */
+	/* surface area heuristic cost of the packed nodes right after the build,
+	 * normalized by the root area, used to detect degradation on refit */
 	float SAH;
 
 	PackedBVH()
@@ -75,6 +83,20 @@ struct PackedBVH {
 		root_index = 0;
 		SAH = 0.0f;
 	}
+
+	/* memory used by the packed arrays, in bytes */
+	size_t memory_size() const
+	{
+		return nodes.size()*sizeof(int4) +
+		       leaf_nodes.size()*sizeof(int4) +
+		       object_node.size()*sizeof(int) +
+		       tri_woop.size()*sizeof(float4) +
+		       prim_type.size()*sizeof(int) +
+		       prim_visibility.size()*sizeof(uint) +
+		       prim_index.size()*sizeof(int) +
+		       prim_object.size()*sizeof(int) +
+		       motion_nodes.size()*sizeof(float4);
+	}
 };
 
 /* BVH */
@@ -90,11 +112,19 @@ public:
 	virtual ~BVH() {}
 
 	void build(Progress& progress);
-	void refit(Progress& progress);
+	/* returns false when the refitted tree degraded too much and needs rebuild */
+	bool refit(Progress& progress);
 
 protected:
 	BVH(const BVHParams& params, const vector<Object*>& objects);
 
+	/* cache */
+	string cache_hash;
+
+	void cache_key(CacheData& key);
+	bool cache_read(CacheData& key);
+	void cache_write(CacheData& key);
+
 	/* triangles and strands*/
 	void pack_primitives();
 	void pack_triangle(int idx, float4 woop[3]);
@@ -102,9 +132,15 @@ protected:
 	/* merge instance BVH's */
 	void pack_instances(size_t nodes_size, size_t leaf_nodes_size);
 
+	/* per motion step node bounds */
+	void pack_motion_nodes();
+	void pack_motion_instances(size_t nsize, size_t nsize_motion);
+	void motion_step_bounds_grow(int prim, int step, BoundBox& bbox);
+
 	/* for subclasses to implement */
 	virtual void pack_nodes(const BVHNode *root) = 0;
-	virtual void refit_nodes() = 0;
+	virtual float refit_nodes() = 0;
+	virtual void pack_motion_node(int idx, bool leaf, int step, BoundBox& bbox) = 0;
 };
 
 /* Regular BVH
@@ -124,8 +160,11 @@ protected:
 	void pack_node(int idx, const BoundBox& b0, const BoundBox& b1, int c0, int c1, uint visibility0, uint visibility1);
 
 	/* refit */
-	void refit_nodes();
-	void refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility);
+	float refit_nodes();
+	void refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility, float& sah);
+
+	/* motion */
+	void pack_motion_node(int idx, bool leaf, int step, BoundBox& bbox);
 };
 
 /* QBVH
@@ -144,8 +183,11 @@ protected:
 	void pack_inner(const BVHStackEntry& e, const BVHStackEntry *en, int num);
 
 	/* refit */
-	void refit_nodes();
-	void refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility);
+	float refit_nodes();
+	void refit_node(int idx, bool leaf, BoundBox& bbox, uint& visibility, float& sah);
+
+	/* motion */
+	void pack_motion_node(int idx, bool leaf, int step, BoundBox& bbox);
 };
 
 CCL_NAMESPACE_END
@@ -26,6 +26,8 @@
 #include "scene.h"
 #include "curves.h"
 
+#include "util_algorithm.h"
+#include "util_atomic.h"
 #include "util_debug.h"
 #include "util_foreach.h"
 #include "util_logging.h"
@@ -62,6 +64,40 @@ public:
 	BVHObjectBinning range;
 };
 
+/* BVH Spatial Split Build Task
+ *
+ * Every task owns a copy of the references of its subtree, so spatial splits
+ * can insert duplicated references without touching arrays of other threads,
+ * plus its own scratch storage for the splitter. */
+
+class BVHSpatialSplitBuildTask : public Task {
+public:
+	BVHSpatialSplitBuildTask(BVHBuild *build,
+	                         InnerNode *node,
+	                         int child,
+	                         const BVHRange& range_,
+	                         const vector<BVHReference>& references_,
+	                         int level)
+	: range(range_),
+	  references(references_.begin() + range_.start(),
+	             references_.begin() + range_.end())
+	{
+		range.set_start(0);
+		run = function_bind(&BVHBuild::thread_build_spatial_split_node,
+		                    build,
+		                    node,
+		                    child,
+		                    &range,
+		                    &references,
+		                    level,
+		                    &storage);
+	}
+
+	BVHRange range;
+	vector<BVHReference> references;
+	BVHSpatialStorage storage;
+};
+
 /* Constructor / Destructor */
 
 BVHBuild::BVHBuild(const vector<Object*>& objects_,
@@ -79,6 +115,7 @@ BVHBuild::BVHBuild(const vector<Object*>& objects_,
    progress_start_time(0.0)
 {
 	spatial_min_overlap = 0.0f;
+	spatial_free_index = 0;
 }
 
 BVHBuild::~BVHBuild()
@@ -244,8 +281,7 @@ BVHNode* BVHBuild::run()
 	}
 
 	spatial_min_overlap = root.bounds().safe_area() * params.spatial_split_alpha;
-	spatial_right_bounds.clear();
-	spatial_right_bounds.resize(max(root.size(), (int)BVHParams::NUM_SPATIAL_BINS) - 1);
+	spatial_free_index = 0;
 
 	/* init progress updates */
 	double build_start_time;
@@ -262,8 +298,10 @@ BVHNode* BVHBuild::run()
 	BVHNode *rootnode;
 
 	if(params.use_spatial_split) {
-		/* singlethreaded spatial split build */
-		rootnode = build_node(root, 0);
+		/* multithreaded spatial split build */
+		BVHSpatialStorage storage;
+		rootnode = build_node(root, &references, 0, &storage);
+		task_pool.wait_work();
 	}
 	else {
 		/* multithreaded binning build */
@@ -283,6 +321,10 @@ BVHNode* BVHBuild::run()
 			/*rotate(rootnode, 4, 5);*/
 			rootnode->update_visibility();
 		}
+		else {
+			reorder_leaf_primitives(rootnode);
+			rootnode->update_visibility();
+		}
 		if(rootnode != NULL) {
 			VLOG(1) << "BVH build statistics:\n"
 			        << "  Build time: " << time_dt() - build_start_time << "\n"
@@ -336,7 +378,78 @@ void BVHBuild::thread_build_node(InnerNode *inner, int child, BVHObjectBinning *
 	}
 }
 
-bool BVHBuild::range_within_max_leaf_size(const BVHRange& range)
+void BVHBuild::thread_build_spatial_split_node(InnerNode *inner,
+                                               int child,
+                                               BVHRange *range,
+                                               vector<BVHReference> *references,
+                                               int level,
+                                               BVHSpatialStorage *storage)
+{
+	if(progress.get_cancel()) {
+		return;
+	}
+
+	/* build nodes */
+	BVHNode *node = build_node(*range, references, level, storage);
+
+	/* set child in inner node */
+	inner->children[child] = node;
+}
+
+void BVHBuild::reorder_leaf_primitives(BVHNode *root)
+{
+	/* Threads create leaves in no particular order, so pack the primitives
+	 * again in depth-first order. This gives exactly the same arrays as the
+	 * single threaded build, independent of the scheduling.
+	 */
+	array<int> new_prim_type(spatial_free_index);
+	array<int> new_prim_index(spatial_free_index);
+	array<int> new_prim_object(spatial_free_index);
+	int num_prims = 0;
+
+	vector<BVHNode*> stack;
+	stack.push_back(root);
+
+	while(!stack.empty()) {
+		BVHNode *node = stack.back();
+		stack.pop_back();
+
+		if(node->is_leaf()) {
+			LeafNode *leaf = (LeafNode*)node;
+			const int num = leaf->num_triangles();
+
+			for(int i = 0; i < num; ++i) {
+				new_prim_type[num_prims + i] = prim_type[leaf->m_lo + i];
+				new_prim_index[num_prims + i] = prim_index[leaf->m_lo + i];
+				new_prim_object[num_prims + i] = prim_object[leaf->m_lo + i];
+			}
+
+			leaf->m_lo = num_prims;
+			leaf->m_hi = num_prims + num;
+			num_prims += num;
+		}
+		else {
+			InnerNode *inner = (InnerNode*)node;
+			stack.push_back(inner->children[1]);
+			stack.push_back(inner->children[0]);
+		}
+	}
+
+	assert(num_prims == spatial_free_index);
+
+	prim_type.resize(num_prims);
+	prim_index.resize(num_prims);
+	prim_object.resize(num_prims);
+
+	for(int i = 0; i < num_prims; ++i) {
+		prim_type[i] = new_prim_type[i];
+		prim_index[i] = new_prim_index[i];
+		prim_object[i] = new_prim_object[i];
+	}
+}
+
+bool BVHBuild::range_within_max_leaf_size(const BVHRange& range,
+                                          const vector<BVHReference>& references) const
 {
 	size_t size = range.size();
 	size_t max_leaf_size = max(params.max_triangle_leaf_size, params.max_curve_leaf_size);
@@ -349,7 +462,7 @@ bool BVHBuild::range_within_max_leaf_size(const BVHRange& range)
 	size_t num_motion_curves = 0;
 
 	for(int i = 0; i < size; i++) {
-		BVHReference& ref = references[range.start() + i];
+		const BVHReference& ref = references[range.start() + i];
 
 		if(ref.prim_type() & PRIMITIVE_CURVE)
 			num_curves++;
@@ -375,8 +488,11 @@ BVHNode* BVHBuild::build_node(const BVHObjectBinning& range, int level)
 	 * visibility tests, since object instances do not check visibility flag */
 	if(!(range.size() > 0 && params.top_level && level == 0)) {
 		/* make leaf node when threshold reached or SAH tells us */
-		if(params.small_enough_for_leaf(size, level) || (range_within_max_leaf_size(range) && leafSAH < splitSAH))
-			return create_leaf_node(range);
+		if(params.small_enough_for_leaf(size, level) ||
+		   (range_within_max_leaf_size(range, references) && leafSAH < splitSAH))
+		{
+			return create_leaf_node(range, references);
+		}
 	}
 
 	/* perform split */
@@ -404,48 +520,57 @@ BVHNode* BVHBuild::build_node(const BVHObjectBinning& range, int level)
 	return inner;
 }
 
-/* single threaded spatial split builder */
-BVHNode* BVHBuild::build_node(const BVHRange& range, int level)
+/* multithreaded spatial split builder */
+BVHNode* BVHBuild::build_node(const BVHRange& range,
+                              vector<BVHReference> *references,
+                              int level,
+                              BVHSpatialStorage *storage)
 {
-	/* progress update */
-	progress_update();
 	if(progress.get_cancel())
 		return NULL;
 
 	/* small enough or too deep => create leaf. */
 	if(!(range.size() > 0 && params.top_level && level == 0)) {
-		if(params.small_enough_for_leaf(range.size(), level)) {
-			progress_count += range.size();
-			return create_leaf_node(range);
-		}
+		if(params.small_enough_for_leaf(range.size(), level))
+			return create_leaf_node(range, *references);
 	}
 
 	/* splitting test */
-	BVHMixedSplit split(this, range, level);
+	BVHMixedSplit split(this, storage, range, references, level);
 
 	if(!(range.size() > 0 && params.top_level && level == 0)) {
-		if(split.no_split) {
-			progress_count += range.size();
-			return create_leaf_node(range);
-		}
+		if(split.no_split)
+			return create_leaf_node(range, *references);
 	}
 	
 	/* do split */
 	BVHRange left, right;
 	split.split(this, left, right, range);
 
-	progress_total += left.size() + right.size() - range.size();
-	size_t total = progress_total;
+	atomic_add_z(&progress_total, left.size() + right.size() - range.size());
 
-	/* left node */
-	BVHNode *leftnode = build_node(left, level + 1);
+	if(range.size() < THREAD_TASK_SIZE) {
+		/* local build */
+		size_t num_references = references->size();
 
-	/* right node (modify start for splits) */
-	right.set_start(right.start() + progress_total - total);
-	BVHNode *rightnode = build_node(right, level + 1);
+		/* left node */
+		BVHNode *leftnode = build_node(left, references, level + 1, storage);
+
+		/* right node (modify start for splits) */
+		right.set_start(right.start() + references->size() - num_references);
+		BVHNode *rightnode = build_node(right, references, level + 1, storage);
+
+		/* inner node */
+		return new InnerNode(range.bounds(), leftnode, rightnode);
+	}
 
-	/* inner node */
-	return new InnerNode(range.bounds(), leftnode, rightnode);
+	/* threaded build, tasks get their own copy of the references */
+	InnerNode *inner = new InnerNode(range.bounds());
+
+	task_pool.push(new BVHSpatialSplitBuildTask(this, inner, 0, left, *references, level + 1), true);
+	task_pool.push(new BVHSpatialSplitBuildTask(this, inner, 1, right, *references, level + 1), true);
+
+	return inner;
 }
 
 /* Create Nodes */
@@ -494,7 +619,8 @@ BVHNode *BVHBuild::create_primitive_leaf_node(const int *p_type,
 	return new LeafNode(bounds, visibility, start, start + num);
 }
 
-BVHNode* BVHBuild::create_leaf_node(const BVHRange& range)
+BVHNode* BVHBuild::create_leaf_node(const BVHRange& range,
+                                    vector<BVHReference>& references)
 {
 	/* TODO(sergey): Consider writing own allocator which would
 	 * not do heap allocation if number of elements is relatively small.
@@ -530,21 +656,33 @@ BVHNode* BVHBuild::create_leaf_node(const BVHRange& range)
 		}
 	}
 
-	/* Extend an array when needed. */
-	if(prim_type.size() < range.end()) {
-		assert(params.use_spatial_split);
-		prim_type.reserve(references.size());
-		prim_index.reserve(references.size());
-		prim_object.reserve(references.size());
-		prim_type.resize(range.end());
-		prim_index.resize(range.end());
-		prim_object.resize(range.end());
+	int start = range.start();
+
+	if(params.use_spatial_split) {
+		/* Leaves of the spatial split builder are created by multiple threads,
+		 * take the next free part of the primitive arrays. The lock is held
+		 * until all primitives are stored since the arrays might get extended.
+		 */
+		build_mutex.lock();
+
+		start = spatial_free_index;
+		spatial_free_index += range.size();
+
+		/* Extend an array when needed. */
+		if(prim_type.size() < spatial_free_index) {
+			size_t reserve = max(spatial_free_index, prim_type.size() + prim_type.size() / 2);
+			prim_type.reserve(reserve);
+			prim_index.reserve(reserve);
+			prim_object.reserve(reserve);
+			prim_type.resize(spatial_free_index);
+			prim_index.resize(spatial_free_index);
+			prim_object.resize(spatial_free_index);
+		}
 	}
 
 	/* Create leaf nodes for every existing primitive. */
 	BVHNode *leaves[PRIMITIVE_NUM_TOTAL + 1] = {NULL};
 	int num_leaves = 0;
-	int start = range.start();
 	for(int i = 0; i < PRIMITIVE_NUM_TOTAL; ++i) {
 		int num = (int)p_type[i].size();
 		if(num != 0) {
@@ -572,6 +710,13 @@ BVHNode* BVHBuild::create_leaf_node(const BVHRange& range)
 		++num_leaves;
 	}
 
+	if(params.use_spatial_split) {
+		progress_count += range.size();
+		progress_update();
+
+		build_mutex.unlock();
+	}
+
 	if(num_leaves == 1) {
 		/* Simplest case: single leaf, just return it.
 		 * In all the rest cases we'll be creating intermediate inner node with
@@ -57,6 +57,7 @@ protected:
 	friend class BVHObjectSplit;
 	friend class BVHSpatialSplit;
 	friend class BVHBuildTask;
+	friend class BVHSpatialSplitBuildTask;
 
 	/* adding references */
 	void add_reference_mesh(BoundBox& root, BoundBox& center, Mesh *mesh, int i);
@@ -64,9 +65,13 @@ protected:
 	void add_references(BVHRange& root);
 
 	/* building */
-	BVHNode *build_node(const BVHRange& range, int level);
+	BVHNode *build_node(const BVHRange& range,
+	                    vector<BVHReference> *references,
+	                    int level,
+	                    BVHSpatialStorage *storage);
 	BVHNode *build_node(const BVHObjectBinning& range, int level);
-	BVHNode *create_leaf_node(const BVHRange& range);
+	BVHNode *create_leaf_node(const BVHRange& range,
+	                          vector<BVHReference>& references);
 	BVHNode *create_object_leaf_nodes(const BVHReference *ref, int start, int num);
 
 	/* Leaf node type splitting. */
@@ -78,13 +83,23 @@ protected:
 	                                    int start,
 	                                    int nun);
 
-	bool range_within_max_leaf_size(const BVHRange& range);
+	bool range_within_max_leaf_size(const BVHRange& range,
+	                                const vector<BVHReference>& references) const;
 
 	/* threads */
 	enum { THREAD_TASK_SIZE = 4096 };
 	void thread_build_node(InnerNode *node, int child, BVHObjectBinning *range, int level);
+	void thread_build_spatial_split_node(InnerNode *node,
+	                                     int child,
+	                                     BVHRange *range,
+	                                     vector<BVHReference> *references,
+	                                     int level,
+	                                     BVHSpatialStorage *storage);
 	thread_mutex build_mutex;
 
+	/* deterministic primitive order for the threaded spatial split build */
+	void reorder_leaf_primitives(BVHNode *root);
+
 	/* progress */
 	void progress_update();
 
@@ -114,8 +129,10 @@ protected:
 
 	/* spatial splitting */
 	float spatial_min_overlap;
-	vector<BoundBox> spatial_right_bounds;
-	BVHSpatialBin spatial_bins[3][BVHParams::NUM_SPATIAL_BINS];
+
+	/* next free index in the primitive arrays, used by the spatial split
+	 * builder where leaves are created in arbitrary order by the threads */
+	size_t spatial_free_index;
 
 	/* threads */
 	TaskPool task_pool;
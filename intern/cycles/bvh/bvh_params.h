@@ -19,6 +19,7 @@
 #define __BVH_PARAMS_H__
 
 #include "util_boundbox.h"
+#include "util_vector.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -46,6 +47,17 @@ public:
 	/* QBVH */
 	bool use_qbvh;
 
+	/* read and write packed BVH from the disk cache */
+	bool use_cache;
+
+	/* maximum allowed growth of the SAH cost when refitting, relative to the
+	 * cost right after the build, before the tree is rebuilt */
+	float refit_max_sah_growth;
+
+	/* number of deformation motion steps to store node bounds for, so motion
+	 * blur traversal can interpolate them at the ray time, 0 to disable */
+	int num_motion_steps;
+
 	/* fixed parameters */
 	enum {
 		MAX_DEPTH = 64,
@@ -69,6 +81,9 @@ public:
 
 		top_level = false;
 		use_qbvh = false;
+		use_cache = false;
+		refit_max_sah_growth = 1.5f;
+		num_motion_steps = 0;
 	}
 
 	/* SAH costs */
@@ -175,6 +190,25 @@ struct BVHSpatialBin
 	}
 };
 
+/* BVH Spatial Storage
+ *
+ * Per-thread storage for the spatial splitter, so multiple subtrees can be
+ * split in parallel without sharing the scratch data. It is pre-allocated by
+ * the build task and reused for all nodes of its subtree. */
+
+struct BVHSpatialStorage
+{
+	/* Accumulated bounds when sweeping from right to left. */
+	vector<BoundBox> right_bounds;
+
+	/* Bins used for histogram when selecting best split plane. */
+	BVHSpatialBin bins[3][BVHParams::NUM_SPATIAL_BINS];
+
+	/* Temporary storage for the new references, used by the spatial split to
+	 * collect duplicates before inserting them into the references array. */
+	vector<BVHReference> new_references;
+};
+
 CCL_NAMESPACE_END
 
 #endif /* __BVH_PARAMS_H__ */
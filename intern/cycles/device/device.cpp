@@ -51,6 +51,12 @@ std::ostream& operator <<(std::ostream &os,
 	   << (requested_features.use_camera_motion ? "True" : "False")  << std::endl;
 	os << "Use Baking: "
 	   << (requested_features.use_baking ? "True" : "False")  << std::endl;
+	os << "Use Subsurface: "
+	   << (requested_features.use_subsurface ? "True" : "False")  << std::endl;
+	os << "Use Volume: "
+	   << (requested_features.use_volume ? "True" : "False")  << std::endl;
+	os << "Use Branched Integrator: "
+	   << (requested_features.use_integrator_branched ? "True" : "False")  << std::endl;
 	return os;
 }
 
@@ -52,6 +52,7 @@
 #include "util_progress.h"
 #include "util_system.h"
 #include "util_thread.h"
+#include "util_time.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -61,6 +62,9 @@ public:
 	TaskPool task_pool;
 	KernelGlobals kernel_globals;
 
+	/* guards merging of per thread profiling and light statistics into stats */
+	thread_mutex stats_mutex;
+
 #ifdef WITH_OSL
 	OSLGlobals osl_globals;
 #endif
@@ -68,6 +72,9 @@ public:
 	CPUDevice(DeviceInfo& info, Stats &stats, bool background)
 	: Device(info, stats, background)
 	{
+		/* image lookups rely on unused texture slots being NULL */
+		memset(&kernel_globals, 0, sizeof(kernel_globals));
+
 #ifdef WITH_OSL
 		kernel_globals.osl = &osl_globals;
 #endif
@@ -166,10 +173,26 @@ public:
 			thread_path_trace(*task);
 		else if(task->type == DeviceTask::FILM_CONVERT)
 			thread_film_convert(*task);
+		else if(task->type == DeviceTask::SHADER && task->acquire_shader_tile)
+			thread_shader_tiles(*task);
 		else if(task->type == DeviceTask::SHADER)
 			thread_shader(*task);
 	}
 
+	void thread_shader_tiles(DeviceTask& task)
+	{
+		DeviceTask tile = task;
+
+		/* keep evaluating tiles until done */
+		while(task.acquire_shader_tile(this, tile)) {
+			thread_shader(tile);
+			task.release_shader_tile(this, tile);
+
+			if(task.get_cancel() || task_pool.canceled())
+				break;
+		}
+	}
+
 	class CPUDeviceTask : public DeviceTask {
 	public:
 		CPUDeviceTask(CPUDevice *device, DeviceTask& task)
@@ -179,6 +202,111 @@ public:
 		}
 	};
 
+	/* Adaptive sampling: mark pixels of the tile whose error estimate is
+	 * below the threshold as converged, so the kernel skips them in the
+	 * following samples. Returns true when the whole tile has converged. */
+	bool adaptive_sampling_filter(KernelGlobals *kg, RenderTile& tile, int sample)
+	{
+		float *render_buffer = (float*)tile.buffer;
+		int pass_stride = kg->__data.film.pass_stride;
+		int aux_offset = kg->__data.film.pass_adaptive_aux_buffer;
+		float threshold = kg->__data.integrator.adaptive_threshold;
+
+		/* per pixel error estimate, from "A Hierarchical Automatic Stopping
+		 * Condition for Monte Carlo Global Illumination" by Dammertz et al. */
+		vector<bool> below_threshold(tile.w*tile.h, false);
+
+		for(int y = 0; y < tile.h; y++) {
+			for(int x = 0; x < tile.w; x++) {
+				int index = tile.offset + tile.x + x + (tile.y + y)*tile.stride;
+				float *buffer = render_buffer + index*pass_stride;
+				float *aux = buffer + aux_offset;
+
+				if(aux[3] != 0.0f) {
+					below_threshold[x + y*tile.w] = true;
+					continue;
+				}
+
+				float I = buffer[0] + buffer[1] + buffer[2];
+				float error = fabsf(buffer[0] - aux[0]) +
+				              fabsf(buffer[1] - aux[1]) +
+				              fabsf(buffer[2] - aux[2]);
+				error /= sqrtf((float)sample * max(I, 0.0f)) + 1e-4f * sample;
+
+				below_threshold[x + y*tile.w] = (error < threshold);
+			}
+		}
+
+		/* only consider a pixel converged when its neighbours are as well,
+		 * which avoids isolated pixels stopping on a lucky estimate */
+		bool tile_converged = true;
+
+		for(int y = 0; y < tile.h; y++) {
+			for(int x = 0; x < tile.w; x++) {
+				int index = tile.offset + tile.x + x + (tile.y + y)*tile.stride;
+				float *aux = render_buffer + index*pass_stride + aux_offset;
+
+				if(aux[3] != 0.0f)
+					continue;
+
+				bool converged = true;
+
+				for(int dy = max(y - 1, 0); dy <= min(y + 1, tile.h - 1) && converged; dy++)
+					for(int dx = max(x - 1, 0); dx <= min(x + 1, tile.w - 1); dx++)
+						if(!below_threshold[dx + dy*tile.w]) {
+							converged = false;
+							break;
+						}
+
+				if(converged)
+					aux[3] = (float)sample;
+				else
+					tile_converged = false;
+			}
+		}
+
+		return tile_converged;
+	}
+
+	/* Converged pixels accumulated fewer samples than the rest of the tile,
+	 * scale them up so all pixels can be normalized by the tile sample count. */
+	void adaptive_sampling_post(KernelGlobals *kg, RenderTile& tile)
+	{
+		float *render_buffer = (float*)tile.buffer;
+		const KernelFilm& kfilm = kg->__data.film;
+		int pass_stride = kfilm.pass_stride;
+
+		for(int y = tile.y; y < tile.y + tile.h; y++) {
+			for(int x = tile.x; x < tile.x + tile.w; x++) {
+				float *buffer = render_buffer + (tile.offset + x + y*tile.stride)*pass_stride;
+				float *aux = buffer + kfilm.pass_adaptive_aux_buffer;
+				float pixel_samples = aux[3];
+
+				if(pixel_samples == 0.0f || pixel_samples >= (float)tile.sample)
+					continue;
+
+				float scale = (float)tile.sample / pixel_samples;
+
+				/* passes written only once are not averaged */
+				float depth = buffer[kfilm.pass_depth];
+				float object_id = buffer[kfilm.pass_object_id];
+				float material_id = buffer[kfilm.pass_material_id];
+
+				for(int i = 0; i < pass_stride; i++)
+					buffer[i] *= scale;
+
+				if(kfilm.pass_flag & PASS_DEPTH)
+					buffer[kfilm.pass_depth] = depth;
+				if(kfilm.pass_flag & PASS_OBJECT_ID)
+					buffer[kfilm.pass_object_id] = object_id;
+				if(kfilm.pass_flag & PASS_MATERIAL_ID)
+					buffer[kfilm.pass_material_id] = material_id;
+
+				aux[3] = (float)tile.sample;
+			}
+		}
+	}
+
 	void thread_path_trace(DeviceTask& task)
 	{
 		if(task_pool.canceled()) {
@@ -192,6 +320,26 @@ public:
 		OSLShader::thread_init(&kg, &kernel_globals, &osl_globals);
 #endif
 
+#ifdef __KERNEL_DEBUG__
+		ProfilingStats profiling;
+		double profiling_start_time = 0.0;
+
+		if(stats.use_profiling) {
+			/* two kernel shader ids per shader, with and without bump */
+			profiling.reset(kg.__shader_flag.width / 4);
+			profiling.num_threads = 1;
+			profiling_start_time = time_dt();
+			kg.profiling = &profiling;
+		}
+#endif
+
+		LightStats light_stats;
+
+		if(stats.use_light_stats) {
+			light_stats.reset(kg.__data.integrator.num_all_lights);
+			kg.light_stats = &light_stats;
+		}
+
 		RenderTile tile;
 
 		void(*path_trace_kernel)(KernelGlobals*, float*, unsigned int*, int, int, int, int, int);
@@ -223,6 +371,10 @@ public:
 #endif
 			path_trace_kernel = kernel_cpu_path_trace;
 		
+		bool use_adaptive_sampling = (kg.__data.film.pass_flag & PASS_ADAPTIVE_AUX_BUFFER) != 0;
+		int adaptive_min_samples = kg.__data.integrator.adaptive_min_samples;
+		int adaptive_step = kg.__data.integrator.adaptive_step;
+
 		while(task.acquire_tile(this, tile)) {
 			float *render_buffer = (float*)tile.buffer;
 			uint *rng_state = (uint*)tile.rng_state;
@@ -245,8 +397,26 @@ public:
 				tile.sample = sample + 1;
 
 				task.update_progress(&tile);
+
+				if(use_adaptive_sampling &&
+				   tile.sample >= adaptive_min_samples &&
+				   tile.sample % adaptive_step == 0 &&
+				   tile.sample < end_sample)
+				{
+					if(adaptive_sampling_filter(&kg, tile, tile.sample)) {
+						/* whole tile converged, account the skipped samples */
+						if(task.update_progress_sample) {
+							for(int i = tile.sample; i < end_sample; i++)
+								task.update_progress_sample();
+						}
+						break;
+					}
+				}
 			}
 
+			if(use_adaptive_sampling)
+				adaptive_sampling_post(&kg, tile);
+
 			task.release_tile(tile);
 
 			if(task_pool.canceled()) {
@@ -255,6 +425,20 @@ public:
 			}
 		}
 
+#ifdef __KERNEL_DEBUG__
+		if(kg.profiling) {
+			profiling.time = time_dt() - profiling_start_time;
+
+			thread_scoped_lock lock(stats_mutex);
+			stats.profiling.add(profiling);
+		}
+#endif
+
+		if(kg.light_stats) {
+			thread_scoped_lock lock(stats_mutex);
+			stats.light.add(light_stats);
+		}
+
 #ifdef WITH_OSL
 		OSLShader::thread_free(&kg);
 #endif
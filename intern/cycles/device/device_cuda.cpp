@@ -35,13 +35,16 @@
 #include "util_types.h"
 #include "util_time.h"
 
-/* use feature-adaptive kernel compilation.
- * Requires CUDA toolkit to be installed and currently only works on Linux.
- */
-/* #define KERNEL_USE_ADAPTIVE */
-
 CCL_NAMESPACE_BEGIN
 
+/* Use feature-adaptive kernel compilation, the kernel is specialized for the
+ * features used by the scene. Requires the CUDA toolkit to be installed, so
+ * it is enabled with CYCLES_CUDA_ADAPTIVE_COMPILE. */
+static bool cuda_use_adaptive_compilation()
+{
+	return (getenv("CYCLES_CUDA_ADAPTIVE_COMPILE") != NULL);
+}
+
 class CUDADevice : public Device
 {
 public:
@@ -54,6 +57,13 @@ public:
 	int cuDevArchitecture;
 	bool first_error;
 	bool use_texture_storage;
+	bool can_map_host;
+
+	/* Read only buffers that no longer fit in device memory are placed in
+	 * pinned host memory mapped into the device address space. Kernels read
+	 * them over the bus, which is slow but lets the render finish, while
+	 * buffers allocated before running out of memory stay on the device. */
+	map<device_ptr, void*> mapped_host_mem_map;
 
 	struct PixelMem {
 		GLuint cuPBO;
@@ -146,6 +156,7 @@ public:
 		cuDevId = info.num;
 		cuDevice = 0;
 		cuContext = 0;
+		can_map_host = false;
 
 		/* intialize */
 		if(cuda_error(cuInit(0)))
@@ -156,15 +167,23 @@ public:
 			return;
 
 		CUresult result;
+		int can_map = 0;
+		unsigned int ctx_flags = 0;
+
+		cuDeviceGetAttribute(&can_map, CU_DEVICE_ATTRIBUTE_CAN_MAP_HOST_MEMORY, cuDevice);
+		if(can_map) {
+			ctx_flags |= CU_CTX_MAP_HOST;
+			can_map_host = true;
+		}
 
 		if(background) {
-			result = cuCtxCreate(&cuContext, 0, cuDevice);
+			result = cuCtxCreate(&cuContext, ctx_flags, cuDevice);
 		}
 		else {
-			result = cuGLCtxCreate(&cuContext, 0, cuDevice);
+			result = cuGLCtxCreate(&cuContext, ctx_flags, cuDevice);
 
 			if(result != CUDA_SUCCESS) {
-				result = cuCtxCreate(&cuContext, 0, cuDevice);
+				result = cuCtxCreate(&cuContext, ctx_flags, cuDevice);
 				background = true;
 			}
 		}
@@ -211,35 +230,40 @@ public:
 		int major, minor;
 		cuDeviceComputeCapability(&major, &minor, cuDevId);
 		string cubin;
+		const bool use_adaptive_compilation = cuda_use_adaptive_compilation();
 
-		/* attempt to use kernel provided with blender */
-		if(requested_features.experimental)
-			cubin = path_get(string_printf("lib/kernel_experimental_sm_%d%d.cubin", major, minor));
-		else
-			cubin = path_get(string_printf("lib/kernel_sm_%d%d.cubin", major, minor));
-		VLOG(1) << "Testing for pre-compiled kernel " << cubin;
-		if(path_exists(cubin)) {
-			VLOG(1) << "Using precompiled kernel";
-			return cubin;
+		/* attempt to use kernel provided with blender, these are compiled
+		 * with all features so they are skipped for adaptive compilation */
+		if(!use_adaptive_compilation) {
+			if(requested_features.experimental)
+				cubin = path_get(string_printf("lib/kernel_experimental_sm_%d%d.cubin", major, minor));
+			else
+				cubin = path_get(string_printf("lib/kernel_sm_%d%d.cubin", major, minor));
+			VLOG(1) << "Testing for pre-compiled kernel " << cubin;
+			if(path_exists(cubin)) {
+				VLOG(1) << "Using precompiled kernel";
+				return cubin;
+			}
 		}
 
 		/* not found, try to use locally compiled kernel */
 		string kernel_path = path_get("kernel");
 		string md5 = path_files_md5_hash(kernel_path);
 
-#ifdef KERNEL_USE_ADAPTIVE
-		string feature_build_options = requested_features.get_build_options();
-		string device_md5 = util_md5_string(feature_build_options);
-		cubin = string_printf("cycles_kernel_%s_sm%d%d_%s.cubin",
-		                      device_md5.c_str(),
-		                      major, minor,
-		                      md5.c_str());
-#else
-		if(requested_features.experimental)
+		/* specialized kernels are cached per feature set */
+		string feature_build_options;
+		if(use_adaptive_compilation) {
+			feature_build_options = requested_features.get_build_options();
+			string device_md5 = util_md5_string(feature_build_options);
+			cubin = string_printf("cycles_kernel_%s_sm%d%d_%s.cubin",
+			                      device_md5.c_str(),
+			                      major, minor,
+			                      md5.c_str());
+		}
+		else if(requested_features.experimental)
 			cubin = string_printf("cycles_kernel_experimental_sm%d%d_%s.cubin", major, minor, md5.c_str());
 		else
 			cubin = string_printf("cycles_kernel_sm%d%d_%s.cubin", major, minor, md5.c_str());
-#endif
 
 		cubin = path_user_get(path_join("cache", cubin));
 		VLOG(1) << "Testing for locally compiled kernel " << cubin;
@@ -250,7 +274,7 @@ public:
 		}
 
 #ifdef _WIN32
-		if(have_precompiled_kernels()) {
+		if(!use_adaptive_compilation && have_precompiled_kernels()) {
 			if(major < 2)
 				cuda_error_message(string_printf("CUDA device requires compute capability 2.0 or up, found %d.%d. Your GPU is not supported.", major, minor));
 			else
@@ -296,13 +320,12 @@ public:
 			"-DNVCC -D__KERNEL_CUDA_VERSION__=%d",
 			nvcc, major, minor, machine, kernel.c_str(), cubin.c_str(), include.c_str(), cuda_version);
 
-#ifdef KERNEL_USE_ADAPTIVE
-		command += " " + feature_build_options;
-#else
-		if(requested_features.experimental) {
+		if(use_adaptive_compilation) {
+			command += " " + feature_build_options;
+		}
+		else if(requested_features.experimental) {
 			command += " -D__KERNEL_EXPERIMENTAL__";
 		}
-#endif
 
 		const char* extra_cflags = getenv("CYCLES_CUDA_EXTRA_CFLAGS");
 		if(extra_cflags) {
@@ -366,23 +389,70 @@ public:
 		return (result == CUDA_SUCCESS);
 	}
 
-	void mem_alloc(device_memory& mem, MemoryType /*type*/)
+	bool mem_alloc_mapped_host(CUdeviceptr *device_pointer, size_t size)
+	{
+		void *host_pointer = NULL;
+
+		/* write combined since the host only ever writes to these */
+		if(cuMemHostAlloc(&host_pointer, size, CU_MEMHOSTALLOC_DEVICEMAP|CU_MEMHOSTALLOC_WRITECOMBINED) != CUDA_SUCCESS)
+			return false;
+
+		if(cuMemHostGetDevicePointer(device_pointer, host_pointer, 0) != CUDA_SUCCESS) {
+			cuMemFreeHost(host_pointer);
+			return false;
+		}
+
+		mapped_host_mem_map[(device_ptr)*device_pointer] = host_pointer;
+		return true;
+	}
+
+	void *mem_mapped_host_pointer(device_ptr device_pointer)
+	{
+		map<device_ptr, void*>::iterator it = mapped_host_mem_map.find(device_pointer);
+		return (it != mapped_host_mem_map.end())? it->second: NULL;
+	}
+
+	void mem_alloc(device_memory& mem, MemoryType type)
 	{
 		cuda_push_context();
-		CUdeviceptr device_pointer;
+		CUdeviceptr device_pointer = 0;
 		size_t size = mem.memory_size();
-		cuda_assert(cuMemAlloc(&device_pointer, size));
+		CUresult result = cuMemAlloc(&device_pointer, size);
+
+		/* texture references can not be bound to mapped memory, so only
+		 * buffers accessed through global pointers can fall back to it */
+		if(result == CUDA_ERROR_OUT_OF_MEMORY && type == MEM_READ_ONLY &&
+		   can_map_host && !use_texture_storage)
+		{
+			if(mem_alloc_mapped_host(&device_pointer, size)) {
+				VLOG(1) << "Out of device memory, using " << string_human_readable_size(size).c_str()
+				        << " of mapped host memory.";
+				result = CUDA_SUCCESS;
+			}
+		}
+
+		cuda_error_(result, "cuMemAlloc(&device_pointer, size)");
+
 		mem.device_pointer = (device_ptr)device_pointer;
-		mem.device_size = size;
-		stats.mem_alloc(size);
+		mem.device_size = (device_pointer)? size: 0;
+		stats.mem_alloc(mem.device_size);
 		cuda_pop_context();
 	}
 
 	void mem_copy_to(device_memory& mem)
 	{
+		if(!mem.device_pointer)
+			return;
+
+		void *host_pointer = mem_mapped_host_pointer(mem.device_pointer);
+
+		if(host_pointer) {
+			memcpy(host_pointer, (void*)mem.data_pointer, mem.memory_size());
+			return;
+		}
+
 		cuda_push_context();
-		if(mem.device_pointer)
-			cuda_assert(cuMemcpyHtoD(cuda_device_ptr(mem.device_pointer), (void*)mem.data_pointer, mem.memory_size()));
+		cuda_assert(cuMemcpyHtoD(cuda_device_ptr(mem.device_pointer), (void*)mem.data_pointer, mem.memory_size()));
 		cuda_pop_context();
 	}
 
@@ -406,6 +476,13 @@ public:
 	{
 		memset((void*)mem.data_pointer, 0, mem.memory_size());
 
+		void *host_pointer = mem_mapped_host_pointer(mem.device_pointer);
+
+		if(host_pointer) {
+			memset(host_pointer, 0, mem.memory_size());
+			return;
+		}
+
 		cuda_push_context();
 		if(mem.device_pointer)
 			cuda_assert(cuMemsetD8(cuda_device_ptr(mem.device_pointer), 0, mem.memory_size()));
@@ -415,8 +492,16 @@ public:
 	void mem_free(device_memory& mem)
 	{
 		if(mem.device_pointer) {
+			void *host_pointer = mem_mapped_host_pointer(mem.device_pointer);
+
 			cuda_push_context();
-			cuda_assert(cuMemFree(cuda_device_ptr(mem.device_pointer)));
+			if(host_pointer) {
+				cuda_assert(cuMemFreeHost(host_pointer));
+				mapped_host_mem_map.erase(mem.device_pointer);
+			}
+			else {
+				cuda_assert(cuMemFree(cuda_device_ptr(mem.device_pointer)));
+			}
 			cuda_pop_context();
 
 			mem.device_pointer = 0;
@@ -1049,6 +1134,23 @@ public:
 				task->release_tile(tile);
 			}
 		}
+		else if(task->type == DeviceTask::SHADER && task->acquire_shader_tile) {
+			DeviceTask tile = *task;
+
+			/* keep evaluating tiles until done */
+			while(task->acquire_shader_tile(this, tile)) {
+				shader(tile);
+
+				cuda_push_context();
+				cuda_assert(cuCtxSynchronize());
+				cuda_pop_context();
+
+				task->release_shader_tile(this, tile);
+
+				if(task->get_cancel())
+					break;
+			}
+		}
 		else if(task->type == DeviceTask::SHADER) {
 			shader(*task);
 
@@ -307,6 +307,10 @@ public:
 		task.split(tasks, devices.size());
 
 		foreach(SubDevice& sub, devices) {
+			/* tiles can not be acquired over the network */
+			if(task.acquire_shader_tile && sub.device->info.type == DEVICE_NETWORK)
+				continue;
+
 			if(!tasks.empty()) {
 				DeviceTask subtask = tasks.front();
 				tasks.pop_front();
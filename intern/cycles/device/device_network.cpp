@@ -20,6 +20,7 @@
 
 #include "util_foreach.h"
 #include "util_logging.h"
+#include "util_md5.h"
 
 #if defined(WITH_NETWORK)
 
@@ -29,9 +30,145 @@ typedef map<device_ptr, device_ptr> PtrMap;
 typedef vector<uint8_t> DataVector;
 typedef map<device_ptr, DataVector> DataMap;
 
+/* Textures of the previous render, kept on the server by name so that
+ * unchanged textures do not have to be sent again for the next frame. The
+ * device allocation is kept resident as well, so reusing a texture does not
+ * have to upload it to the device again. This covers the BVH and mesh data,
+ * which are uploaded as textures too. */
+struct NetworkTextureCache {
+	struct Entry {
+		Entry() : mem(NULL) {}
+
+		string hash;
+		DataVector data;
+		InterpolationType interpolation;
+		ExtensionType extension;
+		/* resident device memory, pointing to data */
+		network_device_memory *mem;
+	};
+
+	map<string, Entry> entries;
+};
+
 /* tile list */
 typedef vector<RenderTile> TileList;
 
+/* hash of a memory buffer, to detect unchanged textures */
+static string network_buffer_hash(const uint8_t *data, size_t size)
+{
+	MD5Hash md5;
+	const size_t chunk_size = 1 << 30;
+
+	for(size_t offset = 0; offset < size; offset += chunk_size)
+		md5.append(data + offset, (int)((size - offset < chunk_size)? size - offset: chunk_size));
+
+	return md5.get_hex();
+}
+
+/* variable length encoding of sizes */
+static void network_write_varint(vector<uint8_t>& packed, size_t value)
+{
+	while(value >= 0x80) {
+		packed.push_back((uint8_t)(value | 0x80));
+		value >>= 7;
+	}
+	packed.push_back((uint8_t)value);
+}
+
+static bool network_read_varint(const vector<uint8_t>& packed, size_t& pos, size_t *value)
+{
+	*value = 0;
+
+	for(int shift = 0; pos < packed.size() && shift < 64; shift += 7) {
+		uint8_t byte = packed[pos++];
+		*value |= (size_t)(byte & 0x7f) << shift;
+
+		if(!(byte & 0x80))
+			return true;
+	}
+
+	return false;
+}
+
+/* Lossless compression of render buffers. Every 32 bit word is XOR'ed with
+ * the same pass of the previous pixel, neighbouring pixels mostly share sign,
+ * exponent and high mantissa bits so this gives many zero bytes, which are
+ * then run length encoded. Returns false if the data does not compress. */
+static bool network_buffer_compress(const uint8_t *data, size_t size, size_t elem, vector<uint8_t>& packed)
+{
+	if(size == 0 || size % sizeof(uint32_t) != 0)
+		return false;
+
+	size_t num_words = size / sizeof(uint32_t);
+	size_t stride = (elem >= sizeof(uint32_t) && elem % sizeof(uint32_t) == 0)? elem / sizeof(uint32_t): 1;
+	const uint32_t *words = (const uint32_t*)data;
+
+	vector<uint32_t> delta(num_words);
+	for(size_t i = 0; i < num_words; i++)
+		delta[i] = (i >= stride)? words[i] ^ words[i - stride]: words[i];
+
+	const uint8_t *bytes = (const uint8_t*)&delta[0];
+	size_t i = 0;
+
+	packed.clear();
+	packed.reserve(size / 2);
+
+	while(i < size) {
+		/* literal bytes up to the next run of at least four zero bytes */
+		size_t literal_start = i;
+		while(i < size && !(i + 4 <= size && (bytes[i] | bytes[i+1] | bytes[i+2] | bytes[i+3]) == 0))
+			i++;
+
+		network_write_varint(packed, i - literal_start);
+		packed.insert(packed.end(), bytes + literal_start, bytes + i);
+
+		size_t zero_start = i;
+		while(i < size && bytes[i] == 0)
+			i++;
+
+		network_write_varint(packed, i - zero_start);
+
+		if(packed.size() >= size)
+			return false;
+	}
+
+	return true;
+}
+
+static bool network_buffer_decompress(const vector<uint8_t>& packed, uint8_t *data, size_t size, size_t elem)
+{
+	size_t pos = 0, i = 0;
+
+	while(i < size) {
+		size_t num_literal, num_zero;
+
+		if(!network_read_varint(packed, pos, &num_literal) ||
+		   num_literal > size - i || num_literal > packed.size() - pos)
+		{
+			return false;
+		}
+
+		memcpy(data + i, &packed[pos], num_literal);
+		pos += num_literal;
+		i += num_literal;
+
+		if(!network_read_varint(packed, pos, &num_zero) || num_zero > size - i)
+			return false;
+
+		memset(data + i, 0, num_zero);
+		i += num_zero;
+	}
+
+	size_t num_words = size / sizeof(uint32_t);
+	size_t stride = (elem >= sizeof(uint32_t) && elem % sizeof(uint32_t) == 0)? elem / sizeof(uint32_t): 1;
+	uint32_t *words = (uint32_t*)data;
+
+	for(size_t w = stride; w < num_words; w++)
+		words[w] ^= words[w - stride];
+
+	return true;
+}
+
 /* search a list of tiles and find the one that matches the passed render tile */
 static TileList::iterator tile_list_find(TileList& tile_list, RenderTile& tile)
 {
@@ -121,8 +258,21 @@ public:
 		snd.add(elem);
 		snd.write();
 
+		/* tile buffers are sent compressed if that makes them smaller */
 		RPCReceive rcv(socket, &error_func);
-		rcv.read_buffer((void*)mem.data_pointer, data_size);
+		size_t packed_size;
+		rcv.read(packed_size);
+
+		if(packed_size == 0) {
+			rcv.read_buffer((void*)mem.data_pointer, data_size);
+		}
+		else {
+			vector<uint8_t> packed(packed_size);
+			rcv.read_buffer(&packed[0], packed_size);
+
+			if(!network_buffer_decompress(packed, (uint8_t*)mem.data_pointer, data_size, elem))
+				error_func.network_error("Network receive error: corrupt compressed buffer");
+		}
 	}
 
 	void mem_zero(device_memory& mem)
@@ -177,13 +327,24 @@ public:
 		RPCSend snd(socket, &error_func, "tex_alloc");
 
 		string name_string(name);
+		string hash = network_buffer_hash((uint8_t*)mem.data_pointer, mem.memory_size());
 
 		snd.add(name_string);
 		snd.add(mem);
 		snd.add(interpolation);
 		snd.add(extension);
+		snd.add(hash);
 		snd.write();
-		snd.write_buffer((void*)mem.data_pointer, mem.memory_size());
+
+		/* only send the data if the server does not have it from a previous render */
+		bool cached;
+		RPCReceive rcv(socket, &error_func);
+		rcv.read(cached);
+
+		if(!cached)
+			snd.write_buffer((void*)mem.data_pointer, mem.memory_size());
+		else
+			VLOG(1) << "Texture " << name << " unchanged, reusing server copy.";
 	}
 
 	void tex_free(device_memory& mem)
@@ -346,8 +507,8 @@ public:
 
 	bool have_error() { return error_func.have_error(); }
 
-	DeviceServer(Device *device_, tcp::socket& socket_)
-	: device(device_), socket(socket_), stop(false), blocked_waiting(false)
+	DeviceServer(Device *device_, tcp::socket& socket_, NetworkTextureCache& tex_cache_)
+	: device(device_), socket(socket_), tex_cache(tex_cache_), stop(false), blocked_waiting(false)
 	{
 		error_func = NetworkError();
 	}
@@ -524,9 +685,17 @@ protected:
 
 			size_t data_size = mem.memory_size();
 
+			vector<uint8_t> packed;
+			bool compressed = network_buffer_compress((uint8_t*)mem.data_pointer, data_size, elem, packed);
+			size_t packed_size = compressed? packed.size(): 0;
+
 			RPCSend snd(socket, &error_func, "mem_copy_from");
+			snd.add(packed_size);
 			snd.write();
-			snd.write_buffer((uint8_t*)mem.data_pointer, data_size);
+			if(compressed)
+				snd.write_buffer(&packed[0], packed_size);
+			else
+				snd.write_buffer((uint8_t*)mem.data_pointer, data_size);
 			lock.unlock();
 		}
 		else if(rcv.name == "mem_zero") {
@@ -577,11 +746,13 @@ protected:
 			ExtensionType extension_type;
 			device_ptr client_pointer;
 
+			string hash;
+
 			rcv.read(name);
 			rcv.read(mem);
 			rcv.read(interpolation);
 			rcv.read(extension_type);
-			lock.unlock();
+			rcv.read(hash);
 
 			client_pointer = mem.device_pointer;
 
@@ -589,16 +760,50 @@ protected:
 
 			DataVector &data_v = data_vector_insert(client_pointer, data_size);
 
+			/* reuse the data of the previous render if it did not change */
+			map<string, NetworkTextureCache::Entry>::iterator it = tex_cache.entries.find(name);
+			bool cached = false;
+			device_ptr resident_pointer = 0;
+
+			if(it != tex_cache.entries.end()) {
+				NetworkTextureCache::Entry& entry = it->second;
+
+				if(entry.hash == hash && entry.data.size() == data_size) {
+					cached = true;
+					data_v.swap(entry.data);
+
+					/* device memory can be reused as is if sampled the same way */
+					if(entry.interpolation == interpolation && entry.extension == extension_type) {
+						resident_pointer = entry.mem->device_pointer;
+						entry.mem->device_pointer = 0;
+					}
+				}
+
+				tex_cache_evict(it);
+			}
+
+			RPCSend snd(socket, &error_func, "tex_alloc");
+			snd.add(cached);
+			snd.write();
+
 			if(data_size)
 				mem.data_pointer = (device_ptr)&(data_v[0]);
 			else
 				mem.data_pointer = 0;
 
-			rcv.read_buffer((uint8_t*)mem.data_pointer, data_size);
+			if(!cached)
+				rcv.read_buffer((uint8_t*)mem.data_pointer, data_size);
+			lock.unlock();
 
-			device->tex_alloc(name.c_str(), mem, interpolation, extension_type);
+			if(resident_pointer)
+				mem.device_pointer = resident_pointer;
+			else
+				device->tex_alloc(name.c_str(), mem, interpolation, extension_type);
 
 			pointer_mapping_insert(client_pointer, mem.device_pointer);
+
+			TextureInfo info = {name, hash, interpolation, extension_type};
+			tex_info[client_pointer] = info;
 		}
 		else if(rcv.name == "tex_free") {
 			network_device_memory mem;
@@ -609,6 +814,36 @@ protected:
 
 			client_pointer = mem.device_pointer;
 
+			/* keep the data and device memory around for the next render */
+			map<device_ptr, TextureInfo>::iterator it = tex_info.find(client_pointer);
+			if(it != tex_info.end()) {
+				const TextureInfo& info = it->second;
+
+				map<string, NetworkTextureCache::Entry>::iterator ientry = tex_cache.entries.find(info.name);
+				if(ientry != tex_cache.entries.end())
+					tex_cache_evict(ientry);
+
+				NetworkTextureCache::Entry& entry = tex_cache.entries[info.name];
+				entry.hash = info.hash;
+				entry.interpolation = info.interpolation;
+				entry.extension = info.extension;
+				entry.data.swap(data_vector_find(client_pointer));
+
+				entry.mem = new network_device_memory();
+				entry.mem->data_type = mem.data_type;
+				entry.mem->data_elements = mem.data_elements;
+				entry.mem->data_size = mem.data_size;
+				entry.mem->device_size = mem.device_size;
+				entry.mem->data_width = mem.data_width;
+				entry.mem->data_height = mem.data_height;
+				entry.mem->data_depth = mem.data_depth;
+				entry.mem->data_pointer = (entry.data.size())? (device_ptr)&entry.data[0]: 0;
+				entry.mem->device_pointer = device_ptr_from_client_pointer_erase(client_pointer);
+
+				tex_info.erase(it);
+				return;
+			}
+
 			mem.device_pointer = device_ptr_from_client_pointer_erase(client_pointer);
 
 			device->tex_free(mem);
@@ -648,7 +883,7 @@ protected:
 			if(task.shader_output)
 				task.shader_output = device_ptr_from_client_pointer(task.shader_output);
 
-			if(task.shader_output)luma)
+			if(task.shader_output_luma)
 				task.shader_output_luma = device_ptr_from_client_pointer(task.shader_output_luma);
 
 
@@ -701,6 +936,20 @@ protected:
 		}
 	}
 
+	/* free the resident device memory of a cached texture */
+	void tex_cache_evict(map<string, NetworkTextureCache::Entry>::iterator it)
+	{
+		NetworkTextureCache::Entry& entry = it->second;
+
+		if(entry.mem) {
+			if(entry.mem->device_pointer)
+				device->tex_free(*entry.mem);
+			delete entry.mem;
+		}
+
+		tex_cache.entries.erase(it);
+	}
+
 	bool task_acquire_tile(Device *device, RenderTile& tile)
 	{
 		thread_scoped_lock acquire_lock(acquire_mutex);
@@ -803,6 +1052,17 @@ protected:
 	PtrMap ptr_imap;
 	DataMap mem_data;
 
+	/* name and contents hash of allocated textures */
+	struct TextureInfo {
+		string name;
+		string hash;
+		InterpolationType interpolation;
+		ExtensionType extension;
+	};
+
+	map<device_ptr, TextureInfo> tex_info;
+	NetworkTextureCache& tex_cache;
+
 	struct AcquireEntry {
 		string name;
 		RenderTile tile;
@@ -826,18 +1086,23 @@ void Device::server_run()
 		/* starts thread that responds to discovery requests */
 		ServerDiscovery discovery;
 
+		/* textures are kept between connections */
+		NetworkTextureCache tex_cache;
+
+		/* keep listening while serving a client, so that other clients are
+		 * queued and served one after another instead of being refused */
+		boost::asio::io_service io_service;
+		tcp::acceptor acceptor(io_service, tcp::endpoint(tcp::v4(), SERVER_PORT));
+
 		for(;;) {
 			/* accept connection */
-			boost::asio::io_service io_service;
-			tcp::acceptor acceptor(io_service, tcp::endpoint(tcp::v4(), SERVER_PORT));
-
 			tcp::socket socket(io_service);
 			acceptor.accept(socket);
 
 			string remote_address = socket.remote_endpoint().address().to_string();
 			printf("Connected to remote client at: %s\n", remote_address.c_str());
 
-			DeviceServer server(this, socket);
+			DeviceServer server(this, socket, tex_cache);
 			server.listen();
 
 			printf("Disconnected.\n");
@@ -109,6 +109,18 @@ bool opencl_kernel_use_debug()
 	return (getenv("CYCLES_OPENCL_DEBUG") != NULL);
 }
 
+/* Compiled kernels are cached in the user cache directory, render farms can
+ * point CYCLES_OPENCL_CACHE_DIR to a location shared between jobs. */
+string opencl_kernel_cache_path(const string& filename)
+{
+	const char *cache_dir = getenv("CYCLES_OPENCL_CACHE_DIR");
+
+	if(cache_dir != NULL && cache_dir[0] != '\0')
+		return path_join(cache_dir, filename);
+
+	return path_user_get(path_join("cache", filename));
+}
+
 bool opencl_kernel_use_advanced_shading(const string& platform)
 {
 	/* keep this in sync with kernel_types.h! */
@@ -367,19 +379,15 @@ class OpenCLCache
 		cl_context context;
 		/* cl_program for shader, bake, film_convert kernels (used in OpenCLDeviceBase) */
 		cl_program ocl_dev_base_program;
-		/* cl_program for megakernel (used in OpenCLDeviceMegaKernel) */
-		cl_program ocl_dev_megakernel_program;
 
 		Slot() : mutex(NULL),
 		         context(NULL),
-		         ocl_dev_base_program(NULL),
-		         ocl_dev_megakernel_program(NULL) {}
+		         ocl_dev_base_program(NULL) {}
 
 		Slot(const Slot& rhs)
 		    : mutex(rhs.mutex),
 		      context(rhs.context),
-		      ocl_dev_base_program(rhs.ocl_dev_base_program),
-		      ocl_dev_megakernel_program(rhs.ocl_dev_megakernel_program)
+		      ocl_dev_base_program(rhs.ocl_dev_base_program)
 		{
 			/* copy can only happen in map insert, assert that */
 			assert(mutex == NULL);
@@ -496,9 +504,10 @@ class OpenCLCache
 
 public:
 
+	/* Megakernel programs are specialized for the requested features of
+	 * the scene, they are only cached on disk. */
 	enum ProgramName {
 		OCL_DEV_BASE_PROGRAM,
-		OCL_DEV_MEGAKERNEL_PROGRAM,
 	};
 
 	/* see get_something comment */
@@ -538,13 +547,6 @@ public:
 				                                    &Slot::ocl_dev_base_program,
 				                                    slot_locker);
 				break;
-			case OCL_DEV_MEGAKERNEL_PROGRAM:
-				/* Get program related to megakernel */
-				program = get_something<cl_program>(platform,
-				                                    device,
-				                                    &Slot::ocl_dev_megakernel_program,
-				                                    slot_locker);
-				break;
 		default:
 			assert(!"Invalid program name");
 		}
@@ -594,13 +596,6 @@ public:
 				                            &Slot::ocl_dev_base_program,
 				                            slot_locker);
 				break;
-			case OCL_DEV_MEGAKERNEL_PROGRAM:
-				store_something<cl_program>(platform,
-				                            device,
-				                            program,
-				                            &Slot::ocl_dev_megakernel_program,
-				                            slot_locker);
-				break;
 			default:
 				assert(!"Invalid program name\n");
 				return;
@@ -623,8 +618,6 @@ public:
 		foreach(CacheMap::value_type &item, self.cache) {
 			if(item.second.ocl_dev_base_program != NULL)
 				clReleaseProgram(item.second.ocl_dev_base_program);
-			if(item.second.ocl_dev_megakernel_program != NULL)
-				clReleaseProgram(item.second.ocl_dev_megakernel_program);
 			if(item.second.context != NULL)
 				clReleaseContext(item.second.context);
 		}
@@ -923,13 +916,18 @@ public:
 	{
 		MD5Hash md5;
 		char version[256], driver[256], name[256], vendor[256];
+		char platform_name[256], platform_version[256];
 
 		clGetPlatformInfo(cpPlatform, CL_PLATFORM_VENDOR, sizeof(vendor), &vendor, NULL);
+		clGetPlatformInfo(cpPlatform, CL_PLATFORM_NAME, sizeof(platform_name), &platform_name, NULL);
+		clGetPlatformInfo(cpPlatform, CL_PLATFORM_VERSION, sizeof(platform_version), &platform_version, NULL);
 		clGetDeviceInfo(cdDevice, CL_DEVICE_VERSION, sizeof(version), &version, NULL);
 		clGetDeviceInfo(cdDevice, CL_DEVICE_NAME, sizeof(name), &name, NULL);
 		clGetDeviceInfo(cdDevice, CL_DRIVER_VERSION, sizeof(driver), &driver, NULL);
 
 		md5.append((uint8_t*)vendor, strlen(vendor));
+		md5.append((uint8_t*)platform_name, strlen(platform_name));
+		md5.append((uint8_t*)platform_version, strlen(platform_version));
 		md5.append((uint8_t*)version, strlen(version));
 		md5.append((uint8_t*)name, strlen(name));
 		md5.append((uint8_t*)driver, strlen(driver));
@@ -978,7 +976,7 @@ public:
 			string clbin = string_printf("cycles_kernel_%s_%s.clbin",
 			                             device_md5.c_str(),
 			                             kernel_md5.c_str());
-			clbin = path_user_get(path_join("cache", clbin));
+			clbin = opencl_kernel_cache_path(clbin);
 
 			/* path to preprocessed source for debugging */
 			string clsrc, *debug_src = NULL;
@@ -987,7 +985,7 @@ public:
 				clsrc = string_printf("cycles_kernel_%s_%s.cl",
 				                      device_md5.c_str(),
 				                      kernel_md5.c_str());
-				clsrc = path_user_get(path_join("cache", clsrc));
+				clsrc = opencl_kernel_cache_path(clsrc);
 				debug_src = &clsrc;
 			}
 
@@ -1618,71 +1616,58 @@ public:
 			return false;
 		}
 
-		/* Try to use cached kernel. */
-		thread_scoped_lock cache_locker;
-		path_trace_program = OpenCLCache::get_program(cpPlatform,
-		                                              cdDevice,
-		                                              OpenCLCache::OCL_DEV_MEGAKERNEL_PROGRAM,
-		                                              cache_locker);
-
-		if(!path_trace_program) {
-			/* Verify we have right opencl version. */
-			if(!opencl_version_check())
-				return false;
+		/* Verify we have right opencl version. */
+		if(!opencl_version_check())
+			return false;
 
-			/* Calculate md5 hash to detect changes. */
-			string kernel_path = path_get("kernel");
-			string kernel_md5 = path_files_md5_hash(kernel_path);
-			string custom_kernel_build_options = "-D__COMPILE_ONLY_MEGAKERNEL__ ";
-			string device_md5 = device_md5_hash(custom_kernel_build_options);
+		/* Calculate md5 hash to detect changes. The program is specialized
+		 * for the requested features, so they are part of the hash too. */
+		string kernel_path = path_get("kernel");
+		string kernel_md5 = path_files_md5_hash(kernel_path);
+		string custom_kernel_build_options = "-D__COMPILE_ONLY_MEGAKERNEL__ " +
+		                                     requested_features.get_build_options();
+		string device_md5 = device_md5_hash(custom_kernel_build_options);
 
-			/* Path to cached binary. */
-			string clbin = string_printf("cycles_kernel_%s_%s.clbin",
-			                             device_md5.c_str(),
-			                             kernel_md5.c_str());
-			clbin = path_user_get(path_join("cache", clbin));
+		/* Path to cached binary. */
+		string clbin = string_printf("cycles_kernel_%s_%s.clbin",
+		                             device_md5.c_str(),
+		                             kernel_md5.c_str());
+		clbin = opencl_kernel_cache_path(clbin);
 
-			/* Path to preprocessed source for debugging. */
-			string clsrc, *debug_src = NULL;
-			if(opencl_kernel_use_debug()) {
-				clsrc = string_printf("cycles_kernel_%s_%s.cl",
-				                      device_md5.c_str(),
-				                      kernel_md5.c_str());
-				clsrc = path_user_get(path_join("cache", clsrc));
-				debug_src = &clsrc;
-			}
+		/* Path to preprocessed source for debugging. */
+		string clsrc, *debug_src = NULL;
+		if(opencl_kernel_use_debug()) {
+			clsrc = string_printf("cycles_kernel_%s_%s.cl",
+			                      device_md5.c_str(),
+			                      kernel_md5.c_str());
+			clsrc = opencl_kernel_cache_path(clsrc);
+			debug_src = &clsrc;
+		}
 
-			/* If exists already, try use it. */
-			if(path_exists(clbin) && load_binary(kernel_path,
-			                                     clbin,
-			                                     custom_kernel_build_options,
-			                                     &path_trace_program,
-			                                     debug_src)) {
-				/* Kernel loaded from binary, nothing to do. */
+		/* If exists already, try use it. */
+		if(path_exists(clbin) && load_binary(kernel_path,
+		                                     clbin,
+		                                     custom_kernel_build_options,
+		                                     &path_trace_program,
+		                                     debug_src)) {
+			/* Kernel loaded from binary, nothing to do. */
+		}
+		else {
+			string init_kernel_source = "#include \"kernels/opencl/kernel.cl\" // " +
+			                            kernel_md5 + "\n";
+			/* If does not exist or loading binary failed, compile kernel. */
+			if(!compile_kernel(kernel_path,
+			                   init_kernel_source,
+			                   custom_kernel_build_options,
+			                   &path_trace_program,
+			                   debug_src))
+			{
+				return false;
 			}
-			else {
-				string init_kernel_source = "#include \"kernels/opencl/kernel.cl\" // " +
-				                            kernel_md5 + "\n";
-				/* If does not exist or loading binary failed, compile kernel. */
-				if(!compile_kernel(kernel_path,
-				                   init_kernel_source,
-				                   custom_kernel_build_options,
-				                   &path_trace_program,
-				                   debug_src))
-				{
-					return false;
-				}
-				/* Save binary for reuse. */
-				if(!save_binary(&path_trace_program, clbin)) {
-					return false;
-				}
+			/* Save binary for reuse. */
+			if(!save_binary(&path_trace_program, clbin)) {
+				return false;
 			}
-			/* Cache the program. */
-			OpenCLCache::store_program(cpPlatform,
-			                           cdDevice,
-			                           path_trace_program,
-			                           OpenCLCache::OCL_DEV_MEGAKERNEL_PROGRAM,
-			                           cache_locker);
 		}
 
 		/* Find kernels. */
@@ -1747,6 +1732,18 @@ public:
 		if(task->type == DeviceTask::FILM_CONVERT) {
 			film_convert(*task, task->buffer, task->rgba_byte, task->rgba_half);
 		}
+		else if(task->type == DeviceTask::SHADER && task->acquire_shader_tile) {
+			DeviceTask tile = *task;
+
+			/* Keep evaluating tiles until done. */
+			while(task->acquire_shader_tile(this, tile)) {
+				shader(tile);
+				task->release_shader_tile(this, tile);
+
+				if(task->get_cancel())
+					break;
+			}
+		}
 		else if(task->type == DeviceTask::SHADER) {
 			shader(*task);
 		}
@@ -1853,6 +1850,7 @@ public:
 	cl_kernel ckPathTraceKernel_lamp_emission;
 	cl_kernel ckPathTraceKernel_queue_enqueue;
 	cl_kernel ckPathTraceKernel_background_buffer_update;
+	cl_kernel ckPathTraceKernel_shader_sort;
 	cl_kernel ckPathTraceKernel_shader_eval;
 	cl_kernel ckPathTraceKernel_holdout_emission_blurring_pathtermination_ao;
 	cl_kernel ckPathTraceKernel_direct_lighting;
@@ -1866,6 +1864,7 @@ public:
 	cl_program lamp_emission_program;
 	cl_program queue_enqueue_program;
 	cl_program background_buffer_update_program;
+	cl_program shader_sort_program;
 	cl_program shader_eval_program;
 	cl_program holdout_emission_blurring_pathtermination_ao_program;
 	cl_program direct_lighting_program;
@@ -2021,6 +2020,7 @@ public:
 		ckPathTraceKernel_scene_intersect = NULL;
 		ckPathTraceKernel_lamp_emission = NULL;
 		ckPathTraceKernel_background_buffer_update = NULL;
+		ckPathTraceKernel_shader_sort = NULL;
 		ckPathTraceKernel_shader_eval = NULL;
 		ckPathTraceKernel_holdout_emission_blurring_pathtermination_ao = NULL;
 		ckPathTraceKernel_direct_lighting = NULL;
@@ -2035,6 +2035,7 @@ public:
 		lamp_emission_program = NULL;
 		queue_enqueue_program = NULL;
 		background_buffer_update_program = NULL;
+		shader_sort_program = NULL;
 		shader_eval_program = NULL;
 		holdout_emission_blurring_pathtermination_ao_program = NULL;
 		direct_lighting_program = NULL;
@@ -2181,7 +2182,7 @@ public:
 		if(!opencl_version_check())
 			return false;
 
-		clbin = path_user_get(path_join("cache", clbin));
+		clbin = opencl_kernel_cache_path(clbin);
 
 		/* If exists already, try use it. */
 		if(path_exists(clbin) && load_binary(kernel_path,
@@ -2190,6 +2191,7 @@ public:
 		                                     program,
 		                                     debug_src)) {
 			/* Kernel loaded from binary. */
+			VLOG(2) << "Loaded kernel from " << clbin << ".";
 		}
 		else {
 			/* If does not exist or loading binary failed, compile kernel. */
@@ -2316,7 +2318,7 @@ public:
 		if(opencl_kernel_use_debug()) { \
 			clsrc = string_printf("cycles_kernel_%s_%s_" #name ".cl", \
 			                      device_md5.c_str(), kernel_md5.c_str()); \
-			clsrc = path_user_get(path_join("cache", clsrc)); \
+			clsrc = opencl_kernel_cache_path(clsrc); \
 			debug_src = &clsrc; \
 		} \
 		if(!load_split_kernel(kernel_path, kernel_init_source, clbin, \
@@ -2334,6 +2336,7 @@ public:
 		LOAD_KERNEL(lamp_emission);
 		LOAD_KERNEL(queue_enqueue);
 		LOAD_KERNEL(background_buffer_update);
+		LOAD_KERNEL(shader_sort);
 		LOAD_KERNEL(shader_eval);
 		LOAD_KERNEL(holdout_emission_blurring_pathtermination_ao);
 		LOAD_KERNEL(direct_lighting);
@@ -2359,6 +2362,7 @@ public:
 		FIND_KERNEL(lamp_emission);
 		FIND_KERNEL(queue_enqueue);
 		FIND_KERNEL(background_buffer_update);
+		FIND_KERNEL(shader_sort);
 		FIND_KERNEL(shader_eval);
 		FIND_KERNEL(holdout_emission_blurring_pathtermination_ao);
 		FIND_KERNEL(direct_lighting);
@@ -2383,6 +2387,7 @@ public:
 		release_kernel_safe(ckPathTraceKernel_lamp_emission);
 		release_kernel_safe(ckPathTraceKernel_queue_enqueue);
 		release_kernel_safe(ckPathTraceKernel_background_buffer_update);
+		release_kernel_safe(ckPathTraceKernel_shader_sort);
 		release_kernel_safe(ckPathTraceKernel_shader_eval);
 		release_kernel_safe(ckPathTraceKernel_holdout_emission_blurring_pathtermination_ao);
 		release_kernel_safe(ckPathTraceKernel_direct_lighting);
@@ -2492,6 +2497,7 @@ public:
 		release_program_safe(lamp_emission_program);
 		release_program_safe(queue_enqueue_program);
 		release_program_safe(background_buffer_update_program);
+		release_program_safe(shader_sort_program);
 		release_program_safe(shader_eval_program);
 		release_program_safe(holdout_emission_blurring_pathtermination_ao_program);
 		release_program_safe(direct_lighting_program);
@@ -2902,6 +2908,16 @@ public:
 #endif
 		                 num_parallel_samples);
 
+		kernel_set_args(ckPathTraceKernel_shader_sort,
+		                0,
+		                kgbuffer,
+		                d_data,
+		                Intersection_coop,
+		                ray_state,
+		                Queue_data,
+		                Queue_index,
+		                dQueue_size);
+
 		kernel_set_args(ckPathTraceKernel_shader_eval,
 		                0,
 		                kgbuffer,
@@ -3051,12 +3067,21 @@ public:
 			global_size_shadow_blocked[0] = global_size[0] * 2;
 			global_size_shadow_blocked[1] = global_size[1];
 
+			/* One work group of ckPathTraceKernel_shader_sort per block of
+			 * SHADER_SORT_BLOCK_SIZE queue slots. */
+			size_t num_sort_blocks = (global_size[0] * global_size[1] +
+			                          SHADER_SORT_BLOCK_SIZE - 1) / SHADER_SORT_BLOCK_SIZE;
+			size_t global_size_shader_sort[2];
+			global_size_shader_sort[0] = num_sort_blocks * local_size[0];
+			global_size_shader_sort[1] = local_size[1];
+
 			/* Do path-iteration in host [Enqueue Path-iteration kernels. */
 			for(int PathIter = 0; PathIter < PathIteration_times; PathIter++) {
 				ENQUEUE_SPLIT_KERNEL(scene_intersect, global_size, local_size);
 				ENQUEUE_SPLIT_KERNEL(lamp_emission, global_size, local_size);
 				ENQUEUE_SPLIT_KERNEL(queue_enqueue, global_size, local_size);
 				ENQUEUE_SPLIT_KERNEL(background_buffer_update, global_size, local_size);
+				ENQUEUE_SPLIT_KERNEL(shader_sort, global_size_shader_sort, local_size);
 				ENQUEUE_SPLIT_KERNEL(shader_eval, global_size, local_size);
 				ENQUEUE_SPLIT_KERNEL(holdout_emission_blurring_pathtermination_ao, global_size, local_size);
 				ENQUEUE_SPLIT_KERNEL(direct_lighting, global_size, local_size);
@@ -3419,6 +3444,18 @@ public:
 		if(task->type == DeviceTask::FILM_CONVERT) {
 			film_convert(*task, task->buffer, task->rgba_byte, task->rgba_half);
 		}
+		else if(task->type == DeviceTask::SHADER && task->acquire_shader_tile) {
+			DeviceTask tile = *task;
+
+			/* Keep evaluating tiles until done. */
+			while(task->acquire_shader_tile(this, tile)) {
+				shader(tile);
+				task->release_shader_tile(this, tile);
+
+				if(task->get_cancel())
+					break;
+			}
+		}
 		else if(task->type == DeviceTask::SHADER) {
 			shader(*task);
 		}
@@ -37,7 +37,7 @@ DeviceTask::DeviceTask(Type type_)
 
 int DeviceTask::get_subtask_count(int num, int max_size)
 {
-	if(max_size != 0) {
+	if(max_size != 0 && !(type == SHADER && acquire_shader_tile)) {
 		int max_size_num;
 
 		if(type == SHADER) {
@@ -51,10 +51,10 @@ int DeviceTask::get_subtask_count(int num, int max_size)
 		num = max(max_size_num, num);
 	}
 
-	if(type == SHADER) {
+	if(type == SHADER && !acquire_shader_tile) {
 		num = min(shader_w, num);
 	}
-	else if(type == PATH_TRACE) {
+	else if(type == PATH_TRACE || type == SHADER) {
 	}
 	else {
 		num = min(h, num);
@@ -67,7 +67,7 @@ void DeviceTask::split(list<DeviceTask>& tasks, int num, int max_size)
 {
 	num = get_subtask_count(num, max_size);
 
-	if(type == SHADER) {
+	if(type == SHADER && !acquire_shader_tile) {
 		for(int i = 0; i < num; i++) {
 			int tx = shader_x + (shader_w/num)*i;
 			int tw = (i == num-1)? shader_w - i*(shader_w/num): shader_w/num;
@@ -80,7 +80,8 @@ void DeviceTask::split(list<DeviceTask>& tasks, int num, int max_size)
 			tasks.push_back(task);
 		}
 	}
-	else if(type == PATH_TRACE) {
+	else if(type == PATH_TRACE || type == SHADER) {
+		/* every task acquires its own tiles */
 		for(int i = 0; i < num; i++)
 			tasks.push_back(*this);
 	}
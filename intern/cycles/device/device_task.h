@@ -61,6 +61,10 @@ public:
 	function<void(void)> update_progress_sample;
 	function<void(RenderTile&)> update_tile_sample;
 	function<void(RenderTile&)> release_tile;
+	/* shader tasks with tile scheduling get their input, output and range
+	 * filled in per tile on the device that evaluates it */
+	function<bool(Device *device, DeviceTask&)> acquire_shader_tile;
+	function<void(Device *device, DeviceTask&)> release_shader_tile;
 	function<bool(void)> get_cancel;
 
 	bool need_finish_queue;
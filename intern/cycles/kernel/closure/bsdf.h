@@ -39,6 +39,8 @@ ccl_device int bsdf_sample(KernelGlobals *kg, const ShaderData *sd, const Shader
 {
 	int label;
 
+	PROFILING_ADD(kg, PROFILING_CLOSURE_EVALS, 1);
+
 #ifdef __OSL__
 	if(kg->osl && sc->prim)
 		return OSLShader::bsdf_sample(sd, sc, randu, randv, *eval, *omega_in, *domega_in, *pdf);
@@ -134,6 +136,8 @@ ccl_device float3 bsdf_eval(KernelGlobals *kg, const ShaderData *sd, const Shade
 {
 	float3 eval;
 
+	PROFILING_ADD(kg, PROFILING_CLOSURE_EVALS, 1);
+
 #ifdef __OSL__
 	if(kg->osl && sc->prim)
 		return OSLShader::bsdf_eval(sd, sc, omega_in, *pdf);
@@ -25,6 +25,8 @@
 #define BVH_NODE_LEAF_SIZE 1
 #define BVH_QNODE_SIZE 7
 #define BVH_QNODE_LEAF_SIZE 1
+#define BVH_MOTION_NODE_SIZE 3
+#define BVH_QMOTION_NODE_SIZE 6
 #define TRI_NODE_SIZE 3
 
 /* silly workaround for float extended precision that happens when compiling
@@ -48,6 +48,30 @@ CCL_NAMESPACE_BEGIN
 
 #define BVH_FEATURE(f) (((BVH_FUNCTION_FEATURES) & (f)) != 0)
 
+/* Motion blur node bounds. */
+
+#if defined(__OBJECT_MOTION__)
+/* Child bounds of a binary BVH node at the given time, interpolated from the
+ * bounds stored for each motion step. Only valid when num_motion_steps is set. */
+ccl_device_inline void bvh_motion_node_bounds(KernelGlobals *kg,
+                                              int nodeAddr,
+                                              float time,
+                                              float4 bounds[BVH_MOTION_NODE_SIZE])
+{
+	const int num_steps = kernel_data.bvh.num_motion_steps;
+	const int maxstep = num_steps - 1;
+	const int step = min((int)(time*maxstep), maxstep - 1);
+	const float t = time*maxstep - step;
+	const int offset = (nodeAddr*num_steps + step)*BVH_MOTION_NODE_SIZE;
+
+	for(int i = 0; i < BVH_MOTION_NODE_SIZE; i++) {
+		float4 a = kernel_tex_fetch(__bvh_motion_nodes, offset + i);
+		float4 b = kernel_tex_fetch(__bvh_motion_nodes, offset + BVH_MOTION_NODE_SIZE + i);
+		bounds[i] = (1.0f - t)*a + t*b;
+	}
+}
+#endif
+
 /* Common QBVH functions. */
 #ifdef __QBVH__
 #include "geom_qbvh.h"
@@ -211,6 +235,12 @@ CCL_NAMESPACE_BEGIN
 #include "geom_bvh_volume_all.h"
 #endif
 
+/* Packet traversal for coherent opaque shadow rays */
+
+#if defined(__QBVH__)
+#include "geom_qbvh_packet.h"
+#endif
+
 #undef BVH_FEATURE
 #undef BVH_NAME_JOIN
 #undef BVH_NAME_EVAL
@@ -219,6 +249,10 @@ CCL_NAMESPACE_BEGIN
 ccl_device_intersect bool scene_intersect(KernelGlobals *kg, const Ray *ray, const uint visibility, Intersection *isect,
 					 uint *lcg_state, float difl, float extmax)
 {
+	PROFILING_RAY(kg, (visibility & PATH_RAY_SHADOW)? PROFILING_RAY_SHADOW:
+	                  (visibility & PATH_RAY_CAMERA)? PROFILING_RAY_CAMERA:
+	                                                  PROFILING_RAY_BOUNCE);
+
 #ifdef __OBJECT_MOTION__
 	if(kernel_data.bvh.have_motion) {
 #ifdef __HAIR__
@@ -262,6 +296,8 @@ ccl_device_intersect void scene_intersect_subsurface(KernelGlobals *kg,
                                                      uint *lcg_state,
                                                      int max_hits)
 {
+	PROFILING_RAY(kg, PROFILING_RAY_SUBSURFACE);
+
 #ifdef __OBJECT_MOTION__
 	if(kernel_data.bvh.have_motion) {
 #ifdef __HAIR__
@@ -339,6 +375,8 @@ ccl_device_intersect void scene_intersect_subsurface(KernelGlobals *kg,
 #ifdef __SHADOW_RECORD_ALL__
 ccl_device_intersect bool scene_intersect_shadow_all(KernelGlobals *kg, const Ray *ray, Intersection *isect, uint max_hits, uint *num_hits)
 {
+	PROFILING_RAY(kg, PROFILING_RAY_SHADOW);
+
 #ifdef __OBJECT_MOTION__
 	if(kernel_data.bvh.have_motion) {
 #ifdef __HAIR__
@@ -364,11 +402,48 @@ ccl_device_intersect bool scene_intersect_shadow_all(KernelGlobals *kg, const Ra
 }
 #endif
 
+#ifdef __KERNEL_CPU__
+/* Opaque occlusion test for a small batch of rays, such as ambient occlusion
+ * rays leaving the same shading point. Returns a bitmask of the blocked rays.
+ * Coherent rays are traced as a packet when the scene allows it. */
+ccl_device_intersect uint scene_intersect_shadow_packet(KernelGlobals *kg, const Ray *rays, int num_rays)
+{
+#ifdef __QBVH__
+	if(kernel_data.bvh.use_qbvh &&
+	   !kernel_data.bvh.have_motion &&
+	   !kernel_data.bvh.have_curves &&
+	   !kernel_data.bvh.have_instancing)
+	{
+		for(int i = 0; i < num_rays; i++) {
+			PROFILING_RAY(kg, PROFILING_RAY_SHADOW);
+		}
+
+		return qbvh_intersect_shadow_packet(kg, rays, num_rays);
+	}
+#endif /* __QBVH__ */
+
+	uint blocked = 0;
+
+	for(int i = 0; i < num_rays; i++) {
+		Intersection isect;
+
+		if(rays[i].t == 0.0f)
+			continue;
+		if(scene_intersect(kg, &rays[i], PATH_RAY_SHADOW_OPAQUE, &isect, NULL, 0.0f, 0.0f))
+			blocked |= (1 << i);
+	}
+
+	return blocked;
+}
+#endif /* __KERNEL_CPU__ */
+
 #ifdef __VOLUME__
 ccl_device_intersect bool scene_intersect_volume(KernelGlobals *kg,
                             const Ray *ray,
                             Intersection *isect)
 {
+	PROFILING_RAY(kg, PROFILING_RAY_VOLUME);
+
 #ifdef __OBJECT_MOTION__
 	if(kernel_data.bvh.have_motion) {
 #ifdef __HAIR__
@@ -411,6 +486,8 @@ ccl_device_intersect uint scene_intersect_volume_all(KernelGlobals *kg,
                                                      Intersection *isect,
                                                      const uint max_hits)
 {
+	PROFILING_RAY(kg, PROFILING_RAY_VOLUME);
+
 #ifdef __OBJECT_MOTION__
 	if(kernel_data.bvh.have_motion) {
 #ifdef __HAIR__
@@ -97,6 +97,8 @@ ccl_device uint BVH_FUNCTION_FULL_NAME(BVH)(KernelGlobals *kg,
 		do {
 			/* traverse internal nodes */
 			while(nodeAddr >= 0 && nodeAddr != ENTRYPOINT_SENTINEL) {
+				PROFILING_ADD(kg, PROFILING_BVH_NODES, 1);
+
 				bool traverseChild0, traverseChild1;
 				int nodeAddrChild1;
 
@@ -110,6 +112,17 @@ ccl_device uint BVH_FUNCTION_FULL_NAME(BVH)(KernelGlobals *kg,
 				float4 node2 = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+2);
 				float4 cnodes = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_NODE_SIZE+3);
 
+#if BVH_FEATURE(BVH_MOTION)
+				if(kernel_data.bvh.num_motion_steps) {
+					/* child bounds at the ray time */
+					float4 motion_bounds[BVH_MOTION_NODE_SIZE];
+					bvh_motion_node_bounds(kg, nodeAddr, ray->time, motion_bounds);
+					node0 = motion_bounds[0];
+					node1 = motion_bounds[1];
+					node2 = motion_bounds[2];
+				}
+#endif
+
 				/* intersect ray against child nodes */
 				NO_EXTENDED_PRECISION float c0lox = (node0.x - P.x) * idir.x;
 				NO_EXTENDED_PRECISION float c0hix = (node0.z - P.x) * idir.x;
@@ -140,6 +153,19 @@ ccl_device uint BVH_FUNCTION_FULL_NAME(BVH)(KernelGlobals *kg,
 				const ssef *bvh_nodes = (ssef*)kg->__bvh_nodes.data + nodeAddr*BVH_NODE_SIZE;
 				const float4 cnodes = ((float4*)bvh_nodes)[3];
 
+#if BVH_FEATURE(BVH_MOTION)
+				ssef motion_nodes[BVH_MOTION_NODE_SIZE];
+				if(kernel_data.bvh.num_motion_steps) {
+					/* child bounds at the ray time */
+					float4 motion_bounds[BVH_MOTION_NODE_SIZE];
+					bvh_motion_node_bounds(kg, nodeAddr, ray->time, motion_bounds);
+					motion_nodes[0] = load4f(motion_bounds[0]);
+					motion_nodes[1] = load4f(motion_bounds[1]);
+					motion_nodes[2] = load4f(motion_bounds[2]);
+					bvh_nodes = motion_nodes;
+				}
+#endif
+
 				/* intersect ray against child nodes */
 				const ssef tminmaxx = (shuffle_swap(bvh_nodes[0], shufflexyz[0]) - Psplat[0]) * idirsplat[0];
 				const ssef tminmaxy = (shuffle_swap(bvh_nodes[1], shufflexyz[1]) - Psplat[1]) * idirsplat[1];
@@ -321,6 +321,8 @@ ccl_device_noinline void motion_triangle_shader_setup(KernelGlobals *kg, ShaderD
 ccl_device_inline bool motion_triangle_intersect(KernelGlobals *kg, Intersection *isect,
 	float3 P, float3 dir, float time, uint visibility, int object, int triAddr)
 {
+	PROFILING_ADD(kg, PROFILING_TRIANGLE_TESTS, 1);
+
 	/* primitive index for vertex location lookup */
 	int prim = kernel_tex_fetch(__prim_index, triAddr);
 	int fobject = (object == OBJECT_NONE)? kernel_tex_fetch(__prim_object, triAddr): object;
@@ -370,6 +372,8 @@ ccl_device_inline void motion_triangle_intersect_subsurface(
         uint *lcg_state,
         int max_hits)
 {
+	PROFILING_ADD(kg, PROFILING_TRIANGLE_TESTS, 1);
+
 	/* primitive index for vertex location lookup */
 	int prim = kernel_tex_fetch(__prim_index, triAddr);
 	int fobject = (object == OBJECT_NONE)? kernel_tex_fetch(__prim_object, triAddr): object;
@@ -145,3 +145,70 @@ ccl_device_inline int qbvh_node_intersect_robust(KernelGlobals *__restrict kg,
 	*dist = tNear;
 	return (int)movemask(vmask);
 }
+
+#ifdef __OBJECT_MOTION__
+/* Same as qbvh_node_intersect(), but with the child bounds interpolated at
+ * the ray time from the bounds stored for each motion step. */
+ccl_device_inline int qbvh_node_intersect_motion(KernelGlobals *__restrict kg,
+                                                 const ssef& tnear,
+                                                 const ssef& tfar,
+#ifdef __KERNEL_AVX2__
+                                                 const sse3f& org_idir,
+#else
+                                                 const sse3f& org,
+#endif
+                                                 const sse3f& idir,
+                                                 const int near_x,
+                                                 const int near_y,
+                                                 const int near_z,
+                                                 const int far_x,
+                                                 const int far_y,
+                                                 const int far_z,
+                                                 const int nodeAddr,
+                                                 const float time,
+                                                 ssef *__restrict dist)
+{
+	const int num_steps = kernel_data.bvh.num_motion_steps;
+	const int maxstep = num_steps - 1;
+	const int step = min((int)(time*maxstep), maxstep - 1);
+	const float t = time*maxstep - step;
+	const int offset = (nodeAddr*num_steps + step)*BVH_QMOTION_NODE_SIZE;
+	const int next_offset = offset + BVH_QMOTION_NODE_SIZE;
+	const ssef t1(t), t0(1.0f - t);
+
+	const ssef bnear_x = t0*kernel_tex_fetch_ssef(__bvh_motion_nodes, offset+near_x) +
+	                     t1*kernel_tex_fetch_ssef(__bvh_motion_nodes, next_offset+near_x);
+	const ssef bnear_y = t0*kernel_tex_fetch_ssef(__bvh_motion_nodes, offset+near_y) +
+	                     t1*kernel_tex_fetch_ssef(__bvh_motion_nodes, next_offset+near_y);
+	const ssef bnear_z = t0*kernel_tex_fetch_ssef(__bvh_motion_nodes, offset+near_z) +
+	                     t1*kernel_tex_fetch_ssef(__bvh_motion_nodes, next_offset+near_z);
+	const ssef bfar_x = t0*kernel_tex_fetch_ssef(__bvh_motion_nodes, offset+far_x) +
+	                    t1*kernel_tex_fetch_ssef(__bvh_motion_nodes, next_offset+far_x);
+	const ssef bfar_y = t0*kernel_tex_fetch_ssef(__bvh_motion_nodes, offset+far_y) +
+	                    t1*kernel_tex_fetch_ssef(__bvh_motion_nodes, next_offset+far_y);
+	const ssef bfar_z = t0*kernel_tex_fetch_ssef(__bvh_motion_nodes, offset+far_z) +
+	                    t1*kernel_tex_fetch_ssef(__bvh_motion_nodes, next_offset+far_z);
+
+#ifdef __KERNEL_AVX2__
+	const ssef tnear_x = msub(bnear_x, idir.x, org_idir.x);
+	const ssef tnear_y = msub(bnear_y, idir.y, org_idir.y);
+	const ssef tnear_z = msub(bnear_z, idir.z, org_idir.z);
+	const ssef tfar_x = msub(bfar_x, idir.x, org_idir.x);
+	const ssef tfar_y = msub(bfar_y, idir.y, org_idir.y);
+	const ssef tfar_z = msub(bfar_z, idir.z, org_idir.z);
+#else
+	const ssef tnear_x = (bnear_x - org.x) * idir.x;
+	const ssef tnear_y = (bnear_y - org.y) * idir.y;
+	const ssef tnear_z = (bnear_z - org.z) * idir.z;
+	const ssef tfar_x = (bfar_x - org.x) * idir.x;
+	const ssef tfar_y = (bfar_y - org.y) * idir.y;
+	const ssef tfar_z = (bfar_z - org.z) * idir.z;
+#endif
+
+	const ssef tNear = max4(tnear_x, tnear_y, tnear_z, tnear);
+	const ssef tFar = min4(tfar_x, tfar_y, tfar_z, tfar);
+	const sseb vmask = tNear <= tFar;
+	*dist = tNear;
+	return (int)movemask(vmask);
+}
+#endif
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2011-2015 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Packet occlusion traversal for up to four coherent opaque shadow rays.
+ *
+ * All rays of the packet walk the tree together, every node is fetched once
+ * for the whole packet and each stack entry carries a mask with the rays
+ * that still have to visit it. Rays are removed from the packet as soon as
+ * they are found to be occluded.
+ *
+ * Only plain triangle geometry is supported, the caller is responsible for
+ * falling back to single ray traversal for instancing, motion blur and hair.
+ */
+
+#define QBVH_PACKET_SIZE 4
+
+struct QBVHPacketStackItem {
+	int addr;
+	uint mask;
+};
+
+ccl_device uint qbvh_intersect_shadow_packet(KernelGlobals *kg,
+                                             const Ray *rays,
+                                             const int num_rays)
+{
+	/* Traversal stack in thread-local memory. */
+	QBVHPacketStackItem traversalStack[BVH_QSTACK_SIZE];
+	traversalStack[0].addr = ENTRYPOINT_SENTINEL;
+	traversalStack[0].mask = 0;
+
+	/* Per ray parameters. */
+	ssef tfar[QBVH_PACKET_SIZE];
+	sse3f idir4[QBVH_PACKET_SIZE];
+#ifdef __KERNEL_AVX2__
+	sse3f P_idir4[QBVH_PACKET_SIZE];
+#else
+	sse3f org[QBVH_PACKET_SIZE];
+#endif
+	int near_x[QBVH_PACKET_SIZE], near_y[QBVH_PACKET_SIZE], near_z[QBVH_PACKET_SIZE];
+	int far_x[QBVH_PACKET_SIZE], far_y[QBVH_PACKET_SIZE], far_z[QBVH_PACKET_SIZE];
+	IsectPrecalc isect_precalc[QBVH_PACKET_SIZE];
+
+	const ssef tnear(0.0f);
+	uint active = 0;
+
+	kernel_assert(num_rays <= QBVH_PACKET_SIZE);
+
+	for(int i = 0; i < num_rays; i++) {
+		const Ray *ray = &rays[i];
+
+		if(ray->t == 0.0f)
+			continue;
+#ifndef __KERNEL_SSE41__
+		if(!isfinite(ray->P.x))
+			continue;
+#endif
+
+		float3 P = ray->P;
+		float3 dir = bvh_clamp_direction(ray->D);
+		float3 idir = bvh_inverse_direction(dir);
+
+		tfar[i] = ssef(ray->t);
+		idir4[i] = sse3f(ssef(idir.x), ssef(idir.y), ssef(idir.z));
+#ifdef __KERNEL_AVX2__
+		float3 P_idir = P*idir;
+		P_idir4[i] = sse3f(P_idir.x, P_idir.y, P_idir.z);
+#else
+		org[i] = sse3f(ssef(P.x), ssef(P.y), ssef(P.z));
+#endif
+
+		if(idir.x >= 0.0f) { near_x[i] = 0; far_x[i] = 1; } else { near_x[i] = 1; far_x[i] = 0; }
+		if(idir.y >= 0.0f) { near_y[i] = 2; far_y[i] = 3; } else { near_y[i] = 3; far_y[i] = 2; }
+		if(idir.z >= 0.0f) { near_z[i] = 4; far_z[i] = 5; } else { near_z[i] = 5; far_z[i] = 4; }
+
+		triangle_intersect_precalc(dir, &isect_precalc[i]);
+
+		active |= (1 << i);
+	}
+
+	/* Traversal variables in registers. */
+	int stackPtr = 0;
+	int nodeAddr = kernel_data.bvh.root;
+	uint nodeMask = active;
+	uint occluded = 0;
+
+	/* Traversal loop. */
+	while(nodeAddr != ENTRYPOINT_SENTINEL) {
+		/* Drop rays which got occluded since this node was pushed. */
+		nodeMask &= ~occluded;
+
+		if(nodeMask != 0) {
+			if(nodeAddr >= 0) {
+				PROFILING_ADD(kg, PROFILING_BVH_NODES, 1);
+
+				/* Inner node, intersect all children with every active ray
+				 * and gather per child masks of the rays that hit it.
+				 */
+				uint childMask[4] = {0, 0, 0, 0};
+				uint rayMask = nodeMask;
+
+				while(rayMask != 0) {
+					int i = __bscf(rayMask);
+					ssef dist;
+					int traverseChild = qbvh_node_intersect(kg,
+					                                        tnear,
+					                                        tfar[i],
+#ifdef __KERNEL_AVX2__
+					                                        P_idir4[i],
+#else
+					                                        org[i],
+#endif
+					                                        idir4[i],
+					                                        near_x[i], near_y[i], near_z[i],
+					                                        far_x[i], far_y[i], far_z[i],
+					                                        nodeAddr,
+					                                        &dist);
+
+					while(traverseChild != 0) {
+						int r = __bscf(traverseChild);
+						childMask[r] |= (1 << i);
+					}
+				}
+
+				float4 cnodes = kernel_tex_fetch(__bvh_nodes, nodeAddr*BVH_QNODE_SIZE+6);
+
+				/* Continue with the first hit child, push the others. */
+				int nextAddr = ENTRYPOINT_SENTINEL;
+				uint nextMask = 0;
+
+				for(int r = 0; r < 4; r++) {
+					if(childMask[r] == 0)
+						continue;
+
+					int childAddr = __float_as_int(cnodes[r]);
+
+					if(nextAddr == ENTRYPOINT_SENTINEL) {
+						nextAddr = childAddr;
+						nextMask = childMask[r];
+					}
+					else {
+						++stackPtr;
+						kernel_assert(stackPtr < BVH_QSTACK_SIZE);
+						traversalStack[stackPtr].addr = childAddr;
+						traversalStack[stackPtr].mask = childMask[r];
+					}
+				}
+
+				if(nextAddr != ENTRYPOINT_SENTINEL) {
+					nodeAddr = nextAddr;
+					nodeMask = nextMask;
+					continue;
+				}
+			}
+			else {
+				/* Leaf node, intersect triangles with every active ray. */
+				float4 leaf = kernel_tex_fetch(__bvh_leaf_nodes, (-nodeAddr-1)*BVH_QNODE_LEAF_SIZE);
+#ifdef __VISIBILITY_FLAG__
+				if((__float_as_uint(leaf.z) & PATH_RAY_SHADOW_OPAQUE) != 0)
+#endif
+				{
+					int primAddr = __float_as_int(leaf.x);
+					int primAddr2 = __float_as_int(leaf.y);
+
+					for(; primAddr < primAddr2 && nodeMask != 0; primAddr++) {
+						kernel_assert(kernel_tex_fetch(__prim_type, primAddr) == PRIMITIVE_TRIANGLE);
+
+						uint rayMask = nodeMask;
+						while(rayMask != 0) {
+							int i = __bscf(rayMask);
+							Intersection isect;
+							isect.t = rays[i].t;
+
+							if(triangle_intersect(kg, &isect_precalc[i], &isect, rays[i].P,
+							                      PATH_RAY_SHADOW_OPAQUE, OBJECT_NONE, primAddr))
+							{
+								occluded |= (1 << i);
+								nodeMask &= ~(1 << i);
+							}
+						}
+					}
+
+					/* Shadow ray early termination. */
+					if(occluded == active)
+						return occluded;
+				}
+			}
+		}
+
+		/* Pop. */
+		nodeAddr = traversalStack[stackPtr].addr;
+		nodeMask = traversalStack[stackPtr].mask;
+		--stackPtr;
+	}
+
+	return occluded;
+}
+
+#undef QBVH_PACKET_SIZE
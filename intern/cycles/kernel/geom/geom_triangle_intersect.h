@@ -111,6 +111,8 @@ ccl_device_inline bool triangle_intersect(KernelGlobals *kg,
                                           int object,
                                           int triAddr)
 {
+	PROFILING_ADD(kg, PROFILING_TRIANGLE_TESTS, 1);
+
 	const int kx = isect_precalc->kx;
 	const int ky = isect_precalc->ky;
 	const int kz = isect_precalc->kz;
@@ -212,6 +214,8 @@ ccl_device_inline void triangle_intersect_subsurface(
         uint *lcg_state,
         int max_hits)
 {
+	PROFILING_ADD(kg, PROFILING_TRIANGLE_TESTS, 1);
+
 	const int kx = isect_precalc->kx;
 	const int ky = isect_precalc->ky;
 	const int kz = isect_precalc->kz;
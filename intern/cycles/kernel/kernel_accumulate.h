@@ -121,6 +121,19 @@ ccl_device_inline void bsdf_eval_mul(BsdfEval *eval, float3 value)
 #endif
 }
 
+ccl_device_inline float3 bsdf_eval_sum(BsdfEval *eval)
+{
+#ifdef __PASSES__
+	if(eval->use_light_pass) {
+		return eval->diffuse + eval->glossy + eval->transmission + eval->subsurface + eval->scatter;
+	}
+	else
+		return eval->diffuse;
+#else
+	return *eval;
+#endif
+}
+
 /* Path Radiance
  *
  * We accumulate different render passes separately. After summing at the end
@@ -180,7 +180,20 @@ ccl_device_noinline float3 indirect_primitive_emission(KernelGlobals *kg, Shader
 	{
 		/* multiple importance sampling, get triangle light pdf,
 		 * and compute weight with respect to BSDF pdf */
-		float pdf = triangle_light_pdf(kg, ccl_fetch(sd, Ng), ccl_fetch(sd, I), t);
+		float pdf;
+
+		if(kernel_data.integrator.use_light_tree) {
+			/* position the ray was traced from */
+			float3 P = ccl_fetch(sd, P) + ccl_fetch(sd, I)*t;
+			int emitter = light_tree_triangle_emitter(kg, ccl_fetch(sd, object), ccl_fetch(sd, prim));
+			float pdf_area = (emitter != -1)? light_tree_triangle_pdf(kg, P, emitter): 0.0f;
+
+			pdf = triangle_light_pdf_area(pdf_area, ccl_fetch(sd, Ng), ccl_fetch(sd, I), t);
+		}
+		else {
+			pdf = triangle_light_pdf(kg, ccl_fetch(sd, Ng), ccl_fetch(sd, I), t);
+		}
+
 		float mis_weight = power_heuristic(bsdf_pdf, pdf);
 
 		return L*mis_weight;
@@ -16,6 +16,10 @@
 
 /* Constant Globals */
 
+#ifdef __KERNEL_CPU__
+#  include "util_stats.h"
+#endif
+
 CCL_NAMESPACE_BEGIN
 
 /* On the CPU, we pass along the struct KernelGlobals to nearly everywhere in
@@ -38,6 +42,11 @@ typedef struct KernelGlobals {
 	texture_image_uchar4 texture_byte_images[MAX_BYTE_IMAGES];
 	texture_image_float4 texture_float_images[MAX_FLOAT_IMAGES];
 
+	/* compact storage, when set it's used instead of the image above in the same slot */
+	texture_image_uchar texture_byte1_images[MAX_BYTE_IMAGES];
+	texture_image_half4 texture_half4_images[MAX_FLOAT_IMAGES];
+	texture_image_half texture_half_images[MAX_FLOAT_IMAGES];
+
 #define KERNEL_TEX(type, ttype, name) ttype name;
 #define KERNEL_IMAGE_TEX(type, ttype, name)
 #include "kernel_textures.h"
@@ -52,8 +61,69 @@ typedef struct KernelGlobals {
 	OSLThreadData *osl_tdata;
 #endif
 
+#ifdef __KERNEL_DEBUG__
+	/* Per thread profiling counters, NULL when profiling is disabled. */
+	ProfilingStats *profiling;
+#endif
+
+	/* Per thread light contribution statistics, NULL when not recording. */
+	LightStats *light_stats;
+
 } KernelGlobals;
 
+#define LIGHT_STATS_SAMPLES(kg, light, n) \
+	if((kg)->light_stats) { (kg)->light_stats->add_samples(light, n); } (void)0
+#define LIGHT_STATS_ADD(kg, light, value) \
+	if((kg)->light_stats) { (kg)->light_stats->add_contribution(light, value); } (void)0
+
+#ifdef __KERNEL_DEBUG__
+#  define PROFILING_RAY(kg, type) \
+	if((kg)->profiling) { (kg)->profiling->rays[type]++; } (void)0
+#  define PROFILING_ADD(kg, counter, n) \
+	if((kg)->profiling) { (kg)->profiling->counters[counter] += (n); } (void)0
+#  define PROFILING_SHADER_EVAL(kg, shader_id) \
+	if((kg)->profiling) { (kg)->profiling->shader_evals[(shader_id) >> 1]++; } (void)0
+#  define PROFILING_SHADER_NODE(kg, shader_id) \
+	if((kg)->profiling) { \
+		(kg)->profiling->counters[PROFILING_SVM_NODES]++; \
+		(kg)->profiling->shader_svm_nodes[(shader_id) >> 1]++; \
+	} (void)0
+#endif
+
+/* Image texture lookups, dispatching on the storage used for the slot. */
+
+#define KERNEL_IMAGE_INTERP(tex, call) \
+	if(tex < MAX_FLOAT_IMAGES) { \
+		if(kg->texture_half4_images[tex].data) \
+			return kg->texture_half4_images[tex].call; \
+		else if(kg->texture_half_images[tex].data) \
+			return kg->texture_half_images[tex].call; \
+		return kg->texture_float_images[tex].call; \
+	} \
+	else { \
+		tex -= MAX_FLOAT_IMAGES; \
+		if(kg->texture_byte1_images[tex].data) \
+			return kg->texture_byte1_images[tex].call; \
+		return kg->texture_byte_images[tex].call; \
+	} (void)0
+
+ccl_device_inline float4 kernel_tex_image_interp_cpu(KernelGlobals *kg, int tex, float x, float y)
+{
+	KERNEL_IMAGE_INTERP(tex, interp(x, y));
+}
+
+ccl_device_inline float4 kernel_tex_image_interp_3d_cpu(KernelGlobals *kg, int tex, float x, float y, float z)
+{
+	KERNEL_IMAGE_INTERP(tex, interp_3d(x, y, z));
+}
+
+ccl_device_inline float4 kernel_tex_image_interp_3d_ex_cpu(KernelGlobals *kg, int tex, float x, float y, float z, int interpolation)
+{
+	KERNEL_IMAGE_INTERP(tex, interp_3d_ex(x, y, z, interpolation));
+}
+
+#undef KERNEL_IMAGE_INTERP
+
 #endif
 
 /* For CUDA, constant memory textures must be globals, so we can't put them
@@ -76,6 +146,22 @@ typedef struct KernelGlobals {} KernelGlobals;
 
 #endif
 
+/* Profiling is only available for the CPU kernel in debug builds. */
+
+#ifndef PROFILING_RAY
+#  define PROFILING_RAY(kg, type)
+#  define PROFILING_ADD(kg, counter, n)
+#  define PROFILING_SHADER_EVAL(kg, shader_id)
+#  define PROFILING_SHADER_NODE(kg, shader_id)
+#endif
+
+/* Light statistics are only recorded by the CPU kernel. */
+
+#ifndef LIGHT_STATS_ADD
+#  define LIGHT_STATS_SAMPLES(kg, light, n)
+#  define LIGHT_STATS_ADD(kg, light, value)
+#endif
+
 /* OpenCL */
 
 #ifdef __KERNEL_OPENCL__
@@ -796,10 +796,9 @@ ccl_device void triangle_light_sample(KernelGlobals *kg, int prim, int object,
 	object_transform_light_sample(kg, ls, object, time);
 }
 
-ccl_device float triangle_light_pdf(KernelGlobals *kg,
+ccl_device float triangle_light_pdf_area(float pdf,
 	const float3 Ng, const float3 I, float t)
 {
-	float pdf = kernel_data.integrator.pdf_triangles;
 	float cos_pi = fabsf(dot(Ng, I));
 
 	if(cos_pi == 0.0f)
@@ -808,6 +807,206 @@ ccl_device float triangle_light_pdf(KernelGlobals *kg,
 	return t*t*pdf/cos_pi;
 }
 
+ccl_device float triangle_light_pdf(KernelGlobals *kg,
+	const float3 Ng, const float3 I, float t)
+{
+	return triangle_light_pdf_area(kernel_data.integrator.pdf_triangles, Ng, I, t);
+}
+
+/* Light Tree
+ *
+ * Emissive triangles are picked by walking down a tree, choosing children
+ * proportional to a conservative estimate of their contribution to P based
+ * on energy, distance and a two sided cone bounding emitter normals. The
+ * estimate ignores the receiver orientation, so that the same probability
+ * can be evaluated for MIS knowing only the previous path vertex. */
+
+ccl_device float light_tree_importance(float3 P, float4 data0, float4 data1, float4 data2)
+{
+	float energy = data0.w;
+
+	if(energy == 0.0f)
+		return 0.0f;
+
+	float3 bbox_min = float4_to_float3(data0);
+	float3 bbox_max = float4_to_float3(data1);
+	float3 axis = float4_to_float3(data2);
+	float cos_theta_o = data1.w;
+
+	float3 w = P - 0.5f*(bbox_min + bbox_max);
+	float radius2 = 0.25f*len_squared(bbox_max - bbox_min);
+	float dist2 = len_squared(w);
+
+	/* inside the bounding sphere no direction can be excluded */
+	if(dist2 <= radius2)
+		return energy/max(radius2, 1e-8f);
+
+	float dist = sqrtf(dist2);
+	float theta = safe_acosf(fabsf(dot(axis, w))/dist);
+	float theta_o = safe_acosf(cos_theta_o);
+	float theta_u = safe_asinf(sqrtf(radius2)/dist);
+	float theta_p = max(theta - theta_o - theta_u, 0.0f);
+
+	if(theta_p >= M_PI_2_F)
+		return 0.0f;
+
+	return energy*cosf(theta_p)/dist2;
+}
+
+ccl_device float light_tree_node_importance(KernelGlobals *kg, float3 P, int node)
+{
+	float4 data0 = kernel_tex_fetch(__light_tree_nodes, node*LIGHT_TREE_NODE_SIZE + 0);
+	float4 data1 = kernel_tex_fetch(__light_tree_nodes, node*LIGHT_TREE_NODE_SIZE + 1);
+	float4 data2 = kernel_tex_fetch(__light_tree_nodes, node*LIGHT_TREE_NODE_SIZE + 2);
+
+	return light_tree_importance(P, data0, data1, data2);
+}
+
+ccl_device float light_tree_emitter_importance(KernelGlobals *kg, float3 P, int emitter)
+{
+	float4 data0 = kernel_tex_fetch(__light_tree_emitters, emitter*LIGHT_TREE_EMITTER_SIZE + 0);
+	float4 data1 = kernel_tex_fetch(__light_tree_emitters, emitter*LIGHT_TREE_EMITTER_SIZE + 1);
+	float4 data2 = kernel_tex_fetch(__light_tree_emitters, emitter*LIGHT_TREE_EMITTER_SIZE + 2);
+
+	return light_tree_importance(P, data0, data1, data2);
+}
+
+ccl_device_inline float light_tree_rescale(float randt, float cdf_lo, float p)
+{
+	return min((randt - cdf_lo)/p, 1.0f - 1e-6f);
+}
+
+/* pick an emitter, returns its index and the probability of picking it.
+ * randt is rescaled at every level so it can be reused. */
+ccl_device int light_tree_sample(KernelGlobals *kg, float3 P, float randt, float *pdf)
+{
+	int node = 0;
+	*pdf = 1.0f;
+
+	for(;;) {
+		float4 data3 = kernel_tex_fetch(__light_tree_nodes, node*LIGHT_TREE_NODE_SIZE + 3);
+		int num_emitters = __float_as_int(data3.y);
+
+		if(num_emitters > 0) {
+			/* leaf, pick an emitter proportional to its importance */
+			int first = __float_as_int(data3.x);
+			float total = 0.0f;
+
+			for(int i = 0; i < num_emitters; i++)
+				total += light_tree_emitter_importance(kg, P, first + i);
+
+			if(total == 0.0f)
+				return -1;
+
+			float r = randt*total;
+			float cdf = 0.0f;
+
+			for(int i = 0; i < num_emitters; i++) {
+				float importance = light_tree_emitter_importance(kg, P, first + i);
+				cdf += importance;
+
+				if(importance > 0.0f && (r < cdf || i == num_emitters - 1)) {
+					*pdf *= importance/total;
+					return first + i;
+				}
+			}
+
+			return -1;
+		}
+
+		/* inner node, pick a child */
+		int left = node + 1;
+		int right = __float_as_int(data3.x);
+		float importance_left = light_tree_node_importance(kg, P, left);
+		float importance_right = light_tree_node_importance(kg, P, right);
+		float total = importance_left + importance_right;
+
+		if(total == 0.0f)
+			return -1;
+
+		float p_left = importance_left/total;
+
+		if(randt < p_left) {
+			randt = light_tree_rescale(randt, 0.0f, p_left);
+			*pdf *= p_left;
+			node = left;
+		}
+		else {
+			randt = light_tree_rescale(randt, p_left, 1.0f - p_left);
+			*pdf *= 1.0f - p_left;
+			node = right;
+		}
+	}
+}
+
+/* probability of light_tree_sample picking the given emitter */
+ccl_device float light_tree_pdf(KernelGlobals *kg, float3 P, int emitter)
+{
+	float4 edata3 = kernel_tex_fetch(__light_tree_emitters, emitter*LIGHT_TREE_EMITTER_SIZE + 3);
+	uint path = __float_as_uint(edata3.y);
+	int node = 0;
+	float pdf = 1.0f;
+
+	for(int depth = 0; ; depth++) {
+		float4 data3 = kernel_tex_fetch(__light_tree_nodes, node*LIGHT_TREE_NODE_SIZE + 3);
+		int num_emitters = __float_as_int(data3.y);
+
+		if(num_emitters > 0) {
+			int first = __float_as_int(data3.x);
+			float total = 0.0f;
+
+			for(int i = 0; i < num_emitters; i++)
+				total += light_tree_emitter_importance(kg, P, first + i);
+
+			if(total == 0.0f)
+				return 0.0f;
+
+			return pdf*light_tree_emitter_importance(kg, P, emitter)/total;
+		}
+
+		int left = node + 1;
+		int right = __float_as_int(data3.x);
+		float importance_left = light_tree_node_importance(kg, P, left);
+		float importance_right = light_tree_node_importance(kg, P, right);
+		float total = importance_left + importance_right;
+
+		if(total == 0.0f)
+			return 0.0f;
+
+		if(path & (1u << depth)) {
+			pdf *= importance_right/total;
+			node = right;
+		}
+		else {
+			pdf *= importance_left/total;
+			node = left;
+		}
+	}
+}
+
+/* emitter index of a triangle, or -1 if it is not in the tree */
+ccl_device int light_tree_triangle_emitter(KernelGlobals *kg, int object, int prim)
+{
+	uint offset = kernel_tex_fetch(__light_tree_map, 2*object);
+
+	if(offset == ~0u)
+		return -1;
+
+	uint tri_offset = kernel_tex_fetch(__light_tree_map, 2*object + 1);
+	uint emitter = kernel_tex_fetch(__light_tree_map, offset + prim - tri_offset);
+
+	return (emitter == ~0u)? -1: (int)emitter;
+}
+
+/* area measure pdf of sampling a point on the emitter from P */
+ccl_device float light_tree_triangle_pdf(KernelGlobals *kg, float3 P, int emitter)
+{
+	float4 edata2 = kernel_tex_fetch(__light_tree_emitters, emitter*LIGHT_TREE_EMITTER_SIZE + 2);
+	float area = edata2.w;
+
+	return kernel_data.integrator.light_tree_fraction*light_tree_pdf(kg, P, emitter)/area;
+}
+
 /* Light Distribution */
 
 ccl_device int light_distribution_sample(KernelGlobals *kg, float randt)
@@ -847,6 +1046,32 @@ ccl_device bool light_select_reached_max_bounces(KernelGlobals *kg, int index, i
 
 ccl_device void light_sample(KernelGlobals *kg, float randt, float randu, float randv, float time, float3 P, int bounce, LightSample *ls)
 {
+	/* pick emissive triangles from the light tree */
+	if(kernel_data.integrator.use_light_tree && randt < kernel_data.integrator.light_tree_fraction) {
+		float tree_pdf;
+		int emitter = light_tree_sample(kg, P, randt/kernel_data.integrator.light_tree_fraction, &tree_pdf);
+
+		if(emitter == -1) {
+			ls->pdf = 0.0f;
+			return;
+		}
+
+		float4 edata2 = kernel_tex_fetch(__light_tree_emitters, emitter*LIGHT_TREE_EMITTER_SIZE + 2);
+		float4 edata3 = kernel_tex_fetch(__light_tree_emitters, emitter*LIGHT_TREE_EMITTER_SIZE + 3);
+		float4 l = kernel_tex_fetch(__light_distribution, __float_as_int(edata3.x));
+		int prim = __float_as_int(l.y);
+		int object = __float_as_int(l.w);
+		int shader_flag = __float_as_int(l.z);
+		float pdf = kernel_data.integrator.light_tree_fraction*tree_pdf/edata2.w;
+
+		triangle_light_sample(kg, prim, object, randu, randv, time, ls);
+
+		ls->D = normalize_len(ls->P - P, &ls->t);
+		ls->pdf = triangle_light_pdf_area(pdf, ls->Ng, -ls->D, ls->t);
+		ls->shader |= shader_flag;
+		return;
+	}
+
 	/* sample index */
 	int index = light_distribution_sample(kg, randt);
 
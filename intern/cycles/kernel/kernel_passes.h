@@ -199,5 +199,31 @@ ccl_device_inline void kernel_write_light_passes(KernelGlobals *kg, ccl_global f
 #endif
 }
 
-CCL_NAMESPACE_END
+/* Adaptive sampling
+ *
+ * Every other sample is accumulated with double weight into an auxiliary
+ * pass, so it converges to the same value as the combined pass. The host
+ * compares both to estimate the per pixel error, and marks converged pixels
+ * by storing the sample count they converged at in the fourth component.
+ */
+
+ccl_device_inline bool kernel_adaptive_pixel_converged(KernelGlobals *kg, ccl_global float *buffer, int sample)
+{
+	if(sample == 0 || !(kernel_data.film.pass_flag & PASS_ADAPTIVE_AUX_BUFFER))
+		return false;
+
+	return buffer[kernel_data.film.pass_adaptive_aux_buffer + 3] != 0.0f;
+}
 
+ccl_device_inline void kernel_write_adaptive_buffer(KernelGlobals *kg, ccl_global float *buffer, int sample, float4 L)
+{
+	if(!(kernel_data.film.pass_flag & PASS_ADAPTIVE_AUX_BUFFER))
+		return;
+
+	float4 value = (sample & 1)? make_float4(2.0f*L.x, 2.0f*L.y, 2.0f*L.z, 0.0f):
+	                             make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+
+	kernel_write_pass_float4(buffer + kernel_data.film.pass_adaptive_aux_buffer, sample, value);
+}
+
+CCL_NAMESPACE_END
@@ -913,6 +913,10 @@ ccl_device void kernel_path_trace(KernelGlobals *kg,
 	rng_state += index;
 	buffer += index*pass_stride;
 
+	/* pixel was marked as converged by adaptive sampling */
+	if(kernel_adaptive_pixel_converged(kg, buffer, sample))
+		return;
+
 	/* initialize random numbers and ray */
 	RNG rng;
 	Ray ray;
@@ -929,6 +933,7 @@ ccl_device void kernel_path_trace(KernelGlobals *kg,
 
 	/* accumulate result in output buffer */
 	kernel_write_pass_float4(buffer, sample, L);
+	kernel_write_adaptive_buffer(kg, buffer, sample, L);
 
 	path_rng_end(kg, rng_state, rng);
 }
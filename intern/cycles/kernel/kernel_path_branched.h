@@ -18,6 +18,18 @@ CCL_NAMESPACE_BEGIN
 
 #ifdef __BRANCHED_PATH__
 
+#ifdef __KERNEL_CPU__
+/* accumulate AO for a packet of opaque shadow rays, given the blocked mask */
+ccl_device_inline void kernel_branched_path_ao_packet(PathRadiance *L, PathState *state, float3 throughput,
+	float3 ao_alpha, float3 ao_bsdf, uint blocked, int num_rays)
+{
+	for(int i = 0; i < num_rays; i++) {
+		if(!(blocked & (1 << i)))
+			path_radiance_accum_ao(L, throughput, ao_alpha, ao_bsdf, make_float3(1.0f, 1.0f, 1.0f), state->bounce);
+	}
+}
+#endif
+
 ccl_device void kernel_branched_path_ao(KernelGlobals *kg, ShaderData *sd, PathRadiance *L, PathState *state, RNG *rng, float3 throughput)
 {
 	int num_samples = kernel_data.integrator.ao_samples;
@@ -27,6 +39,17 @@ ccl_device void kernel_branched_path_ao(KernelGlobals *kg, ShaderData *sd, PathR
 	float3 ao_bsdf = shader_bsdf_ao(kg, sd, ao_factor, &ao_N);
 	float3 ao_alpha = shader_bsdf_alpha(kg, sd);
 
+#ifdef __KERNEL_CPU__
+	/* AO rays all leave the same point, so when only opaque occlusion needs
+	 * to be tested they are coherent enough to be traced as packets. */
+	bool use_packets = !kernel_data.integrator.transparent_shadows;
+#ifdef __VOLUME__
+	use_packets = use_packets && (state->volume_stack[0].shader == SHADER_NONE);
+#endif
+	Ray packet_rays[4];
+	int num_packet_rays = 0;
+#endif
+
 	for(int j = 0; j < num_samples; j++) {
 		float bsdf_u, bsdf_v;
 		path_branched_rng_2D(kg, rng, state, j, num_samples, PRNG_BSDF_U, &bsdf_u, &bsdf_v);
@@ -49,12 +72,32 @@ ccl_device void kernel_branched_path_ao(KernelGlobals *kg, ShaderData *sd, PathR
 			light_ray.dP = ccl_fetch(sd, dP);
 			light_ray.dD = differential3_zero();
 
+#ifdef __KERNEL_CPU__
+			if(use_packets) {
+				packet_rays[num_packet_rays++] = light_ray;
+				if(num_packet_rays == 4) {
+					kernel_branched_path_ao_packet(L, state, throughput*num_samples_inv, ao_alpha, ao_bsdf,
+					                               scene_intersect_shadow_packet(kg, packet_rays, num_packet_rays),
+					                               num_packet_rays);
+					num_packet_rays = 0;
+				}
+				continue;
+			}
+#endif
+
 			if(!shadow_blocked(kg, state, &light_ray, &ao_shadow))
 				path_radiance_accum_ao(L, throughput*num_samples_inv, ao_alpha, ao_bsdf, ao_shadow, state->bounce);
 		}
 	}
-}
 
+#ifdef __KERNEL_CPU__
+	if(num_packet_rays > 0) {
+		kernel_branched_path_ao_packet(L, state, throughput*num_samples_inv, ao_alpha, ao_bsdf,
+		                               scene_intersect_shadow_packet(kg, packet_rays, num_packet_rays),
+		                               num_packet_rays);
+	}
+#endif
+}
 
 /* bounce off surface and integrate indirect light */
 ccl_device_noinline void kernel_branched_path_surface_indirect_light(KernelGlobals *kg,
@@ -575,6 +618,10 @@ ccl_device void kernel_branched_path_trace(KernelGlobals *kg,
 	rng_state += index;
 	buffer += index*pass_stride;
 
+	/* pixel was marked as converged by adaptive sampling */
+	if(kernel_adaptive_pixel_converged(kg, buffer, sample))
+		return;
+
 	/* initialize random numbers and ray */
 	RNG rng;
 	Ray ray;
@@ -591,6 +638,7 @@ ccl_device void kernel_branched_path_trace(KernelGlobals *kg,
 
 	/* accumulate result in output buffer */
 	kernel_write_pass_float4(buffer, sample, L);
+	kernel_write_adaptive_buffer(kg, buffer, sample, L);
 
 	path_rng_end(kg, rng_state, rng);
 }
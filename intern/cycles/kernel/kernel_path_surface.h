@@ -48,6 +48,8 @@ ccl_device void kernel_branched_path_surface_connect_light(KernelGlobals *kg, RN
 			if(kernel_data.integrator.pdf_triangles != 0.0f)
 				num_samples_inv *= 0.5f;
 
+			LIGHT_STATS_SAMPLES(kg, i, num_samples);
+
 			for(int j = 0; j < num_samples; j++) {
 				float light_u, light_v;
 				path_branched_rng_2D(kg, &lamp_rng, state, j, num_samples, PRNG_LIGHT_U, &light_u, &light_v);
@@ -62,6 +64,7 @@ ccl_device void kernel_branched_path_surface_connect_light(KernelGlobals *kg, RN
 					if(!shadow_blocked(kg, state, &light_ray, &shadow)) {
 						/* accumulate */
 						path_radiance_accum_light(L, throughput*num_samples_inv, &L_light, shadow, num_samples_inv, state->bounce, is_lamp);
+						LIGHT_STATS_ADD(kg, i, average(throughput*bsdf_eval_sum(&L_light)*shadow));
 					}
 				}
 			}
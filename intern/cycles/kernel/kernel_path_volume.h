@@ -134,6 +134,8 @@ ccl_device void kernel_branched_path_volume_connect_light(KernelGlobals *kg, RNG
 			if(kernel_data.integrator.pdf_triangles != 0.0f)
 				num_samples_inv *= 0.5f;
 
+			LIGHT_STATS_SAMPLES(kg, i, num_samples);
+
 			for(int j = 0; j < num_samples; j++) {
 				/* sample random position on given light */
 				float light_u, light_v;
@@ -167,6 +169,7 @@ ccl_device void kernel_branched_path_volume_connect_light(KernelGlobals *kg, RNG
 					if(!shadow_blocked(kg, state, &light_ray, &shadow)) {
 						/* accumulate */
 						path_radiance_accum_light(L, tp*num_samples_inv, &L_light, shadow, num_samples_inv, state->bounce, is_lamp);
+						LIGHT_STATS_ADD(kg, i, average(tp*bsdf_eval_sum(&L_light)*shadow));
 					}
 				}
 			}
@@ -37,6 +37,8 @@ CCL_NAMESPACE_BEGIN
 #define OBJECT_SIZE 		11
 #define OBJECT_VECTOR_SIZE	6
 #define LIGHT_SIZE			5
+#define LIGHT_TREE_NODE_SIZE	4
+#define LIGHT_TREE_EMITTER_SIZE	4
 #define FILTER_TABLE_SIZE	1024
 #define RAMP_TABLE_SIZE		256
 #define SHUTTER_TABLE_SIZE		256
@@ -196,6 +198,12 @@ CCL_NAMESPACE_BEGIN
 #ifdef __NO_BRANCHED_PATH__
 #  undef __BRANCHED_PATH__
 #endif
+#ifdef __NO_VOLUME__
+#  undef __VOLUME__
+#  undef __VOLUME_DECOUPLED__
+#  undef __VOLUME_SCATTER__
+#  undef __VOLUME_RECORD_ALL__
+#endif
 
 /* Random Numbers */
 
@@ -351,10 +359,11 @@ typedef enum PassType {
 	PASS_SUBSURFACE_INDIRECT = (1 << 23),
 	PASS_SUBSURFACE_COLOR = (1 << 24),
 	PASS_LIGHT = (1 << 25), /* no real pass, used to force use_light_pass */
+	PASS_ADAPTIVE_AUX_BUFFER = (1 << 26), /* internal, used by adaptive sampling */
 #ifdef __KERNEL_DEBUG__
-	PASS_BVH_TRAVERSAL_STEPS = (1 << 26),
-	PASS_BVH_TRAVERSED_INSTANCES = (1 << 27),
-	PASS_RAY_BOUNCES = (1 << 28),
+	PASS_BVH_TRAVERSAL_STEPS = (1 << 27),
+	PASS_BVH_TRAVERSED_INSTANCES = (1 << 28),
+	PASS_RAY_BOUNCES = (1 << 29),
 #endif
 } PassType;
 
@@ -896,7 +905,7 @@ typedef struct KernelFilm {
 	int pass_shadow;
 	float pass_shadow_scale;
 	int filter_table_offset;
-	int pass_pad2;
+	int pass_adaptive_aux_buffer;
 
 	int pass_mist;
 	float mist_start;
@@ -993,7 +1002,14 @@ typedef struct KernelIntegrator {
 	float volume_step_size;
 	int volume_samples;
 
-	int pad;
+	/* adaptive sampling */
+	int adaptive_min_samples;
+	int adaptive_step;
+	float adaptive_threshold;
+
+	/* light tree */
+	int use_light_tree;
+	float light_tree_fraction;
 } KernelIntegrator;
 
 typedef struct KernelBVH {
@@ -1004,7 +1020,8 @@ typedef struct KernelBVH {
 	int have_curves;
 	int have_instancing;
 	int use_qbvh;
-	int pad1, pad2;
+	int num_motion_steps;
+	int pad1;
 } KernelBVH;
 
 typedef enum CurveFlag {
@@ -1082,6 +1099,10 @@ enum QueueNumber {
 	                                            */
 };
 
+/* Number of consecutive queue slots sorted by shader together by one work
+ * group of the shader sort kernel, must be a power of two. */
+#define SHADER_SORT_BLOCK_SIZE 2048
+
 /* We use RAY_STATE_MASK to get ray_state (enums 0 to 5) */
 #define RAY_STATE_MASK 0x007
 #define RAY_FLAG_MASK 0x0F8
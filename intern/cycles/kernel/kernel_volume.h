@@ -179,6 +179,8 @@ ccl_device void kernel_volume_shadow_heterogeneous(KernelGlobals *kg, PathState
 	float3 sum = make_float3(0.0f, 0.0f, 0.0f);
 
 	for(int i = 0; i < max_steps; i++) {
+		PROFILING_ADD(kg, PROFILING_VOLUME_STEPS, 1);
+
 		/* advance to new position */
 		float new_t = min(ray->t, (i+1) * step);
 		float dt = new_t - t;
@@ -448,6 +450,8 @@ ccl_device VolumeIntegrateResult kernel_volume_integrate_heterogeneous_distance(
 	bool has_scatter = false;
 
 	for(int i = 0; i < max_steps; i++) {
+		PROFILING_ADD(kg, PROFILING_VOLUME_STEPS, 1);
+
 		/* advance to new position */
 		float new_t = min(ray->t, (i+1) * step_size);
 		float dt = new_t - t;
@@ -654,6 +658,8 @@ ccl_device void kernel_volume_decoupled_record(KernelGlobals *kg, PathState *sta
 	VolumeStep *step = segment->steps;
 
 	for(int i = 0; i < max_steps; i++, step++) {
+		PROFILING_ADD(kg, PROFILING_VOLUME_STEPS, 1);
+
 		/* advance to new position */
 		float new_t = min(ray->t, (i+1) * step_size);
 		float dt = new_t - t;
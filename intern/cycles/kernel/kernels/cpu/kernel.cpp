@@ -42,6 +42,21 @@ void kernel_const_copy(KernelGlobals *kg, const char *name, void *host, size_t s
 		assert(0);
 }
 
+template<typename T>
+static void kernel_tex_image_set(texture_image<T> *tex,
+                                 T *data,
+                                 size_t width,
+                                 size_t height,
+                                 size_t depth,
+                                 InterpolationType interpolation,
+                                 ExtensionType extension)
+{
+	tex->data = data;
+	tex->dimensions_set(width, height, depth);
+	tex->interpolation = interpolation;
+	tex->extension = extension;
+}
+
 void kernel_tex_copy(KernelGlobals *kg,
                      const char *name,
                      device_ptr mem,
@@ -62,6 +77,35 @@ void kernel_tex_copy(KernelGlobals *kg,
 #define KERNEL_IMAGE_TEX(type, ttype, tname)
 #include "kernel_textures.h"
 
+	else if(strstr(name, "__tex_image_half4")) {
+		int array_index = atoi(name + strlen("__tex_image_half4_"));
+
+		if(array_index >= 0 && array_index < MAX_FLOAT_IMAGES) {
+			kernel_tex_image_set(&kg->texture_half4_images[array_index],
+			                     (half4*)mem, width, height, depth,
+			                     interpolation, extension);
+			kg->texture_half_images[array_index].data = NULL;
+		}
+	}
+	else if(strstr(name, "__tex_image_half")) {
+		int array_index = atoi(name + strlen("__tex_image_half_"));
+
+		if(array_index >= 0 && array_index < MAX_FLOAT_IMAGES) {
+			kernel_tex_image_set(&kg->texture_half_images[array_index],
+			                     (half*)mem, width, height, depth,
+			                     interpolation, extension);
+			kg->texture_half4_images[array_index].data = NULL;
+		}
+	}
+	else if(strstr(name, "__tex_image_byte")) {
+		int array_index = atoi(name + strlen("__tex_image_byte_")) - MAX_FLOAT_IMAGES;
+
+		if(array_index >= 0 && array_index < MAX_BYTE_IMAGES) {
+			kernel_tex_image_set(&kg->texture_byte1_images[array_index],
+			                     (uchar*)mem, width, height, depth,
+			                     interpolation, extension);
+		}
+	}
 	else if(strstr(name, "__tex_image_float")) {
 		texture_image_float4 *tex = NULL;
 		int id = atoi(name + strlen("__tex_image_float_"));
@@ -69,6 +113,10 @@ void kernel_tex_copy(KernelGlobals *kg,
 
 		if(array_index >= 0 && array_index < MAX_FLOAT_IMAGES) {
 			tex = &kg->texture_float_images[array_index];
+
+			/* full precision image replaces compact storage of the slot */
+			kg->texture_half4_images[array_index].data = NULL;
+			kg->texture_half_images[array_index].data = NULL;
 		}
 
 		if(tex) {
@@ -85,6 +133,7 @@ void kernel_tex_copy(KernelGlobals *kg,
 
 		if(array_index >= 0 && array_index < MAX_BYTE_IMAGES) {
 			tex = &kg->texture_byte_images[array_index];
+			kg->texture_byte1_images[array_index].data = NULL;
 		}
 
 		if(tex) {
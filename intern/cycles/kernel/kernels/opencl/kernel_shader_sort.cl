@@ -0,0 +1,39 @@
+/*
+ * Copyright 2011-2015 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "split/kernel_shader_sort.h"
+
+__kernel void kernel_ocl_path_trace_shader_sort(
+        ccl_global char *kg,
+        ccl_constant KernelData *data,
+        Intersection *Intersection_coop,       /* Required for the shader of the hit */
+        ccl_global char *ray_state,            /* Denotes the state of each ray */
+        ccl_global int *Queue_data,            /* Queue memory */
+        ccl_global int *Queue_index,           /* Tracks the number of elements in each queue */
+        int queuesize)                         /* Size (capacity) of each queue */
+{
+	ccl_local uint local_key[SHADER_SORT_BLOCK_SIZE];
+	ccl_local int local_value[SHADER_SORT_BLOCK_SIZE];
+
+	kernel_shader_sort((KernelGlobals *)kg,
+	                   Intersection_coop,
+	                   ray_state,
+	                   Queue_data,
+	                   Queue_index,
+	                   queuesize,
+	                   local_key,
+	                   local_value);
+}
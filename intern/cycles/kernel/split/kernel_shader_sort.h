@@ -0,0 +1,140 @@
+/*
+ * Copyright 2011-2015 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "kernel_split_common.h"
+
+/* Note on kernel_shader_sort kernel
+ * This kernel runs between kernel_background_buffer_update and
+ * kernel_shader_eval. It reorders the QUEUE_ACTIVE_AND_REGENERATED_RAYS queue
+ * so that rays which hit surfaces with the same shader are processed by
+ * neighbouring threads, which keeps the threads of a warp or wavefront in the
+ * same branch of the SVM interpreter during shader evaluation.
+ *
+ * Every work group sorts one block of SHADER_SORT_BLOCK_SIZE queue slots in
+ * local memory with a bitonic sort, non active rays and empty slots are moved
+ * to the end of the block.
+ *
+ * The input and output of the kernel is as follows,
+ * Intersection_coop ----------------------------------|--- kernel_shader_sort --|--- Queue_data (QUEUE_ACTIVE_AND_REGENERATED_RAYS)
+ * Queue_data (QUEUE_ACTIVE_AND_REGENERATED_RAYS)-------|                         |
+ * Queue_index(QUEUE_ACTIVE_AND_REGENERATED_RAYS)-------|                         |
+ * ray_state ------------------------------------------|                         |
+ * kg (globals) ---------------------------------------|                         |
+ * queuesize ------------------------------------------|                         |
+ *
+ * Note on Queues :
+ * All kernels after this one fetch their ray index from the queue slot of
+ * their own thread, since ShaderData is stored per thread the queue must not be
+ * reordered again until the next path iteration.
+ * at entry,
+ * QUEUE_ACTIVE_AND_REGENERATED_RAYS will be filled with RAY_ACTIVE and RAY_REGENERATED rays
+ * at exit,
+ * QUEUE_ACTIVE_AND_REGENERATED_RAYS will be filled with the same rays, sorted by shader within blocks
+ */
+
+#define SHADER_SORT_KEY_INACTIVE 0xFFFFFFFE
+#define SHADER_SORT_KEY_EMPTY 0xFFFFFFFF
+
+ccl_device uint kernel_shader_sort_key(
+        KernelGlobals *kg,
+        Intersection *Intersection_coop,
+        ccl_global char *ray_state,
+        int ray_index)
+{
+	if(ray_index == QUEUE_EMPTY_SLOT)
+		return SHADER_SORT_KEY_EMPTY;
+	if(!IS_STATE(ray_state, ray_index, RAY_ACTIVE))
+		return SHADER_SORT_KEY_INACTIVE;
+
+	Intersection *isect = &Intersection_coop[ray_index];
+	int prim = kernel_tex_fetch(__prim_index, isect->prim);
+	int shader;
+
+#ifdef __HAIR__
+	if(isect->type & PRIMITIVE_ALL_TRIANGLE) {
+#endif
+		shader = kernel_tex_fetch(__tri_shader, prim);
+#ifdef __HAIR__
+	}
+	else {
+		float4 str = kernel_tex_fetch(__curves, prim);
+		shader = __float_as_int(str.z);
+	}
+#endif
+
+	return (uint)(shader & SHADER_MASK);
+}
+
+ccl_device void kernel_shader_sort(
+        KernelGlobals *kg,
+        Intersection *Intersection_coop,       /* Required for the shader of the hit */
+        ccl_global char *ray_state,            /* Denotes the state of each ray */
+        ccl_global int *Queue_data,            /* Queue memory */
+        ccl_global int *Queue_index,           /* Tracks the number of elements in each queue */
+        int queuesize,                         /* Size (capacity) of each queue */
+        ccl_local uint *local_key,             /* SHADER_SORT_BLOCK_SIZE sort keys */
+        ccl_local int *local_value)            /* SHADER_SORT_BLOCK_SIZE ray indices */
+{
+	int num_rays = min(Queue_index[QUEUE_ACTIVE_AND_REGENERATED_RAYS], queuesize);
+	int block = get_group_id(1) * get_num_groups(0) + get_group_id(0);
+	int block_start = block * SHADER_SORT_BLOCK_SIZE;
+
+	if(block_start >= num_rays)
+		return;
+
+	int block_end = min(block_start + SHADER_SORT_BLOCK_SIZE, num_rays);
+	int lidx = get_local_id(1) * get_local_size(0) + get_local_id(0);
+	int local_size = get_local_size(0) * get_local_size(1);
+	ccl_global int *queue = Queue_data + QUEUE_ACTIVE_AND_REGENERATED_RAYS * queuesize;
+
+	/* load keys, slots past the end of the queue sort last */
+	for(int i = lidx; i < SHADER_SORT_BLOCK_SIZE; i += local_size) {
+		int ray_index = (block_start + i < block_end)? queue[block_start + i]: QUEUE_EMPTY_SLOT;
+
+		local_key[i] = kernel_shader_sort_key(kg, Intersection_coop, ray_state, ray_index);
+		local_value[i] = ray_index;
+	}
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	/* bitonic sort */
+	for(uint k = 2; k <= SHADER_SORT_BLOCK_SIZE; k <<= 1) {
+		for(uint j = k >> 1; j > 0; j >>= 1) {
+			for(uint i = lidx; i < SHADER_SORT_BLOCK_SIZE; i += local_size) {
+				uint ixj = i ^ j;
+
+				if(ixj > i) {
+					bool ascending = ((i & k) == 0);
+					uint key_i = local_key[i];
+					uint key_ixj = local_key[ixj];
+
+					if((key_i > key_ixj) == ascending) {
+						int value_i = local_value[i];
+
+						local_key[i] = key_ixj;
+						local_key[ixj] = key_i;
+						local_value[i] = local_value[ixj];
+						local_value[ixj] = value_i;
+					}
+				}
+			}
+			barrier(CLK_LOCAL_MEM_FENCE);
+		}
+	}
+
+	/* write back, the block holds the same rays so empty slots stay at the end */
+	for(int i = lidx; i < block_end - block_start; i += local_size)
+		queue[block_start + i] = local_value[i];
+}
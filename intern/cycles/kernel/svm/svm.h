@@ -192,9 +192,13 @@ ccl_device_noinline void svm_eval_nodes(KernelGlobals *kg, ShaderData *sd, Shade
 	float stack[SVM_STACK_SIZE];
 	int offset = ccl_fetch(sd, shader) & SHADER_MASK;
 
+	PROFILING_SHADER_EVAL(kg, offset);
+
 	while(1) {
 		uint4 node = read_node(kg, &offset);
 
+		PROFILING_SHADER_NODE(kg, ccl_fetch(sd, shader) & SHADER_MASK);
+
 		switch(node.x) {
 #if NODES_GROUP(NODE_GROUP_LEVEL_0)
 			case NODE_SHADER_JUMP: {
@@ -101,6 +101,10 @@ BakeManager::BakeManager()
 	m_is_baking = false;
 	need_update = true;
 	m_shader_limit = 512 * 512;
+	m_tile_offset = 0;
+	m_tile_bake_data = NULL;
+	m_tile_result = NULL;
+	m_tile_progress = NULL;
 }
 
 BakeManager::~BakeManager()
@@ -136,94 +140,129 @@ bool BakeManager::bake(Device *device, DeviceScene *dscene, Scene *scene, Progre
 	size_t num_pixels = bake_data->size();
 
 	progress.reset_sample();
-	this->num_parts = 0;
-
-	/* calculate the total parts for the progress bar */
-	for(size_t shader_offset = 0; shader_offset < num_pixels; shader_offset += m_shader_limit) {
-		size_t shader_size = (size_t)fminf(num_pixels - shader_offset, m_shader_limit);
+	this->num_parts = (num_pixels + m_shader_limit - 1) / m_shader_limit;
+	this->num_samples = is_aa_pass(shader_type)? scene->integrator->aa_samples : 1;
 
-		DeviceTask task(DeviceTask::SHADER);
-		task.shader_w = shader_size;
+	if(num_pixels == 0) {
+		m_is_baking = false;
+		return false;
+	}
 
-		this->num_parts += device->get_split_task_count(task);
+	if(device->info.type == DEVICE_NETWORK) {
+		progress.set_error("Baking is not supported on network devices");
+		m_is_baking = false;
+		return false;
 	}
 
-	this->num_samples = is_aa_pass(shader_type)? scene->integrator->aa_samples : 1;
+	/* needs to be up to data for attribute access */
+	device->const_copy_to("__data", &dscene->data, sizeof(dscene->data));
+
+	/* tiles are acquired by every device and thread until all pixels are
+	 * baked, so faster devices bake more tiles */
+	m_tile_offset = 0;
+	m_tile_bake_data = bake_data;
+	m_tile_result = result;
+	m_tile_progress = &progress;
+
+	DeviceTask task(DeviceTask::SHADER);
+	task.shader_eval_type = shader_type;
+	task.num_samples = this->num_samples;
+	task.acquire_shader_tile = function_bind(&BakeManager::acquire_tile, this, _1, _2);
+	task.release_shader_tile = function_bind(&BakeManager::release_tile, this, _1, _2);
+	task.get_cancel = function_bind(&Progress::get_cancel, &progress);
+	task.update_progress_sample = function_bind(&Progress::increment_sample_update, &progress);
+
+	device->task_add(task);
+	device->task_wait();
+
+	m_tile_bake_data = NULL;
+	m_tile_result = NULL;
+	m_tile_progress = NULL;
+	m_is_baking = false;
 
-	for(size_t shader_offset = 0; shader_offset < num_pixels; shader_offset += m_shader_limit) {
-		size_t shader_size = (size_t)fminf(num_pixels - shader_offset, m_shader_limit);
+	return !progress.get_cancel();
+}
 
-		/* setup input for device task */
-		device_vector<uint4> d_input;
-		uint4 *d_input_data = d_input.resize(shader_size * 2);
-		size_t d_input_size = 0;
+bool BakeManager::acquire_tile(Device *device, DeviceTask& task)
+{
+	BakeTile *tile = new BakeTile();
 
-		for(size_t i = shader_offset; i < (shader_offset + shader_size); i++) {
-			d_input_data[d_input_size++] = bake_data->data(i);
-			d_input_data[d_input_size++] = bake_data->differentials(i);
-		}
+	{
+		thread_scoped_lock tile_lock(m_tile_mutex);
 
-		if(d_input_size == 0) {
-			m_is_baking = false;
+		if(m_tile_offset >= m_tile_bake_data->size() || m_tile_progress->get_cancel()) {
+			delete tile;
 			return false;
 		}
 
-		/* run device task */
-		device_vector<float4> d_output;
-		d_output.resize(shader_size);
-
-		/* needs to be up to data for attribute access */
-		device->const_copy_to("__data", &dscene->data, sizeof(dscene->data));
-
-		device->mem_alloc(d_input, MEM_READ_ONLY);
-		device->mem_copy_to(d_input);
-		device->mem_alloc(d_output, MEM_WRITE_ONLY);
-
-		DeviceTask task(DeviceTask::SHADER);
-		task.shader_input = d_input.device_pointer;
-		task.shader_output = d_output.device_pointer;
-		task.shader_eval_type = shader_type;
-		task.shader_x = 0;
-		task.offset = shader_offset;
-		task.shader_w = d_output.size();
-		task.num_samples = this->num_samples;
-		task.get_cancel = function_bind(&Progress::get_cancel, &progress);
-		task.update_progress_sample = function_bind(&Progress::increment_sample_update, &progress);
-
-		device->task_add(task);
-		device->task_wait();
-
-		if(progress.get_cancel()) {
-			device->mem_free(d_input);
-			device->mem_free(d_output);
-			m_is_baking = false;
-			return false;
-		}
+		tile->offset = m_tile_offset;
+		tile->size = m_tile_bake_data->size() - m_tile_offset;
+		if(tile->size > m_shader_limit)
+			tile->size = m_shader_limit;
+		m_tile_offset += tile->size;
+	}
+
+	/* setup input for device task */
+	uint4 *d_input_data = tile->input.resize(tile->size * 2);
+	size_t d_input_size = 0;
+
+	for(size_t i = tile->offset; i < (tile->offset + tile->size); i++) {
+		d_input_data[d_input_size++] = m_tile_bake_data->data(i);
+		d_input_data[d_input_size++] = m_tile_bake_data->differentials(i);
+	}
+
+	tile->output.resize(tile->size);
 
-		device->mem_copy_from(d_output, 0, 1, d_output.size(), sizeof(float4));
-		device->mem_free(d_input);
-		device->mem_free(d_output);
+	device->mem_alloc(tile->input, MEM_READ_ONLY);
+	device->mem_copy_to(tile->input);
+	device->mem_alloc(tile->output, MEM_WRITE_ONLY);
 
-		/* read result */
-		int k = 0;
+	task.shader_input = tile->input.device_pointer;
+	task.shader_output = tile->output.device_pointer;
+	task.shader_x = 0;
+	task.shader_w = tile->size;
+	task.offset = tile->offset;
 
-		float4 *offset = (float4*)d_output.data_pointer;
+	thread_scoped_lock tile_lock(m_tile_mutex);
+	m_tiles[BakeTileKey(device, tile->output.device_pointer)] = tile;
 
+	return true;
+}
+
+void BakeManager::release_tile(Device *device, DeviceTask& task)
+{
+	BakeTile *tile;
+
+	{
+		thread_scoped_lock tile_lock(m_tile_mutex);
+		map<BakeTileKey, BakeTile*>::iterator it = m_tiles.find(BakeTileKey(device, task.shader_output));
+
+		assert(it != m_tiles.end());
+		tile = it->second;
+		m_tiles.erase(it);
+	}
+
+	if(!m_tile_progress->get_cancel()) {
+		device->mem_copy_from(tile->output, 0, 1, tile->output.size(), sizeof(float4));
+
+		/* read result, tiles do not overlap so no lock is needed */
+		float4 *output = (float4*)tile->output.data_pointer;
 		size_t depth = 4;
-		for(size_t i=shader_offset; i < (shader_offset + shader_size); i++) {
-			size_t index = i * depth;
-			float4 out = offset[k++];
-
-			if(bake_data->is_valid(i)) {
-				for(size_t j=0; j < 4; j++) {
-					result[index + j] = out[j];
-				}
+
+		for(size_t i = 0; i < tile->size; i++) {
+			size_t pixel = tile->offset + i;
+
+			if(m_tile_bake_data->is_valid(pixel)) {
+				for(size_t j = 0; j < depth; j++)
+					m_tile_result[pixel * depth + j] = output[i][j];
 			}
 		}
 	}
 
-	m_is_baking = false;
-	return true;
+	device->mem_free(tile->input);
+	device->mem_free(tile->output);
+
+	delete tile;
 }
 
 void BakeManager::device_update(Device * /*device*/,
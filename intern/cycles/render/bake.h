@@ -20,7 +20,9 @@
 #include "device.h"
 #include "scene.h"
 
+#include "util_map.h"
 #include "util_progress.h"
+#include "util_thread.h"
 #include "util_vector.h"
 
 CCL_NAMESPACE_BEGIN
@@ -51,6 +53,20 @@ private:
 	vector<float>m_dvdy;
 };
 
+/* Bake Tile
+ *
+ * Range of pixels evaluated at once, with input and output memory allocated
+ * on the device that acquired it. */
+
+class BakeTile {
+public:
+	size_t offset;
+	size_t size;
+
+	device_vector<uint4> input;
+	device_vector<float4> output;
+};
+
 class BakeManager {
 public:
 	BakeManager();
@@ -80,6 +96,20 @@ private:
 	BakeData *m_bake_data;
 	bool m_is_baking;
 	size_t m_shader_limit;
+
+	/* tile scheduling, all devices and threads keep acquiring tiles of
+	 * m_shader_limit pixels until the whole bake is done */
+	typedef pair<Device*, device_ptr> BakeTileKey;
+
+	bool acquire_tile(Device *device, DeviceTask& task);
+	void release_tile(Device *device, DeviceTask& task);
+
+	thread_mutex m_tile_mutex;
+	size_t m_tile_offset;
+	BakeData *m_tile_bake_data;
+	float *m_tile_result;
+	Progress *m_tile_progress;
+	map<BakeTileKey, BakeTile*> m_tiles;
 };
 
 CCL_NAMESPACE_END
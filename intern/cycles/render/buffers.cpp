@@ -76,6 +76,7 @@ int BufferParams::get_passes_size()
 
 RenderTile::RenderTile()
 {
+	tile_index = 0;
 	x = 0;
 	y = 0;
 	w = 0;
@@ -131,6 +131,7 @@ protected:
 
 class RenderTile {
 public:
+	int tile_index;
 	int x, y, w, h;
 	int start_sample;
 	int num_samples;
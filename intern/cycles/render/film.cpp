@@ -153,6 +153,13 @@ void Pass::add(PassType type, vector<Pass>& passes)
 			 */
 			pass.components = 0;
 			break;
+		case PASS_ADAPTIVE_AUX_BUFFER:
+			/* Accumulates every other sample, with the number of samples
+			 * the pixel converged at stored in the fourth component.
+			 */
+			pass.components = 4;
+			pass.filter = false;
+			break;
 #ifdef WITH_CYCLES_DEBUG
 		case PASS_BVH_TRAVERSAL_STEPS:
 			pass.components = 1;
@@ -404,6 +411,10 @@ void Film::device_update(Device *device, DeviceScene *dscene, Scene *scene)
 				kfilm->use_light_pass = 1;
 				break;
 
+			case PASS_ADAPTIVE_AUX_BUFFER:
+				kfilm->pass_adaptive_aux_buffer = kfilm->pass_stride;
+				break;
+
 #ifdef WITH_CYCLES_DEBUG
 			case PASS_BVH_TRAVERSAL_STEPS:
 				kfilm->pass_bvh_traversal_steps = kfilm->pass_stride;
@@ -33,6 +33,8 @@ ImageManager::ImageManager()
 {
 	need_update = true;
 	pack_images = false;
+	max_texture_size = 0;
+	compact_textures = false;
 	osl_texture_system = NULL;
 	animation_frame = 0;
 
@@ -54,6 +56,16 @@ void ImageManager::set_pack_images(bool pack_images_)
 	pack_images = pack_images_;
 }
 
+void ImageManager::set_max_texture_size(int max_texture_size_)
+{
+	max_texture_size = max_texture_size_;
+}
+
+void ImageManager::set_compact_textures(bool compact_textures_)
+{
+	compact_textures = compact_textures_;
+}
+
 void ImageManager::set_osl_texture_system(void *texture_system)
 {
 	osl_texture_system = texture_system;
@@ -398,6 +410,101 @@ void ImageManager::tag_reload_image(const string& filename,
 	}
 }
 
+/* Texture size limit
+ *
+ * Images larger than the limit are reduced by repeated 2x2 box filtering,
+ * which gives the same result as keeping the first mip level that fits. */
+
+static inline uchar4 image_box_filter(uchar4 a, uchar4 b, uchar4 c, uchar4 d)
+{
+	return make_uchar4((a.x + b.x + c.x + d.x + 2) / 4,
+	                   (a.y + b.y + c.y + d.y + 2) / 4,
+	                   (a.z + b.z + c.z + d.z + 2) / 4,
+	                   (a.w + b.w + c.w + d.w + 2) / 4);
+}
+
+static inline float4 image_box_filter(float4 a, float4 b, float4 c, float4 d)
+{
+	return (a + b + c + d) * 0.25f;
+}
+
+template<typename T>
+static void image_scale_to_limit(device_vector<T>& tex_img, int max_size)
+{
+	int width = tex_img.data_width;
+	int height = tex_img.data_height;
+
+	if(max_size <= 0 || tex_img.data_depth > 1)
+		return;
+	if(width <= max_size && height <= max_size)
+		return;
+
+	vector<T> pixels((T*)tex_img.data_pointer, (T*)tex_img.data_pointer + ((size_t)width)*height);
+
+	while(width > max_size || height > max_size) {
+		int scaled_width = max(width/2, 1);
+		int scaled_height = max(height/2, 1);
+
+		for(int y = 0; y < scaled_height; y++) {
+			int y0 = min(y*2, height - 1), y1 = min(y*2 + 1, height - 1);
+
+			for(int x = 0; x < scaled_width; x++) {
+				int x0 = min(x*2, width - 1), x1 = min(x*2 + 1, width - 1);
+
+				/* in place is safe, the destination never passes the source */
+				pixels[((size_t)y)*scaled_width + x] =
+					image_box_filter(pixels[((size_t)y0)*width + x0],
+					                 pixels[((size_t)y0)*width + x1],
+					                 pixels[((size_t)y1)*width + x0],
+					                 pixels[((size_t)y1)*width + x1]);
+			}
+		}
+
+		width = scaled_width;
+		height = scaled_height;
+	}
+
+	/* reallocate so the memory of the full resolution image is freed */
+	tex_img.clear();
+	tex_img.copy(&pixels[0], width, height);
+}
+
+/* Compact storage
+ *
+ * Float images are stored as half floats, and grayscale images without
+ * alpha keep a single channel, which the CPU kernel expands on lookup. */
+
+static bool image_is_grayscale(const uchar4 *pixels, size_t num_pixels)
+{
+	for(size_t i = 0; i < num_pixels; i++) {
+		const uchar4& p = pixels[i];
+		if(p.x != p.y || p.x != p.z || p.w != 255)
+			return false;
+	}
+
+	return true;
+}
+
+static bool image_is_grayscale(const float4 *pixels, size_t num_pixels)
+{
+	for(size_t i = 0; i < num_pixels; i++) {
+		const float4& p = pixels[i];
+		if(p.x != p.y || p.x != p.z || p.w != 1.0f)
+			return false;
+	}
+
+	return true;
+}
+
+template<typename T>
+static void image_tex_free(Device *device, device_vector<T>& tex_img)
+{
+	if(tex_img.device_pointer)
+		device->tex_free(tex_img);
+
+	tex_img.clear();
+}
+
 bool ImageManager::file_load_image(Image *img, device_vector<uchar4>& tex_img)
 {
 	if(img->filename == "")
@@ -696,12 +803,18 @@ void ImageManager::device_load_image(Device *device, DeviceScene *dscene, int sl
 		progress->set_status("Updating Images", "Loading " + filename);
 
 		device_vector<float4>& tex_img = dscene->tex_float_image[slot];
+		device_vector<half4>& tex_half4 = dscene->tex_half4_image[slot];
+		device_vector<half>& tex_half = dscene->tex_half_image[slot];
 
-		if(tex_img.device_pointer) {
+		if(tex_img.device_pointer || tex_half4.device_pointer || tex_half.device_pointer) {
 			thread_scoped_lock device_lock(device_mutex);
-			device->tex_free(tex_img);
+			image_tex_free(device, tex_img);
+			image_tex_free(device, tex_half4);
+			image_tex_free(device, tex_half);
 		}
 
+		bool compact = false;
+
 		if(!file_load_float_image(img, tex_img)) {
 			/* on failure to load, we set a 1x1 pixels pink image */
 			float *pixels = (float*)tex_img.resize(1, 1);
@@ -711,6 +824,10 @@ void ImageManager::device_load_image(Device *device, DeviceScene *dscene, int sl
 			pixels[2] = TEX_IMAGE_MISSING_B;
 			pixels[3] = TEX_IMAGE_MISSING_A;
 		}
+		else {
+			image_scale_to_limit(tex_img, max_texture_size);
+			compact = compact_textures && !pack_images;
+		}
 
 		string name;
 
@@ -718,7 +835,47 @@ void ImageManager::device_load_image(Device *device, DeviceScene *dscene, int sl
 		else if(slot >= 10) name = string_printf("__tex_image_float_0%d", slot);
 		else name = string_printf("__tex_image_float_00%d", slot);
 
-		if(!pack_images) {
+		if(compact) {
+			const float4 *pixels = (const float4*)tex_img.data_pointer;
+			size_t num_pixels = tex_img.size();
+			int width = tex_img.data_width;
+			int height = tex_img.data_height;
+			int depth = tex_img.data_depth;
+
+			if(image_is_grayscale(pixels, num_pixels)) {
+				half *half_pixels = tex_half.resize(width, height, depth);
+
+				for(size_t i = 0; i < num_pixels; i++)
+					half_pixels[i] = float_to_half(pixels[i].x);
+
+				tex_img.clear();
+
+				thread_scoped_lock device_lock(device_mutex);
+				device->tex_alloc(string_printf("__tex_image_half_%03d", slot).c_str(),
+				                  tex_half,
+				                  img->interpolation,
+				                  img->extension);
+			}
+			else {
+				half4 *half_pixels = tex_half4.resize(width, height, depth);
+
+				for(size_t i = 0; i < num_pixels; i++) {
+					half_pixels[i].x = float_to_half(pixels[i].x);
+					half_pixels[i].y = float_to_half(pixels[i].y);
+					half_pixels[i].z = float_to_half(pixels[i].z);
+					half_pixels[i].w = float_to_half(pixels[i].w);
+				}
+
+				tex_img.clear();
+
+				thread_scoped_lock device_lock(device_mutex);
+				device->tex_alloc(string_printf("__tex_image_half4_%03d", slot).c_str(),
+				                  tex_half4,
+				                  img->interpolation,
+				                  img->extension);
+			}
+		}
+		else if(!pack_images) {
 			thread_scoped_lock device_lock(device_mutex);
 			device->tex_alloc(name.c_str(),
 			                  tex_img,
@@ -731,12 +888,16 @@ void ImageManager::device_load_image(Device *device, DeviceScene *dscene, int sl
 		progress->set_status("Updating Images", "Loading " + filename);
 
 		device_vector<uchar4>& tex_img = dscene->tex_image[slot - tex_image_byte_start];
+		device_vector<uchar>& tex_byte = dscene->tex_byte_image[slot - tex_image_byte_start];
 
-		if(tex_img.device_pointer) {
+		if(tex_img.device_pointer || tex_byte.device_pointer) {
 			thread_scoped_lock device_lock(device_mutex);
-			device->tex_free(tex_img);
+			image_tex_free(device, tex_img);
+			image_tex_free(device, tex_byte);
 		}
 
+		bool compact = false;
+
 		if(!file_load_image(img, tex_img)) {
 			/* on failure to load, we set a 1x1 pixels pink image */
 			uchar *pixels = (uchar*)tex_img.resize(1, 1);
@@ -746,6 +907,11 @@ void ImageManager::device_load_image(Device *device, DeviceScene *dscene, int sl
 			pixels[2] = (TEX_IMAGE_MISSING_B * 255);
 			pixels[3] = (TEX_IMAGE_MISSING_A * 255);
 		}
+		else {
+			image_scale_to_limit(tex_img, max_texture_size);
+			compact = compact_textures && !pack_images &&
+			          image_is_grayscale((const uchar4*)tex_img.data_pointer, tex_img.size());
+		}
 
 		string name;
 
@@ -753,7 +919,25 @@ void ImageManager::device_load_image(Device *device, DeviceScene *dscene, int sl
 		else if(slot >= 10) name = string_printf("__tex_image_0%d", slot);
 		else name = string_printf("__tex_image_00%d", slot);
 
-		if(!pack_images) {
+		if(compact) {
+			const uchar4 *pixels = (const uchar4*)tex_img.data_pointer;
+			size_t num_pixels = tex_img.size();
+			uchar *byte_pixels = tex_byte.resize(tex_img.data_width,
+			                                     tex_img.data_height,
+			                                     tex_img.data_depth);
+
+			for(size_t i = 0; i < num_pixels; i++)
+				byte_pixels[i] = pixels[i].x;
+
+			tex_img.clear();
+
+			thread_scoped_lock device_lock(device_mutex);
+			device->tex_alloc(string_printf("__tex_image_byte_%03d", slot).c_str(),
+			                  tex_byte,
+			                  img->interpolation,
+			                  img->extension);
+		}
+		else if(!pack_images) {
 			thread_scoped_lock device_lock(device_mutex);
 			device->tex_alloc(name.c_str(),
 			                  tex_img,
@@ -787,27 +971,20 @@ void ImageManager::device_free_image(Device *device, DeviceScene *dscene, int sl
 #endif
 		}
 		else if(is_float) {
-			device_vector<float4>& tex_img = dscene->tex_float_image[slot];
-
-			if(tex_img.device_pointer) {
-				thread_scoped_lock device_lock(device_mutex);
-				device->tex_free(tex_img);
-			}
-
-			tex_img.clear();
+			thread_scoped_lock device_lock(device_mutex);
+			image_tex_free(device, dscene->tex_float_image[slot]);
+			image_tex_free(device, dscene->tex_half4_image[slot]);
+			image_tex_free(device, dscene->tex_half_image[slot]);
+			device_lock.unlock();
 
 			delete float_images[slot];
 			float_images[slot] = NULL;
 		}
 		else {
-			device_vector<uchar4>& tex_img = dscene->tex_image[slot - tex_image_byte_start];
-
-			if(tex_img.device_pointer) {
-				thread_scoped_lock device_lock(device_mutex);
-				device->tex_free(tex_img);
-			}
-
-			tex_img.clear();
+			thread_scoped_lock device_lock(device_mutex);
+			image_tex_free(device, dscene->tex_image[slot - tex_image_byte_start]);
+			image_tex_free(device, dscene->tex_byte_image[slot - tex_image_byte_start]);
+			device_lock.unlock();
 
 			delete images[slot - tex_image_byte_start];
 			images[slot - tex_image_byte_start] = NULL;
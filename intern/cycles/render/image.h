@@ -90,6 +90,8 @@ public:
 	void set_osl_texture_system(void *texture_system);
 	void set_pack_images(bool pack_images_);
 	void set_extended_image_limits(const DeviceInfo& info);
+	void set_max_texture_size(int max_texture_size_);
+	void set_compact_textures(bool compact_textures_);
 	bool set_animation_frame_update(int frame);
 
 	bool need_update;
@@ -123,6 +125,8 @@ private:
 	vector<Image*> float_images;
 	void *osl_texture_system;
 	bool pack_images;
+	int max_texture_size;
+	bool compact_textures;
 
 	bool file_load_image(Image *img, device_vector<uchar4>& tex_img);
 	bool file_load_float_image(Image *img, device_vector<float4>& tex_img);
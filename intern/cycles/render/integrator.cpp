@@ -64,6 +64,15 @@ Integrator::Integrator()
 	sample_all_lights_direct = true;
 	sample_all_lights_indirect = true;
 
+	use_adaptive_sampling = false;
+	adaptive_min_samples = 32;
+	adaptive_threshold = 0.01f;
+
+	use_light_tree = false;
+
+	use_light_sample_learning = false;
+	light_learning_samples = 4;
+
 	method = PATH;
 
 	sampling_pattern = SAMPLING_PATTERN_SOBOL;
@@ -151,6 +160,12 @@ void Integrator::device_update(Device *device, DeviceScene *dscene, Scene *scene
 	kintegrator->sampling_pattern = sampling_pattern;
 	kintegrator->aa_samples = aa_samples;
 
+	/* adaptive sampling, convergence is checked every adaptive_step samples,
+	 * which is kept even so both halves of the samples are equally weighted */
+	kintegrator->adaptive_min_samples = max(adaptive_min_samples, 2);
+	kintegrator->adaptive_step = 16;
+	kintegrator->adaptive_threshold = adaptive_threshold;
+
 	/* sobol directions table */
 	int max_samples = 1;
 
@@ -215,7 +230,13 @@ bool Integrator::modified(const Integrator& integrator)
 		motion_blur == integrator.motion_blur &&
 		sampling_pattern == integrator.sampling_pattern &&
 		sample_all_lights_direct == integrator.sample_all_lights_direct &&
-		sample_all_lights_indirect == integrator.sample_all_lights_indirect);
+		sample_all_lights_indirect == integrator.sample_all_lights_indirect &&
+		use_adaptive_sampling == integrator.use_adaptive_sampling &&
+		adaptive_min_samples == integrator.adaptive_min_samples &&
+		adaptive_threshold == integrator.adaptive_threshold &&
+		use_light_tree == integrator.use_light_tree &&
+		use_light_sample_learning == integrator.use_light_sample_learning &&
+		light_learning_samples == integrator.light_learning_samples);
 }
 
 void Integrator::tag_update(Scene *scene)
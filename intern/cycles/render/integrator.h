@@ -64,6 +64,17 @@ public:
 	bool sample_all_lights_direct;
 	bool sample_all_lights_indirect;
 
+	bool use_adaptive_sampling;
+	int adaptive_min_samples;
+	float adaptive_threshold;
+
+	bool use_light_tree;
+
+	/* redistribute lamp samples of the branched path integrator by their
+	 * measured contribution, once this many samples were rendered */
+	bool use_light_sample_learning;
+	int light_learning_samples;
+
 	enum Method {
 		BRANCHED_PATH = 0,
 		PATH = 1
@@ -19,6 +19,7 @@
 #include "integrator.h"
 #include "film.h"
 #include "light.h"
+#include "light_tree.h"
 #include "mesh.h"
 #include "object.h"
 #include "scene.h"
@@ -27,6 +28,7 @@
 #include "util_foreach.h"
 #include "util_progress.h"
 #include "util_logging.h"
+#include "util_stats.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -216,6 +218,18 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 	float4 *distribution = dscene->light_distribution.resize(num_distribution + 1);
 	float totarea = 0.0f;
 
+	/* light tree emitters, and a map from object triangles to emitters. the
+	 * map starts with an (offset, tri_offset) pair per object */
+	bool use_light_tree = scene->integrator->use_light_tree;
+	vector<LightTreeEmitter> tree_emitters;
+	vector<uint> tree_map;
+	vector<uint> tree_map_slots;
+
+	if(use_light_tree) {
+		tree_map.resize(2*scene->objects.size(), ~0u);
+		tree_map_slots.resize(num_triangles, ~0u);
+	}
+
 	/* triangles */
 	size_t offset = 0;
 	int j = 0;
@@ -273,6 +287,14 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 				use_light_visibility = true;
 			}
 
+			size_t tree_map_offset = tree_map.size();
+
+			if(use_light_tree) {
+				tree_map[2*j] = tree_map_offset;
+				tree_map[2*j + 1] = mesh->tri_offset;
+				tree_map.resize(tree_map_offset + mesh->triangles.size(), ~0u);
+			}
+
 			for(size_t i = 0; i < mesh->triangles.size(); i++) {
 				Shader *shader = scene->shaders[mesh->shader[i]];
 
@@ -281,7 +303,6 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 					distribution[offset].y = __int_as_float(i + mesh->tri_offset);
 					distribution[offset].z = __int_as_float(shader_flag);
 					distribution[offset].w = __int_as_float(object_id);
-					offset++;
 
 					Mesh::Triangle t = mesh->triangles[i];
 					float3 p1 = mesh->verts[t.v[0]];
@@ -294,7 +315,29 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 						p3 = transform_point(&tfm, p3);
 					}
 
-					totarea += triangle_area(p1, p2, p3);
+					float area = triangle_area(p1, p2, p3);
+					totarea += area;
+
+					/* emission strength is not known here, so the energy
+					 * of an emitter is estimated from its area only */
+					if(use_light_tree && area > 0.0f) {
+						LightTreeEmitter emitter;
+
+						emitter.bounds = BoundBox(p1);
+						emitter.bounds.grow(p2);
+						emitter.bounds.grow(p3);
+						emitter.axis = normalize(cross(p2 - p1, p3 - p1));
+						emitter.cos_theta_o = 1.0f;
+						emitter.energy = area;
+						emitter.area = area;
+						emitter.distribution_index = offset;
+						emitter.path = 0;
+
+						tree_emitters.push_back(emitter);
+						tree_map_slots[offset] = tree_map_offset + i;
+					}
+
+					offset++;
 				}
 			}
 		}
@@ -392,6 +435,17 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 		/* CDF */
 		device->tex_alloc("__light_distribution", dscene->light_distribution);
 
+		/* light tree */
+		kintegrator->use_light_tree = false;
+		kintegrator->light_tree_fraction = 0.0f;
+
+		if(!tree_emitters.empty()) {
+			device_update_light_tree(device, dscene, tree_emitters, tree_map, tree_map_slots);
+
+			kintegrator->use_light_tree = true;
+			kintegrator->light_tree_fraction = trianglearea * kintegrator->pdf_triangles;
+		}
+
 		/* Portals */
 		if(num_background_lights > 0 && light_index != scene->lights.size()) {
 			kintegrator->portal_offset = light_index;
@@ -413,6 +467,8 @@ void LightManager::device_update_distribution(Device *device, DeviceScene *dscen
 		kintegrator->pdf_lights = 0.0f;
 		kintegrator->inv_pdf_lights = 0.0f;
 		kintegrator->use_lamp_mis = false;
+		kintegrator->use_light_tree = false;
+		kintegrator->light_tree_fraction = 0.0f;
 		kintegrator->num_portals = 0;
 		kintegrator->portal_offset = 0;
 		kintegrator->portal_pdf = 0.0f;
@@ -460,6 +516,34 @@ static void background_cdf(int start,
 	}
 }
 
+void LightManager::device_update_light_tree(Device *device,
+                                            DeviceScene *dscene,
+                                            vector<LightTreeEmitter>& emitters,
+                                            vector<uint>& map,
+                                            const vector<uint>& map_slots)
+{
+	LightTree tree(emitters);
+
+	/* emitters got reordered by the build, point map at their final place */
+	for(size_t i = 0; i < emitters.size(); i++)
+		map[map_slots[emitters[i].distribution_index]] = i;
+
+	float4 *nodes = dscene->light_tree_nodes.resize(tree.num_nodes() * LIGHT_TREE_NODE_SIZE);
+	float4 *edata = dscene->light_tree_emitters.resize(emitters.size() * LIGHT_TREE_EMITTER_SIZE);
+	uint *mdata = dscene->light_tree_map.resize(map.size());
+
+	tree.pack_nodes(nodes);
+	tree.pack_emitters(edata);
+	memcpy(mdata, &map[0], sizeof(uint) * map.size());
+
+	VLOG(1) << "Light tree built with " << tree.num_nodes() << " nodes for "
+	        << emitters.size() << " emitters.";
+
+	device->tex_alloc("__light_tree_nodes", dscene->light_tree_nodes);
+	device->tex_alloc("__light_tree_emitters", dscene->light_tree_emitters);
+	device->tex_alloc("__light_tree_map", dscene->light_tree_map);
+}
+
 void LightManager::device_update_background(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress)
 {
 	KernelIntegrator *kintegrator = &dscene->data.integrator;
@@ -749,6 +833,9 @@ void LightManager::device_update(Device *device, DeviceScene *dscene, Scene *sce
 
 	use_light_visibility = false;
 
+	/* lamps may have changed, samples need to be learned again */
+	learned_samples.clear();
+
 	device_update_points(device, dscene, scene);
 	if(progress.get_cancel()) return;
 
@@ -772,11 +859,75 @@ void LightManager::device_free(Device *device, DeviceScene *dscene)
 	device->tex_free(dscene->light_data);
 	device->tex_free(dscene->light_background_marginal_cdf);
 	device->tex_free(dscene->light_background_conditional_cdf);
+	device->tex_free(dscene->light_tree_nodes);
+	device->tex_free(dscene->light_tree_emitters);
+	device->tex_free(dscene->light_tree_map);
 
 	dscene->light_distribution.clear();
 	dscene->light_data.clear();
 	dscene->light_background_marginal_cdf.clear();
 	dscene->light_background_conditional_cdf.clear();
+	dscene->light_tree_nodes.clear();
+	dscene->light_tree_emitters.clear();
+	dscene->light_tree_map.clear();
+}
+
+void LightManager::device_update_learned_samples(Device *device,
+                                                 DeviceScene *dscene,
+                                                 Scene *scene,
+                                                 const LightStats& stats)
+{
+	/* lamps in the order they were packed into the light data */
+	vector<int> samples;
+
+	foreach(Light *light, scene->lights)
+		if(light->has_contribution(scene))
+			samples.push_back(light->samples);
+
+	if(samples.size() != stats.sum.size() ||
+	   dscene->light_data.size() < samples.size()*LIGHT_SIZE)
+	{
+		return;
+	}
+
+	/* keep the total number of lamp samples, but give every lamp a share
+	 * proportional to the standard deviation of its single sample estimate,
+	 * which minimizes the variance of the summed direct lighting */
+	vector<double> weight(samples.size(), 0.0);
+	double total_weight = 0.0;
+	int total_samples = 0;
+
+	for(size_t i = 0; i < samples.size(); i++) {
+		total_samples += samples[i];
+
+		if(stats.num_samples[i] == 0)
+			continue;
+
+		double mean = stats.sum[i] / stats.num_samples[i];
+		double variance = stats.sum_sq[i] / stats.num_samples[i] - mean*mean;
+
+		weight[i] = sqrt(max(variance, 0.0));
+		total_weight += weight[i];
+	}
+
+	learned_samples = samples;
+
+	/* nothing was recorded, keep the samples of the lamps */
+	if(total_weight == 0.0)
+		return;
+
+	float4 *light_data = dscene->light_data.get_data();
+
+	for(size_t i = 0; i < samples.size(); i++) {
+		learned_samples[i] = max((int)(total_samples*weight[i]/total_weight + 0.5), 1);
+		light_data[i*LIGHT_SIZE + 3].x = __int_as_float(learned_samples[i]);
+
+		VLOG(1) << "Lamp " << i << " samples " << samples[i]
+		        << " -> " << learned_samples[i] << ".";
+	}
+
+	device->tex_free(dscene->light_data);
+	device->tex_alloc("__light_data", dscene->light_data);
 }
 
 void LightManager::tag_update(Scene * /*scene*/)
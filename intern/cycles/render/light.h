@@ -26,8 +26,10 @@ CCL_NAMESPACE_BEGIN
 
 class Device;
 class DeviceScene;
+class LightStats;
 class Progress;
 class Scene;
+struct LightTreeEmitter;
 
 class Light {
 public:
@@ -73,18 +75,34 @@ public:
 	bool use_light_visibility;
 	bool need_update;
 
+	/* lamp samples redistributed by their measured contribution, indexed like
+	 * the lights on the device. empty until learned, cleared on a full update */
+	vector<int> learned_samples;
+
 	LightManager();
 	~LightManager();
 
 	void device_update(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
 	void device_free(Device *device, DeviceScene *dscene);
 
+	/* fill learned_samples from statistics recorded by the kernel and only
+	 * upload the lamp data again, without a full update */
+	void device_update_learned_samples(Device *device,
+	                                   DeviceScene *dscene,
+	                                   Scene *scene,
+	                                   const LightStats& stats);
+
 	void tag_update(Scene *scene);
 
 protected:
 	void device_update_points(Device *device, DeviceScene *dscene, Scene *scene);
 	void device_update_distribution(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
 	void device_update_background(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
+	void device_update_light_tree(Device *device,
+	                              DeviceScene *dscene,
+	                              vector<LightTreeEmitter>& emitters,
+	                              vector<uint>& map,
+	                              const vector<uint>& map_slots);
 };
 
 CCL_NAMESPACE_END
@@ -0,0 +1,208 @@
+/*
+ * Copyright 2011-2015 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "light_tree.h"
+
+#include "kernel_types.h"
+
+#include "util_algorithm.h"
+#include "util_math.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Bounding cone of two sided normals. Since orientation does not matter the
+ * axes are flipped to agree before merging, and a spread of half a sphere
+ * already covers all directions. */
+
+static void light_tree_cone_merge(float3 axis_a, float cos_a,
+                                  float3 axis_b, float cos_b,
+                                  float3 *r_axis, float *r_cos)
+{
+	if(cos_a <= 0.0f || cos_b <= 0.0f) {
+		*r_axis = axis_a;
+		*r_cos = 0.0f;
+		return;
+	}
+
+	if(dot(axis_a, axis_b) < 0.0f)
+		axis_b = -axis_b;
+
+	float theta_a = safe_acosf(cos_a);
+	float theta_b = safe_acosf(cos_b);
+	float theta_d = safe_acosf(dot(axis_a, axis_b));
+
+	/* one cone contains the other */
+	if(theta_d + theta_b <= theta_a) {
+		*r_axis = axis_a;
+		*r_cos = cos_a;
+		return;
+	}
+	if(theta_d + theta_a <= theta_b) {
+		*r_axis = axis_b;
+		*r_cos = cos_b;
+		return;
+	}
+
+	float theta_o = 0.5f*(theta_a + theta_d + theta_b);
+
+	if(theta_o >= M_PI_2_F) {
+		*r_axis = axis_a;
+		*r_cos = 0.0f;
+		return;
+	}
+
+	/* rotate axis a towards b */
+	float theta_r = theta_o - theta_a;
+	float3 perp = axis_b - axis_a*dot(axis_a, axis_b);
+	float perp_len = len(perp);
+
+	if(perp_len > 0.0f)
+		*r_axis = normalize(axis_a*cosf(theta_r) + perp*(sinf(theta_r)/perp_len));
+	else
+		*r_axis = axis_a;
+	*r_cos = cosf(theta_o);
+}
+
+struct LightTreeCentroidCompare {
+	int dim;
+
+	LightTreeCentroidCompare(int dim_) : dim(dim_) {}
+
+	bool operator()(const LightTreeEmitter& a, const LightTreeEmitter& b) const
+	{
+		float3 ca = a.bounds.center(), cb = b.bounds.center();
+		return (&ca.x)[dim] < (&cb.x)[dim];
+	}
+};
+
+LightTree::LightTree(vector<LightTreeEmitter>& emitters_)
+: emitters(emitters_)
+{
+	if(!emitters.empty()) {
+		nodes.reserve(2*emitters.size());
+		build(0, emitters.size(), 0, 0);
+	}
+}
+
+int LightTree::build(int first, int num, int depth, uint path)
+{
+	int index = nodes.size();
+	nodes.push_back(LightTreeNode());
+
+	/* bounds of emitters and of their centroids */
+	BoundBox bounds = BoundBox::empty;
+	BoundBox centroid_bounds = BoundBox::empty;
+	float energy = 0.0f;
+
+	for(int i = first; i < first + num; i++) {
+		bounds.grow(emitters[i].bounds);
+		centroid_bounds.grow(emitters[i].bounds.center());
+		energy += emitters[i].energy;
+	}
+
+	/* leaf node */
+	if(num <= LIGHT_TREE_MAX_LEAF_SIZE || depth >= LIGHT_TREE_MAX_DEPTH) {
+		float3 axis = emitters[first].axis;
+		float cos_theta_o = emitters[first].cos_theta_o;
+
+		for(int i = first; i < first + num; i++) {
+			if(i != first)
+				light_tree_cone_merge(axis, cos_theta_o,
+				                      emitters[i].axis, emitters[i].cos_theta_o,
+				                      &axis, &cos_theta_o);
+			emitters[i].path = path;
+		}
+
+		LightTreeNode& node = nodes[index];
+		node.bounds = bounds;
+		node.axis = axis;
+		node.cos_theta_o = cos_theta_o;
+		node.energy = energy;
+		node.right_child = -1;
+		node.first_emitter = first;
+		node.num_emitters = num;
+
+		return index;
+	}
+
+	/* median split along the longest axis of the centroid bounds */
+	float3 size = centroid_bounds.size();
+	int dim = (size.x >= size.y && size.x >= size.z)? 0: (size.y >= size.z)? 1: 2;
+	int mid = first + num/2;
+
+	nth_element(emitters.begin() + first,
+	            emitters.begin() + mid,
+	            emitters.begin() + first + num,
+	            LightTreeCentroidCompare(dim));
+
+	build(first, mid - first, depth + 1, path);
+	int right_child = build(mid, first + num - mid, depth + 1, path | (1u << depth));
+
+	/* merge child cones, left child directly follows this node */
+	const LightTreeNode& left = nodes[index + 1];
+	const LightTreeNode& right = nodes[right_child];
+	float3 axis;
+	float cos_theta_o;
+
+	light_tree_cone_merge(left.axis, left.cos_theta_o,
+	                      right.axis, right.cos_theta_o,
+	                      &axis, &cos_theta_o);
+
+	LightTreeNode& node = nodes[index];
+	node.bounds = bounds;
+	node.axis = axis;
+	node.cos_theta_o = cos_theta_o;
+	node.energy = energy;
+	node.right_child = right_child;
+	node.first_emitter = -1;
+	node.num_emitters = 0;
+
+	return index;
+}
+
+void LightTree::pack_nodes(float4 *data) const
+{
+	for(size_t i = 0; i < nodes.size(); i++) {
+		const LightTreeNode& node = nodes[i];
+		float4 *ndata = data + i*LIGHT_TREE_NODE_SIZE;
+		bool leaf = (node.num_emitters > 0);
+
+		ndata[0] = make_float4(node.bounds.min.x, node.bounds.min.y, node.bounds.min.z, node.energy);
+		ndata[1] = make_float4(node.bounds.max.x, node.bounds.max.y, node.bounds.max.z, node.cos_theta_o);
+		ndata[2] = make_float4(node.axis.x, node.axis.y, node.axis.z, 0.0f);
+		ndata[3] = make_float4(__int_as_float(leaf? node.first_emitter: node.right_child),
+		                       __int_as_float(node.num_emitters),
+		                       0.0f, 0.0f);
+	}
+}
+
+void LightTree::pack_emitters(float4 *data) const
+{
+	for(size_t i = 0; i < emitters.size(); i++) {
+		const LightTreeEmitter& emitter = emitters[i];
+		float4 *edata = data + i*LIGHT_TREE_EMITTER_SIZE;
+
+		edata[0] = make_float4(emitter.bounds.min.x, emitter.bounds.min.y, emitter.bounds.min.z, emitter.energy);
+		edata[1] = make_float4(emitter.bounds.max.x, emitter.bounds.max.y, emitter.bounds.max.z, emitter.cos_theta_o);
+		edata[2] = make_float4(emitter.axis.x, emitter.axis.y, emitter.axis.z, emitter.area);
+		edata[3] = make_float4(__int_as_float(emitter.distribution_index),
+		                       __uint_as_float(emitter.path),
+		                       0.0f, 0.0f);
+	}
+}
+
+CCL_NAMESPACE_END
+
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2011-2015 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIGHT_TREE_H__
+#define __LIGHT_TREE_H__
+
+#include "util_boundbox.h"
+#include "util_types.h"
+#include "util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Light Tree
+ *
+ * Bounding volume hierarchy over emissive triangles, used to pick a triangle
+ * to sample proportional to an estimate of its contribution to the shading
+ * point instead of proportional to its area only. Every node stores the
+ * bounding box of its emitters, their total energy and a two sided cone
+ * bounding their normals. */
+
+#define LIGHT_TREE_MAX_LEAF_SIZE 4
+#define LIGHT_TREE_MAX_DEPTH 31
+
+struct LightTreeEmitter {
+	BoundBox bounds;
+	float3 axis;
+	float cos_theta_o;
+	float energy;
+	float area;
+
+	/* index into the light distribution */
+	int distribution_index;
+	/* child choices taken from the root to reach this emitter */
+	uint path;
+};
+
+struct LightTreeNode {
+	BoundBox bounds;
+	float3 axis;
+	float cos_theta_o;
+	float energy;
+
+	/* inner nodes: index of the second child, the first one directly follows
+	 * its parent. leaf nodes: range of emitters. */
+	int right_child;
+	int first_emitter;
+	int num_emitters;
+};
+
+class LightTree {
+public:
+	/* emitters are reordered to be contiguous in leaf nodes */
+	explicit LightTree(vector<LightTreeEmitter>& emitters);
+
+	size_t num_nodes() const { return nodes.size(); }
+
+	/* write LIGHT_TREE_NODE_SIZE and LIGHT_TREE_EMITTER_SIZE float4 per
+	 * node and emitter respectively */
+	void pack_nodes(float4 *data) const;
+	void pack_emitters(float4 *data) const;
+
+protected:
+	int build(int first, int num, int depth, uint path);
+
+	vector<LightTreeEmitter>& emitters;
+	vector<LightTreeNode> nodes;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __LIGHT_TREE_H__ */
+
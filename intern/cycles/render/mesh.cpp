@@ -484,7 +484,7 @@ void Mesh::pack_curves(Scene *scene, float4 *curve_key_co, float4 *curve_data, s
 	}
 }
 
-void Mesh::compute_bvh(SceneParams *params, Progress *progress, int n, int total)
+void Mesh::compute_bvh(SceneParams *params, int num_motion_steps, Progress *progress, int n, int total)
 {
 	if(progress->get_cancel())
 		return;
@@ -504,17 +504,27 @@ void Mesh::compute_bvh(SceneParams *params, Progress *progress, int n, int total
 		vector<Object*> objects;
 		objects.push_back(&object);
 
-		if(bvh && !need_update_rebuild) {
+		bool do_rebuild = (bvh == NULL ||
+		                   need_update_rebuild ||
+		                   bvh->params.num_motion_steps != num_motion_steps);
+
+		if(!do_rebuild) {
 			progress->set_status(msg, "Refitting BVH");
 			bvh->objects = objects;
-			bvh->refit(*progress);
+
+			/* tree got too slow to traverse after refitting, build it again */
+			if(!bvh->refit(*progress))
+				do_rebuild = true;
 		}
-		else {
+
+		if(do_rebuild) {
 			progress->set_status(msg, "Building BVH");
 
 			BVHParams bparams;
 			bparams.use_spatial_split = params->use_bvh_spatial_split;
 			bparams.use_qbvh = params->use_qbvh;
+			bparams.use_cache = params->use_bvh_cache;
+			bparams.num_motion_steps = num_motion_steps;
 
 			delete bvh;
 			bvh = BVH::create(bparams, objects);
@@ -551,6 +561,54 @@ bool Mesh::has_motion_blur() const
 	         curve_attributes.find(ATTR_STD_MOTION_VERTEX_POSITION)));
 }
 
+/* Number of motion steps to store BVH node bounds for. This requires all
+ * meshes with deformation motion blur to use the same steps, otherwise the
+ * traversal falls back to the bounds over the whole shutter interval. */
+static int mesh_bvh_motion_steps(Scene *scene)
+{
+	int num_motion_steps = 0;
+
+	foreach(Mesh *mesh, scene->meshes) {
+		if(!mesh->has_motion_blur())
+			continue;
+
+		if(num_motion_steps == 0)
+			num_motion_steps = mesh->motion_steps;
+		else if(num_motion_steps != (int)mesh->motion_steps)
+			return 0;
+	}
+
+	return (num_motion_steps > 1)? num_motion_steps: 0;
+}
+
+/* Mesh Instance Statistics */
+
+MeshInstanceStats::MeshInstanceStats()
+{
+	num_objects = 0;
+	num_instances = 0;
+	num_instanced_meshes = 0;
+	mem_scene_bvh = 0;
+	mem_instanced = 0;
+	mem_flattened = 0;
+}
+
+string MeshInstanceStats::full_report() const
+{
+	string report = "Mesh instancing statistics:\n";
+
+	report += string_printf("  Objects: %d\n", (int)num_objects);
+	report += string_printf("  Instances: %d of %d shared meshes\n",
+	                        (int)num_instances, (int)num_instanced_meshes);
+	report += string_printf("  Scene BVH: %s\n",
+	                        string_human_readable_size(mem_scene_bvh).c_str());
+	report += string_printf("  Instanced geometry: %s (%s when flattened)",
+	                        string_human_readable_size(mem_instanced).c_str(),
+	                        string_human_readable_size(mem_flattened).c_str());
+
+	return report;
+}
+
 /* Mesh Manager */
 
 MeshManager::MeshManager()
@@ -558,6 +616,7 @@ MeshManager::MeshManager()
 	bvh = NULL;
 	need_update = true;
 	need_flags_update = true;
+	need_top_level_update = false;
 }
 
 MeshManager::~MeshManager()
@@ -1083,6 +1142,8 @@ void MeshManager::device_update_bvh(Device *device, DeviceScene *dscene, Scene *
 	bparams.top_level = true;
 	bparams.use_qbvh = scene->params.use_qbvh;
 	bparams.use_spatial_split = scene->params.use_bvh_spatial_split;
+	bparams.use_cache = scene->params.use_bvh_cache;
+	bparams.num_motion_steps = mesh_bvh_motion_steps(scene);
 
 	delete bvh;
 	bvh = BVH::create(bparams, scene->objects);
@@ -1127,9 +1188,45 @@ void MeshManager::device_update_bvh(Device *device, DeviceScene *dscene, Scene *
 		dscene->prim_object.reference((uint*)&pack.prim_object[0], pack.prim_object.size());
 		device->tex_alloc("__prim_object", dscene->prim_object);
 	}
+	if(pack.motion_nodes.size()) {
+		dscene->bvh_motion_nodes.reference((float4*)&pack.motion_nodes[0], pack.motion_nodes.size());
+		device->tex_alloc("__bvh_motion_nodes", dscene->bvh_motion_nodes);
+	}
 
 	dscene->data.bvh.root = pack.root_index;
 	dscene->data.bvh.use_qbvh = scene->params.use_qbvh;
+	dscene->data.bvh.num_motion_steps = (pack.motion_nodes.size())? bparams.num_motion_steps: 0;
+
+	/* instancing statistics, meshes without applied transform are shared by
+	 * all their objects through the top level BVH */
+	map<Mesh*, int> mesh_instances;
+
+	foreach(Object *object, scene->objects) {
+		if(!object->mesh->transform_applied)
+			mesh_instances[object->mesh]++;
+	}
+
+	instance_stats = MeshInstanceStats();
+	instance_stats.num_objects = scene->objects.size();
+	instance_stats.mem_scene_bvh = pack.memory_size();
+
+	for(map<Mesh*, int>::iterator it = mesh_instances.begin(); it != mesh_instances.end(); it++) {
+		Mesh *mesh = it->first;
+		size_t mesh_size = mesh->verts.size()*sizeof(float4) +
+		                   mesh->triangles.size()*(sizeof(float4)*2 + sizeof(uint)) +
+		                   mesh->curve_keys.size()*sizeof(float4) +
+		                   mesh->curves.size()*sizeof(float4);
+
+		if(mesh->bvh)
+			mesh_size += mesh->bvh->pack.memory_size();
+
+		instance_stats.num_instances += it->second;
+		instance_stats.num_instanced_meshes++;
+		instance_stats.mem_instanced += mesh_size;
+		instance_stats.mem_flattened += mesh_size*it->second;
+	}
+
+	VLOG(1) << instance_stats.full_report().c_str();
 }
 
 void MeshManager::device_update_flags(Device * /*device*/,
@@ -1201,12 +1298,62 @@ void MeshManager::device_update_displacement_images(Device *device,
 	pool.wait_work();
 }
 
+bool MeshManager::device_meshes_modified(Scene *scene)
+{
+	if(scene->meshes != device_meshes)
+		return true;
+	if(scene->objects.size() != device_object_meshes.size())
+		return true;
+
+	for(size_t i = 0; i < scene->objects.size(); i++)
+		if(scene->objects[i]->mesh != device_object_meshes[i])
+			return true;
+
+	foreach(Shader *shader, scene->shaders)
+		if(shader->need_update_attributes)
+			return true;
+
+	return false;
+}
+
+void MeshManager::device_update_top_level(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress)
+{
+	VLOG(1) << "Updating top level BVH only.";
+
+#ifdef __OBJECT_MOTION__
+	Scene::MotionType need_motion = scene->need_motion(device->info.advanced_shading);
+	bool motion_blur = need_motion == Scene::MOTION_BLUR;
+#else
+	bool motion_blur = false;
+#endif
+
+	foreach(Object *object, scene->objects)
+		object->compute_bounds(motion_blur);
+
+	if(progress.get_cancel()) return;
+
+	device_free_bvh(device, dscene);
+	device_update_bvh(device, dscene, scene, progress);
+}
+
 void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress)
 {
 	VLOG(1) << "Total " << scene->meshes.size() << " meshes.";
 
-	if(!need_update)
-		return;
+	if(!need_update) {
+		if(!need_top_level_update)
+			return;
+
+		/* fall back to a full update when objects were added, removed or
+		 * switched mesh, since offsets and attribute maps depend on them */
+		if(!device_meshes_modified(scene)) {
+			device_update_top_level(device, dscene, scene, progress);
+			if(progress.get_cancel()) return;
+
+			need_top_level_update = false;
+			return;
+		}
+	}
 
 	/* update normals */
 	foreach(Mesh *mesh, scene->meshes) {
@@ -1276,12 +1423,17 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 	}
 
 	/* update bvh */
+	double bvh_start_time = time_dt();
 	size_t i = 0, num_bvh = 0;
 
+	if(scene->params.use_bvh_cache)
+		Cache::global.set_path(scene->params.bvh_cache_path);
+
 	foreach(Mesh *mesh, scene->meshes)
 		if(mesh->need_update && !mesh->transform_applied)
 			num_bvh++;
 
+	int num_motion_steps = mesh_bvh_motion_steps(scene);
 	TaskPool pool;
 
 	foreach(Mesh *mesh, scene->meshes) {
@@ -1289,6 +1441,7 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 			pool.push(function_bind(&Mesh::compute_bvh,
 			                        mesh,
 			                        &scene->params,
+			                        num_motion_steps,
 			                        &progress,
 			                        i,
 			                        num_bvh));
@@ -1318,7 +1471,15 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 
 	device_update_bvh(device, dscene, scene, progress);
 
+	device->stats.timing.bvh_build += time_dt() - bvh_start_time;
+
 	need_update = false;
+	need_top_level_update = false;
+
+	device_meshes = scene->meshes;
+	device_object_meshes.clear();
+	foreach(Object *object, scene->objects)
+		device_object_meshes.push_back(object->mesh);
 
 	if(need_displacement_images) {
 		/* Re-tag flags for update, so they're re-evaluated
@@ -1331,16 +1492,33 @@ void MeshManager::device_update(Device *device, DeviceScene *dscene, Scene *scen
 	}
 }
 
-void MeshManager::device_free(Device *device, DeviceScene *dscene)
+void MeshManager::device_free_bvh(Device *device, DeviceScene *dscene)
 {
 	device->tex_free(dscene->bvh_nodes);
 	device->tex_free(dscene->bvh_leaf_nodes);
+	device->tex_free(dscene->bvh_motion_nodes);
 	device->tex_free(dscene->object_node);
 	device->tex_free(dscene->tri_woop);
 	device->tex_free(dscene->prim_type);
 	device->tex_free(dscene->prim_visibility);
 	device->tex_free(dscene->prim_index);
 	device->tex_free(dscene->prim_object);
+
+	dscene->bvh_nodes.clear();
+	dscene->bvh_leaf_nodes.clear();
+	dscene->bvh_motion_nodes.clear();
+	dscene->object_node.clear();
+	dscene->tri_woop.clear();
+	dscene->prim_type.clear();
+	dscene->prim_visibility.clear();
+	dscene->prim_index.clear();
+	dscene->prim_object.clear();
+}
+
+void MeshManager::device_free(Device *device, DeviceScene *dscene)
+{
+	device_free_bvh(device, dscene);
+
 	device->tex_free(dscene->tri_shader);
 	device->tex_free(dscene->tri_vnormal);
 	device->tex_free(dscene->tri_vindex);
@@ -1352,13 +1530,6 @@ void MeshManager::device_free(Device *device, DeviceScene *dscene)
 	device->tex_free(dscene->attributes_float3);
 	device->tex_free(dscene->attributes_uchar4);
 
-	dscene->bvh_nodes.clear();
-	dscene->object_node.clear();
-	dscene->tri_woop.clear();
-	dscene->prim_type.clear();
-	dscene->prim_visibility.clear();
-	dscene->prim_index.clear();
-	dscene->prim_object.clear();
 	dscene->tri_shader.clear();
 	dscene->tri_vnormal.clear();
 	dscene->tri_vindex.clear();
@@ -1387,6 +1558,12 @@ void MeshManager::tag_update(Scene *scene)
 	scene->object_manager->need_update = true;
 }
 
+void MeshManager::tag_update_top_level(Scene *scene)
+{
+	need_top_level_update = true;
+	scene->object_manager->need_update = true;
+}
+
 bool Mesh::need_attribute(Scene *scene, AttributeStandard std)
 {
 	if(std == ATTR_STD_NONE)
@@ -133,7 +133,7 @@ public:
 	void pack_normals(Scene *scene, uint *shader, float4 *vnormal);
 	void pack_verts(float4 *tri_verts, float4 *tri_vindex, size_t vert_offset);
 	void pack_curves(Scene *scene, float4 *curve_key_co, float4 *curve_data, size_t curvekey_offset);
-	void compute_bvh(SceneParams *params, Progress *progress, int n, int total);
+	void compute_bvh(SceneParams *params, int num_motion_steps, Progress *progress, int n, int total);
 
 	bool need_attribute(Scene *scene, AttributeStandard std);
 	bool need_attribute(Scene *scene, ustring name);
@@ -143,14 +143,38 @@ public:
 	bool has_motion_blur() const;
 };
 
+/* Mesh Instance Statistics
+ *
+ * Gathered when building the scene BVH. Meshes used by multiple objects are
+ * stored once on the device and referenced from the top level BVH through
+ * the instance transforms. The flattened size is an estimate of memory that
+ * would be needed with the transform baked into a copy for every instance. */
+
+struct MeshInstanceStats {
+	size_t num_objects;
+	size_t num_instances;
+	size_t num_instanced_meshes;
+	size_t mem_scene_bvh;
+	size_t mem_instanced;
+	size_t mem_flattened;
+
+	MeshInstanceStats();
+
+	string full_report() const;
+};
+
 /* Mesh Manager */
 
 class MeshManager {
 public:
 	BVH *bvh;
+	MeshInstanceStats instance_stats;
 
 	bool need_update;
 	bool need_flags_update;
+	/* only object transforms or visibility changed, mesh data on the device
+	 * stays valid and just the top level BVH is rebuilt */
+	bool need_top_level_update;
 
 	MeshManager();
 	~MeshManager();
@@ -168,9 +192,20 @@ public:
 	void device_update_bvh(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
 	void device_update_flags(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
 	void device_update_displacement_images(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
+	void device_update_top_level(Device *device, DeviceScene *dscene, Scene *scene, Progress& progress);
 	void device_free(Device *device, DeviceScene *dscene);
+	void device_free_bvh(Device *device, DeviceScene *dscene);
 
 	void tag_update(Scene *scene);
+	void tag_update_top_level(Scene *scene);
+
+protected:
+	bool device_meshes_modified(Scene *scene);
+
+	/* meshes and the mesh of every object at the last full device update,
+	 * mesh offsets and attribute maps are only valid for these */
+	vector<Mesh*> device_meshes;
+	vector<Mesh*> device_object_meshes;
 };
 
 CCL_NAMESPACE_END
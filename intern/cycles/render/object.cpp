@@ -181,9 +181,14 @@ void Object::apply_transform(bool apply_to_motion)
 
 void Object::tag_update(Scene *scene)
 {
+	/* with instancing the mesh itself is unaffected by object changes */
+	bool need_mesh_update = true;
+
 	if(mesh) {
 		if(mesh->transform_applied)
 			mesh->need_update = true;
+		else if(scene->params.bvh_type == SceneParams::BVH_DYNAMIC)
+			need_mesh_update = false;
 
 		foreach(uint sindex, mesh->used_shaders) {
 			Shader *shader = scene->shaders[sindex];
@@ -195,8 +200,12 @@ void Object::tag_update(Scene *scene)
 
 	scene->camera->need_flags_update = true;
 	scene->curve_system_manager->need_update = true;
-	scene->mesh_manager->need_update = true;
 	scene->object_manager->need_update = true;
+
+	if(need_mesh_update)
+		scene->mesh_manager->need_update = true;
+	else
+		scene->mesh_manager->tag_update_top_level(scene);
 }
 
 vector<float> Object::motion_times()
@@ -70,6 +70,10 @@ Scene::Scene(const SceneParams& params_, const DeviceInfo& device_info_)
 
 	/* Extended image limits for CPU and GPUs */
 	image_manager->set_extended_image_limits(device_info_);
+	image_manager->set_max_texture_size(params.texture_limit);
+	/* compact texture storage is only implemented in the CPU kernel */
+	image_manager->set_compact_textures(params.use_compact_textures &&
+	                                    device_info_.type == DEVICE_CPU);
 }
 
 Scene::~Scene()
@@ -293,6 +297,7 @@ bool Scene::need_reset()
 		|| camera->need_update
 		|| object_manager->need_update
 		|| mesh_manager->need_update
+		|| mesh_manager->need_top_level_update
 		|| light_manager->need_update
 		|| lookup_tables->need_update
 		|| integrator->need_update
@@ -63,6 +63,7 @@ public:
 	/* BVH */
 	device_vector<float4> bvh_nodes;
 	device_vector<float4> bvh_leaf_nodes;
+	device_vector<float4> bvh_motion_nodes;
 	device_vector<uint> object_node;
 	device_vector<float4> tri_woop;
 	device_vector<uint> prim_type;
@@ -94,6 +95,9 @@ public:
 	device_vector<float4> light_data;
 	device_vector<float2> light_background_marginal_cdf;
 	device_vector<float2> light_background_conditional_cdf;
+	device_vector<float4> light_tree_nodes;
+	device_vector<float4> light_tree_emitters;
+	device_vector<uint> light_tree_map;
 
 	/* particles */
 	device_vector<float4> particles;
@@ -113,6 +117,11 @@ public:
 	device_vector<uchar4> tex_image[TEX_EXTENDED_NUM_IMAGES_CPU];
 	device_vector<float4> tex_float_image[TEX_EXTENDED_NUM_FLOAT_IMAGES];
 
+	/* cpu images in compact storage */
+	device_vector<uchar> tex_byte_image[TEX_EXTENDED_NUM_IMAGES_CPU];
+	device_vector<half4> tex_half4_image[TEX_EXTENDED_NUM_FLOAT_IMAGES];
+	device_vector<half> tex_half_image[TEX_EXTENDED_NUM_FLOAT_IMAGES];
+
 	/* opencl images */
 	device_vector<uchar4> tex_image_packed;
 	device_vector<uint4> tex_image_packed_info;
@@ -128,6 +137,10 @@ public:
 	enum BVHType { BVH_DYNAMIC, BVH_STATIC } bvh_type;
 	bool use_bvh_spatial_split;
 	bool use_qbvh;
+	bool use_bvh_cache;
+	string bvh_cache_path;
+	int texture_limit;
+	bool use_compact_textures;
 	bool persistent_data;
 
 	SceneParams()
@@ -136,6 +149,9 @@ public:
 		bvh_type = BVH_DYNAMIC;
 		use_bvh_spatial_split = false;
 		use_qbvh = false;
+		use_bvh_cache = false;
+		texture_limit = 0;
+		use_compact_textures = false;
 		persistent_data = false;
 	}
 
@@ -144,6 +160,10 @@ public:
 		&& bvh_type == params.bvh_type
 		&& use_bvh_spatial_split == params.use_bvh_spatial_split
 		&& use_qbvh == params.use_qbvh
+		&& use_bvh_cache == params.use_bvh_cache
+		&& bvh_cache_path == params.bvh_cache_path
+		&& texture_limit == params.texture_limit
+		&& use_compact_textures == params.use_compact_textures
 		&& persistent_data == params.persistent_data); }
 };
 
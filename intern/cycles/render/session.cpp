@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <stdio.h>
 #include <string.h>
 #include <limits.h>
 
@@ -22,10 +23,12 @@
 #include "device.h"
 #include "graph.h"
 #include "integrator.h"
+#include "light.h"
 #include "mesh.h"
 #include "object.h"
 #include "scene.h"
 #include "session.h"
+#include "shader.h"
 #include "bake.h"
 
 #include "util_foreach.h"
@@ -53,6 +56,7 @@ Session::Session(const SessionParams& params_)
 
 	TaskScheduler::init(params.threads);
 
+	stats.use_profiling = params.use_profiling;
 	device = Device::create(params.device, stats, params.background);
 
 	if(params.background && params.output_path.empty()) {
@@ -274,10 +278,14 @@ void Session::run_gpu()
 			update_status_time();
 
 			/* path trace */
+			double path_trace_start_time = time_dt();
+
 			path_trace();
 
 			device->task_wait();
 
+			stats.timing.path_trace += time_dt() - path_trace_start_time;
+
 			if(!device->error_message().empty())
 				progress.set_cancel(device->error_message());
 
@@ -370,6 +378,7 @@ bool Session::acquire_tile(Device *tile_device, RenderTile& rtile)
 		return false;
 	
 	/* fill render tile */
+	rtile.tile_index = tile.index;
 	rtile.x = tile_manager.state.buffer.full_x + tile.x;
 	rtile.y = tile_manager.state.buffer.full_y + tile.y;
 	rtile.w = tile.w;
@@ -465,6 +474,8 @@ void Session::release_tile(RenderTile& rtile)
 {
 	thread_scoped_lock tile_lock(tile_mutex);
 
+	tile_manager.finish_tile(rtile.tile_index, rtile.sample - rtile.start_sample);
+
 	if(write_render_tile_cb) {
 		if(params.progressive_refine == false) {
 			/* todo: optimize this by making it thread safe and removing lock */
@@ -497,6 +508,7 @@ void Session::run_cpu()
 		/* advance to next tile */
 		bool no_tiles = !tile_manager.next();
 		bool need_tonemap = false;
+		double path_trace_start_time = 0.0;
 
 		if(params.background) {
 			/* if no work left and in background mode, we can stop immediately */
@@ -562,6 +574,8 @@ void Session::run_cpu()
 			update_status_time();
 
 			/* path trace */
+			path_trace_start_time = time_dt();
+
 			path_trace();
 
 			/* update status and timing */
@@ -576,6 +590,10 @@ void Session::run_cpu()
 
 		device->task_wait();
 
+		if(path_trace_start_time != 0.0) {
+			stats.timing.path_trace += time_dt() - path_trace_start_time;
+		}
+
 		{
 			thread_scoped_lock reset_lock(delayed_reset.mutex);
 			thread_scoped_lock buffers_lock(buffers_mutex);
@@ -614,6 +632,8 @@ DeviceRequestedFeatures Session::get_requested_device_features()
 		requested_features.max_closure = 64;
 		requested_features.max_nodes_group = NODE_GROUP_LEVEL_MAX;
 		requested_features.nodes_features = NODE_FEATURE_ALL;
+		requested_features.use_subsurface = true;
+		requested_features.use_volume = true;
 	}
 	else {
 		requested_features.max_closure = get_max_closure_count();
@@ -681,10 +701,17 @@ void Session::run()
 		/* reset number of rendered samples */
 		progress.reset_sample();
 
+		if(params.use_profiling)
+			stats.profiling.reset(0);
+		stats.timing.reset();
+
 		if(device_use_gl)
 			run_gpu();
 		else
 			run_cpu();
+
+		if(params.use_profiling)
+			print_profiling_report();
 	}
 
 	/* progress update */
@@ -714,6 +741,10 @@ void Session::reset_(BufferParams& buffer_params, int samples)
 
 	tile_manager.reset(buffer_params, samples);
 
+	/* statistics of lamps are recorded against the samples from the start */
+	if(stats.use_light_stats)
+		stats.light.reset(0);
+
 	start_time = time_dt();
 	preview_time = 0.0;
 	paused_time = 0.0;
@@ -815,8 +846,40 @@ void Session::update_scene()
 
 	/* update scene */
 	if(scene->need_update()) {
+		double update_start_time = time_dt();
+
 		progress.set_status("Updating Scene");
 		scene->device_update(device, progress);
+
+		stats.timing.scene_update += time_dt() - update_start_time;
+	}
+
+	update_light_sample_learning();
+}
+
+void Session::update_light_sample_learning()
+{
+	/* record the contribution of lamps during the first samples, then
+	 * redistribute their samples for the rest of the render. this needs the
+	 * scene to be updated between samples, so it only has an effect for
+	 * progressive rendering */
+	Integrator *integrator = scene->integrator;
+	LightManager *light_manager = scene->light_manager;
+
+	bool learn = integrator->use_light_sample_learning &&
+	             integrator->method == Integrator::BRANCHED_PATH &&
+	             light_manager->learned_samples.empty();
+
+	if(!learn) {
+		stats.use_light_stats = false;
+	}
+	else if(!stats.use_light_stats) {
+		stats.light.reset(0);
+		stats.use_light_stats = true;
+	}
+	else if(tile_manager.state.sample >= integrator->light_learning_samples) {
+		light_manager->device_update_learned_samples(device, &scene->dscene, scene, stats.light);
+		stats.use_light_stats = false;
 	}
 }
 
@@ -900,6 +963,25 @@ void Session::update_status_time(bool show_pause, bool show_done)
 	progress.set_tile(tile, tile_time);
 }
 
+void Session::print_profiling_report()
+{
+	if(stats.profiling.num_threads == 0) {
+		printf("Profiling: no data, only collected by CPU devices in builds with kernel debug.\n");
+		return;
+	}
+
+	vector<string> shader_names;
+	{
+		thread_scoped_lock scene_lock(scene->mutex);
+
+		foreach(Shader *shader, scene->shaders)
+			shader_names.push_back(shader->name);
+	}
+
+	printf("%s", stats.profiling.full_report(shader_names).c_str());
+	fflush(stdout);
+}
+
 void Session::update_progress_sample()
 {
 	progress.increment_sample();
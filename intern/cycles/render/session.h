@@ -64,6 +64,9 @@ public:
 
 	ShadingSystem shadingsystem;
 
+	/* collect kernel counters, CPU only and in builds with kernel debug */
+	bool use_profiling;
+
 	SessionParams()
 	{
 		background = false;
@@ -86,6 +89,8 @@ public:
 
 		shadingsystem = SHADINGSYSTEM_SVM;
 		tile_order = TILE_CENTER;
+
+		use_profiling = false;
 	}
 
 	bool modified(const SessionParams& params)
@@ -106,7 +111,8 @@ public:
 		&& text_timeout == params.text_timeout
 		&& progressive_update_timeout == params.progressive_update_timeout
 		&& tile_order == params.tile_order
-		&& shadingsystem == params.shadingsystem); }
+		&& shadingsystem == params.shadingsystem
+		&& use_profiling == params.use_profiling); }
 
 };
 
@@ -142,6 +148,7 @@ public:
 	void set_pause(bool pause);
 
 	void update_scene();
+	void update_light_sample_learning();
 	void load_kernels();
 
 	void device_free();
@@ -157,6 +164,7 @@ protected:
 	void run();
 
 	void update_status_time(bool show_pause = false, bool show_done = false);
+	void print_profiling_report();
 
 	void tonemap(int sample);
 	void path_trace();
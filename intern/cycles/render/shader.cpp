@@ -527,6 +527,9 @@ void ShaderManager::get_requested_features(Scene *scene,
 		if(output_node->input("Displacement")->link != NULL) {
 			requested_features->nodes_features |= NODE_FEATURE_BUMP;
 		}
+		if(output_node->input("Volume")->link != NULL) {
+			requested_features->use_volume = true;
+		}
 	}
 }
 
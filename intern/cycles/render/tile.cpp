@@ -17,6 +17,8 @@
 #include "tile.h"
 
 #include "util_algorithm.h"
+#include "util_foreach.h"
+#include "util_time.h"
 #include "util_types.h"
 
 CCL_NAMESPACE_BEGIN
@@ -105,6 +107,9 @@ void TileManager::reset(BufferParams& params_, int num_samples_)
 	state.num_samples = 0;
 	state.resolution_divider = divider;
 	state.tiles.clear();
+	state.device_stats.clear();
+	state.device_stats.resize(num_devices);
+	state.active_tiles.clear();
 }
 
 void TileManager::set_samples(int num_samples_)
@@ -191,6 +196,64 @@ void TileManager::set_tiles()
 	state.buffer.full_height = max(1, params.full_height/resolution);
 }
 
+/* Tiles are not split smaller than this in either dimension. */
+#define TILE_MIN_SPLIT_SIZE 16
+
+void TileManager::split_tail_tile(int device)
+{
+	list<Tile>& tiles = state.tiles[0];
+	const DeviceStats& stats = state.device_stats[device];
+
+	if(stats.num_finished == 0 || stats.tile_rate <= 0.0)
+		return;
+
+	/* combined throughput of all devices */
+	double current_time = time_dt();
+	double total_rate = 0.0;
+
+	foreach(const DeviceStats& device_stats, state.device_stats) {
+		double elapsed = current_time - device_stats.start_time;
+
+		if(device_stats.num_finished > 0 && elapsed > 0.0)
+			total_rate += device_stats.work_done / elapsed;
+	}
+
+	if(total_rate <= 0.0)
+		return;
+
+	double remaining_work = 0.0;
+
+	foreach(const Tile& tile, tiles)
+		remaining_work += (double)tile.w * tile.h * state.num_samples;
+
+	double time_left = remaining_work / total_rate;
+
+	while(true) {
+		Tile& front = tiles.front();
+		double tile_time = (double)front.w * front.h * state.num_samples / stats.tile_rate;
+
+		if(tile_time <= time_left || max(front.w, front.h) < 2*TILE_MIN_SPLIT_SIZE)
+			break;
+
+		/* halve along the longest axis, second half stays in the queue */
+		Tile second = front;
+		second.index = state.num_tiles++;
+
+		if(front.w >= front.h) {
+			front.w /= 2;
+			second.x += front.w;
+			second.w -= front.w;
+		}
+		else {
+			front.h /= 2;
+			second.y += front.h;
+			second.h -= front.h;
+		}
+
+		tiles.insert(++tiles.begin(), second);
+	}
+}
+
 bool TileManager::next_tile(Tile& tile, int device)
 {
 	int logical_device = preserve_tile_device? device: 0;
@@ -198,12 +261,58 @@ bool TileManager::next_tile(Tile& tile, int device)
 	if((logical_device >= state.tiles.size()) || state.tiles[logical_device].empty())
 		return false;
 
+	/* tiles are shared between devices, balance the tail of the frame */
+	bool use_stats = !preserve_tile_device && device >= 0 && device < state.device_stats.size();
+
+	if(use_stats && num_devices > 1)
+		split_tail_tile(device);
+
 	tile = Tile(state.tiles[logical_device].front());
 	state.tiles[logical_device].pop_front();
 	state.num_rendered_tiles++;
+
+	if(use_stats) {
+		ActiveTile active;
+		active.device = device;
+		active.w = tile.w;
+		active.h = tile.h;
+		active.start_time = time_dt();
+
+		DeviceStats& stats = state.device_stats[device];
+		if(stats.start_time == 0.0)
+			stats.start_time = active.start_time;
+
+		state.active_tiles[tile.index] = active;
+	}
+
 	return true;
 }
 
+void TileManager::finish_tile(int index, int num_samples)
+{
+	map<int, ActiveTile>::iterator it = state.active_tiles.find(index);
+
+	if(it == state.active_tiles.end())
+		return;
+
+	const ActiveTile& active = it->second;
+	DeviceStats& stats = state.device_stats[active.device];
+	double work = (double)active.w * active.h * num_samples;
+	double elapsed = time_dt() - active.start_time;
+
+	stats.work_done += work;
+
+	if(elapsed > 0.0 && num_samples > 0) {
+		double rate = work / elapsed;
+
+		/* running average, recent tiles weighted more */
+		stats.tile_rate = (stats.num_finished == 0)? rate: 0.5*(stats.tile_rate + rate);
+		stats.num_finished++;
+	}
+
+	state.active_tiles.erase(it);
+}
+
 bool TileManager::done()
 {
 	return (state.sample+state.num_samples >= num_samples && state.resolution_divider == 1);
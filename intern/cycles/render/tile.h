@@ -21,6 +21,7 @@
 
 #include "buffers.h"
 #include "util_list.h"
+#include "util_map.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -56,6 +57,22 @@ class TileManager {
 public:
 	BufferParams params;
 
+	/* Throughput of a render device, measured from finished tiles. */
+	struct DeviceStats {
+		DeviceStats() : start_time(0.0), work_done(0.0), tile_rate(0.0), num_finished(0) {}
+
+		double start_time;  /* time the device got its first tile */
+		double work_done;   /* number of pixel samples finished */
+		double tile_rate;   /* pixel samples per second of a single tile */
+		int num_finished;
+	};
+
+	struct ActiveTile {
+		int device;
+		int w, h;
+		double start_time;
+	};
+
 	struct State {
 		BufferParams buffer;
 		int sample;
@@ -66,6 +83,10 @@ public:
 		/* This vector contains a list of tiles for every logical device in the session.
 		 * In each list, the tiles are sorted according to the tile order setting. */
 		vector<list<Tile> > tiles;
+		/* Per device throughput and tiles currently being rendered, used to
+		 * split tiles at the end of a frame when tiles are shared between devices. */
+		vector<DeviceStats> device_stats;
+		map<int, ActiveTile> active_tiles;
 	} state;
 
 	int num_samples;
@@ -78,6 +99,7 @@ public:
 	void set_samples(int num_samples);
 	bool next();
 	bool next_tile(Tile& tile, int device = 0);
+	void finish_tile(int index, int num_samples);
 	bool done();
 
 	void set_tile_order(TileOrder tile_order_) { tile_order = tile_order_; }
@@ -112,6 +134,10 @@ protected:
 
 	/* Generate tile list, return number of tiles. */
 	int gen_tiles(bool sliced);
+
+	/* Split the next tile when the device would still be rendering it after
+	 * all other devices ran out of work. */
+	void split_tail_tile(int device);
 };
 
 CCL_NAMESPACE_END
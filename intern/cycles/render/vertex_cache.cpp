@@ -0,0 +1,195 @@
+/*
+ * Copyright 2011-2015 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vertex_cache.h"
+
+#include "util_algorithm.h"
+#include "util_math.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* MDD files are big endian, PC2 files little endian */
+
+static bool system_is_little_endian()
+{
+	const uint16_t test = 1;
+	return *((const uchar*)&test) == 1;
+}
+
+static void endian_switch_array(void *data, size_t num)
+{
+	uchar *bytes = (uchar*)data;
+
+	for(size_t i = 0; i < num; i++, bytes += 4) {
+		swap(bytes[0], bytes[3]);
+		swap(bytes[1], bytes[2]);
+	}
+}
+
+VertexCacheFile::VertexCacheFile()
+{
+	fp = NULL;
+	format = FORMAT_MDD;
+	verts_tot = 0;
+	frame_tot = 0;
+	data_offset = 0;
+}
+
+VertexCacheFile::~VertexCacheFile()
+{
+	close();
+}
+
+bool VertexCacheFile::open(const string& filepath, Format format_)
+{
+	close();
+
+	fp = fopen(filepath.c_str(), "rb");
+	if(!fp)
+		return false;
+
+	format = format_;
+
+	if(format == FORMAT_MDD) {
+		/* frame and vertex count, followed by a time per frame */
+		int head[2];
+
+		if(fread(head, sizeof(head), 1, fp) != 1) {
+			close();
+			return false;
+		}
+		if(system_is_little_endian())
+			endian_switch_array(head, 2);
+
+		frame_tot = head[0];
+		verts_tot = head[1];
+		data_offset = sizeof(head) + sizeof(float)*frame_tot;
+	}
+	else {
+		/* 'POINTCACHE2' identifier, version, vertex count, start frame,
+		 * sampling and frame count */
+		char header[12];
+		int head[4];
+
+		if(fread(header, sizeof(header), 1, fp) != 1 ||
+		   fread(head, sizeof(head), 1, fp) != 1 ||
+		   memcmp(header, "POINTCACHE2", 12) != 0)
+		{
+			close();
+			return false;
+		}
+		if(!system_is_little_endian())
+			endian_switch_array(head, 4);
+
+		verts_tot = head[1];
+		frame_tot = head[3];
+		data_offset = sizeof(header) + sizeof(head);
+	}
+
+	if(verts_tot <= 0 || frame_tot <= 0) {
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void VertexCacheFile::close()
+{
+	if(fp) {
+		fclose(fp);
+		fp = NULL;
+	}
+
+	verts_tot = 0;
+	frame_tot = 0;
+	data_offset = 0;
+	buffer.clear();
+}
+
+bool VertexCacheFile::read_index(int index, float3 *P, float factor)
+{
+	size_t frame_size = sizeof(float)*3*verts_tot;
+
+	if(fseek(fp, data_offset + (long)(frame_size*index), SEEK_SET) != 0)
+		return false;
+
+	buffer.resize(verts_tot*3);
+
+	if(fread(&buffer[0], frame_size, 1, fp) != 1)
+		return false;
+
+	if(system_is_little_endian() == (format == FORMAT_MDD))
+		endian_switch_array(&buffer[0], buffer.size());
+
+	const float *co = &buffer[0];
+
+	if(factor >= 1.0f) {
+		for(int i = 0; i < verts_tot; i++, co += 3)
+			P[i] = make_float3(co[0], co[1], co[2]);
+	}
+	else {
+		for(int i = 0; i < verts_tot; i++, co += 3)
+			P[i] = interp(P[i], make_float3(co[0], co[1], co[2]), factor);
+	}
+
+	return true;
+}
+
+bool VertexCacheFile::read(float frame, bool interpolate, float3 *P)
+{
+	if(!fp)
+		return false;
+
+	/* same frame selection as the Mesh Cache modifier */
+	int index0, index1;
+	float factor = 1.0f;
+
+	if(!interpolate) {
+		index0 = index1 = clamp((int)floorf(frame + 0.5f), 0, frame_tot - 1);
+	}
+	else {
+		float tframe = floorf(frame);
+		float range = frame - tframe;
+
+		index0 = (int)tframe;
+		index1 = index0;
+
+		if(range > 1e-4f) {
+			index1 = index0 + 1;
+			factor = range;
+		}
+
+		if(index0 >= frame_tot || index1 >= frame_tot) {
+			index0 = index1 = frame_tot - 1;
+			factor = 1.0f;
+		}
+		else if(index0 < 0) {
+			index0 = index1 = 0;
+			factor = 1.0f;
+		}
+	}
+
+	if(!read_index(index0, P, 1.0f))
+		return false;
+	if(index1 != index0 && !read_index(index1, P, factor))
+		return false;
+
+	return true;
+}
+
+CCL_NAMESPACE_END
+
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2011-2015 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __VERTEX_CACHE_H__
+#define __VERTEX_CACHE_H__
+
+#include "util_string.h"
+#include "util_types.h"
+#include "util_vector.h"
+
+#include <stdio.h>
+
+CCL_NAMESPACE_BEGIN
+
+/* Vertex Cache File
+ *
+ * Reader for the MDD and PC2 vertex animation formats, as written by other
+ * applications and read by the Mesh Cache modifier. Only the frames that are
+ * needed are read from the file, so baked geometry can be streamed into a
+ * mesh without evaluating it on the Blender side. */
+
+class VertexCacheFile {
+public:
+	enum Format {
+		FORMAT_MDD,
+		FORMAT_PC2
+	};
+
+	VertexCacheFile();
+	~VertexCacheFile();
+
+	bool open(const string& filepath, Format format);
+	void close();
+
+	int num_verts() const { return verts_tot; }
+	int num_frames() const { return frame_tot; }
+
+	/* read positions at a frame index, frames outside of the cache are
+	 * clamped. with interpolation the two nearest frames are blended. */
+	bool read(float frame, bool interpolate, float3 *P);
+
+protected:
+	bool read_index(int index, float3 *P, float factor);
+
+	FILE *fp;
+	Format format;
+	int verts_tot;
+	int frame_tot;
+	long data_offset;
+	vector<float> buffer;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __VERTEX_CACHE_H__ */
+
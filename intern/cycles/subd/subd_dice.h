@@ -40,6 +40,7 @@ struct SubdParams {
 	int test_steps;
 	int split_threshold;
 	float dicing_rate;
+	int max_triangles;
 	Camera *camera;
 
 	SubdParams(Mesh *mesh_, int shader_, bool smooth_ = true, bool ptex_ = false)
@@ -52,6 +53,7 @@ struct SubdParams {
 		test_steps = 3;
 		split_threshold = 1;
 		dicing_rate = 0.1f;
+		max_triangles = 0;
 		camera = NULL;
 	}
 
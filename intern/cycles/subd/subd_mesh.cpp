@@ -264,6 +264,17 @@ void OpenSubdMesh::tessellate(DiagSplit *split)
 	/* split & dice patches */
 	OpenSubdPatch patch(farmesh, vbuf_base);
 
+	if(split->params.max_triangles > 0) {
+		float num_triangles = 0.0f;
+
+		for(int f = 0; f < num_ptex_faces; f++) {
+			patch.face_id = f;
+			num_triangles += split->estimate_triangles(&patch);
+		}
+
+		split->limit_dicing_rate(num_triangles);
+	}
+
 	for(int f = 0; f < num_ptex_faces; f++) {
 		patch.face_id = f;
 		split->split_quad(&patch);
@@ -376,7 +387,10 @@ bool SubdMesh::finish()
 void SubdMesh::tessellate(DiagSplit *split)
 {
 	int num_faces = faces.size();
-		        
+	vector<Patch*> patches;
+
+	patches.reserve(num_faces);
+
 	for(int f = 0; f < num_faces; f++) {
 		SubdFace *face = faces[f];
 		Patch *patch;
@@ -403,6 +417,22 @@ void SubdMesh::tessellate(DiagSplit *split)
 		if(face->numverts == 4)
 			swap(hull[2], hull[3]);
 
+		patches.push_back(patch);
+	}
+
+	/* fit into the triangle budget before any geometry is diced */
+	if(split->params.max_triangles > 0) {
+		float num_triangles = 0.0f;
+
+		for(size_t i = 0; i < patches.size(); i++)
+			num_triangles += split->estimate_triangles(patches[i]);
+
+		split->limit_dicing_rate(num_triangles);
+	}
+
+	for(size_t i = 0; i < patches.size(); i++) {
+		Patch *patch = patches[i];
+
 		if(patch->is_triangle())
 			split->split_triangle(patch);
 		else
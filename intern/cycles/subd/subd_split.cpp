@@ -86,6 +86,52 @@ int DiagSplit::T(Patch *patch, float2 Pstart, float2 Pend)
 	return tmax;
 }
 
+float DiagSplit::edge_length(Patch *patch, float2 Pstart, float2 Pend)
+{
+	float3 Plast = project(patch, Pstart);
+	float Lsum = 0.0f;
+
+	for(int i = 1; i < params.test_steps; i++) {
+		float t = i/(float)(params.test_steps-1);
+		float3 P = project(patch, Pstart + t*(Pend - Pstart));
+
+		Lsum += len(P - Plast);
+		Plast = P;
+	}
+
+	return Lsum;
+}
+
+float DiagSplit::estimate_triangles(Patch *patch)
+{
+	/* triangles are diced with fixed edge factors, see split_triangle */
+	if(patch->is_triangle())
+		return 16.0f;
+
+	float2 P00 = make_float2(0.0f, 0.0f);
+	float2 P10 = make_float2(1.0f, 0.0f);
+	float2 P01 = make_float2(0.0f, 1.0f);
+	float2 P11 = make_float2(1.0f, 1.0f);
+
+	float Lu = 0.5f*(edge_length(patch, P00, P10) + edge_length(patch, P01, P11));
+	float Lv = 0.5f*(edge_length(patch, P00, P01) + edge_length(patch, P10, P11));
+
+	float tu = max(ceilf(Lu/params.dicing_rate), 1.0f);
+	float tv = max(ceilf(Lv/params.dicing_rate), 1.0f);
+
+	return 2.0f*tu*tv;
+}
+
+void DiagSplit::limit_dicing_rate(float num_triangles)
+{
+	if(params.max_triangles <= 0 || num_triangles <= (float)params.max_triangles)
+		return;
+
+	/* the number of triangles of a quad grows with the square of the edge
+	 * factors, so scale the rate by the square root of the excess */
+	params.dicing_rate *= sqrtf(num_triangles/(float)params.max_triangles);
+}
+
 void DiagSplit::partition_edge(Patch *patch, float2 *P, int *t0, int *t1, float2 Pstart, float2 Pend, int t)
 {
 	if(t == DSPLIT_NON_UNIFORM) {
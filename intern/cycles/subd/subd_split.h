@@ -47,6 +47,7 @@ public:
 
 	float3 project(Patch *patch, float2 uv);
 	int T(Patch *patch, float2 Pstart, float2 Pend);
+	float edge_length(Patch *patch, float2 Pstart, float2 Pend);
 	void partition_edge(Patch *patch, float2 *P, int *t0, int *t1,
 		float2 Pstart, float2 Pend, int t);
 
@@ -58,6 +59,11 @@ public:
 
 	void split_triangle(Patch *patch);
 	void split_quad(Patch *patch);
+
+	/* triangle budget, call with the estimate summed over all patches before
+	 * splitting any of them to coarsen the dicing rate to fit the budget */
+	float estimate_triangles(Patch *patch);
+	void limit_dicing_rate(float num_triangles);
 };
 
 CCL_NAMESPACE_END
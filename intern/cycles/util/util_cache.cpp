@@ -64,31 +64,62 @@ const string& CacheData::get_filename()
 
 Cache Cache::global;
 
+void Cache::set_path(const string& path_)
+{
+	path = path_;
+}
+
+string Cache::cache_path()
+{
+	if(path.empty())
+		return path_user_get("cache");
+
+	return path;
+}
+
 string Cache::data_filename(CacheData& key)
 {
-	return path_user_get(path_join("cache", key.get_filename()));
+	return path_join(cache_path(), key.get_filename());
 }
 
 void Cache::insert(CacheData& key, CacheData& value)
 {
 	string filename = data_filename(key);
 	path_create_directories(filename);
-	FILE *f = path_fopen(filename, "wb");
+
+	/* Write into a temporary file first and move it in place after, so other
+	 * processes sharing the cache never read a partially written file. */
+	string temp_filename = filename + "." +
+		boost::filesystem::unique_path().string() + ".tmp";
+	FILE *f = path_fopen(temp_filename, "wb");
 
 	if(!f) {
-		fprintf(stderr, "Failed to open file %s for writing.\n", filename.c_str());
+		fprintf(stderr, "Failed to open file %s for writing.\n", temp_filename.c_str());
 		return;
 	}
 
+	bool ok = true;
+
 	foreach(CacheBuffer& buffer, value.buffers) {
 		if(!fwrite(&buffer.size, sizeof(buffer.size), 1, f))
-			fprintf(stderr, "Failed to write to file %s.\n", filename.c_str());
+			ok = false;
 		if(buffer.size)
 			if(!fwrite(buffer.data, buffer.size, 1, f))
-				fprintf(stderr, "Failed to write to file %s.\n", filename.c_str());
+				ok = false;
 	}
 	
-	fclose(f);
+	if(fclose(f) != 0)
+		ok = false;
+
+	boost::system::error_code error;
+
+	if(ok)
+		boost::filesystem::rename(temp_filename, filename, error);
+
+	if(!ok || error) {
+		fprintf(stderr, "Failed to write to file %s.\n", filename.c_str());
+		boost::filesystem::remove(temp_filename, error);
+	}
 }
 
 bool Cache::lookup(CacheData& key, CacheData& value)
@@ -107,7 +138,7 @@ bool Cache::lookup(CacheData& key, CacheData& value)
 
 void Cache::clear_except(const string& name, const set<string>& except)
 {
-	path_cache_clear_except(name, except);
+	path_cache_clear_except(cache_path(), name, except);
 }
 
 CCL_NAMESPACE_END
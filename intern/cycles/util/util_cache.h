@@ -105,9 +105,14 @@ public:
 			return false;
 		}
 
-		if((size == 0) || (size % sizeof(T)) != 0)
+		if((size % sizeof(T)) != 0)
 			return false;
 
+		if(size == 0) {
+			data.clear();
+			return true;
+		}
+
 		data.resize(size/sizeof(T));
 
 		if(!fread(&data[0], size, 1, f)) {
@@ -172,7 +177,14 @@ public:
 
 	void clear_except(const string& name, const set<string>& except);
 
+	/* Directory containing the cache files, empty for the default location
+	 * in the user path. */
+	void set_path(const string& path);
+
 protected:
+	string path;
+
+	string cache_path();
 	string data_filename(CacheData& key);
 };
 
@@ -85,6 +85,59 @@ ccl_device_inline void float4_store_half(half *h, float4 f, float scale)
 #endif
 }
 
+/* Full range conversion, used for texture storage where values can be
+ * negative or above one. Denormals are flushed to zero and values beyond
+ * the half range are clamped to the largest finite half. */
+
+ccl_device_inline half float_to_half(float f)
+{
+	union { uint i; float f; } in;
+	in.f = f;
+
+	uint sign = (in.i >> 16) & 0x8000;
+	uint absolute = in.i & 0x7FFFFFFF;
+
+	if(absolute > 0x7F800000)
+		return (half)(sign | 0x7E00);  /* nan */
+	if(absolute < 0x38800000)
+		return (half)sign;  /* zero and denormals */
+
+	/* rebias exponent and round mantissa to nearest even */
+	absolute += 0xC8000000 + 0x0FFF + ((absolute >> 13) & 1);
+	uint result = absolute >> 13;
+
+	return (half)(sign | ((result < 0x7BFF)? result: 0x7BFF));
+}
+
+ccl_device_inline float half_to_float(half h)
+{
+	union { uint i; float f; } out;
+
+	uint sign = ((uint)h & 0x8000) << 16;
+	uint exponent = ((uint)h >> 10) & 0x1F;
+	uint mantissa = (uint)h & 0x3FF;
+
+	if(exponent == 0) {
+		/* zero and denormals */
+		float f = (float)mantissa * (1.0f/16777216.0f);
+		return (sign)? -f: f;
+	}
+	else if(exponent == 31)
+		out.i = sign | 0x7F800000 | (mantissa << 13);
+	else
+		out.i = sign | ((exponent + 112) << 23) | (mantissa << 13);
+
+	return out.f;
+}
+
+ccl_device_inline float4 half4_to_float4(half4 h)
+{
+	return make_float4(half_to_float(h.x),
+	                   half_to_float(h.y),
+	                   half_to_float(h.z),
+	                   half_to_float(h.w));
+}
+
 #endif
 
 #endif
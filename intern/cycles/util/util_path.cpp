@@ -165,18 +165,35 @@ bool path_write_binary(const string& path, const vector<uint8_t>& binary)
 {
 	path_create_directories(path);
 
+	/* write to a temporary file first and move it in place, so that other
+	 * processes sharing the same cache never read a partially written file */
+	string tmp_path = path + from_boost(boost::filesystem::unique_path(".%%%%%%%%.tmp"));
+
 	/* write binary file from memory */
-	FILE *f = path_fopen(path, "wb");
+	FILE *f = path_fopen(tmp_path, "wb");
 
 	if(!f)
 		return false;
 
+	bool ok = true;
+
 	if(binary.size() > 0)
-		fwrite(&binary[0], sizeof(uint8_t), binary.size(), f);
+		ok = (fwrite(&binary[0], sizeof(uint8_t), binary.size(), f) == binary.size());
 
-	fclose(f);
+	if(fclose(f) != 0)
+		ok = false;
 
-	return true;
+	boost::system::error_code ec;
+
+	if(ok) {
+		boost::filesystem::rename(to_boost(tmp_path), to_boost(path), ec);
+		ok = !ec;
+	}
+
+	if(!ok)
+		boost::filesystem::remove(to_boost(tmp_path), ec);
+
+	return ok;
 }
 
 bool path_write_text(const string& path, string& text)
@@ -266,10 +283,8 @@ FILE *path_fopen(const string& path, const string& mode)
 	return fopen(path.c_str(), mode.c_str());
 }
 
-void path_cache_clear_except(const string& name, const set<string>& except)
+void path_cache_clear_except(const string& dir, const string& name, const set<string>& except)
 {
-	string dir = path_user_get("cache");
-
 	if(boost::filesystem::exists(dir)) {
 		boost::filesystem::directory_iterator it(dir), it_end;
 
@@ -278,7 +293,7 @@ void path_cache_clear_except(const string& name, const set<string>& except)
 
 			if(boost::starts_with(filename, name))
 				if(except.find(filename) == except.end())
-					boost::filesystem::remove(to_boost(filename));
+					boost::filesystem::remove(it->path());
 		}
 	}
 
@@ -63,7 +63,7 @@ bool path_read_text(const string& path, string& text);
 string path_source_replace_includes(const string& source, const string& path);
 
 /* cache utility */
-void path_cache_clear_except(const string& name, const set<string>& except);
+void path_cache_clear_except(const string& dir, const string& name, const set<string>& except);
 
 CCL_NAMESPACE_END
 
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2011-2015 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "util_stats.h"
+
+#include "util_algorithm.h"
+#include "util_foreach.h"
+
+CCL_NAMESPACE_BEGIN
+
+static const char *profiling_ray_names[PROFILING_NUM_RAY_TYPES] = {
+	"Camera",
+	"Bounce",
+	"Shadow",
+	"Subsurface",
+	"Volume",
+};
+
+static const char *profiling_counter_names[PROFILING_NUM_COUNTERS] = {
+	"BVH nodes",
+	"Triangle tests",
+	"Closure evaluations",
+	"Volume steps",
+	"SVM nodes",
+};
+
+struct ProfilingShaderCompare {
+	const vector<uint64_t>& nodes;
+
+	ProfilingShaderCompare(const vector<uint64_t>& nodes_) : nodes(nodes_) {}
+
+	bool operator()(int a, int b) const
+	{
+		return nodes[a] > nodes[b];
+	}
+};
+
+static double profiling_ratio(uint64_t a, uint64_t b)
+{
+	return (b != 0)? (double)a / (double)b: 0.0;
+}
+
+string ProfilingStats::full_report(const vector<string>& shader_names) const
+{
+	string report = "Profiling:\n";
+	uint64_t num_rays = 0;
+
+	for(int i = 0; i < PROFILING_NUM_RAY_TYPES; i++)
+		num_rays += rays[i];
+
+	report += string_printf("  Threads: %d, render time: %.2fs (%.2fs per thread)\n",
+	                        num_threads, time,
+	                        (num_threads)? time / num_threads: 0.0);
+
+	report += "  Rays:\n";
+	for(int i = 0; i < PROFILING_NUM_RAY_TYPES; i++) {
+		report += string_printf("    %-21s %14llu  %5.1f%%\n",
+		                        profiling_ray_names[i],
+		                        (unsigned long long)rays[i],
+		                        100.0 * profiling_ratio(rays[i], num_rays));
+	}
+	report += string_printf("    %-21s %14llu  %.2fM/s per thread\n",
+	                        "Total",
+	                        (unsigned long long)num_rays,
+	                        (time > 0.0)? num_rays * 1e-6 / time: 0.0);
+
+	report += "  Counters:\n";
+	for(int i = 0; i < PROFILING_NUM_COUNTERS; i++) {
+		report += string_printf("    %-21s %14llu  %8.2f per ray\n",
+		                        profiling_counter_names[i],
+		                        (unsigned long long)counters[i],
+		                        profiling_ratio(counters[i], num_rays));
+	}
+
+	/* shaders sorted by the number of nodes they executed */
+	vector<int> order;
+	for(size_t i = 0; i < shader_evals.size(); i++)
+		if(shader_evals[i] != 0)
+			order.push_back(i);
+
+	if(order.empty())
+		return report;
+
+	sort(order.begin(), order.end(), ProfilingShaderCompare(shader_svm_nodes));
+
+	report += string_printf("  Shaders:\n    %-32s %14s %14s %10s %7s\n",
+	                        "Name", "Evaluations", "SVM nodes", "Per eval", "Share");
+
+	foreach(int i, order) {
+		string name = (i < (int)shader_names.size())? shader_names[i]: string_printf("Shader %d", i);
+
+		report += string_printf("    %-32s %14llu %14llu %10.2f %6.1f%%\n",
+		                        name.c_str(),
+		                        (unsigned long long)shader_evals[i],
+		                        (unsigned long long)shader_svm_nodes[i],
+		                        profiling_ratio(shader_svm_nodes[i], shader_evals[i]),
+		                        100.0 * profiling_ratio(shader_svm_nodes[i], counters[PROFILING_SVM_NODES]));
+	}
+
+	return report;
+}
+
+CCL_NAMESPACE_END
+
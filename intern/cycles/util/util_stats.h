@@ -18,12 +18,176 @@
 #define __UTIL_STATS_H__
 
 #include "util_atomic.h"
+#include "util_string.h"
+#include "util_types.h"
+#include "util_vector.h"
 
 CCL_NAMESPACE_BEGIN
 
+/* Profiling
+ *
+ * Counters accumulated by the CPU kernel in debug builds when profiling is
+ * enabled. Every render thread fills its own copy, which is merged into the
+ * session statistics once the thread is done. */
+
+typedef enum ProfilingRayType {
+	PROFILING_RAY_CAMERA = 0,
+	PROFILING_RAY_BOUNCE,
+	PROFILING_RAY_SHADOW,
+	PROFILING_RAY_SUBSURFACE,
+	PROFILING_RAY_VOLUME,
+
+	PROFILING_NUM_RAY_TYPES
+} ProfilingRayType;
+
+typedef enum ProfilingCounter {
+	PROFILING_BVH_NODES = 0,
+	PROFILING_TRIANGLE_TESTS,
+	PROFILING_CLOSURE_EVALS,
+	PROFILING_VOLUME_STEPS,
+	PROFILING_SVM_NODES,
+
+	PROFILING_NUM_COUNTERS
+} ProfilingCounter;
+
+class ProfilingStats {
+public:
+	ProfilingStats()
+	{
+		reset(0);
+	}
+
+	void reset(int num_shaders)
+	{
+		memset(rays, 0, sizeof(rays));
+		memset(counters, 0, sizeof(counters));
+		shader_evals.clear();
+		shader_svm_nodes.clear();
+		shader_evals.resize(num_shaders, 0);
+		shader_svm_nodes.resize(num_shaders, 0);
+		num_threads = 0;
+		time = 0.0;
+	}
+
+	void add(const ProfilingStats& other)
+	{
+		for(int i = 0; i < PROFILING_NUM_RAY_TYPES; i++)
+			rays[i] += other.rays[i];
+		for(int i = 0; i < PROFILING_NUM_COUNTERS; i++)
+			counters[i] += other.counters[i];
+
+		if(shader_evals.size() < other.shader_evals.size()) {
+			shader_evals.resize(other.shader_evals.size(), 0);
+			shader_svm_nodes.resize(other.shader_svm_nodes.size(), 0);
+		}
+		for(size_t i = 0; i < other.shader_evals.size(); i++) {
+			shader_evals[i] += other.shader_evals[i];
+			shader_svm_nodes[i] += other.shader_svm_nodes[i];
+		}
+
+		num_threads += other.num_threads;
+		time += other.time;
+	}
+
+	/* human readable summary, shader names are indexed like the counters */
+	string full_report(const vector<string>& shader_names) const;
+
+	uint64_t rays[PROFILING_NUM_RAY_TYPES];
+	uint64_t counters[PROFILING_NUM_COUNTERS];
+
+	/* indexed by shader, not by kernel shader id which includes bump */
+	vector<uint64_t> shader_evals;
+	vector<uint64_t> shader_svm_nodes;
+
+	/* number of merged thread runs and sum of their render time in seconds */
+	int num_threads;
+	double time;
+};
+
+/* Light Statistics
+ *
+ * Contribution of every lamp to the branched path integrator, recorded by the
+ * CPU kernel while sampling all lights. Used to redistribute lamp samples,
+ * indexed like the lights on the device. */
+
+class LightStats {
+public:
+	LightStats()
+	{
+		reset(0);
+	}
+
+	void reset(int num_lights)
+	{
+		sum.clear();
+		sum_sq.clear();
+		num_samples.clear();
+		sum.resize(num_lights, 0.0);
+		sum_sq.resize(num_lights, 0.0);
+		num_samples.resize(num_lights, 0);
+	}
+
+	void add(const LightStats& other)
+	{
+		if(sum.size() < other.sum.size()) {
+			sum.resize(other.sum.size(), 0.0);
+			sum_sq.resize(other.sum_sq.size(), 0.0);
+			num_samples.resize(other.num_samples.size(), 0);
+		}
+		for(size_t i = 0; i < other.sum.size(); i++) {
+			sum[i] += other.sum[i];
+			sum_sq[i] += other.sum_sq[i];
+			num_samples[i] += other.num_samples[i];
+		}
+	}
+
+	/* samples that found no contribution are only counted */
+	void add_samples(int light, int n)
+	{
+		num_samples[light] += n;
+	}
+
+	void add_contribution(int light, float value)
+	{
+		sum[light] += value;
+		sum_sq[light] += (double)value*(double)value;
+	}
+
+	vector<double> sum;
+	vector<double> sum_sq;
+	vector<uint64_t> num_samples;
+};
+
+/* Timing Statistics
+ *
+ * Wall clock time in seconds spent in the stages of a render, accumulated
+ * over all scene updates and samples of a session. */
+
+class TimingStats {
+public:
+	TimingStats()
+	{
+		reset();
+	}
+
+	void reset()
+	{
+		scene_update = 0.0;
+		bvh_build = 0.0;
+		path_trace = 0.0;
+	}
+
+	/* Scene::device_update, includes the BVH build */
+	double scene_update;
+	/* mesh and top level BVH build */
+	double bvh_build;
+	/* path tracing, from pushing the device task until it's done */
+	double path_trace;
+};
+
 class Stats {
 public:
-	Stats() : mem_used(0), mem_peak(0) {}
+	Stats() : mem_used(0), mem_peak(0), use_profiling(false), use_light_stats(false) {}
 
 	void mem_alloc(size_t size) {
 		atomic_add_z(&mem_used, size);
@@ -37,6 +201,16 @@ public:
 
 	size_t mem_used;
 	size_t mem_peak;
+
+	/* only filled by devices supporting it, in builds with kernel debug */
+	bool use_profiling;
+	ProfilingStats profiling;
+
+	/* only filled by the CPU device */
+	bool use_light_stats;
+	LightStats light;
+
+	TimingStats timing;
 };
 
 CCL_NAMESPACE_END
@@ -122,5 +122,24 @@ string string_remove_trademark(const string &s)
 	return string_strip(result);
 }
 
+string string_human_readable_size(size_t size)
+{
+	static const char *suffixes[] = {"B", "K", "M", "G", "T"};
+	const int num_suffixes = sizeof(suffixes)/sizeof(*suffixes);
+
+	double value = (double)size;
+	int i = 0;
+
+	while(value >= 1024.0 && i < num_suffixes - 1) {
+		value /= 1024.0;
+		i++;
+	}
+
+	if(i == 0)
+		return string_printf("%d%s", (int)size, suffixes[i]);
+
+	return string_printf("%.2f%s", value, suffixes[i]);
+}
+
 CCL_NAMESPACE_END
 
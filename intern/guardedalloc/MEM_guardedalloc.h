@@ -206,6 +206,10 @@ extern const char *(*MEM_name_ptr)(void *vmemh);
 /* Switch allocator to slower but fully guarded mode. */
 void MEM_use_guarded_allocator(void);
 
+/* Sample allocations of the lock-free allocator, collecting statistics per allocation string. */
+void MEM_enable_profile(unsigned int sample_rate);
+void MEM_print_profile(void);
+
 #ifdef __cplusplus
 /* alloc funcs for C++ only */
 #define MEM_CXX_CLASS_ALLOC_FUNCS(_id)                                        \
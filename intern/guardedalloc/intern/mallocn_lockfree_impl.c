@@ -51,8 +51,32 @@ typedef struct MemHeadAligned {
 	size_t len;
 } MemHeadAligned;
 
-static unsigned int totblock = 0;
-static size_t mem_in_use = 0, mmap_in_use = 0, peak_mem = 0;
+/* Counters are split over a number of slots, each in its own cache line,
+ * so threads allocating at the same time don't keep taking the line from each other.
+ * They are only added up when the totals are requested. */
+#define MEM_COUNTER_SLOTS_BIT 5
+#define MEM_COUNTER_SLOTS (1 << MEM_COUNTER_SLOTS_BIT)
+
+/* how many bytes a slot allocates before the peak is updated */
+#define MEM_PEAK_UPDATE_STEP (64 * 1024)
+
+typedef struct MemCounters {
+	/* a slot may go below zero (wrap around) when other threads free its blocks, only the sum is meaningful */
+	size_t mem_in_use, mmap_in_use;
+	unsigned int totblock;
+	/* bytes allocated since the last peak update, not atomic, lost updates only delay the next one */
+	size_t peak_step;
+	/* allocations since the last profile sample, not atomic either */
+	unsigned int profile_step;
+} MemCounters;
+
+typedef union MemCountersSlot {
+	MemCounters counters;
+	char _pad[64];
+} MemCountersSlot;
+
+static MemCountersSlot mem_counters[MEM_COUNTER_SLOTS];
+static size_t peak_mem = 0;
 static bool malloc_debug_memset = false;
 
 static void (*error_callback)(const char *) = NULL;
@@ -63,12 +87,15 @@ enum {
 	MEMHEAD_MMAP_FLAG = 1,
 	MEMHEAD_ALIGN_FLAG = 2,
 };
+/* sampled by the profiler, preceded by a MemHeadProfile (the low bits are all taken) */
+#define MEMHEAD_PROFILE_FLAG ((size_t)1 << (sizeof(size_t) * 8 - 1))
 
 #define MEMHEAD_FROM_PTR(ptr) (((MemHead*) vmemh) - 1)
 #define PTR_FROM_MEMHEAD(memhead) (memhead + 1)
 #define MEMHEAD_ALIGNED_FROM_PTR(ptr) (((MemHeadAligned*) vmemh) - 1)
 #define MEMHEAD_IS_MMAP(memhead) ((memhead)->len & (size_t) MEMHEAD_MMAP_FLAG)
 #define MEMHEAD_IS_ALIGNED(memhead) ((memhead)->len & (size_t) MEMHEAD_ALIGN_FLAG)
+#define MEMHEAD_IS_PROFILED(memhead) ((memhead)->len & MEMHEAD_PROFILE_FLAG)
 
 /* Uncomment this to have proper peak counter. */
 #define USE_ATOMIC_MAX
@@ -87,6 +114,81 @@ MEM_INLINE void update_maximum(size_t *maximum_value, size_t value)
 #endif
 }
 
+/**
+ * Threads have their own stack (at least a MB apart), so its address picks a slot per thread
+ * without thread-local storage. Any slot gives correct totals, this only avoids sharing them.
+ */
+MEM_INLINE MemCounters *mem_counters_get(void)
+{
+	int stack_var;
+	const unsigned int stack_hash = (unsigned int)((size_t)&stack_var >> 20) * 2654435761u;
+
+	return &mem_counters[stack_hash >> (32 - MEM_COUNTER_SLOTS_BIT)].counters;
+}
+
+static size_t mem_counters_mem_in_use(void)
+{
+	size_t mem_in_use = 0;
+	int i;
+
+	for (i = 0; i < MEM_COUNTER_SLOTS; i++) {
+		mem_in_use += mem_counters[i].counters.mem_in_use;
+	}
+	return mem_in_use;
+}
+
+static size_t mem_counters_mmap_in_use(void)
+{
+	size_t mmap_in_use = 0;
+	int i;
+
+	for (i = 0; i < MEM_COUNTER_SLOTS; i++) {
+		mmap_in_use += mem_counters[i].counters.mmap_in_use;
+	}
+	return mmap_in_use;
+}
+
+static unsigned int mem_counters_totblock(void)
+{
+	unsigned int totblock = 0;
+	int i;
+
+	for (i = 0; i < MEM_COUNTER_SLOTS; i++) {
+		totblock += mem_counters[i].counters.totblock;
+	}
+	return totblock;
+}
+
+MEM_INLINE void mem_counters_add(size_t len, bool is_mmap)
+{
+	MemCounters *counters = mem_counters_get();
+
+	atomic_add_u(&counters->totblock, 1);
+	atomic_add_z(&counters->mem_in_use, len);
+	if (is_mmap) {
+		atomic_add_z(&counters->mmap_in_use, len);
+	}
+
+	/* adding up all slots on every allocation would bring back the contention,
+	 * so the peak is only updated in steps, it may miss up to a step per slot */
+	counters->peak_step += len;
+	if (UNLIKELY(counters->peak_step >= MEM_PEAK_UPDATE_STEP)) {
+		counters->peak_step = 0;
+		update_maximum(&peak_mem, mem_counters_mem_in_use());
+	}
+}
+
+MEM_INLINE void mem_counters_sub(size_t len, bool is_mmap)
+{
+	MemCounters *counters = mem_counters_get();
+
+	atomic_sub_u(&counters->totblock, 1);
+	atomic_sub_z(&counters->mem_in_use, len);
+	if (is_mmap) {
+		atomic_sub_z(&counters->mmap_in_use, len);
+	}
+}
+
 #ifdef __GNUC__
 __attribute__ ((format(printf, 1, 2)))
 #endif
@@ -119,10 +221,217 @@ static void mem_unlock_thread(void)
 }
 #endif
 
+/* -------------------------------------------------------------------- */
+/* Allocation Profiler
+ *
+ * Samples one in every N allocations (per counter slot) made by #MEM_lockfree_mallocN and
+ * #MEM_lockfree_callocN, and collects statistics per allocation string.
+ * Sampled blocks are preceded by a #MemHeadProfile, so their free updates the statistics too.
+ *
+ * Entries are keyed by the string pointer (without comparing the text), like the guarded allocator
+ * these strings are expected to stay valid, they are printed by #MEM_print_profile.
+ */
+
+#define MEM_PROFILE_ENTRIES_BIT 12
+#define MEM_PROFILE_ENTRIES (1 << MEM_PROFILE_ENTRIES_BIT)
+#define MEM_PROFILE_PROBE_MAX 64
+#define MEM_PROFILE_LIFETIME_BUCKETS 24
+
+typedef struct MemProfileEntry {
+	const char *name;
+	size_t count, count_live;
+	size_t bytes, bytes_live, bytes_peak;
+	/* lifetime of freed blocks, bucket N counts lifetimes below 2^N sampled allocations */
+	size_t lifetime[MEM_PROFILE_LIFETIME_BUCKETS];
+} MemProfileEntry;
+
+typedef struct MemHeadProfile {
+	MemProfileEntry *entry;
+	/* mem_profile_clock when allocated */
+	size_t clock;
+} MemHeadProfile;
+
+static MemProfileEntry mem_profile_entries[MEM_PROFILE_ENTRIES];
+/* used when mem_profile_entries is full */
+static MemProfileEntry mem_profile_entry_other = {"(other)"};
+static unsigned int mem_profile_sample_rate = 0;
+/* number of sampled allocations, the unit of the lifetime */
+static size_t mem_profile_clock = 0;
+
+static MemProfileEntry *mem_profile_entry_ensure(const char *name)
+{
+	const unsigned int hash = (unsigned int)((size_t)name >> 2) * 2654435761u;
+	unsigned int index = hash >> (32 - MEM_PROFILE_ENTRIES_BIT);
+	int probe;
+
+	for (probe = 0; probe < MEM_PROFILE_PROBE_MAX; probe++, index = (index + 1) & (MEM_PROFILE_ENTRIES - 1)) {
+		MemProfileEntry *entry = &mem_profile_entries[index];
+
+		if (entry->name == name) {
+			return entry;
+		}
+		else if (entry->name == NULL) {
+			const char *name_prev = atomic_cas_ptr((void **)&entry->name, NULL, (void *)name);
+			if (name_prev == NULL || name_prev == name) {
+				return entry;
+			}
+		}
+	}
+	return &mem_profile_entry_other;
+}
+
+MEM_INLINE bool mem_profile_sample_test(void)
+{
+	MemCounters *counters = mem_counters_get();
+
+	if (++counters->profile_step >= mem_profile_sample_rate) {
+		counters->profile_step = 0;
+		return true;
+	}
+	return false;
+}
+
+static void mem_profile_alloc(MemHeadProfile *memh_profile, size_t len, const char *str)
+{
+	MemProfileEntry *entry = mem_profile_entry_ensure(str);
+
+	memh_profile->entry = entry;
+	memh_profile->clock = atomic_add_z(&mem_profile_clock, 1);
+
+	atomic_add_z(&entry->count, 1);
+	atomic_add_z(&entry->count_live, 1);
+	atomic_add_z(&entry->bytes, len);
+	update_maximum(&entry->bytes_peak, atomic_add_z(&entry->bytes_live, len));
+}
+
+static void mem_profile_free(MemHeadProfile *memh_profile, size_t len)
+{
+	MemProfileEntry *entry = memh_profile->entry;
+	size_t lifetime = mem_profile_clock - memh_profile->clock;
+	int bucket = 0;
+
+	while (lifetime && bucket < MEM_PROFILE_LIFETIME_BUCKETS - 1) {
+		lifetime >>= 1;
+		bucket++;
+	}
+
+	atomic_sub_z(&entry->count_live, 1);
+	atomic_sub_z(&entry->bytes_live, len);
+	atomic_add_z(&entry->lifetime[bucket], 1);
+}
+
+static void *mem_profile_mallocN(size_t len, const char *str, bool use_calloc)
+{
+	MemHeadProfile *memh_profile;
+	MemHead *memh;
+	const size_t len_alloc = len + sizeof(MemHeadProfile) + sizeof(MemHead);
+
+	memh_profile = use_calloc ? calloc(1, len_alloc) : malloc(len_alloc);
+
+	if (UNLIKELY(memh_profile == NULL)) {
+		return NULL;
+	}
+
+	mem_profile_alloc(memh_profile, len, str);
+
+	memh = (MemHead *)(memh_profile + 1);
+	memh->len = len | MEMHEAD_PROFILE_FLAG;
+
+	if (UNLIKELY(!use_calloc && malloc_debug_memset && len)) {
+		memset(memh + 1, 255, len);
+	}
+	mem_counters_add(len, false);
+
+	return PTR_FROM_MEMHEAD(memh);
+}
+
+static const char *mem_profile_count_str(char str[32], size_t count)
+{
+	snprintf(str, 32, SIZET_FORMAT, SIZET_ARG(count));
+	return str;
+}
+
+static int mem_profile_entry_cmp(const void *a, const void *b)
+{
+	const MemProfileEntry *entry_a = *(const MemProfileEntry **)a;
+	const MemProfileEntry *entry_b = *(const MemProfileEntry **)b;
+
+	if (entry_a->bytes_peak > entry_b->bytes_peak) return -1;
+	if (entry_a->bytes_peak < entry_b->bytes_peak) return  1;
+	return 0;
+}
+
+/**
+ * Start sampling one in every \a sample_rate allocations, 0 to stop
+ * (blocks which were sampled already are still accounted for when freed).
+ * Can be called at any time, only the lock-free allocator is profiled.
+ */
+void MEM_enable_profile(unsigned int sample_rate)
+{
+	mem_profile_sample_rate = sample_rate;
+}
+
+/**
+ * Print the statistics of all allocation strings which had sampled allocations, largest peak first.
+ * Counts and sizes are estimates, scaled by the sample rate.
+ */
+void MEM_print_profile(void)
+{
+	MemProfileEntry **entries;
+	const size_t scale = mem_profile_sample_rate ? mem_profile_sample_rate : 1;
+	unsigned int entries_len = 0, i;
+	int bucket;
+
+	if (mem_profile_clock == 0) {
+		return;
+	}
+
+	entries = malloc(sizeof(*entries) * (MEM_PROFILE_ENTRIES + 1));
+	if (entries == NULL) {
+		return;
+	}
+
+	for (i = 0; i < MEM_PROFILE_ENTRIES; i++) {
+		if (mem_profile_entries[i].name) {
+			entries[entries_len++] = &mem_profile_entries[i];
+		}
+	}
+	if (mem_profile_entry_other.count) {
+		entries[entries_len++] = &mem_profile_entry_other;
+	}
+
+	qsort(entries, entries_len, sizeof(*entries), mem_profile_entry_cmp);
+
+	printf("\nMemory profile, 1 in %u allocations sampled, " SIZET_FORMAT " samples:\n",
+	       (unsigned int)scale, SIZET_ARG(mem_profile_clock));
+	printf("%10s %10s %10s %10s %10s  %s\n", "peak MB", "live MB", "total MB", "count", "live", "name");
+
+	for (i = 0; i < entries_len; i++) {
+		const MemProfileEntry *entry = entries[i];
+		char count_str[32], count_live_str[32];
+
+		printf("%10.3f %10.3f %10.3f %10s %10s  %s\n",
+		       (double)(entry->bytes_peak * scale) / (double)(1024 * 1024),
+		       (double)(entry->bytes_live * scale) / (double)(1024 * 1024),
+		       (double)(entry->bytes * scale) / (double)(1024 * 1024),
+		       mem_profile_count_str(count_str, entry->count * scale),
+		       mem_profile_count_str(count_live_str, entry->count_live * scale),
+		       entry->name);
+
+		printf("%55s", "lifetime (log2 samples):");
+		for (bucket = 0; bucket < MEM_PROFILE_LIFETIME_BUCKETS; bucket++) {
+			printf(" " SIZET_FORMAT, SIZET_ARG(entry->lifetime[bucket] * scale));
+		}
+		printf("\n");
+	}
+
+	free(entries);
+}
+
 size_t MEM_lockfree_allocN_len(const void *vmemh)
 {
 	if (vmemh) {
-		return MEMHEAD_FROM_PTR(vmemh)->len & ~((size_t) (MEMHEAD_MMAP_FLAG | MEMHEAD_ALIGN_FLAG));
+		return MEMHEAD_FROM_PTR(vmemh)->len & ~((size_t) (MEMHEAD_MMAP_FLAG | MEMHEAD_ALIGN_FLAG) | MEMHEAD_PROFILE_FLAG);
 	}
 	else {
 		return 0;
@@ -142,11 +451,9 @@ void MEM_lockfree_freeN(void *vmemh)
 		return;
 	}
 
-	atomic_sub_u(&totblock, 1);
-	atomic_sub_z(&mem_in_use, len);
+	mem_counters_sub(len, MEMHEAD_IS_MMAP(memh) != 0);
 
 	if (MEMHEAD_IS_MMAP(memh)) {
-		atomic_sub_z(&mmap_in_use, len);
 #if defined(WIN32)
 		/* our windows mmap implementation is not thread safe */
 		mem_lock_thread();
@@ -161,7 +468,12 @@ void MEM_lockfree_freeN(void *vmemh)
 		if (UNLIKELY(malloc_debug_memset && len)) {
 			memset(memh + 1, 255, len);
 		}
-		if (UNLIKELY(MEMHEAD_IS_ALIGNED(memh))) {
+		if (UNLIKELY(MEMHEAD_IS_PROFILED(memh))) {
+			MemHeadProfile *memh_profile = ((MemHeadProfile *)memh) - 1;
+			mem_profile_free(memh_profile, len);
+			free(memh_profile);
+		}
+		else if (UNLIKELY(MEMHEAD_IS_ALIGNED(memh))) {
 			MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
 			aligned_free(MEMHEAD_REAL_PTR(memh_aligned));
 		}
@@ -283,18 +595,23 @@ void *MEM_lockfree_callocN(size_t len, const char *str)
 
 	len = SIZET_ALIGN_4(len);
 
+	if (UNLIKELY(mem_profile_sample_rate) && mem_profile_sample_test()) {
+		void *ptr = mem_profile_mallocN(len, str, true);
+		if (LIKELY(ptr)) {
+			return ptr;
+		}
+	}
+
 	memh = (MemHead *)calloc(1, len + sizeof(MemHead));
 
 	if (LIKELY(memh)) {
 		memh->len = len;
-		atomic_add_u(&totblock, 1);
-		atomic_add_z(&mem_in_use, len);
-		update_maximum(&peak_mem, mem_in_use);
+		mem_counters_add(len, false);
 
 		return PTR_FROM_MEMHEAD(memh);
 	}
 	print_error("Calloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
-	            SIZET_ARG(len), str, (unsigned int) mem_in_use);
+	            SIZET_ARG(len), str, (unsigned int) mem_counters_mem_in_use());
 	return NULL;
 }
 
@@ -304,6 +621,13 @@ void *MEM_lockfree_mallocN(size_t len, const char *str)
 
 	len = SIZET_ALIGN_4(len);
 
+	if (UNLIKELY(mem_profile_sample_rate) && mem_profile_sample_test()) {
+		void *ptr = mem_profile_mallocN(len, str, false);
+		if (LIKELY(ptr)) {
+			return ptr;
+		}
+	}
+
 	memh = (MemHead *)malloc(len + sizeof(MemHead));
 
 	if (LIKELY(memh)) {
@@ -312,14 +636,12 @@ void *MEM_lockfree_mallocN(size_t len, const char *str)
 		}
 
 		memh->len = len;
-		atomic_add_u(&totblock, 1);
-		atomic_add_z(&mem_in_use, len);
-		update_maximum(&peak_mem, mem_in_use);
+		mem_counters_add(len, false);
 
 		return PTR_FROM_MEMHEAD(memh);
 	}
 	print_error("Malloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
-	            SIZET_ARG(len), str, (unsigned int) mem_in_use);
+	            SIZET_ARG(len), str, (unsigned int) mem_counters_mem_in_use());
 	return NULL;
 }
 
@@ -361,14 +683,12 @@ void *MEM_lockfree_mallocN_aligned(size_t len, size_t alignment, const char *str
 
 		memh->len = len | (size_t) MEMHEAD_ALIGN_FLAG;
 		memh->alignment = (short) alignment;
-		atomic_add_u(&totblock, 1);
-		atomic_add_z(&mem_in_use, len);
-		update_maximum(&peak_mem, mem_in_use);
+		mem_counters_add(len, false);
 
 		return PTR_FROM_MEMHEAD(memh);
 	}
 	print_error("Malloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
-	            SIZET_ARG(len), str, (unsigned int) mem_in_use);
+	            SIZET_ARG(len), str, (unsigned int) mem_counters_mem_in_use());
 	return NULL;
 }
 
@@ -396,18 +716,13 @@ void *MEM_lockfree_mapallocN(size_t len, const char *str)
 
 	if (memh != (MemHead *)-1) {
 		memh->len = len | (size_t) MEMHEAD_MMAP_FLAG;
-		atomic_add_u(&totblock, 1);
-		atomic_add_z(&mem_in_use, len);
-		atomic_add_z(&mmap_in_use, len);
-
-		update_maximum(&peak_mem, mem_in_use);
-		update_maximum(&peak_mem, mmap_in_use);
+		mem_counters_add(len, true);
 
 		return PTR_FROM_MEMHEAD(memh);
 	}
 	print_error("Mapalloc returns null, fallback to regular malloc: "
 	            "len=" SIZET_FORMAT " in %s, total %u\n",
-	            SIZET_ARG(len), str, (unsigned int) mmap_in_use);
+	            SIZET_ARG(len), str, (unsigned int) mem_counters_mmap_in_use());
 	return MEM_lockfree_callocN(len, str);
 }
 
@@ -428,9 +743,9 @@ void MEM_lockfree_callbackmemlist(void (*func)(void *))
 void MEM_lockfree_printmemlist_stats(void)
 {
 	printf("\ntotal memory len: %.3f MB\n",
-	       (double)mem_in_use / (double)(1024 * 1024));
+	       (double)MEM_lockfree_get_memory_in_use() / (double)(1024 * 1024));
 	printf("peak memory len: %.3f MB\n",
-	       (double)peak_mem / (double)(1024 * 1024));
+	       (double)MEM_lockfree_get_peak_memory() / (double)(1024 * 1024));
 	printf("\nFor more detailed per-block statistics run Blender with memory debugging command line argument.\n");
 
 #ifdef HAVE_MALLOC_STATS
@@ -462,27 +777,28 @@ void MEM_lockfree_set_memory_debug(void)
 
 size_t MEM_lockfree_get_memory_in_use(void)
 {
-	return mem_in_use;
+	return mem_counters_mem_in_use();
 }
 
 size_t MEM_lockfree_get_mapped_memory_in_use(void)
 {
-	return mmap_in_use;
+	return mem_counters_mmap_in_use();
 }
 
 unsigned int MEM_lockfree_get_memory_blocks_in_use(void)
 {
-	return totblock;
+	return mem_counters_totblock();
 }
 
 /* dummy */
 void MEM_lockfree_reset_peak_memory(void)
 {
-	peak_mem = mem_in_use;
+	peak_mem = mem_counters_mem_in_use();
 }
 
 size_t MEM_lockfree_get_peak_memory(void)
 {
+	update_maximum(&peak_mem, mem_counters_mem_in_use());
 	return peak_mem;
 }
 
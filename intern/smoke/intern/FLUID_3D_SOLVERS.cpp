@@ -165,11 +165,27 @@ void FLUID_3D::solveHeat(float* field, float* b, unsigned char* skip)
 	if (_Acenter)  delete[] _Acenter;
 }
 
+// add up the partial sums of the z slabs in order, so the result doesn't depend on the number of threads
+static float sumSlabs(const float *slabs, int zRes)
+{
+	float sum = 0.0f;
+	for (int z = 1; z < zRes - 1; z++)
+		sum += slabs[z];
+	return sum;
+}
+
+static float maxSlabs(const float *slabs, int zRes)
+{
+	float max = 0.0f;
+	for (int z = 1; z < zRes - 1; z++)
+		max = (slabs[z] > max) ? slabs[z] : max;
+	return max;
+}
+
 void FLUID_3D::solvePressurePre(float* field, float* b, unsigned char* skip)
 {
-	int x, y, z;
-	size_t index;
-	float *_q, *_Precond, *_h, *_residual, *_direction;
+	float *_q, *_Precond, *_h, *_residual, *_direction, *_Acenter;
+	float *_slabSum, *_slabMax;
 
 	// i = 0
 	int i = 0;
@@ -179,20 +195,31 @@ void FLUID_3D::solvePressurePre(float* field, float* b, unsigned char* skip)
 	_q            = new float[_totalCells]; // set 0
 	_h			  = new float[_totalCells]; // set 0
 	_Precond	  = new float[_totalCells]; // set 0
+	_Acenter      = new float[_totalCells]; // set 0
+	_slabSum      = new float[_zRes];
+	_slabMax      = new float[_zRes];
 
 	memset(_residual, 0, sizeof(float)*_xRes*_yRes*_zRes);
 	memset(_q, 0, sizeof(float)*_xRes*_yRes*_zRes);
 	memset(_direction, 0, sizeof(float)*_xRes*_yRes*_zRes);
 	memset(_h, 0, sizeof(float)*_xRes*_yRes*_zRes);
 	memset(_Precond, 0, sizeof(float)*_xRes*_yRes*_zRes);
+	memset(_Acenter, 0, sizeof(float)*_xRes*_yRes*_zRes);
 
 	float deltaNew = 0.0f;
 
 	// r = b - Ax
-	index = _slabSize + _xRes + 1;
-	for (z = 1; z < _zRes - 1; z++, index += 2 * _xRes)
-		for (y = 1; y < _yRes - 1; y++, index += 2)
-		  for (x = 1; x < _xRes - 1; x++, index++)
+	// the stencil only depends on the obstacles, so its center is stored for the iterations
+#if PARALLEL==1
+	#pragma omp parallel for schedule(static)
+#endif
+	for (int z = 1; z < _zRes - 1; z++)
+	{
+		size_t index = (size_t)z * _slabSize + _xRes + 1;
+		float slabSum = 0.0f;
+
+		for (int y = 1; y < _yRes - 1; y++, index += 2)
+		  for (int x = 1; x < _xRes - 1; x++, index++)
 		  {
 			// if the cell is a variable
 			float Acenter = 0.0f;
@@ -219,6 +246,8 @@ void FLUID_3D::solvePressurePre(float* field, float* b, unsigned char* skip)
 			_residual[index] = 0.0f;
 			}
 
+			_Acenter[index] = Acenter;
+
 			// P^-1
 			if(Acenter < 1.0f)
 				_Precond[index] = 0.0;
@@ -228,9 +257,13 @@ void FLUID_3D::solvePressurePre(float* field, float* b, unsigned char* skip)
 			// p = P^-1 * r
 			_direction[index] = _residual[index] * _Precond[index];
 
-			deltaNew += _residual[index] * _direction[index];
+			slabSum += _residual[index] * _direction[index];
 		  }
 
+		_slabSum[z] = slabSum;
+	}
+	deltaNew = sumSlabs(_slabSum, _zRes);
+
 
   // While deltaNew > (eps^2) * delta0
   const float eps  = SOLVER_ACCURACY;
@@ -242,24 +275,21 @@ void FLUID_3D::solvePressurePre(float* field, float* b, unsigned char* skip)
 
 	float alpha = 0.0f;
 
-    index = _slabSize + _xRes + 1;
-    for (z = 1; z < _zRes - 1; z++, index += 2 * _xRes)
-      for (y = 1; y < _yRes - 1; y++, index += 2)
-        for (x = 1; x < _xRes - 1; x++, index++)
+#if PARALLEL==1
+	#pragma omp parallel for schedule(static)
+#endif
+    for (int z = 1; z < _zRes - 1; z++)
+    {
+      size_t index = (size_t)z * _slabSize + _xRes + 1;
+      float slabSum = 0.0f;
+
+      for (int y = 1; y < _yRes - 1; y++, index += 2)
+        for (int x = 1; x < _xRes - 1; x++, index++)
         {
           // if the cell is a variable
-          float Acenter = 0.0f;
           if (!skip[index])
           {
-            // set the matrix to the Poisson stencil in order
-            if (!skip[index + 1]) Acenter += 1.0f;
-            if (!skip[index - 1]) Acenter += 1.0f;
-            if (!skip[index + _xRes]) Acenter += 1.0f;
-            if (!skip[index - _xRes]) Acenter += 1.0f;
-            if (!skip[index + _slabSize]) Acenter += 1.0f;
-            if (!skip[index - _slabSize]) Acenter += 1.0f;
-
-			_q[index] = Acenter * _direction[index] +  
+			_q[index] = _Acenter[index] * _direction[index] +  
             _direction[index - 1] * (skip[index - 1] ? 0.0f : -1.0f) +
             _direction[index + 1] * (skip[index + 1] ? 0.0f : -1.0f) +
             _direction[index - _xRes] * (skip[index - _xRes] ? 0.0f : -1.0f) +
@@ -272,9 +302,13 @@ void FLUID_3D::solvePressurePre(float* field, float* b, unsigned char* skip)
           _q[index] = 0.0f;
 		  }
 
-		  alpha += _direction[index] * _q[index];
+		  slabSum += _direction[index] * _q[index];
         }
 
+      _slabSum[z] = slabSum;
+    }
+    alpha = sumSlabs(_slabSum, _zRes);
+
 
     if (fabs(alpha) > 0.0f)
       alpha = deltaNew / alpha;
@@ -284,13 +318,17 @@ void FLUID_3D::solvePressurePre(float* field, float* b, unsigned char* skip)
 
 	maxR = 0.0;
 
-	float tmp;
-
     // x = x + alpha * d
-    index = _slabSize + _xRes + 1;
-    for (z = 1; z < _zRes - 1; z++, index += 2 * _xRes)
-      for (y = 1; y < _yRes - 1; y++, index += 2)
-        for (x = 1; x < _xRes - 1; x++, index++)
+#if PARALLEL==1
+	#pragma omp parallel for schedule(static)
+#endif
+    for (int z = 1; z < _zRes - 1; z++)
+    {
+      size_t index = (size_t)z * _slabSize + _xRes + 1;
+      float slabSum = 0.0f, slabMax = 0.0f;
+
+      for (int y = 1; y < _yRes - 1; y++, index += 2)
+        for (int x = 1; x < _xRes - 1; x++, index++)
 		{
           field[index] += alpha * _direction[index];
 
@@ -298,22 +336,33 @@ void FLUID_3D::solvePressurePre(float* field, float* b, unsigned char* skip)
 
 		  _h[index] = _Precond[index] * _residual[index];
 
-		  tmp = _residual[index] * _h[index];
-		  deltaNew += tmp;
-		  maxR = (tmp > maxR) ? tmp : maxR;
-
+		  float tmp = _residual[index] * _h[index];
+		  slabSum += tmp;
+		  slabMax = (tmp > slabMax) ? tmp : slabMax;
 		}
 
+      _slabSum[z] = slabSum;
+      _slabMax[z] = slabMax;
+    }
+    deltaNew = sumSlabs(_slabSum, _zRes);
+    maxR = maxSlabs(_slabMax, _zRes);
+
 
     // beta = deltaNew / deltaOld
     float beta = deltaNew / deltaOld;
 
     // d = h + beta * d
-    index = _slabSize + _xRes + 1;
-    for (z = 1; z < _zRes - 1; z++, index += 2 * _xRes)
-      for (y = 1; y < _yRes - 1; y++, index += 2)
-        for (x = 1; x < _xRes - 1; x++, index++)
+#if PARALLEL==1
+	#pragma omp parallel for schedule(static)
+#endif
+    for (int z = 1; z < _zRes - 1; z++)
+    {
+      size_t index = (size_t)z * _slabSize + _xRes + 1;
+
+      for (int y = 1; y < _yRes - 1; y++, index += 2)
+        for (int x = 1; x < _xRes - 1; x++, index++)
           _direction[index] = _h[index] + beta * _direction[index];
+    }
 
     // i = i + 1
     i++;
@@ -322,7 +371,10 @@ void FLUID_3D::solvePressurePre(float* field, float* b, unsigned char* skip)
 
 	if (_h) delete[] _h;
 	if (_Precond) delete[] _Precond;
+	if (_Acenter) delete[] _Acenter;
 	if (_residual) delete[] _residual;
 	if (_direction) delete[] _direction;
 	if (_q)       delete[] _q;
+	delete[] _slabSum;
+	delete[] _slabMax;
 }
@@ -515,5 +515,47 @@ static inline float WNoiseDz(Vec3 p, float* data) {
   return result;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// x, y and z derivatives of noise at once, gives the same values as WNoiseDx/Dy/Dz
+// but shares the weights and the 27 tile lookups between them
+//////////////////////////////////////////////////////////////////////////////////////////
+static inline void WNoiseGradient(Vec3 p, float* data, float result[3]) { 
+  int c[3], mid[3], n = noiseTileSize;
+  float w[3][3], dw[3][3], t;
+
+  for (int i = 0; i < 3; i++) {
+    mid[i] = (int)ceil(p[i] - 0.5f);
+    t = mid[i] - (p[i] - 0.5f);
+
+    // quadratic B-spline weights
+    w[i][0] = t * t / 2;
+    w[i][2] = (1 - t) * (1 - t) / 2;
+    w[i][1] = 1 - w[i][0] - w[i][2];
+
+    // and their derivatives
+    dw[i][0] = -t;
+    dw[i][2] = (1.f - t);
+    dw[i][1] = 2.0f * t - 1.0f;
+  }
+
+  result[0] = result[1] = result[2] = 0.0f;
+
+  for (int z = -1; z <=1; z++) {
+    c[2] = modFast128(mid[2] + z);
+    for (int y = -1; y <=1; y++) {
+      c[1] = modFast128(mid[1] + y);
+      for (int x = -1; x <=1; x++) {
+        c[0] = modFast128(mid[0] + x);
+        const float value = data[c[2]*n*n+c[1]*n+c[0]];
+
+        // same order of multiplications as the single derivatives
+        result[0] += ((1.0f * dw[0][x+1]) * w[1][y+1]) * w[2][z+1] * value;
+        result[1] += ((1.0f * w[0][x+1]) * dw[1][y+1]) * w[2][z+1] * value;
+        result[2] += ((1.0f * w[0][x+1]) * w[1][y+1]) * dw[2][z+1] * value;
+      }
+    }
+  }
+}
+
 #endif
 
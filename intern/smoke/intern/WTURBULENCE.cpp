@@ -48,6 +48,15 @@
 // 2^ {-5/6}
 static const float persistence = 0.56123f;
 
+// true when a field has no smoke at all, advecting it would only give zeros again
+static bool fieldIsEmpty(const float *field, int size)
+{
+	for (int i = 0; i < size; i++)
+		if (field[i] != 0.0f)
+			return false;
+	return true;
+}
+
 //////////////////////////////////////////////////////////////////////
 // constructor
 //////////////////////////////////////////////////////////////////////
@@ -613,23 +622,17 @@ Vec3 WTURBULENCE::WVelocityWithJacobian(Vec3 orgPos, float* xUnwarped, float* yU
   const Vec3 p3 = orgPos + Vec3(0,0,NOISE_TILE_SIZE/2.0);
 
   Vec3 final;
-  final[0] = WNoiseDx(p1, _noiseTile);
-  final[1] = WNoiseDy(p1, _noiseTile);
-  final[2] = WNoiseDz(p1, _noiseTile);
+  WNoiseGradient(p1, _noiseTile, &final[0]);
   // UNUSED const float f1x = xUnwarped[0] * final[0] + xUnwarped[1] * final[1] + xUnwarped[2] * final[2];
   const float f1y = yUnwarped[0] * final[0] + yUnwarped[1] * final[1] + yUnwarped[2] * final[2];
   const float f1z = zUnwarped[0] * final[0] + zUnwarped[1] * final[1] + zUnwarped[2] * final[2];
 
-  final[0] = WNoiseDx(p2, _noiseTile);
-  final[1] = WNoiseDy(p2, _noiseTile);
-  final[2] = WNoiseDz(p2, _noiseTile);
+  WNoiseGradient(p2, _noiseTile, &final[0]);
   const float f2x = xUnwarped[0] * final[0] + xUnwarped[1] * final[1] + xUnwarped[2] * final[2];
   // UNUSED const float f2y = yUnwarped[0] * final[0] + yUnwarped[1] * final[1] + yUnwarped[2] * final[2];
   const float f2z = zUnwarped[0] * final[0] + zUnwarped[1] * final[1] + zUnwarped[2] * final[2];
 
-  final[0] = WNoiseDx(p3, _noiseTile);
-  final[1] = WNoiseDy(p3, _noiseTile);
-  final[2] = WNoiseDz(p3, _noiseTile);
+  WNoiseGradient(p3, _noiseTile, &final[0]);
   const float f3x = xUnwarped[0] * final[0] + xUnwarped[1] * final[1] + xUnwarped[2] * final[2];
   const float f3y = yUnwarped[0] * final[0] + yUnwarped[1] * final[1] + yUnwarped[2] * final[2];
   // UNUSED const float f3z = zUnwarped[0] * final[0] + zUnwarped[1] * final[1] + zUnwarped[2] * final[2];
@@ -1052,6 +1055,29 @@ void WTURBULENCE::stepTurbulenceFull(float dtOrg, float* xvel, float* yvel, floa
   SWAP_POINTERS(_color_gBig, _color_gBigOld);
   SWAP_POINTERS(_color_bBig, _color_bBigOld);
 
+  // skip the advection of fields without any smoke (e.g. before the first fire),
+  // their new values are just cleared
+  const bool advectDensity = !fieldIsEmpty(_densityBigOld, _totalCellsBig);
+  const bool advectFuel = _fuelBig &&
+      (!fieldIsEmpty(_fuelBigOld, _totalCellsBig) || !fieldIsEmpty(_reactBigOld, _totalCellsBig));
+  const bool advectColor = _color_rBig &&
+      (!fieldIsEmpty(_color_rBigOld, _totalCellsBig) ||
+       !fieldIsEmpty(_color_gBigOld, _totalCellsBig) ||
+       !fieldIsEmpty(_color_bBigOld, _totalCellsBig));
+
+  if (!advectDensity) {
+	memset(_densityBig, 0, sizeof(float) * _totalCellsBig);
+  }
+  if (_fuelBig && !advectFuel) {
+	memset(_fuelBig, 0, sizeof(float) * _totalCellsBig);
+	memset(_reactBig, 0, sizeof(float) * _totalCellsBig);
+  }
+  if (_color_rBig && !advectColor) {
+	memset(_color_rBig, 0, sizeof(float) * _totalCellsBig);
+	memset(_color_gBig, 0, sizeof(float) * _totalCellsBig);
+	memset(_color_bBig, 0, sizeof(float) * _totalCellsBig);
+  }
+
   // based on the maximum velocity present, see if we need to substep,
   // but cap the maximum number of substeps to 5
   const int maxSubSteps = 25;
@@ -1095,15 +1121,17 @@ void WTURBULENCE::stepTurbulenceFull(float dtOrg, float* xvel, float* yvel, floa
 		int zBegin = (int)((float)i*partSize + 0.5f);
 		int zEnd = (int)((float)(i+1)*partSize + 0.5f);
 #endif
-		FLUID_3D::advectFieldMacCormack1(dtSubdiv, bigUx, bigUy, bigUz, 
-		    _densityBigOld, tempDensityBig, _resBig, zBegin, zEnd);
-		if (_fuelBig) {
+		if (advectDensity) {
+			FLUID_3D::advectFieldMacCormack1(dtSubdiv, bigUx, bigUy, bigUz, 
+			    _densityBigOld, tempDensityBig, _resBig, zBegin, zEnd);
+		}
+		if (advectFuel) {
 			FLUID_3D::advectFieldMacCormack1(dtSubdiv, bigUx, bigUy, bigUz, 
 				_fuelBigOld, tempFuelBig, _resBig, zBegin, zEnd);
 			FLUID_3D::advectFieldMacCormack1(dtSubdiv, bigUx, bigUy, bigUz, 
 				_reactBigOld, tempReactBig, _resBig, zBegin, zEnd);
 		}
-		if (_color_rBig) {
+		if (advectColor) {
 			FLUID_3D::advectFieldMacCormack1(dtSubdiv, bigUx, bigUy, bigUz, 
 				_color_rBigOld, tempColor_rBig, _resBig, zBegin, zEnd);
 			FLUID_3D::advectFieldMacCormack1(dtSubdiv, bigUx, bigUy, bigUz, 
@@ -1122,15 +1150,17 @@ void WTURBULENCE::stepTurbulenceFull(float dtOrg, float* xvel, float* yvel, floa
 		int zBegin = (int)((float)i*partSize + 0.5f);
 		int zEnd = (int)((float)(i+1)*partSize + 0.5f);
 #endif
-		FLUID_3D::advectFieldMacCormack2(dtSubdiv, bigUx, bigUy, bigUz, 
-		    _densityBigOld, _densityBig, tempDensityBig, tempBig, _resBig, NULL, zBegin, zEnd);
-		if (_fuelBig) {
+		if (advectDensity) {
+			FLUID_3D::advectFieldMacCormack2(dtSubdiv, bigUx, bigUy, bigUz, 
+			    _densityBigOld, _densityBig, tempDensityBig, tempBig, _resBig, NULL, zBegin, zEnd);
+		}
+		if (advectFuel) {
 			FLUID_3D::advectFieldMacCormack2(dtSubdiv, bigUx, bigUy, bigUz, 
 				_fuelBigOld, _fuelBig, tempFuelBig, tempBig, _resBig, NULL, zBegin, zEnd);
 			FLUID_3D::advectFieldMacCormack2(dtSubdiv, bigUx, bigUy, bigUz, 
 				_reactBigOld, _reactBig, tempReactBig, tempBig, _resBig, NULL, zBegin, zEnd);
 		}
-		if (_color_rBig) {
+		if (advectColor) {
 			FLUID_3D::advectFieldMacCormack2(dtSubdiv, bigUx, bigUy, bigUz, 
 				_color_rBigOld, _color_rBig, tempColor_rBig, tempBig, _resBig, NULL, zBegin, zEnd);
 			FLUID_3D::advectFieldMacCormack2(dtSubdiv, bigUx, bigUy, bigUz, 
@@ -41,8 +41,32 @@ def _initialize():
     path_list = paths()
     for path in path_list:
         _bpy.utils._sys_path_ensure(path)
-    for addon in _user_preferences.addons:
-        enable(addon.module)
+    module_names = [addon.module for addon in _user_preferences.addons]
+    if _bpy.app.addons_render_only:
+        module_names = _render_modules(module_names)
+    for module_name in module_names:
+        enable(module_name)
+
+
+def _render_modules(module_names):
+    """
+    Filter add-ons for background rendering, using 'bl_info' so nothing is imported.
+    Keeps render engines and add-ons which set "render_required",
+    also add-ons which can't be found, these report the error as usual.
+    """
+    modules_refresh()
+
+    module_names_render = []
+    for module_name in module_names:
+        mod = addons_fake_modules.get(module_name)
+        if mod is not None:
+            bl_info = mod.bl_info
+            if not (bl_info.get("category") == "Render" or bl_info.get("render_required", False)):
+                if _bpy.app.debug_python:
+                    print("\taddon_utils: skipping %r, not needed for rendering" % module_name)
+                continue
+        module_names_render.append(module_name)
+    return module_names_render
 
 
 def paths():
@@ -40,6 +40,7 @@ __all__ = (
     "manual_map",
     "previews",
     "resource_path",
+    "rna_update_batch",
     "script_path_user",
     "script_path_pref",
     "script_paths",
@@ -59,6 +60,10 @@ from _bpy import (
         resource_path,
         )
 from _bpy import script_paths as _bpy_script_paths
+from _bpy import (
+        _rna_update_batch_begin,
+        _rna_update_batch_end,
+        )
 from _bpy import user_resource as _user_resource
 from _bpy import _utils_units as units
 
@@ -577,6 +582,29 @@ def user_resource(resource_type, path="", create=False):
     return target_path
 
 
+class rna_update_batch:
+    """
+    Context manager deferring the updates of the properties set inside it
+    until it exits, so that each update runs once per struct,
+    for scripts which set many properties at once.
+
+    .. code-block:: python
+
+       with bpy.utils.rna_update_batch():
+           for ob in objects:
+               ob.location.x += 1.0
+
+    .. note:: Data whose properties are set must not be removed inside the batch.
+    """
+    __slots__ = ()
+
+    def __enter__(self):
+        _rna_update_batch_begin()
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        _rna_update_batch_end()
+
+
 def _bpy_module_classes(module, is_registered=False):
     typemap_list = _bpy_types.TypeMap.get(module, ())
     i = 0
@@ -156,8 +156,8 @@ class DATA_PT_modifiers(ModifierButtonsPanel, Panel):
         col.label(text="Object:")
         col.prop(md, "object", text="")
 
-        layout.prop(md, "use_bmesh")
-        if md.use_bmesh:
+        layout.prop(md, "solver")
+        if md.solver == 'BMESH':
             box = layout.box()
             box.label("BMesh Options:")
             box.prop(md, "use_bmesh_separate")
@@ -882,6 +882,10 @@ class DATA_PT_modifiers(ModifierButtonsPanel, Panel):
         col.label(text="Subdivisions:")
         col.prop(md, "levels", text="View")
         col.prop(md, "render_levels", text="Render")
+        col.prop(md, "use_adaptive_render")
+        sub = col.column()
+        sub.active = md.use_adaptive_render
+        sub.prop(md, "dicing_rate")
 
         col = split.column()
         col.label(text="Options:")
@@ -493,6 +493,7 @@ class USERPREF_PT_system(Panel):
         # currently disabled in the code
         # col.prop(system, "prefetch_frames")
         col.prop(system, "memory_cache_limit")
+        col.prop(system, "sequencer_disk_cache_limit", text="Disk Cache Limit")
 
         # 3. Column
         column = split.column()
@@ -901,6 +902,7 @@ class USERPREF_PT_file(Panel):
         sub.label(text="Sounds:")
         sub.label(text="Temp:")
         sub.label(text="Render Cache:")
+        sub.label(text="Sequencer Cache:")
         sub.label(text="I18n Branches:")
         sub.label(text="Image Editor:")
         sub.label(text="Animation Player:")
@@ -913,6 +915,7 @@ class USERPREF_PT_file(Panel):
         sub.prop(paths, "sound_directory", text="")
         sub.prop(paths, "temporary_directory", text="")
         sub.prop(paths, "render_cache_directory", text="")
+        sub.prop(paths, "sequencer_disk_cache_directory", text="")
         sub.prop(paths, "i18n_branches_directory", text="")
         sub.prop(paths, "image_editor", text="")
         subsplit = sub.split(percentage=0.3)
@@ -3163,6 +3163,8 @@ class VIEW3D_PT_view3d_shading(Panel):
                 col.prop(view, "show_textured_shadeless")
 
         col.prop(view, "show_backface_culling")
+        if scene.render.engine != 'BLENDER_GAME':
+            col.prop(view, "show_lod")
 
         if view.viewport_shade not in {'BOUNDBOX', 'WIREFRAME'}:
             if obj and obj.mode == 'EDIT':
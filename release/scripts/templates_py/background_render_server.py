@@ -0,0 +1,174 @@
+# This script keeps blender running in background mode as a render server,
+# so consecutive render jobs for the same file don't pay for blender startup,
+# reading the file and (with Cycles) building the render scene again.
+#
+# Example usage:
+#  blender --background --addons-render-only --python $HOME/background_render_server.py -- \
+#          --port=7000
+#
+# Jobs are sent as one JSON object per line, the server replies with one JSON
+# object per line once the job is finished, eg:
+#
+#  {"file": "/shots/010.blend", "frame_start": 1, "frame_end": 4,
+#   "output": "/renders/010/####", "overrides": {"render.resolution_percentage": 50}}
+#
+#  {"status": "OK", "time": 12.5, "file_reloaded": false}
+#
+# "overrides" are paths relative to the scene (eg "cycles.samples"),
+# they are restored after the job, so later jobs for the same file start from the file's values.
+# Send {"quit": true} to stop the server.
+#
+# Notice:
+# The file is only read again when a job uses another file, or the file changed on disk.
+# Persistent data is enabled for rendered scenes, so Cycles keeps its scene and BVH
+# between frames and jobs, only updating what changed.
+
+import bpy
+
+
+class RenderServer:
+    def __init__(self):
+        self.filepath = ""
+        self.mtime = 0.0
+
+    def file_ensure(self, filepath):
+        """Open the file unless it's already loaded and unchanged, returns True when it was read."""
+        import os
+
+        filepath = os.path.abspath(filepath)
+        mtime = os.path.getmtime(filepath)
+
+        if filepath == self.filepath and mtime == self.mtime:
+            return False
+
+        bpy.ops.wm.open_mainfile(filepath=filepath)
+        self.filepath = filepath
+        self.mtime = mtime
+        return True
+
+    @staticmethod
+    def overrides_apply(scene, overrides):
+        """Set all overrides, returns their previous values to restore them afterwards."""
+        overrides_orig = []
+        for data_path, value in overrides.items():
+            owner_path, _, attr = data_path.rpartition(".")
+            owner = scene.path_resolve(owner_path) if owner_path else scene
+            overrides_orig.append((owner, attr, getattr(owner, attr)))
+            setattr(owner, attr, value)
+        return overrides_orig
+
+    @staticmethod
+    def overrides_restore(overrides_orig):
+        for owner, attr, value in reversed(overrides_orig):
+            setattr(owner, attr, value)
+
+    def render(self, job):
+        import time
+
+        time_start = time.time()
+        file_reloaded = self.file_ensure(job["file"])
+
+        scene = bpy.data.scenes[job["scene"]] if "scene" in job else bpy.context.scene
+
+        # not restored, disabling it frees the data kept for the next job
+        scene.render.use_persistent_data = True
+
+        frame = job.get("frame_start", scene.frame_current)
+        overrides = {
+            "frame_start": frame,
+            "frame_end": job.get("frame_end", frame),
+        }
+        if "output" in job:
+            overrides["render.filepath"] = job["output"]
+        overrides.update(job.get("overrides", {}))
+
+        overrides_orig = self.overrides_apply(scene, overrides)
+        try:
+            bpy.ops.render.render(animation=True, scene=scene.name)
+            output = scene.render.frame_path(frame=frame)
+        finally:
+            self.overrides_restore(overrides_orig)
+
+        return {
+            "status": "OK",
+            "time": time.time() - time_start,
+            "file_reloaded": file_reloaded,
+            "output": output,
+        }
+
+    def serve(self, host, port):
+        import socket
+        import json
+
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        sock.bind((host, port))
+        sock.listen(1)
+        print("render server listening on %s:%d" % (host, port))
+
+        is_running = True
+        while is_running:
+            conn, _ = sock.accept()
+            with conn, conn.makefile("rw", encoding="utf-8") as stream:
+                for line in stream:
+                    if not line.strip():
+                        continue
+                    try:
+                        job = json.loads(line)
+                        if job.get("quit"):
+                            is_running = False
+                            reply = {"status": "OK"}
+                        else:
+                            reply = self.render(job)
+                    except Exception as ex:
+                        import traceback
+                        traceback.print_exc()
+                        reply = {"status": "ERROR", "message": str(ex)}
+
+                    stream.write(json.dumps(reply) + "\n")
+                    stream.flush()
+
+                    if not is_running:
+                        break
+
+        sock.close()
+
+
+def main():
+    import sys       # to get command line args
+    import argparse  # to parse options for us and print a nice help message
+
+    # get the args passed to blender after "--", all of which are ignored by
+    # blender so scripts may receive their own arguments
+    argv = sys.argv
+
+    if "--" not in argv:
+        argv = []  # as if no args are passed
+    else:
+        argv = argv[argv.index("--") + 1:]  # get all args after "--"
+
+    usage_text = (
+            "Run blender in background mode with this script:"
+            "  blender --background --python " + __file__ + " -- [options]"
+            )
+
+    parser = argparse.ArgumentParser(description=usage_text)
+
+    parser.add_argument("--host", dest="host", type=str, default="127.0.0.1",
+            help="Address to listen on (only local connections by default)")
+    parser.add_argument("--port", dest="port", type=int, default=7000,
+            help="Port to listen on")
+
+    args = parser.parse_args(argv)
+
+    if not bpy.app.background:
+        print("Error: the render server only runs in background mode, aborting.")
+        return
+
+    RenderServer().serve(args.host, args.port)
+
+    print("render server finished, exiting")
+
+
+if __name__ == "__main__":
+    main()
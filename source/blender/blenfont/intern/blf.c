@@ -534,6 +534,9 @@ static void blf_draw_gl__start(FontBLF *font, GLint *mode)
 
 static void blf_draw_gl__end(GLint mode)
 {
+	/* draw glyphs still waiting in the batch */
+	blf_glyph_batch_flush();
+
 	glMatrixMode(GL_TEXTURE);
 	glPopMatrix();
 
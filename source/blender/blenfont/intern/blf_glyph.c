@@ -308,21 +308,58 @@ void blf_glyph_free(GlyphBLF *g)
 	MEM_freeN(g);
 }
 
+/* Glyph quads are collected and drawn together, they only need to be flushed
+ * when the texture or the color changes, or drawing of the string ends. */
+#define BLF_BATCH_QUADS_MAX 256
+
+static struct {
+	float pos[BLF_BATCH_QUADS_MAX * 4][2];
+	float uv[BLF_BATCH_QUADS_MAX * 4][2];
+	unsigned int quads_len;
+} g_batch = {{{0}}};
+
+void blf_glyph_batch_flush(void)
+{
+	if (g_batch.quads_len == 0) {
+		return;
+	}
+
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 0, g_batch.pos);
+	glTexCoordPointer(2, GL_FLOAT, 0, g_batch.uv);
+
+	glDrawArrays(GL_QUADS, 0, (GLsizei)(g_batch.quads_len * 4));
+
+	glPopClientAttrib();
+
+	g_batch.quads_len = 0;
+}
+
 static void blf_texture_draw(float uv[2][2], float dx, float y1, float dx1, float y2)
 {
-	glBegin(GL_QUADS);
-	glTexCoord2f(uv[0][0], uv[0][1]);
-	glVertex2f(dx, y1);
-	
-	glTexCoord2f(uv[0][0], uv[1][1]);
-	glVertex2f(dx, y2);
-	
-	glTexCoord2f(uv[1][0], uv[1][1]);
-	glVertex2f(dx1, y2);
-	
-	glTexCoord2f(uv[1][0], uv[0][1]);
-	glVertex2f(dx1, y1);
-	glEnd();
+	float (*pos)[2], (*tex)[2];
+
+	if (UNLIKELY(g_batch.quads_len == BLF_BATCH_QUADS_MAX)) {
+		blf_glyph_batch_flush();
+	}
+
+	pos = &g_batch.pos[g_batch.quads_len * 4];
+	tex = &g_batch.uv[g_batch.quads_len * 4];
+	g_batch.quads_len++;
+
+	tex[0][0] = uv[0][0]; tex[0][1] = uv[0][1];
+	pos[0][0] = dx;       pos[0][1] = y1;
+
+	tex[1][0] = uv[0][0]; tex[1][1] = uv[1][1];
+	pos[1][0] = dx;       pos[1][1] = y2;
+
+	tex[2][0] = uv[1][0]; tex[2][1] = uv[1][1];
+	pos[2][0] = dx1;      pos[2][1] = y2;
+
+	tex[3][0] = uv[1][0]; tex[3][1] = uv[0][1];
+	pos[3][0] = dx1;      pos[3][1] = y1;
 }
 
 static void blf_texture5_draw(const float shadow_col[4], float uv[2][2], float x1, float y1, float x2, float y2)
@@ -344,11 +381,13 @@ static void blf_texture5_draw(const float shadow_col[4], float uv[2][2], float x
 	for (dx = -2; dx < 3; dx++) {
 		for (dy = -2; dy < 3; dy++, fp++) {
 			color[3] = *(fp) * shadow_col[3];
+			blf_glyph_batch_flush();
 			glColor4fv(color);
 			blf_texture_draw(uv, x1 + dx, y1 + dy, x2 + dx, y2 + dy);
 		}
 	}
 	
+	blf_glyph_batch_flush();
 	glColor4fv(color);
 }
 
@@ -369,11 +408,13 @@ static void blf_texture3_draw(const float shadow_col[4], float uv[2][2], float x
 	for (dx = -1; dx < 2; dx++) {
 		for (dy = -1; dy < 2; dy++, fp++) {
 			color[3] = *(fp) * shadow_col[3];
+			blf_glyph_batch_flush();
 			glColor4fv(color);
 			blf_texture_draw(uv, x1 + dx, y1 + dy, x2 + dx, y2 + dy);
 		}
 	}
 	
+	blf_glyph_batch_flush();
 	glColor4fv(color);
 }
 
@@ -395,6 +436,10 @@ void blf_glyph_render(FontBLF *font, GlyphBLF *g, float x, float y)
 	if (g->build_tex == 0) {
 		GlyphCacheBLF *gc = font->glyph_cache;
 
+		/* uploading changes the bound texture */
+		blf_glyph_batch_flush();
+		font->tex_bind_state = (unsigned int)-1;
+
 		if (font->max_tex_size == -1)
 			glGetIntegerv(GL_MAX_TEXTURE_SIZE, (GLint *)&font->max_tex_size);
 
@@ -465,6 +510,7 @@ void blf_glyph_render(FontBLF *font, GlyphBLF *g, float x, float y)
 	}
 
 	if (font->tex_bind_state != g->tex) {
+		blf_glyph_batch_flush();
 		glBindTexture(GL_TEXTURE_2D, (font->tex_bind_state = g->tex));
 	}
 
@@ -482,11 +528,13 @@ void blf_glyph_render(FontBLF *font, GlyphBLF *g, float x, float y)
 				blf_texture5_draw(font->shadow_col, g->uv, rect_ofs.xmin, rect_ofs.ymin, rect_ofs.xmax, rect_ofs.ymax);
 				break;
 			default:
+				blf_glyph_batch_flush();
 				glColor4fv(font->shadow_col);
 				blf_texture_draw(g->uv, rect_ofs.xmin, rect_ofs.ymin, rect_ofs.xmax, rect_ofs.ymax);
 				break;
 		}
 
+		blf_glyph_batch_flush();
 		glColor4fv(font->orig_col);
 	}
 
@@ -528,6 +528,8 @@ void          DM_to_bmesh_ex(struct DerivedMesh *dm, struct BMesh *bm, const boo
 struct BMesh *DM_to_bmesh(struct DerivedMesh *dm, const bool calc_face_normal);
 
 
+void DM_modifier_stack_cache_free(struct ModifierData *md);
+
 /** Utility function to convert a DerivedMesh to a shape key block */
 void DM_to_meshkey(DerivedMesh *dm, struct Mesh *me, struct KeyBlock *kb);
 
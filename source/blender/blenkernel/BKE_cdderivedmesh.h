@@ -80,6 +80,11 @@ DerivedMesh *CDDM_from_curve_displist(struct Object *ob, struct ListBase *dispba
 struct DerivedMesh *CDDM_copy(struct DerivedMesh *dm);
 struct DerivedMesh *CDDM_copy_from_tessface(struct DerivedMesh *dm);
 
+/* Same as CDDM_copy followed by releasing the given DerivedMesh,
+ * without copying its layers when it's a CDDerivedMesh nothing else uses.
+ */
+struct DerivedMesh *CDDM_copy_and_release(struct DerivedMesh *dm);
+
 /* creates a CDDerivedMesh with the same layer stack configuration as the
  * given DerivedMesh and containing the requested numbers of elements.
  * elements are initialized to all zeros
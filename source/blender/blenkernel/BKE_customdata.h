@@ -208,6 +208,7 @@ bool CustomData_is_referenced_layer(struct CustomData *data, int type);
  */
 void CustomData_set_only_copy(const struct CustomData *data,
                               CustomDataMask mask);
+void CustomData_free_layers_nocopy(struct CustomData *data, CustomDataMask mask, int totelem);
 
 /* copies data from one CustomData object to another
  * objects need not be compatible, each source layer is copied to the
@@ -253,6 +254,10 @@ void CustomData_bmesh_interp(
         struct CustomData *data, const void **src_blocks,
         const float *weights, const float *sub_weights, int count,
         void *dst_block);
+void CustomData_bmesh_interp_array(
+        struct CustomData *data, const void **src_blocks,
+        const float *weights, int count,
+        void **dst_blocks, int dst_num);
 
 
 /* swaps the data in the element corners, to new corners with indices as
@@ -340,6 +345,7 @@ void CustomData_set_layer_stencil_index(struct CustomData *data, int type, int n
 /* adds flag to the layer flags */
 void CustomData_set_layer_flag(struct CustomData *data, int type, int flag);
 
+void CustomData_bmesh_alloc_block(struct CustomData *data, void **block);
 void CustomData_bmesh_set_default(struct CustomData *data, void **block);
 void CustomData_bmesh_free_block(struct CustomData *data, void **block);
 void CustomData_bmesh_free_block_data(struct CustomData *data, void *block);
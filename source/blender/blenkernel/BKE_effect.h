@@ -105,6 +105,11 @@ typedef struct EffectorCache {
 	float guide_loc[4], guide_dir[3], guide_radius;
 	float velocity[3];
 
+	/* precalculated for visibility, used when the caller doesn't pass its own colliders */
+	struct ListBase *colliders;
+	/* precalculated for texture effectors */
+	bool scene_color_manage;
+
 	float frame;
 	int flag;
 } EffectorCache;
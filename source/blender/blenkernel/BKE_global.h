@@ -67,6 +67,8 @@ typedef struct Global {
 
 	bool background;
 	bool factory_startup;
+	/* background mode only enables add-ons needed for rendering (--addons-render-only) */
+	bool addons_render_only;
 
 	short moving;
 
@@ -0,0 +1,37 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+#ifndef __BKE_MESH_IMPORT_H__
+#define __BKE_MESH_IMPORT_H__
+
+/** \file BKE_mesh_import.h
+ *  \ingroup bke
+ *
+ * Native reading of OBJ, PLY and STL files into a single mesh.
+ */
+
+struct Main;
+struct Mesh;
+struct ReportList;
+
+bool BKE_mesh_import_supported(const char *filepath);
+struct Mesh *BKE_mesh_import(struct Main *bmain, const char *filepath, struct ReportList *reports);
+
+#endif  /* __BKE_MESH_IMPORT_H__ */
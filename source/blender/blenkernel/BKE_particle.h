@@ -99,6 +99,10 @@ typedef struct SPHData {
 	float element_size;
 	float flow[3];
 
+	/* When set, new fluid springs are collected here and added to psys[0] after a threaded loop,
+	 * instead of resizing the spring array of psys[0] while other threads read it. */
+	struct SPHNewSprings *new_springs;
+
 	/* Integrator callbacks. This allows different SPH implementations. */
 	void (*force_cb) (void *sphdata_v, ParticleKey *state, float *force, float *impulse);
 	void (*density_cb) (void *rangedata_v, int index, float squared_dist);
@@ -160,7 +164,7 @@ typedef struct ParticleThreadContext {
 
 typedef struct ParticleTask {
 	ParticleThreadContext *ctx;
-	struct RNG *rng, *rng_path;
+	struct RNG *rng;
 	int begin, end;
 } ParticleTask;
 
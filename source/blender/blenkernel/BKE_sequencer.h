@@ -252,6 +252,7 @@ bool BKE_sequencer_input_have_to_preprocess(const SeqRenderData *context, struct
 void BKE_sequencer_proxy_rebuild_context(struct Main *bmain, struct Scene *scene, struct Sequence *seq, struct GSet *file_list, ListBase *queue);
 void BKE_sequencer_proxy_rebuild(struct SeqIndexBuildContext *context, short *stop, short *do_update, float *progress);
 void BKE_sequencer_proxy_rebuild_finish(struct SeqIndexBuildContext *context, bool stop);
+bool BKE_sequencer_proxy_rebuild_is_threadsafe(struct SeqIndexBuildContext *context);
 
 void BKE_sequencer_proxy_set(struct Sequence *seq, bool value);
 /* **********************************************************************
@@ -279,6 +280,8 @@ struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context, struct Seque
  */
 
 void BKE_sequencer_cache_put(const SeqRenderData *context, struct Sequence *seq, float cfra, eSeqStripElemIBuf type, struct ImBuf *nval);
+void BKE_sequencer_cache_put_ex(const SeqRenderData *context, struct Sequence *seq, float cfra, eSeqStripElemIBuf type,
+                                struct ImBuf *nval, float cost);
 
 void BKE_sequencer_cache_cleanup_sequence(struct Sequence *seq);
 
@@ -35,6 +35,9 @@
 
 #define SOUND_WAVE_SAMPLES_PER_SECOND 250
 
+/* maximum number of waveform resolutions, each halving the samples of the previous one */
+#define SOUND_WAVE_LEVELS_MAX 16
+
 #ifdef WITH_SYSTEM_AUDASPACE
 #  include AUD_DEVICE_H
 #endif
@@ -46,6 +49,12 @@ struct Sequence;
 typedef struct SoundWaveform {
 	int length;
 	float *data;
+
+	/* min, max and power like data, at decreasing resolutions for drawing zoomed out,
+	 * level 0 is data itself */
+	int levels;
+	int level_length[SOUND_WAVE_LEVELS_MAX];
+	float *level_data[SOUND_WAVE_LEVELS_MAX];
 } SoundWaveform;
 
 void BKE_sound_init_once(void);
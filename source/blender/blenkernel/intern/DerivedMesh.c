@@ -48,6 +48,7 @@
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
 #include "BLI_linklist.h"
+#include "BLI_hash_mm2a.h"
 
 #include "BKE_cdderivedmesh.h"
 #include "BKE_editmesh.h"
@@ -73,6 +74,10 @@ static DerivedMesh *navmesh_dm_createNavMeshForVisualization(DerivedMesh *dm);
 
 #include "BLI_sys_types.h" /* for intptr_t support */
 
+#include "PIL_time.h"
+
+#include "atomic_ops.h"
+
 #include "GPU_buffers.h"
 #include "GPU_glew.h"
 #include "GPU_shader.h"
@@ -1166,19 +1171,14 @@ DerivedMesh *mesh_create_derived_for_modifier(
 
 static float (*get_editbmesh_orco_verts(BMEditMesh *em))[3]
 {
-	BMIter iter;
-	BMVert *eve;
 	float (*orco)[3];
-	int i;
 
 	/* these may not really be the orco's, but it's only for preview.
 	 * could be solver better once, but isn't simple */
 	
 	orco = MEM_mallocN(sizeof(float) * 3 * em->bm->totvert, "BMEditMesh Orco");
 
-	BM_ITER_MESH_INDEX (eve, &iter, em->bm, BM_VERTS_OF_MESH, i) {
-		copy_v3_v3(orco[i], eve->co);
-	}
+	BM_mesh_vert_coords_get(em->bm, orco, NULL);
 	
 	return orco;
 }
@@ -1699,6 +1699,236 @@ static void dm_ensure_display_normals(DerivedMesh *dm)
 	}
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Modifier Stack Cache
+ *
+ * The result of expensive constructive modifiers is kept in #ModifierData.stack_cache,
+ * keyed by a hash of the modifier settings and of its input mesh.
+ * When a modifier further down the stack is tweaked, the ones above it find their key unchanged
+ * and reuse their result, instead of the whole stack being evaluated from the base mesh again.
+ *
+ * Only modifiers which read nothing but their settings and the mesh are cached,
+ * anything depending on other objects, textures or time is always evaluated.
+ * \{ */
+
+/* modifiers evaluating faster than this (in seconds) aren't worth copying their result */
+#define MODIFIER_STACK_CACHE_MIN_TIME 0.005
+/* total memory used by the cached meshes of all modifiers */
+#define MODIFIER_STACK_CACHE_LIMIT ((size_t)512 * 1024 * 1024)
+
+typedef struct ModifierStackCache {
+	uint32_t key;
+	/* the last evaluation took longer than MODIFIER_STACK_CACHE_MIN_TIME */
+	bool is_expensive;
+	DerivedMesh *dm;
+	size_t mem_size;
+} ModifierStackCache;
+
+static size_t modifier_stack_cache_mem = 0;
+
+static void modifier_stack_cache_clear(ModifierStackCache *cache)
+{
+	if (cache->dm) {
+		cache->dm->release(cache->dm);
+		cache->dm = NULL;
+		atomic_sub_z(&modifier_stack_cache_mem, cache->mem_size);
+		cache->mem_size = 0;
+	}
+}
+
+void DM_modifier_stack_cache_free(ModifierData *md)
+{
+	ModifierStackCache *cache = md->stack_cache;
+
+	if (cache) {
+		modifier_stack_cache_clear(cache);
+		MEM_freeN(cache);
+		md->stack_cache = NULL;
+	}
+}
+
+static void modifier_stack_cache_link_walk(void *userData, Object *UNUSED(ob), ID **idpoin, int UNUSED(cd_flag))
+{
+	if (*idpoin) {
+		*((bool *)userData) = true;
+	}
+}
+
+static bool modifier_stack_cache_supported(Object *ob, ModifierData *md)
+{
+	const ModifierTypeInfo *mti = modifierType_getInfo(md->type);
+	bool has_links = false;
+
+	if (!ELEM(md->type,
+	          eModifierType_Array, eModifierType_Bevel, eModifierType_Decimate,
+	          eModifierType_EdgeSplit, eModifierType_Mirror, eModifierType_Remesh,
+	          eModifierType_Screw, eModifierType_Skin, eModifierType_Solidify,
+	          eModifierType_Triangulate, eModifierType_Wireframe))
+	{
+		return false;
+	}
+
+	/* the result depends on other objects (array caps, mirror object...) */
+	if (mti->foreachIDLink) {
+		mti->foreachIDLink(md, ob, modifier_stack_cache_link_walk, &has_links);
+	}
+	if (mti->foreachObjectLink) {
+		mti->foreachObjectLink(md, ob, (ObjectWalkFunc)modifier_stack_cache_link_walk, &has_links);
+	}
+
+	return !has_links && !(mti->dependsOnTime && mti->dependsOnTime(md));
+}
+
+static bool modifier_stack_cache_hash_customdata(BLI_HashMurmur2A *mm2, const CustomData *data, const int totelem)
+{
+	int i;
+
+	BLI_hash_mm2a_add_int(mm2, totelem);
+
+	for (i = 0; i < data->totlayer; i++) {
+		const CustomDataLayer *layer = &data->layers[i];
+
+		BLI_hash_mm2a_add_int(mm2, layer->type);
+		BLI_hash_mm2a_add(mm2, (const unsigned char *)layer->name, strlen(layer->name));
+
+		if (layer->data == NULL) {
+			continue;
+		}
+
+		if (layer->type == CD_MDEFORMVERT) {
+			/* the weights are stored outside of the layer */
+			const MDeformVert *dvert = layer->data;
+			int j;
+
+			for (j = 0; j < totelem; j++, dvert++) {
+				BLI_hash_mm2a_add_int(mm2, dvert->totweight);
+				if (dvert->dw) {
+					BLI_hash_mm2a_add(mm2, (const unsigned char *)dvert->dw,
+					                  sizeof(*dvert->dw) * (size_t)dvert->totweight);
+				}
+			}
+		}
+		else if (ELEM(layer->type, CD_MDISPS, CD_GRID_PAINT_MASK, CD_BM_ELEM_PYPTR)) {
+			/* layers pointing to more data, not worth supporting */
+			return false;
+		}
+		else {
+			BLI_hash_mm2a_add(mm2, (const unsigned char *)layer->data,
+			                  (size_t)CustomData_sizeof(layer->type) * (size_t)totelem);
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Hash everything in \a dm a modifier may read.
+ *
+ * \return false when \a dm holds data which can't be hashed.
+ */
+static bool modifier_stack_cache_hash_dm(DerivedMesh *dm, uint32_t *r_key)
+{
+	BLI_HashMurmur2A mm2;
+
+	if (dm->type != DM_TYPE_CDDM) {
+		return false;
+	}
+
+	BLI_hash_mm2a_init(&mm2, 0);
+	BLI_hash_mm2a_add_int(&mm2, dm->cd_flag);
+
+	if (!modifier_stack_cache_hash_customdata(&mm2, &dm->vertData, dm->numVertData) ||
+	    !modifier_stack_cache_hash_customdata(&mm2, &dm->edgeData, dm->numEdgeData) ||
+	    !modifier_stack_cache_hash_customdata(&mm2, &dm->loopData, dm->numLoopData) ||
+	    !modifier_stack_cache_hash_customdata(&mm2, &dm->polyData, dm->numPolyData))
+	{
+		return false;
+	}
+
+	*r_key = BLI_hash_mm2a_end(&mm2);
+	return true;
+}
+
+/**
+ * Combine the hash of the input mesh with everything else the result of \a md depends on.
+ */
+static uint32_t modifier_stack_cache_key(
+        Object *ob, ModifierData *md, const uint32_t dm_key,
+        const CustomDataMask mask, const ModifierApplyFlag flag)
+{
+	const ModifierTypeInfo *mti = modifierType_getInfo(md->type);
+	const size_t data_size = sizeof(ModifierData);
+	BLI_HashMurmur2A mm2;
+	bDeformGroup *dg;
+
+	BLI_hash_mm2a_init(&mm2, dm_key);
+
+	/* the settings, the generic part of the struct only holds runtime data */
+	BLI_hash_mm2a_add_int(&mm2, md->type);
+	BLI_hash_mm2a_add_int(&mm2, md->mode);
+	BLI_hash_mm2a_add(&mm2, ((const unsigned char *)md) + data_size, (size_t)mti->structSize - data_size);
+
+	BLI_hash_mm2a_add(&mm2, (const unsigned char *)&mask, sizeof(mask));
+	BLI_hash_mm2a_add_int(&mm2, (int)flag);
+
+	/* object data used by some modifiers (solidify material offset, mirrored vertex groups) */
+	BLI_hash_mm2a_add_int(&mm2, ob->totcol);
+	for (dg = ob->defbase.first; dg; dg = dg->next) {
+		BLI_hash_mm2a_add(&mm2, (const unsigned char *)dg->name, strlen(dg->name));
+	}
+
+	return BLI_hash_mm2a_end(&mm2);
+}
+
+static size_t modifier_stack_cache_dm_size(DerivedMesh *dm)
+{
+	const CustomData *datas[4] = {&dm->vertData, &dm->edgeData, &dm->loopData, &dm->polyData};
+	const int totelems[4] = {dm->numVertData, dm->numEdgeData, dm->numLoopData, dm->numPolyData};
+	size_t mem_size = 0;
+	int i, j;
+
+	for (i = 0; i < 4; i++) {
+		for (j = 0; j < datas[i]->totlayer; j++) {
+			mem_size += (size_t)CustomData_sizeof(datas[i]->layers[j].type) * (size_t)totelems[i];
+		}
+	}
+
+	return mem_size;
+}
+
+/**
+ * Keep a copy of \a dm as the result of \a md for \a key,
+ * unless it was too cheap to evaluate or it would exceed the memory limit.
+ */
+static bool modifier_stack_cache_store(ModifierData *md, const uint32_t key, const bool has_key,
+                                       DerivedMesh *dm, const double time)
+{
+	ModifierStackCache *cache = md->stack_cache;
+
+	if (cache == NULL) {
+		cache = md->stack_cache = MEM_callocN(sizeof(*cache), __func__);
+	}
+
+	modifier_stack_cache_clear(cache);
+	cache->is_expensive = (time >= MODIFIER_STACK_CACHE_MIN_TIME);
+
+	if (cache->is_expensive && has_key && dm && dm->type == DM_TYPE_CDDM) {
+		const size_t mem_size = modifier_stack_cache_dm_size(dm);
+
+		if (atomic_add_z(&modifier_stack_cache_mem, mem_size) <= MODIFIER_STACK_CACHE_LIMIT) {
+			cache->dm = CDDM_copy(dm);
+			cache->mem_size = mem_size;
+			cache->key = key;
+			return true;
+		}
+		atomic_sub_z(&modifier_stack_cache_mem, mem_size);
+	}
+
+	return false;
+}
+
+/** \} */
+
 /**
  * new value for useDeform -1  (hack for the gameengine):
  *
@@ -1751,6 +1981,10 @@ static void mesh_calc_modifiers(
 	ModifierApplyFlag app_flags = useRenderParams ? MOD_APPLY_RENDER : 0;
 	ModifierApplyFlag deform_app_flags = app_flags;
 
+	/* key of the modifier stack cache for dm, when it's the unchanged result of a cached modifier */
+	uint32_t dm_key = 0;
+	bool dm_key_valid = false;
+
 
 	if (useCache)
 		app_flags |= MOD_APPLY_USECACHE;
@@ -1924,8 +2158,10 @@ static void mesh_calc_modifiers(
 		else
 			mask = 0;
 
-		if (dm && (mask & CD_MASK_ORCO))
+		if (dm && (mask & CD_MASK_ORCO)) {
 			add_orco_dm(ob, NULL, dm, orcodm, CD_ORCO);
+			dm_key_valid = false;
+		}
 
 		/* How to apply modifier depends on (a) what we already have as
 		 * a result of previous modifiers (could be a DerivedMesh or just
@@ -1973,11 +2209,10 @@ static void mesh_calc_modifiers(
 			/* apply vertex coordinates or build a DerivedMesh as necessary */
 			if (dm) {
 				if (deformedVerts) {
-					DerivedMesh *tdm = CDDM_copy(dm);
-					dm->release(dm);
-					dm = tdm;
+					dm = CDDM_copy_and_release(dm);
 
 					CDDM_apply_vert_coords(dm, deformedVerts);
+					dm_key_valid = false;
 				}
 			}
 			else {
@@ -2028,18 +2263,59 @@ static void mesh_calc_modifiers(
 			DM_set_only_copy(dm, mask | (need_mapping ? CD_MASK_ORIGINDEX : 0));
 			
 			/* add cloth rest shape key if need */
-			if (mask & CD_MASK_CLOTH_ORCO)
+			if (mask & CD_MASK_CLOTH_ORCO) {
 				add_orco_dm(ob, NULL, dm, clothorcodm, CD_CLOTH_ORCO);
+				dm_key_valid = false;
+			}
 
 			/* add an origspace layer if needed */
 			if ((curr->mask) & CD_MASK_ORIGSPACE_MLOOP) {
 				if (!CustomData_has_layer(&dm->loopData, CD_ORIGSPACE_MLOOP)) {
 					DM_add_loop_layer(dm, CD_ORIGSPACE_MLOOP, CD_CALLOC, NULL);
 					DM_init_origspace(dm);
+					dm_key_valid = false;
+				}
+			}
+
+			ndm = NULL;
+			/* render evaluation may run alongside viewport updates, keep it out of the cache */
+			if (!useRenderParams && !sculpt_mode && modifier_stack_cache_supported(ob, md)) {
+				ModifierStackCache *cache = md->stack_cache;
+				uint32_t key = 0;
+				bool has_key = false;
+
+				/* only hash the input of modifiers which were expensive last time */
+				if (cache == NULL || cache->is_expensive) {
+					uint32_t input_key = dm_key;
+
+					if (dm_key_valid || modifier_stack_cache_hash_dm(dm, &input_key)) {
+						key = modifier_stack_cache_key(ob, md, input_key,
+						                               mask | (need_mapping ? CD_MASK_ORIGINDEX : 0), app_flags);
+						has_key = true;
+					}
+				}
+
+				if (has_key && cache && cache->dm && cache->key == key) {
+					ndm = CDDM_copy(cache->dm);
+					dm_key_valid = true;
+				}
+				else {
+					const double time_start = PIL_check_seconds_timer();
+
+					ndm = modwrap_applyModifier(md, ob, dm, app_flags);
+					dm_key_valid = modifier_stack_cache_store(md, key, has_key, ndm,
+					                                          PIL_check_seconds_timer() - time_start);
 				}
+				dm_key = key;
 			}
+			else {
+				ndm = modwrap_applyModifier(md, ob, dm, app_flags);
+				dm_key_valid = false;
 
-			ndm = modwrap_applyModifier(md, ob, dm, app_flags);
+				if (!useRenderParams) {
+					DM_modifier_stack_cache_free(md);
+				}
+			}
 			ASSERT_IS_VALID_DM(ndm);
 
 			if (ndm) {
@@ -2104,6 +2380,7 @@ static void mesh_calc_modifiers(
 			else if ((md == previewmd) && (do_mod_wmcol)) {
 				DM_update_weight_mcol(ob, dm, draw_flag, NULL, 0, NULL);
 				append_mask |= CD_MASK_PREVIEW_MLOOPCOL;
+				dm_key_valid = false;
 			}
 		}
 
@@ -2126,9 +2403,7 @@ static void mesh_calc_modifiers(
 	 * DerivedMesh then we need to build one.
 	 */
 	if (dm && deformedVerts) {
-		finaldm = CDDM_copy(dm);
-
-		dm->release(dm);
+		finaldm = CDDM_copy_and_release(dm);
 
 		CDDM_apply_vert_coords(finaldm, deformedVerts);
 
@@ -2226,18 +2501,13 @@ static void mesh_calc_modifiers(
 
 float (*editbmesh_get_vertex_cos(BMEditMesh *em, int *r_numVerts))[3]
 {
-	BMIter iter;
-	BMVert *eve;
 	float (*cos)[3];
-	int i;
 
 	*r_numVerts = em->bm->totvert;
 
 	cos = MEM_mallocN(sizeof(float) * 3 * em->bm->totvert, "vertexcos");
 
-	BM_ITER_MESH_INDEX (eve, &iter, em->bm, BM_VERTS_OF_MESH, i) {
-		copy_v3_v3(cos[i], eve->co);
-	}
+	BM_mesh_vert_coords_get(em->bm, cos, NULL);
 
 	return cos;
 }
@@ -2358,11 +2628,12 @@ static void editbmesh_calc_modifiers(
 			/* apply vertex coordinates or build a DerivedMesh as necessary */
 			if (dm) {
 				if (deformedVerts) {
-					DerivedMesh *tdm = CDDM_copy(dm);
-					if (!(r_cage && dm == *r_cage)) {
-						dm->release(dm);
+					if (r_cage && dm == *r_cage) {
+						dm = CDDM_copy(dm);
+					}
+					else {
+						dm = CDDM_copy_and_release(dm);
 					}
-					dm = tdm;
 
 					CDDM_apply_vert_coords(dm, deformedVerts);
 				}
@@ -2470,10 +2741,11 @@ static void editbmesh_calc_modifiers(
 	 * then we need to build one.
 	 */
 	if (dm && deformedVerts) {
-		*r_final = CDDM_copy(dm);
-
-		if (!(r_cage && dm == *r_cage)) {
-			dm->release(dm);
+		if (r_cage && dm == *r_cage) {
+			*r_final = CDDM_copy(dm);
+		}
+		else {
+			*r_final = CDDM_copy_and_release(dm);
 		}
 
 		CDDM_apply_vert_coords(*r_final, deformedVerts);
@@ -2550,9 +2822,17 @@ static void editbmesh_calc_modifiers(
  * we'll be using GPU backend of OpenSubdiv. This is so
  * playback performance is kept as high as possible.
  */
-static bool calc_modifiers_skip_orco(const Object *ob)
+static bool calc_modifiers_skip_orco(Scene *scene, Object *ob)
 {
-	const ModifierData *last_md = ob->modifiers.last;
+	ModifierData *last_md;
+
+	/* disabled modifiers after subsurf don't keep it from running on the GPU */
+	for (last_md = ob->modifiers.last; last_md; last_md = last_md->prev) {
+		if (modifier_isEnabled(scene, last_md, eModifierMode_Realtime)) {
+			break;
+		}
+	}
+
 	if (last_md != NULL &&
 	    last_md->type == eModifierType_Subsurf)
 	{
@@ -2574,7 +2854,7 @@ static void mesh_build_data(
 	BKE_object_sculpt_modifiers_changed(ob);
 
 #ifdef WITH_OPENSUBDIV
-	if (calc_modifiers_skip_orco(ob)) {
+	if (calc_modifiers_skip_orco(scene, ob)) {
 		dataMask &= ~(CD_MASK_ORCO | CD_MASK_PREVIEW_MCOL);
 	}
 #endif
@@ -2609,7 +2889,7 @@ static void editbmesh_build_data(Scene *scene, Object *obedit, BMEditMesh *em, C
 	BKE_editmesh_free_derivedmesh(em);
 
 #ifdef WITH_OPENSUBDIV
-	if (calc_modifiers_skip_orco(obedit)) {
+	if (calc_modifiers_skip_orco(scene, obedit)) {
 		dataMask &= ~(CD_MASK_ORCO | CD_MASK_PREVIEW_MCOL);
 	}
 #endif
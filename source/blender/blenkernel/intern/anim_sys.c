@@ -43,6 +43,7 @@
 #include "BLI_alloca.h"
 #include "BLI_dynstr.h"
 #include "BLI_listbase.h"
+#include "BLI_task.h"
 
 #include "BLT_translation.h"
 
@@ -1486,125 +1487,132 @@ static bool animsys_remap_path(AnimMapper *UNUSED(remap), char *path, char **dst
 /* less than 1.0 evaluates to false, use epsilon to avoid float error */
 #define ANIMSYS_FLOAT_AS_BOOL(value) ((value) > ((1.0f - FLT_EPSILON)))
 
-/* Write the given value to a setting using RNA, and return success */
-static bool animsys_write_rna_setting(PointerRNA *ptr, char *path, int array_index, float value)
+/* Write the given value to an already resolved property (new_ptr, prop) of the path, and return success */
+static bool animsys_write_rna_property(PointerRNA *ptr, PointerRNA *new_ptr, PropertyRNA *prop,
+                                       const char *path, int array_index, float value)
 {
-	PropertyRNA *prop;
-	PointerRNA new_ptr;
-	
-	//printf("%p %s %i %f\n", ptr, path, array_index, value);
-	
-	/* get property to write to */
-	if (RNA_path_resolve_property(ptr, path, &new_ptr, &prop)) {
-		/* set value for animatable numerical values only
-		 * HACK: some local F-Curves (e.g. those on NLA Strips) are evaluated
-		 *       without an ID provided, which causes the animateable test to fail!
-		 */
-		if (RNA_property_animateable(&new_ptr, prop) || (ptr->id.data == NULL)) {
-			int array_len = RNA_property_array_length(&new_ptr, prop);
-			bool written = false;
-			
-			if (array_len && array_index >= array_len) {
-				if (G.debug & G_DEBUG) {
-					printf("Animato: Invalid array index. ID = '%s',  '%s[%d]', array length is %d\n",
-					       (ptr && ptr->id.data) ? (((ID *)ptr->id.data)->name + 2) : "<No ID>",
-					       path, array_index, array_len - 1);
-				}
-				
-				return false;
+	/* set value for animatable numerical values only
+	 * HACK: some local F-Curves (e.g. those on NLA Strips) are evaluated
+	 *       without an ID provided, which causes the animateable test to fail!
+	 */
+	if (RNA_property_animateable(new_ptr, prop) || (ptr->id.data == NULL)) {
+		int array_len = RNA_property_array_length(new_ptr, prop);
+		bool written = false;
+		
+		if (array_len && array_index >= array_len) {
+			if (G.debug & G_DEBUG) {
+				printf("Animato: Invalid array index. ID = '%s',  '%s[%d]', array length is %d\n",
+				       (ptr && ptr->id.data) ? (((ID *)ptr->id.data)->name + 2) : "<No ID>",
+				       path, array_index, array_len - 1);
 			}
 			
-			switch (RNA_property_type(prop)) {
-				case PROP_BOOLEAN:
-					if (array_len) {
-						if (RNA_property_boolean_get_index(&new_ptr, prop, array_index) != ANIMSYS_FLOAT_AS_BOOL(value)) {
-							RNA_property_boolean_set_index(&new_ptr, prop, array_index, ANIMSYS_FLOAT_AS_BOOL(value));
-							written = true;
-						}
-					}
-					else {
-						if (RNA_property_boolean_get(&new_ptr, prop) != ANIMSYS_FLOAT_AS_BOOL(value)) {
-							RNA_property_boolean_set(&new_ptr, prop, ANIMSYS_FLOAT_AS_BOOL(value));
-							written = true;
-						}
+			return false;
+		}
+		
+		switch (RNA_property_type(prop)) {
+			case PROP_BOOLEAN:
+				if (array_len) {
+					if (RNA_property_boolean_get_index(new_ptr, prop, array_index) != ANIMSYS_FLOAT_AS_BOOL(value)) {
+						RNA_property_boolean_set_index(new_ptr, prop, array_index, ANIMSYS_FLOAT_AS_BOOL(value));
+						written = true;
 					}
-					break;
-				case PROP_INT:
-					if (array_len) {
-						if (RNA_property_int_get_index(&new_ptr, prop, array_index) != (int)value) {
-							RNA_property_int_set_index(&new_ptr, prop, array_index, (int)value);
-							written = true;
-						}
+				}
+				else {
+					if (RNA_property_boolean_get(new_ptr, prop) != ANIMSYS_FLOAT_AS_BOOL(value)) {
+						RNA_property_boolean_set(new_ptr, prop, ANIMSYS_FLOAT_AS_BOOL(value));
+						written = true;
 					}
-					else {
-						if (RNA_property_int_get(&new_ptr, prop) != (int)value) {
-							RNA_property_int_set(&new_ptr, prop, (int)value);
-							written = true;
-						}
+				}
+				break;
+			case PROP_INT:
+				if (array_len) {
+					if (RNA_property_int_get_index(new_ptr, prop, array_index) != (int)value) {
+						RNA_property_int_set_index(new_ptr, prop, array_index, (int)value);
+						written = true;
 					}
-					break;
-				case PROP_FLOAT:
-					if (array_len) {
-						if (RNA_property_float_get_index(&new_ptr, prop, array_index) != value) {
-							RNA_property_float_set_index(&new_ptr, prop, array_index, value);
-							written = true;
-						}
+				}
+				else {
+					if (RNA_property_int_get(new_ptr, prop) != (int)value) {
+						RNA_property_int_set(new_ptr, prop, (int)value);
+						written = true;
 					}
-					else {
-						if (RNA_property_float_get(&new_ptr, prop) != value) {
-							RNA_property_float_set(&new_ptr, prop, value);
-							written = true;
-						}
+				}
+				break;
+			case PROP_FLOAT:
+				if (array_len) {
+					if (RNA_property_float_get_index(new_ptr, prop, array_index) != value) {
+						RNA_property_float_set_index(new_ptr, prop, array_index, value);
+						written = true;
 					}
-					break;
-				case PROP_ENUM:
-					if (RNA_property_enum_get(&new_ptr, prop) != (int)value) {
-						RNA_property_enum_set(&new_ptr, prop, (int)value);
+				}
+				else {
+					if (RNA_property_float_get(new_ptr, prop) != value) {
+						RNA_property_float_set(new_ptr, prop, value);
 						written = true;
 					}
-					break;
-				default:
-					/* nothing can be done here... so it is unsuccessful? */
-					return false;
-			}
-			
-			/* RNA property update disabled for now - [#28525] [#28690] [#28774] [#28777] */
-#if 0
-			/* buffer property update for later flushing */
-			if (written && RNA_property_update_check(prop)) {
-				short skip_updates_hack = 0;
-				
-				/* optimization hacks: skip property updates for those properties
-				 * for we know that which the updates in RNA were really just for
-				 * flushing property editing via UI/Py
-				 */
-				if (new_ptr.type == &RNA_PoseBone) {
-					/* bone transforms - update pose (i.e. tag depsgraph) */
-					skip_updates_hack = 1;
 				}
-				
-				if (skip_updates_hack == 0)
-					RNA_property_update_cache_add(&new_ptr, prop);
+				break;
+			case PROP_ENUM:
+				if (RNA_property_enum_get(new_ptr, prop) != (int)value) {
+					RNA_property_enum_set(new_ptr, prop, (int)value);
+					written = true;
+				}
+				break;
+			default:
+				/* nothing can be done here... so it is unsuccessful? */
+				return false;
+		}
+		
+		/* RNA property update disabled for now - [#28525] [#28690] [#28774] [#28777] */
+#if 0
+		/* buffer property update for later flushing */
+		if (written && RNA_property_update_check(prop)) {
+			short skip_updates_hack = 0;
+			
+			/* optimization hacks: skip property updates for those properties
+			 * for we know that which the updates in RNA were really just for
+			 * flushing property editing via UI/Py
+			 */
+			if (new_ptr->type == &RNA_PoseBone) {
+				/* bone transforms - update pose (i.e. tag depsgraph) */
+				skip_updates_hack = 1;
 			}
+			
+			if (skip_updates_hack == 0)
+				RNA_property_update_cache_add(new_ptr, prop);
+		}
 #endif
 
-			/* as long as we don't do property update, we still tag datablock
-			 * as having been updated. this flag does not cause any updates to
-			 * be run, it's for e.g. render engines to synchronize data */
-			if (written && new_ptr.id.data) {
-				ID *id = new_ptr.id.data;
-
-				/* for cases like duplifarmes it's only a temporary so don't
-				 * notify anyone of updates */
-				if (!(id->tag & LIB_TAG_ANIM_NO_RECALC)) {
-					id->tag |= LIB_TAG_ID_RECALC;
-					DAG_id_type_tag(G.main, GS(id->name));
-				}
+		/* as long as we don't do property update, we still tag datablock
+		 * as having been updated. this flag does not cause any updates to
+		 * be run, it's for e.g. render engines to synchronize data */
+		if (written && new_ptr->id.data) {
+			ID *id = new_ptr->id.data;
+
+			/* for cases like duplifarmes it's only a temporary so don't
+			 * notify anyone of updates */
+			if (!(id->tag & LIB_TAG_ANIM_NO_RECALC)) {
+				id->tag |= LIB_TAG_ID_RECALC;
+				DAG_id_type_tag(G.main, GS(id->name));
 			}
 		}
-		
-		/* successful */
-		return true;
+	}
+	
+	/* successful */
+	return true;
+}
+
+/* Write the given value to a setting using RNA, and return success */
+static bool animsys_write_rna_setting(PointerRNA *ptr, char *path, int array_index, float value)
+{
+	PropertyRNA *prop;
+	PointerRNA new_ptr;
+	
+	//printf("%p %s %i %f\n", ptr, path, array_index, value);
+	
+	/* get property to write to */
+	if (RNA_path_resolve_property(ptr, path, &new_ptr, &prop)) {
+		return animsys_write_rna_property(ptr, &new_ptr, prop, path, array_index, value);
 	}
 	else {
 		/* failed to get path */
@@ -1641,12 +1649,88 @@ bool BKE_animsys_execute_fcurve(PointerRNA *ptr, AnimMapper *remap, FCurve *fcu)
 	return ok;
 }
 
+/* F-Curves are only evaluated in parallel for large actions, for small ones the threading overhead dominates */
+#define ANIMSYS_FCURVES_THREADED_MIN 256
+
+typedef struct FCurvesEvalData {
+	FCurve **fcurves;
+	float *values;
+	float ctime;
+} FCurvesEvalData;
+
+static void animsys_fcurves_evaluate_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	FCurvesEvalData *data = userdata;
+	FCurve *fcu = data->fcurves[i];
+	
+	if (data->values)
+		data->values[i] = evaluate_fcurve(fcu, data->ctime);
+	else
+		calculate_fcurve(fcu, data->ctime);
+}
+
+/* Evaluate the unmuted F-Curves of a large list in parallel, only the evaluation itself is threaded,
+ * writing the values to RNA (or accumulating them in NLA channels) is left to the caller.
+ *
+ *	- r_values: when given, the values of the unmuted curves are returned in order (to be freed by the caller),
+ *	            otherwise each curve's curval is set like calculate_fcurve does
+ *
+ * Returns false when the curves weren't evaluated, and should be evaluated one by one instead.
+ */
+static bool animsys_fcurves_evaluate_threaded(ListBase *list, float ctime, float **r_values)
+{
+	FCurvesEvalData data;
+	FCurve *fcu;
+	int tot = 0;
+	
+	for (fcu = list->first; fcu; fcu = fcu->next) {
+		if ((fcu->flag & (FCURVE_MUTED | FCURVE_DISABLED)) || ((fcu->grp) && (fcu->grp->flag & AGRP_MUTED)))
+			continue;
+		
+		/* drivers may run Python, which can't be done from threads */
+		if (fcu->driver)
+			return false;
+		
+		tot++;
+	}
+	
+	if (tot < ANIMSYS_FCURVES_THREADED_MIN)
+		return false;
+	
+	data.fcurves = MEM_mallocN(sizeof(*data.fcurves) * tot, __func__);
+	data.values = r_values ? MEM_mallocN(sizeof(*data.values) * tot, __func__) : NULL;
+	data.ctime = ctime;
+	
+	tot = 0;
+	for (fcu = list->first; fcu; fcu = fcu->next) {
+		if ((fcu->flag & (FCURVE_MUTED | FCURVE_DISABLED)) || ((fcu->grp) && (fcu->grp->flag & AGRP_MUTED)))
+			continue;
+		
+		data.fcurves[tot++] = fcu;
+	}
+	
+	BLI_task_parallel_range_ex(0, tot, &data, NULL, 0, animsys_fcurves_evaluate_cb, true, false);
+	
+	MEM_freeN(data.fcurves);
+	if (r_values)
+		*r_values = data.values;
+	
+	return true;
+}
+
 /* Evaluate all the F-Curves in the given list 
  * This performs a set of standard checks. If extra checks are required, separate code should be used
  */
 static void animsys_evaluate_fcurves(PointerRNA *ptr, ListBase *list, AnimMapper *remap, float ctime)
 {
 	FCurve *fcu;
+	/* the curves of one array property (e.g. the location channels of a bone) usually follow each other,
+	 * so the last resolved path is reused for them instead of parsing and resolving it again */
+	const char *path_prev = NULL;
+	PointerRNA ptr_prev;
+	PropertyRNA *prop_prev = NULL;
+	/* large actions are calculated in parallel first, then written one by one */
+	const bool is_calculated = animsys_fcurves_evaluate_threaded(list, ctime, NULL);
 	
 	/* calculate then execute each curve */
 	for (fcu = list->first; fcu; fcu = fcu->next) {
@@ -1654,8 +1738,32 @@ static void animsys_evaluate_fcurves(PointerRNA *ptr, ListBase *list, AnimMapper
 		if ((fcu->grp == NULL) || (fcu->grp->flag & AGRP_MUTED) == 0) {
 			/* check if this curve should be skipped */
 			if ((fcu->flag & (FCURVE_MUTED | FCURVE_DISABLED)) == 0) {
-				calculate_fcurve(fcu, ctime);
-				BKE_animsys_execute_fcurve(ptr, remap, fcu); 
+				char *path = NULL;
+				const bool free_path = animsys_remap_path(remap, fcu->rna_path, &path);
+				
+				if (!is_calculated)
+					calculate_fcurve(fcu, ctime);
+				
+				if (path == NULL) {
+					/* pass */
+				}
+				else if (free_path) {
+					animsys_write_rna_setting(ptr, path, fcu->array_index, fcu->curval);
+					MEM_freeN(path);
+				}
+				else {
+					if ((path_prev == NULL) || !STREQ(path, path_prev)) {
+						path_prev = RNA_path_resolve_property(ptr, path, &ptr_prev, &prop_prev) ? path : NULL;
+					}
+					
+					if (path_prev) {
+						animsys_write_rna_property(ptr, &ptr_prev, prop_prev, path, fcu->array_index, fcu->curval);
+					}
+					else {
+						/* reports the invalid path */
+						animsys_write_rna_setting(ptr, path, fcu->array_index, fcu->curval);
+					}
+				}
 			}
 		}
 	}
@@ -2214,6 +2322,8 @@ static void nlastrip_evaluate_actionclip(PointerRNA *ptr, ListBase *channels, Li
 	ListBase tmp_modifiers = {NULL, NULL};
 	NlaStrip *strip = nes->strip;
 	FCurve *fcu;
+	float *values = NULL;
+	int i = 0;
 	float evaltime;
 	
 	/* sanity checks for action */
@@ -2234,6 +2344,9 @@ static void nlastrip_evaluate_actionclip(PointerRNA *ptr, ListBase *channels, Li
 	storage = evaluate_fmodifiers_storage_new(&tmp_modifiers);
 	evaltime = evaluate_time_fmodifiers(storage, &tmp_modifiers, NULL, 0.0f, strip->strip_time);
 	
+	/* the curves of large actions are evaluated in parallel first, the loop below only accumulates them */
+	animsys_fcurves_evaluate_threaded(&strip->act->curves, evaltime, &values);
+	
 	/* evaluate all the F-Curves in the action, saving the relevant pointers to data that will need to be used */
 	for (fcu = strip->act->curves.first; fcu; fcu = fcu->next) {
 		NlaEvalChannel *nec;
@@ -2249,7 +2362,7 @@ static void nlastrip_evaluate_actionclip(PointerRNA *ptr, ListBase *channels, Li
 		/* evaluate the F-Curve's value for the time given in the strip 
 		 * NOTE: we use the modified time here, since strip's F-Curve Modifiers are applied on top of this 
 		 */
-		value = evaluate_fcurve(fcu, evaltime);
+		value = values ? values[i++] : evaluate_fcurve(fcu, evaltime);
 		
 		/* apply strip's F-Curve Modifiers on this value 
 		 * NOTE: we apply the strip's original evaluation time not the modified one (as per standard F-Curve eval)
@@ -2266,6 +2379,8 @@ static void nlastrip_evaluate_actionclip(PointerRNA *ptr, ListBase *channels, Li
 	}
 
 	/* free temporary storage */
+	if (values)
+		MEM_freeN(values);
 	evaluate_fmodifiers_storage_free(storage);
 
 	/* unlink this strip's modifiers from the parent's modifiers again */
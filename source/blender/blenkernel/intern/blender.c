@@ -73,6 +73,7 @@
 #include "BKE_ipo.h"
 #include "BKE_library.h"
 #include "BKE_main.h"
+#include "BKE_mesh.h"
 #include "BKE_node.h"
 #include "BKE_report.h"
 #include "BKE_scene.h"
@@ -127,6 +128,7 @@ void free_blender(void)
 
 	BKE_sequencer_cache_destruct();
 	IMB_moviecache_destruct();
+	BKE_mesh_normals_loop_split_cache_free();
 	
 	free_nodesystem();
 }
@@ -887,8 +889,6 @@ const char *BKE_undo_get_name(int nr, bool *r_active)
 bool BKE_undo_save_file(const char *filename)
 {
 	UndoElem *uel;
-	MemFileChunk *chunk;
-	int file, oflags;
 
 	if ((U.uiflag & USER_GLOBALUNDO) == 0) {
 		return false;
@@ -900,42 +900,7 @@ bool BKE_undo_save_file(const char *filename)
 		return false;
 	}
 
-	/* note: This is currently used for autosave and 'quit.blend', where _not_ following symlinks is OK,
-	 * however if this is ever executed explicitly by the user, we may want to allow writing to symlinks.
-	 */
-
-	oflags = O_BINARY | O_WRONLY | O_CREAT | O_TRUNC;
-#ifdef O_NOFOLLOW
-	/* use O_NOFOLLOW to avoid writing to a symlink - use 'O_EXCL' (CVE-2008-1103) */
-	oflags |= O_NOFOLLOW;
-#else
-	/* TODO(sergey): How to deal with symlinks on windows? */
-#  ifndef _MSC_VER
-#    warning "Symbolic links will be followed on undo save, possibly causing CVE-2008-1103"
-#  endif
-#endif
-	file = BLI_open(filename,  oflags, 0666);
-
-	if (file == -1) {
-		fprintf(stderr, "Unable to save '%s': %s\n",
-		        filename, errno ? strerror(errno) : "Unknown error opening file");
-		return false;
-	}
-
-	for (chunk = uel->memfile.chunks.first; chunk; chunk = chunk->next) {
-		if (write(file, chunk->buf, chunk->size) != chunk->size) {
-			break;
-		}
-	}
-	
-	close(file);
-	
-	if (chunk) {
-		fprintf(stderr, "Unable to save '%s': %s\n",
-		        filename, errno ? strerror(errno) : "Unknown error writing file");
-		return false;
-	}
-	return true;
+	return BLO_memfile_write_file(&uel->memfile, filename);
 }
 
 /* sets curscene */
@@ -40,6 +40,7 @@
 #include "BLI_stackdefines.h"
 
 #include "BKE_pbvh.h"
+#include "BKE_bvhutils.h"
 #include "BKE_cdderivedmesh.h"
 #include "BKE_global.h"
 #include "BKE_mesh.h"
@@ -2433,6 +2434,43 @@ DerivedMesh *CDDM_copy_from_tessface(DerivedMesh *source)
 	return cddm_copy_ex(source, 1);
 }
 
+/**
+ * Use in place of #CDDM_copy when \a source is released right after.
+ *
+ * A #CDDerivedMesh owned by the caller is returned as is, only dropping the layers
+ * #CDDM_copy would leave out, so the layers nobody writes to aren't duplicated.
+ * Layers referencing other data (such as the original mesh) stay shared,
+ * they are only duplicated once something writes to them (see #CustomData_duplicate_referenced_layer).
+ */
+DerivedMesh *CDDM_copy_and_release(DerivedMesh *source)
+{
+	DerivedMesh *dm;
+
+	if (source->type == DM_TYPE_CDDM && source->needsFree && ((CDDerivedMesh *)source)->pbvh == NULL) {
+		dm = source;
+
+		CustomData_free_layers_nocopy(&dm->vertData, CD_MASK_DERIVEDMESH | CD_MASK_MVERT, dm->numVertData);
+		CustomData_free_layers_nocopy(&dm->edgeData, CD_MASK_DERIVEDMESH | CD_MASK_MEDGE, dm->numEdgeData);
+		CustomData_free_layers_nocopy(&dm->faceData, CD_MASK_DERIVEDMESH | CD_MASK_MFACE, dm->numTessFaceData);
+		CustomData_free_layers_nocopy(&dm->loopData, CD_MASK_DERIVEDMESH | CD_MASK_MLOOP, dm->numLoopData);
+		CustomData_free_layers_nocopy(&dm->polyData, CD_MASK_DERIVEDMESH | CD_MASK_MPOLY, dm->numPolyData);
+
+		/* the caller is about to change the mesh, like a copy nothing derived from it is kept */
+		bvhcache_free(&dm->bvhCache);
+		bvhcache_init(&dm->bvhCache);
+		GPU_drawobject_free(dm);
+		MEM_SAFE_FREE(dm->looptris.array);
+		dm->looptris.num = 0;
+		dm->looptris.num_alloc = 0;
+	}
+	else {
+		dm = CDDM_copy(source);
+		source->release(source);
+	}
+
+	return dm;
+}
+
 /* note, the CD_ORIGINDEX layers are all 0, so if there is a direct
  * relationship between mesh data this needs to be set by the caller. */
 DerivedMesh *CDDM_from_template_ex(
@@ -45,6 +45,7 @@
 #include "DNA_ID.h"
 
 #include "BLI_utildefines.h"
+#include "BLI_alloca.h"
 #include "BLI_string.h"
 #include "BLI_path_util.h"
 #include "BLI_math.h"
@@ -2155,6 +2156,43 @@ void CustomData_free_temporary(CustomData *data, int totelem)
 	}
 }
 
+/**
+ * Free the layers #CustomData_copy would leave out with \a mask,
+ * for when \a data is kept in place of a copy of it.
+ * Since #CustomData_set_only_copy works on types, only whole types are removed.
+ */
+void CustomData_free_layers_nocopy(CustomData *data, CustomDataMask mask, int totelem)
+{
+	CustomDataLayer *layer;
+	int i, j;
+	bool changed = false;
+
+	for (i = 0, j = 0; i < data->totlayer; ++i) {
+		layer = &data->layers[i];
+
+		if (i != j)
+			data->layers[j] = data->layers[i];
+
+		if ((layer->flag & CD_FLAG_NOCOPY) || !(mask & CD_TYPE_AS_MASK(layer->type))) {
+			customData_free_layer__internal(layer, totelem);
+			changed = true;
+		}
+		else
+			j++;
+	}
+
+	data->totlayer = j;
+
+	if (data->totlayer <= data->maxlayer - CUSTOMDATA_GROW) {
+		customData_resize(data, -CUSTOMDATA_GROW);
+		changed = true;
+	}
+
+	if (changed) {
+		customData_update_offsets(data);
+	}
+}
+
 void CustomData_set_only_copy(const struct CustomData *data,
                               CustomDataMask mask)
 {
@@ -2812,9 +2850,9 @@ void CustomData_bmesh_free_block_data(CustomData *data, void *block)
 		memset(block, 0, data->totsize);
 }
 
-static void CustomData_bmesh_alloc_block(CustomData *data, void **block)
+/* the block data is left uninitialized, the allocation isn't thread safe */
+void CustomData_bmesh_alloc_block(CustomData *data, void **block)
 {
-
 	if (*block)
 		CustomData_bmesh_free_block(data, block);
 
@@ -3146,6 +3184,223 @@ void CustomData_bmesh_interp(
 	if (count > SOURCE_BUF_SIZE) MEM_freeN((void *)sources);
 }
 
+/* -------------------------------------------------------------------- */
+/* Batched interpolation
+ *
+ * Interpolates many destination blocks from the same sources, one layer at a time.
+ * The common layer types read their sources into arrays once, so the weighted sums
+ * for each destination are plain loops over contiguous floats. */
+
+typedef void (*cd_interp_array)(
+        const void **sources, const float *weights, int count,
+        void **dst_blocks, int dst_num, int offset);
+
+static void layerInterpArray_mloopuv(
+        const void **sources, const float *weights, int count,
+        void **dst_blocks, int dst_num, int offset)
+{
+	float *src_u = BLI_array_alloca(src_u, count);
+	float *src_v = BLI_array_alloca(src_v, count);
+	int *src_flag = BLI_array_alloca(src_flag, count);
+	int i, d;
+
+	for (i = 0; i < count; i++) {
+		const MLoopUV *src = sources[i];
+		src_u[i] = src->uv[0];
+		src_v[i] = src->uv[1];
+		src_flag[i] = src->flag;
+	}
+
+	for (d = 0; d < dst_num; d++, weights += count) {
+		MLoopUV *dst = POINTER_OFFSET(dst_blocks[d], offset);
+		float u = 0.0f, v = 0.0f;
+		int flag = 0;
+
+		for (i = 0; i < count; i++) {
+			u += src_u[i] * weights[i];
+			v += src_v[i] * weights[i];
+		}
+		for (i = 0; i < count; i++) {
+			if (weights[i] > 0.0f) {
+				flag |= src_flag[i];
+			}
+		}
+
+		dst->uv[0] = u;
+		dst->uv[1] = v;
+		dst->flag = flag;
+	}
+}
+
+static void layerInterpArray_mloopcol(
+        const void **sources, const float *weights, int count,
+        void **dst_blocks, int dst_num, int offset)
+{
+	float (*src_col)[4] = BLI_array_alloca(src_col, count);
+	int i, d;
+
+	for (i = 0; i < count; i++) {
+		const MLoopCol *src = sources[i];
+		src_col[i][0] = src->r;
+		src_col[i][1] = src->g;
+		src_col[i][2] = src->b;
+		src_col[i][3] = src->a;
+	}
+
+	for (d = 0; d < dst_num; d++, weights += count) {
+		MLoopCol *dst = POINTER_OFFSET(dst_blocks[d], offset);
+		float col[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+		for (i = 0; i < count; i++) {
+			madd_v4_v4fl(col, src_col[i], weights[i]);
+		}
+
+		/* same clamping as layerInterp_mloopcol */
+		CLAMP4(col, 0.0f, 255.0f);
+
+		dst->r = (int)col[0];
+		dst->g = (int)col[1];
+		dst->b = (int)col[2];
+		dst->a = (int)col[3];
+	}
+}
+
+static void layerInterpArray_float(
+        const void **sources, const float *weights, int count,
+        void **dst_blocks, int dst_num, int offset)
+{
+	float *src_f = BLI_array_alloca(src_f, count);
+	int i, d;
+
+	for (i = 0; i < count; i++) {
+		src_f[i] = *(const float *)sources[i];
+	}
+
+	for (d = 0; d < dst_num; d++, weights += count) {
+		float f = 0.0f;
+
+		for (i = 0; i < count; i++) {
+			f += src_f[i] * weights[i];
+		}
+
+		*(float *)POINTER_OFFSET(dst_blocks[d], offset) = f;
+	}
+}
+
+static void layerInterpArray_float3(
+        const void **sources, const float *weights, int count,
+        void **dst_blocks, int dst_num, int offset, const bool do_normalize)
+{
+	float *src_x = BLI_array_alloca(src_x, count);
+	float *src_y = BLI_array_alloca(src_y, count);
+	float *src_z = BLI_array_alloca(src_z, count);
+	int i, d;
+
+	for (i = 0; i < count; i++) {
+		const float *src = sources[i];
+		src_x[i] = src[0];
+		src_y[i] = src[1];
+		src_z[i] = src[2];
+	}
+
+	for (d = 0; d < dst_num; d++, weights += count) {
+		float *dst = POINTER_OFFSET(dst_blocks[d], offset);
+		float co[3] = {0.0f, 0.0f, 0.0f};
+
+		for (i = 0; i < count; i++) {
+			co[0] += src_x[i] * weights[i];
+			co[1] += src_y[i] * weights[i];
+			co[2] += src_z[i] * weights[i];
+		}
+
+		if (do_normalize) {
+			normalize_v3_v3(dst, co);
+		}
+		else {
+			copy_v3_v3(dst, co);
+		}
+	}
+}
+
+static void layerInterpArray_shapekey(
+        const void **sources, const float *weights, int count,
+        void **dst_blocks, int dst_num, int offset)
+{
+	layerInterpArray_float3(sources, weights, count, dst_blocks, dst_num, offset, false);
+}
+
+static void layerInterpArray_normal(
+        const void **sources, const float *weights, int count,
+        void **dst_blocks, int dst_num, int offset)
+{
+	layerInterpArray_float3(sources, weights, count, dst_blocks, dst_num, offset, true);
+}
+
+static cd_interp_array layerInterpArray_get(int type)
+{
+	switch (type) {
+		case CD_MLOOPUV:
+			return layerInterpArray_mloopuv;
+		case CD_MLOOPCOL:
+		case CD_PREVIEW_MLOOPCOL:
+			return layerInterpArray_mloopcol;
+		case CD_SHAPEKEY:
+			return layerInterpArray_shapekey;
+		case CD_NORMAL:
+			return layerInterpArray_normal;
+		case CD_BWEIGHT:
+		case CD_CREASE:
+			return layerInterpArray_float;
+		default:
+			return NULL;
+	}
+}
+
+/**
+ * Interpolate \a dst_num blocks from the same \a count source blocks,
+ * the same as calling #CustomData_bmesh_interp for each of them without sub-weights.
+ *
+ * \param weights: \a count weights for each destination, one after another.
+ * \note Batched layer types read all sources before writing, others write the destinations one at a time,
+ * which only matters when destination blocks are among the sources.
+ */
+void CustomData_bmesh_interp_array(
+        CustomData *data, const void **src_blocks,
+        const float *weights, int count,
+        void **dst_blocks, int dst_num)
+{
+	int i, j, d;
+	void *source_buf[SOURCE_BUF_SIZE];
+	const void **sources = (const void **)source_buf;
+
+	if (count > SOURCE_BUF_SIZE)
+		sources = MEM_mallocN(sizeof(*sources) * count, __func__);
+
+	for (i = 0; i < data->totlayer; ++i) {
+		CustomDataLayer *layer = &data->layers[i];
+		const LayerTypeInfo *typeInfo = layerType_getInfo(layer->type);
+		if (typeInfo->interp) {
+			const cd_interp_array interp_array = layerInterpArray_get(layer->type);
+
+			for (j = 0; j < count; ++j) {
+				sources[j] = POINTER_OFFSET(src_blocks[j], layer->offset);
+			}
+
+			if (interp_array) {
+				interp_array(sources, weights, count, dst_blocks, dst_num, layer->offset);
+			}
+			else {
+				for (d = 0; d < dst_num; d++) {
+					typeInfo->interp(sources, &weights[d * count], NULL, count,
+					                 POINTER_OFFSET(dst_blocks[d], layer->offset));
+				}
+			}
+		}
+	}
+
+	if (count > SOURCE_BUF_SIZE) MEM_freeN((void *)sources);
+}
+
 static void CustomData_bmesh_set_default_n(CustomData *data, void **block, int n)
 {
 	const LayerTypeInfo *typeInfo;
@@ -45,6 +45,7 @@
 #include "BLI_memarena.h"
 #include "BLI_math.h"
 #include "BLI_scanfill.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_global.h"
@@ -63,6 +64,9 @@
 
 #include "BLI_sys_types.h" // for intptr_t support
 
+/* minimum number of vertices in a bevel sweep before it's worth threading */
+#define BEVEL_SWEEP_THREADED_MIN 4096
+
 static void boundbox_displist_object(Object *ob);
 
 void BKE_displist_elem_free(DispList *dl)
@@ -1287,59 +1291,103 @@ void BKE_displist_make_surf(Scene *scene, Object *ob, ListBase *dispbase,
 static void rotateBevelPiece(Curve *cu, BevPoint *bevp, BevPoint *nbevp, DispList *dlb, float bev_blend, float widfac, float fac, float **r_data)
 {
 	float *fp, *data = *r_data;
+	float co[3];
 	int b;
 
+	/* the position and orientation are the same for every vertex of the piece,
+	 * so interpolate them once and only transform the bevel profile per vertex */
+	if (nbevp == NULL) {
+		copy_v3_v3(co, bevp->vec);
+	}
+	else {
+		interp_v3_v3v3(co, bevp->vec, nbevp->vec, bev_blend);
+	}
+
 	fp = dlb->verts;
-	for (b = 0; b < dlb->nr; b++, fp += 3, data += 3) {
-		if (cu->flag & CU_3D) {
-			float vec[3], quat[4];
 
-			vec[0] = fp[1] + widfac;
-			vec[1] = fp[2];
-			vec[2] = 0.0;
+	if (cu->flag & CU_3D) {
+		float quat[4], mat[3][3];
 
-			if (nbevp == NULL) {
-				copy_v3_v3(data, bevp->vec);
-				copy_qt_qt(quat, bevp->quat);
-			}
-			else {
-				interp_v3_v3v3(data, bevp->vec, nbevp->vec, bev_blend);
-				interp_qt_qtqt(quat, bevp->quat, nbevp->quat, bev_blend);
-			}
+		if (nbevp == NULL) {
+			copy_qt_qt(quat, bevp->quat);
+		}
+		else {
+			interp_qt_qtqt(quat, bevp->quat, nbevp->quat, bev_blend);
+		}
 
-			mul_qt_v3(quat, vec);
+		quat_to_mat3(mat, quat);
+		mul_m3_fl(mat, fac);
 
-			data[0] += fac * vec[0];
-			data[1] += fac * vec[1];
-			data[2] += fac * vec[2];
+		/* the profile lies in the XY plane, so the third column is never needed */
+		for (b = 0; b < dlb->nr; b++, fp += 3, data += 3) {
+			const float x = fp[1] + widfac;
+			const float y = fp[2];
+
+			data[0] = co[0] + mat[0][0] * x + mat[1][0] * y;
+			data[1] = co[1] + mat[0][1] * x + mat[1][1] * y;
+			data[2] = co[2] + mat[0][2] * x + mat[1][2] * y;
 		}
-		else {
-			float sina, cosa;
+	}
+	else {
+		float sina, cosa;
 
-			if (nbevp == NULL) {
-				copy_v3_v3(data, bevp->vec);
-				sina = bevp->sina;
-				cosa = bevp->cosa;
-			}
-			else {
-				interp_v3_v3v3(data, bevp->vec, nbevp->vec, bev_blend);
+		if (nbevp == NULL) {
+			sina = bevp->sina;
+			cosa = bevp->cosa;
+		}
+		else {
+			/* perhaps we need to interpolate angles instead. but the thing is
+			 * cosa and sina are not actually sine and cosine
+			 */
+			sina = nbevp->sina * bev_blend + bevp->sina * (1.0f - bev_blend);
+			cosa = nbevp->cosa * bev_blend + bevp->cosa * (1.0f - bev_blend);
+		}
 
-				/* perhaps we need to interpolate angles instead. but the thing is
-				 * cosa and sina are not actually sine and cosine
-				 */
-				sina = nbevp->sina * bev_blend + bevp->sina * (1.0f - bev_blend);
-				cosa = nbevp->cosa * bev_blend + bevp->cosa * (1.0f - bev_blend);
-			}
+		sina *= fac;
+		cosa *= fac;
 
-			data[0] += fac * (widfac + fp[1]) * sina;
-			data[1] += fac * (widfac + fp[1]) * cosa;
-			data[2] += fac * fp[2];
+		for (b = 0; b < dlb->nr; b++, fp += 3, data += 3) {
+			data[0] = co[0] + (widfac + fp[1]) * sina;
+			data[1] = co[1] + (widfac + fp[1]) * cosa;
+			data[2] = co[2] + fac * fp[2];
 		}
 	}
 
 	*r_data = data;
 }
 
+typedef struct BevelSweepData {
+	Curve *cu;
+	BevList *bl;
+	DispList *dlb;
+	float *verts;
+	const float *facs;
+	float widfac;
+	float firstblend, lastblend;
+	int start, steps;
+} BevelSweepData;
+
+static void bevel_sweep_cb(void *userdata, void *UNUSED(userdata_chunk), int a)
+{
+	BevelSweepData *data = userdata;
+	BevList *bl = data->bl;
+	BevPoint *bevp_first = bl->bevpoints;
+	BevPoint *bevp_last = &bl->bevpoints[bl->nr - 1];
+	BevPoint *bevp = &bl->bevpoints[data->start + a];
+	float *verts = data->verts + 3 * data->dlb->nr * a;
+
+	/* rotate bevel piece and write in data */
+	if ((a == 0) && (bevp != bevp_last)) {
+		rotateBevelPiece(data->cu, bevp, bevp + 1, data->dlb, 1.0f - data->firstblend, data->widfac, data->facs[a], &verts);
+	}
+	else if ((a == data->steps - 1) && (bevp != bevp_first)) {
+		rotateBevelPiece(data->cu, bevp, bevp - 1, data->dlb, 1.0f - data->lastblend, data->widfac, data->facs[a], &verts);
+	}
+	else {
+		rotateBevelPiece(data->cu, bevp, NULL, data->dlb, 0.0f, data->widfac, data->facs[a], &verts);
+	}
+}
+
 static void fillBevelCap(Nurb *nu, DispList *dlb, float *prev_fp, ListBase *dispbase)
 {
 	DispList *dl;
@@ -1600,7 +1648,9 @@ static void do_makeDispListCurveTypes(Scene *scene, Object *ob, ListBase *dispba
 						float bottom_no[3] = {0.0f};
 						float top_no[3] = {0.0f};
 						float firstblend = 0.0f, lastblend = 0.0f;
-						int i, start, steps = 0;
+						BevelSweepData sweep;
+						float *facs;
+						int i, start = 0, steps = 0;
 
 						if (nu->flagu & CU_NURB_CYCLIC) {
 							calc_bevfac_mapping_default(bl,
@@ -1614,13 +1664,23 @@ static void do_makeDispListCurveTypes(Scene *scene, Object *ob, ListBase *dispba
 							calc_bevfac_mapping(cu, bl, nu, &start, &firstblend, &steps, &lastblend);
 						}
 
+						facs = MEM_mallocN(sizeof(*facs) * max_ii(steps, 1), "bevel sweep facs");
+
+						sweep.cu = cu;
+						sweep.bl = bl;
+						sweep.facs = facs;
+						sweep.widfac = widfac;
+						sweep.firstblend = firstblend;
+						sweep.lastblend = lastblend;
+						sweep.start = start;
+						sweep.steps = steps;
+
 						for (dlb = dlbev.first; dlb; dlb = dlb->next) {
-							BevPoint *bevp_first, *bevp_last;
 							BevPoint *bevp;
 
 							/* for each part of the bevel use a separate displblock */
 							dl = MEM_callocN(sizeof(DispList), "makeDispListbev1");
-							dl->verts = data = MEM_mallocN(sizeof(float[3]) * dlb->nr * steps, "dlverts");
+							dl->verts = MEM_mallocN(sizeof(float[3]) * dlb->nr * steps, "dlverts");
 							BLI_addtail(dispbase, dl);
 
 							dl->type = DL_SURF;
@@ -1645,13 +1705,14 @@ static void do_makeDispListCurveTypes(Scene *scene, Object *ob, ListBase *dispba
 							dl->bevelSplitFlag = MEM_callocN(sizeof(*dl->bevelSplitFlag) * ((steps + 0x1F) >> 5),
 							                                 "bevelSplitFlag");
 
-							/* for each point of poly make a bevel piece */
-							bevp_first =  bl->bevpoints;
-							bevp_last  = &bl->bevpoints[bl->nr - 1];
-							bevp       = &bl->bevpoints[start];
+							/* for each point of poly make a bevel piece,
+							 * the taper is evaluated up front since it may touch other objects */
+							sweep.dlb = dlb;
+							sweep.verts = dl->verts;
+
+							bevp = &bl->bevpoints[start];
 							for (i = start, a = 0; a < steps; i++, bevp++, a++) {
 								float fac = 1.0;
-								float *cur_data = data;
 
 								if (cu->taperobj == NULL) {
 									fac = bevp->radius;
@@ -1682,37 +1743,31 @@ static void do_makeDispListCurveTypes(Scene *scene, Object *ob, ListBase *dispba
 									fac = displist_calc_taper(scene, cu->taperobj, taper_fac);
 								}
 
+								facs[a] = fac;
+
 								if (bevp->split_tag) {
 									dl->bevelSplitFlag[a >> 5] |= 1 << (a & 0x1F);
 								}
+							}
 
-								/* rotate bevel piece and write in data */
-								if ((a == 0) && (bevp != bevp_last)) {
-									rotateBevelPiece(cu, bevp, bevp + 1, dlb, 1.0f - firstblend, widfac, fac, &data);
-								}
-								else if ((a == steps - 1) && (bevp != bevp_first) ) {
-									rotateBevelPiece(cu, bevp, bevp - 1, dlb, 1.0f - lastblend, widfac, fac, &data);
-								}
-								else {
-									rotateBevelPiece(cu, bevp, NULL, dlb, 0.0f, widfac, fac, &data);
-								}
+							BLI_task_parallel_range_ex(0, steps, &sweep, NULL, 0, bevel_sweep_cb,
+							                           steps * dlb->nr >= BEVEL_SWEEP_THREADED_MIN, false);
 
-								if (cu->bevobj && (cu->flag & CU_FILL_CAPS) && !(nu->flagu & CU_NURB_CYCLIC)) {
-									if (a == 1) {
-										fillBevelCap(nu, dlb, cur_data - 3 * dlb->nr, &bottom_capbase);
-										negate_v3_v3(bottom_no, bevp->dir);
-									}
-									if (a == steps - 1) {
-										fillBevelCap(nu, dlb, cur_data, &top_capbase);
-										copy_v3_v3(top_no, bevp->dir);
-									}
+							if (cu->bevobj && (cu->flag & CU_FILL_CAPS) && !(nu->flagu & CU_NURB_CYCLIC) && steps > 0) {
+								if (steps > 1) {
+									fillBevelCap(nu, dlb, dl->verts, &bottom_capbase);
+									negate_v3_v3(bottom_no, bl->bevpoints[start + 1].dir);
 								}
+								fillBevelCap(nu, dlb, dl->verts + 3 * dlb->nr * (steps - 1), &top_capbase);
+								copy_v3_v3(top_no, bl->bevpoints[start + steps - 1].dir);
 							}
 
 							/* gl array drawing: using indices */
 							displist_surf_indices(dl);
 						}
 
+						MEM_freeN(facs);
+
 						if (bottom_capbase.first) {
 							BKE_displist_fill(&bottom_capbase, dispbase, bottom_no, false);
 							BKE_displist_fill(&top_capbase, dispbase, top_no, false);
@@ -4424,7 +4424,7 @@ static void dynamicPaint_doWaveStep(DynamicPaintSurface *surface, float timescal
 	float dt, min_dist, damp_factor;
 	float wave_speed = surface->wave_speed;
 	float wave_max_slope = (surface->wave_smoothness >= 0.01f) ? (0.5f / surface->wave_smoothness) : 0.0f;
-	double average_dist = 0.0f;
+	double average_dist;
 	const float canvas_size = getSurfaceDimension(sData);
 	float wave_scale = CANVAS_REL_SIZE / canvas_size;
 
@@ -4432,16 +4432,8 @@ static void dynamicPaint_doWaveStep(DynamicPaintSurface *surface, float timescal
 	PaintWavePoint *prevPoint = MEM_mallocN(sData->total_points * sizeof(PaintWavePoint), "Temp previous points for wave simulation");
 	if (!prevPoint) return;
 
-	/* calculate average neigh distance (single thread) */
-	for (index = 0; index < sData->total_points; index++) {
-		int i;
-		int numOfNeighs = sData->adj_data->n_num[index];
-
-		for (i = 0; i < numOfNeighs; i++) {
-			average_dist += bNeighs[sData->adj_data->n_index[index] + i].dist;
-		}
-	}
-	average_dist  *= wave_scale / sData->adj_data->total_targets;
+	/* average neigh distance is already calculated along with bNeighs */
+	average_dist = sData->bData->average_dist * wave_scale;
 
 	/* determine number of required steps */
 	steps = (int)ceil((WAVE_TIME_FAC * timescale * surface->wave_timescale) / (average_dist / wave_speed / 3));
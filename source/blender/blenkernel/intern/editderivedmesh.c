@@ -1936,9 +1936,7 @@ static void emDM_getVertCos(DerivedMesh *dm, float (*r_cos)[3])
 		}
 	}
 	else {
-		BM_ITER_MESH_INDEX (eve, &iter, bm, BM_VERTS_OF_MESH, i) {
-			copy_v3_v3(r_cos[i], eve->co);
-		}
+		BM_mesh_vert_coords_get(bm, r_cos, NULL);
 	}
 }
 
@@ -258,6 +258,7 @@ void pdEndEffectors(ListBase **effectors)
 		for (; eff; eff=eff->next) {
 			if (eff->guide_data)
 				MEM_freeN(eff->guide_data);
+			free_collider_cache(&eff->colliders);
 		}
 
 		BLI_freelistN(*effectors);
@@ -295,6 +296,13 @@ static void precalculate_effector(EffectorCache *eff)
 	else if (eff->psys)
 		psys_update_particle_tree(eff->psys, eff->scene->r.cfra);
 
+	/* collect the colliders once, instead of for every effected point */
+	free_collider_cache(&eff->colliders);
+	if (eff->pd->flag & PFIELD_VISIBILITY)
+		eff->colliders = get_collider_cache(eff->scene, eff->ob, NULL);
+
+	eff->scene_color_manage = BKE_scene_check_color_management_enabled(eff->scene);
+
 	/* Store object velocity */
 	if (eff->ob) {
 		float old_vel[3];
@@ -402,7 +410,7 @@ static float eff_calc_visibility(ListBase *colliders, EffectorCache *eff, Effect
 		return visibility;
 
 	if (!colls)
-		colls = get_collider_cache(eff->scene, eff->ob, NULL);
+		colls = eff->colliders;
 
 	if (!colls)
 		return visibility;
@@ -439,9 +447,6 @@ static float eff_calc_visibility(ListBase *colliders, EffectorCache *eff, Effect
 		}
 	}
 
-	if (!colliders)
-		free_collider_cache(&colls);
-	
 	return visibility;
 }
 
@@ -735,7 +740,7 @@ static void do_texture_effector(EffectorCache *eff, EffectorData *efd, EffectedP
 	float nabla = eff->pd->tex_nabla;
 	int hasrgb;
 	short mode = eff->pd->tex_mode;
-	bool scene_color_manage;
+	const bool scene_color_manage = eff->scene_color_manage;
 
 	if (!eff->pd->tex)
 		return;
@@ -755,8 +760,6 @@ static void do_texture_effector(EffectorCache *eff, EffectorData *efd, EffectedP
 		mul_m4_v3(eff->ob->imat, tex_co);
 	}
 
-	scene_color_manage = BKE_scene_check_color_management_enabled(eff->scene);
-
 	hasrgb = multitex_ext(eff->pd->tex, tex_co, NULL, NULL, 0, result, NULL, scene_color_manage, false);
 
 	if (hasrgb && mode==PFIELD_TEX_RGB) {
@@ -901,9 +904,16 @@ static void do_physical_effector(EffectorCache *eff, EffectorData *efd, Effected
 			else {
 				add_v3_v3v3(temp, efd->vec_to_point2, efd->nor2);
 			}
-			force[0] = -1.0f + 2.0f * BLI_gTurbulence(pd->f_size, temp[0], temp[1], temp[2], 2, 0, 2);
-			force[1] = -1.0f + 2.0f * BLI_gTurbulence(pd->f_size, temp[1], temp[2], temp[0], 2, 0, 2);
-			force[2] = -1.0f + 2.0f * BLI_gTurbulence(pd->f_size, temp[2], temp[0], temp[1], 2, 0, 2);
+			{
+				const float turb_co[3][3] = {
+				    {temp[0], temp[1], temp[2]},
+				    {temp[1], temp[2], temp[0]},
+				    {temp[2], temp[0], temp[1]}};
+				BLI_gTurbulence_array(pd->f_size, turb_co, 3, 2, 0, 2, force);
+			}
+			force[0] = -1.0f + 2.0f * force[0];
+			force[1] = -1.0f + 2.0f * force[1];
+			force[2] = -1.0f + 2.0f * force[2];
 			mul_v3_fl(force, strength * efd->falloff);
 			break;
 		case PFIELD_DRAG:
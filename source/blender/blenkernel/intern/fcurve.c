@@ -43,9 +43,11 @@
 #include "DNA_constraint_types.h"
 #include "DNA_object_types.h"
 
+#include "BLI_alloca.h"
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
 #include "BLI_easing.h"
+#include "BLI_expr_pylike_eval.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -1647,6 +1649,8 @@ void fcurve_free_driver(FCurve *fcu)
 		BPY_DECREF(driver->expr_comp);
 #endif
 
+	BLI_expr_pylike_free(driver->expr_simple);
+
 	/* free driver itself, then set F-Curve's point to this to NULL (as the curve may still be used) */
 	MEM_freeN(driver);
 	fcu->driver = NULL;
@@ -1665,6 +1669,7 @@ ChannelDriver *fcurve_copy_driver(ChannelDriver *driver)
 	/* copy all data */
 	ndriver = MEM_dupallocN(driver);
 	ndriver->expr_comp = NULL;
+	ndriver->expr_simple = NULL;
 	
 	/* copy variables */
 	BLI_listbase_clear(&ndriver->variables);
@@ -1710,6 +1715,67 @@ float driver_get_variable_value(ChannelDriver *driver, DriverVar *dvar)
 	return dvar->curval;
 }
 
+/* Evaluate a simple expression driver without Python, see BLI_expr_pylike_eval.c.
+ * This doesn't need the Python lock, so these drivers can be evaluated from threads at once.
+ * Returns false if the expression needs Python.
+ */
+static bool driver_evaluate_simple_expr(ChannelDriver *driver, const float evaltime)
+{
+	/* the variables, and the current frame like in the Python driver namespace */
+	const int names_len = BLI_listbase_count(&driver->variables) + 1;
+	double *values = BLI_array_alloca(values, names_len);
+	DriverVar *dvar;
+	eExprPyLike_EvalStatus status;
+	double result;
+	int i;
+	
+	/* parse the expression again when it or the variable names changed */
+	if ((driver->expr_simple == NULL) || (driver->flag & (DRIVER_FLAG_RECOMPILE | DRIVER_FLAG_RENAMEVAR))) {
+		const char **names = BLI_array_alloca(names, names_len);
+		
+		/* variables come first, they hide 'frame' like Python locals hide globals */
+		for (dvar = driver->variables.first, i = 0; dvar; dvar = dvar->next) {
+			names[i++] = dvar->name;
+		}
+		names[i] = "frame";
+		
+		BLI_expr_pylike_free(driver->expr_simple);
+		driver->expr_simple = BLI_expr_pylike_parse(driver->expression, names, names_len);
+		
+		if (BLI_expr_pylike_is_valid(driver->expr_simple)) {
+			/* nothing left to compile for Python */
+			driver->flag &= ~(DRIVER_FLAG_RECOMPILE | DRIVER_FLAG_RENAMEVAR);
+		}
+		else {
+			/* the compiled Python expression may be of an older expression */
+			driver->flag |= DRIVER_FLAG_RECOMPILE;
+		}
+	}
+	
+	if (!BLI_expr_pylike_is_valid(driver->expr_simple))
+		return false;
+	
+	for (dvar = driver->variables.first, i = 0; dvar; dvar = dvar->next) {
+		values[i++] = (double)driver_get_variable_value(driver, dvar);
+	}
+	values[i] = (double)evaltime;
+	
+	status = BLI_expr_pylike_eval(driver->expr_simple, values, names_len, &result);
+	
+	if (status == EXPR_PYLIKE_SUCCESS) {
+		driver->curval = (float)result;
+	}
+	else {
+		/* same as when the Python expression raises an exception */
+		fprintf(stderr, "\nError in Driver: The following Python expression failed:\n\t'%s'\n\t%s\n\n",
+		        driver->expression, (status == EXPR_PYLIKE_DIV_BY_ZERO) ? "Division by zero" : "Math domain error");
+		driver->flag |= DRIVER_FLAG_INVALID;
+		driver->curval = 0.0f;
+	}
+	
+	return true;
+}
+
 /* Evaluate an Channel-Driver to get a 'time' value to use instead of "evaltime"
  *	- "evaltime" is the frame at which F-Curve is being evaluated
  *  - has to return a float value
@@ -1787,24 +1853,25 @@ static float evaluate_driver(ChannelDriver *driver, const float evaltime)
 		}
 		case DRIVER_TYPE_PYTHON: /* expression */
 		{
-#ifdef WITH_PYTHON
 			/* check for empty or invalid expression */
 			if ( (driver->expression[0] == '\0') ||
 			     (driver->flag & DRIVER_FLAG_INVALID) )
 			{
 				driver->curval = 0.0f;
 			}
+			else if (driver_evaluate_simple_expr(driver, evaltime)) {
+				/* pass */
+			}
 			else {
+#ifdef WITH_PYTHON
 				/* this evaluates the expression using Python, and returns its result:
 				 *  - on errors it reports, then returns 0.0f
 				 */
 				BLI_mutex_lock(&python_driver_lock);
 				driver->curval = BPY_driver_exec(driver, evaltime);
 				BLI_mutex_unlock(&python_driver_lock);
-			}
-#else /* WITH_PYTHON*/
-			(void)evaltime;
 #endif /* WITH_PYTHON*/
+			}
 			break;
 		}
 		default:
@@ -40,6 +40,7 @@
 #include "BLI_listbase.h"
 #include "BLI_bitmap.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
@@ -885,11 +886,38 @@ void curve_deform_vector(Scene *scene, Object *cuOb, Object *target,
 
 }
 
+typedef struct LatticeDeformUserdata {
+	LatticeDeformData *lattice_deform_data;
+	float (*vertexCos)[3];
+	DerivedMesh *dm;
+	MDeformVert *dvert;
+	int defgrp_index;
+	float fac;
+} LatticeDeformUserdata;
+
+static void lattice_deform_vert_task(void *userdata, void *UNUSED(userdata_chunk), int index)
+{
+	const LatticeDeformUserdata *data = userdata;
+
+	if (data->dvert || data->dm) {
+		const MDeformVert *dvert = data->dm ?
+		                           data->dm->getVertData(data->dm, index, CD_MDEFORMVERT) :
+		                           data->dvert + index;
+		const float weight = defvert_find_weight(dvert, data->defgrp_index);
+
+		if (weight > 0.0f)
+			calc_latt_deform(data->lattice_deform_data, data->vertexCos[index], weight * data->fac);
+	}
+	else {
+		calc_latt_deform(data->lattice_deform_data, data->vertexCos[index], data->fac);
+	}
+}
+
 void lattice_deform_verts(Object *laOb, Object *target, DerivedMesh *dm,
                           float (*vertexCos)[3], int numVerts, const char *vgroup, float fac)
 {
 	LatticeDeformData *lattice_deform_data;
-	int a;
+	LatticeDeformUserdata data = {NULL};
 	bool use_vgroups;
 
 	if (laOb->type != OB_LATTICE)
@@ -914,30 +942,32 @@ void lattice_deform_verts(Object *laOb, Object *target, DerivedMesh *dm,
 	else {
 		use_vgroups = false;
 	}
-	
+
+	data.lattice_deform_data = lattice_deform_data;
+	data.vertexCos = vertexCos;
+	data.fac = fac;
+
 	if (vgroup && vgroup[0] && use_vgroups) {
 		Mesh *me = target->data;
 		const int defgrp_index = defgroup_name_index(target, vgroup);
-		float weight;
 
 		if (defgrp_index >= 0 && (me->dvert || dm)) {
-			MDeformVert *dvert = me->dvert;
-			
-			for (a = 0; a < numVerts; a++, dvert++) {
-				if (dm) dvert = dm->getVertData(dm, a, CD_MDEFORMVERT);
-
-				weight = defvert_find_weight(dvert, defgrp_index);
-
-				if (weight > 0.0f)
-					calc_latt_deform(lattice_deform_data, vertexCos[a], weight * fac);
-			}
+			data.dm = dm;
+			data.dvert = me->dvert;
+			data.defgrp_index = defgrp_index;
 		}
-	}
-	else {
-		for (a = 0; a < numVerts; a++) {
-			calc_latt_deform(lattice_deform_data, vertexCos[a], fac);
+		else {
+			/* the group doesn't exist, nothing to deform */
+			numVerts = 0;
 		}
 	}
+
+	/* the lattice is only read, so the vertices can be deformed in parallel */
+	if (numVerts > 0) {
+		BLI_task_parallel_range_ex(0, numVerts, &data, NULL, 0, lattice_deform_vert_task,
+		                           numVerts > 1000, false);
+	}
+
 	end_latt_deform(lattice_deform_data);
 }
 
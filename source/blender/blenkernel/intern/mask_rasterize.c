@@ -82,6 +82,7 @@
 #include "BLI_rect.h"
 #include "BLI_listbase.h"
 #include "BLI_linklist.h"
+#include "BLI_task.h"
 
 #include "BKE_mask.h"
 
@@ -1299,11 +1300,8 @@ BLI_INLINE unsigned int layer_bucket_index_from_xy(MaskRasterLayer *layer, const
 	       (((unsigned int)((xy[1] - layer->bounds.ymin) * layer->buckets_xy_scalar[1])) * layer->buckets_x);
 }
 
-static float layer_bucket_depth_from_xy(MaskRasterLayer *layer, const float xy[2])
+static float layer_bucket_depth_from_faces(MaskRasterLayer *layer, unsigned int *face_index, const float xy[2])
 {
-	unsigned int index = layer_bucket_index_from_xy(layer, xy);
-	unsigned int *face_index = layer->buckets_face[index];
-
 	if (face_index) {
 		unsigned int (*face_array)[4] = layer->face_array;
 		float        (*cos)[3]        = layer->face_coords;
@@ -1327,6 +1325,92 @@ static float layer_bucket_depth_from_xy(MaskRasterLayer *layer, const float xy[2
 	}
 }
 
+static float layer_bucket_depth_from_xy(MaskRasterLayer *layer, const float xy[2])
+{
+	unsigned int index = layer_bucket_index_from_xy(layer, xy);
+
+	return layer_bucket_depth_from_faces(layer, layer->buckets_face[index], xy);
+}
+
+BLI_INLINE float layer_value_falloff(const MaskRasterLayer *layer, float value_layer)
+{
+	switch (layer->falloff) {
+		case PROP_SMOOTH:
+			/* ease - gives less hard lines for dilate/erode feather */
+			value_layer = (3.0f * value_layer * value_layer - 2.0f * value_layer * value_layer * value_layer);
+			break;
+		case PROP_SPHERE:
+			value_layer = sqrtf(2.0f * value_layer - value_layer * value_layer);
+			break;
+		case PROP_ROOT:
+			value_layer = sqrtf(value_layer);
+			break;
+		case PROP_SHARP:
+			value_layer = value_layer * value_layer;
+			break;
+		case PROP_INVSQUARE:
+			value_layer = value_layer * (2.0f - value_layer);
+			break;
+		case PROP_LIN:
+		default:
+			/* nothing */
+			break;
+	}
+
+	if (layer->blend != MASK_BLEND_REPLACE) {
+		value_layer *= layer->alpha;
+	}
+
+	return value_layer;
+}
+
+BLI_INLINE float layer_value_blend(const MaskRasterLayer *layer, float value, float value_layer)
+{
+	if (layer->blend_flag & MASK_BLENDFLAG_INVERT) {
+		value_layer = 1.0f - value_layer;
+	}
+
+	switch (layer->blend) {
+		case MASK_BLEND_MERGE_ADD:
+			value += value_layer * (1.0f - value);
+			break;
+		case MASK_BLEND_MERGE_SUBTRACT:
+			value -= value_layer * value;
+			break;
+		case MASK_BLEND_ADD:
+			value += value_layer;
+			break;
+		case MASK_BLEND_SUBTRACT:
+			value -= value_layer;
+			break;
+		case MASK_BLEND_LIGHTEN:
+			value = max_ff(value, value_layer);
+			break;
+		case MASK_BLEND_DARKEN:
+			value = min_ff(value, value_layer);
+			break;
+		case MASK_BLEND_MUL:
+			value *= value_layer;
+			break;
+		case MASK_BLEND_REPLACE:
+			value = (value * (1.0f - layer->alpha)) + (value_layer * layer->alpha);
+			break;
+		case MASK_BLEND_DIFFERENCE:
+			value = fabsf(value - value_layer);
+			break;
+		default: /* same as add */
+			BLI_assert(0);
+			value += value_layer;
+			break;
+	}
+
+	/* clamp after applying each layer so we don't get
+	 * issues subtracting after accumulating over 1.0f */
+	CLAMP(value, 0.0f, 1.0f);
+
+	return value;
+}
+
 float BKE_maskrasterize_handle_sample(MaskRasterHandle *mr_handle, const float xy[2])
 {
 	/* can't do this because some layers may invert */
@@ -1344,128 +1428,110 @@ float BKE_maskrasterize_handle_sample(MaskRasterHandle *mr_handle, const float x
 
 		/* also used as signal for unused layer (when render is disabled) */
 		if (layer->alpha != 0.0f && BLI_rctf_isect_pt_v(&layer->bounds, xy)) {
-			value_layer = 1.0f - layer_bucket_depth_from_xy(layer, xy);
-
-			switch (layer->falloff) {
-				case PROP_SMOOTH:
-					/* ease - gives less hard lines for dilate/erode feather */
-					value_layer = (3.0f * value_layer * value_layer - 2.0f * value_layer * value_layer * value_layer);
-					break;
-				case PROP_SPHERE:
-					value_layer = sqrtf(2.0f * value_layer - value_layer * value_layer);
-					break;
-				case PROP_ROOT:
-					value_layer = sqrtf(value_layer);
-					break;
-				case PROP_SHARP:
-					value_layer = value_layer * value_layer;
-					break;
-				case PROP_INVSQUARE:
-					value_layer = value_layer * (2.0f - value_layer);
-					break;
-				case PROP_LIN:
-				default:
-					/* nothing */
-					break;
-			}
-
-			if (layer->blend != MASK_BLEND_REPLACE) {
-				value_layer *= layer->alpha;
-			}
+			value_layer = layer_value_falloff(layer, 1.0f - layer_bucket_depth_from_xy(layer, xy));
 		}
 		else {
 			value_layer = 0.0f;
 		}
 
-		if (layer->blend_flag & MASK_BLENDFLAG_INVERT) {
-			value_layer = 1.0f - value_layer;
-		}
-
-		switch (layer->blend) {
-			case MASK_BLEND_MERGE_ADD:
-				value += value_layer * (1.0f - value);
-				break;
-			case MASK_BLEND_MERGE_SUBTRACT:
-				value -= value_layer * value;
-				break;
-			case MASK_BLEND_ADD:
-				value += value_layer;
-				break;
-			case MASK_BLEND_SUBTRACT:
-				value -= value_layer;
-				break;
-			case MASK_BLEND_LIGHTEN:
-				value = max_ff(value, value_layer);
-				break;
-			case MASK_BLEND_DARKEN:
-				value = min_ff(value, value_layer);
-				break;
-			case MASK_BLEND_MUL:
-				value *= value_layer;
-				break;
-			case MASK_BLEND_REPLACE:
-				value = (value * (1.0f - layer->alpha)) + (value_layer * layer->alpha);
-				break;
-			case MASK_BLEND_DIFFERENCE:
-				value = fabsf(value - value_layer);
-				break;
-			default: /* same as add */
-				BLI_assert(0);
-				value += value_layer;
-				break;
-		}
-
-		/* clamp after applying each layer so we don't get
-		 * issues subtracting after accumulating over 1.0f */
-		CLAMP(value, 0.0f, 1.0f);
+		value = layer_value_blend(layer, value, value_layer);
 	}
 
 	return value;
 }
 
+typedef struct MaskRasterizeBufferData {
+	MaskRasterHandle *mr_handle;
+	float x_inv, y_inv;
+	float x_px_ofs, y_px_ofs;
+	unsigned int width;
+
+	float *buffer;
+} MaskRasterizeBufferData;
+
 /**
- * \brief Rasterize a buffer from a single mask
+ * Rasterize one row of a layer, blending it over the values already in the row.
  *
- * We could get some speedup by inlining #BKE_maskrasterize_handle_sample
- * and calculating each layer then blending buffers, but this function is only
- * used by the sequencer - so better have the caller thread.
- *
- * Since #BKE_maskrasterize_handle_sample is used threaded elsewhere,
- * we can simply use openmp here for some speedup.
+ * The bucket row only depends on Y, so it's resolved once for the whole row
+ * and consecutive pixels usually share the same bucket face list.
  */
-void BKE_maskrasterize_buffer(MaskRasterHandle *mr_handle,
-                              const unsigned int width, const unsigned int height,
-                              float *buffer)
+static void maskrasterize_buffer_layer_row(MaskRasterLayer *layer, const MaskRasterizeBufferData *data,
+                                           const float y, float *row)
 {
-	const float x_inv = 1.0f / (float)width;
-	const float y_inv = 1.0f / (float)height;
-	const float x_px_ofs = x_inv * 0.5f;
-	const float y_px_ofs = y_inv * 0.5f;
-#ifdef _MSC_VER
-	int y;  /* msvc requires signed for some reason */
-
-	/* ignore sign mismatch */
-#  pragma warning(push)
-#  pragma warning(disable:4018)
-#else
-	unsigned int y;
-#endif
+	const unsigned int width = data->width;
+	unsigned int x;
+	float xy[2];
 
-#pragma omp parallel for private(y)
-	for (y = 0; y < height; y++) {
-		unsigned int i = y * width;
-		unsigned int x;
-		float xy[2];
-		xy[1] = ((float)y * y_inv) + y_px_ofs;
-		for (x = 0; x < width; x++, i++) {
-			xy[0] = ((float)x * x_inv) + x_px_ofs;
+	xy[1] = y;
 
-			buffer[i] = BKE_maskrasterize_handle_sample(mr_handle, xy);
+	/* also used as signal for unused layer (when render is disabled) */
+	if (layer->alpha == 0.0f || y < layer->bounds.ymin || y > layer->bounds.ymax) {
+		for (x = 0; x < width; x++) {
+			row[x] = layer_value_blend(layer, row[x], 0.0f);
 		}
 	}
+	else {
+		unsigned int **buckets_face_row = &layer->buckets_face[
+		        ((unsigned int)((y - layer->bounds.ymin) * layer->buckets_xy_scalar[1])) * layer->buckets_x];
 
-#ifdef _MSC_VER
-#  pragma warning(pop)
-#endif
+		for (x = 0; x < width; x++) {
+			float value_layer;
+
+			xy[0] = ((float)x * data->x_inv) + data->x_px_ofs;
+
+			if (xy[0] >= layer->bounds.xmin && xy[0] <= layer->bounds.xmax) {
+				unsigned int *face_index = buckets_face_row[
+				        (unsigned int)((xy[0] - layer->bounds.xmin) * layer->buckets_xy_scalar[0])];
+
+				value_layer = layer_value_falloff(layer, 1.0f - layer_bucket_depth_from_faces(layer, face_index, xy));
+			}
+			else {
+				value_layer = 0.0f;
+			}
+
+			row[x] = layer_value_blend(layer, row[x], value_layer);
+		}
+	}
+}
 
+static void maskrasterize_buffer_cb(void *userdata, void *UNUSED(userdata_chunk), int y)
+{
+	MaskRasterizeBufferData *data = userdata;
+	MaskRasterHandle *mr_handle = data->mr_handle;
+	MaskRasterLayer *layer = mr_handle->layers;
+	const unsigned int layers_tot = mr_handle->layers_tot;
+	const float y_fl = ((float)y * data->y_inv) + data->y_px_ofs;
+	float *row = &data->buffer[(size_t)y * data->width];
+	unsigned int i;
+
+	copy_vn_fl(row, (int)data->width, 0.0f);
+
+	for (i = 0; i < layers_tot; i++, layer++) {
+		maskrasterize_buffer_layer_row(layer, data, y_fl, row);
+	}
+}
+
+/**
+ * \brief Rasterize a buffer from a single mask
+ *
+ * Gives the same result as calling #BKE_maskrasterize_handle_sample for every pixel,
+ * but rasterizes each layer a row at a time, so bucket lookups are shared between pixels.
+ * Rows are distributed over the task scheduler.
+ */
+void BKE_maskrasterize_buffer(MaskRasterHandle *mr_handle,
+                              const unsigned int width, const unsigned int height,
+                              float *buffer)
+{
+	MaskRasterizeBufferData data;
+
+	data.mr_handle = mr_handle;
+	data.x_inv = 1.0f / (float)width;
+	data.y_inv = 1.0f / (float)height;
+	data.x_px_ofs = data.x_inv * 0.5f;
+	data.y_px_ofs = data.y_inv * 0.5f;
+	data.width = width;
+	data.buffer = buffer;
+
+	BLI_task_parallel_range_ex(0, (int)height, &data, NULL, 0, maskrasterize_buffer_cb,
+	                           height * width > 10000, false);
 }
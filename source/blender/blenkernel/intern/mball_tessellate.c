@@ -45,6 +45,7 @@
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
 #include "BLI_memarena.h"
+#include "BLI_task.h"
 
 #include "BKE_global.h"
 
@@ -131,6 +132,7 @@ typedef struct process {        /* parameters, storage */
 	unsigned int curindex;		/* number of currently added indices */
 
 	float (*co)[3], (*no)[3];   /* surface vertices - positions and normals */
+	const struct corner *(*co_edge)[2];  /* corners of the edge each vertex lies on */
 	unsigned int totvertex;		/* memory size */
 	unsigned int curvertex;		/* currently added vertices */
 
@@ -142,7 +144,7 @@ typedef struct process {        /* parameters, storage */
 static int vertid(PROCESS *process, const CORNER *c1, const CORNER *c2);
 static void add_cube(PROCESS *process, int i, int j, int k);
 static void make_face(PROCESS *process, int i1, int i2, int i3, int i4);
-static void converge(PROCESS *process, const CORNER *c1, const CORNER *c2, float r_p[3]);
+static void converge(PROCESS *process, MetaballBVHNode **bvh_queue, const CORNER *c1, const CORNER *c2, float r_p[3]);
 
 /* ******************* SIMPLE BVH ********************* */
 
@@ -361,26 +363,27 @@ static float densfunc(const MetaElem *ball, float x, float y, float z)
 
 /**
  * Computes density at given position form all metaballs which contain this point in their box.
- * Traverses BVH using a queue.
+ * Traverses BVH using a queue, \a bvh_queue must hold bvh_queue_size nodes,
+ * and is passed separately so the density can be computed from multiple threads.
  */
-static float metaball(PROCESS *process, float x, float y, float z)
+static float metaball(PROCESS *process, MetaballBVHNode **bvh_queue, float x, float y, float z)
 {
 	int i;
 	float dens = 0.0f;
 	unsigned int front = 0, back = 0;
 	MetaballBVHNode *node;
 
-	process->bvh_queue[front++] = &process->metaball_bvh;
+	bvh_queue[front++] = &process->metaball_bvh;
 
 	while (front != back) {
-		node = process->bvh_queue[back++];
+		node = bvh_queue[back++];
 
 		for (i = 0; i < 2; i++) {
 			if ((node->bb[i].min[0] <= x) && (node->bb[i].max[0] >= x) &&
 			    (node->bb[i].min[1] <= y) && (node->bb[i].max[1] >= y) &&
 			    (node->bb[i].min[2] <= z) && (node->bb[i].max[2] >= z))
 			{
-				if (node->child[i])	process->bvh_queue[front++] = node->child[i];
+				if (node->child[i])	bvh_queue[front++] = node->child[i];
 				else dens += densfunc(node->bb[i].ml, x, y, z);
 			}
 		}
@@ -396,10 +399,6 @@ static void make_face(PROCESS *process, int i1, int i2, int i3, int i4)
 {
 	int *cur;
 
-#ifdef USE_ACCUM_NORMAL
-	float n[3];
-#endif
-
 	if (UNLIKELY(process->totindex == process->curindex)) {
 		process->totindex += 4096;
 		process->indices = MEM_reallocN(process->indices, sizeof(int[4]) * process->totindex);
@@ -419,28 +418,41 @@ static void make_face(PROCESS *process, int i1, int i2, int i3, int i4)
 	else {
 		cur[3] = i4;
 	}
+}
 
 #ifdef USE_ACCUM_NORMAL
-	if (i4 == 0) {
-		normal_tri_v3(n, process->co[i1], process->co[i2], process->co[i3]);
-		accumulate_vertex_normals(
-		        process->no[i1], process->no[i2], process->no[i3], NULL, n,
-		        process->co[i1], process->co[i2], process->co[i3], NULL);
-	}
-	else {
-		normal_quad_v3(n, process->co[i1], process->co[i2], process->co[i3], process->co[i4]);
-		accumulate_vertex_normals(
-		        process->no[i1], process->no[i2], process->no[i3], process->no[i4], n,
-		        process->co[i1], process->co[i2], process->co[i3], process->co[i4]);
-	}
-#endif
+/**
+ * Accumulates face normals to the vertices, once their positions are computed.
+ */
+static void accumulate_face_normals(PROCESS *process)
+{
+	unsigned int a;
+
+	for (a = 0; a < process->curindex; a++) {
+		const int *cur = process->indices[a];
+		float n[3];
 
+		if (cur[3] == cur[2]) {
+			normal_tri_v3(n, process->co[cur[0]], process->co[cur[1]], process->co[cur[2]]);
+			accumulate_vertex_normals(
+			        process->no[cur[0]], process->no[cur[1]], process->no[cur[2]], NULL, n,
+			        process->co[cur[0]], process->co[cur[1]], process->co[cur[2]], NULL);
+		}
+		else {
+			normal_quad_v3(n, process->co[cur[0]], process->co[cur[1]], process->co[cur[2]], process->co[cur[3]]);
+			accumulate_vertex_normals(
+			        process->no[cur[0]], process->no[cur[1]], process->no[cur[2]], process->no[cur[3]], n,
+			        process->co[cur[0]], process->co[cur[1]], process->co[cur[2]], process->co[cur[3]]);
+		}
+	}
 }
+#endif
 
 /* Frees allocated memory */
 static void freepolygonize(PROCESS *process)
 {
 	if (process->corners) MEM_freeN(process->corners);
+	if (process->co_edge) MEM_freeN(process->co_edge);
 	if (process->edges) MEM_freeN(process->edges);
 	if (process->centers) MEM_freeN(process->centers);
 	if (process->mainb) MEM_freeN(process->mainb);
@@ -595,7 +607,7 @@ static CORNER *setcorner(PROCESS *process, int i, int j, int k)
 	c->k = k;
 	c->co[2] = ((float)k - 0.5f) * process->size;
 
-	c->value = metaball(process, c->co[0], c->co[1], c->co[2]);
+	c->value = metaball(process, process->bvh_queue, c->co[0], c->co[1], c->co[2]);
 
 	c->next = process->corners[index];
 	process->corners[index] = c;
@@ -829,17 +841,19 @@ static int getedge(EDGELIST *table[],
 
 /**
  * Adds a vertex, expands memory if needed.
+ * Its position and normal are computed later by #polygonize_vertices().
  */
-static void addtovertices(PROCESS *process, const float v[3], const float no[3])
+static void addtovertices(PROCESS *process, const CORNER *c1, const CORNER *c2)
 {
 	if (process->curvertex == process->totvertex) {
 		process->totvertex += 4096;
 		process->co = MEM_reallocN(process->co, process->totvertex * sizeof(float[3]));
 		process->no = MEM_reallocN(process->no, process->totvertex * sizeof(float[3]));
+		process->co_edge = MEM_reallocN(process->co_edge, process->totvertex * sizeof(*process->co_edge));
 	}
 
-	copy_v3_v3(process->co[process->curvertex], v);
-	copy_v3_v3(process->no[process->curvertex], no);
+	process->co_edge[process->curvertex][0] = c1;
+	process->co_edge[process->curvertex][1] = c2;
 
 	process->curvertex++;
 }
@@ -850,14 +864,14 @@ static void addtovertices(PROCESS *process, const float v[3], const float no[3])
  *
  * \note Doesn't do normalization!
  */
-static void vnormal(PROCESS *process, const float point[3], float r_no[3])
+static void vnormal(PROCESS *process, MetaballBVHNode **bvh_queue, const float point[3], float r_no[3])
 {
 	const float delta = process->delta;
-	const float f = metaball(process, point[0], point[1], point[2]);
+	const float f = metaball(process, bvh_queue, point[0], point[1], point[2]);
 
-	r_no[0] = metaball(process, point[0] + delta, point[1], point[2]) - f;
-	r_no[1] = metaball(process, point[0], point[1] + delta, point[2]) - f;
-	r_no[2] = metaball(process, point[0], point[1], point[2] + delta) - f;
+	r_no[0] = metaball(process, bvh_queue, point[0] + delta, point[1], point[2]) - f;
+	r_no[1] = metaball(process, bvh_queue, point[0], point[1] + delta, point[2]) - f;
+	r_no[2] = metaball(process, bvh_queue, point[0], point[1], point[2] + delta) - f;
 
 #if 0
 	f = normalize_v3(r_no);
@@ -885,24 +899,15 @@ static void vnormal(PROCESS *process, const float point[3], float r_no[3])
 /**
  * \return the id of vertex between two corners.
  *
- * If it wasn't previously computed, does #converge() and adds vertex to process.
+ * If it wasn't previously added, adds vertex to process.
  */
 static int vertid(PROCESS *process, const CORNER *c1, const CORNER *c2)
 {
-	float v[3], no[3];
 	int vid = getedge(process->edges, c1->i, c1->j, c1->k, c2->i, c2->j, c2->k);
 
 	if (vid != -1) return vid;  /* previously computed */
 
-	converge(process, c1, c2, v);  /* position */
-
-#ifdef USE_ACCUM_NORMAL
-	zero_v3(no);
-#else
-	vnormal(process, v, no);
-#endif
-
-	addtovertices(process, v, no);            /* save vertex */
+	addtovertices(process, c1, c2);            /* save vertex */
 	vid = (int)process->curvertex - 1;
 	setedge(process, c1->i, c1->j, c1->k, c2->i, c2->j, c2->k, vid);
 
@@ -913,7 +918,7 @@ static int vertid(PROCESS *process, const CORNER *c1, const CORNER *c2)
  * Given two corners, computes approximation of surface intersection point between them.
  * In case of small threshold, do bisection.
  */
-static void converge(PROCESS *process, const CORNER *c1, const CORNER *c2, float r_p[3])
+static void converge(PROCESS *process, MetaballBVHNode **bvh_queue, const CORNER *c1, const CORNER *c2, float r_p[3])
 {
 	float tmp, dens;
 	unsigned int i;
@@ -936,7 +941,7 @@ static void converge(PROCESS *process, const CORNER *c1, const CORNER *c2, float
 
 	for (i = 0; i < process->converge_res; i++) {
 		interp_v3_v3v3(r_p, c1_co, c2_co, 0.5f);
-		dens = metaball(process, r_p[0], r_p[1], r_p[2]);
+		dens = metaball(process, bvh_queue, r_p[0], r_p[1], r_p[2]);
 
 		if (dens > 0.0f) {
 			c1_value = dens;
@@ -1043,6 +1048,46 @@ static void find_first_points(PROCESS *process, const unsigned int em)
 	}
 }
 
+/* vertices computed per task */
+#define MB_VERTICES_BLOCK_SIZE 256
+
+static void polygonize_vertices_cb(void *userdata, void *UNUSED(userdata_chunk), int block)
+{
+	PROCESS *process = userdata;
+	MetaballBVHNode **bvh_queue = MEM_mallocN(sizeof(MetaballBVHNode *) * process->bvh_queue_size, __func__);
+	const unsigned int start = (unsigned int)block * MB_VERTICES_BLOCK_SIZE;
+	const unsigned int end = MIN2(start + MB_VERTICES_BLOCK_SIZE, process->curvertex);
+	unsigned int i;
+
+	for (i = start; i < end; i++) {
+		converge(process, bvh_queue, process->co_edge[i][0], process->co_edge[i][1], process->co[i]);
+
+#ifdef USE_ACCUM_NORMAL
+		zero_v3(process->no[i]);
+#else
+		vnormal(process, bvh_queue, process->co[i], process->no[i]);
+#endif
+	}
+
+	MEM_freeN(bvh_queue);
+}
+
+/**
+ * Computes the positions and normals of all vertices found by the cube walk.
+ * Converging to the surface takes most of the field evaluations, and unlike the walk
+ * it only reads the corners and metaballs, so the vertices are computed in parallel.
+ */
+static void polygonize_vertices(PROCESS *process)
+{
+	const int blocks = (int)((process->curvertex + MB_VERTICES_BLOCK_SIZE - 1) / MB_VERTICES_BLOCK_SIZE);
+
+	BLI_task_parallel_range_ex(0, blocks, process, NULL, 0, polygonize_vertices_cb, blocks > 1, false);
+
+#ifdef USE_ACCUM_NORMAL
+	accumulate_face_normals(process);
+#endif
+}
+
 /**
  * The main polygonization proc.
  * Allocates memory, makes cubetable,
@@ -1071,6 +1116,8 @@ static void polygonize(PROCESS *process)
 
 		docube(process, &c);
 	}
+
+	polygonize_vertices(process);
 }
 
 /**
@@ -47,8 +47,10 @@
 #include "BLI_linklist.h"
 #include "BLI_linklist_stack.h"
 #include "BLI_alloca.h"
+#include "BLI_hash_mm2a.h"
 #include "BLI_stack.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "BKE_customdata.h"
 #include "BKE_global.h"
@@ -632,6 +634,104 @@ typedef struct LoopSplitTaskDataCommon {
 
 } LoopSplitTaskDataCommon;
 
+/* Cache of the last split normals results of big meshes.
+ * The modifier stack evaluates the same mesh again for many changes which don't affect its geometry
+ * (object level changes, frame changes without animated deformation...), so the normals are looked up
+ * by a hash of all the input data, and the whole calculation is skipped when they haven't changed. */
+#define LOOP_SPLIT_CACHE_MIN_LOOPS (LOOP_SPLIT_TASK_BLOCK_SIZE * 8)
+#define LOOP_SPLIT_CACHE_SIZE 2
+
+typedef struct LoopSplitCacheEntry {
+	uint32_t key;
+	int numLoops;
+	float (*loopnors)[3];
+} LoopSplitCacheEntry;
+
+static LoopSplitCacheEntry loop_split_cache[LOOP_SPLIT_CACHE_SIZE] = {{0}};
+static int loop_split_cache_next = 0;
+static ThreadMutex loop_split_cache_lock = BLI_MUTEX_INITIALIZER;
+
+static uint32_t loop_split_cache_key(
+        const MVert *mverts, const int numVerts, const MEdge *medges, const int numEdges,
+        const MLoop *mloops, const int numLoops,
+        const MPoly *mpolys, const float (*polynors)[3], const int numPolys,
+        const float split_angle, const short (*clnors_data)[2])
+{
+	BLI_HashMurmur2A mm2;
+
+	BLI_hash_mm2a_init(&mm2, 0);
+
+	BLI_hash_mm2a_add_int(&mm2, numVerts);
+	BLI_hash_mm2a_add_int(&mm2, numEdges);
+	BLI_hash_mm2a_add_int(&mm2, numLoops);
+	BLI_hash_mm2a_add_int(&mm2, numPolys);
+	BLI_hash_mm2a_add(&mm2, (const unsigned char *)&split_angle, sizeof(split_angle));
+
+	BLI_hash_mm2a_add(&mm2, (const unsigned char *)mverts, sizeof(*mverts) * (size_t)numVerts);
+	BLI_hash_mm2a_add(&mm2, (const unsigned char *)medges, sizeof(*medges) * (size_t)numEdges);
+	BLI_hash_mm2a_add(&mm2, (const unsigned char *)mloops, sizeof(*mloops) * (size_t)numLoops);
+	BLI_hash_mm2a_add(&mm2, (const unsigned char *)mpolys, sizeof(*mpolys) * (size_t)numPolys);
+	BLI_hash_mm2a_add(&mm2, (const unsigned char *)polynors, sizeof(*polynors) * (size_t)numPolys);
+	BLI_hash_mm2a_add_int(&mm2, clnors_data != NULL);
+	if (clnors_data) {
+		BLI_hash_mm2a_add(&mm2, (const unsigned char *)clnors_data, sizeof(*clnors_data) * (size_t)numLoops);
+	}
+
+	return BLI_hash_mm2a_end(&mm2);
+}
+
+static bool loop_split_cache_lookup(const uint32_t key, const int numLoops, float (*r_loopnors)[3])
+{
+	bool found = false;
+	int i;
+
+	BLI_mutex_lock(&loop_split_cache_lock);
+	for (i = 0; i < LOOP_SPLIT_CACHE_SIZE; i++) {
+		const LoopSplitCacheEntry *entry = &loop_split_cache[i];
+		if (entry->loopnors && entry->key == key && entry->numLoops == numLoops) {
+			memcpy(r_loopnors, entry->loopnors, sizeof(*r_loopnors) * (size_t)numLoops);
+			found = true;
+			break;
+		}
+	}
+	BLI_mutex_unlock(&loop_split_cache_lock);
+
+	return found;
+}
+
+static void loop_split_cache_add(const uint32_t key, const int numLoops, const float (*loopnors)[3])
+{
+	float (*loopnors_copy)[3] = MEM_mallocN(sizeof(*loopnors_copy) * (size_t)numLoops, __func__);
+	LoopSplitCacheEntry *entry;
+
+	memcpy(loopnors_copy, loopnors, sizeof(*loopnors_copy) * (size_t)numLoops);
+
+	BLI_mutex_lock(&loop_split_cache_lock);
+	entry = &loop_split_cache[loop_split_cache_next];
+	loop_split_cache_next = (loop_split_cache_next + 1) % LOOP_SPLIT_CACHE_SIZE;
+	if (entry->loopnors) {
+		MEM_freeN(entry->loopnors);
+	}
+	entry->key = key;
+	entry->numLoops = numLoops;
+	entry->loopnors = loopnors_copy;
+	BLI_mutex_unlock(&loop_split_cache_lock);
+}
+
+/**
+ * Free the cached split normals, on exit.
+ */
+void BKE_mesh_normals_loop_split_cache_free(void)
+{
+	int i;
+
+	BLI_mutex_lock(&loop_split_cache_lock);
+	for (i = 0; i < LOOP_SPLIT_CACHE_SIZE; i++) {
+		MEM_SAFE_FREE(loop_split_cache[i].loopnors);
+	}
+	BLI_mutex_unlock(&loop_split_cache_lock);
+}
+
 #define INDEX_UNSET INT_MIN
 #define INDEX_INVALID -1
 /* See comment about edge_to_loops below. */
@@ -1134,6 +1234,8 @@ void BKE_mesh_normals_loop_split(
         const bool use_split_normals, float split_angle,
         MLoopNorSpaceArray *r_lnors_spacearr, short (*clnors_data)[2], int *r_loop_to_poly)
 {
+	uint32_t cache_key = 0;
+	bool use_cache = false;
 
 	/* For now this is not supported. If we do not use split normals, we do not generate anything fancy! */
 	BLI_assert(use_split_normals || !(r_lnors_spacearr));
@@ -1167,6 +1269,17 @@ void BKE_mesh_normals_loop_split(
 		return;
 	}
 
+	/* The cached normals can only be used when no other data has to be returned. */
+	if ((r_lnors_spacearr == NULL) && (r_loop_to_poly == NULL) && (numLoops >= LOOP_SPLIT_CACHE_MIN_LOOPS)) {
+		cache_key = loop_split_cache_key(
+		        mverts, numVerts, medges, numEdges, mloops, numLoops, mpolys, polynors, numPolys,
+		        split_angle, (const short (*)[2])clnors_data);
+		if (loop_split_cache_lookup(cache_key, numLoops, r_loopnors)) {
+			return;
+		}
+		use_cache = true;
+	}
+
 	{
 
 	/* Mapping edge -> loops.
@@ -1335,6 +1448,10 @@ void BKE_mesh_normals_loop_split(
 		}
 	}
 
+	if (use_cache) {
+		loop_split_cache_add(cache_key, numLoops, (const float (*)[3])r_loopnors);
+	}
+
 #ifdef DEBUG_TIME
 	TIMEIT_END(BKE_mesh_normals_loop_split);
 #endif
@@ -2694,133 +2811,225 @@ int BKE_mesh_recalc_tessellation(
 
 }
 
-/**
- * Calculate tessellation into #MLoopTri which exist only for this purpose.
- */
-void BKE_mesh_recalc_looptri(
-        const MLoop *mloop, const MPoly *mpoly,
-        const MVert *mvert,
-        int totloop, int totpoly,
-        MLoopTri *mlooptri)
-{
-	/* use this to avoid locking pthread for _every_ polygon
-	 * and calling the fill function */
-
+/* use this to avoid locking pthread for _every_ polygon
+ * and calling the fill function */
 #define USE_TESSFACE_SPEEDUP
 
-	const MPoly *mp;
+/* ngons up to this size are filled using the stack in threads, bigger ones use their own arena */
+#define LOOPTRI_NGON_ALLOCA_MAX 1024
+
+/* not worth threading below this amount of polygons */
+#define LOOPTRI_TASK_MIN_POLYS 4096
+
+static void mesh_recalc_looptri__single_poly(
+        const MLoop *mloop, const MPoly *mpoly, const MVert *mvert,
+        const int poly_index, MLoopTri *mlooptri, int mlooptri_index,
+        MemArena **pa_arena)
+{
+	const MPoly *mp = &mpoly[poly_index];
 	const MLoop *ml;
 	MLoopTri *mlt;
-	MemArena *arena = NULL;
-	int poly_index, mlooptri_index;
+	const unsigned int mp_loopstart = (unsigned int)mp->loopstart;
+	const unsigned int mp_totloop = (unsigned int)mp->totloop;
+	unsigned int l1, l2, l3;
 	unsigned int j;
 
-	mlooptri_index = 0;
-	mp = mpoly;
-	for (poly_index = 0; poly_index < totpoly; poly_index++, mp++) {
-		const unsigned int mp_loopstart = (unsigned int)mp->loopstart;
-		const unsigned int mp_totloop = (unsigned int)mp->totloop;
-		unsigned int l1, l2, l3;
-		if (mp_totloop < 3) {
-			/* do nothing */
-		}
+	if (mp_totloop < 3) {
+		/* do nothing */
+	}
 
 #ifdef USE_TESSFACE_SPEEDUP
 
 #define ML_TO_MLT(i1, i2, i3)  { \
-			mlt = &mlooptri[mlooptri_index]; \
-			l1 = mp_loopstart + i1; \
-			l2 = mp_loopstart + i2; \
-			l3 = mp_loopstart + i3; \
-			ARRAY_SET_ITEMS(mlt->tri, l1, l2, l3); \
-			mlt->poly = (unsigned int)poly_index; \
-		} ((void)0)
+		mlt = &mlooptri[mlooptri_index]; \
+		l1 = mp_loopstart + i1; \
+		l2 = mp_loopstart + i2; \
+		l3 = mp_loopstart + i3; \
+		ARRAY_SET_ITEMS(mlt->tri, l1, l2, l3); \
+		mlt->poly = (unsigned int)poly_index; \
+	} ((void)0)
+
+	else if (mp_totloop == 3) {
+		ML_TO_MLT(0, 1, 2);
+	}
+	else if (mp_totloop == 4) {
+		ML_TO_MLT(0, 1, 2);
+		mlooptri_index++;
+		ML_TO_MLT(0, 2, 3);
+	}
+
+#undef ML_TO_MLT
 
-		else if (mp_totloop == 3) {
-			ML_TO_MLT(0, 1, 2);
-			mlooptri_index++;
-		}
-		else if (mp_totloop == 4) {
-			ML_TO_MLT(0, 1, 2);
-			mlooptri_index++;
-			ML_TO_MLT(0, 2, 3);
-			mlooptri_index++;
-		}
 #endif /* USE_TESSFACE_SPEEDUP */
-		else {
-			const float *co_curr, *co_prev;
+	else {
+		const float *co_curr, *co_prev;
 
-			float normal[3];
+		float normal[3];
 
-			float axis_mat[3][3];
-			float (*projverts)[2];
-			unsigned int (*tris)[3];
+		float axis_mat[3][3];
+		float (*projverts)[2];
+		unsigned int (*tris)[3];
 
-			const unsigned int totfilltri = mp_totloop - 2;
+		const unsigned int totfilltri = mp_totloop - 2;
 
-			if (UNLIKELY(arena == NULL)) {
-				arena = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, __func__);
+		/* threads pass no arena, use the stack for all but huge ngons */
+		MemArena *arena_local = NULL;
+		MemArena *arena;
+
+		if (pa_arena) {
+			if (UNLIKELY(*pa_arena == NULL)) {
+				*pa_arena = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, __func__);
 			}
+			arena = *pa_arena;
+		}
+		else if (mp_totloop > LOOPTRI_NGON_ALLOCA_MAX) {
+			arena = arena_local = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, __func__);
+		}
+		else {
+			arena = NULL;
+		}
 
+		if (arena) {
 			tris = BLI_memarena_alloc(arena, sizeof(*tris) * (size_t)totfilltri);
 			projverts = BLI_memarena_alloc(arena, sizeof(*projverts) * (size_t)mp_totloop);
+		}
+		else {
+			tris = BLI_array_alloca(tris, (size_t)totfilltri);
+			projverts = BLI_array_alloca(projverts, (size_t)mp_totloop);
+		}
 
-			zero_v3(normal);
+		zero_v3(normal);
 
-			/* calc normal, flipped: to get a positive 2d cross product */
-			ml = mloop + mp_loopstart;
-			co_prev = mvert[ml[mp_totloop - 1].v].co;
-			for (j = 0; j < mp_totloop; j++, ml++) {
-				co_curr = mvert[ml->v].co;
-				add_newell_cross_v3_v3v3(normal, co_prev, co_curr);
-				co_prev = co_curr;
-			}
-			if (UNLIKELY(normalize_v3(normal) == 0.0f)) {
-				normal[2] = 1.0f;
-			}
+		/* calc normal, flipped: to get a positive 2d cross product */
+		ml = mloop + mp_loopstart;
+		co_prev = mvert[ml[mp_totloop - 1].v].co;
+		for (j = 0; j < mp_totloop; j++, ml++) {
+			co_curr = mvert[ml->v].co;
+			add_newell_cross_v3_v3v3(normal, co_prev, co_curr);
+			co_prev = co_curr;
+		}
+		if (UNLIKELY(normalize_v3(normal) == 0.0f)) {
+			normal[2] = 1.0f;
+		}
 
-			/* project verts to 2d */
-			axis_dominant_v3_to_m3_negate(axis_mat, normal);
+		/* project verts to 2d */
+		axis_dominant_v3_to_m3_negate(axis_mat, normal);
 
-			ml = mloop + mp_loopstart;
-			for (j = 0; j < mp_totloop; j++, ml++) {
-				mul_v2_m3v3(projverts[j], axis_mat, mvert[ml->v].co);
-			}
+		ml = mloop + mp_loopstart;
+		for (j = 0; j < mp_totloop; j++, ml++) {
+			mul_v2_m3v3(projverts[j], axis_mat, mvert[ml->v].co);
+		}
 
+		if (arena) {
 			BLI_polyfill_calc_arena((const float (*)[2])projverts, mp_totloop, 1, tris, arena);
+		}
+		else {
+			BLI_polyfill_calc((const float (*)[2])projverts, mp_totloop, 1, tris);
+		}
 
-			/* apply fill */
-			for (j = 0; j < totfilltri; j++) {
-				unsigned int *tri = tris[j];
+		/* apply fill */
+		for (j = 0; j < totfilltri; j++) {
+			unsigned int *tri = tris[j];
 
-				mlt = &mlooptri[mlooptri_index];
+			mlt = &mlooptri[mlooptri_index];
 
-				/* set loop indices, transformed to vert indices later */
-				l1 = mp_loopstart + tri[0];
-				l2 = mp_loopstart + tri[1];
-				l3 = mp_loopstart + tri[2];
+			/* set loop indices, transformed to vert indices later */
+			l1 = mp_loopstart + tri[0];
+			l2 = mp_loopstart + tri[1];
+			l3 = mp_loopstart + tri[2];
 
-				ARRAY_SET_ITEMS(mlt->tri, l1, l2, l3);
-				mlt->poly = (unsigned int)poly_index;
+			ARRAY_SET_ITEMS(mlt->tri, l1, l2, l3);
+			mlt->poly = (unsigned int)poly_index;
 
-				mlooptri_index++;
-			}
+			mlooptri_index++;
+		}
 
+		if (arena_local) {
+			BLI_memarena_free(arena_local);
+		}
+		else if (arena) {
 			BLI_memarena_clear(arena);
 		}
 	}
+}
 
-	if (arena) {
-		BLI_memarena_free(arena);
-		arena = NULL;
+typedef struct LoopTriTaskData {
+	const MLoop *mloop;
+	const MPoly *mpoly;
+	const MVert *mvert;
+	MLoopTri *mlooptri;
+	const int *poly_to_looptri;
+} LoopTriTaskData;
+
+static void mesh_recalc_looptri_cb(void *userdata, void *UNUSED(userdata_chunk), int poly_index)
+{
+	LoopTriTaskData *data = userdata;
+
+	mesh_recalc_looptri__single_poly(
+	        data->mloop, data->mpoly, data->mvert,
+	        poly_index, data->mlooptri, data->poly_to_looptri[poly_index], NULL);
+}
+
+/**
+ * Calculate tessellation into #MLoopTri which exist only for this purpose.
+ *
+ * Big meshes are tessellated in parallel, the triangles of each polygon follow those of the polygons before it.
+ */
+void BKE_mesh_recalc_looptri(
+        const MLoop *mloop, const MPoly *mpoly,
+        const MVert *mvert,
+        int totloop, int totpoly,
+        MLoopTri *mlooptri)
+{
+	int poly_index, mlooptri_index;
+
+	if (totpoly < LOOPTRI_TASK_MIN_POLYS) {
+		MemArena *arena = NULL;
+
+		mlooptri_index = 0;
+		for (poly_index = 0; poly_index < totpoly; poly_index++) {
+			const int mp_totloop = mpoly[poly_index].totloop;
+			if (mp_totloop >= 3) {
+				mesh_recalc_looptri__single_poly(mloop, mpoly, mvert, poly_index, mlooptri, mlooptri_index, &arena);
+				mlooptri_index += mp_totloop - 2;
+			}
+		}
+
+		if (arena) {
+			BLI_memarena_free(arena);
+		}
+	}
+	else {
+		LoopTriTaskData data;
+		int *poly_to_looptri = MEM_mallocN(sizeof(*poly_to_looptri) * (size_t)totpoly, __func__);
+
+		mlooptri_index = 0;
+		for (poly_index = 0; poly_index < totpoly; poly_index++) {
+			const int mp_totloop = mpoly[poly_index].totloop;
+			poly_to_looptri[poly_index] = mlooptri_index;
+			if (mp_totloop >= 3) {
+				mlooptri_index += mp_totloop - 2;
+			}
+		}
+
+		data.mloop = mloop;
+		data.mpoly = mpoly;
+		data.mvert = mvert;
+		data.mlooptri = mlooptri;
+		data.poly_to_looptri = poly_to_looptri;
+
+		BLI_task_parallel_range_ex(0, totpoly, &data, NULL, 0, mesh_recalc_looptri_cb, true, false);
+
+		MEM_freeN(poly_to_looptri);
 	}
 
 	BLI_assert(mlooptri_index == poly_to_tri_count(totpoly, totloop));
 	UNUSED_VARS_NDEBUG(totloop);
+}
 
 #undef USE_TESSFACE_SPEEDUP
-#undef ML_TO_MLT
-}
+#undef LOOPTRI_NGON_ALLOCA_MAX
+#undef LOOPTRI_TASK_MIN_POLYS
 
 /* -------------------------------------------------------------------- */
 
@@ -0,0 +1,1931 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/blenkernel/intern/mesh_import.c
+ *  \ingroup bke
+ *
+ * Reading of OBJ, PLY and STL files into a mesh, meant for very large scans
+ * where going through Python for every element is too slow.
+ *
+ * Files are memory mapped and split into chunks which are parsed in parallel:
+ * - Text formats first count vertices per chunk, so coordinates are parsed
+ *   directly into the final #MVert array, and faces are then parsed into per-chunk
+ *   loop arrays, which are joined into the #MLoop and #MPoly arrays.
+ * - Binary formats use fixed size records, which are split into ranges
+ *   (PLY faces need one pass over the list lengths first).
+ *
+ * Only geometry (and OBJ texture coordinates) is read, into a single mesh.
+ * Objects, groups, materials and custom normals are left to the Python importers.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef WIN32
+#  include <unistd.h>
+#  include <sys/mman.h>
+#else
+#  include <io.h>
+#  include "BLI_winstuff.h"
+#  include "mmap_win.h"
+#endif
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_endian_switch.h"
+#include "BLI_fileops.h"
+#include "BLI_math_vector.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "BLT_translation.h"
+
+#include "BKE_customdata.h"
+#include "BKE_global.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_import.h"  /* own include */
+#include "BKE_report.h"
+
+/* don't split text or records into smaller parts than this */
+#define IMPORT_CHUNK_SIZE_MIN (1 << 20)
+#define IMPORT_CHUNK_RECORDS_MIN (1 << 16)
+
+/* -------------------------------------------------------------------- */
+/** \name File Access
+ * \{ */
+
+typedef struct ImportFile {
+	const char *buf;
+	size_t size;
+	bool is_mapped;
+} ImportFile;
+
+/**
+ * Map the whole file, or read it into memory when it can't be mapped.
+ * \return false on failure, with errno set for system errors.
+ */
+static bool import_file_open(ImportFile *file, const char *filepath)
+{
+	size_t size;
+	int fd;
+
+	memset(file, 0, sizeof(*file));
+
+	fd = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+	if (fd == -1) {
+		return false;
+	}
+
+	size = BLI_file_descriptor_size(fd);
+	if ((size == (size_t)-1) || (size == 0)) {
+		close(fd);
+		return false;
+	}
+
+#ifdef WIN32
+	/* mmap_win passes the size as a 32 bit DWORD */
+	if (size <= UINT_MAX)
+#endif
+	{
+		void *mem = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mem != MAP_FAILED && mem != NULL) {
+			file->buf = mem;
+			file->is_mapped = true;
+		}
+	}
+
+	if (file->buf == NULL) {
+		char *mem = MEM_mapallocN(size, "mesh import file");
+		size_t done = 0;
+
+		while (done < size) {
+			const int len = (int)MIN2(size - done, (size_t)(1 << 30));
+			const int len_read = (int)read(fd, mem + done, len);
+			if (len_read <= 0) {
+				MEM_freeN(mem);
+				close(fd);
+				return false;
+			}
+			done += (size_t)len_read;
+		}
+		file->buf = mem;
+	}
+
+	/* the mapping stays valid after closing the file */
+	close(fd);
+	file->size = size;
+
+	return true;
+}
+
+static void import_file_close(ImportFile *file)
+{
+	if (file->is_mapped) {
+		munmap((void *)file->buf, file->size);
+	}
+	else if (file->buf) {
+		MEM_freeN((void *)file->buf);
+	}
+	file->buf = NULL;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Text Parsing
+ *
+ * Locale independent and bounded by the end of the buffer, since a mapped file isn't nil terminated.
+ * \{ */
+
+BLI_INLINE bool import_is_blank(const char c)
+{
+	/* backslash and newline are only found inside a line when an OBJ line is continued */
+	return ELEM(c, ' ', '\t', '\r', '\n', '\\');
+}
+
+BLI_INLINE bool import_is_digit(const char c)
+{
+	return (c >= '0' && c <= '9');
+}
+
+BLI_INLINE const char *import_skip_blank(const char *p, const char *end)
+{
+	while (p < end && import_is_blank(*p)) {
+		p++;
+	}
+	return p;
+}
+
+/* true when a number ends at \a p */
+BLI_INLINE bool import_is_token_end(const char *p, const char *end)
+{
+	return (p == end) || import_is_blank(*p);
+}
+
+/**
+ * End of the line starting at \a line (the newline, or \a end),
+ * with \a use_continue a backslash before the newline continues the line.
+ */
+static const char *import_line_end(const char *line, const char *end, const bool use_continue)
+{
+	const char *p = line;
+
+	while (p < end) {
+		const char *eol = memchr(p, '\n', (size_t)(end - p));
+		const char *last;
+
+		if (eol == NULL) {
+			return end;
+		}
+		if (!use_continue) {
+			return eol;
+		}
+
+		last = eol;
+		if (last > line && last[-1] == '\r') {
+			last--;
+		}
+		if (!(last > line && last[-1] == '\\')) {
+			return eol;
+		}
+		p = eol + 1;
+	}
+
+	return end;
+}
+
+static const double import_pow10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/**
+ * Parse a decimal number ([+-]digits[.digits][(e|E)[+-]digits]).
+ * \return the position after the number, NULL when there is none.
+ */
+static const char *import_parse_double(const char *p, const char *end, double *r_value)
+{
+	unsigned long long mantissa = 0;
+	int digits = 0, exponent = 0;
+	bool is_negative = false, is_number = false;
+	double value;
+
+	if (p < end && ELEM(*p, '-', '+')) {
+		is_negative = (*p == '-');
+		p++;
+	}
+
+	for (; p < end && import_is_digit(*p); p++) {
+		is_number = true;
+		if (digits < 19) {
+			mantissa = mantissa * 10 + (unsigned long long)(*p - '0');
+			if (mantissa != 0) {
+				digits++;
+			}
+		}
+		else {
+			exponent++;
+		}
+	}
+
+	if (p < end && *p == '.') {
+		for (p++; p < end && import_is_digit(*p); p++) {
+			is_number = true;
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (unsigned long long)(*p - '0');
+				if (mantissa != 0) {
+					digits++;
+				}
+				exponent--;
+			}
+		}
+	}
+
+	if (!is_number) {
+		return NULL;
+	}
+
+	if (p < end && ELEM(*p, 'e', 'E')) {
+		const char *q = p + 1;
+		bool is_exp_negative = false;
+		int exp = 0;
+
+		if (q < end && ELEM(*q, '-', '+')) {
+			is_exp_negative = (*q == '-');
+			q++;
+		}
+		if (q < end && import_is_digit(*q)) {
+			for (; q < end && import_is_digit(*q); q++) {
+				if (exp < 10000) {
+					exp = exp * 10 + (*q - '0');
+				}
+			}
+			exponent += is_exp_negative ? -exp : exp;
+			p = q;
+		}
+	}
+
+	value = (double)mantissa;
+	if (exponent != 0 && mantissa != 0) {
+		if (exponent > 0 && exponent < (int)ARRAY_SIZE(import_pow10)) {
+			value *= import_pow10[exponent];
+		}
+		else if (exponent < 0 && -exponent < (int)ARRAY_SIZE(import_pow10)) {
+			value /= import_pow10[-exponent];
+		}
+		else {
+			value *= pow(10.0, (double)exponent);
+		}
+	}
+
+	*r_value = is_negative ? -value : value;
+	return p;
+}
+
+static const char *import_parse_float(const char *p, const char *end, float *r_value)
+{
+	double value;
+	if ((p = import_parse_double(p, end, &value))) {
+		*r_value = (float)value;
+	}
+	return p;
+}
+
+/**
+ * Parse an integer ([+-]digits).
+ * \return the position after the number, NULL when there is none or it doesn't fit an int.
+ */
+static const char *import_parse_int(const char *p, const char *end, int *r_value)
+{
+	long long value = 0;
+	bool is_negative = false;
+	const char *digits;
+
+	if (p < end && ELEM(*p, '-', '+')) {
+		is_negative = (*p == '-');
+		p++;
+	}
+
+	for (digits = p; p < end && import_is_digit(*p); p++) {
+		value = value * 10 + (*p - '0');
+		if (value > INT_MAX) {
+			return NULL;
+		}
+	}
+
+	if (p == digits) {
+		return NULL;
+	}
+
+	*r_value = (int)(is_negative ? -value : value);
+	return p;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Chunks
+ * \{ */
+
+typedef struct ImportChunk {
+	const char *start, *end;
+
+	/* vertices (and OBJ texture coordinates) in this chunk, counted before parsing */
+	unsigned int vert_start, totvert;
+	unsigned int uv_start, totuv;
+
+	/* vertex (and OBJ texture coordinate, -1 for none) index for every loop */
+	int *loop_v, *loop_uv;
+	unsigned int totloop, loop_alloc;
+	/* number of loops of every polygon */
+	int *poly_len;
+	unsigned int totpoly, poly_alloc;
+	/* first loop and polygon in the mesh, set when joining chunks */
+	unsigned int loop_start, poly_start;
+
+	/* set when parsing failed, error_line may be NULL when the location isn't known */
+	const char *error_msg;
+	const char *error_line;
+} ImportChunk;
+
+static int import_chunks_num(const size_t size, const size_t size_min)
+{
+	const size_t num_max = (size_t)BLI_system_thread_count() * 4;
+	return (int)max_ii((int)MIN2(size / size_min, num_max), 1);
+}
+
+/**
+ * Split the text between \a start and \a end into chunks of whole lines.
+ */
+static ImportChunk *import_chunks_text(const char *start, const char *end, const bool use_continue, int *r_totchunk)
+{
+	const size_t size = (size_t)(end - start);
+	const int totchunk = import_chunks_num(size, IMPORT_CHUNK_SIZE_MIN);
+	ImportChunk *chunks = MEM_callocN(sizeof(*chunks) * (size_t)totchunk, __func__);
+	const char *p = start;
+	int i;
+
+	for (i = 0; i < totchunk; i++) {
+		const char *chunk_end = end;
+
+		if (i != totchunk - 1) {
+			chunk_end = start + (size_t)(((unsigned long long)size * (unsigned long long)(i + 1)) /
+			                             (unsigned long long)totchunk);
+			if (chunk_end < p) {
+				chunk_end = p;
+			}
+			chunk_end = import_line_end(chunk_end, end, use_continue);
+			if (chunk_end < end) {
+				chunk_end++;
+			}
+		}
+
+		chunks[i].start = p;
+		chunks[i].end = chunk_end;
+		p = chunk_end;
+	}
+
+	*r_totchunk = totchunk;
+	return chunks;
+}
+
+/**
+ * Split \a num fixed size records into ranges, stored as indices in \a start and \a end.
+ */
+static ImportChunk *import_chunks_records(const unsigned int num, int *r_totchunk)
+{
+	const int totchunk = import_chunks_num(num, IMPORT_CHUNK_RECORDS_MIN);
+	ImportChunk *chunks = MEM_callocN(sizeof(*chunks) * (size_t)totchunk, __func__);
+	int i;
+
+	for (i = 0; i < totchunk; i++) {
+		chunks[i].vert_start = (unsigned int)(((unsigned long long)num * (unsigned long long)i) /
+		                                      (unsigned long long)totchunk);
+		chunks[i].totvert = (unsigned int)(((unsigned long long)num * (unsigned long long)(i + 1)) /
+		                                   (unsigned long long)totchunk) - chunks[i].vert_start;
+	}
+
+	*r_totchunk = totchunk;
+	return chunks;
+}
+
+static void import_chunks_free(ImportChunk *chunks, const int totchunk)
+{
+	int i;
+
+	for (i = 0; i < totchunk; i++) {
+		MEM_SAFE_FREE(chunks[i].loop_v);
+		MEM_SAFE_FREE(chunks[i].loop_uv);
+		MEM_SAFE_FREE(chunks[i].poly_len);
+	}
+	MEM_freeN(chunks);
+}
+
+static void import_chunk_error(ImportChunk *chunk, const char *line, const char *msg)
+{
+	if (chunk->error_msg == NULL) {
+		chunk->error_line = line;
+		chunk->error_msg = msg;
+	}
+}
+
+/**
+ * Report the first error of all chunks.
+ * \return true when there was an error.
+ */
+static bool import_chunks_report_error(
+        const ImportChunk *chunks, const int totchunk,
+        const char *filepath, const ImportFile *file, ReportList *reports)
+{
+	int i;
+
+	for (i = 0; i < totchunk; i++) {
+		const ImportChunk *chunk = &chunks[i];
+
+		if (chunk->error_msg) {
+			if (chunk->error_line) {
+				const char *p;
+				unsigned int line_nr = 1;
+
+				for (p = file->buf; (p = memchr(p, '\n', (size_t)(chunk->error_line - p))); p++) {
+					line_nr++;
+				}
+				BKE_reportf(reports, RPT_ERROR, "Cannot read '%s', line %u: %s",
+				            filepath, line_nr, chunk->error_msg);
+			}
+			else {
+				BKE_reportf(reports, RPT_ERROR, "Cannot read '%s': %s", filepath, chunk->error_msg);
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+BLI_INLINE void import_chunk_loop_add(ImportChunk *chunk, const int v, const int uv)
+{
+	if (UNLIKELY(chunk->totloop == chunk->loop_alloc)) {
+		chunk->loop_alloc = MAX2(chunk->loop_alloc * 2, 1024u);
+		chunk->loop_v = MEM_reallocN(chunk->loop_v, sizeof(int) * chunk->loop_alloc);
+		if (chunk->loop_uv) {
+			chunk->loop_uv = MEM_reallocN(chunk->loop_uv, sizeof(int) * chunk->loop_alloc);
+		}
+	}
+
+	chunk->loop_v[chunk->totloop] = v;
+	if (chunk->loop_uv) {
+		chunk->loop_uv[chunk->totloop] = uv;
+	}
+	chunk->totloop++;
+}
+
+/**
+ * Add a polygon using the last \a len loops added, the loops are removed again for faces
+ * with less than 3 vertices.
+ */
+BLI_INLINE void import_chunk_poly_add(ImportChunk *chunk, const int len)
+{
+	if (len < 3) {
+		chunk->totloop -= (unsigned int)len;
+		return;
+	}
+
+	if (UNLIKELY(chunk->totpoly == chunk->poly_alloc)) {
+		chunk->poly_alloc = MAX2(chunk->poly_alloc * 2, 256u);
+		chunk->poly_len = MEM_reallocN(chunk->poly_len, sizeof(int) * chunk->poly_alloc);
+	}
+	chunk->poly_len[chunk->totpoly++] = len;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Mesh Creation
+ * \{ */
+
+typedef struct ImportPolysData {
+	ImportChunk *chunks;
+	unsigned int totvert, totuv;
+	const float (*uv)[2];
+
+	MLoop *mloop;
+	MPoly *mpoly;
+	MLoopUV *mloopuv;
+} ImportPolysData;
+
+static void import_polys_chunk_cb(void *userdata, void *UNUSED(userdata_chunk), int chunk_index)
+{
+	ImportPolysData *data = userdata;
+	ImportChunk *chunk = &data->chunks[chunk_index];
+	MLoop *ml = &data->mloop[chunk->loop_start];
+	MPoly *mp = &data->mpoly[chunk->poly_start];
+	unsigned int loopstart = chunk->loop_start;
+	unsigned int i;
+
+	for (i = 0; i < chunk->totpoly; i++, mp++) {
+		mp->loopstart = (int)loopstart;
+		mp->totloop = chunk->poly_len[i];
+		loopstart += (unsigned int)chunk->poly_len[i];
+	}
+
+	for (i = 0; i < chunk->totloop; i++, ml++) {
+		const int v = chunk->loop_v[i];
+		if ((v < 0) || ((unsigned int)v >= data->totvert)) {
+			import_chunk_error(chunk, NULL, N_("face vertex index out of range"));
+			return;
+		}
+		ml->v = (unsigned int)v;
+	}
+
+	if (data->mloopuv) {
+		MLoopUV *mluv = &data->mloopuv[chunk->loop_start];
+
+		for (i = 0; i < chunk->totloop; i++, mluv++) {
+			const int uv = chunk->loop_uv[i];
+			if (uv == -1) {
+				continue;
+			}
+			if ((uv < 0) || ((unsigned int)uv >= data->totuv)) {
+				import_chunk_error(chunk, NULL, N_("face texture coordinate index out of range"));
+				return;
+			}
+			copy_v2_v2(mluv->uv, data->uv[uv]);
+		}
+	}
+}
+
+/**
+ * Join the polygons of all chunks into mesh loop and polygon arrays,
+ * with \a uv, loop texture coordinates are created too.
+ *
+ * \return false on errors, which are stored in the chunks.
+ */
+static bool import_polys_from_chunks(
+        ImportChunk *chunks, const int totchunk,
+        const unsigned int totvert, const float (*uv)[2], const unsigned int totuv,
+        MLoop **r_mloop, unsigned int *r_totloop,
+        MPoly **r_mpoly, unsigned int *r_totpoly,
+        MLoopUV **r_mloopuv)
+{
+	ImportPolysData data;
+	unsigned long long totloop = 0, totpoly = 0;
+	bool use_uv = false;
+	int i;
+
+	for (i = 0; i < totchunk; i++) {
+		chunks[i].loop_start = (unsigned int)totloop;
+		chunks[i].poly_start = (unsigned int)totpoly;
+		totloop += chunks[i].totloop;
+		totpoly += chunks[i].totpoly;
+
+		if (uv && chunks[i].loop_uv) {
+			unsigned int l;
+			for (l = 0; l < chunks[i].totloop && !use_uv; l++) {
+				use_uv = (chunks[i].loop_uv[l] != -1);
+			}
+		}
+	}
+
+	if (totloop > INT_MAX) {
+		import_chunk_error(&chunks[0], NULL, N_("too many faces"));
+		return false;
+	}
+
+	data.chunks = chunks;
+	data.totvert = totvert;
+	data.totuv = totuv;
+	data.uv = uv;
+	data.mloop = MEM_callocN(sizeof(MLoop) * MAX2(totloop, 1), "mesh import loops");
+	data.mpoly = MEM_callocN(sizeof(MPoly) * MAX2(totpoly, 1), "mesh import polys");
+	data.mloopuv = use_uv ? MEM_callocN(sizeof(MLoopUV) * MAX2(totloop, 1), "mesh import uvs") : NULL;
+
+	BLI_task_parallel_range_ex(0, totchunk, &data, NULL, 0, import_polys_chunk_cb, totchunk > 1, false);
+
+	for (i = 0; i < totchunk; i++) {
+		if (chunks[i].error_msg) {
+			MEM_freeN(data.mloop);
+			MEM_freeN(data.mpoly);
+			MEM_SAFE_FREE(data.mloopuv);
+			return false;
+		}
+	}
+
+	*r_mloop = data.mloop;
+	*r_totloop = (unsigned int)totloop;
+	*r_mpoly = data.mpoly;
+	*r_totpoly = (unsigned int)totpoly;
+	*r_mloopuv = data.mloopuv;
+	return true;
+}
+
+/**
+ * Create a mesh named after the file, taking ownership of the arrays.
+ */
+static Mesh *import_mesh_create(
+        Main *bmain, const char *filepath,
+        MVert *mvert, const unsigned int totvert,
+        MLoop *mloop, const unsigned int totloop,
+        MPoly *mpoly, const unsigned int totpoly,
+        MLoopUV *mloopuv)
+{
+	char name[MAX_ID_NAME - 2];
+	Mesh *me;
+
+	BLI_strncpy(name, BLI_path_basename(filepath), sizeof(name));
+	BLI_replace_extension(name, sizeof(name), "");
+
+	me = BKE_mesh_add(bmain, name);
+
+	me->totvert = (int)totvert;
+	me->totloop = (int)totloop;
+	me->totpoly = (int)totpoly;
+	CustomData_add_layer(&me->vdata, CD_MVERT, CD_ASSIGN, mvert, me->totvert);
+	CustomData_add_layer(&me->ldata, CD_MLOOP, CD_ASSIGN, mloop, me->totloop);
+	CustomData_add_layer(&me->pdata, CD_MPOLY, CD_ASSIGN, mpoly, me->totpoly);
+	if (mloopuv) {
+		CustomData_add_layer_named(&me->pdata, CD_MTEXPOLY, CD_DEFAULT, NULL, me->totpoly, DATA_("UVMap"));
+		CustomData_add_layer_named(&me->ldata, CD_MLOOPUV, CD_ASSIGN, mloopuv, me->totloop, DATA_("UVMap"));
+	}
+	BKE_mesh_update_customdata_pointers(me, false);
+
+	BKE_mesh_calc_edges(me, false, false);
+	/* normals first, validating would otherwise 'fix' every zero normal */
+	BKE_mesh_calc_normals(me);
+	/* removes degenerate faces, out of range indices are already refused while reading */
+	BKE_mesh_validate(me, false, false);
+
+	return me;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name OBJ
+ * \{ */
+
+enum {
+	OBJ_LINE_OTHER = 0,
+	OBJ_LINE_V,
+	OBJ_LINE_VT,
+	OBJ_LINE_F,
+};
+
+static int obj_line_type(const char *p, const char *eol, const char **r_args)
+{
+	while (p < eol && ELEM(*p, ' ', '\t')) {
+		p++;
+	}
+
+	if ((eol - p >= 2) && (p[0] == 'v') && ELEM(p[1], ' ', '\t')) {
+		*r_args = p + 2;
+		return OBJ_LINE_V;
+	}
+	else if ((eol - p >= 3) && (p[0] == 'v') && (p[1] == 't') && ELEM(p[2], ' ', '\t')) {
+		*r_args = p + 3;
+		return OBJ_LINE_VT;
+	}
+	else if ((eol - p >= 2) && (p[0] == 'f') && ELEM(p[1], ' ', '\t')) {
+		*r_args = p + 2;
+		return OBJ_LINE_F;
+	}
+
+	return OBJ_LINE_OTHER;
+}
+
+typedef struct OBJImportData {
+	ImportChunk *chunks;
+	MVert *mvert;
+	float (*uv)[2];
+} OBJImportData;
+
+static void obj_count_chunk_cb(void *userdata, void *UNUSED(userdata_chunk), int chunk_index)
+{
+	OBJImportData *data = userdata;
+	ImportChunk *chunk = &data->chunks[chunk_index];
+	const char *line, *eol, *args;
+
+	for (line = chunk->start; line < chunk->end; line = eol + 1) {
+		eol = import_line_end(line, chunk->end, true);
+
+		switch (obj_line_type(line, eol, &args)) {
+			case OBJ_LINE_V:
+				chunk->totvert++;
+				break;
+			case OBJ_LINE_VT:
+				chunk->totuv++;
+				break;
+		}
+	}
+}
+
+/**
+ * Resolve an OBJ index (1 based, or negative relative to the number of elements read so far),
+ * may return an out of range index, checked when joining the chunks.
+ */
+BLI_INLINE int obj_index_resolve(const int index, const unsigned int num_read)
+{
+	return (index > 0) ? (index - 1) : ((int)num_read + index);
+}
+
+static void obj_parse_chunk_cb(void *userdata, void *UNUSED(userdata_chunk), int chunk_index)
+{
+	OBJImportData *data = userdata;
+	ImportChunk *chunk = &data->chunks[chunk_index];
+	unsigned int vert_index = chunk->vert_start;
+	unsigned int uv_index = chunk->uv_start;
+	const char *line, *eol, *args, *p;
+
+	/* rough guess, around 4 loops for every 40 bytes of face line */
+	chunk->loop_alloc = (unsigned int)MAX2((chunk->end - chunk->start) / 10, 1024);
+	chunk->loop_v = MEM_mallocN(sizeof(int) * chunk->loop_alloc, "obj import loops");
+	chunk->loop_uv = MEM_mallocN(sizeof(int) * chunk->loop_alloc, "obj import loop uvs");
+
+	for (line = chunk->start; line < chunk->end; line = eol + 1) {
+		eol = import_line_end(line, chunk->end, true);
+
+		switch (obj_line_type(line, eol, &args)) {
+			case OBJ_LINE_V:
+			{
+				float co[3];
+				int i;
+
+				for (i = 0, p = args; i < 3; i++) {
+					p = import_skip_blank(p, eol);
+					if (!(p = import_parse_float(p, eol, &co[i])) || !import_is_token_end(p, eol)) {
+						import_chunk_error(chunk, line, N_("invalid vertex"));
+						return;
+					}
+				}
+				copy_v3_v3(data->mvert[vert_index++].co, co);
+				break;
+			}
+			case OBJ_LINE_VT:
+			{
+				float uv[2] = {0.0f, 0.0f};
+
+				p = import_skip_blank(args, eol);
+				if (!(p = import_parse_float(p, eol, &uv[0])) || !import_is_token_end(p, eol)) {
+					import_chunk_error(chunk, line, N_("invalid texture coordinate"));
+					return;
+				}
+				/* the second coordinate is optional */
+				p = import_skip_blank(p, eol);
+				if (p < eol && (!(p = import_parse_float(p, eol, &uv[1])) || !import_is_token_end(p, eol))) {
+					import_chunk_error(chunk, line, N_("invalid texture coordinate"));
+					return;
+				}
+				copy_v2_v2(data->uv[uv_index++], uv);
+				break;
+			}
+			case OBJ_LINE_F:
+			{
+				int len = 0;
+
+				/* v, v/vt, v/vt/vn or v//vn */
+				for (p = import_skip_blank(args, eol); p < eol; p = import_skip_blank(p, eol)) {
+					int v, vt = 0, vn;
+
+					if (!(p = import_parse_int(p, eol, &v)) || (v == 0)) {
+						import_chunk_error(chunk, line, N_("invalid face"));
+						return;
+					}
+					if (p < eol && *p == '/') {
+						p++;
+						if (p < eol && *p != '/') {
+							if (!(p = import_parse_int(p, eol, &vt)) || (vt == 0)) {
+								import_chunk_error(chunk, line, N_("invalid face"));
+								return;
+							}
+						}
+						if (p < eol && *p == '/') {
+							p++;
+							if (!(p = import_parse_int(p, eol, &vn))) {
+								import_chunk_error(chunk, line, N_("invalid face"));
+								return;
+							}
+						}
+					}
+					if (!import_is_token_end(p, eol)) {
+						import_chunk_error(chunk, line, N_("invalid face"));
+						return;
+					}
+
+					import_chunk_loop_add(chunk, obj_index_resolve(v, vert_index),
+					                      vt ? obj_index_resolve(vt, uv_index) : -1);
+					len++;
+				}
+				import_chunk_poly_add(chunk, len);
+				break;
+			}
+		}
+	}
+}
+
+static Mesh *obj_import(Main *bmain, const char *filepath, const ImportFile *file, ReportList *reports)
+{
+	OBJImportData data;
+	ImportChunk *chunks;
+	MLoop *mloop;
+	MPoly *mpoly;
+	MLoopUV *mloopuv;
+	unsigned long long totvert = 0, totuv = 0;
+	unsigned int totloop, totpoly;
+	int totchunk, i;
+	Mesh *me = NULL;
+
+	chunks = import_chunks_text(file->buf, file->buf + file->size, true, &totchunk);
+	data.chunks = chunks;
+
+	/* count, to parse vertices into their final place */
+	BLI_task_parallel_range_ex(0, totchunk, &data, NULL, 0, obj_count_chunk_cb, totchunk > 1, false);
+
+	for (i = 0; i < totchunk; i++) {
+		chunks[i].vert_start = (unsigned int)totvert;
+		chunks[i].uv_start = (unsigned int)totuv;
+		totvert += chunks[i].totvert;
+		totuv += chunks[i].totuv;
+	}
+
+	if (totvert == 0) {
+		BKE_reportf(reports, RPT_ERROR, "Cannot read '%s': %s", filepath, TIP_("no vertices found"));
+		import_chunks_free(chunks, totchunk);
+		return NULL;
+	}
+	if (totvert > INT_MAX || totuv > INT_MAX) {
+		BKE_reportf(reports, RPT_ERROR, "Cannot read '%s': %s", filepath, TIP_("too many vertices"));
+		import_chunks_free(chunks, totchunk);
+		return NULL;
+	}
+
+	data.mvert = MEM_callocN(sizeof(MVert) * totvert, "obj import verts");
+	data.uv = MEM_mallocN(sizeof(*data.uv) * MAX2(totuv, 1), "obj import uvs");
+
+	BLI_task_parallel_range_ex(0, totchunk, &data, NULL, 0, obj_parse_chunk_cb, totchunk > 1, true);
+
+	if (import_chunks_report_error(chunks, totchunk, filepath, file, reports) ||
+	    !import_polys_from_chunks(chunks, totchunk, (unsigned int)totvert,
+	                              (const float (*)[2])data.uv, (unsigned int)totuv,
+	                              &mloop, &totloop, &mpoly, &totpoly, &mloopuv))
+	{
+		import_chunks_report_error(chunks, totchunk, filepath, file, reports);
+		MEM_freeN(data.mvert);
+	}
+	else {
+		me = import_mesh_create(bmain, filepath, data.mvert, (unsigned int)totvert,
+		                        mloop, totloop, mpoly, totpoly, mloopuv);
+	}
+
+	MEM_freeN(data.uv);
+	import_chunks_free(chunks, totchunk);
+
+	return me;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name PLY
+ * \{ */
+
+enum {
+	PLY_ASCII = 0,
+	PLY_BINARY_LE,
+	PLY_BINARY_BE,
+};
+
+enum {
+	PLY_CHAR = 0,
+	PLY_UCHAR,
+	PLY_SHORT,
+	PLY_USHORT,
+	PLY_INT,
+	PLY_UINT,
+	PLY_FLOAT,
+	PLY_DOUBLE,
+};
+
+static const struct {
+	const char *name, *name_alt;
+	int size;
+} ply_types[] = {
+	{"char", "int8", 1},
+	{"uchar", "uint8", 1},
+	{"short", "int16", 2},
+	{"ushort", "uint16", 2},
+	{"int", "int32", 4},
+	{"uint", "uint32", 4},
+	{"float", "float32", 4},
+	{"double", "float64", 8},
+};
+
+#define PLY_ELEMS_MAX 16
+#define PLY_PROPS_MAX 64
+
+typedef struct PLYProperty {
+	char name[64];
+	int type;
+	/* type of the list length, -1 for scalar properties */
+	int len_type;
+	/* byte offset in binary elements without lists */
+	int offset;
+} PLYProperty;
+
+typedef struct PLYElement {
+	char name[64];
+	unsigned int num;
+	PLYProperty props[PLY_PROPS_MAX];
+	int totprop;
+	/* size of binary elements, 0 when there are lists */
+	int stride;
+} PLYElement;
+
+typedef struct PLYHeader {
+	int format;
+	PLYElement elems[PLY_ELEMS_MAX];
+	int totelem;
+	/* start of the element data */
+	const char *body;
+} PLYHeader;
+
+static int ply_type_find(const char *name)
+{
+	int i;
+
+	for (i = 0; i < (int)ARRAY_SIZE(ply_types); i++) {
+		if (STREQ(name, ply_types[i].name) || STREQ(name, ply_types[i].name_alt)) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/**
+ * \return an error message, NULL on success.
+ */
+static const char *ply_header_parse(const ImportFile *file, PLYHeader *header)
+{
+	const char *end = file->buf + file->size;
+	const char *line, *eol;
+	bool has_format = false;
+
+	memset(header, 0, sizeof(*header));
+
+	if (file->size < 4 || !STREQLEN(file->buf, "ply", 3) || !ELEM(file->buf[3], '\n', '\r')) {
+		return N_("not a PLY file");
+	}
+
+	for (line = file->buf; line < end; line = eol + 1) {
+		char buf[256], word[3][64];
+		unsigned int num;
+
+		eol = import_line_end(line, end, false);
+		BLI_strncpy(buf, line, (size_t)MIN2(eol - line + 1, (ptrdiff_t)sizeof(buf)));
+
+		if (STREQLEN(buf, "end_header", 10)) {
+			header->body = eol + 1;
+			break;
+		}
+		else if (sscanf(buf, "format %63s", word[0]) == 1) {
+			if (STREQ(word[0], "ascii")) {
+				header->format = PLY_ASCII;
+			}
+			else if (STREQ(word[0], "binary_little_endian")) {
+				header->format = PLY_BINARY_LE;
+			}
+			else if (STREQ(word[0], "binary_big_endian")) {
+				header->format = PLY_BINARY_BE;
+			}
+			else {
+				return N_("unknown PLY format");
+			}
+			has_format = true;
+		}
+		else if (sscanf(buf, "element %63s %u", word[0], &num) == 2) {
+			PLYElement *elem;
+
+			if (header->totelem == PLY_ELEMS_MAX) {
+				return N_("too many PLY elements");
+			}
+			elem = &header->elems[header->totelem++];
+			BLI_strncpy(elem->name, word[0], sizeof(elem->name));
+			elem->num = num;
+		}
+		else if (sscanf(buf, "property list %63s %63s %63s", word[0], word[1], word[2]) == 3) {
+			PLYElement *elem = header->totelem ? &header->elems[header->totelem - 1] : NULL;
+			PLYProperty *prop;
+
+			if (elem == NULL || elem->totprop == PLY_PROPS_MAX) {
+				return N_("invalid PLY property");
+			}
+			prop = &elem->props[elem->totprop++];
+			BLI_strncpy(prop->name, word[2], sizeof(prop->name));
+			prop->len_type = ply_type_find(word[0]);
+			prop->type = ply_type_find(word[1]);
+			if (prop->len_type == -1 || prop->type == -1) {
+				return N_("unknown PLY property type");
+			}
+		}
+		else if (sscanf(buf, "property %63s %63s", word[0], word[1]) == 2) {
+			PLYElement *elem = header->totelem ? &header->elems[header->totelem - 1] : NULL;
+			PLYProperty *prop;
+
+			if (elem == NULL || elem->totprop == PLY_PROPS_MAX) {
+				return N_("invalid PLY property");
+			}
+			prop = &elem->props[elem->totprop++];
+			BLI_strncpy(prop->name, word[1], sizeof(prop->name));
+			prop->len_type = -1;
+			prop->type = ply_type_find(word[0]);
+			if (prop->type == -1) {
+				return N_("unknown PLY property type");
+			}
+		}
+		/* 'comment', 'obj_info' and the first line are skipped */
+	}
+
+	if (header->body == NULL || !has_format) {
+		return N_("invalid PLY header");
+	}
+
+	/* binary layout */
+	{
+		int i, j;
+
+		for (i = 0; i < header->totelem; i++) {
+			PLYElement *elem = &header->elems[i];
+			int offset = 0;
+
+			for (j = 0; j < elem->totprop; j++) {
+				if (elem->props[j].len_type != -1) {
+					offset = 0;
+					break;
+				}
+				elem->props[j].offset = offset;
+				offset += ply_types[elem->props[j].type].size;
+			}
+			elem->stride = offset;
+		}
+	}
+
+	return NULL;
+}
+
+static int ply_property_find(const PLYElement *elem, const char *name, const char *name_alt)
+{
+	int i;
+
+	for (i = 0; i < elem->totprop; i++) {
+		if (STREQ(elem->props[i].name, name) || (name_alt && STREQ(elem->props[i].name, name_alt))) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+BLI_INLINE double ply_read_binary(const char *p, const int type, const bool use_swap)
+{
+	switch (type) {
+		case PLY_CHAR:
+			return (double)*(const signed char *)p;
+		case PLY_UCHAR:
+			return (double)*(const unsigned char *)p;
+		case PLY_SHORT:
+		{
+			short value;
+			memcpy(&value, p, sizeof(value));
+			if (use_swap) BLI_endian_switch_int16(&value);
+			return (double)value;
+		}
+		case PLY_USHORT:
+		{
+			unsigned short value;
+			memcpy(&value, p, sizeof(value));
+			if (use_swap) BLI_endian_switch_uint16(&value);
+			return (double)value;
+		}
+		case PLY_INT:
+		{
+			int value;
+			memcpy(&value, p, sizeof(value));
+			if (use_swap) BLI_endian_switch_int32(&value);
+			return (double)value;
+		}
+		case PLY_UINT:
+		{
+			unsigned int value;
+			memcpy(&value, p, sizeof(value));
+			if (use_swap) BLI_endian_switch_uint32(&value);
+			return (double)value;
+		}
+		case PLY_FLOAT:
+		{
+			float value;
+			memcpy(&value, p, sizeof(value));
+			if (use_swap) BLI_endian_switch_float(&value);
+			return (double)value;
+		}
+		case PLY_DOUBLE:
+		{
+			double value;
+			memcpy(&value, p, sizeof(value));
+			if (use_swap) BLI_endian_switch_double(&value);
+			return value;
+		}
+	}
+
+	BLI_assert(0);
+	return 0.0;
+}
+
+/**
+ * Size of one binary element starting at \a p, or 0 when it doesn't fit before \a end.
+ */
+static size_t ply_binary_element_size(const PLYElement *elem, const char *p, const char *end, const bool use_swap)
+{
+	const char *start = p;
+	int i;
+
+	if (elem->stride) {
+		return ((size_t)(end - p) >= (size_t)elem->stride) ? (size_t)elem->stride : 0;
+	}
+
+	for (i = 0; i < elem->totprop; i++) {
+		const PLYProperty *prop = &elem->props[i];
+
+		if (prop->len_type == -1) {
+			p += ply_types[prop->type].size;
+		}
+		else {
+			double len;
+
+			if (end - p < ply_types[prop->len_type].size) {
+				return 0;
+			}
+			len = ply_read_binary(p, prop->len_type, use_swap);
+			if (len < 0.0) {
+				return 0;
+			}
+			p += ply_types[prop->len_type].size + (size_t)len * (size_t)ply_types[prop->type].size;
+		}
+		if (p > end) {
+			return 0;
+		}
+	}
+
+	return (size_t)(p - start);
+}
+
+typedef struct PLYImportData {
+	const PLYHeader *header;
+	const PLYElement *vert_elem, *face_elem;
+	int prop_xyz[3];
+	int prop_index;
+	bool use_swap;
+
+	ImportChunk *chunks;
+	const char *vert_data;
+	unsigned int totvert;
+
+	MVert *mvert;
+	MLoop *mloop;
+	MPoly *mpoly;
+} PLYImportData;
+
+/* binary vertices, in ranges of the vertex element */
+static void ply_binary_verts_chunk_cb(void *userdata, void *UNUSED(userdata_chunk), int chunk_index)
+{
+	PLYImportData *data = userdata;
+	const ImportChunk *chunk = &data->chunks[chunk_index];
+	const PLYElement *elem = data->vert_elem;
+	unsigned int i;
+	int j;
+
+	for (i = chunk->vert_start; i < chunk->vert_start + chunk->totvert; i++) {
+		const char *p = data->vert_data + (size_t)i * (size_t)elem->stride;
+		float co[3];
+
+		for (j = 0; j < 3; j++) {
+			const PLYProperty *prop = &elem->props[data->prop_xyz[j]];
+			co[j] = (float)ply_read_binary(p + prop->offset, prop->type, data->use_swap);
+		}
+		copy_v3_v3(data->mvert[i].co, co);
+	}
+}
+
+/* binary faces, chunks start at a known byte offset, first polygon and first loop */
+static void ply_binary_faces_chunk_cb(void *userdata, void *UNUSED(userdata_chunk), int chunk_index)
+{
+	PLYImportData *data = userdata;
+	ImportChunk *chunk = &data->chunks[chunk_index];
+	const PLYElement *elem = data->face_elem;
+	const char *p = chunk->start;
+	MPoly *mp = &data->mpoly[chunk->poly_start];
+	MLoop *ml = &data->mloop[chunk->loop_start];
+	unsigned int loopstart = chunk->loop_start;
+	unsigned int f;
+	int i;
+
+	/* 'totvert' is the number of faces for face chunks */
+	for (f = 0; f < chunk->totvert; f++) {
+		for (i = 0; i < elem->totprop; i++) {
+			const PLYProperty *prop = &elem->props[i];
+			const int size = ply_types[prop->type].size;
+
+			if (prop->len_type == -1) {
+				p += size;
+			}
+			else {
+				const int len = (int)ply_read_binary(p, prop->len_type, data->use_swap);
+				int l;
+
+				p += ply_types[prop->len_type].size;
+
+				if (i == data->prop_index && len >= 3) {
+					for (l = 0; l < len; l++, p += size, ml++) {
+						const double v = ply_read_binary(p, prop->type, data->use_swap);
+						if (!(v >= 0.0 && v < (double)data->totvert)) {
+							import_chunk_error(chunk, NULL, N_("face vertex index out of range"));
+							return;
+						}
+						ml->v = (unsigned int)v;
+					}
+					mp->loopstart = (int)loopstart;
+					mp->totloop = len;
+					loopstart += (unsigned int)len;
+					mp++;
+				}
+				else {
+					p += (size_t)len * (size_t)size;
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Binary faces have a variable size, walk over them once to split them into chunks
+ * which can be decoded in parallel, counting polygons and loops.
+ *
+ * \return the end of the faces, NULL on errors.
+ */
+static const char *ply_binary_faces_split(
+        PLYImportData *data, const char *p, const char *end,
+        ImportChunk **r_chunks, int *r_totchunk, unsigned int *r_totloop, unsigned int *r_totpoly)
+{
+	const PLYElement *elem = data->face_elem;
+	ImportChunk *chunks;
+	unsigned long long totloop = 0;
+	unsigned int totpoly = 0, n;
+	int totchunk, c = 0;
+
+	chunks = import_chunks_records(elem->num, &totchunk);
+
+	for (n = 0; n < elem->num; n++) {
+		const char *q = p;
+		size_t size;
+		int i;
+
+		while (n == chunks[c].vert_start + chunks[c].totvert) {
+			c++;
+		}
+		if (n == chunks[c].vert_start) {
+			chunks[c].start = p;
+			chunks[c].loop_start = (unsigned int)MIN2(totloop, UINT_MAX);
+			chunks[c].poly_start = totpoly;
+		}
+
+		if ((size = ply_binary_element_size(elem, p, end, data->use_swap)) == 0) {
+			import_chunks_free(chunks, totchunk);
+			return NULL;
+		}
+
+		for (i = 0; i < elem->totprop; i++) {
+			const PLYProperty *prop = &elem->props[i];
+
+			if (prop->len_type == -1) {
+				q += ply_types[prop->type].size;
+			}
+			else {
+				const int len = (int)ply_read_binary(q, prop->len_type, data->use_swap);
+				if (i == data->prop_index && len >= 3) {
+					totloop += (unsigned int)len;
+					totpoly++;
+				}
+				q += ply_types[prop->len_type].size + (size_t)len * (size_t)ply_types[prop->type].size;
+			}
+		}
+
+		p += size;
+	}
+
+	*r_chunks = chunks;
+	*r_totchunk = totchunk;
+	*r_totloop = (unsigned int)MIN2(totloop, UINT_MAX);
+	*r_totpoly = totpoly;
+	return p;
+}
+
+/* ascii elements, one per line */
+static void ply_ascii_count_chunk_cb(void *userdata, void *UNUSED(userdata_chunk), int chunk_index)
+{
+	PLYImportData *data = userdata;
+	ImportChunk *chunk = &data->chunks[chunk_index];
+	const char *line, *eol;
+
+	for (line = chunk->start; line < chunk->end; line = eol + 1) {
+		eol = import_line_end(line, chunk->end, false);
+		chunk->totvert++;
+	}
+}
+
+/**
+ * Parse an ascii element line, storing the first value of every property in \a r_values,
+ * with \a chunk, items of the list property \a prop_loops are added as loops.
+ *
+ * \return the number of loops added, -1 on errors.
+ */
+static int ply_ascii_line_parse(
+        const PLYElement *elem, const char *p, const char *eol,
+        double r_values[PLY_PROPS_MAX], const int prop_loops, ImportChunk *chunk)
+{
+	int len_loops = 0;
+	int i;
+
+	for (i = 0; i < elem->totprop; i++) {
+		const bool is_loops = (i == prop_loops) && chunk;
+		double value = 0.0;
+		int len = 1, l;
+
+		if (elem->props[i].len_type != -1) {
+			p = import_skip_blank(p, eol);
+			if (!(p = import_parse_double(p, eol, &value)) || !import_is_token_end(p, eol)) {
+				return -1;
+			}
+			len = (int)value;
+		}
+
+		for (l = 0; l < len; l++) {
+			p = import_skip_blank(p, eol);
+			if (!(p = import_parse_double(p, eol, &value)) || !import_is_token_end(p, eol)) {
+				return -1;
+			}
+			if (l == 0) {
+				r_values[i] = value;
+			}
+			if (is_loops) {
+				/* range is checked when joining chunks */
+				import_chunk_loop_add(chunk, (value >= 0.0 && value <= (double)INT_MAX) ? (int)value : -1, -1);
+				len_loops++;
+			}
+		}
+	}
+
+	return len_loops;
+}
+
+static void ply_ascii_verts_chunk_cb(void *userdata, void *UNUSED(userdata_chunk), int chunk_index)
+{
+	PLYImportData *data = userdata;
+	ImportChunk *chunk = &data->chunks[chunk_index];
+	const PLYElement *elem = data->vert_elem;
+	unsigned int vert_index = chunk->vert_start;
+	const char *line, *eol;
+	double values[PLY_PROPS_MAX];
+
+	for (line = chunk->start; line < chunk->end; line = eol + 1) {
+		MVert *mv = &data->mvert[vert_index++];
+
+		eol = import_line_end(line, chunk->end, false);
+
+		if (ply_ascii_line_parse(elem, line, eol, values, -1, NULL) == -1) {
+			import_chunk_error(chunk, line, N_("invalid vertex"));
+			return;
+		}
+		mv->co[0] = (float)values[data->prop_xyz[0]];
+		mv->co[1] = (float)values[data->prop_xyz[1]];
+		mv->co[2] = (float)values[data->prop_xyz[2]];
+	}
+}
+
+static void ply_ascii_faces_chunk_cb(void *userdata, void *UNUSED(userdata_chunk), int chunk_index)
+{
+	PLYImportData *data = userdata;
+	ImportChunk *chunk = &data->chunks[chunk_index];
+	const PLYElement *elem = data->face_elem;
+	const char *line, *eol;
+	double values[PLY_PROPS_MAX];
+
+	chunk->loop_alloc = (unsigned int)MAX2((chunk->end - chunk->start) / 4, 1024);
+	chunk->loop_v = MEM_mallocN(sizeof(int) * chunk->loop_alloc, "ply import loops");
+
+	for (line = chunk->start; line < chunk->end; line = eol + 1) {
+		int len;
+
+		eol = import_line_end(line, chunk->end, false);
+
+		if ((len = ply_ascii_line_parse(elem, line, eol, values, data->prop_index, chunk)) == -1) {
+			import_chunk_error(chunk, line, N_("invalid face"));
+			return;
+		}
+		import_chunk_poly_add(chunk, len);
+	}
+}
+
+static Mesh *ply_import(Main *bmain, const char *filepath, const ImportFile *file, ReportList *reports)
+{
+	const char *end = file->buf + file->size;
+	const char *error = NULL;
+	const char *vert_start = NULL, *vert_end = NULL, *face_start = NULL, *face_end = NULL;
+	PLYHeader header;
+	PLYImportData data;
+	ImportChunk *face_chunks = NULL;
+	MLoop *mloop = NULL;
+	MPoly *mpoly = NULL;
+	MLoopUV *mloopuv = NULL;
+	unsigned int totloop = 0, totpoly = 0;
+	int totchunk, face_totchunk = 0, i, j;
+	const char *p;
+	Mesh *me = NULL;
+
+	if ((error = ply_header_parse(file, &header))) {
+		BKE_reportf(reports, RPT_ERROR, "Cannot read '%s': %s", filepath, TIP_(error));
+		return NULL;
+	}
+
+	memset(&data, 0, sizeof(data));
+	data.header = &header;
+	data.use_swap = (header.format == PLY_BINARY_BE) != (ENDIAN_ORDER == B_ENDIAN);
+	data.prop_index = -1;
+
+	for (i = 0; i < header.totelem; i++) {
+		if (STREQ(header.elems[i].name, "vertex")) {
+			data.vert_elem = &header.elems[i];
+		}
+		else if (STREQ(header.elems[i].name, "face")) {
+			data.face_elem = &header.elems[i];
+		}
+	}
+
+	if (data.vert_elem == NULL || data.vert_elem->num == 0) {
+		BKE_reportf(reports, RPT_ERROR, "Cannot read '%s': %s", filepath, TIP_("no vertices found"));
+		return NULL;
+	}
+	for (j = 0; j < 3; j++) {
+		const char *names[3] = {"x", "y", "z"};
+		data.prop_xyz[j] = ply_property_find(data.vert_elem, names[j], NULL);
+		if (data.prop_xyz[j] == -1 || data.vert_elem->props[data.prop_xyz[j]].len_type != -1) {
+			BKE_reportf(reports, RPT_ERROR, "Cannot read '%s': %s", filepath, TIP_("vertex coordinates not found"));
+			return NULL;
+		}
+	}
+	if (header.format != PLY_ASCII && data.vert_elem->stride == 0) {
+		BKE_reportf(reports, RPT_ERROR, "Cannot read '%s': %s", filepath, TIP_("unsupported vertex list property"));
+		return NULL;
+	}
+	if (data.face_elem) {
+		data.prop_index = ply_property_find(data.face_elem, "vertex_indices", "vertex_index");
+		if (data.prop_index != -1 && data.face_elem->props[data.prop_index].len_type == -1) {
+			data.prop_index = -1;
+		}
+	}
+	data.totvert = data.vert_elem->num;
+
+	if (data.totvert > INT_MAX) {
+		BKE_reportf(reports, RPT_ERROR, "Cannot read '%s': %s", filepath, TIP_("too many vertices"));
+		return NULL;
+	}
+
+	/* find where the elements are */
+	p = header.body;
+	for (i = 0; i < header.totelem && !error; i++) {
+		const PLYElement *elem = &header.elems[i];
+		const char *elem_start = p;
+		unsigned int n;
+
+		if (header.format == PLY_ASCII) {
+			for (n = 0; n < elem->num; n++) {
+				if (p >= end) {
+					error = N_("unexpected end of file");
+					break;
+				}
+				p = import_line_end(p, end, false);
+				if (p < end) {
+					p++;
+				}
+			}
+		}
+		else if (elem->stride) {
+			if ((size_t)(end - p) / (size_t)elem->stride < elem->num) {
+				error = N_("unexpected end of file");
+			}
+			else {
+				p += (size_t)elem->num * (size_t)elem->stride;
+			}
+		}
+		else if (elem == data.face_elem) {
+			if (!(p = ply_binary_faces_split(&data, p, end, &face_chunks, &face_totchunk, &totloop, &totpoly))) {
+				error = N_("unexpected end of file");
+			}
+		}
+		else {
+			for (n = 0; n < elem->num; n++) {
+				const size_t size = ply_binary_element_size(elem, p, end, data.use_swap);
+				if (size == 0) {
+					error = N_("unexpected end of file");
+					break;
+				}
+				p += size;
+			}
+		}
+
+		if (elem == data.vert_elem) {
+			vert_start = elem_start;
+			vert_end = p;
+		}
+		else if (elem == data.face_elem) {
+			face_start = elem_start;
+			face_end = p;
+		}
+	}
+
+	if (!error && totloop > INT_MAX) {
+		error = N_("too many faces");
+	}
+	if (error) {
+		BKE_reportf(reports, RPT_ERROR, "Cannot read '%s': %s", filepath, TIP_(error));
+		if (face_chunks) {
+			import_chunks_free(face_chunks, face_totchunk);
+		}
+		return NULL;
+	}
+
+	data.mvert = MEM_callocN(sizeof(MVert) * data.totvert, "ply import verts");
+
+	if (header.format == PLY_ASCII) {
+		ImportChunk *chunks;
+
+		/* vertices */
+		data.chunks = chunks = import_chunks_text(vert_start, vert_end, false, &totchunk);
+		BLI_task_parallel_range_ex(0, totchunk, &data, NULL, 0, ply_ascii_count_chunk_cb, totchunk > 1, false);
+		for (i = 0, j = 0; i < totchunk; j += (int)chunks[i].totvert, i++) {
+			chunks[i].vert_start = (unsigned int)j;
+		}
+		BLI_task_parallel_range_ex(0, totchunk, &data, NULL, 0, ply_ascii_verts_chunk_cb, totchunk > 1, false);
+		if (import_chunks_report_error(chunks, totchunk, filepath, file, reports)) {
+			import_chunks_free(chunks, totchunk);
+			MEM_freeN(data.mvert);
+			return NULL;
+		}
+		import_chunks_free(chunks, totchunk);
+
+		/* faces */
+		if (data.prop_index != -1) {
+			data.chunks = chunks = import_chunks_text(face_start, face_end, false, &totchunk);
+			BLI_task_parallel_range_ex(0, totchunk, &data, NULL, 0, ply_ascii_faces_chunk_cb, totchunk > 1, true);
+			if (import_chunks_report_error(chunks, totchunk, filepath, file, reports) ||
+			    !import_polys_from_chunks(chunks, totchunk, data.totvert, NULL, 0,
+			                              &mloop, &totloop, &mpoly, &totpoly, &mloopuv))
+			{
+				import_chunks_report_error(chunks, totchunk, filepath, file, reports);
+				import_chunks_free(chunks, totchunk);
+				MEM_freeN(data.mvert);
+				return NULL;
+			}
+			import_chunks_free(chunks, totchunk);
+		}
+	}
+	else {
+		/* vertices */
+		data.vert_data = vert_start;
+		data.chunks = import_chunks_records(data.totvert, &totchunk);
+		BLI_task_parallel_range_ex(0, totchunk, &data, NULL, 0, ply_binary_verts_chunk_cb, totchunk > 1, false);
+		import_chunks_free(data.chunks, totchunk);
+
+		/* faces */
+		if (face_chunks) {
+			data.chunks = face_chunks;
+			data.mloop = mloop = MEM_callocN(sizeof(MLoop) * MAX2(totloop, 1), "ply import loops");
+			data.mpoly = mpoly = MEM_callocN(sizeof(MPoly) * MAX2(totpoly, 1), "ply import polys");
+			BLI_task_parallel_range_ex(0, face_totchunk, &data, NULL, 0, ply_binary_faces_chunk_cb,
+			                           face_totchunk > 1, false);
+			if (import_chunks_report_error(face_chunks, face_totchunk, filepath, file, reports)) {
+				import_chunks_free(face_chunks, face_totchunk);
+				MEM_freeN(data.mvert);
+				MEM_freeN(mloop);
+				MEM_freeN(mpoly);
+				return NULL;
+			}
+			import_chunks_free(face_chunks, face_totchunk);
+		}
+	}
+
+	if (mloop == NULL) {
+		/* point clouds */
+		mloop = MEM_callocN(sizeof(MLoop), "ply import loops");
+		mpoly = MEM_callocN(sizeof(MPoly), "ply import polys");
+		totloop = totpoly = 0;
+	}
+
+	me = import_mesh_create(bmain, filepath, data.mvert, data.totvert, mloop, totloop, mpoly, totpoly, mloopuv);
+
+	return me;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name STL
+ * \{ */
+
+#define STL_BINARY_HEADER_SIZE 84
+#define STL_BINARY_FACE_SIZE 50
+
+typedef struct STLImportData {
+	ImportChunk *chunks;
+	const char *faces;
+	float (*co)[3];
+} STLImportData;
+
+static void stl_binary_chunk_cb(void *userdata, void *UNUSED(userdata_chunk), int chunk_index)
+{
+	STLImportData *data = userdata;
+	const ImportChunk *chunk = &data->chunks[chunk_index];
+	unsigned int i;
+
+	for (i = chunk->vert_start; i < chunk->vert_start + chunk->totvert; i++) {
+		/* skip the normal */
+		const char *p = data->faces + (size_t)i * STL_BINARY_FACE_SIZE + sizeof(float[3]);
+		float (*co)[3] = &data->co[(size_t)i * 3];
+
+		memcpy(co, p, sizeof(float[3][3]));
+		if (ENDIAN_ORDER == B_ENDIAN) {
+			BLI_endian_switch_float_array(co[0], 9);
+		}
+	}
+}
+
+BLI_INLINE bool stl_line_is_vertex(const char *p, const char *eol, const char **r_args)
+{
+	p = import_skip_blank(p, eol);
+	if ((eol - p >= 7) && STREQLEN(p, "vertex", 6) && ELEM(p[6], ' ', '\t')) {
+		*r_args = p + 7;
+		return true;
+	}
+	return false;
+}
+
+static void stl_ascii_count_chunk_cb(void *userdata, void *UNUSED(userdata_chunk), int chunk_index)
+{
+	STLImportData *data = userdata;
+	ImportChunk *chunk = &data->chunks[chunk_index];
+	const char *line, *eol, *args;
+
+	for (line = chunk->start; line < chunk->end; line = eol + 1) {
+		eol = import_line_end(line, chunk->end, false);
+		if (stl_line_is_vertex(line, eol, &args)) {
+			chunk->totvert++;
+		}
+	}
+}
+
+static void stl_ascii_chunk_cb(void *userdata, void *UNUSED(userdata_chunk), int chunk_index)
+{
+	STLImportData *data = userdata;
+	ImportChunk *chunk = &data->chunks[chunk_index];
+	unsigned int vert_index = chunk->vert_start;
+	const char *line, *eol, *args, *p;
+	int i;
+
+	for (line = chunk->start; line < chunk->end; line = eol + 1) {
+		eol = import_line_end(line, chunk->end, false);
+		if (stl_line_is_vertex(line, eol, &args)) {
+			float *co = data->co[vert_index++];
+
+			for (i = 0, p = args; i < 3; i++) {
+				p = import_skip_blank(p, eol);
+				if (!(p = import_parse_float(p, eol, &co[i])) || !import_is_token_end(p, eol)) {
+					import_chunk_error(chunk, line, N_("invalid vertex"));
+					return;
+				}
+			}
+		}
+	}
+}
+
+BLI_INLINE unsigned int stl_hash_co(const float co[3])
+{
+	unsigned int bits[3], h;
+
+	memcpy(bits, co, sizeof(bits));
+	h = (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+	h ^= h >> 16;
+	h *= 0x85ebca6bu;
+	h ^= h >> 13;
+	return h;
+}
+
+/**
+ * STL stores every triangle with its own vertices, merge the exactly equal ones
+ * (the Python importer does the same).
+ */
+static MVert *stl_merge_verts(float (*co)[3], const unsigned int totco, MLoop *mloop, unsigned int *r_totvert)
+{
+	unsigned int table_size = 1, mask, totvert = 0, i;
+	unsigned int *table;
+	MVert *mvert;
+
+	while (table_size < totco * 2) {
+		table_size <<= 1;
+	}
+	mask = table_size - 1;
+
+	table = MEM_mallocN(sizeof(*table) * table_size, __func__);
+	memset(table, 0xff, sizeof(*table) * table_size);
+	mvert = MEM_callocN(sizeof(MVert) * totco, "stl import verts");
+
+	for (i = 0; i < totco; i++) {
+		unsigned int key;
+
+		/* -0.0 and 0.0 are the same location */
+		add_v3_fl(co[i], 0.0f);
+
+		for (key = stl_hash_co(co[i]) & mask; table[key] != UINT_MAX; key = (key + 1) & mask) {
+			if (equals_v3v3(mvert[table[key]].co, co[i])) {
+				break;
+			}
+		}
+		if (table[key] == UINT_MAX) {
+			table[key] = totvert;
+			copy_v3_v3(mvert[totvert++].co, co[i]);
+		}
+		mloop[i].v = table[key];
+	}
+
+	MEM_freeN(table);
+
+	*r_totvert = totvert;
+	return MEM_reallocN(mvert, sizeof(MVert) * MAX2(totvert, 1));
+}
+
+static Mesh *stl_import(Main *bmain, const char *filepath, const ImportFile *file, ReportList *reports)
+{
+	STLImportData data;
+	MVert *mvert;
+	MLoop *mloop;
+	MPoly *mpoly;
+	unsigned int totface = 0, totvert, totco, i;
+	int totchunk;
+	bool is_binary = false;
+
+	if (file->size >= STL_BINARY_HEADER_SIZE) {
+		unsigned int num;
+		memcpy(&num, file->buf + 80, sizeof(num));
+		if (ENDIAN_ORDER == B_ENDIAN) {
+			BLI_endian_switch_uint32(&num);
+		}
+		/* ascii files start with "solid", but binary files may use it in their header too */
+		if ((num <= (file->size - STL_BINARY_HEADER_SIZE) / STL_BINARY_FACE_SIZE) &&
+		    (!STREQLEN(file->buf, "solid", 5) ||
+		     (file->size == STL_BINARY_HEADER_SIZE + (size_t)num * STL_BINARY_FACE_SIZE)))
+		{
+			is_binary = true;
+			totface = num;
+		}
+	}
+
+	if (is_binary) {
+		if (totface == 0 || (unsigned long long)totface * 3 > INT_MAX) {
+			BKE_reportf(reports, RPT_ERROR, "Cannot read '%s': %s", filepath,
+			            totface ? TIP_("too many faces") : TIP_("no faces found"));
+			return NULL;
+		}
+		totco = totface * 3;
+		data.faces = file->buf + STL_BINARY_HEADER_SIZE;
+		data.co = MEM_mallocN(sizeof(*data.co) * totco, "stl import coords");
+		data.chunks = import_chunks_records(totface, &totchunk);
+		BLI_task_parallel_range_ex(0, totchunk, &data, NULL, 0, stl_binary_chunk_cb, totchunk > 1, false);
+		import_chunks_free(data.chunks, totchunk);
+	}
+	else {
+		unsigned long long num = 0;
+		int c;
+
+		data.chunks = import_chunks_text(file->buf, file->buf + file->size, false, &totchunk);
+		BLI_task_parallel_range_ex(0, totchunk, &data, NULL, 0, stl_ascii_count_chunk_cb, totchunk > 1, false);
+		for (c = 0; c < totchunk; c++) {
+			data.chunks[c].vert_start = (unsigned int)num;
+			num += data.chunks[c].totvert;
+		}
+		if (num == 0 || num % 3 != 0 || num > INT_MAX) {
+			BKE_reportf(reports, RPT_ERROR, "Cannot read '%s': %s", filepath,
+			            (num == 0) ? TIP_("no faces found") :
+			            (num % 3) ? TIP_("faces must have 3 vertices") : TIP_("too many faces"));
+			import_chunks_free(data.chunks, totchunk);
+			return NULL;
+		}
+		totco = (unsigned int)num;
+		totface = totco / 3;
+		data.co = MEM_mallocN(sizeof(*data.co) * totco, "stl import coords");
+		BLI_task_parallel_range_ex(0, totchunk, &data, NULL, 0, stl_ascii_chunk_cb, totchunk > 1, false);
+		if (import_chunks_report_error(data.chunks, totchunk, filepath, file, reports)) {
+			import_chunks_free(data.chunks, totchunk);
+			MEM_freeN(data.co);
+			return NULL;
+		}
+		import_chunks_free(data.chunks, totchunk);
+	}
+
+	mloop = MEM_callocN(sizeof(MLoop) * totco, "stl import loops");
+	mpoly = MEM_callocN(sizeof(MPoly) * totface, "stl import polys");
+	for (i = 0; i < totface; i++) {
+		mpoly[i].loopstart = (int)i * 3;
+		mpoly[i].totloop = 3;
+	}
+
+	mvert = stl_merge_verts(data.co, totco, mloop, &totvert);
+	MEM_freeN(data.co);
+
+	return import_mesh_create(bmain, filepath, mvert, totvert, mloop, totco, mpoly, totface, NULL);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Public API
+ * \{ */
+
+bool BKE_mesh_import_supported(const char *filepath)
+{
+	return (BLI_testextensie(filepath, ".obj") ||
+	        BLI_testextensie(filepath, ".ply") ||
+	        BLI_testextensie(filepath, ".stl"));
+}
+
+/**
+ * Read an OBJ, PLY or STL file (by extension) into a new mesh, named after the file.
+ *
+ * \return NULL on failure, with an error report.
+ */
+Mesh *BKE_mesh_import(Main *bmain, const char *filepath, ReportList *reports)
+{
+	ImportFile file;
+	Mesh *me;
+
+	if (!BKE_mesh_import_supported(filepath)) {
+		BKE_reportf(reports, RPT_ERROR, "Cannot read '%s': %s", filepath, TIP_("unsupported mesh format"));
+		return NULL;
+	}
+
+	errno = 0;
+	if (!import_file_open(&file, filepath)) {
+		BKE_reportf(reports, RPT_ERROR, "Cannot read '%s': %s", filepath,
+		            errno ? strerror(errno) : TIP_("empty file"));
+		return NULL;
+	}
+
+	if (BLI_testextensie(filepath, ".obj")) {
+		me = obj_import(bmain, filepath, &file, reports);
+	}
+	else if (BLI_testextensie(filepath, ".ply")) {
+		me = ply_import(bmain, filepath, &file, reports);
+	}
+	else {
+		me = stl_import(bmain, filepath, &file, reports);
+	}
+
+	import_file_close(&file);
+
+	return me;
+}
+
+/** \} */
@@ -38,6 +38,7 @@
 #include "BLI_memarena.h"
 #include "BLI_polyfill2d.h"
 #include "BLI_rand.h"
+#include "BLI_task.h"
 
 #include "BKE_bvhutils.h"
 #include "BKE_customdata.h"
@@ -105,6 +106,99 @@ static bool mesh_remap_bvhtree_query_raycast(
 	}
 }
 
+typedef struct MeshRemapQueryResult {
+	int index;  /* -1 when nothing was found */
+	float hit_dist;
+	float co[3];
+} MeshRemapQueryResult;
+
+typedef struct MeshRemapQueryBatchData {
+	BVHTreeFromMesh *treedata;
+	const SpaceTransform *space_transform;
+	const float (*cos)[3];
+	const float (*nos)[3];
+	float max_dist;
+	float ray_radius;
+	MeshRemapQueryResult *results;
+} MeshRemapQueryBatchData;
+
+static void mesh_remap_bvhtree_query_batch_cb(void *userdata, void *userdata_chunk, int i)
+{
+	MeshRemapQueryBatchData *data = userdata;
+	MeshRemapQueryResult *result = &data->results[i];
+	float tmp_co[3], tmp_no[3];
+	bool found;
+
+	copy_v3_v3(tmp_co, data->cos[i]);
+
+	if (data->nos) {
+		BVHTreeRayHit rayhit = {0};
+
+		copy_v3_v3(tmp_no, data->nos[i]);
+
+		/* Convert the vertex to tree coordinates, if needed. */
+		if (data->space_transform) {
+			BLI_space_transform_apply(data->space_transform, tmp_co);
+			BLI_space_transform_apply_normal(data->space_transform, tmp_no);
+		}
+
+		found = mesh_remap_bvhtree_query_raycast(
+		        data->treedata, &rayhit, tmp_co, tmp_no, data->ray_radius, data->max_dist, &result->hit_dist);
+		result->index = rayhit.index;
+		copy_v3_v3(result->co, rayhit.co);
+	}
+	else {
+		/* Each chunk of the range gets its own copy, so the proximity heuristic uses the previous item. */
+		BVHTreeNearest *nearest = userdata_chunk;
+
+		/* Convert the vertex to tree coordinates, if needed. */
+		if (data->space_transform) {
+			BLI_space_transform_apply(data->space_transform, tmp_co);
+		}
+
+		found = mesh_remap_bvhtree_query_nearest(
+		        data->treedata, nearest, tmp_co, data->max_dist * data->max_dist, &result->hit_dist);
+		result->index = nearest->index;
+		copy_v3_v3(result->co, nearest->co);
+	}
+
+	if (!found) {
+		result->index = -1;
+		result->hit_dist = FLT_MAX;
+	}
+}
+
+/**
+ * Run the nearest queries (or the raycasts along \a nos when given) for all \a cos at once, in parallel.
+ * \a cos and \a nos are in the space of the destination mesh, they get converted with \a space_transform.
+ *
+ * \return an array of \a num results, to be freed by the caller, hit coordinates are in the source space.
+ */
+static MeshRemapQueryResult *mesh_remap_bvhtree_query_batch(
+        BVHTreeFromMesh *treedata, const SpaceTransform *space_transform,
+        const float (*cos)[3], const float (*nos)[3], const int num,
+        const float max_dist, const float ray_radius)
+{
+	MeshRemapQueryResult *results = MEM_mallocN(sizeof(*results) * (size_t)max_ii(num, 1), __func__);
+	MeshRemapQueryBatchData data = {
+		.treedata = treedata, .space_transform = space_transform,
+		.cos = cos, .nos = nos,
+		.max_dist = max_dist, .ray_radius = ray_radius,
+		.results = results,
+	};
+	BVHTreeNearest nearest = {0};
+
+	nearest.index = -1;
+
+	if (num != 0) {
+		BLI_task_parallel_range_ex(
+		        0, num, &data, &nearest, sizeof(nearest), mesh_remap_bvhtree_query_batch_cb,
+		        num > BKE_MESH_OMP_LIMIT, false);
+	}
+
+	return results;
+}
+
 /** \} */
 
 /**
@@ -439,7 +533,6 @@ void BKE_mesh_remap_calc_verts_from_dm(
         MeshPairRemap *r_map)
 {
 	const float full_weight = 1.0f;
-	const float max_dist_sq = max_dist * max_dist;
 	int i;
 
 	BLI_assert(mode & MREMAP_MODE_VERT);
@@ -454,25 +547,23 @@ void BKE_mesh_remap_calc_verts_from_dm(
 	}
 	else {
 		BVHTreeFromMesh treedata = {NULL};
-		BVHTreeNearest nearest = {0};
-		BVHTreeRayHit rayhit = {0};
-		float hit_dist;
-		float tmp_co[3], tmp_no[3];
+		MeshRemapQueryResult *results = NULL;
+		float tmp_co[3];
+
+		/* The tree queries run in parallel first, the map items (allocated from its memarena) are defined after. */
+		float (*vcos_dst)[3] = MEM_mallocN(sizeof(*vcos_dst) * (size_t)max_ii(numverts_dst, 1), __func__);
+		for (i = 0; i < numverts_dst; i++) {
+			copy_v3_v3(vcos_dst[i], verts_dst[i].co);
+		}
 
 		if (mode == MREMAP_MODE_VERT_NEAREST) {
 			bvhtree_from_mesh_verts(&treedata, dm_src, 0.0f, 2, 6);
-			nearest.index = -1;
+			results = mesh_remap_bvhtree_query_batch(
+			        &treedata, space_transform, (const float (*)[3])vcos_dst, NULL, numverts_dst, max_dist, 0.0f);
 
 			for (i = 0; i < numverts_dst; i++) {
-				copy_v3_v3(tmp_co, verts_dst[i].co);
-
-				/* Convert the vertex to tree coordinates, if needed. */
-				if (space_transform) {
-					BLI_space_transform_apply(space_transform, tmp_co);
-				}
-
-				if (mesh_remap_bvhtree_query_nearest(&treedata, &nearest, tmp_co, max_dist_sq, &hit_dist)) {
-					mesh_remap_item_define(r_map, i, hit_dist, 0, 1, &nearest.index, &full_weight);
+				if (results[i].index != -1) {
+					mesh_remap_item_define(r_map, i, results[i].hit_dist, 0, 1, &results[i].index, &full_weight);
 				}
 				else {
 					/* No source for this dest vertex! */
@@ -486,21 +577,23 @@ void BKE_mesh_remap_calc_verts_from_dm(
 			dm_src->getVertCos(dm_src, vcos_src);
 
 			bvhtree_from_mesh_edges(&treedata, dm_src, 0.0f, 2, 6);
-			nearest.index = -1;
+			results = mesh_remap_bvhtree_query_batch(
+			        &treedata, space_transform, (const float (*)[3])vcos_dst, NULL, numverts_dst, max_dist, 0.0f);
 
 			for (i = 0; i < numverts_dst; i++) {
-				copy_v3_v3(tmp_co, verts_dst[i].co);
-
-				/* Convert the vertex to tree coordinates, if needed. */
-				if (space_transform) {
-					BLI_space_transform_apply(space_transform, tmp_co);
-				}
-
-				if (mesh_remap_bvhtree_query_nearest(&treedata, &nearest, tmp_co, max_dist_sq, &hit_dist)) {
-					MEdge *me = &edges_src[nearest.index];
+				if (results[i].index != -1) {
+					const float hit_dist = results[i].hit_dist;
+					MEdge *me = &edges_src[results[i].index];
 					const float *v1cos = vcos_src[me->v1];
 					const float *v2cos = vcos_src[me->v2];
 
+					copy_v3_v3(tmp_co, vcos_dst[i]);
+
+					/* Convert the vertex to tree coordinates, if needed. */
+					if (space_transform) {
+						BLI_space_transform_apply(space_transform, tmp_co);
+					}
+
 					if (mode == MREMAP_MODE_VERT_EDGE_NEAREST) {
 						const float dist_v1 = len_squared_v3v3(tmp_co, v1cos);
 						const float dist_v2 = len_squared_v3v3(tmp_co, v2cos);
@@ -546,26 +639,25 @@ void BKE_mesh_remap_calc_verts_from_dm(
 			bvhtree_from_mesh_looptri(&treedata, dm_src, (mode & MREMAP_USE_NORPROJ) ? ray_radius : 0.0f, 2, 6);
 
 			if (mode == MREMAP_MODE_VERT_POLYINTERP_VNORPROJ) {
+				float (*vnos_dst)[3] = MEM_mallocN(sizeof(*vnos_dst) * (size_t)max_ii(numverts_dst, 1), __func__);
 				for (i = 0; i < numverts_dst; i++) {
-					copy_v3_v3(tmp_co, verts_dst[i].co);
-					normal_short_to_float_v3(tmp_no, verts_dst[i].no);
+					normal_short_to_float_v3(vnos_dst[i], verts_dst[i].no);
+				}
 
-					/* Convert the vertex to tree coordinates, if needed. */
-					if (space_transform) {
-						BLI_space_transform_apply(space_transform, tmp_co);
-						BLI_space_transform_apply_normal(space_transform, tmp_no);
-					}
+				results = mesh_remap_bvhtree_query_batch(
+				        &treedata, space_transform, (const float (*)[3])vcos_dst, (const float (*)[3])vnos_dst,
+				        numverts_dst, max_dist, ray_radius);
+				MEM_freeN(vnos_dst);
 
-					if (mesh_remap_bvhtree_query_raycast(
-					        &treedata, &rayhit, tmp_co, tmp_no, ray_radius, max_dist, &hit_dist))
-					{
-						const MLoopTri *lt = &treedata.looptri[rayhit.index];
+				for (i = 0; i < numverts_dst; i++) {
+					if (results[i].index != -1) {
+						const MLoopTri *lt = &treedata.looptri[results[i].index];
 						MPoly *mp_src = &polys_src[lt->poly];
 						const int sources_num = mesh_remap_interp_poly_data_get(
-						        mp_src, loops_src, (const float (*)[3])vcos_src, rayhit.co,
+						        mp_src, loops_src, (const float (*)[3])vcos_src, results[i].co,
 						        &tmp_buff_size, &vcos, false, &indices, &weights, true, NULL);
 
-						mesh_remap_item_define(r_map, i, hit_dist, 0, sources_num, indices, weights);
+						mesh_remap_item_define(r_map, i, results[i].hit_dist, 0, sources_num, indices, weights);
 					}
 					else {
 						/* No source for this dest vertex! */
@@ -574,36 +666,30 @@ void BKE_mesh_remap_calc_verts_from_dm(
 				}
 			}
 			else {
-				nearest.index = -1;
+				results = mesh_remap_bvhtree_query_batch(
+				        &treedata, space_transform, (const float (*)[3])vcos_dst, NULL, numverts_dst, max_dist, 0.0f);
 
 				for (i = 0; i < numverts_dst; i++) {
-					copy_v3_v3(tmp_co, verts_dst[i].co);
-
-					/* Convert the vertex to tree coordinates, if needed. */
-					if (space_transform) {
-						BLI_space_transform_apply(space_transform, tmp_co);
-					}
-
-					if (mesh_remap_bvhtree_query_nearest(&treedata, &nearest, tmp_co, max_dist_sq, &hit_dist)) {
-						const MLoopTri *lt = &treedata.looptri[nearest.index];
+					if (results[i].index != -1) {
+						const MLoopTri *lt = &treedata.looptri[results[i].index];
 						MPoly *mp = &polys_src[lt->poly];
 
 						if (mode == MREMAP_MODE_VERT_POLY_NEAREST) {
 							int index;
 							mesh_remap_interp_poly_data_get(
-							        mp, loops_src, (const float (*)[3])vcos_src, nearest.co,
+							        mp, loops_src, (const float (*)[3])vcos_src, results[i].co,
 							        &tmp_buff_size, &vcos, false, &indices, &weights, false,
 							        &index);
 
-							mesh_remap_item_define(r_map, i, hit_dist, 0, 1, &index, &full_weight);
+							mesh_remap_item_define(r_map, i, results[i].hit_dist, 0, 1, &index, &full_weight);
 						}
 						else if (mode == MREMAP_MODE_VERT_POLYINTERP_NEAREST) {
 							const int sources_num = mesh_remap_interp_poly_data_get(
-							        mp, loops_src, (const float (*)[3])vcos_src, nearest.co,
+							        mp, loops_src, (const float (*)[3])vcos_src, results[i].co,
 							        &tmp_buff_size, &vcos, false, &indices, &weights, true,
 							        NULL);
 
-							mesh_remap_item_define(r_map, i, hit_dist, 0, sources_num, indices, weights);
+							mesh_remap_item_define(r_map, i, results[i].hit_dist, 0, sources_num, indices, weights);
 						}
 					}
 					else {
@@ -623,6 +709,11 @@ void BKE_mesh_remap_calc_verts_from_dm(
 			memset(r_map->items, 0, sizeof(*r_map->items) * (size_t)numverts_dst);
 		}
 
+		if (results) {
+			MEM_freeN(results);
+		}
+		MEM_freeN(vcos_dst);
+
 		free_bvhtree_from_mesh(&treedata);
 	}
 }
@@ -1980,7 +2071,6 @@ void BKE_mesh_remap_calc_polys_from_dm(
         DerivedMesh *dm_src, MeshPairRemap *r_map)
 {
 	const float full_weight = 1.0f;
-	const float max_dist_sq = max_dist * max_dist;
 	float (*poly_nors_dst)[3] = NULL;
 	float tmp_co[3], tmp_no[3];
 	int i;
@@ -2010,7 +2100,6 @@ void BKE_mesh_remap_calc_polys_from_dm(
 	}
 	else {
 		BVHTreeFromMesh treedata = {NULL};
-		BVHTreeNearest nearest = {0};
 		BVHTreeRayHit rayhit = {0};
 		float hit_dist;
 
@@ -2019,55 +2108,28 @@ void BKE_mesh_remap_calc_polys_from_dm(
 		        (mode & MREMAP_USE_NORPROJ) ? MREMAP_RAYCAST_APPROXIMATE_BVHEPSILON(ray_radius) : 0.0f,
 		        2, 6);
 
-		if (mode == MREMAP_MODE_POLY_NEAREST) {
-			nearest.index = -1;
+		if (ELEM(mode, MREMAP_MODE_POLY_NEAREST, MREMAP_MODE_POLY_NOR)) {
+			/* The tree queries run in parallel first, the map items are defined after. */
+			MeshRemapQueryResult *results;
+			float (*pcos_dst)[3] = MEM_mallocN(sizeof(*pcos_dst) * (size_t)max_ii(numpolys_dst, 1), __func__);
 
 			for (i = 0; i < numpolys_dst; i++) {
 				MPoly *mp = &polys_dst[i];
-
-				BKE_mesh_calc_poly_center(mp, &loops_dst[mp->loopstart], verts_dst, tmp_co);
-
-				/* Convert the vertex to tree coordinates, if needed. */
-				if (space_transform) {
-					BLI_space_transform_apply(space_transform, tmp_co);
-				}
-
-				if (mesh_remap_bvhtree_query_nearest(&treedata, &nearest, tmp_co, max_dist_sq, &hit_dist)) {
-					const MLoopTri *lt = &treedata.looptri[nearest.index];
-					const int poly_index = (int)lt->poly;
-					mesh_remap_item_define(
-					        r_map, i, hit_dist, 0,
-					        1, &poly_index, &full_weight);
-				}
-				else {
-					/* No source for this dest poly! */
-					BKE_mesh_remap_item_define_invalid(r_map, i);
-				}
+				BKE_mesh_calc_poly_center(mp, &loops_dst[mp->loopstart], verts_dst, pcos_dst[i]);
 			}
-		}
-		else if (mode == MREMAP_MODE_POLY_NOR) {
-			BLI_assert(poly_nors_dst);
-
-			for (i = 0; i < numpolys_dst; i++) {
-				MPoly *mp = &polys_dst[i];
 
-				BKE_mesh_calc_poly_center(mp, &loops_dst[mp->loopstart], verts_dst, tmp_co);
-				copy_v3_v3(tmp_no, poly_nors_dst[i]);
-
-				/* Convert the vertex to tree coordinates, if needed. */
-				if (space_transform) {
-					BLI_space_transform_apply(space_transform, tmp_co);
-					BLI_space_transform_apply_normal(space_transform, tmp_no);
-				}
+			BLI_assert(mode == MREMAP_MODE_POLY_NEAREST || poly_nors_dst);
+			results = mesh_remap_bvhtree_query_batch(
+			        &treedata, space_transform, (const float (*)[3])pcos_dst,
+			        (mode == MREMAP_MODE_POLY_NOR) ? (const float (*)[3])poly_nors_dst : NULL,
+			        numpolys_dst, max_dist, ray_radius);
 
-				if (mesh_remap_bvhtree_query_raycast(
-				        &treedata, &rayhit, tmp_co, tmp_no, ray_radius, max_dist, &hit_dist))
-				{
-					const MLoopTri *lt = &treedata.looptri[rayhit.index];
+			for (i = 0; i < numpolys_dst; i++) {
+				if (results[i].index != -1) {
+					const MLoopTri *lt = &treedata.looptri[results[i].index];
 					const int poly_index = (int)lt->poly;
-
 					mesh_remap_item_define(
-					        r_map, i, hit_dist, 0,
+					        r_map, i, results[i].hit_dist, 0,
 					        1, &poly_index, &full_weight);
 				}
 				else {
@@ -2075,6 +2137,9 @@ void BKE_mesh_remap_calc_polys_from_dm(
 					BKE_mesh_remap_item_define_invalid(r_map, i);
 				}
 			}
+
+			MEM_freeN(results);
+			MEM_freeN(pcos_dst);
 		}
 		else if (mode == MREMAP_MODE_POLY_POLYINTERP_PNORPROJ) {
 			/* We cast our rays randomly, with a pseudo-even distribution (since we spread across tessellated tris,
@@ -53,6 +53,7 @@
 #include "BLI_listbase.h"
 #include "BLI_linklist.h"
 #include "BLI_string.h"
+#include "BLI_trace.h"
 
 #include "BLT_translation.h"
 
@@ -139,6 +140,7 @@ void modifier_free(ModifierData *md)
 
 	if (mti->freeData) mti->freeData(md);
 	if (md->error) MEM_freeN(md->error);
+	DM_modifier_stack_cache_free(md);
 
 	MEM_freeN(md);
 }
@@ -422,6 +424,21 @@ bool modifier_isEnabled(struct Scene *scene, ModifierData *md, int required_mode
 	return true;
 }
 
+/**
+ * Check whether none of the modifiers after \a md are evaluated for \a required_mode,
+ * so the result of \a md is the final result of the stack.
+ */
+bool modifier_isLastEnabled(struct Scene *scene, ModifierData *md, int required_mode)
+{
+	for (md = md->next; md; md = md->next) {
+		if (modifier_isEnabled(scene, md, required_mode)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 CDMaskLink *modifiers_calcDataMasks(struct Scene *scene, Object *ob, ModifierData *md,
                                     CustomDataMask dataMask, int required_mode,
                                     ModifierData *previewmd, CustomDataMask previewmask)
@@ -736,12 +753,18 @@ struct DerivedMesh *modwrap_applyModifier(
         ModifierApplyFlag flag)
 {
 	const ModifierTypeInfo *mti = modifierType_getInfo(md->type);
+	const double trace_start = BLI_trace_begin();
+	DerivedMesh *result;
 	BLI_assert(CustomData_has_layer(&dm->polyData, CD_NORMAL) == false);
 
 	if (mti->dependsOnNormals && mti->dependsOnNormals(md)) {
 		DM_ensure_normals(dm);
 	}
-	return mti->applyModifier(md, ob, dm, flag);
+	result = mti->applyModifier(md, ob, dm, flag);
+
+	/* type names are static, the modifier name isn't */
+	BLI_trace_end(mti->name, trace_start);
+	return result;
 }
 
 struct DerivedMesh *modwrap_applyModifierEM(
@@ -751,12 +774,17 @@ struct DerivedMesh *modwrap_applyModifierEM(
         ModifierApplyFlag flag)
 {
 	const ModifierTypeInfo *mti = modifierType_getInfo(md->type);
+	const double trace_start = BLI_trace_begin();
+	DerivedMesh *result;
 	BLI_assert(CustomData_has_layer(&dm->polyData, CD_NORMAL) == false);
 
 	if (mti->dependsOnNormals && mti->dependsOnNormals(md)) {
 		DM_ensure_normals(dm);
 	}
-	return mti->applyModifierEM(md, ob, em, dm, flag);
+	result = mti->applyModifierEM(md, ob, em, dm, flag);
+
+	BLI_trace_end(mti->name, trace_start);
+	return result;
 }
 
 void modwrap_deformVerts(
@@ -766,12 +794,15 @@ void modwrap_deformVerts(
         ModifierApplyFlag flag)
 {
 	const ModifierTypeInfo *mti = modifierType_getInfo(md->type);
+	const double trace_start = BLI_trace_begin();
 	BLI_assert(!dm || CustomData_has_layer(&dm->polyData, CD_NORMAL) == false);
 
 	if (dm && mti->dependsOnNormals && mti->dependsOnNormals(md)) {
 		DM_ensure_normals(dm);
 	}
 	mti->deformVerts(md, ob, dm, vertexCos, numVerts, flag);
+
+	BLI_trace_end(mti->name, trace_start);
 }
 
 void modwrap_deformVertsEM(
@@ -780,11 +811,14 @@ void modwrap_deformVertsEM(
         float (*vertexCos)[3], int numVerts)
 {
 	const ModifierTypeInfo *mti = modifierType_getInfo(md->type);
+	const double trace_start = BLI_trace_begin();
 	BLI_assert(!dm || CustomData_has_layer(&dm->polyData, CD_NORMAL) == false);
 
 	if (dm && mti->dependsOnNormals && mti->dependsOnNormals(md)) {
 		DM_ensure_normals(dm);
 	}
 	mti->deformVertsEM(md, ob, em, dm, vertexCos, numVerts);
+
+	BLI_trace_end(mti->name, trace_start);
 }
 /* end modifier callback wrappers */
@@ -2062,15 +2062,8 @@ static bool psys_thread_context_init_path(ParticleThreadContext *ctx, ParticleSi
 	return true;
 }
 
-static void psys_task_init_path(ParticleTask *task, ParticleSimulationData *sim)
-{
-	/* init random number generator */
-	int seed = 31415926 + sim->psys->seed;
-	
-	task->rng_path = BLI_rng_new(seed);
-}
-
-/* note: this function must be thread safe, except for branching! */
+/* note: this function must be thread safe, random values come from psys_frand() with the child index,
+ * so the paths don't depend on which task computes them. */
 static void psys_thread_create_path(ParticleTask *task, struct ChildParticle *cpa, ParticleCacheKey *child_keys, int i)
 {
 	ParticleThreadContext *ctx = task->ctx;
@@ -2381,7 +2374,6 @@ void psys_cache_child_paths(ParticleSimulationData *sim, float cfra, int editupd
 	for (i = 0; i < numtasks_parent; ++i) {
 		ParticleTask *task = &tasks_parent[i];
 		
-		psys_task_init_path(task, sim);
 		BLI_task_pool_push(task_pool, exec_child_path_cache, task, false, TASK_PRIORITY_LOW);
 	}
 	BLI_task_pool_work_and_wait(task_pool);
@@ -2392,7 +2384,6 @@ void psys_cache_child_paths(ParticleSimulationData *sim, float cfra, int editupd
 	for (i = 0; i < numtasks_child; ++i) {
 		ParticleTask *task = &tasks_child[i];
 		
-		psys_task_init_path(task, sim);
 		BLI_task_pool_push(task_pool, exec_child_path_cache, task, false, TASK_PRIORITY_LOW);
 	}
 	BLI_task_pool_work_and_wait(task_pool);
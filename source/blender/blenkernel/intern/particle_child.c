@@ -606,6 +606,20 @@ float do_clump(ParticleKey *state, const float par_co[3], float time, const floa
 	return clump;
 }
 
+/* three turbulence values for the cyclic permutations of rco, mapped to [-1, 1] */
+static void do_rough_turbulence(const float rco[3], float size, float r_rough[3])
+{
+	const float turb_co[3][3] = {
+	    {rco[0], rco[1], rco[2]},
+	    {rco[1], rco[2], rco[0]},
+	    {rco[2], rco[0], rco[1]}};
+
+	BLI_gTurbulence_array(size, turb_co, 3, 2, 0, 2, r_rough);
+	r_rough[0] = -1.0f + 2.0f * r_rough[0];
+	r_rough[1] = -1.0f + 2.0f * r_rough[1];
+	r_rough[2] = -1.0f + 2.0f * r_rough[2];
+}
+
 static void do_rough(const float loc[3], float mat[4][4], float t, float fac, float size, float thres, ParticleKey *state)
 {
 	float rough[3];
@@ -619,9 +633,7 @@ static void do_rough(const float loc[3], float mat[4][4], float t, float fac, fl
 
 	copy_v3_v3(rco, loc);
 	mul_v3_fl(rco, t);
-	rough[0] = -1.0f + 2.0f * BLI_gTurbulence(size, rco[0], rco[1], rco[2], 2, 0, 2);
-	rough[1] = -1.0f + 2.0f * BLI_gTurbulence(size, rco[1], rco[2], rco[0], 2, 0, 2);
-	rough[2] = -1.0f + 2.0f * BLI_gTurbulence(size, rco[2], rco[0], rco[1], 2, 0, 2);
+	do_rough_turbulence(rco, size, rough);
 
 	madd_v3_v3fl(state->co, mat[0], fac * rough[0]);
 	madd_v3_v3fl(state->co, mat[1], fac * rough[1]);
@@ -655,9 +667,7 @@ static void do_rough_curve(const float loc[3], float mat[4][4], float time, floa
 	
 	copy_v3_v3(rco, loc);
 	mul_v3_fl(rco, time);
-	rough[0] = -1.0f + 2.0f * BLI_gTurbulence(size, rco[0], rco[1], rco[2], 2, 0, 2);
-	rough[1] = -1.0f + 2.0f * BLI_gTurbulence(size, rco[1], rco[2], rco[0], 2, 0, 2);
-	rough[2] = -1.0f + 2.0f * BLI_gTurbulence(size, rco[2], rco[0], rco[1], 2, 0, 2);
+	do_rough_turbulence(rco, size, rough);
 	
 	madd_v3_v3fl(state->co, mat[0], fac * rough[0]);
 	madd_v3_v3fl(state->co, mat[1], fac * rough[1]);
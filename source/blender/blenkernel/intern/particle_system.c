@@ -40,10 +40,6 @@
 #include <math.h>
 #include <string.h>
 
-#ifdef _OPENMP
-#include <omp.h>
-#endif
-
 #include "MEM_guardedalloc.h"
 
 #include "DNA_anim_types.h"
@@ -479,8 +475,6 @@ void psys_tasks_free(ParticleTask *tasks, int numtasks)
 	for (i = 0; i < numtasks; ++i) {
 		if (tasks[i].rng)
 			BLI_rng_free(tasks[i].rng);
-		if (tasks[i].rng_path)
-			BLI_rng_free(tasks[i].rng_path);
 	}
 
 	MEM_freeN(tasks);
@@ -1464,6 +1458,34 @@ static ParticleSpring *sph_spring_add(ParticleSystem *psys, ParticleSpring *spri
 
 	return psys->fluid_springs + psys->tot_fluidsprings - 1;
 }
+
+/* springs found by one thread, see SPHData.new_springs */
+typedef struct SPHNewSprings {
+	ParticleSpring *springs;
+	int tot, alloc;
+} SPHNewSprings;
+
+static void sph_new_spring_add(SPHNewSprings *new_springs, ParticleSpring *spring)
+{
+	if (new_springs->tot == new_springs->alloc) {
+		new_springs->alloc = new_springs->alloc ? new_springs->alloc * 2 : PSYS_FLUID_SPRINGS_INITIAL_SIZE;
+		new_springs->springs = MEM_reallocN(new_springs->springs, new_springs->alloc * sizeof(ParticleSpring));
+	}
+
+	new_springs->springs[new_springs->tot++] = *spring;
+}
+static void sph_new_springs_apply(ParticleSystem *psys, SPHNewSprings *new_springs)
+{
+	int i;
+
+	for (i = 0; i < new_springs->tot; i++)
+		sph_spring_add(psys, &new_springs->springs[i]);
+}
+static void sph_new_springs_free(SPHNewSprings *new_springs)
+{
+	MEM_SAFE_FREE(new_springs->springs);
+	new_springs->tot = new_springs->alloc = 0;
+}
 static void sph_spring_delete(ParticleSystem *psys, int j)
 {
 	if (j != psys->tot_fluidsprings - 1)
@@ -1745,9 +1767,11 @@ static void sph_force_cb(void *sphdata_v, ParticleKey *state, float *force, floa
 					temp_spring.rest_length = (fluid->flag & SPH_CURRENT_REST_LENGTH) ? rij : rest_length;
 					temp_spring.delete_flag = 0;
 
-					/* sph_spring_add is not thread-safe. - z0r */
-#pragma omp critical
-					sph_spring_add(psys[0], &temp_spring);
+					/* sph_spring_add is not thread-safe, threads collect their new springs. */
+					if (sphdata->new_springs)
+						sph_new_spring_add(sphdata->new_springs, &temp_spring);
+					else
+						sph_spring_add(psys[0], &temp_spring);
 				}
 			}
 			else {/* PART_SPRING_HOOKES - Hooke's spring force */
@@ -1962,6 +1986,7 @@ void psys_sph_init(ParticleSimulationData *sim, SPHData *sphdata)
 	// completeness we give them default values now.
 	sphdata->pa = NULL;
 	sphdata->mass = 1.0f;
+	sphdata->new_springs = NULL;
 
 	if (sim->psys->part->fluid->solver == SPH_SOLVER_DDR) {
 		sphdata->force_cb = sph_force_cb;
@@ -3286,7 +3311,7 @@ static const float TIMESTEP_EXPANSION_TOLERANCE = 1.5f;
  * simulation. This should be called once per particle during a simulation
  * step, after the velocity has been updated. element_size defines the scale of
  * the simulation, and is typically the distance to neighboring particles. */
-static void update_courant_num(ParticleSimulationData *sim, ParticleData *pa,
+static void update_courant_num(float *courant_num, ParticleData *pa,
                                float dtime, SPHData *sphdata)
 {
 	float relative_vel[3];
@@ -3294,8 +3319,8 @@ static void update_courant_num(ParticleSimulationData *sim, ParticleData *pa,
 
 	sub_v3_v3v3(relative_vel, pa->prev_state.vel, sphdata->flow);
 	speed = len_v3(relative_vel);
-	if (sim->courant_num < speed * dtime / sphdata->element_size)
-		sim->courant_num = speed * dtime / sphdata->element_size;
+	if (*courant_num < speed * dtime / sphdata->element_size)
+		*courant_num = speed * dtime / sphdata->element_size;
 }
 static float get_base_time_step(ParticleSettings *part)
 {
@@ -3332,6 +3357,127 @@ static float update_timestep(ParticleSystem *psys, ParticleSimulationData *sim,
 		return psys->dt_frac;
 }
 
+typedef struct DynamicsStepSPHData {
+	ParticleSimulationData *sim;
+	float cfra, dtime, timestep;
+} DynamicsStepSPHData;
+
+/* per task copy of the SPH data, so the threads don't need to lock anything */
+typedef struct DynamicsStepSPHChunk {
+	SPHData sphdata;
+	SPHNewSprings new_springs;
+	float courant_num;
+} DynamicsStepSPHChunk;
+
+static void dynamics_step_sph_init(void *UNUSED(userdata), void *userdata_chunk)
+{
+	DynamicsStepSPHChunk *chunk = userdata_chunk;
+
+	chunk->sphdata.new_springs = &chunk->new_springs;
+}
+
+static void dynamics_step_sph_reduce(void *userdata, void *userdata_chunk_join, void *userdata_chunk)
+{
+	DynamicsStepSPHData *data = userdata;
+	DynamicsStepSPHChunk *join = userdata_chunk_join;
+	DynamicsStepSPHChunk *chunk = userdata_chunk;
+
+	sph_new_springs_apply(data->sim->psys, &chunk->new_springs);
+	join->courant_num = max_ff(join->courant_num, chunk->courant_num);
+}
+
+static void dynamics_step_sph_finalize(void *UNUSED(userdata), void *userdata_chunk)
+{
+	DynamicsStepSPHChunk *chunk = userdata_chunk;
+
+	sph_new_springs_free(&chunk->new_springs);
+}
+
+static void dynamics_step_sph_ddr_task_cb(void *userdata, void *userdata_chunk, int p)
+{
+	DynamicsStepSPHData *data = userdata;
+	DynamicsStepSPHChunk *chunk = userdata_chunk;
+	ParticleSimulationData *sim = data->sim;
+	ParticleSettings *part = sim->psys->part;
+	ParticleData *pa = sim->psys->particles + p;
+
+	if (pa->state.time <= 0.0f)
+		return;
+
+	/* do global forces & effectors */
+	basic_integrate(sim, p, pa->state.time, data->cfra);
+
+	/* actual fluids calculations */
+	sph_integrate(sim, pa, pa->state.time, &chunk->sphdata);
+
+	if (sim->colliders)
+		collision_check(sim, p, pa->state.time, data->cfra);
+
+	/* SPH particles are not physical particles, just interpolation
+	 * particles,  thus rotation has not a direct sense for them */
+	basic_rotate(part, pa, pa->state.time, data->timestep);
+
+	if (part->time_flag & PART_TIME_AUTOSF)
+		update_courant_num(&chunk->courant_num, pa, data->dtime, &chunk->sphdata);
+}
+
+static void dynamics_step_sph_classical_basic_integrate_task_cb(void *userdata, void *UNUSED(userdata_chunk), int p)
+{
+	DynamicsStepSPHData *data = userdata;
+	ParticleSimulationData *sim = data->sim;
+	ParticleData *pa = sim->psys->particles + p;
+
+	if (pa->state.time <= 0.0f)
+		return;
+
+	basic_integrate(sim, p, pa->state.time, data->cfra);
+}
+
+static void dynamics_step_sph_classical_calc_density_task_cb(void *userdata, void *userdata_chunk, int p)
+{
+	DynamicsStepSPHData *data = userdata;
+	DynamicsStepSPHChunk *chunk = userdata_chunk;
+	ParticleData *pa = data->sim->psys->particles + p;
+
+	if (pa->state.time <= 0.0f)
+		return;
+
+	sphclassical_calc_dens(pa, pa->state.time, &chunk->sphdata);
+}
+
+static void dynamics_step_sph_classical_integrate_task_cb(void *userdata, void *userdata_chunk, int p)
+{
+	DynamicsStepSPHData *data = userdata;
+	DynamicsStepSPHChunk *chunk = userdata_chunk;
+	ParticleSimulationData *sim = data->sim;
+	ParticleSettings *part = sim->psys->part;
+	ParticleData *pa = sim->psys->particles + p;
+
+	if (pa->state.time <= 0.0f)
+		return;
+
+	/* actual fluids calculations */
+	sph_integrate(sim, pa, pa->state.time, &chunk->sphdata);
+
+	if (sim->colliders)
+		collision_check(sim, p, pa->state.time, data->cfra);
+
+	/* SPH particles are not physical particles, just interpolation
+	 * particles,  thus rotation has not a direct sense for them */
+	basic_rotate(part, pa, pa->state.time, data->timestep);
+
+	if (part->time_flag & PART_TIME_AUTOSF)
+		update_courant_num(&chunk->courant_num, pa, data->dtime, &chunk->sphdata);
+}
+
+static void dynamics_step_sph_range(
+        DynamicsStepSPHData *data, DynamicsStepSPHChunk *chunk, TaskParallelRangeFunc func)
+{
+	BLI_task_parallel_range_reduce(
+	        0, data->sim->psys->totpart, data, chunk, sizeof(*chunk),
+	        func, dynamics_step_sph_init, dynamics_step_sph_reduce, dynamics_step_sph_finalize, 5, true);
+}
+
 /************************************************/
 /*			System Core							*/
 /************************************************/
@@ -3488,31 +3634,20 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
 		}
 		case PART_PHYS_FLUID:
 		{
-			SPHData sphdata;
-			psys_sph_init(sim, &sphdata);
+			DynamicsStepSPHData sph_data = {.sim = sim, .cfra = cfra, .dtime = dtime, .timestep = timestep};
+			DynamicsStepSPHChunk sph_chunk = {{{NULL}}};
+			SPHData *sphdata = &sph_chunk.sphdata;
 
-			if (part->fluid->solver == SPH_SOLVER_DDR) {
+			psys_sph_init(sim, sphdata);
+			sph_chunk.courant_num = sim->courant_num;
+
+			if (psys->totpart == 0) {
+				/* nothing to do */
+			}
+			else if (part->fluid->solver == SPH_SOLVER_DDR) {
 				/* Apply SPH forces using double-density relaxation algorithm
 				 * (Clavat et. al.) */
-#pragma omp parallel for firstprivate (sphdata) private (pa) schedule(dynamic,5)
-				LOOP_DYNAMIC_PARTICLES {
-					/* do global forces & effectors */
-					basic_integrate(sim, p, pa->state.time, cfra);
-
-					/* actual fluids calculations */
-					sph_integrate(sim, pa, pa->state.time, &sphdata);
-
-					if (sim->colliders)
-						collision_check(sim, p, pa->state.time, cfra);
-
-					/* SPH particles are not physical particles, just interpolation
-					 * particles,  thus rotation has not a direct sense for them */
-					basic_rotate(part, pa, pa->state.time, timestep);
-
-#pragma omp critical
-					if (part->time_flag & PART_TIME_AUTOSF)
-						update_courant_num(sim, pa, dtime, &sphdata);
-				}
+				dynamics_step_sph_range(&sph_data, &sph_chunk, dynamics_step_sph_ddr_task_cb);
 
 				sph_springs_modify(psys, timestep);
 
@@ -3523,37 +3658,18 @@ static void dynamics_step(ParticleSimulationData *sim, float cfra)
 				 * and Monaghan). Note that, unlike double-density relaxation,
 				 * this algorithm is separated into distinct loops. */
 
-#pragma omp parallel for private (pa) schedule(dynamic,5)
-				LOOP_DYNAMIC_PARTICLES {
-					basic_integrate(sim, p, pa->state.time, cfra);
-				}
+				dynamics_step_sph_range(&sph_data, &sph_chunk, dynamics_step_sph_classical_basic_integrate_task_cb);
 
 				/* calculate summation density */
-#pragma omp parallel for firstprivate (sphdata) private (pa) schedule(dynamic,5)
-				LOOP_DYNAMIC_PARTICLES {
-					sphclassical_calc_dens(pa, pa->state.time, &sphdata);
-				}
+				dynamics_step_sph_range(&sph_data, &sph_chunk, dynamics_step_sph_classical_calc_density_task_cb);
 
 				/* do global forces & effectors */
-#pragma omp parallel for firstprivate (sphdata) private (pa) schedule(dynamic,5)
-				LOOP_DYNAMIC_PARTICLES {
-					/* actual fluids calculations */
-					sph_integrate(sim, pa, pa->state.time, &sphdata);
-
-					if (sim->colliders)
-						collision_check(sim, p, pa->state.time, cfra);
-				
-					/* SPH particles are not physical particles, just interpolation
-					 * particles,  thus rotation has not a direct sense for them */
-					basic_rotate(part, pa, pa->state.time, timestep);
-
-#pragma omp critical
-					if (part->time_flag & PART_TIME_AUTOSF)
-						update_courant_num(sim, pa, dtime, &sphdata);
-				}
+				dynamics_step_sph_range(&sph_data, &sph_chunk, dynamics_step_sph_classical_integrate_task_cb);
 			}
 
-			psys_sph_finalise(&sphdata);
+			sim->courant_num = sph_chunk.courant_num;
+
+			psys_sph_finalise(sphdata);
 			break;
 		}
 	}
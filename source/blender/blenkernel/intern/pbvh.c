@@ -30,6 +30,8 @@
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
 #include "BLI_ghash.h"
+#include "BLI_sort_utils.h"
+#include "BLI_task.h"
 
 #include "BKE_pbvh.h"
 #include "BKE_ccg.h"
@@ -42,23 +44,28 @@
 
 #include "bmesh.h"
 
+#include "atomic_ops.h"
+
 #include "pbvh_intern.h"
 
 #include <limits.h>
+#include <stdlib.h>
+#include <string.h>
 
 #define LEAF_LIMIT 10000
 
+/* ranges of more primitives are split in their own task while building */
+#define PBVH_BUILD_TASK_LIMIT 4096
+
 //#define PERFCNTRS
 
 #define STACK_FIXED_DEPTH   100
 
-/* Setting zero so we can catch bugs in OpenMP/PBVH. */
-#ifdef _OPENMP
-#  ifdef DEBUG
-#    define PBVH_OMP_LIMIT 0
-#  else
-#    define PBVH_OMP_LIMIT 8
-#  endif
+/* Setting zero so we can catch bugs in threaded PBVH updates. */
+#ifdef DEBUG
+#  define PBVH_THREADED_LIMIT 0
+#else
+#  define PBVH_THREADED_LIMIT 8
 #endif
 
 typedef struct PBVHStack {
@@ -241,61 +248,42 @@ void pbvh_grow_nodes(PBVH *bvh, int totnode)
 	bvh->totnode = totnode;
 }
 
-/* Add a vertex to the map, with a positive value for unique vertices and
- * a negative value for additional vertices */
-static int map_insert_vert(PBVH *bvh, GHash *map,
-                           unsigned int *face_verts,
-                           unsigned int *uniq_verts, int vertex)
-{
-	void *key, **value_p;
+typedef struct PBVHBuildInfo {
+	/* range of the primitives in the PBVH prim_indices array */
+	int offset, count;
+	/* the two halves the range is split into, NULL for leaves */
+	struct PBVHBuildInfo *children;
+} PBVHBuildInfo;
 
-	key = SET_INT_IN_POINTER(vertex);
-	value_p = BLI_ghash_lookup_p(map, key);
+typedef struct PBVHBuildState {
+	PBVH *bvh;
+	BBC *prim_bbc;
 
-	if (value_p == NULL) {
-		void *value;
-		if (BLI_BITMAP_TEST(bvh->vert_bitmap, vertex)) {
-			value = SET_INT_IN_POINTER(~(*face_verts));
-			++(*face_verts);
-		}
-		else {
-			BLI_BITMAP_ENABLE(bvh->vert_bitmap, vertex);
-			value = SET_INT_IN_POINTER(*uniq_verts);
-			++(*uniq_verts);
-		}
-		
-		BLI_ghash_insert(map, key, value);
-		return GET_INT_FROM_POINTER(value);
-	}
-	else {
-		return GET_INT_FROM_POINTER(*value_p);
-	}
-}
+	/* leaf nodes, in depth-first order */
+	int *leaf_indices;
+	int totleaf, leaf_mem_count;
 
-/* Find vertices used by the faces in this node and update the draw buffers */
-static void build_mesh_leaf_node(PBVH *bvh, PBVHNode *node)
-{
-	bool has_visible = false;
+	/* mesh only, for each vertex the order of the first leaf using it */
+	unsigned int *vert_owner;
+} PBVHBuildState;
 
-	node->uniq_verts = node->face_verts = 0;
+/* Gather the vertices used by the triangles of a mesh leaf, sorted and without duplicates,
+ * and claim the ownership of those no earlier leaf uses (see #build_mesh_leaf_node).
+ * The list is stored in the leaf's vert_indices, face_verts holds its length for now. */
+static void build_mesh_leaf_verts(PBVHBuildState *state, PBVHNode *node, const unsigned int leaf_order)
+{
+	PBVH *bvh = state->bvh;
 	const int totface = node->totprim;
-
-	/* reserve size is rough guess */
-	GHash *map = BLI_ghash_int_new_ex("build_mesh_leaf_node gh", 2 * totface);
-
-	int (*face_vert_indices)[4] = MEM_callocN(sizeof(int[4]) * totface,
-	                                          "bvh node face vert indices");
-
-	node->face_vert_indices = (const int (*)[4])face_vert_indices;
+	const int sides = 3;
+	bool has_visible = false;
+	int *verts = MEM_mallocN(sizeof(int) * sides * totface, "bvh node vert indices");
+	int totvert = 0;
 
 	for (int i = 0; i < totface; ++i) {
 		const MLoopTri *lt = &bvh->looptri[node->prim_indices[i]];
-		const int sides = 3;
 
 		for (int j = 0; j < sides; ++j) {
-			face_vert_indices[i][j] =
-			        map_insert_vert(bvh, map, &node->face_verts,
-			                        &node->uniq_verts, bvh->mloop[lt->tri[j]].v);
+			verts[totvert++] = (int)bvh->mloop[lt->tri[j]].v;
 		}
 
 		if (!paint_is_face_hidden(lt, bvh->verts, bvh->mloop)) {
@@ -303,39 +291,88 @@ static void build_mesh_leaf_node(PBVH *bvh, PBVHNode *node)
 		}
 	}
 
-	int *vert_indices = MEM_callocN(sizeof(int) * (node->uniq_verts + node->face_verts),
-	                                "bvh node vert indices");
-	node->vert_indices = vert_indices;
+	if (totvert) {
+		int uniq = 1;
 
-	/* Build the vertex list, unique verts first */
-	GHashIterator gh_iter;
-	GHASH_ITER (gh_iter, map) {
-		void *value = BLI_ghashIterator_getValue(&gh_iter);
-		int ndx = GET_INT_FROM_POINTER(value);
+		qsort(verts, (size_t)totvert, sizeof(int), BLI_sortutil_cmp_int);
+		for (int i = 1; i < totvert; ++i) {
+			if (verts[i] != verts[uniq - 1]) {
+				verts[uniq++] = verts[i];
+			}
+		}
+		totvert = uniq;
+	}
+
+	/* the first leaf using a vertex owns it, regardless of which thread gets there first */
+	for (int i = 0; i < totvert; ++i) {
+		unsigned int *owner = &state->vert_owner[verts[i]];
+		unsigned int owner_prev = *owner;
+
+		while (leaf_order < owner_prev) {
+			const unsigned int owner_cur = atomic_cas_uint32(owner, owner_prev, leaf_order);
+			if (owner_cur == owner_prev) {
+				break;
+			}
+			owner_prev = owner_cur;
+		}
+	}
 
-		if (ndx < 0)
-			ndx = -ndx + node->uniq_verts - 1;
+	node->vert_indices = verts;
+	node->uniq_verts = 0;
+	node->face_verts = (unsigned int)totvert;
 
-		vert_indices[ndx] =
-		        GET_INT_FROM_POINTER(BLI_ghashIterator_getKey(&gh_iter));
+	BKE_pbvh_node_fully_hidden_set(node, !has_visible);
+}
+
+/* Order the vertices of a leaf with the ones it owns first, and map the face corners into them.
+ * Runs once all the leaves went through #build_mesh_leaf_verts. */
+static void build_mesh_leaf_node(PBVHBuildState *state, PBVHNode *node, const unsigned int leaf_order)
+{
+	PBVH *bvh = state->bvh;
+	const int totface = node->totprim;
+	const int totvert = (int)node->face_verts;
+	int *verts_sorted = (int *)node->vert_indices;
+	const int sides = 3;
+
+	int *vert_indices = MEM_mallocN(sizeof(int) * totvert, "bvh node vert indices");
+	int *vert_order = MEM_mallocN(sizeof(int) * totvert, __func__);
+	int uniq_verts = 0;
+
+	for (int i = 0; i < totvert; ++i) {
+		if (state->vert_owner[verts_sorted[i]] == leaf_order) {
+			uniq_verts++;
+		}
+	}
+
+	/* Build the vertex list, unique verts first */
+	for (int i = 0, uniq_index = 0, face_index = uniq_verts; i < totvert; ++i) {
+		vert_order[i] = (state->vert_owner[verts_sorted[i]] == leaf_order) ? uniq_index++ : face_index++;
+		vert_indices[vert_order[i]] = verts_sorted[i];
 	}
 
+	int (*face_vert_indices)[4] = MEM_callocN(sizeof(int[4]) * totface,
+	                                          "bvh node face vert indices");
+
 	for (int i = 0; i < totface; ++i) {
-		const int sides = 3;
+		const MLoopTri *lt = &bvh->looptri[node->prim_indices[i]];
 
 		for (int j = 0; j < sides; ++j) {
-			if (face_vert_indices[i][j] < 0)
-				face_vert_indices[i][j] =
-				        -face_vert_indices[i][j] +
-				        node->uniq_verts - 1;
+			const int v = (int)bvh->mloop[lt->tri[j]].v;
+			const int *v_p = bsearch(&v, verts_sorted, (size_t)totvert, sizeof(int), BLI_sortutil_cmp_int);
+
+			face_vert_indices[i][j] = vert_order[v_p - verts_sorted];
 		}
 	}
 
-	BKE_pbvh_node_mark_rebuild_draw(node);
+	node->vert_indices = vert_indices;
+	node->uniq_verts = (unsigned int)uniq_verts;
+	node->face_verts = (unsigned int)(totvert - uniq_verts);
+	node->face_vert_indices = (const int (*)[4])face_vert_indices;
 
-	BKE_pbvh_node_fully_hidden_set(node, !has_visible);
+	BKE_pbvh_node_mark_rebuild_draw(node);
 
-	BLI_ghash_free(map, NULL, NULL);
+	MEM_freeN(verts_sorted);
+	MEM_freeN(vert_order);
 }
 
 static void update_vb(PBVH *bvh, PBVHNode *node, BBC *prim_bbc,
@@ -387,24 +424,6 @@ static void build_grid_leaf_node(PBVH *bvh, PBVHNode *node)
 }
 
 
-static void build_leaf(PBVH *bvh, int node_index, BBC *prim_bbc,
-                       int offset, int count)
-{
-	bvh->nodes[node_index].flag |= PBVH_Leaf;
-
-	bvh->nodes[node_index].prim_indices = bvh->prim_indices + offset;
-	bvh->nodes[node_index].totprim = count;
-
-	/* Still need vb for searches */
-	update_vb(bvh, &bvh->nodes[node_index], prim_bbc, offset, count);
-		
-	if (bvh->looptri)
-		build_mesh_leaf_node(bvh, bvh->nodes + node_index);
-	else {
-		build_grid_leaf_node(bvh, bvh->nodes + node_index);
-	}
-}
-
 /* Return zero if all primitives in the node can be drawn with the
  * same material (including flat/smooth shading), non-zero otherwise */
 static bool leaf_needs_material_split(PBVH *bvh, int offset, int count)
@@ -438,46 +457,40 @@ static bool leaf_needs_material_split(PBVH *bvh, int offset, int count)
 }
 
 
-/* Recursively build a node in the tree
- *
- * vb is the voxel box around all of the primitives contained in
- * this node.
+static void build_sub_task(TaskPool * __restrict pool, void *taskdata, int threadid);
+
+/* Recursively split a range of primitives, only partitioning the prim_indices array,
+ * the nodes themselves are created afterwards by #build_nodes.
  *
  * cb is the bounding box around all the centroids of the primitives
- * contained in this node
+ * in the range, NULL to calculate it here.
  *
- * offset and start indicate a range in the array of primitive indices
- */
-
-static void build_sub(PBVH *bvh, int node_index, BB *cb, BBC *prim_bbc,
-                      int offset, int count)
+ * Ranges don't overlap, so big ones are split in their own task when \a pool is given. */
+static void build_sub(TaskPool *pool, PBVHBuildState *state, PBVHBuildInfo *info, BB *cb)
 {
+	PBVH *bvh = state->bvh;
+	const int offset = info->offset;
+	const int count = info->count;
 	int end;
 	BB cb_backing;
 
+	info->children = NULL;
+
 	/* Decide whether this is a leaf or not */
 	const bool below_leaf_limit = count <= bvh->leaf_limit;
 	if (below_leaf_limit) {
 		if (!leaf_needs_material_split(bvh, offset, count)) {
-			build_leaf(bvh, node_index, prim_bbc, offset, count);
 			return;
 		}
 	}
 
-	/* Add two child nodes */
-	bvh->nodes[node_index].children_offset = bvh->totnode;
-	pbvh_grow_nodes(bvh, bvh->totnode + 2);
-
-	/* Update parent node bounding box */
-	update_vb(bvh, &bvh->nodes[node_index], prim_bbc, offset, count);
-
 	if (!below_leaf_limit) {
 		/* Find axis with widest range of primitive centroids */
 		if (!cb) {
 			cb = &cb_backing;
 			BB_reset(cb);
 			for (int i = offset + count - 1; i >= offset; --i)
-				BB_expand(cb, prim_bbc[bvh->prim_indices[i]].bcentroid);
+				BB_expand(cb, state->prim_bbc[bvh->prim_indices[i]].bcentroid);
 		}
 		const int axis = BB_widest_axis(cb);
 
@@ -486,7 +499,7 @@ static void build_sub(PBVH *bvh, int node_index, BB *cb, BBC *prim_bbc,
 		                        offset, offset + count - 1,
 		                        axis,
 		                        (cb->bmax[axis] + cb->bmin[axis]) * 0.5f,
-		                        prim_bbc);
+		                        state->prim_bbc);
 	}
 	else {
 		/* Partition primitives by material */
@@ -494,10 +507,80 @@ static void build_sub(PBVH *bvh, int node_index, BB *cb, BBC *prim_bbc,
 	}
 
 	/* Build children */
-	build_sub(bvh, bvh->nodes[node_index].children_offset, NULL,
-	          prim_bbc, offset, end - offset);
-	build_sub(bvh, bvh->nodes[node_index].children_offset + 1, NULL,
-	          prim_bbc, end, offset + count - end);
+	PBVHBuildInfo *children = MEM_mallocN(sizeof(*children) * 2, __func__);
+	children[0].offset = offset;
+	children[0].count = end - offset;
+	children[1].offset = end;
+	children[1].count = offset + count - end;
+	info->children = children;
+
+	for (int i = 0; i < 2; ++i) {
+		if (pool && children[i].count > PBVH_BUILD_TASK_LIMIT) {
+			BLI_task_pool_push(pool, build_sub_task, &children[i], false, TASK_PRIORITY_HIGH);
+		}
+		else {
+			build_sub(pool, state, &children[i], NULL);
+		}
+	}
+}
+
+static void build_sub_task(TaskPool * __restrict pool, void *taskdata, int UNUSED(threadid))
+{
+	build_sub(pool, BLI_task_pool_userdata(pool), taskdata, NULL);
+}
+
+/* Create the nodes of the split ranges, in the same depth-first order as the recursion */
+static void build_nodes(PBVHBuildState *state, PBVHBuildInfo *info, int node_index)
+{
+	PBVH *bvh = state->bvh;
+
+	if (info->children) {
+		const int children_offset = bvh->totnode;
+
+		/* Add two child nodes */
+		bvh->nodes[node_index].children_offset = children_offset;
+		pbvh_grow_nodes(bvh, bvh->totnode + 2);
+
+		build_nodes(state, &info->children[0], children_offset);
+		build_nodes(state, &info->children[1], children_offset + 1);
+
+		MEM_freeN(info->children);
+	}
+	else {
+		PBVHNode *node = &bvh->nodes[node_index];
+
+		node->flag |= PBVH_Leaf;
+		node->prim_indices = bvh->prim_indices + info->offset;
+		node->totprim = (unsigned int)info->count;
+
+		if (UNLIKELY(state->totleaf == state->leaf_mem_count)) {
+			state->leaf_mem_count = max_ii(state->leaf_mem_count * 2, 64);
+			state->leaf_indices = MEM_reallocN(state->leaf_indices, sizeof(int) * state->leaf_mem_count);
+		}
+		state->leaf_indices[state->totleaf++] = node_index;
+	}
+}
+
+static void build_leaf_task_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	PBVHBuildState *state = userdata;
+	PBVH *bvh = state->bvh;
+	PBVHNode *node = &bvh->nodes[state->leaf_indices[i]];
+
+	/* Still need vb for searches */
+	update_vb(bvh, node, state->prim_bbc, (int)(node->prim_indices - bvh->prim_indices), (int)node->totprim);
+
+	if (bvh->looptri)
+		build_mesh_leaf_verts(state, node, (unsigned int)i);
+	else
+		build_grid_leaf_node(bvh, node);
+}
+
+static void build_mesh_leaf_task_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	PBVHBuildState *state = userdata;
+
+	build_mesh_leaf_node(state, &state->bvh->nodes[state->leaf_indices[i]], (unsigned int)i);
 }
 
 static void pbvh_build(PBVH *bvh, BB *cb, BBC *prim_bbc, int totprim)
@@ -519,8 +602,54 @@ static void pbvh_build(PBVH *bvh, BB *cb, BBC *prim_bbc, int totprim)
 		}
 	}
 
+	PBVHBuildState state = {.bvh = bvh, .prim_bbc = prim_bbc};
+	PBVHBuildInfo root = {.offset = 0, .count = totprim};
+	const bool use_threading = totprim > PBVH_BUILD_TASK_LIMIT;
+
+	/* Split the primitives, subtrees are independent so they can be split in parallel */
+	if (use_threading) {
+		TaskPool *pool = BLI_task_pool_create(BLI_task_scheduler_get(), &state);
+
+		build_sub(pool, &state, &root, cb);
+		BLI_task_pool_work_and_wait(pool);
+		BLI_task_pool_free(pool);
+	}
+	else {
+		build_sub(NULL, &state, &root, cb);
+	}
+
 	bvh->totnode = 1;
-	build_sub(bvh, 0, cb, prim_bbc, 0, totprim);
+	build_nodes(&state, &root, 0);
+
+	/* Fill the leaves, for meshes in two passes since a vertex is only unique to one of them */
+	if (bvh->looptri) {
+		state.vert_owner = MEM_mallocN(sizeof(*state.vert_owner) * bvh->totvert, __func__);
+		memset(state.vert_owner, 0xff, sizeof(*state.vert_owner) * bvh->totvert);
+	}
+
+	BLI_task_parallel_range_ex(
+	        0, state.totleaf, &state, NULL, 0, build_leaf_task_cb,
+	        use_threading, false);
+
+	if (bvh->looptri) {
+		BLI_task_parallel_range_ex(
+		        0, state.totleaf, &state, NULL, 0, build_mesh_leaf_task_cb,
+		        use_threading, false);
+
+		MEM_freeN(state.vert_owner);
+	}
+
+	MEM_freeN(state.leaf_indices);
+
+	/* Parent nodes have lower indices than their children, so the bounds can be merged back to front */
+	for (int n = bvh->totnode - 1; n >= 0; --n) {
+		PBVHNode *node = &bvh->nodes[n];
+
+		if (!(node->flag & PBVH_Leaf)) {
+			update_node_vb(bvh, node);
+			node->orig_vb = node->vb;
+		}
+	}
 }
 
 /* Do a full rebuild with on Mesh data structure */
@@ -537,7 +666,6 @@ void BKE_pbvh_build_mesh(
 	bvh->mloop = mloop;
 	bvh->looptri = looptri;
 	bvh->verts = verts;
-	bvh->vert_bitmap = BLI_BITMAP_NEW(totvert, "bvh->vert_bitmap");
 	bvh->totvert = totvert;
 	bvh->leaf_limit = LEAF_LIMIT;
 	bvh->vdata = vdata;
@@ -566,7 +694,6 @@ void BKE_pbvh_build_mesh(
 		pbvh_build(bvh, &cb, prim_bbc, looptri_num);
 
 	MEM_freeN(prim_bbc);
-	MEM_freeN(bvh->vert_bitmap);
 }
 
 /* Do a full rebuild with on Grids data structure */
@@ -926,10 +1053,102 @@ static bool update_search_cb(PBVHNode *node, void *data_v)
 	return true;
 }
 
+typedef struct PBVHUpdateData {
+	PBVH *bvh;
+	PBVHNode **nodes;
+	int flag;
+
+	/* for normals */
+	float (*face_nors)[3];
+	float (*vnors)[3];
+} PBVHUpdateData;
+
+static void pbvh_update_normals_accum_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	PBVHUpdateData *data = userdata;
+
+	PBVH *bvh = data->bvh;
+	PBVHNode *node = data->nodes[n];
+	float (*face_nors)[3] = data->face_nors;
+	float (*vnors)[3] = data->vnors;
+
+	if ((node->flag & PBVH_UpdateNormals)) {
+		unsigned int mpoly_prev = UINT_MAX;
+		float fn[3];
+
+		const int *faces = node->prim_indices;
+		const int totface = node->totprim;
+
+		for (int i = 0; i < totface; ++i) {
+			const MLoopTri *lt = &bvh->looptri[faces[i]];
+			const unsigned int vtri[3] = {
+			    bvh->mloop[lt->tri[0]].v,
+			    bvh->mloop[lt->tri[1]].v,
+			    bvh->mloop[lt->tri[2]].v,
+			};
+			const int sides = 3;
+
+			/* Face normal and mask */
+			if (lt->poly != mpoly_prev) {
+				const MPoly *mp = &bvh->mpoly[lt->poly];
+				BKE_mesh_calc_poly_normal(mp, &bvh->mloop[mp->loopstart], bvh->verts, fn);
+				mpoly_prev = lt->poly;
+
+				if (face_nors) {
+					copy_v3_v3(face_nors[lt->poly], fn);
+				}
+			}
+
+			for (int j = 0; j < sides; ++j) {
+				int v = vtri[j];
+
+				if (bvh->verts[v].flag & ME_VERT_PBVH_UPDATE) {
+					/* vertices are shared by nodes, so add per component,
+					 * only atomicity of each component is needed here */
+					atomic_add_fl(&vnors[v][0], fn[0]);
+					atomic_add_fl(&vnors[v][1], fn[1]);
+					atomic_add_fl(&vnors[v][2], fn[2]);
+				}
+			}
+		}
+	}
+}
+
+static void pbvh_update_normals_store_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	PBVHUpdateData *data = userdata;
+
+	PBVH *bvh = data->bvh;
+	PBVHNode *node = data->nodes[n];
+	float (*vnors)[3] = data->vnors;
+
+	if (node->flag & PBVH_UpdateNormals) {
+		const int *verts = node->vert_indices;
+		const int totvert = node->uniq_verts;
+
+		for (int i = 0; i < totvert; ++i) {
+			const int v = verts[i];
+			MVert *mvert = &bvh->verts[v];
+
+			if (mvert->flag & ME_VERT_PBVH_UPDATE) {
+				float no[3];
+
+				copy_v3_v3(no, vnors[v]);
+				normalize_v3(no);
+				normal_float_to_short_v3(mvert->no, no);
+
+				mvert->flag &= ~ME_VERT_PBVH_UPDATE;
+			}
+		}
+
+		node->flag &= ~PBVH_UpdateNormals;
+	}
+}
+
 static void pbvh_update_normals(PBVH *bvh, PBVHNode **nodes,
                                 int totnode, float (*face_nors)[3])
 {
-	float (*vnor)[3];
+	float (*vnors)[3];
 
 	if (bvh->type == PBVH_BMESH) {
 		BLI_assert(face_nors == NULL);
@@ -937,12 +1156,12 @@ static void pbvh_update_normals(PBVH *bvh, PBVHNode **nodes,
 		return;
 	}
 
-	if (bvh->type != PBVH_FACES)
+	if (bvh->type != PBVH_FACES || totnode == 0)
 		return;
 
 	/* could be per node to save some memory, but also means
 	 * we have to store for each vertex which node it is in */
-	vnor = MEM_callocN(sizeof(float) * 3 * bvh->totvert, "bvh temp vnors");
+	vnors = MEM_callocN(sizeof(*vnors) * bvh->totvert, __func__);
 
 	/* subtle assumptions:
 	 * - We know that for all edited vertices, the nodes with faces
@@ -954,104 +1173,54 @@ static void pbvh_update_normals(PBVH *bvh, PBVHNode **nodes,
 	 *   can only update vertices marked with ME_VERT_PBVH_UPDATE.
 	 */
 
-	int n;
-#pragma omp parallel for private(n) schedule(static) if (totnode > PBVH_OMP_LIMIT)
-	for (n = 0; n < totnode; n++) {
-		PBVHNode *node = nodes[n];
+	PBVHUpdateData data = {
+		.bvh = bvh, .nodes = nodes,
+		.face_nors = face_nors, .vnors = vnors,
+	};
 
-		if ((node->flag & PBVH_UpdateNormals)) {
-			unsigned int mpoly_prev = UINT_MAX;
-			float fn[3];
-
-			const int *faces = node->prim_indices;
-			const int totface = node->totprim;
-
-			for (int i = 0; i < totface; ++i) {
-				const MLoopTri *lt = &bvh->looptri[faces[i]];
-				const unsigned int vtri[3] = {
-				    bvh->mloop[lt->tri[0]].v,
-				    bvh->mloop[lt->tri[1]].v,
-				    bvh->mloop[lt->tri[2]].v,
-				};
-				const int sides = 3;
-
-				/* Face normal and mask */
-				if (lt->poly != mpoly_prev) {
-					const MPoly *mp = &bvh->mpoly[lt->poly];
-					BKE_mesh_calc_poly_normal(mp, &bvh->mloop[mp->loopstart], bvh->verts, fn);
-					mpoly_prev = lt->poly;
-
-					if (face_nors) {
-						copy_v3_v3(face_nors[lt->poly], fn);
-					}
-				}
+	BLI_task_parallel_range_ex(
+	        0, totnode, &data, NULL, 0, pbvh_update_normals_accum_task_cb,
+	        totnode > PBVH_THREADED_LIMIT, false);
 
-				for (int j = 0; j < sides; ++j) {
-					int v = vtri[j];
-
-					if (bvh->verts[v].flag & ME_VERT_PBVH_UPDATE) {
-						/* this seems like it could be very slow but profile
-						 * does not show this, so just leave it for now? */
-#pragma omp atomic
-						vnor[v][0] += fn[0];
-#pragma omp atomic
-						vnor[v][1] += fn[1];
-#pragma omp atomic
-						vnor[v][2] += fn[2];
-					}
-				}
-			}
-		}
-	}
-
-#pragma omp parallel for private(n) schedule(static) if (totnode > PBVH_OMP_LIMIT)
-	for (n = 0; n < totnode; n++) {
-		PBVHNode *node = nodes[n];
+	BLI_task_parallel_range_ex(
+	        0, totnode, &data, NULL, 0, pbvh_update_normals_store_task_cb,
+	        totnode > PBVH_THREADED_LIMIT, false);
 
-		if (node->flag & PBVH_UpdateNormals) {
-			const int *verts = node->vert_indices;
-			const int totvert = node->uniq_verts;
+	MEM_freeN(vnors);
+}
 
-			for (int i = 0; i < totvert; ++i) {
-				const int v = verts[i];
-				MVert *mvert = &bvh->verts[v];
+static void pbvh_update_BB_redraw_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	PBVHUpdateData *data = userdata;
+	PBVH *bvh = data->bvh;
+	PBVHNode *node = data->nodes[n];
+	const int flag = data->flag;
 
-				if (mvert->flag & ME_VERT_PBVH_UPDATE) {
-					float no[3];
+	if ((flag & PBVH_UpdateBB) && (node->flag & PBVH_UpdateBB))
+		/* don't clear flag yet, leave it for flushing later */
+		update_node_vb(bvh, node);
 
-					copy_v3_v3(no, vnor[v]);
-					normalize_v3(no);
-					normal_float_to_short_v3(mvert->no, no);
+	if ((flag & PBVH_UpdateOriginalBB) && (node->flag & PBVH_UpdateOriginalBB))
+		node->orig_vb = node->vb;
 
-					mvert->flag &= ~ME_VERT_PBVH_UPDATE;
-				}
-			}
-
-			node->flag &= ~PBVH_UpdateNormals;
-		}
-	}
-
-	MEM_freeN(vnor);
+	if ((flag & PBVH_UpdateRedraw) && (node->flag & PBVH_UpdateRedraw))
+		node->flag &= ~PBVH_UpdateRedraw;
 }
 
 void pbvh_update_BB_redraw(PBVH *bvh, PBVHNode **nodes, int totnode, int flag)
 {
 	/* update BB, redraw flag */
-	int n;
-#pragma omp parallel for private(n) schedule(static) if (totnode > PBVH_OMP_LIMIT)
-	for (n = 0; n < totnode; n++) {
-		PBVHNode *node = nodes[n];
+	PBVHUpdateData data = {
+		.bvh = bvh, .nodes = nodes,
+		.flag = flag,
+	};
 
-		if ((flag & PBVH_UpdateBB) && (node->flag & PBVH_UpdateBB))
-			/* don't clear flag yet, leave it for flushing later */
-			update_node_vb(bvh, node);
-
-		if ((flag & PBVH_UpdateOriginalBB) && (node->flag & PBVH_UpdateOriginalBB))
-			node->orig_vb = node->vb;
+	if (totnode == 0)
+		return;
 
-		if ((flag & PBVH_UpdateRedraw) && (node->flag & PBVH_UpdateRedraw))
-			node->flag &= ~PBVH_UpdateRedraw;
-	}
+	BLI_task_parallel_range_ex(
+	        0, totnode, &data, NULL, 0, pbvh_update_BB_redraw_task_cb,
+	        totnode > PBVH_THREADED_LIMIT, false);
 }
 
 static void pbvh_update_draw_buffers(PBVH *bvh, PBVHNode **nodes, int totnode)
@@ -30,6 +30,7 @@
 #include "BLI_heap.h"
 #include "BLI_math.h"
 #include "BLI_memarena.h"
+#include "BLI_task.h"
 
 #include "BKE_ccg.h"
 #include "BKE_DerivedMesh.h"
@@ -641,6 +642,20 @@ static bool edge_queue_tri_in_sphere(const EdgeQueue *q, BMFace *f)
 	return len_squared_v3v3(q->center, c) <= q->radius_squared;
 }
 
+/* Return true if the face should have its edges checked for the queue */
+static bool edge_queue_face_test(const EdgeQueue *q, BMFace *f)
+{
+#ifdef USE_EDGEQUEUE_FRONTFACE
+	if (q->use_view_normal) {
+		if (dot_v3v3(f->no, q->view_normal) < 0.0f) {
+			return false;
+		}
+	}
+#endif
+
+	return edge_queue_tri_in_sphere(q, f);
+}
+
 /* Return true if the vertex mask is less than 1.0, false otherwise */
 static bool check_mask(EdgeQueueContext *eq_ctx, BMVert *v)
 {
@@ -764,59 +779,130 @@ static void short_edge_queue_edge_add(
 	}
 }
 
-static void long_edge_queue_face_add(
+/* Add the edges of a face which passed #edge_queue_face_test */
+static void long_edge_queue_face_edges_add(
         EdgeQueueContext *eq_ctx,
         BMFace *f)
 {
-#ifdef USE_EDGEQUEUE_FRONTFACE
-	if (eq_ctx->q->use_view_normal) {
-		if (dot_v3v3(f->no, eq_ctx->q->view_normal) < 0.0f) {
-			return;
-		}
-	}
-#endif
-
-	if (edge_queue_tri_in_sphere(eq_ctx->q, f)) {
-		/* Check each edge of the face */
-		BMLoop *l_first = BM_FACE_FIRST_LOOP(f);
-		BMLoop *l_iter = l_first;
-		do {
+	/* Check each edge of the face */
+	BMLoop *l_first = BM_FACE_FIRST_LOOP(f);
+	BMLoop *l_iter = l_first;
+	do {
 #ifdef USE_EDGEQUEUE_EVEN_SUBDIV
-			const float len_sq = BM_edge_calc_length_squared(l_iter->e);
-			if (len_sq > eq_ctx->q->limit_len_squared) {
-				long_edge_queue_edge_add_recursive(
-				        eq_ctx, l_iter->radial_next, l_iter,
-				        len_sq, eq_ctx->q->limit_len);
-			}
+		const float len_sq = BM_edge_calc_length_squared(l_iter->e);
+		if (len_sq > eq_ctx->q->limit_len_squared) {
+			long_edge_queue_edge_add_recursive(
+			        eq_ctx, l_iter->radial_next, l_iter,
+			        len_sq, eq_ctx->q->limit_len);
+		}
 #else
-			long_edge_queue_edge_add(eq_ctx, l_iter->e);
+		long_edge_queue_edge_add(eq_ctx, l_iter->e);
 #endif
-		} while ((l_iter = l_iter->next) != l_first);
+	} while ((l_iter = l_iter->next) != l_first);
+}
+
+static void long_edge_queue_face_add(
+        EdgeQueueContext *eq_ctx,
+        BMFace *f)
+{
+	if (edge_queue_face_test(eq_ctx->q, f)) {
+		long_edge_queue_face_edges_add(eq_ctx, f);
 	}
 }
 
-static void short_edge_queue_face_add(
+/* Add the edges of a face which passed #edge_queue_face_test */
+static void short_edge_queue_face_edges_add(
         EdgeQueueContext *eq_ctx,
         BMFace *f)
 {
-#ifdef USE_EDGEQUEUE_FRONTFACE
-	if (eq_ctx->q->use_view_normal) {
-		if (dot_v3v3(f->no, eq_ctx->q->view_normal) < 0.0f) {
-			return;
+	BMLoop *l_iter;
+	BMLoop *l_first;
+
+	/* Check each edge of the face */
+	l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+	do {
+		short_edge_queue_edge_add(eq_ctx, l_iter->e);
+	} while ((l_iter = l_iter->next) != l_first);
+}
+
+/* Faces of a node which passed #edge_queue_face_test */
+typedef struct EdgeQueueNodeFaces {
+	BMFace **faces;
+	int totface;
+} EdgeQueueNodeFaces;
+
+typedef struct EdgeQueueGatherData {
+	const EdgeQueue *q;
+	PBVHNode **nodes;
+	EdgeQueueNodeFaces *node_faces;
+} EdgeQueueGatherData;
+
+static void edge_queue_gather_faces_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	EdgeQueueGatherData *data = userdata;
+	PBVHNode *node = data->nodes[n];
+	EdgeQueueNodeFaces *node_faces = &data->node_faces[n];
+	GSetIterator gs_iter;
+	int totface = 0;
+
+	node_faces->faces = MEM_mallocN(sizeof(*node_faces->faces) * max_ii(BLI_gset_size(node->bm_faces), 1), __func__);
+
+	/* Check each face */
+	GSET_ITER (gs_iter, node->bm_faces) {
+		BMFace *f = BLI_gsetIterator_getKey(&gs_iter);
+
+		if (edge_queue_face_test(data->q, f)) {
+			node_faces->faces[totface++] = f;
 		}
 	}
-#endif
 
-	if (edge_queue_tri_in_sphere(eq_ctx->q, f)) {
-		BMLoop *l_iter;
-		BMLoop *l_first;
+	node_faces->totface = totface;
+}
 
-		/* Check each edge of the face */
-		l_iter = l_first = BM_FACE_FIRST_LOOP(f);
-		do {
-			short_edge_queue_edge_add(eq_ctx, l_iter->e);
-		} while ((l_iter = l_iter->next) != l_first);
+/**
+ * Test the faces of the leaf nodes marked for topology update against the brush,
+ * one node per task since this is read-only.
+ *
+ * Adding the edges tags them and allocates from the queue's mempool,
+ * so that part is left to the caller, which runs over the result in node order
+ * (any given stroke step gives the same queue as a single threaded loop).
+ *
+ * eturn An array of  r_totnode face arrays, the caller frees them.
+ */
+static EdgeQueueNodeFaces *edge_queue_gather_faces(PBVH *bvh, const EdgeQueue *q, int *r_totnode)
+{
+	PBVHNode **nodes = MEM_mallocN(sizeof(*nodes) * max_ii(bvh->totnode, 1), __func__);
+	EdgeQueueNodeFaces *node_faces;
+	int totnode = 0;
+
+	for (int n = 0; n < bvh->totnode; n++) {
+		PBVHNode *node = &bvh->nodes[n];
+
+		/* Check leaf nodes marked for topology update */
+		if ((node->flag & PBVH_Leaf) &&
+		    (node->flag & PBVH_UpdateTopology) &&
+		    !(node->flag & PBVH_FullyHidden))
+		{
+			nodes[totnode++] = node;
+		}
 	}
+
+	node_faces = MEM_mallocN(sizeof(*node_faces) * max_ii(totnode, 1), __func__);
+
+	if (totnode != 0) {
+		EdgeQueueGatherData data = {
+		    .q = q, .nodes = nodes, .node_faces = node_faces,
+		};
+
+		BLI_task_parallel_range_ex(
+		        0, totnode, &data, NULL, 0, edge_queue_gather_faces_task_cb,
+		        totnode > 1, false);
+	}
+
+	MEM_freeN(nodes);
+
+	*r_totnode = totnode;
+	return node_faces;
 }
 
 /* Create a priority queue containing vertex pairs connected by a long
@@ -833,6 +919,9 @@ static void long_edge_queue_create(
         PBVH *bvh, const float center[3], const float view_normal[3],
         float radius)
 {
+	EdgeQueueNodeFaces *node_faces;
+	int totnode;
+
 	eq_ctx->q->heap = BLI_heap_new();
 	eq_ctx->q->center = center;
 	eq_ctx->q->radius_squared = radius * radius;
@@ -852,24 +941,16 @@ static void long_edge_queue_create(
 	pbvh_bmesh_edge_tag_verify(bvh);
 #endif
 
-	for (int n = 0; n < bvh->totnode; n++) {
-		PBVHNode *node = &bvh->nodes[n];
+	node_faces = edge_queue_gather_faces(bvh, eq_ctx->q, &totnode);
 
-		/* Check leaf nodes marked for topology update */
-		if ((node->flag & PBVH_Leaf) &&
-		    (node->flag & PBVH_UpdateTopology) &&
-		    !(node->flag & PBVH_FullyHidden))
-		{
-			GSetIterator gs_iter;
-
-			/* Check each face */
-			GSET_ITER (gs_iter, node->bm_faces) {
-				BMFace *f = BLI_gsetIterator_getKey(&gs_iter);
-
-				long_edge_queue_face_add(eq_ctx, f);
-			}
+	for (int n = 0; n < totnode; n++) {
+		for (int i = 0; i < node_faces[n].totface; i++) {
+			long_edge_queue_face_edges_add(eq_ctx, node_faces[n].faces[i]);
 		}
+		MEM_freeN(node_faces[n].faces);
 	}
+
+	MEM_freeN(node_faces);
 }
 
 /* Create a priority queue containing vertex pairs connected by a
@@ -886,6 +967,9 @@ static void short_edge_queue_create(
         PBVH *bvh, const float center[3], const float view_normal[3],
         float radius)
 {
+	EdgeQueueNodeFaces *node_faces;
+	int totnode;
+
 	eq_ctx->q->heap = BLI_heap_new();
 	eq_ctx->q->center = center;
 	eq_ctx->q->radius_squared = radius * radius;
@@ -901,24 +985,16 @@ static void short_edge_queue_create(
 	UNUSED_VARS(view_normal);
 #endif
 
-	for (int n = 0; n < bvh->totnode; n++) {
-		PBVHNode *node = &bvh->nodes[n];
-
-		/* Check leaf nodes marked for topology update */
-		if ((node->flag & PBVH_Leaf) &&
-		    (node->flag & PBVH_UpdateTopology) &&
-		    !(node->flag & PBVH_FullyHidden))
-		{
-			GSetIterator gs_iter;
+	node_faces = edge_queue_gather_faces(bvh, eq_ctx->q, &totnode);
 
-			/* Check each face */
-			GSET_ITER (gs_iter, node->bm_faces) {
-				BMFace *f = BLI_gsetIterator_getKey(&gs_iter);
-
-				short_edge_queue_face_add(eq_ctx, f);
-			}
+	for (int n = 0; n < totnode; n++) {
+		for (int i = 0; i < node_faces[n].totface; i++) {
+			short_edge_queue_face_edges_add(eq_ctx, node_faces[n].faces[i]);
 		}
+		MEM_freeN(node_faces[n].faces);
 	}
+
+	MEM_freeN(node_faces);
 }
 
 /*************************** Topology update **************************/
@@ -47,6 +47,7 @@
 #include "DNA_smoke_types.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_math.h"
 #include "BLI_utildefines.h"
@@ -1526,10 +1527,19 @@ static int ptcache_filename(PTCacheID *pid, char *filename, int cfra, short do_p
 	return len; /* make sure the above string is always 16 chars */
 }
 
+static PTCacheFile *ptcache_file_from_fp(FILE *fp, int cfra)
+{
+	PTCacheFile *pf = MEM_mallocN(sizeof(PTCacheFile), "PTCacheFile");
+	pf->fp = fp;
+	pf->old_format = 0;
+	pf->frame = cfra;
+
+	return pf;
+}
+
 /* youll need to close yourself after! */
 static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
 {
-	PTCacheFile *pf;
 	FILE *fp = NULL;
 	char filename[FILE_MAX * 2];
 
@@ -1560,12 +1570,7 @@ static PTCacheFile *ptcache_file_open(PTCacheID *pid, int mode, int cfra)
 	if (!fp)
 		return NULL;
 
-	pf= MEM_mallocN(sizeof(PTCacheFile), "PTCacheFile");
-	pf->fp= fp;
-	pf->old_format = 0;
-	pf->frame = cfra;
-
-	return pf;
+	return ptcache_file_from_fp(fp, cfra);
 }
 static void ptcache_file_close(PTCacheFile *pf)
 {
@@ -1945,19 +1950,17 @@ static void ptcache_find_frames_around(PTCacheID *pid, unsigned int frame, int *
 	}
 }
 
-static PTCacheMem *ptcache_disk_frame_to_mem(PTCacheID *pid, int cfra)
+/* reads an opened cache file into a new memory frame and closes it,
+ * only uses the file so it's safe to call from a thread */
+static PTCacheMem *ptcache_file_to_mem(PTCacheFile *pf, int type, int (*read_header)(PTCacheFile *pf))
 {
-	PTCacheFile *pf = ptcache_file_open(pid, PTCACHE_FILE_READ, cfra);
 	PTCacheMem *pm = NULL;
 	unsigned int i, error = 0;
 
-	if (pf == NULL)
-		return NULL;
-
 	if (!ptcache_file_header_begin_read(pf))
 		error = 1;
 
-	if (!error && (pf->type != pid->type || !pid->read_header(pf)))
+	if (!error && (pf->type != type || !read_header(pf)))
 		error = 1;
 
 	if (!error) {
@@ -2026,6 +2029,161 @@ static PTCacheMem *ptcache_disk_frame_to_mem(PTCacheID *pid, int cfra)
 	
 	return pm;
 }
+static PTCacheMem *ptcache_disk_frame_to_mem(PTCacheID *pid, int cfra)
+{
+	PTCacheFile *pf = ptcache_file_open(pid, PTCACHE_FILE_READ, cfra);
+
+	if (pf == NULL)
+		return NULL;
+
+	return ptcache_file_to_mem(pf, pid->type, pid->read_header);
+}
+
+/* Disk cache read-ahead
+ *
+ * While playing back a disk cache the next cached frame is read and decompressed
+ * by a background task, so the following read only has to copy it into the simulation.
+ * Every cache has at most one frame in flight, it's dropped as soon as the cache files change.
+ */
+typedef struct PTCacheReadAhead {
+	struct PTCacheReadAhead *next, *prev;
+	PointCache *cache; /* only used as key, the task never touches it */
+	TaskPool *pool;
+	char filename[MAX_PTCACHE_FILE];
+	int type, frame;
+	int (*read_header)(PTCacheFile *pf);
+	PTCacheMem *pm; /* result of the task, NULL if the file couldn't be read */
+} PTCacheReadAhead;
+
+static ListBase ptcache_read_ahead_list = {NULL, NULL};
+static ThreadMutex ptcache_read_ahead_lock = BLI_MUTEX_INITIALIZER;
+
+static void ptcache_read_ahead_task(TaskPool *__restrict pool, void *UNUSED(taskdata), int UNUSED(threadid))
+{
+	PTCacheReadAhead *ra = BLI_task_pool_userdata(pool);
+	FILE *fp = BLI_fopen(ra->filename, "rb");
+
+	if (fp)
+		ra->pm = ptcache_file_to_mem(ptcache_file_from_fp(fp, ra->frame), ra->type, ra->read_header);
+}
+static void ptcache_read_ahead_free(PTCacheReadAhead *ra)
+{
+	/* waits for the task if it's running already */
+	BLI_task_pool_cancel(ra->pool);
+	BLI_task_pool_free(ra->pool);
+
+	if (ra->pm) {
+		ptcache_data_free(ra->pm);
+		ptcache_extra_free(ra->pm);
+		MEM_freeN(ra->pm);
+	}
+
+	MEM_freeN(ra);
+}
+static PTCacheReadAhead *ptcache_read_ahead_pop(PointCache *cache)
+{
+	PTCacheReadAhead *ra;
+
+	BLI_mutex_lock(&ptcache_read_ahead_lock);
+	for (ra = ptcache_read_ahead_list.first; ra; ra = ra->next) {
+		if (ra->cache == cache) {
+			BLI_remlink(&ptcache_read_ahead_list, ra);
+			break;
+		}
+	}
+	BLI_mutex_unlock(&ptcache_read_ahead_lock);
+
+	return ra;
+}
+/* drop the frame read ahead for this cache, needed whenever its files are changed */
+static void ptcache_read_ahead_discard(PointCache *cache)
+{
+	PTCacheReadAhead *ra = ptcache_read_ahead_pop(cache);
+
+	if (ra)
+		ptcache_read_ahead_free(ra);
+}
+/* start reading the first cached frame after cfra */
+static void ptcache_read_ahead_start(PTCacheID *pid, int cfra)
+{
+	PointCache *cache = pid->cache;
+	PTCacheReadAhead *ra, *ra_old;
+	int fra;
+
+	ptcache_read_ahead_discard(cache);
+
+	for (fra = cfra + 1; fra <= cfra + cache->step; fra++) {
+		if (BKE_ptcache_id_exist(pid, fra))
+			break;
+	}
+
+	if (fra > cfra + cache->step)
+		return;
+
+	ra = MEM_callocN(sizeof(PTCacheReadAhead), "PTCacheReadAhead");
+
+	if (ptcache_filename(pid, ra->filename, fra, 1, 1) == 0) {
+		MEM_freeN(ra);
+		return;
+	}
+
+	ra->cache = cache;
+	ra->type = pid->type;
+	ra->frame = fra;
+	ra->read_header = pid->read_header;
+
+	ra->pool = BLI_task_pool_create_background(BLI_task_scheduler_get(), ra);
+	BLI_task_pool_push(ra->pool, ptcache_read_ahead_task, NULL, false, TASK_PRIORITY_LOW);
+
+	/* another thread may have started one for the same cache meanwhile */
+	ra_old = ptcache_read_ahead_pop(cache);
+
+	BLI_mutex_lock(&ptcache_read_ahead_lock);
+	BLI_addtail(&ptcache_read_ahead_list, ra);
+	BLI_mutex_unlock(&ptcache_read_ahead_lock);
+
+	if (ra_old)
+		ptcache_read_ahead_free(ra_old);
+}
+/* get the frame read ahead for cfra, if there's one for the current cache files */
+static PTCacheMem *ptcache_read_ahead_take(PTCacheID *pid, int cfra)
+{
+	PTCacheReadAhead *ra = ptcache_read_ahead_pop(pid->cache);
+	PTCacheMem *pm = NULL;
+
+	if (ra == NULL)
+		return NULL;
+
+	if (ra->frame == cfra && ra->type == pid->type) {
+		char filename[MAX_PTCACHE_FILE];
+
+		ptcache_filename(pid, filename, cfra, 1, 1);
+
+		if (STREQ(filename, ra->filename)) {
+			BLI_task_pool_work_and_wait(ra->pool);
+			pm = ra->pm;
+			ra->pm = NULL;
+		}
+	}
+
+	ptcache_read_ahead_free(ra);
+
+	return pm;
+}
+/* like ptcache_disk_frame_to_mem, but uses and starts the read-ahead of the following frame */
+static PTCacheMem *ptcache_disk_frame_to_mem_read_ahead(PTCacheID *pid, int cfra)
+{
+	PTCacheMem *pm = ptcache_read_ahead_take(pid, cfra);
+
+	if (pm == NULL)
+		pm = ptcache_disk_frame_to_mem(pid, cfra);
+
+	/* frame 0 is the info file */
+	if (pm && cfra)
+		ptcache_read_ahead_start(pid, cfra);
+
+	return pm;
+}
 static int ptcache_mem_frame_to_disk(PTCacheID *pid, PTCacheMem *pm)
 {
 	PTCacheFile *pf = NULL;
@@ -2164,7 +2322,7 @@ static int ptcache_read(PTCacheID *pid, int cfra)
 
 	/* get a memory cache to read from */
 	if (pid->cache->flag & PTCACHE_DISK_CACHE) {
-		pm = ptcache_disk_frame_to_mem(pid, cfra);
+		pm = ptcache_disk_frame_to_mem_read_ahead(pid, cfra);
 	}
 	else {
 		pm = pid->cache->mem_cache.first;
@@ -2218,7 +2376,7 @@ static int ptcache_interpolate(PTCacheID *pid, float cfra, int cfra1, int cfra2)
 
 	/* get a memory cache to read from */
 	if (pid->cache->flag & PTCACHE_DISK_CACHE) {
-		pm = ptcache_disk_frame_to_mem(pid, cfra2);
+		pm = ptcache_disk_frame_to_mem_read_ahead(pid, cfra2);
 	}
 	else {
 		pm = pid->cache->mem_cache.first;
@@ -2547,7 +2705,12 @@ void BKE_ptcache_id_clear(PTCacheID *pid, int mode, unsigned int cfra)
 	char path_full[MAX_PTCACHE_FILE];
 	char ext[MAX_PTCACHE_PATH];
 
-	if (!pid || !pid->cache || pid->cache->flag & PTCACHE_BAKED)
+	if (!pid || !pid->cache)
+		return;
+
+	ptcache_read_ahead_discard(pid->cache);
+
+	if (pid->cache->flag & PTCACHE_BAKED)
 		return;
 
 	if (pid->cache->flag & PTCACHE_IGNORE_CLEAR)
@@ -3031,6 +3194,7 @@ void BKE_ptcache_free_mem(ListBase *mem_cache)
 }
 void BKE_ptcache_free(PointCache *cache)
 {
+	ptcache_read_ahead_discard(cache);
 	BKE_ptcache_free_mem(&cache->mem_cache);
 	if (cache->edit && cache->free_edit)
 		cache->free_edit(cache->edit);
@@ -3463,6 +3627,8 @@ void BKE_ptcache_toggle_disk_cache(PTCacheID *pid)
 	PointCache *cache = pid->cache;
 	int last_exact = cache->last_exact;
 
+	ptcache_read_ahead_discard(cache);
+
 	if (!G.relbase_valid) {
 		cache->flag &= ~PTCACHE_DISK_CACHE;
 		if (G.debug & G_DEBUG)
@@ -3511,6 +3677,8 @@ void BKE_ptcache_disk_cache_rename(PTCacheID *pid, const char *name_src, const c
 	char old_path_full[MAX_PTCACHE_FILE];
 	char ext[MAX_PTCACHE_PATH];
 
+	ptcache_read_ahead_discard(pid->cache);
+
 	/* save old name */
 	BLI_strncpy(old_name, pid->cache->name, sizeof(old_name));
 
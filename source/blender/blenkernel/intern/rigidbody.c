@@ -1207,7 +1207,31 @@ static void rigidbody_update_sim_world(Scene *scene, RigidBodyWorld *rbw)
 	rigidbody_update_ob_array(rbw);
 }
 
-static void rigidbody_update_sim_ob(Scene *scene, RigidBodyWorld *rbw, Object *ob, RigidBodyOb *rbo)
+/* Effectors acting on the simulation objects.
+ * Bodies getting forces are never effectors themselves, so the effectors only depend on the layers
+ * of the body and can be shared by all bodies on the same layers, instead of collecting them for every body.
+ */
+typedef struct RigidBodyEffectors {
+	ListBase *effectors;
+	unsigned int lay;
+	bool is_init;
+} RigidBodyEffectors;
+
+static ListBase *rigidbody_effectors_get(Scene *scene, RigidBodyWorld *rbw, Object *ob, RigidBodyEffectors *rbe)
+{
+	if (!rbe->is_init || rbe->lay != ob->lay) {
+		pdEndEffectors(&rbe->effectors);
+
+		rbe->effectors = pdInitEffectors(scene, ob, NULL, rbw->effector_weights, true);
+		rbe->lay = ob->lay;
+		rbe->is_init = true;
+	}
+
+	return rbe->effectors;
+}
+
+static void rigidbody_update_sim_ob(Scene *scene, RigidBodyWorld *rbw, Object *ob, RigidBodyOb *rbo,
+                                    RigidBodyEffectors *rbe)
 {
 	float loc[3];
 	float rot[4];
@@ -1255,7 +1279,7 @@ static void rigidbody_update_sim_ob(Scene *scene, RigidBodyWorld *rbw, Object *o
 		ListBase *effectors;
 
 		/* get effectors present in the group specified by effector_weights */
-		effectors = pdInitEffectors(scene, ob, NULL, effector_weights, true);
+		effectors = rigidbody_effectors_get(scene, rbw, ob, rbe);
 		if (effectors) {
 			float eff_force[3] = {0.0f, 0.0f, 0.0f};
 			float eff_loc[3], eff_vel[3];
@@ -1280,9 +1304,6 @@ static void rigidbody_update_sim_ob(Scene *scene, RigidBodyWorld *rbw, Object *o
 		}
 		else if (G.f & G_DEBUG)
 			printf("\tno forces to apply to '%s'\n", ob->id.name + 2);
-
-		/* cleanup */
-		pdEndEffectors(&effectors);
 	}
 	/* NOTE: passive objects don't need to be updated since they don't move */
 
@@ -1299,6 +1320,7 @@ static void rigidbody_update_sim_ob(Scene *scene, RigidBodyWorld *rbw, Object *o
 static void rigidbody_update_simulation(Scene *scene, RigidBodyWorld *rbw, bool rebuild)
 {
 	GroupObject *go;
+	RigidBodyEffectors rbe = {NULL};
 
 	/* update world */
 	if (rebuild)
@@ -1367,9 +1389,12 @@ static void rigidbody_update_simulation(Scene *scene, RigidBodyWorld *rbw, bool
 			}
 
 			/* update simulation object... */
-			rigidbody_update_sim_ob(scene, rbw, ob, rbo);
+			rigidbody_update_sim_ob(scene, rbw, ob, rbo, &rbe);
 		}
 	}
+
+	/* cleanup */
+	pdEndEffectors(&rbe.effectors);
 	
 	/* update constraints */
 	if (rbw->constraints == NULL) /* no constraints, move on */
@@ -57,6 +57,7 @@
 #include "BLI_string.h"
 #include "BLI_threads.h"
 #include "BLI_task.h"
+#include "BLI_trace.h"
 
 #include "BLT_translation.h"
 
@@ -1775,6 +1776,7 @@ void BKE_scene_update_tagged(EvaluationContext *eval_ctx, Main *bmain, Scene *sc
 #ifdef WITH_LEGACY_DEPSGRAPH
 	bool use_new_eval = !DEG_depsgraph_use_legacy();
 #endif
+	const double trace_start = BLI_trace_begin();
 
 	/* keep this first */
 	BLI_callback_exec(bmain, &scene->id, BLI_CB_EVT_SCENE_UPDATE_PRE);
@@ -1878,6 +1880,8 @@ void BKE_scene_update_tagged(EvaluationContext *eval_ctx, Main *bmain, Scene *sc
 
 	/* clear recalc flags */
 	DAG_ids_clear_recalc(bmain);
+
+	BLI_trace_end("BKE_scene_update_tagged", trace_start);
 }
 
 /* applies changes right away, does all sets too */
@@ -1893,6 +1897,7 @@ void BKE_scene_update_for_newframe_ex(EvaluationContext *eval_ctx, Main *bmain,
 #ifdef DETAILED_ANALYSIS_OUTPUT
 	double start_time = PIL_check_seconds_timer();
 #endif
+	const double trace_start = BLI_trace_begin();
 #ifdef WITH_LEGACY_DEPSGRAPH
 	bool use_new_eval = !DEG_depsgraph_use_legacy();
 #else
@@ -2005,6 +2010,8 @@ void BKE_scene_update_for_newframe_ex(EvaluationContext *eval_ctx, Main *bmain,
 	/* clear recalc flags */
 	DAG_ids_clear_recalc(bmain);
 
+	BLI_trace_end("BKE_scene_update_for_newframe", trace_start);
+
 #ifdef DETAILED_ANALYSIS_OUTPUT
 	fprintf(stderr, "frame update start_time %f duration %f\n", start_time, PIL_check_seconds_timer() - start_time);
 #endif
@@ -27,20 +27,35 @@
  */
 
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "zlib.h"
 
 #include "BLI_sys_types.h"  /* for intptr_t */
 
 #include "MEM_guardedalloc.h"
 
+#include "DNA_color_types.h"
 #include "DNA_sequence_types.h"
 #include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
 
 #include "IMB_moviecache.h"
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
+#include "IMB_colormanagement.h"
 
+#include "BLI_fileops.h"
+#include "BLI_fileops_types.h"
+#include "BLI_hash_mm2a.h"
 #include "BLI_listbase.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
 
+#include "BKE_main.h"
 #include "BKE_sequencer.h"
 #include "BKE_scene.h"
 
@@ -49,8 +64,21 @@ typedef struct SeqCacheKey {
 	SeqRenderData context;
 	float cfra;
 	eSeqStripElemIBuf type;
+
+	/* not part of the hash, only used for the priority of the element */
+	float timeline_frame;
+	float cost;
 } SeqCacheKey;
 
+typedef struct SeqCachePriorityData {
+	float timeline_frame;
+	float cost;
+} SeqCachePriorityData;
+
+/* render time in seconds which makes an element as hard to replace as one a frame closer to the playhead,
+ * roughly the time of a frame at realtime playback */
+#define SEQ_CACHE_COST_REF 0.04f
+
 typedef struct SeqPreprocessCacheElem {
 	struct SeqPreprocessCacheElem *next, *prev;
 
@@ -69,6 +97,10 @@ typedef struct SeqPreprocessCache {
 static struct MovieCache *moviecache = NULL;
 static struct SeqPreprocessCache *preprocess_cache = NULL;
 
+/* strips of a stack may be rendered from several threads at once,
+ * taken by getting and putting buffers */
+static ThreadMutex cache_lock = BLI_MUTEX_INITIALIZER;
+
 static void preprocessed_cache_destruct(void);
 
 static bool seq_cmp_render_data(const SeqRenderData *a, const SeqRenderData *b)
@@ -121,6 +153,530 @@ static bool seqcache_hashcmp(const void *a_, const void *b_)
 	        seq_cmp_render_data(&a->context, &b->context));
 }
 
+/* elements are freed farthest away from the last put frame first (like the movie clip cache),
+ * elements which were slow to render count as being closer */
+static void *seqcache_getprioritydata(void *key_v)
+{
+	SeqCacheKey *key = (SeqCacheKey *) key_v;
+	SeqCachePriorityData *priority_data;
+
+	priority_data = MEM_mallocN(sizeof(*priority_data), "sequencer cache priority data");
+	priority_data->timeline_frame = key->timeline_frame;
+	priority_data->cost = key->cost;
+
+	return priority_data;
+}
+
+static int seqcache_getitempriority(void *last_userkey_v, void *priority_data_v)
+{
+	SeqCacheKey *last_userkey = (SeqCacheKey *) last_userkey_v;
+	SeqCachePriorityData *priority_data = (SeqCachePriorityData *) priority_data_v;
+	const float distance = fabsf(last_userkey->timeline_frame - priority_data->timeline_frame);
+
+	/* scaled so fractional distances of slow elements still differ */
+	return -(int)(distance * 100.0f / (1.0f + priority_data->cost / SEQ_CACHE_COST_REF));
+}
+
+static void seqcache_prioritydeleter(void *priority_data_v)
+{
+	MEM_freeN(priority_data_v);
+}
+
+static struct MovieCache *seqcache_create(void)
+{
+	struct MovieCache *cache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
+
+	IMB_moviecache_set_priority_callback(cache, seqcache_getprioritydata, seqcache_getitempriority,
+	                                     seqcache_prioritydeleter);
+
+	return cache;
+}
+
+/* -------------------------------------------------------------------- */
+/* Disk Cache */
+
+/* Strip buffers which were slow to render are also written to U.sequencer_disk_cache_dir,
+ * so they survive cache cleanups and restarts.
+ *
+ * Files are named after a hash of everything the buffer depends on (strip settings and inputs,
+ * modification time of the source files and the render size), a changed strip simply doesn't find
+ * its old files anymore, those are removed oldest first once the size limit is reached.
+ * Strips depending on data outside of the sequencer (scenes, clips, masks, meta strips) are not written. */
+
+#define SEQ_DISK_CACHE_VERSION 1
+#define SEQ_DISK_CACHE_EXT ".bseq"
+
+typedef struct SeqDiskCacheHeader {
+	char magic[4];
+	int version;
+	unsigned int hash;
+	int x, y, planes;
+	int flag;
+	float cost;
+	char rect_colorspace[64];   /* MAX_COLORSPACE_NAME */
+	char float_colorspace[64];  /* MAX_COLORSPACE_NAME */
+} SeqDiskCacheHeader;
+
+/* SeqDiskCacheHeader->flag */
+enum {
+	SEQ_DISK_CACHE_RECT      = (1 << 0),
+	SEQ_DISK_CACHE_RECTFLOAT = (1 << 1),
+};
+
+typedef struct SeqDiskCacheFile {
+	char path[FILE_MAX];
+	size_t size;
+	int64_t mtime;
+} SeqDiskCacheFile;
+
+/* taken while counting and freeing files of the cache directory */
+static ThreadMutex disk_cache_lock = BLI_MUTEX_INITIALIZER;
+/* bytes used by the cache directory, -1 until it's been scanned */
+static int64_t disk_cache_size = -1;
+
+static void seq_disk_cache_hash_float(BLI_HashMurmur2A *mm2, float value)
+{
+	BLI_hash_mm2a_add(mm2, (const unsigned char *)&value, sizeof(value));
+}
+
+static void seq_disk_cache_hash_str(BLI_HashMurmur2A *mm2, const char *str)
+{
+	BLI_hash_mm2a_add(mm2, (const unsigned char *)str, strlen(str));
+	BLI_hash_mm2a_add_int(mm2, 0);
+}
+
+static void seq_disk_cache_hash_curvemapping(BLI_HashMurmur2A *mm2, const CurveMapping *cumap)
+{
+	int a, i;
+
+	BLI_hash_mm2a_add_int(mm2, cumap->flag);
+	BLI_hash_mm2a_add(mm2, (const unsigned char *)&cumap->clipr, sizeof(cumap->clipr));
+	BLI_hash_mm2a_add(mm2, (const unsigned char *)cumap->black, sizeof(cumap->black));
+	BLI_hash_mm2a_add(mm2, (const unsigned char *)cumap->white, sizeof(cumap->white));
+
+	for (a = 0; a < CM_TOT; a++) {
+		const CurveMap *cuma = &cumap->cm[a];
+
+		BLI_hash_mm2a_add_int(mm2, cuma->totpoint);
+		BLI_hash_mm2a_add_int(mm2, cuma->flag);
+		BLI_hash_mm2a_add(mm2, (const unsigned char *)cuma->ext_in, sizeof(cuma->ext_in));
+		BLI_hash_mm2a_add(mm2, (const unsigned char *)cuma->ext_out, sizeof(cuma->ext_out));
+
+		if (cuma->curve) {
+			for (i = 0; i < cuma->totpoint; i++) {
+				seq_disk_cache_hash_float(mm2, cuma->curve[i].x);
+				seq_disk_cache_hash_float(mm2, cuma->curve[i].y);
+				BLI_hash_mm2a_add_int(mm2, cuma->curve[i].flag);
+			}
+		}
+	}
+}
+
+static void seq_disk_cache_hash_file(BLI_HashMurmur2A *mm2, const char *dir, const char *name, const char *relbase)
+{
+	char filepath[FILE_MAX];
+	BLI_stat_t st;
+
+	BLI_join_dirfile(filepath, sizeof(filepath), dir, name);
+	BLI_path_abs(filepath, relbase);
+
+	seq_disk_cache_hash_str(mm2, filepath);
+
+	if (BLI_stat(filepath, &st) == 0) {
+		BLI_hash_mm2a_add_int(mm2, (int)st.st_mtime);
+		BLI_hash_mm2a_add_int(mm2, (int)st.st_size);
+	}
+}
+
+static void seq_disk_cache_hash_context(BLI_HashMurmur2A *mm2, const SeqRenderData *context)
+{
+	const Scene *scene = context->scene;
+
+	BLI_hash_mm2a_add_int(mm2, context->rectx);
+	BLI_hash_mm2a_add_int(mm2, context->recty);
+	BLI_hash_mm2a_add_int(mm2, context->preview_render_size);
+	BLI_hash_mm2a_add_int(mm2, context->motion_blur_samples);
+	seq_disk_cache_hash_float(mm2, context->motion_blur_shutter);
+	BLI_hash_mm2a_add_int(mm2, context->is_proxy_render);
+	BLI_hash_mm2a_add_int(mm2, context->view_id);
+	BLI_hash_mm2a_add_int(mm2, scene->r.views_format);
+	BLI_hash_mm2a_add_int(mm2, scene->r.frs_sec);
+	seq_disk_cache_hash_float(mm2, scene->r.frs_sec_base);
+	seq_disk_cache_hash_str(mm2, scene->sequencer_colorspace_settings.name);
+}
+
+/**
+ * Adds everything the rendered buffer of \a seq depends on to \a mm2,
+ * frame numbers are relative to \a start_ref so moving strips in time keeps their files valid.
+ *
+ * \return false when the buffer depends on data which isn't hashed.
+ */
+static bool seq_disk_cache_hash_strip(
+        BLI_HashMurmur2A *mm2, const SeqRenderData *context, Sequence *seq, float cfra, int start_ref)
+{
+	const char *relbase = context->bmain->name;
+	Strip *strip = seq->strip;
+	SequenceModifierData *smd;
+
+	if (ELEM(seq->type, SEQ_TYPE_META, SEQ_TYPE_SCENE, SEQ_TYPE_MOVIECLIP, SEQ_TYPE_MASK,
+	         SEQ_TYPE_SPEED, SEQ_TYPE_MULTICAM, SEQ_TYPE_ADJUSTMENT))
+	{
+		return false;
+	}
+
+	BLI_hash_mm2a_add_int(mm2, seq->type);
+	BLI_hash_mm2a_add_int(mm2, seq->flag & ~(SEQ_ALLSEL | SEQ_OVERLAP | SEQ_LOCK));
+	BLI_hash_mm2a_add_int(mm2, seq->start - start_ref);
+	BLI_hash_mm2a_add_int(mm2, seq->len);
+	BLI_hash_mm2a_add_int(mm2, seq->startofs);
+	BLI_hash_mm2a_add_int(mm2, seq->endofs);
+	BLI_hash_mm2a_add_int(mm2, seq->startstill);
+	BLI_hash_mm2a_add_int(mm2, seq->endstill);
+	BLI_hash_mm2a_add_int(mm2, seq->anim_startofs);
+	BLI_hash_mm2a_add_int(mm2, seq->anim_endofs);
+	BLI_hash_mm2a_add_int(mm2, seq->streamindex);
+	BLI_hash_mm2a_add_int(mm2, seq->blend_mode);
+	BLI_hash_mm2a_add_int(mm2, seq->alpha_mode);
+	BLI_hash_mm2a_add_int(mm2, seq->views_format);
+	seq_disk_cache_hash_float(mm2, seq->sat);
+	seq_disk_cache_hash_float(mm2, seq->mul);
+	seq_disk_cache_hash_float(mm2, seq->strobe);
+	seq_disk_cache_hash_float(mm2, seq->blend_opacity);
+	seq_disk_cache_hash_float(mm2, seq->effect_fader);
+
+	if (strip) {
+		StripElem *se = (seq->type == SEQ_TYPE_IMAGE) ? BKE_sequencer_give_stripelem(seq, (int)cfra) : strip->stripdata;
+
+		if (se) {
+			seq_disk_cache_hash_file(mm2, strip->dir, se->name, relbase);
+		}
+		if ((seq->flag & SEQ_USE_CROP) && strip->crop) {
+			BLI_hash_mm2a_add(mm2, (const unsigned char *)strip->crop, sizeof(*strip->crop));
+		}
+		if ((seq->flag & SEQ_USE_TRANSFORM) && strip->transform) {
+			BLI_hash_mm2a_add(mm2, (const unsigned char *)strip->transform, sizeof(*strip->transform));
+		}
+		if ((seq->flag & SEQ_USE_PROXY) && strip->proxy) {
+			BLI_hash_mm2a_add_int(mm2, strip->proxy->tc);
+			BLI_hash_mm2a_add_int(mm2, strip->proxy->quality);
+		}
+		seq_disk_cache_hash_str(mm2, strip->colorspace_settings.name);
+	}
+
+	if (seq->effectdata) {
+		/* effect settings are plain values, except for the speed effect */
+		BLI_hash_mm2a_add(mm2, (const unsigned char *)seq->effectdata, MEM_allocN_len(seq->effectdata));
+	}
+
+	for (smd = seq->modifiers.first; smd; smd = smd->next) {
+		const SequenceModifierTypeInfo *smti = BKE_sequence_modifier_type_info_get(smd->type);
+
+		if (smti == NULL || smd->mask_sequence || smd->mask_id) {
+			return false;
+		}
+
+		BLI_hash_mm2a_add_int(mm2, smd->type);
+		BLI_hash_mm2a_add_int(mm2, smd->flag);
+
+		if (smd->type == seqModifierType_Curves) {
+			seq_disk_cache_hash_curvemapping(mm2, &((CurvesModifierData *)smd)->curve_mapping);
+		}
+		else if (smd->type == seqModifierType_HueCorrect) {
+			seq_disk_cache_hash_curvemapping(mm2, &((HueCorrectModifierData *)smd)->curve_mapping);
+		}
+		else {
+			BLI_hash_mm2a_add(mm2, (const unsigned char *)(smd + 1), (size_t)smti->struct_size - sizeof(*smd));
+		}
+	}
+
+	if (seq->seq1 && !seq_disk_cache_hash_strip(mm2, context, seq->seq1, cfra, start_ref))
+		return false;
+	if (seq->seq2 && !seq_disk_cache_hash_strip(mm2, context, seq->seq2, cfra, start_ref))
+		return false;
+	if (seq->seq3 && !seq_disk_cache_hash_strip(mm2, context, seq->seq3, cfra, start_ref))
+		return false;
+
+	return true;
+}
+
+static bool seq_disk_cache_root_get(const SeqRenderData *context, char *root)
+{
+	if (U.sequencer_disk_cache_dir[0] == '\0' || context->bmain->name[0] == '\0') {
+		return false;
+	}
+
+	BLI_strncpy(root, U.sequencer_disk_cache_dir, FILE_MAX);
+	BLI_path_abs(root, context->bmain->name);
+
+	return true;
+}
+
+/**
+ * Path of the file for the buffer of \a seq at \a cfra, inside a directory for the blend file.
+ */
+static bool seq_disk_cache_path_get(
+        const SeqRenderData *context, Sequence *seq, float cfra, char *root, char *filepath, unsigned int *r_hash)
+{
+	const char *blendfile = context->bmain->name;
+	BLI_HashMurmur2A mm2;
+	char dirname[FILE_MAXFILE], filename[FILE_MAXFILE];
+	char dir[FILE_MAX];
+
+	if (!seq_disk_cache_root_get(context, root)) {
+		return false;
+	}
+
+	BLI_hash_mm2a_init(&mm2, SEQ_DISK_CACHE_VERSION);
+	seq_disk_cache_hash_context(&mm2, context);
+
+	if (!seq_disk_cache_hash_strip(&mm2, context, seq, cfra, seq->start)) {
+		return false;
+	}
+
+	*r_hash = BLI_hash_mm2a_end(&mm2);
+
+	BLI_strncpy(dirname, BLI_path_basename(blendfile), sizeof(dirname));
+	BLI_replace_extension(dirname, sizeof(dirname), "");
+	BLI_snprintf(dirname + strlen(dirname), sizeof(dirname) - strlen(dirname), "_%08x",
+	             BLI_hash_mm2((const unsigned char *)blendfile, strlen(blendfile), 0));
+	BLI_join_dirfile(dir, sizeof(dir), root, dirname);
+
+	BLI_snprintf(filename, sizeof(filename), "%s-%08x-%g" SEQ_DISK_CACHE_EXT, seq->name + 2, *r_hash, cfra - seq->start);
+	BLI_filename_make_safe(filename);
+	BLI_join_dirfile(filepath, FILE_MAX, dir, filename);
+
+	return true;
+}
+
+static int seq_disk_cache_file_cmp(const void *a_v, const void *b_v)
+{
+	const SeqDiskCacheFile *a = a_v, *b = b_v;
+
+	if (a->mtime < b->mtime) return -1;
+	else if (a->mtime > b->mtime) return 1;
+
+	return 0;
+}
+
+/**
+ * Counts the files in the directories of \a root, when \a size_limit is exceeded
+ * the oldest files are removed until there is some room again.
+ */
+static int64_t seq_disk_cache_scan(const char *root, const int64_t size_limit)
+{
+	SeqDiskCacheFile *files = NULL;
+	int files_len = 0, files_alloc = 0;
+	struct direntry *dirs;
+	unsigned int dirs_len, i;
+	int64_t size = 0;
+
+	dirs_len = BLI_filelist_dir_contents(root, &dirs);
+
+	for (i = 0; i < dirs_len; i++) {
+		struct direntry *entries;
+		unsigned int entries_len, j;
+
+		if (!S_ISDIR(dirs[i].type) || FILENAME_IS_CURRPAR(dirs[i].relname)) {
+			continue;
+		}
+
+		entries_len = BLI_filelist_dir_contents(dirs[i].path, &entries);
+
+		for (j = 0; j < entries_len; j++) {
+			SeqDiskCacheFile *file;
+
+			if (!S_ISREG(entries[j].type) || !BLI_testextensie(entries[j].relname, SEQ_DISK_CACHE_EXT)) {
+				continue;
+			}
+
+			if (files_len == files_alloc) {
+				files_alloc = files_alloc ? files_alloc * 2 : 256;
+				files = MEM_reallocN_id(files, sizeof(*files) * (size_t)files_alloc, __func__);
+			}
+
+			file = &files[files_len++];
+			BLI_strncpy(file->path, entries[j].path, sizeof(file->path));
+			file->size = (size_t)entries[j].s.st_size;
+			file->mtime = (int64_t)entries[j].s.st_mtime;
+
+			size += (int64_t)file->size;
+		}
+
+		BLI_filelist_free(entries, entries_len);
+	}
+
+	BLI_filelist_free(dirs, dirs_len);
+
+	if (size_limit && size > size_limit) {
+		int j;
+
+		qsort(files, (size_t)files_len, sizeof(*files), seq_disk_cache_file_cmp);
+
+		/* free a bit more than needed, so the directory isn't scanned on every write */
+		for (j = 0; j < files_len && size > size_limit - size_limit / 10; j++) {
+			if (BLI_delete(files[j].path, false, false) == 0) {
+				size -= (int64_t)files[j].size;
+			}
+		}
+	}
+
+	if (files) {
+		MEM_freeN(files);
+	}
+
+	return size;
+}
+
+static void seq_disk_cache_size_add(const char *root, size_t size)
+{
+	const int64_t size_limit = (int64_t)U.sequencer_disk_cache_limit * 1024 * 1024;
+
+	BLI_mutex_lock(&disk_cache_lock);
+
+	if (disk_cache_size == -1) {
+		/* first write of the session, the new file is counted by the scan */
+		disk_cache_size = seq_disk_cache_scan(root, size_limit);
+	}
+	else {
+		disk_cache_size += (int64_t)size;
+
+		if (size_limit && disk_cache_size > size_limit) {
+			disk_cache_size = seq_disk_cache_scan(root, size_limit);
+		}
+	}
+
+	BLI_mutex_unlock(&disk_cache_lock);
+}
+
+static bool seq_disk_cache_gzread(gzFile file, void *data, size_t len)
+{
+	return gzread(file, data, (unsigned int)len) == (int)len;
+}
+
+static bool seq_disk_cache_gzwrite(gzFile file, const void *data, size_t len)
+{
+	return gzwrite(file, data, (unsigned int)len) == (int)len;
+}
+
+static ImBuf *seq_disk_cache_read(const char *filepath, unsigned int hash, float *r_cost)
+{
+	SeqDiskCacheHeader header;
+	ImBuf *ibuf = NULL;
+	gzFile file;
+
+	file = BLI_gzopen(filepath, "rb");
+
+	if (file == NULL) {
+		return NULL;
+	}
+
+	if (seq_disk_cache_gzread(file, &header, sizeof(header)) &&
+	    memcmp(header.magic, "BSEQ", 4) == 0 &&
+	    header.version == SEQ_DISK_CACHE_VERSION &&
+	    header.hash == hash &&
+	    header.x > 0 && header.y > 0)
+	{
+		const size_t num_pixels = (size_t)header.x * (size_t)header.y;
+		int flags = 0;
+
+		header.rect_colorspace[sizeof(header.rect_colorspace) - 1] = '\0';
+		header.float_colorspace[sizeof(header.float_colorspace) - 1] = '\0';
+
+		if (header.flag & SEQ_DISK_CACHE_RECT)
+			flags |= IB_rect;
+		if (header.flag & SEQ_DISK_CACHE_RECTFLOAT)
+			flags |= IB_rectfloat;
+
+		ibuf = IMB_allocImBuf((unsigned int)header.x, (unsigned int)header.y, (unsigned char)header.planes, flags);
+
+		if (ibuf) {
+			bool ok = true;
+
+			if (ibuf->rect) {
+				ok &= seq_disk_cache_gzread(file, ibuf->rect, num_pixels * 4 * sizeof(unsigned char));
+				IMB_colormanagement_assign_rect_colorspace(ibuf, header.rect_colorspace);
+			}
+			if (ok && ibuf->rect_float) {
+				ok &= seq_disk_cache_gzread(file, ibuf->rect_float, num_pixels * 4 * sizeof(float));
+				IMB_colormanagement_assign_float_colorspace(ibuf, header.float_colorspace);
+			}
+
+			if (ok) {
+				*r_cost = header.cost;
+			}
+			else {
+				IMB_freeImBuf(ibuf);
+				ibuf = NULL;
+			}
+		}
+	}
+
+	gzclose(file);
+
+	return ibuf;
+}
+
+static void seq_disk_cache_write(const char *root, const char *filepath, unsigned int hash, ImBuf *ibuf, float cost)
+{
+	const size_t num_pixels = (size_t)ibuf->x * (size_t)ibuf->y;
+	char filepath_temp[FILE_MAX];
+	SeqDiskCacheHeader header = {{0}};
+	gzFile file;
+	bool ok;
+
+	if (ibuf->rect_float && !ELEM(ibuf->channels, 0, 4)) {
+		return;
+	}
+
+	memcpy(header.magic, "BSEQ", 4);
+	header.version = SEQ_DISK_CACHE_VERSION;
+	header.hash = hash;
+	header.x = ibuf->x;
+	header.y = ibuf->y;
+	header.planes = ibuf->planes;
+	header.cost = cost;
+
+	if (ibuf->rect) {
+		header.flag |= SEQ_DISK_CACHE_RECT;
+		if (ibuf->rect_colorspace) {
+			BLI_strncpy(header.rect_colorspace, IMB_colormanagement_get_rect_colorspace(ibuf),
+			            sizeof(header.rect_colorspace));
+		}
+	}
+	if (ibuf->rect_float) {
+		header.flag |= SEQ_DISK_CACHE_RECTFLOAT;
+		BLI_strncpy(header.float_colorspace, IMB_colormanagement_get_float_colorspace(ibuf),
+		            sizeof(header.float_colorspace));
+	}
+
+	/* several threads may write the same file, each writes its own and renames it when done */
+	BLI_snprintf(filepath_temp, sizeof(filepath_temp), "%s.%p", filepath, (void *)ibuf);
+	BLI_make_existing_file(filepath_temp);
+
+	/* lowest compression level, writing must not slow down playback much */
+	file = BLI_gzopen(filepath_temp, "wb1");
+
+	if (file == NULL) {
+		return;
+	}
+
+	ok = seq_disk_cache_gzwrite(file, &header, sizeof(header));
+	if (ok && ibuf->rect)
+		ok = seq_disk_cache_gzwrite(file, ibuf->rect, num_pixels * 4 * sizeof(unsigned char));
+	if (ok && ibuf->rect_float)
+		ok = seq_disk_cache_gzwrite(file, ibuf->rect_float, num_pixels * 4 * sizeof(float));
+
+	if (gzclose(file) != Z_OK)
+		ok = false;
+
+	if (ok && BLI_rename(filepath_temp, filepath) == 0) {
+		seq_disk_cache_size_add(root, BLI_file_size(filepath));
+	}
+	else {
+		BLI_delete(filepath_temp, false, false);
+	}
+}
+
 void BKE_sequencer_cache_destruct(void)
 {
 	if (moviecache)
@@ -133,7 +689,7 @@ void BKE_sequencer_cache_cleanup(void)
 {
 	if (moviecache) {
 		IMB_moviecache_free(moviecache);
-		moviecache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
+		moviecache = seqcache_create();
 	}
 
 	BKE_sequencer_preprocessed_cache_cleanup();
@@ -153,8 +709,35 @@ void BKE_sequencer_cache_cleanup_sequence(Sequence *seq)
 		IMB_moviecache_cleanup(moviecache, seqcache_key_check_seq, seq);
 }
 
+static void seqcache_put(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type,
+                         ImBuf *i, float cost)
+{
+	SeqCacheKey key;
+
+	BLI_mutex_lock(&cache_lock);
+
+	if (!moviecache) {
+		moviecache = seqcache_create();
+	}
+
+	key.seq = seq;
+	key.context = *context;
+	key.cfra = cfra - seq->start;
+	key.type = type;
+	key.timeline_frame = cfra;
+	key.cost = cost;
+
+	IMB_moviecache_put(moviecache, &key, i);
+
+	BLI_mutex_unlock(&cache_lock);
+}
+
 struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type)
 {
+	ImBuf *ibuf = NULL;
+
+	BLI_mutex_lock(&cache_lock);
+
 	if (moviecache && seq) {
 		SeqCacheKey key;
 
@@ -163,33 +746,57 @@ struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context, Sequence *se
 		key.cfra = cfra - seq->start;
 		key.type = type;
 
-		return IMB_moviecache_get(moviecache, &key);
+		ibuf = IMB_moviecache_get(moviecache, &key);
 	}
 
-	return NULL;
+	BLI_mutex_unlock(&cache_lock);
+
+	if (ibuf == NULL && seq && type == SEQ_STRIPELEM_IBUF && !context->skip_cache) {
+		char root[FILE_MAX], filepath[FILE_MAX];
+		unsigned int hash;
+		float cost;
+
+		if (seq_disk_cache_path_get(context, seq, cfra, root, filepath, &hash)) {
+			ibuf = seq_disk_cache_read(filepath, hash, &cost);
+
+			if (ibuf) {
+				seqcache_put(context, seq, cfra, type, ibuf, cost);
+			}
+		}
+	}
+
+	return ibuf;
 }
 
-void BKE_sequencer_cache_put(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type, ImBuf *i)
+/**
+ * Put \a i in the cache, \a cost is the time in seconds it took to render, used to keep expensive
+ * elements longer when the cache is full. Strip buffers slower than realtime are also written to the disk cache.
+ */
+void BKE_sequencer_cache_put_ex(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type,
+                                ImBuf *i, float cost)
 {
-	SeqCacheKey key;
-
 	if (i == NULL || context->skip_cache) {
 		return;
 	}
 
-	if (!moviecache) {
-		moviecache = IMB_moviecache_create("seqcache", sizeof(SeqCacheKey), seqcache_hashhash, seqcache_hashcmp);
-	}
+	seqcache_put(context, seq, cfra, type, i, cost);
 
-	key.seq = seq;
-	key.context = *context;
-	key.cfra = cfra - seq->start;
-	key.type = type;
+	if (type == SEQ_STRIPELEM_IBUF && cost >= SEQ_CACHE_COST_REF) {
+		char root[FILE_MAX], filepath[FILE_MAX];
+		unsigned int hash;
 
-	IMB_moviecache_put(moviecache, &key, i);
+		if (seq_disk_cache_path_get(context, seq, cfra, root, filepath, &hash)) {
+			seq_disk_cache_write(root, filepath, hash, i, cost);
+		}
+	}
 }
 
-void BKE_sequencer_preprocessed_cache_cleanup(void)
+void BKE_sequencer_cache_put(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type, ImBuf *i)
+{
+	BKE_sequencer_cache_put_ex(context, seq, cfra, type, i, 0.0f);
+}
+
+static void preprocessed_cache_cleanup(void)
 {
 	SeqPreprocessCacheElem *elem;
 
@@ -204,12 +811,19 @@ void BKE_sequencer_preprocessed_cache_cleanup(void)
 	BLI_listbase_clear(&preprocess_cache->elems);
 }
 
+void BKE_sequencer_preprocessed_cache_cleanup(void)
+{
+	BLI_mutex_lock(&cache_lock);
+	preprocessed_cache_cleanup();
+	BLI_mutex_unlock(&cache_lock);
+}
+
 static void preprocessed_cache_destruct(void)
 {
 	if (!preprocess_cache)
 		return;
 
-	BKE_sequencer_preprocessed_cache_cleanup();
+	preprocessed_cache_cleanup();
 
 	MEM_freeN(preprocess_cache);
 	preprocess_cache = NULL;
@@ -218,12 +832,14 @@ static void preprocessed_cache_destruct(void)
 ImBuf *BKE_sequencer_preprocessed_cache_get(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type)
 {
 	SeqPreprocessCacheElem *elem;
+	ImBuf *ibuf = NULL;
 
-	if (!preprocess_cache)
-		return NULL;
+	BLI_mutex_lock(&cache_lock);
 
-	if (preprocess_cache->cfra != cfra)
+	if (!preprocess_cache || preprocess_cache->cfra != cfra) {
+		BLI_mutex_unlock(&cache_lock);
 		return NULL;
+	}
 
 	for (elem = preprocess_cache->elems.first; elem; elem = elem->next) {
 		if (elem->seq != seq)
@@ -236,22 +852,27 @@ ImBuf *BKE_sequencer_preprocessed_cache_get(const SeqRenderData *context, Sequen
 			continue;
 
 		IMB_refImBuf(elem->ibuf);
-		return elem->ibuf;
+		ibuf = elem->ibuf;
+		break;
 	}
 
-	return NULL;
+	BLI_mutex_unlock(&cache_lock);
+
+	return ibuf;
 }
 
 void BKE_sequencer_preprocessed_cache_put(const SeqRenderData *context, Sequence *seq, float cfra, eSeqStripElemIBuf type, ImBuf *ibuf)
 {
 	SeqPreprocessCacheElem *elem;
 
+	BLI_mutex_lock(&cache_lock);
+
 	if (!preprocess_cache) {
 		preprocess_cache = MEM_callocN(sizeof(SeqPreprocessCache), "sequencer preprocessed cache");
 	}
 	else {
 		if (preprocess_cache->cfra != cfra)
-			BKE_sequencer_preprocessed_cache_cleanup();
+			preprocessed_cache_cleanup();
 	}
 
 	elem = MEM_callocN(sizeof(SeqPreprocessCacheElem), "sequencer preprocessed cache element");
@@ -266,6 +887,8 @@ void BKE_sequencer_preprocessed_cache_put(const SeqRenderData *context, Sequence
 	IMB_refImBuf(ibuf);
 
 	BLI_addtail(&preprocess_cache->elems, elem);
+
+	BLI_mutex_unlock(&cache_lock);
 }
 
 void BKE_sequencer_preprocessed_cache_cleanup_sequence(Sequence *seq)
@@ -50,6 +50,7 @@
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_string_utf8.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -78,6 +79,8 @@
 
 #include "RE_pipeline.h"
 
+#include "PIL_time.h"
+
 #include <pthread.h>
 
 #include "IMB_imbuf.h"
@@ -2000,6 +2003,15 @@ void BKE_sequencer_proxy_rebuild(SeqIndexBuildContext *context, short *stop, sho
 	}
 }
 
+/**
+ * Movie proxies are built from their own decoder, so several of them can be rebuilt at once,
+ * other strips are rendered through the sequencer and have to be rebuilt one by one.
+ */
+bool BKE_sequencer_proxy_rebuild_is_threadsafe(SeqIndexBuildContext *context)
+{
+	return (context->seq->type == SEQ_TYPE_MOVIE);
+}
+
 void BKE_sequencer_proxy_rebuild_finish(SeqIndexBuildContext *context, bool stop)
 {
 	if (context->index_context) {
@@ -3514,12 +3526,15 @@ static ImBuf *seq_render_strip(const SeqRenderData *context, Sequence *seq, floa
 	ImBuf *ibuf = NULL;
 	bool use_preprocess = false;
 	bool is_proxy_image = false;
+	bool is_cached;
 	float nr = give_stripelem_index(seq, cfra);
 	/* all effects are handled similarly with the exception of speed effect */
 	int type = (seq->type & SEQ_TYPE_EFFECT && seq->type != SEQ_TYPE_SPEED) ? SEQ_TYPE_EFFECT : seq->type;
 	bool is_preprocessed = !ELEM(type, SEQ_TYPE_IMAGE, SEQ_TYPE_MOVIE, SEQ_TYPE_SCENE, SEQ_TYPE_MOVIECLIP);
+	const double begin = PIL_check_seconds_timer();
 
 	ibuf = BKE_sequencer_cache_get(context, seq, cfra, SEQ_STRIPELEM_IBUF);
+	is_cached = (ibuf != NULL);
 
 	if (ibuf == NULL) {
 		ibuf = copy_from_ibuf_still(context, seq, nr);
@@ -3570,7 +3585,11 @@ static ImBuf *seq_render_strip(const SeqRenderData *context, Sequence *seq, floa
 	if (use_preprocess)
 		ibuf = input_preprocess(context, seq, cfra, ibuf, is_proxy_image, is_preprocessed);
 
-	BKE_sequencer_cache_put(context, seq, cfra, SEQ_STRIPELEM_IBUF, ibuf);
+	/* putting a cached buffer again would lose its render time */
+	if (!is_cached || use_preprocess) {
+		BKE_sequencer_cache_put_ex(context, seq, cfra, SEQ_STRIPELEM_IBUF, ibuf,
+		                           (float)(PIL_check_seconds_timer() - begin));
+	}
 
 	return ibuf;
 }
@@ -3636,12 +3655,93 @@ static ImBuf *seq_render_strip_stack_apply_effect(const SeqRenderData *context,
 	return out;
 }
 
+typedef struct SeqRenderStripsData {
+	const SeqRenderData *context;
+	Sequence **seq_arr;
+	float cfra;
+} SeqRenderStripsData;
+
+static void seq_render_strip_stack_prefetch_func(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	SeqRenderStripsData *data = userdata;
+
+	/* result goes to the cache, where the stack rendering picks it up */
+	ImBuf *ibuf = seq_render_strip(data->context, data->seq_arr[i], data->cfra);
+	IMB_freeImBuf(ibuf);
+}
+
+/* Render the image and movie strips which seq_render_strip_stack is going to blend, all at once.
+ * Those only read their own files, so unlike scene or effect strips they don't depend on other
+ * strips in the stack. Strips with modifiers are skipped, since masks may use other strips. */
+static void seq_render_strip_stack_prefetch(const SeqRenderData *context, Sequence **seq_arr, int count, float cfra)
+{
+	Sequence *render_arr[MAXSEQ + 1];
+	SeqRenderStripsData data;
+	bool is_cached = false;
+	int render_count = 0;
+	int i, start;
+
+	if (context->skip_cache) {
+		return;
+	}
+
+	/* find the strip blending starts from, the same way seq_render_strip_stack does */
+	for (i = count - 1; i >= 0; i--) {
+		Sequence *seq = seq_arr[i];
+		ImBuf *ibuf = BKE_sequencer_cache_get(context, seq, cfra, SEQ_STRIPELEM_IBUF_COMP);
+
+		if (ibuf) {
+			IMB_freeImBuf(ibuf);
+			is_cached = true;
+			break;
+		}
+		if (seq->blend_mode == SEQ_BLEND_REPLACE ||
+		    ELEM(seq_get_early_out_for_blend_mode(seq), EARLY_NO_INPUT, EARLY_USE_INPUT_2))
+		{
+			break;
+		}
+	}
+
+	start = max_ii(i, 0);
+
+	for (i = start; i < count; i++) {
+		Sequence *seq = seq_arr[i];
+		bool do_render;
+
+		if (i == start) {
+			do_render = !is_cached && (seq->blend_mode == SEQ_BLEND_REPLACE ||
+			                           seq_get_early_out_for_blend_mode(seq) != EARLY_USE_INPUT_1);
+		}
+		else {
+			do_render = seq_get_early_out_for_blend_mode(seq) == EARLY_DO_EFFECT;
+		}
+
+		if (do_render &&
+		    ELEM(seq->type, SEQ_TYPE_IMAGE, SEQ_TYPE_MOVIE) &&
+		    BLI_listbase_is_empty(&seq->modifiers))
+		{
+			render_arr[render_count++] = seq;
+		}
+	}
+
+	if (render_count < 2) {
+		return;
+	}
+
+	data.context = context;
+	data.seq_arr = render_arr;
+	data.cfra = cfra;
+
+	BLI_task_parallel_range_ex(0, render_count, &data, NULL, 0, seq_render_strip_stack_prefetch_func, true, true);
+}
+
 static ImBuf *seq_render_strip_stack(const SeqRenderData *context, ListBase *seqbasep, float cfra, int chanshown)
 {
 	Sequence *seq_arr[MAXSEQ + 1];
 	int count;
 	int i;
 	ImBuf *out = NULL;
+	double begin;
 
 	count = get_shown_sequences(seqbasep, cfra, chanshown, (Sequence **)&seq_arr);
 
@@ -3662,7 +3762,9 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context, ListBase *seq
 	if (out) {
 		return out;
 	}
-	
+
+	begin = PIL_check_seconds_timer();
+
 	if (count == 1) {
 		Sequence *seq = seq_arr[0];
 
@@ -3705,11 +3807,14 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context, ListBase *seq
 			out = seq_render_strip(context, seq, cfra);
 		}
 
-		BKE_sequencer_cache_put(context, seq, cfra, SEQ_STRIPELEM_IBUF_COMP, out);
+		BKE_sequencer_cache_put_ex(context, seq, cfra, SEQ_STRIPELEM_IBUF_COMP, out,
+		                           (float)(PIL_check_seconds_timer() - begin));
 
 		return out;
 	}
 
+	seq_render_strip_stack_prefetch(context, seq_arr, count, cfra);
+
 	for (i = count - 1; i >= 0; i--) {
 		int early_out;
 		Sequence *seq = seq_arr[i];
@@ -3754,7 +3859,8 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context, ListBase *seq
 		}
 	}
 
-	BKE_sequencer_cache_put(context, seq_arr[i], cfra, SEQ_STRIPELEM_IBUF_COMP, out);
+	BKE_sequencer_cache_put_ex(context, seq_arr[i], cfra, SEQ_STRIPELEM_IBUF_COMP, out,
+	                           (float)(PIL_check_seconds_timer() - begin));
 
 	i++;
 
@@ -3771,7 +3877,8 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context, ListBase *seq
 			IMB_freeImBuf(ibuf2);
 		}
 
-		BKE_sequencer_cache_put(context, seq_arr[i], cfra, SEQ_STRIPELEM_IBUF_COMP, out);
+		BKE_sequencer_cache_put_ex(context, seq_arr[i], cfra, SEQ_STRIPELEM_IBUF_COMP, out,
+		                           (float)(PIL_check_seconds_timer() - begin));
 	}
 
 	return out;
@@ -714,6 +714,11 @@ void BKE_sound_free_waveform(bSound *sound)
 {
 	SoundWaveform *waveform = sound->waveform;
 	if (waveform) {
+		int i;
+
+		for (i = 1; i < waveform->levels; i++) {
+			MEM_freeN(waveform->level_data[i]);
+		}
 		if (waveform->data) {
 			MEM_freeN(waveform->data);
 		}
@@ -723,6 +728,53 @@ void BKE_sound_free_waveform(bSound *sound)
 	sound->waveform = NULL;
 }
 
+/* Build the lower resolutions of the waveform, so drawing long sounds
+ * zoomed out doesn't have to go over all samples for every pixel. */
+static void sound_waveform_build_levels(SoundWaveform *waveform)
+{
+	waveform->levels = 0;
+
+	if (waveform->data == NULL) {
+		return;
+	}
+
+	waveform->level_data[0] = waveform->data;
+	waveform->level_length[0] = waveform->length;
+	waveform->levels = 1;
+
+	while (waveform->levels < SOUND_WAVE_LEVELS_MAX) {
+		const int prev_length = waveform->level_length[waveform->levels - 1];
+		const float *prev = waveform->level_data[waveform->levels - 1];
+		const int length = (prev_length + 1) / 2;
+		float *data;
+		int i;
+
+		if (prev_length < 64) {
+			break;
+		}
+
+		data = MEM_mallocN(length * sizeof(float) * 3, "SoundWaveform.level");
+
+		for (i = 0; i < length; i++) {
+			const float *a = &prev[i * 6];
+
+			if (i * 2 + 1 < prev_length) {
+				const float *b = a + 3;
+				data[i * 3]     = min_ff(a[0], b[0]);
+				data[i * 3 + 1] = max_ff(a[1], b[1]);
+				data[i * 3 + 2] = (a[2] + b[2]) * 0.5f;
+			}
+			else {
+				copy_v3_v3(&data[i * 3], a);
+			}
+		}
+
+		waveform->level_data[waveform->levels] = data;
+		waveform->level_length[waveform->levels] = length;
+		waveform->levels++;
+	}
+}
+
 void BKE_sound_read_waveform(bSound *sound, short *stop)
 {
 	AUD_SoundInfo info = AUD_getInfo(sound->playback_handle);
@@ -754,6 +806,8 @@ void BKE_sound_read_waveform(bSound *sound, short *stop)
 		return;
 	}
 		
+	sound_waveform_build_levels(waveform);
+
 	BKE_sound_free_waveform(sound);
 	
 	BLI_spin_lock(sound->spinlock);
@@ -36,6 +36,7 @@
 #include "DNA_movieclip_types.h"
 #include "DNA_object_types.h"   /* SELECT */
 
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 #include "BLI_math.h"
@@ -81,6 +82,7 @@ typedef struct AutoTrackContext {
 	int first_frame;
 	int sync_frame;
 	bool first_sync;
+	bool step_ok;  /* Whether any track was tracked during the last step. */
 	SpinLock spin_lock;
 } AutoTrackContext;
 
@@ -367,81 +369,130 @@ AutoTrackContext *BKE_autotrack_context_new(MovieClip *clip,
 	return context;
 }
 
-bool BKE_autotrack_context_step(AutoTrackContext *context)
+static void autotrack_context_step_cb(TaskPool *__restrict pool,
+                                      void *taskdata,
+                                      int UNUSED(threadid))
 {
-	int frame_delta = context->backwards ? -1 : 1;
-	bool ok = false;
-	int track;
+	AutoTrackContext *context = BLI_task_pool_userdata(pool);
+	AutoTrackOptions *options = &context->options[GET_INT_FROM_POINTER(taskdata)];
+	const int frame_delta = context->backwards ? -1 : 1;
+	libmv_Marker libmv_current_marker,
+	             libmv_reference_marker,
+	             libmv_tracked_marker;
+	libmv_TrackRegionResult libmv_result;
+	int frame = BKE_movieclip_remap_scene_to_clip_frame(
+		context->clips[options->clip_index],
+		context->user.framenr);
+	bool has_marker;
 
-#pragma omp parallel for if (context->num_tracks > 1)
-	for (track = 0; track < context->num_tracks; ++track) {
-		AutoTrackOptions *options = &context->options[track];
-		libmv_Marker libmv_current_marker,
-		             libmv_reference_marker,
-		             libmv_tracked_marker;
-		libmv_TrackRegionResult libmv_result;
-		int frame = BKE_movieclip_remap_scene_to_clip_frame(
-			context->clips[options->clip_index],
-			context->user.framenr);
-		bool has_marker;
+	BLI_spin_lock(&context->spin_lock);
+	has_marker = libmv_autoTrackGetMarker(context->autotrack,
+	                                      options->clip_index,
+	                                      frame,
+	                                      options->track_index,
+	                                      &libmv_current_marker);
+	BLI_spin_unlock(&context->spin_lock);
+
+	if (has_marker) {
+		if (!tracking_check_marker_margin(&libmv_current_marker,
+		                                  options->track->margin,
+		                                  context->frame_width,
+		                                  context->frame_height))
+		{
+			return;
+		}
+
+		libmv_tracked_marker = libmv_current_marker;
+		libmv_tracked_marker.frame = frame + frame_delta;
+
+		if (options->use_keyframe_match) {
+			libmv_tracked_marker.reference_frame =
+				libmv_current_marker.reference_frame;
+			libmv_autoTrackGetMarker(context->autotrack,
+			                         options->clip_index,
+			                         libmv_tracked_marker.reference_frame,
+			                         options->track_index,
+			                         &libmv_reference_marker);
+		}
+		else {
+			libmv_tracked_marker.reference_frame = frame;
+			libmv_reference_marker = libmv_current_marker;
+		}
+
+		if (libmv_autoTrackMarker(context->autotrack,
+		                          &options->track_region_options,
+		                          &libmv_tracked_marker,
+		                          &libmv_result))
+		{
+			BLI_spin_lock(&context->spin_lock);
+			libmv_autoTrackAddMarker(context->autotrack,
+			                         &libmv_tracked_marker);
+			BLI_spin_unlock(&context->spin_lock);
+		}
+		else {
+			options->is_failed = true;
+			options->failed_frame = frame + frame_delta;
+		}
 
 		BLI_spin_lock(&context->spin_lock);
-		has_marker = libmv_autoTrackGetMarker(context->autotrack,
-		                                      options->clip_index,
-		                                      frame,
-		                                      options->track_index,
-		                                      &libmv_current_marker);
+		context->step_ok = true;
 		BLI_spin_unlock(&context->spin_lock);
+	}
+}
 
-		if (has_marker) {
-			if (!tracking_check_marker_margin(&libmv_current_marker,
-			                                  options->track->margin,
-			                                  context->frame_width,
-			                                  context->frame_height))
-			{
-				continue;
-			}
+static void autotrack_context_prefetch_cb(TaskPool *__restrict pool,
+                                          void *taskdata,
+                                          int UNUSED(threadid))
+{
+	AutoTrackContext *context = BLI_task_pool_userdata(pool);
+	int frame = GET_INT_FROM_POINTER(taskdata);
 
-			libmv_tracked_marker = libmv_current_marker;
-			libmv_tracked_marker.frame = frame + frame_delta;
+	/* TODO(sergey): Single clip only for now. */
+	tracking_image_accessor_hold_frame(context->image_accessor, 0, frame);
+}
 
-			if (options->use_keyframe_match) {
-				libmv_tracked_marker.reference_frame =
-					libmv_current_marker.reference_frame;
-				libmv_autoTrackGetMarker(context->autotrack,
-			                             options->clip_index,
-			                             libmv_tracked_marker.reference_frame,
-			                             options->track_index,
-			                             &libmv_reference_marker);
-			}
-			else {
-				libmv_tracked_marker.reference_frame = frame;
-				libmv_reference_marker = libmv_current_marker;
-			}
+bool BKE_autotrack_context_step(AutoTrackContext *context)
+{
+	const int frame_delta = context->backwards ? -1 : 1;
+	TaskScheduler *scheduler = BLI_task_scheduler_get();
+	TaskPool *task_pool;
+	int frame = BKE_movieclip_remap_scene_to_clip_frame(context->clips[0],
+	                                                    context->user.framenr);
+	int track;
 
-			if (libmv_autoTrackMarker(context->autotrack,
-			                          &options->track_region_options,
-			                          &libmv_tracked_marker,
-			                          &libmv_result))
-			{
-				BLI_spin_lock(&context->spin_lock);
-				libmv_autoTrackAddMarker(context->autotrack,
-				                         &libmv_tracked_marker);
-				BLI_spin_unlock(&context->spin_lock);
-			}
-			else {
-				options->is_failed = true;
-				options->failed_frame = frame + frame_delta;
-			}
-			ok = true;
-		}
+	context->step_ok = false;
+
+	/* Decode both frames of this step once, all tracks share them then. */
+	tracking_image_accessor_hold_frame(context->image_accessor, 0, frame);
+	tracking_image_accessor_hold_frame(context->image_accessor, 0, frame + frame_delta);
+
+	task_pool = BLI_task_pool_create(scheduler, context);
+
+	/* Decode the frame needed by the next step while tracks are busy. */
+	if (context->sequence) {
+		BLI_task_pool_push(task_pool,
+		                   autotrack_context_prefetch_cb,
+		                   SET_INT_IN_POINTER(frame + 2 * frame_delta),
+		                   false,
+		                   TASK_PRIORITY_HIGH);
 	}
 
+	for (track = 0; track < context->num_tracks; ++track) {
+		BLI_task_pool_push(task_pool,
+		                   autotrack_context_step_cb,
+		                   SET_INT_IN_POINTER(track),
+		                   false,
+		                   TASK_PRIORITY_HIGH);
+	}
+
+	BLI_task_pool_work_and_wait(task_pool);
+	BLI_task_pool_free(task_pool);
+
 	BLI_spin_lock(&context->spin_lock);
 	context->user.framenr += frame_delta;
 	BLI_spin_unlock(&context->spin_lock);
 
-	return ok;
+	return context->step_ok;
 }
 
 void BKE_autotrack_context_sync(AutoTrackContext *context)
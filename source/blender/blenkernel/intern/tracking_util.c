@@ -578,9 +578,9 @@ static ImBuf *accesscache_get(TrackingImageAccessor *accessor,
 	return IMB_moviecache_get(accessor->cache, &key);
 }
 
-static ImBuf *accessor_get_preprocessed_ibuf(TrackingImageAccessor *accessor,
-                                             int clip_index,
-                                             int frame)
+static ImBuf *accessor_load_clip_ibuf(TrackingImageAccessor *accessor,
+                                      int clip_index,
+                                      int frame)
 {
 	MovieClip *clip;
 	MovieClipUser user;
@@ -599,6 +599,46 @@ static ImBuf *accessor_get_preprocessed_ibuf(TrackingImageAccessor *accessor,
 	return ibuf;
 }
 
+/* Get a new reference to a held frame, NULL if the frame isn't held. */
+static ImBuf *accessor_get_held_ibuf(TrackingImageAccessor *accessor,
+                                     int clip_index,
+                                     int frame)
+{
+	ImBuf *ibuf = NULL;
+	int i;
+
+	BLI_spin_lock(&accessor->held_frames_lock);
+	for (i = 0; i < MAX_ACCESSOR_HELD_FRAMES; i++) {
+		TrackingImageAccessorFrame *held = &accessor->held_frames[i];
+		if (held->ibuf != NULL &&
+		    held->clip_index == clip_index &&
+		    held->frame == frame)
+		{
+			ibuf = held->ibuf;
+			IMB_refImBuf(ibuf);
+			break;
+		}
+	}
+	BLI_spin_unlock(&accessor->held_frames_lock);
+
+	return ibuf;
+}
+
+static ImBuf *accessor_get_preprocessed_ibuf(TrackingImageAccessor *accessor,
+                                             int clip_index,
+                                             int frame)
+{
+	ImBuf *ibuf;
+
+	/* Held frames are shared by all the tracks and don't need the clip lock. */
+	ibuf = accessor_get_held_ibuf(accessor, clip_index, frame);
+	if (ibuf != NULL) {
+		return ibuf;
+	}
+
+	return accessor_load_clip_ibuf(accessor, clip_index, frame);
+}
+
 static ImBuf *make_grayscale_ibuf_copy(ImBuf *ibuf)
 {
 	ImBuf *grayscale = IMB_allocImBuf(ibuf->x, ibuf->y, 32, 0);
@@ -887,12 +927,75 @@ TrackingImageAccessor *tracking_image_accessor_new(MovieClip *clips[MAX_ACCESSOR
 		                       accessor_get_image_callback,
 		                       accessor_release_image_callback);
 
+	BLI_spin_init(&accessor->held_frames_lock);
+
 	return accessor;
 }
 
 void tracking_image_accessor_destroy(TrackingImageAccessor *accessor)
 {
+	int i;
+
+	for (i = 0; i < MAX_ACCESSOR_HELD_FRAMES; i++) {
+		if (accessor->held_frames[i].ibuf != NULL) {
+			IMB_freeImBuf(accessor->held_frames[i].ibuf);
+		}
+	}
+	BLI_spin_end(&accessor->held_frames_lock);
+
 	IMB_moviecache_free(accessor->cache);
 	libmv_FrameAccessorDestroy(accessor->libmv_accessor);
 	MEM_freeN(accessor);
 }
+
+void tracking_image_accessor_hold_frame(TrackingImageAccessor *accessor,
+                                        int clip_index,
+                                        int frame)
+{
+	TrackingImageAccessorFrame *held;
+	ImBuf *ibuf, *old_ibuf;
+	int i;
+
+	ibuf = accessor_get_held_ibuf(accessor, clip_index, frame);
+	if (ibuf != NULL) {
+		IMB_freeImBuf(ibuf);
+		return;
+	}
+
+	/* Decoding happens outside of our lock, so tracks which are using
+	 * already held frames are not blocked by it. */
+	ibuf = accessor_load_clip_ibuf(accessor, clip_index, frame);
+	if (ibuf == NULL) {
+		return;
+	}
+
+	BLI_spin_lock(&accessor->held_frames_lock);
+
+	/* Another thread might have held the same frame meanwhile. */
+	for (i = 0; i < MAX_ACCESSOR_HELD_FRAMES; i++) {
+		held = &accessor->held_frames[i];
+		if (held->ibuf != NULL &&
+		    held->clip_index == clip_index &&
+		    held->frame == frame)
+		{
+			BLI_spin_unlock(&accessor->held_frames_lock);
+			IMB_freeImBuf(ibuf);
+			return;
+		}
+	}
+
+	held = &accessor->held_frames[accessor->next_held_frame];
+	old_ibuf = held->ibuf;
+	held->clip_index = clip_index;
+	held->frame = frame;
+	held->ibuf = ibuf;
+	accessor->next_held_frame =
+		(accessor->next_held_frame + 1) % MAX_ACCESSOR_HELD_FRAMES;
+	BLI_spin_unlock(&accessor->held_frames_lock);
+
+	/* Tracks which are still using the replaced frame keep their own
+	 * reference to it. */
+	if (old_ibuf != NULL) {
+		IMB_freeImBuf(old_ibuf);
+	}
+}
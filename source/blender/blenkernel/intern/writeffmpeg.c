@@ -43,6 +43,7 @@
 #include "DNA_scene_types.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_threads.h"
 
 #ifdef WITH_AUDASPACE
 #  include AUD_DEVICE_H
@@ -93,10 +94,32 @@ typedef struct FFMpegContext {
 #ifdef WITH_AUDASPACE
 	AUD_Device *audio_mixdown_device;
 #endif
+
+	/* frames are converted and encoded in a writer thread, see BKE_ffmpeg_append() */
+	ListBase writer_thread;
+	ThreadQueue *frame_queue;  /* frames to be written */
+	ThreadQueue *free_queue;   /* written frames, to be reused */
+	int frames_len;            /* number of allocated frames */
+	bool writer_failed;
 } FFMpegContext;
 
+/* A frame passed to the writer thread, the render data and pixels are copied
+ * since the caller may free them once the frame is appended. */
+typedef struct FFMpegFrame {
+	RenderData rd;
+	int start_frame, frame;
+	int rectx, recty;
+	char suffix[64];
+	int *pixels;
+	size_t pixels_size;
+} FFMpegFrame;
+
 #define FFMPEG_AUTOSPLIT_SIZE 2000000000
 
+/* frames appended but not written yet, so rendering only waits for the
+ * encoder once it falls this far behind */
+#define FFMPEG_FRAMES_QUEUE_MAX 4
+
 #define PRINT if (G.debug & G_DEBUG_FFMPEG) printf
 
 static void ffmpeg_dict_set_int(AVDictionary **dict, const char *key, int value);
@@ -574,6 +597,9 @@ static AVStream *alloc_video_stream(FFMpegContext *context, RenderData *rd, int
 #endif
 
 	c->me_method = ME_EPZS;
+
+	/* let the encoder use multiple threads, unless overridden by the codec properties */
+	c->thread_count = BLI_system_thread_count();
 	
 	codec = avcodec_find_encoder(c->codec_id);
 	if (!codec)
@@ -1161,6 +1187,11 @@ int BKE_ffmpeg_start(void *context_v, struct Scene *scene, RenderData *rd, int r
 #endif
 	}
 #endif
+
+	if (success) {
+		ffmpeg_writer_start(context);
+	}
+
 	return success;
 }
 
@@ -1181,10 +1212,9 @@ static void write_audio_frames(FFMpegContext *context, double to_pts)
 }
 #endif
 
-int BKE_ffmpeg_append(void *context_v, RenderData *rd, int start_frame, int frame, int *pixels,
-                      int rectx, int recty, const char *suffix, ReportList *reports)
+static int ffmpeg_write_frame(FFMpegContext *context, RenderData *rd, int start_frame, int frame, int *pixels,
+                              int rectx, int recty, const char *suffix, ReportList *reports)
 {
-	FFMpegContext *context = context_v;
 	AVFrame *avframe;
 	int success = 1;
 
@@ -1212,6 +1242,116 @@ int BKE_ffmpeg_append(void *context_v, RenderData *rd, int start_frame, int fram
 	return success;
 }
 
+static void *ffmpeg_writer_thread(void *context_v)
+{
+	FFMpegContext *context = context_v;
+	FFMpegFrame *frame;
+
+	/* returns NULL once ffmpeg_writer_end() was called and all frames are popped */
+	while ((frame = BLI_thread_queue_pop(context->frame_queue))) {
+		/* errors can't be added to the report list from this thread, they are
+		 * printed and reported by the next BKE_ffmpeg_append() call instead */
+		if (!context->writer_failed &&
+		    !ffmpeg_write_frame(context, &frame->rd, frame->start_frame, frame->frame, frame->pixels,
+		                        frame->rectx, frame->recty, frame->suffix, NULL))
+		{
+			context->writer_failed = true;
+		}
+
+		BLI_thread_queue_push(context->free_queue, frame);
+	}
+
+	return NULL;
+}
+
+static void ffmpeg_writer_start(FFMpegContext *context)
+{
+	context->frame_queue = BLI_thread_queue_init();
+	context->free_queue = BLI_thread_queue_init();
+	context->frames_len = 0;
+	context->writer_failed = false;
+
+	BLI_init_threads(&context->writer_thread, ffmpeg_writer_thread, 1);
+	BLI_insert_thread(&context->writer_thread, context);
+}
+
+/* wait for all appended frames to be written */
+static void ffmpeg_writer_end(FFMpegContext *context)
+{
+	FFMpegFrame *frame;
+
+	if (context->frame_queue == NULL) {
+		return;
+	}
+
+	BLI_thread_queue_nowait(context->frame_queue);
+	BLI_end_threads(&context->writer_thread);
+
+	BLI_thread_queue_nowait(context->free_queue);
+	while ((frame = BLI_thread_queue_pop(context->free_queue))) {
+		if (frame->pixels) {
+			MEM_freeN(frame->pixels);
+		}
+		MEM_freeN(frame);
+	}
+
+	BLI_thread_queue_free(context->frame_queue);
+	BLI_thread_queue_free(context->free_queue);
+	context->frame_queue = NULL;
+	context->free_queue = NULL;
+	context->frames_len = 0;
+}
+
+/* Frames are queued for the writer thread, which converts and encodes them while
+ * the next frames render. Errors are reported for the frames appended after them. */
+int BKE_ffmpeg_append(void *context_v, RenderData *rd, int start_frame, int frame, int *pixels,
+                      int rectx, int recty, const char *suffix, ReportList *reports)
+{
+	FFMpegContext *context = context_v;
+	FFMpegFrame *qframe;
+	const size_t pixels_size = (context->video_stream && pixels) ? (size_t)rectx * (size_t)recty * sizeof(int) : 0;
+
+	if (context->frame_queue == NULL) {
+		return ffmpeg_write_frame(context, rd, start_frame, frame, pixels, rectx, recty, suffix, reports);
+	}
+
+	if (context->writer_failed) {
+		BKE_report(reports, RPT_ERROR, "Error writing frame");
+		return 0;
+	}
+
+	if (context->frames_len < FFMPEG_FRAMES_QUEUE_MAX) {
+		qframe = MEM_callocN(sizeof(FFMpegFrame), "FFMpegFrame");
+		context->frames_len++;
+	}
+	else {
+		/* wait for the writer thread to catch up */
+		qframe = BLI_thread_queue_pop(context->free_queue);
+	}
+
+	if (qframe->pixels_size != pixels_size) {
+		if (qframe->pixels) {
+			MEM_freeN(qframe->pixels);
+		}
+		qframe->pixels = pixels_size ? MEM_mallocN(pixels_size, "FFMpegFrame.pixels") : NULL;
+		qframe->pixels_size = pixels_size;
+	}
+
+	qframe->rd = *rd;
+	qframe->start_frame = start_frame;
+	qframe->frame = frame;
+	qframe->rectx = rectx;
+	qframe->recty = recty;
+	BLI_strncpy(qframe->suffix, suffix, sizeof(qframe->suffix));
+	if (pixels_size) {
+		memcpy(qframe->pixels, pixels, pixels_size);
+	}
+
+	BLI_thread_queue_push(context->frame_queue, qframe);
+
+	return 1;
+}
+
 static void end_ffmpeg_impl(FFMpegContext *context, int is_autosplit)
 {
 	PRINT("Closing ffmpeg...\n");
@@ -1292,6 +1432,7 @@ static void end_ffmpeg_impl(FFMpegContext *context, int is_autosplit)
 void BKE_ffmpeg_end(void *context_v)
 {
 	FFMpegContext *context = context_v;
+	ffmpeg_writer_end(context);
 	end_ffmpeg_impl(context, false);
 }
 
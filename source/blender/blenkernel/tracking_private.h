@@ -38,6 +38,7 @@
 #include "BLI_threads.h"
 
 struct GHash;
+struct ImBuf;
 struct MovieTracking;
 struct MovieTrackingMarker;
 
@@ -110,12 +111,26 @@ struct MovieTrackingMarker *tracking_get_keyframed_marker(
 struct libmv_FrameAccessor;
 
 #define MAX_ACCESSOR_CLIP 64
+#define MAX_ACCESSOR_HELD_FRAMES 4
+
+/* Original clip frame which is kept referenced by the accessor, so tracks
+ * can share it without going through the clip's locked frame cache. */
+typedef struct TrackingImageAccessorFrame {
+	int clip_index;
+	int frame;
+	struct ImBuf *ibuf;
+} TrackingImageAccessorFrame;
+
 typedef struct TrackingImageAccessor {
 	struct MovieCache *cache;
 	struct MovieClip *clips[MAX_ACCESSOR_CLIP];
 	int num_clips;
 	int start_frame;
 	struct libmv_FrameAccessor *libmv_accessor;
+
+	TrackingImageAccessorFrame held_frames[MAX_ACCESSOR_HELD_FRAMES];
+	int next_held_frame;
+	SpinLock held_frames_lock;
 } TrackingImageAccessor;
 
 TrackingImageAccessor *tracking_image_accessor_new(MovieClip *clips[MAX_ACCESSOR_CLIP],
@@ -123,4 +138,10 @@ TrackingImageAccessor *tracking_image_accessor_new(MovieClip *clips[MAX_ACCESSOR
                                                    int start_frame);
 void tracking_image_accessor_destroy(TrackingImageAccessor *accessor);
 
+/* Decode the given clip frame and keep it referenced, replacing the oldest
+ * held frame. Safe to call from multiple threads. */
+void tracking_image_accessor_hold_frame(TrackingImageAccessor *accessor,
+                                        int clip_index,
+                                        int frame);
+
 #endif  /* __TRACKING_PRIVATE_H__ */
@@ -0,0 +1,74 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+#ifndef __BLI_CONCURRENT_GHASH_H__
+#define __BLI_CONCURRENT_GHASH_H__
+
+/** \file BLI_concurrent_ghash.h
+ *  \ingroup bli
+ *
+ * A hash table which can be used from multiple threads at once, see concurrent_ghash.c.
+ */
+
+#include "BLI_ghash.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ConcurrentGHash ConcurrentGHash;
+
+ConcurrentGHash *BLI_concurrent_ghash_new_ex(
+        GHashHashFP hashfp, GHashCmpFP cmpfp, const char *info,
+        const unsigned int nentries_reserve) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+ConcurrentGHash *BLI_concurrent_ghash_new(
+        GHashHashFP hashfp, GHashCmpFP cmpfp, const char *info) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+void   BLI_concurrent_ghash_free(ConcurrentGHash *cgh, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp);
+
+/* thread-safe */
+void   BLI_concurrent_ghash_insert(ConcurrentGHash *cgh, void *key, void *val);
+bool   BLI_concurrent_ghash_add(ConcurrentGHash *cgh, void *key, void *val);
+void  *BLI_concurrent_ghash_lookup_or_add(ConcurrentGHash *cgh, void *key, void *val);
+void  *BLI_concurrent_ghash_lookup(ConcurrentGHash *cgh, const void *key) ATTR_WARN_UNUSED_RESULT;
+void  *BLI_concurrent_ghash_lookup_default(
+        ConcurrentGHash *cgh, const void *key, void *val_default) ATTR_WARN_UNUSED_RESULT;
+bool   BLI_concurrent_ghash_haskey(ConcurrentGHash *cgh, const void *key) ATTR_WARN_UNUSED_RESULT;
+bool   BLI_concurrent_ghash_remove(
+        ConcurrentGHash *cgh, const void *key, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp);
+void  *BLI_concurrent_ghash_popkey(
+        ConcurrentGHash *cgh, const void *key, GHashKeyFreeFP keyfreefp) ATTR_WARN_UNUSED_RESULT;
+unsigned int BLI_concurrent_ghash_size(ConcurrentGHash *cgh) ATTR_WARN_UNUSED_RESULT;
+
+/* not thread-safe, for when all threads are done */
+void   BLI_concurrent_ghash_foreach(
+        ConcurrentGHash *cgh, void (*func)(void *key, void *val, void *userdata), void *userdata);
+
+ConcurrentGHash *BLI_concurrent_ghash_ptr_new_ex(
+        const char *info, const unsigned int nentries_reserve) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+ConcurrentGHash *BLI_concurrent_ghash_ptr_new(const char *info) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+ConcurrentGHash *BLI_concurrent_ghash_int_new_ex(
+        const char *info, const unsigned int nentries_reserve) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+ConcurrentGHash *BLI_concurrent_ghash_int_new(const char *info) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BLI_CONCURRENT_GHASH_H__ */
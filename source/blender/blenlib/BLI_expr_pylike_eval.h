@@ -0,0 +1,63 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+#ifndef __BLI_EXPR_PYLIKE_EVAL_H__
+#define __BLI_EXPR_PYLIKE_EVAL_H__
+
+/** \file BLI_expr_pylike_eval.h
+ *  \ingroup bli
+ *
+ * Parses and evaluates simple math expressions with Python syntax and semantics,
+ * without needing Python, see expr_pylike_eval.c.
+ */
+
+#include "BLI_compiler_attrs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ExprPyLike_Parsed ExprPyLike_Parsed;
+
+typedef enum eExprPyLike_EvalStatus {
+	EXPR_PYLIKE_SUCCESS = 0,
+	/* the expression couldn't be parsed */
+	EXPR_PYLIKE_INVALID,
+	/* the wrong number of parameter values was passed */
+	EXPR_PYLIKE_FATAL_ERROR,
+	/* runtime errors, which Python would raise an exception for */
+	EXPR_PYLIKE_DIV_BY_ZERO,
+	EXPR_PYLIKE_MATH_ERROR,
+} eExprPyLike_EvalStatus;
+
+ExprPyLike_Parsed *BLI_expr_pylike_parse(
+        const char *expression, const char **param_names, int param_names_len) ATTR_WARN_UNUSED_RESULT;
+void BLI_expr_pylike_free(ExprPyLike_Parsed *expr);
+bool BLI_expr_pylike_is_valid(ExprPyLike_Parsed *expr);
+
+/* thread-safe */
+eExprPyLike_EvalStatus BLI_expr_pylike_eval(
+        ExprPyLike_Parsed *expr, const double *param_values, int param_values_len, double *r_result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BLI_EXPR_PYLIKE_EVAL_H__ */
@@ -123,6 +123,15 @@ int BLI_bvhtree_ray_cast(
         BVHTree *tree, const float co[3], const float dir[3], float radius, BVHTreeRayHit *hit,
         BVHTree_RayCastCallback callback, void *userdata);
 
+/* batched versions of the queries above, threaded for large arrays (callbacks must be thread-safe) */
+void BLI_bvhtree_find_nearest_array(
+        BVHTree *tree, const float (*co)[3], const int co_len, BVHTreeNearest *nearest,
+        BVHTree_NearestPointCallback callback, void *userdata);
+void BLI_bvhtree_ray_cast_array(
+        BVHTree *tree, const float (*co)[3], const float (*dir)[3], const int rays_len, float radius,
+        BVHTreeRayHit *hit, BVHTree_RayCastCallback callback, void *userdata,
+        int flag);
+
 int BLI_bvhtree_ray_cast_all_ex(
         BVHTree *tree, const float co[3], const float dir[3], float radius,
         BVHTree_RayCastCallback callback, void *userdata,
@@ -71,6 +71,9 @@ typedef struct BLI_mempool_iter {
 	BLI_mempool *pool;
 	struct BLI_mempool_chunk *curchunk;
 	unsigned int curindex;
+
+	/* next chunk to be claimed, shared by all thread-safe iterators of the pool */
+	struct BLI_mempool_chunk **curchunk_threaded_shared;
 } BLI_mempool_iter;
 
 /* flag */
@@ -87,6 +90,25 @@ enum {
 void  BLI_mempool_iternew(BLI_mempool *pool, BLI_mempool_iter *iter) ATTR_NONNULL();
 void *BLI_mempool_iterstep(BLI_mempool_iter *iter) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
 
+BLI_mempool_iter *BLI_mempool_iter_threadsafe_create(BLI_mempool *pool, const unsigned int num_iter) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
+void  BLI_mempool_iter_threadsafe_free(BLI_mempool_iter *iter_arr) ATTR_NONNULL();
+void *BLI_mempool_iterstep_threadsafe(BLI_mempool_iter *iter) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
+
+/** allocation from multiple threads: private structure, one per thread */
+typedef struct BLI_mempool_thread {
+	BLI_mempool *pool;
+	struct BLI_freenode *free;
+	/* chunks allocated by this thread, only added to the pool by BLI_mempool_thread_end */
+	struct BLI_mempool_chunk *chunks, *chunk_tail;
+	int totused;
+} BLI_mempool_thread;
+
+void  BLI_mempool_thread_begin(BLI_mempool *pool, BLI_mempool_thread *mpt) ATTR_NONNULL();
+void *BLI_mempool_thread_alloc(BLI_mempool_thread *mpt) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
+void *BLI_mempool_thread_calloc(BLI_mempool_thread *mpt) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
+void  BLI_mempool_thread_free(BLI_mempool_thread *mpt, void *addr) ATTR_NONNULL();
+void  BLI_mempool_thread_end(BLI_mempool_thread *mpt) ATTR_NONNULL();
+
 #ifdef __cplusplus
 }
 #endif
@@ -46,6 +46,11 @@ float BLI_turbulence1(float noisesize, float x, float y, float z, int nr);
  * This is done so different noise basis functions can be used */
 float BLI_gNoise(float noisesize, float x, float y, float z, int hard, int noisebasis);
 float BLI_gTurbulence(float noisesize, float x, float y, float z, int oct, int hard, int noisebasis);
+/* newnoise: batched versions of the above, evaluating co_len points at once */
+void BLI_gNoise_array(float noisesize, const float (*co)[3], const int co_len, int hard, int noisebasis,
+                      float *r_values);
+void BLI_gTurbulence_array(float noisesize, const float (*co)[3], const int co_len, int oct, int hard, int noisebasis,
+                           float *r_values);
 /* newnoise: musgrave functions */
 float mg_fBm(float x, float y, float z, float H, float lacunarity, float octaves, int noisebasis);
 float mg_MultiFractal(float x, float y, float z, float H, float lacunarity, float octaves, int noisebasis);
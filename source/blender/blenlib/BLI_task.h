@@ -32,6 +32,8 @@ extern "C" {
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
+struct BLI_mempool;
+
 /* Task Scheduler
  * 
  * Central scheduler that holds running threads ready to execute tasks. A single
@@ -52,6 +54,7 @@ TaskScheduler *BLI_task_scheduler_create(int num_threads);
 void BLI_task_scheduler_free(TaskScheduler *scheduler);
 
 int BLI_task_scheduler_num_threads(TaskScheduler *scheduler);
+int BLI_task_scheduler_thread_id(TaskScheduler *scheduler);
 
 /* Task Pool
  *
@@ -126,6 +129,28 @@ void BLI_task_parallel_range(
         void *userdata,
         TaskParallelRangeFunc func);
 
+typedef void (*TaskParallelRangeFuncInit)(void *userdata, void *userdata_chunk);
+typedef void (*TaskParallelRangeFuncReduce)(void *userdata, void *userdata_chunk_join, void *userdata_chunk);
+typedef void (*TaskParallelRangeFuncFinalize)(void *userdata, void *userdata_chunk);
+void BLI_task_parallel_range_reduce(
+        int start, int stop,
+        void *userdata,
+        void *userdata_chunk,
+        const size_t userdata_chunk_size,
+        TaskParallelRangeFunc func,
+        TaskParallelRangeFuncInit func_init,
+        TaskParallelRangeFuncReduce func_reduce,
+        TaskParallelRangeFuncFinalize func_finalize,
+        const int chunk_size,
+        const bool use_threading);
+
+typedef void (*TaskParallelMempoolFunc)(void *userdata, void *item);
+void BLI_task_parallel_mempool(
+        struct BLI_mempool *mempool,
+        void *userdata,
+        TaskParallelMempoolFunc func,
+        const bool use_threading);
+
 #ifdef __cplusplus
 }
 #endif
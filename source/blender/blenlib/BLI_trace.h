@@ -0,0 +1,60 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+#ifndef __BLI_TRACE_H__
+#define __BLI_TRACE_H__
+
+/** \file BLI_trace.h
+ *  \ingroup bli
+ *
+ * Opt-in timing of code regions, for finding out where time goes in a running session.
+ *
+ * Usage:
+ * \code{.c}
+ * const double trace_start = BLI_trace_begin();
+ * ...
+ * BLI_trace_end("wm_draw_update", trace_start);
+ * \endcode
+ *
+ * When tracing isn't enabled #BLI_trace_begin returns zero and #BLI_trace_end does nothing.
+ * Regions are recorded per thread into a ring buffer, so only the most recent ones are kept,
+ * and written out in the Chrome trace event format (open in chrome://tracing).
+ */
+
+#include "BLI_compiler_attrs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void BLI_trace_init(const char *filepath);
+void BLI_trace_exit(void);
+bool BLI_trace_is_enabled(void);
+
+double BLI_trace_begin(void) ATTR_WARN_UNUSED_RESULT;
+void   BLI_trace_end(const char *name, const double start);
+
+bool BLI_trace_write(const char *filepath) ATTR_NONNULL();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __BLI_TRACE_H__ */
@@ -37,6 +37,8 @@
  *   #BLI_bvhtree_find_nearest, #BVHNearestData
  * - Overlapping 2 trees:
  *   #BLI_bvhtree_overlap, #BVHOverlapData_Shared, #BVHOverlapData_Thread
+ * - Batched queries (threaded):
+ *   #BLI_bvhtree_ray_cast_array, #BLI_bvhtree_find_nearest_array
  */
 
 #include <assert.h>
@@ -51,6 +53,10 @@
 #include "BLI_strict_flags.h"
 #include "BLI_task.h"
 
+#ifdef __SSE__
+#  include <xmmintrin.h>
+#endif
+
 /* used for iterative_raycast */
 // #define USE_SKIP_LINKS
 
@@ -61,10 +67,16 @@
  */
 #ifdef DEBUG
 #  define KDOPBVH_THREAD_LEAF_THRESHOLD 0
+#  define KDOPBVH_THREAD_QUERY_THRESHOLD 0
 #else
 #  define KDOPBVH_THREAD_LEAF_THRESHOLD 1024
+#  define KDOPBVH_THREAD_QUERY_THRESHOLD 256
 #endif
 
+/* refit the bounds of branches with more leafs than this with multiple threads,
+ * only the top levels of big trees, where there are fewer branches than threads */
+#define KDOPBVH_THREAD_REFIT_THRESHOLD 100000
+
 typedef unsigned char axis_t;
 
 typedef struct BVHNode {
@@ -459,6 +471,36 @@ static void create_kdop_hull(BVHTree *tree, BVHNode *node, const float *co, int
 	}
 }
 
+static void refit_kdop_hull_task_cb(void *userdata, void *userdata_chunk, int j)
+{
+	const BVHTree *tree = userdata;
+	const float *node_bv = tree->nodes[j]->bv;
+	float *bv = userdata_chunk;
+	axis_t axis_iter;
+
+	for (axis_iter = tree->start_axis; axis_iter < tree->stop_axis; axis_iter++) {
+		if (node_bv[(2 * axis_iter)] < bv[(2 * axis_iter)])
+			bv[(2 * axis_iter)] = node_bv[(2 * axis_iter)];
+		if (node_bv[(2 * axis_iter) + 1] > bv[(2 * axis_iter) + 1])
+			bv[(2 * axis_iter) + 1] = node_bv[(2 * axis_iter) + 1];
+	}
+}
+
+static void refit_kdop_hull_reduce_cb(void *userdata, void *userdata_chunk_join, void *userdata_chunk)
+{
+	const BVHTree *tree = userdata;
+	const float *bv_chunk = userdata_chunk;
+	float *bv = userdata_chunk_join;
+	axis_t axis_iter;
+
+	for (axis_iter = tree->start_axis; axis_iter < tree->stop_axis; axis_iter++) {
+		if (bv_chunk[(2 * axis_iter)] < bv[(2 * axis_iter)])
+			bv[(2 * axis_iter)] = bv_chunk[(2 * axis_iter)];
+		if (bv_chunk[(2 * axis_iter) + 1] > bv[(2 * axis_iter) + 1])
+			bv[(2 * axis_iter) + 1] = bv_chunk[(2 * axis_iter) + 1];
+	}
+}
+
 /**
  * \note depends on the fact that the BVH's for each face is already build
  */
@@ -471,6 +513,13 @@ static void refit_kdop_hull(BVHTree *tree, BVHNode *node, int start, int end)
 
 	node_minmax_init(tree, node);
 
+	if (end - start > KDOPBVH_THREAD_REFIT_THRESHOLD) {
+		BLI_task_parallel_range_reduce(
+		            start, end, tree, bv, sizeof(*bv) * (size_t)tree->axis,
+		            refit_kdop_hull_task_cb, NULL, refit_kdop_hull_reduce_cb, NULL, 0, true);
+		return;
+	}
+
 	for (j = start; j < end; j++) {
 		/* for all Axes. */
 		for (axis_iter = tree->start_axis; axis_iter < tree->stop_axis; axis_iter++) {
@@ -1055,6 +1104,12 @@ bool BLI_bvhtree_update_node(BVHTree *tree, int index, const float co[3], const
 	return true;
 }
 
+static void bvhtree_update_tree_task_cb(void *userdata, void *UNUSED(userdata_chunk), int j)
+{
+	BVHTree *tree = userdata;
+	node_join(tree, tree->nodes[tree->totleaf + j]);
+}
+
 /* call BLI_bvhtree_update_node() first for every node/point/triangle */
 void BLI_bvhtree_update_tree(BVHTree *tree)
 {
@@ -1065,6 +1120,27 @@ void BLI_bvhtree_update_tree(BVHTree *tree)
 	BVHNode **root  = tree->nodes + tree->totleaf;
 	BVHNode **index = tree->nodes + tree->totleaf + tree->totbranch - 1;
 
+	if (tree->totleaf > KDOPBVH_THREAD_LEAF_THRESHOLD) {
+		/* branches of the same level don't depend on each other,
+		 * join them level by level (see non_recursive_bvh_div_nodes) */
+		const int tree_offset = 2 - tree->tree_type;
+		int level_start[32], level_end[32];
+		int depth = 0, i;
+
+		/* 1-based implicit branch index, as used when building */
+		for (i = 1; i <= tree->totbranch; i = i * tree->tree_type + tree_offset) {
+			BLI_assert(depth < 32);
+			level_start[depth] = i - 1;
+			level_end[depth] = min_ii(i * tree->tree_type + tree_offset, tree->totbranch + 1) - 1;
+			depth++;
+		}
+
+		while (depth--) {
+			BLI_task_parallel_range(level_start[depth], level_end[depth], tree, bvhtree_update_tree_task_cb);
+		}
+		return;
+	}
+
 	for (; index >= root; index--)
 		node_join(tree, *index);
 }
@@ -1493,6 +1569,37 @@ int BLI_bvhtree_find_nearest(BVHTree *tree, const float co[3], BVHTreeNearest *n
 	return data.nearest.index;
 }
 
+typedef struct BVHNearestArrayData {
+	BVHTree *tree;
+	const float (*co)[3];
+	BVHTreeNearest *nearest;
+	BVHTree_NearestPointCallback callback;
+	void *userdata;
+} BVHNearestArrayData;
+
+static void bvhtree_find_nearest_array_task_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	BVHNearestArrayData *data = userdata;
+	BLI_bvhtree_find_nearest(data->tree, data->co[i], &data->nearest[i], data->callback, data->userdata);
+}
+
+/**
+ * Run #BLI_bvhtree_find_nearest for every coordinate in \a co, using multiple threads for large arrays.
+ *
+ * \param nearest  Array sized \a co_len, initialized as for #BLI_bvhtree_find_nearest (index and dist_sq).
+ * \param callback  Optional, must be thread-safe.
+ */
+void BLI_bvhtree_find_nearest_array(
+        BVHTree *tree, const float (*co)[3], const int co_len, BVHTreeNearest *nearest,
+        BVHTree_NearestPointCallback callback, void *userdata)
+{
+	BVHNearestArrayData data = {tree, co, nearest, callback, userdata};
+
+	BLI_task_parallel_range_ex(
+	            0, co_len, &data, NULL, 0, bvhtree_find_nearest_array_task_cb,
+	            co_len > KDOPBVH_THREAD_QUERY_THRESHOLD, false);
+}
+
 
 /**
  * Raycast - BLI_bvhtree_ray_cast
@@ -1542,6 +1649,35 @@ static float ray_nearest_hit(BVHRayCastData *data, const float bv[6])
  * [http://tog.acm.org/resources/RTNews/html/rtnv21n1.html#art9]
  *
  * TODO this doesn't take data->ray.radius into consideration */
+#ifdef __SSE__
+static float fast_ray_nearest_hit(const BVHRayCastData *data, const BVHNode *node)
+{
+	const float *bv = node->bv;
+	/* the 4th lane repeats z, so it doesn't change the min/max */
+	const __m128 origin = _mm_set_ps(data->ray.origin[2], data->ray.origin[2], data->ray.origin[1], data->ray.origin[0]);
+	const __m128 idot = _mm_set_ps(data->idot_axis[2], data->idot_axis[2], data->idot_axis[1], data->idot_axis[0]);
+	const __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set_ps(bv[data->index[4]], bv[data->index[4]], bv[data->index[2]], bv[data->index[0]]), origin), idot);
+	const __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_set_ps(bv[data->index[5]], bv[data->index[5]], bv[data->index[3]], bv[data->index[1]]), origin), idot);
+	__m128 t_min, t_max;
+	float t_near, t_far;
+
+	t_min = _mm_max_ps(t1, _mm_shuffle_ps(t1, t1, _MM_SHUFFLE(1, 0, 3, 2)));
+	t_min = _mm_max_ps(t_min, _mm_shuffle_ps(t_min, t_min, _MM_SHUFFLE(2, 3, 0, 1)));
+	t_max = _mm_min_ps(t2, _mm_shuffle_ps(t2, t2, _MM_SHUFFLE(1, 0, 3, 2)));
+	t_max = _mm_min_ps(t_max, _mm_shuffle_ps(t_max, t_max, _MM_SHUFFLE(2, 3, 0, 1)));
+
+	t_near = _mm_cvtss_f32(t_min);
+	t_far = _mm_cvtss_f32(t_max);
+
+	/* same tests as the scalar version below: the slabs overlap, in front of the ray, closer than the hit */
+	if ((t_near > t_far) || (t_far < 0.0f) || (t_near > data->hit.dist)) {
+		return FLT_MAX;
+	}
+	else {
+		return t_near;
+	}
+}
+#else
 static float fast_ray_nearest_hit(const BVHRayCastData *data, const BVHNode *node)
 {
 	const float *bv = node->bv;
@@ -1563,6 +1699,7 @@ static float fast_ray_nearest_hit(const BVHRayCastData *data, const BVHNode *nod
 		return max_fff(t1x, t1y, t1z);
 	}
 }
+#endif  /* __SSE__ */
 
 static void dfs_raycast(BVHRayCastData *data, BVHNode *node)
 {
@@ -1607,12 +1744,15 @@ static void dfs_raycast_all(BVHRayCastData *data, BVHNode *node)
 	 * before calling the ray-primitive functions */
 	/* XXX: temporary solution for particles until fast_ray_nearest_hit supports ray.radius */
 	float dist = (data->ray.radius == 0.0f) ? fast_ray_nearest_hit(data, node) : ray_nearest_hit(data, node->bv);
+	if (dist == FLT_MAX) return;
 
 	if (node->totnode == 0) {
 		if (data->callback) {
 			data->hit.index = -1;
 			data->hit.dist = FLT_MAX;
 			data->callback(data->userdata, node->index, &data->ray, &data->hit);
+			/* the callback may shorten the hit, which must not cull the remaining nodes */
+			data->hit.dist = FLT_MAX;
 		}
 		else {
 			data->hit.index = node->index;
@@ -1742,6 +1882,43 @@ int BLI_bvhtree_ray_cast(
 	return BLI_bvhtree_ray_cast_ex(tree, co, dir, radius, hit, callback, userdata, BVH_RAYCAST_DEFAULT);
 }
 
+typedef struct BVHRayCastArrayData {
+	BVHTree *tree;
+	const float (*co)[3];
+	const float (*dir)[3];
+	float radius;
+	BVHTreeRayHit *hit;
+	BVHTree_RayCastCallback callback;
+	void *userdata;
+	int flag;
+} BVHRayCastArrayData;
+
+static void bvhtree_ray_cast_array_task_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	BVHRayCastArrayData *data = userdata;
+	BLI_bvhtree_ray_cast_ex(
+	        data->tree, data->co[i], data->dir[i], data->radius, &data->hit[i],
+	        data->callback, data->userdata, data->flag);
+}
+
+/**
+ * Run #BLI_bvhtree_ray_cast_ex for every ray in \a co, \a dir, using multiple threads for large arrays.
+ *
+ * \param hit  Array sized \a rays_len, initialized as for #BLI_bvhtree_ray_cast_ex (index and dist).
+ * \param callback  Optional, must be thread-safe.
+ */
+void BLI_bvhtree_ray_cast_array(
+        BVHTree *tree, const float (*co)[3], const float (*dir)[3], const int rays_len, float radius,
+        BVHTreeRayHit *hit, BVHTree_RayCastCallback callback, void *userdata,
+        int flag)
+{
+	BVHRayCastArrayData data = {tree, co, dir, radius, hit, callback, userdata, flag};
+
+	BLI_task_parallel_range_ex(
+	            0, rays_len, &data, NULL, 0, bvhtree_ray_cast_array_task_cb,
+	            rays_len > KDOPBVH_THREAD_QUERY_THRESHOLD, false);
+}
+
 float BLI_bvhtree_bb_raycast(const float bv[6], const float light_start[3], const float light_end[3], float pos[3])
 {
 	BVHRayCastData data;
@@ -29,6 +29,7 @@
 
 #include "BLI_math.h"
 #include "BLI_kdtree.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "BLI_strict_flags.h"
 
@@ -61,6 +62,9 @@ struct KDTree {
 
 #define KD_NODE_UNSET ((unsigned int)-1)
 
+#define KD_BALANCE_THREAD_MIN 10000  /* balance subtrees with more nodes in their own task */
+#define KD_QUERY_THREAD_MIN 1000     /* use threads for batched queries with more points */
+
 /**
  * Creates or free a kdtree
  */
@@ -113,7 +117,32 @@ void BLI_kdtree_insert(KDTree *tree, int index, const float co[3])
 #endif
 }
 
-static unsigned int kdtree_balance(KDTreeNode *nodes, unsigned int totnode, unsigned int axis, const unsigned int ofs)
+typedef struct KDTreeBalanceTask {
+	KDTreeNode *nodes;
+	unsigned int totnode, axis, ofs;
+} KDTreeBalanceTask;
+
+static unsigned int kdtree_balance(
+        KDTreeNode *nodes, unsigned int totnode, unsigned int axis, const unsigned int ofs,
+        TaskPool *pool);
+
+/**
+ * The root #kdtree_balance returns, without having to balance the nodes first.
+ */
+static unsigned int kdtree_balance_root(const unsigned int totnode, const unsigned int ofs)
+{
+	return (totnode == 0) ? KD_NODE_UNSET : (totnode / 2) + ofs;
+}
+
+static void kdtree_balance_task(TaskPool *__restrict pool, void *taskdata, int UNUSED(threadid))
+{
+	KDTreeBalanceTask *task = taskdata;
+	kdtree_balance(task->nodes, task->totnode, task->axis, task->ofs, pool);
+}
+
+static unsigned int kdtree_balance(
+        KDTreeNode *nodes, unsigned int totnode, unsigned int axis, const unsigned int ofs,
+        TaskPool *pool)
 {
 	KDTreeNode *node;
 	float co;
@@ -155,15 +184,36 @@ static unsigned int kdtree_balance(KDTreeNode *nodes, unsigned int totnode, unsi
 	node = &nodes[median];
 	node->d = axis;
 	axis = (axis + 1) % 3;
-	node->left = kdtree_balance(nodes, median, axis, ofs);
-	node->right = kdtree_balance(nodes + median + 1, (totnode - (median + 1)), axis, (median + 1) + ofs);
+
+	/* both halves are independent, large ones are balanced by another thread */
+	if (pool && (totnode - (median + 1)) >= KD_BALANCE_THREAD_MIN) {
+		KDTreeBalanceTask *task = MEM_mallocN(sizeof(*task), __func__);
+		task->nodes = nodes + median + 1;
+		task->totnode = totnode - (median + 1);
+		task->axis = axis;
+		task->ofs = (median + 1) + ofs;
+		node->right = kdtree_balance_root(task->totnode, task->ofs);
+		BLI_task_pool_push(pool, kdtree_balance_task, task, true, TASK_PRIORITY_HIGH);
+	}
+	else {
+		node->right = kdtree_balance(nodes + median + 1, (totnode - (median + 1)), axis, (median + 1) + ofs, pool);
+	}
+	node->left = kdtree_balance(nodes, median, axis, ofs, pool);
 
 	return median + ofs;
 }
 
 void BLI_kdtree_balance(KDTree *tree)
 {
-	tree->root = kdtree_balance(tree->nodes, tree->totnode, 0, 0);
+	if (tree->totnode >= KD_BALANCE_THREAD_MIN) {
+		TaskPool *pool = BLI_task_pool_create(BLI_task_scheduler_get(), NULL);
+		tree->root = kdtree_balance(tree->nodes, tree->totnode, 0, 0, pool);
+		BLI_task_pool_work_and_wait(pool);
+		BLI_task_pool_free(pool);
+	}
+	else {
+		tree->root = kdtree_balance(tree->nodes, tree->totnode, 0, 0, NULL);
+	}
 
 #ifdef DEBUG
 	tree->is_balanced = true;
@@ -674,3 +724,70 @@ finally:
 	if (stack != defaultstack)
 		MEM_freeN(stack);
 }
+
+/* -------------------------------------------------------------------- */
+/* Batched Queries */
+
+typedef struct KDTreeNearestArrayData {
+	const KDTree *tree;
+	const float (*co)[3];
+	KDTreeNearest *r_nearest;
+	int *r_index;
+	int *r_found;
+	unsigned int n;
+} KDTreeNearestArrayData;
+
+static void kdtree_find_nearest_array_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	KDTreeNearestArrayData *data = userdata;
+	const int index = BLI_kdtree_find_nearest(data->tree, data->co[i], data->r_nearest ? &data->r_nearest[i] : NULL);
+
+	if (data->r_index) {
+		data->r_index[i] = index;
+	}
+}
+
+/**
+ * Find the nearest point for every coordinate in \a co, using multiple threads for large arrays.
+ *
+ * \param r_nearest  Optional array of nearest, sized \a co_len.
+ * \param r_index  Optional array of indices (-1 when no node is found), sized \a co_len.
+ */
+void BLI_kdtree_find_nearest_array(
+        const KDTree *tree, const float (*co)[3], const unsigned int co_len,
+        KDTreeNearest *r_nearest, int *r_index)
+{
+	KDTreeNearestArrayData data = {tree, co, r_nearest, r_index, NULL, 0};
+
+	BLI_task_parallel_range_ex(
+	        0, (int)co_len, &data, NULL, 0, kdtree_find_nearest_array_cb,
+	        co_len >= KD_QUERY_THREAD_MIN, false);
+}
+
+static void kdtree_find_nearest_n_array_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	KDTreeNearestArrayData *data = userdata;
+	const int found = BLI_kdtree_find_nearest_n(data->tree, data->co[i], &data->r_nearest[(unsigned int)i * data->n], data->n);
+
+	if (data->r_found) {
+		data->r_found[i] = found;
+	}
+}
+
+/**
+ * Find the \a n nearest points for every coordinate in \a co, using multiple threads for large arrays.
+ *
+ * \param r_nearest  An array of nearest, sized \a co_len * \a n,
+ * the results for ``co[i]`` start at ``r_nearest[i * n]``.
+ * \param r_found  Optional array with the number of points found for every coordinate, sized \a co_len.
+ */
+void BLI_kdtree_find_nearest_n_array(
+        const KDTree *tree, const float (*co)[3], const unsigned int co_len,
+        KDTreeNearest *r_nearest, int *r_found, unsigned int n)
+{
+	KDTreeNearestArrayData data = {tree, co, r_nearest, NULL, r_found, n};
+
+	BLI_task_parallel_range_ex(
+	        0, (int)co_len, &data, NULL, 0, kdtree_find_nearest_n_array_cb,
+	        co_len >= KD_QUERY_THREAD_MIN, false);
+}
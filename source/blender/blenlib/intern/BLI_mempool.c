@@ -40,6 +40,7 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <pthread.h>
 
 #include "BLI_utildefines.h"
 
@@ -47,6 +48,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_strict_flags.h"  /* keep last */
 
 #ifdef WITH_MEM_VALGRIND
@@ -545,6 +548,58 @@ void BLI_mempool_iternew(BLI_mempool *pool, BLI_mempool_iter *iter)
 	iter->pool = pool;
 	iter->curchunk = pool->chunks;
 	iter->curindex = 0;
+
+	iter->curchunk_threaded_shared = NULL;
+}
+
+/* take the next chunk nobody is iterating over yet */
+static BLI_mempool_chunk *mempool_chunk_claim(BLI_mempool_chunk **curchunk_shared)
+{
+	BLI_mempool_chunk *chunk;
+
+	do {
+		chunk = *(BLI_mempool_chunk * volatile *)curchunk_shared;
+		if (chunk == NULL) {
+			return NULL;
+		}
+	} while (atomic_cas_ptr((void **)curchunk_shared, chunk, chunk->next) != chunk);
+
+	return chunk;
+}
+
+/**
+ * Create an array of thread-safe iterators, \a BLI_MEMPOOL_ALLOW_ITER flag must be set.
+ *
+ * Each iterator is meant to be used by a single thread, together they step over every
+ * element of the pool once, with whole chunks handed out to whichever iterator needs one.
+ * The pool must not be modified while iterating.
+ */
+BLI_mempool_iter *BLI_mempool_iter_threadsafe_create(BLI_mempool *pool, const unsigned int num_iter)
+{
+	BLI_mempool_iter *iter_arr = MEM_mallocN(sizeof(*iter_arr) * num_iter, __func__);
+	BLI_mempool_chunk **curchunk_threaded_shared = MEM_mallocN(sizeof(void *), __func__);
+	unsigned int i;
+
+	BLI_assert(pool->flag & BLI_MEMPOOL_ALLOW_ITER);
+
+	*curchunk_threaded_shared = pool->chunks;
+
+	for (i = 0; i < num_iter; i++) {
+		iter_arr[i].pool = pool;
+		iter_arr[i].curchunk = mempool_chunk_claim(curchunk_threaded_shared);
+		iter_arr[i].curindex = 0;
+		iter_arr[i].curchunk_threaded_shared = curchunk_threaded_shared;
+	}
+
+	return iter_arr;
+}
+
+void BLI_mempool_iter_threadsafe_free(BLI_mempool_iter *iter_arr)
+{
+	BLI_assert(iter_arr->curchunk_threaded_shared != NULL);
+
+	MEM_freeN(iter_arr->curchunk_threaded_shared);
+	MEM_freeN(iter_arr);
 }
 
 #if 0
@@ -609,6 +664,31 @@ void *BLI_mempool_iterstep(BLI_mempool_iter *iter)
 
 #endif
 
+/**
+ * Step over an iterator created by #BLI_mempool_iter_threadsafe_create,
+ * returning the mempool item or NULL when no chunks are left.
+ */
+void *BLI_mempool_iterstep_threadsafe(BLI_mempool_iter *iter)
+{
+	BLI_freenode *ret;
+
+	do {
+		if (LIKELY(iter->curchunk)) {
+			ret = (BLI_freenode *)(((char *)CHUNK_DATA(iter->curchunk)) + (iter->pool->esize * iter->curindex));
+		}
+		else {
+			return NULL;
+		}
+
+		if (UNLIKELY(++iter->curindex == iter->pool->pchunk)) {
+			iter->curindex = 0;
+			iter->curchunk = mempool_chunk_claim(iter->curchunk_threaded_shared);
+		}
+	} while (ret->freeword == FREEWORD);
+
+	return ret;
+}
+
 /**
  * Empty the pool, as if it were just created.
  *
@@ -689,6 +769,170 @@ void BLI_mempool_destroy(BLI_mempool *pool)
 	MEM_freeN(pool);
 }
 
+/* -------------------------------------------------------------------- */
+/* Thread Allocation API */
+
+/** \name Thread Allocation
+ *
+ * Every thread allocating from the pool uses its own #BLI_mempool_thread,
+ * with a free list and new chunks of its own, so allocating and freeing needs no locking.
+ * Elements stay in chunks of the pool, which only get added to it by #BLI_mempool_thread_end.
+ *
+ * \note While threads allocate, the pool may only be used through #BLI_mempool_thread functions,
+ * and #BLI_mempool_count doesn't include their elements.
+ * \{ */
+
+/* only taken on begin and end, shared by all pools.
+ * Uses pthread directly, makesdna links this file without threads.c */
+static pthread_mutex_t mempool_thread_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Start allocating from \a pool in this thread,
+ * the first thread also takes over the free elements of the pool.
+ */
+void BLI_mempool_thread_begin(BLI_mempool *pool, BLI_mempool_thread *mpt)
+{
+	mpt->pool = pool;
+	mpt->chunks = NULL;
+	mpt->chunk_tail = NULL;
+	mpt->totused = 0;
+
+	pthread_mutex_lock(&mempool_thread_lock);
+	mpt->free = pool->free;
+	pool->free = NULL;
+	pthread_mutex_unlock(&mempool_thread_lock);
+}
+
+static void mempool_thread_chunk_add(BLI_mempool_thread *mpt)
+{
+	BLI_mempool *pool = mpt->pool;
+	const unsigned int esize = pool->esize;
+	BLI_mempool_chunk *mpchunk = mempool_chunk_alloc(pool);
+	BLI_freenode *curnode = CHUNK_DATA(mpchunk);
+	unsigned int j;
+
+	mpchunk->next = NULL;
+	if (mpt->chunk_tail) {
+		mpt->chunk_tail->next = mpchunk;
+	}
+	else {
+		mpt->chunks = mpchunk;
+	}
+	mpt->chunk_tail = mpchunk;
+
+	mpt->free = curnode;
+
+	/* same as mempool_chunk_add */
+	j = pool->pchunk;
+	if (pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
+		while (j--) {
+			curnode->next = NODE_STEP_NEXT(curnode);
+			curnode->freeword = FREEWORD;
+			curnode = curnode->next;
+		}
+	}
+	else {
+		while (j--) {
+			curnode->next = NODE_STEP_NEXT(curnode);
+			curnode = curnode->next;
+		}
+	}
+
+	curnode = NODE_STEP_PREV(curnode);
+	curnode->next = NULL;
+}
+
+void *BLI_mempool_thread_alloc(BLI_mempool_thread *mpt)
+{
+	BLI_freenode *free_pop;
+
+	if (UNLIKELY(mpt->free == NULL)) {
+		mempool_thread_chunk_add(mpt);
+	}
+
+	free_pop = mpt->free;
+
+	if (mpt->pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
+		free_pop->freeword = USEDWORD;
+	}
+
+	mpt->free = free_pop->next;
+	mpt->totused++;
+
+	return (void *)free_pop;
+}
+
+void *BLI_mempool_thread_calloc(BLI_mempool_thread *mpt)
+{
+	void *retval = BLI_mempool_thread_alloc(mpt);
+	memset(retval, 0, (size_t)mpt->pool->esize);
+	return retval;
+}
+
+/**
+ * Free an element allocated from the pool, by any thread.
+ * Unlike #BLI_mempool_free, chunks are never freed.
+ */
+void BLI_mempool_thread_free(BLI_mempool_thread *mpt, void *addr)
+{
+	BLI_freenode *newhead = addr;
+
+	if (mpt->pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
+		BLI_assert(newhead->freeword != FREEWORD);
+		newhead->freeword = FREEWORD;
+	}
+
+	newhead->next = mpt->free;
+	mpt->free = newhead;
+
+	mpt->totused--;
+}
+
+/**
+ * Stop allocating from the pool in this thread,
+ * adds the new chunks and the free elements of \a mpt to the pool.
+ */
+void BLI_mempool_thread_end(BLI_mempool_thread *mpt)
+{
+	BLI_mempool *pool = mpt->pool;
+	BLI_freenode *free_tail = NULL;
+
+	/* find the end of the free list outside of the lock */
+	if (mpt->free) {
+		for (free_tail = mpt->free; free_tail->next; free_tail = free_tail->next) {
+			/* pass */
+		}
+	}
+
+	pthread_mutex_lock(&mempool_thread_lock);
+
+	if (mpt->chunks) {
+		if (pool->chunk_tail) {
+			pool->chunk_tail->next = mpt->chunks;
+		}
+		else {
+			pool->chunks = mpt->chunks;
+		}
+		pool->chunk_tail = mpt->chunk_tail;
+	}
+
+	if (free_tail) {
+		free_tail->next = pool->free;
+		pool->free = mpt->free;
+	}
+
+	pool->totused = (unsigned int)((int)pool->totused + mpt->totused);
+
+	pthread_mutex_unlock(&mempool_thread_lock);
+
+	mpt->free = NULL;
+	mpt->chunks = NULL;
+	mpt->chunk_tail = NULL;
+	mpt->totused = 0;
+}
+
+/** \} */
+
 #ifndef NDEBUG
 void BLI_mempool_set_memory_debug(void)
 {
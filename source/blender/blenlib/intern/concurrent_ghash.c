@@ -0,0 +1,306 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/blenlib/intern/concurrent_ghash.c
+ *  \ingroup bli
+ *
+ * A (pointer -> pointer) hash table which multiple threads can insert into and lookup from at once,
+ * using the same hash and compare callbacks as #GHash.
+ *
+ * The keys are split over a fixed number of shards by their hash, every shard is a #GHash with its own lock.
+ * Threads working on keys of different shards don't wait for each other,
+ * with enough shards a lock is rarely taken by more than one thread at once.
+ *
+ * \note None of the functions return pointers into the table (like #BLI_ghash_lookup_p),
+ * since another thread may resize the shard while they are used.
+ */
+
+#include <stdlib.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_ghash.h"
+#include "BLI_threads.h"
+
+#include "BLI_concurrent_ghash.h"
+#include "BLI_strict_flags.h"
+
+#define CGHASH_SHARD_BIT 6
+#define CGHASH_SHARD_NUM (1 << CGHASH_SHARD_BIT)
+
+typedef struct ConcurrentGHashShard {
+	GHash *gh;
+	SpinLock lock;
+	/* keep the locks of different shards in different cache lines */
+	char _pad[64];
+} ConcurrentGHashShard;
+
+struct ConcurrentGHash {
+	GHashHashFP hashfp;
+	ConcurrentGHashShard shards[CGHASH_SHARD_NUM];
+};
+
+/* -------------------------------------------------------------------- */
+/* Internal Utility API */
+
+BLI_INLINE ConcurrentGHashShard *cghash_shard_lock(ConcurrentGHash *cgh, const void *key)
+{
+	/* use the high bits of a multiplication, the low bits of the hash pick the bucket within the shard */
+	const unsigned int hash = cgh->hashfp(key);
+	ConcurrentGHashShard *shard = &cgh->shards[(hash * 2654435761u) >> (32 - CGHASH_SHARD_BIT)];
+
+	BLI_spin_lock(&shard->lock);
+	return shard;
+}
+
+BLI_INLINE void cghash_shard_unlock(ConcurrentGHashShard *shard)
+{
+	BLI_spin_unlock(&shard->lock);
+}
+
+/* -------------------------------------------------------------------- */
+/* Public API */
+
+/**
+ * Creates a new, empty ConcurrentGHash.
+ *
+ * \param hashfp  Hash callback.
+ * \param cmpfp  Comparison callback.
+ * \param info  A string identifier for debugging, used for the memory allocation.
+ * \param nentries_reserve  Optionally reserve the number of members that the hash will hold.
+ * \return  An empty ConcurrentGHash.
+ */
+ConcurrentGHash *BLI_concurrent_ghash_new_ex(
+        GHashHashFP hashfp, GHashCmpFP cmpfp, const char *info,
+        const unsigned int nentries_reserve)
+{
+	ConcurrentGHash *cgh = MEM_mallocN(sizeof(*cgh), info);
+	const unsigned int nentries_reserve_shard = nentries_reserve / CGHASH_SHARD_NUM;
+	int i;
+
+	cgh->hashfp = hashfp;
+
+	for (i = 0; i < CGHASH_SHARD_NUM; i++) {
+		cgh->shards[i].gh = BLI_ghash_new_ex(hashfp, cmpfp, info, nentries_reserve_shard);
+		BLI_spin_init(&cgh->shards[i].lock);
+	}
+
+	return cgh;
+}
+
+/**
+ * Wraps #BLI_concurrent_ghash_new_ex with zero entries reserved.
+ */
+ConcurrentGHash *BLI_concurrent_ghash_new(GHashHashFP hashfp, GHashCmpFP cmpfp, const char *info)
+{
+	return BLI_concurrent_ghash_new_ex(hashfp, cmpfp, info, 0);
+}
+
+/**
+ * Frees the ConcurrentGHash and its members, no other thread may use it anymore.
+ *
+ * \param keyfreefp  Optional callback to free the key.
+ * \param valfreefp  Optional callback to free the value.
+ */
+void BLI_concurrent_ghash_free(ConcurrentGHash *cgh, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp)
+{
+	int i;
+
+	for (i = 0; i < CGHASH_SHARD_NUM; i++) {
+		BLI_ghash_free(cgh->shards[i].gh, keyfreefp, valfreefp);
+		BLI_spin_end(&cgh->shards[i].lock);
+	}
+
+	MEM_freeN(cgh);
+}
+
+/**
+ * Insert a key/value pair, see #BLI_ghash_insert.
+ *
+ * \note Duplicates are not checked,
+ * the caller is expected to ensure elements are unique (use #BLI_concurrent_ghash_add otherwise).
+ */
+void BLI_concurrent_ghash_insert(ConcurrentGHash *cgh, void *key, void *val)
+{
+	ConcurrentGHashShard *shard = cghash_shard_lock(cgh, key);
+	BLI_ghash_insert(shard->gh, key, val);
+	cghash_shard_unlock(shard);
+}
+
+/**
+ * Insert a key/value pair, unless another thread added the key already.
+ *
+ * \return true if the key has been added.
+ */
+bool BLI_concurrent_ghash_add(ConcurrentGHash *cgh, void *key, void *val)
+{
+	ConcurrentGHashShard *shard = cghash_shard_lock(cgh, key);
+	void **val_p;
+	const bool haskey = BLI_ghash_ensure_p(shard->gh, key, &val_p);
+
+	if (!haskey) {
+		*val_p = val;
+	}
+	cghash_shard_unlock(shard);
+
+	return !haskey;
+}
+
+/**
+ * Lookup the value of \a key, adding \a val when it's not there yet.
+ * When several threads add the same key, they all get the value of the first one.
+ *
+ * \return the value of \a key in \a cgh.
+ */
+void *BLI_concurrent_ghash_lookup_or_add(ConcurrentGHash *cgh, void *key, void *val)
+{
+	ConcurrentGHashShard *shard = cghash_shard_lock(cgh, key);
+	void **val_p;
+
+	if (!BLI_ghash_ensure_p(shard->gh, key, &val_p)) {
+		*val_p = val;
+	}
+	else {
+		val = *val_p;
+	}
+	cghash_shard_unlock(shard);
+
+	return val;
+}
+
+/**
+ * Lookup the value of \a key, see #BLI_ghash_lookup.
+ */
+void *BLI_concurrent_ghash_lookup(ConcurrentGHash *cgh, const void *key)
+{
+	return BLI_concurrent_ghash_lookup_default(cgh, key, NULL);
+}
+
+/**
+ * A version of #BLI_concurrent_ghash_lookup which accepts a fallback argument.
+ */
+void *BLI_concurrent_ghash_lookup_default(ConcurrentGHash *cgh, const void *key, void *val_default)
+{
+	ConcurrentGHashShard *shard = cghash_shard_lock(cgh, key);
+	void *val = BLI_ghash_lookup_default(shard->gh, key, val_default);
+	cghash_shard_unlock(shard);
+
+	return val;
+}
+
+/**
+ * \return true if the \a key is in \a cgh.
+ */
+bool BLI_concurrent_ghash_haskey(ConcurrentGHash *cgh, const void *key)
+{
+	ConcurrentGHashShard *shard = cghash_shard_lock(cgh, key);
+	const bool haskey = BLI_ghash_haskey(shard->gh, key);
+	cghash_shard_unlock(shard);
+
+	return haskey;
+}
+
+/**
+ * Remove \a key from \a cgh, see #BLI_ghash_remove.
+ *
+ * \note The callbacks run with the shard locked.
+ */
+bool BLI_concurrent_ghash_remove(
+        ConcurrentGHash *cgh, const void *key, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp)
+{
+	ConcurrentGHashShard *shard = cghash_shard_lock(cgh, key);
+	const bool removed = BLI_ghash_remove(shard->gh, key, keyfreefp, valfreefp);
+	cghash_shard_unlock(shard);
+
+	return removed;
+}
+
+/**
+ * Remove \a key from \a cgh, returning the value or NULL if the key wasn't found.
+ */
+void *BLI_concurrent_ghash_popkey(ConcurrentGHash *cgh, const void *key, GHashKeyFreeFP keyfreefp)
+{
+	ConcurrentGHashShard *shard = cghash_shard_lock(cgh, key);
+	void *val = BLI_ghash_popkey(shard->gh, key, keyfreefp);
+	cghash_shard_unlock(shard);
+
+	return val;
+}
+
+/**
+ * \return size of the ConcurrentGHash,
+ * only a snapshot while other threads are modifying it.
+ */
+unsigned int BLI_concurrent_ghash_size(ConcurrentGHash *cgh)
+{
+	unsigned int size = 0;
+	int i;
+
+	for (i = 0; i < CGHASH_SHARD_NUM; i++) {
+		BLI_spin_lock(&cgh->shards[i].lock);
+		size += BLI_ghash_size(cgh->shards[i].gh);
+		BLI_spin_unlock(&cgh->shards[i].lock);
+	}
+
+	return size;
+}
+
+/**
+ * Call \a func for all key/value pairs, in no particular order.
+ *
+ * \note Not thread-safe, only use this once the threads are done with \a cgh.
+ */
+void BLI_concurrent_ghash_foreach(
+        ConcurrentGHash *cgh, void (*func)(void *key, void *val, void *userdata), void *userdata)
+{
+	int i;
+
+	for (i = 0; i < CGHASH_SHARD_NUM; i++) {
+		GHashIterator gh_iter;
+
+		GHASH_ITER (gh_iter, cgh->shards[i].gh) {
+			func(BLI_ghashIterator_getKey(&gh_iter), BLI_ghashIterator_getValue(&gh_iter), userdata);
+		}
+	}
+}
+
+/** \name Convenience ConcurrentGHash Creation Functions
+ * \{ */
+
+ConcurrentGHash *BLI_concurrent_ghash_ptr_new_ex(const char *info, const unsigned int nentries_reserve)
+{
+	return BLI_concurrent_ghash_new_ex(BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, info, nentries_reserve);
+}
+ConcurrentGHash *BLI_concurrent_ghash_ptr_new(const char *info)
+{
+	return BLI_concurrent_ghash_ptr_new_ex(info, 0);
+}
+
+ConcurrentGHash *BLI_concurrent_ghash_int_new_ex(const char *info, const unsigned int nentries_reserve)
+{
+	return BLI_concurrent_ghash_new_ex(BLI_ghashutil_inthash_p, BLI_ghashutil_intcmp, info, nentries_reserve);
+}
+ConcurrentGHash *BLI_concurrent_ghash_int_new(const char *info)
+{
+	return BLI_concurrent_ghash_int_new_ex(info, 0);
+}
+
+/** \} */
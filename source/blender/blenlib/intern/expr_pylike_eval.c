@@ -0,0 +1,989 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/blenlib/intern/expr_pylike_eval.c
+ *  \ingroup bli
+ *
+ * Evaluator for the subset of Python expressions which only works with floating point numbers,
+ * so that simple expressions (e.g. of drivers) don't need the Python interpreter and its global lock.
+ *
+ * The supported subset:
+ * - Numbers (decimal integer and floating point), True, False and the constants pi and e.
+ * - Parameters, given by name when parsing and by value when evaluating.
+ * - The operators + - * / // % ** (including unary + and -),
+ *   the comparisons == != < <= > >= (not chained), and, or, not and the 'a if cond else b' conditional.
+ * - The functions min, max, abs and a set of functions from the math module.
+ *
+ * Everything else fails to parse, so that the caller can fall back to Python.
+ * Results match Python, including its floor division and modulo semantics,
+ * errors Python would raise an exception for are returned as an error status.
+ *
+ * The expression is compiled to a list of stack machine operations when parsing,
+ * evaluation only reads the parsed expression so it can run from multiple threads at once.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <ctype.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_alloca.h"
+#include "BLI_math_base.h"
+
+#include "BLI_expr_pylike_eval.h"
+
+/* -------------------------------------------------------------------- */
+/* Internal Types */
+
+typedef enum eOpCode {
+	/* push a constant or a parameter */
+	OPCODE_CONST,
+	OPCODE_PARAMETER,
+	/* call a function with one or two arguments */
+	OPCODE_FUNC1,
+	OPCODE_FUNC2,
+	/* minimum or maximum of 'ival' arguments */
+	OPCODE_MIN,
+	OPCODE_MAX,
+	/* unary operators */
+	OPCODE_NEG,
+	OPCODE_NOT,
+	/* binary operators */
+	OPCODE_ADD,
+	OPCODE_SUB,
+	OPCODE_MUL,
+	OPCODE_DIV,
+	OPCODE_FLOORDIV,
+	OPCODE_MOD,
+	OPCODE_POW,
+	OPCODE_EQ,
+	OPCODE_NE,
+	OPCODE_LT,
+	OPCODE_LE,
+	OPCODE_GT,
+	OPCODE_GE,
+	/* jumps by 'jmp_offset' operations */
+	OPCODE_JMP,        /* always */
+	OPCODE_JMP_ELSE,   /* pops the condition, jumps if it's false */
+	OPCODE_JMP_OR,     /* jumps if the top is true, pops it otherwise */
+	OPCODE_JMP_AND,    /* jumps if the top is false, pops it otherwise */
+} eOpCode;
+
+typedef double (*UnaryOpFunc)(double);
+typedef double (*BinaryOpFunc)(double, double);
+
+typedef struct ExprOp {
+	eOpCode opcode;
+
+	int jmp_offset;
+
+	union {
+		int ival;
+		double dval;
+		UnaryOpFunc func1;
+		BinaryOpFunc func2;
+	} arg;
+} ExprOp;
+
+struct ExprPyLike_Parsed {
+	/* zero when the expression couldn't be parsed */
+	int ops_count;
+	/* enough stack space for evaluating all operations */
+	int max_stack;
+
+	ExprOp *ops;
+};
+
+/* -------------------------------------------------------------------- */
+/* Public API */
+
+/**
+ * Free a parsed expression.
+ */
+void BLI_expr_pylike_free(ExprPyLike_Parsed *expr)
+{
+	if (expr != NULL) {
+		if (expr->ops) {
+			MEM_freeN(expr->ops);
+		}
+		MEM_freeN(expr);
+	}
+}
+
+/**
+ * \return true if the expression was parsed successfully and can be evaluated.
+ */
+bool BLI_expr_pylike_is_valid(ExprPyLike_Parsed *expr)
+{
+	return expr != NULL && expr->ops_count > 0;
+}
+
+/* -------------------------------------------------------------------- */
+/* Stack Machine Evaluation */
+
+/**
+ * Evaluate a parsed expression with the parameter values in the order of the names given when parsing.
+ *
+ * \return #EXPR_PYLIKE_SUCCESS with the value in \a r_result, or the error status.
+ */
+eExprPyLike_EvalStatus BLI_expr_pylike_eval(
+        ExprPyLike_Parsed *expr, const double *param_values, int param_values_len, double *r_result)
+{
+	double *stack;
+	int sp = 0, pc;
+
+	*r_result = 0.0;
+
+	if (!BLI_expr_pylike_is_valid(expr)) {
+		return EXPR_PYLIKE_INVALID;
+	}
+
+	stack = BLI_array_alloca(stack, expr->max_stack);
+
+	for (pc = 0; pc >= 0 && pc < expr->ops_count; pc++) {
+		const ExprOp *op = &expr->ops[pc];
+
+		switch (op->opcode) {
+			case OPCODE_CONST:
+				stack[sp++] = op->arg.dval;
+				break;
+			case OPCODE_PARAMETER:
+				if (op->arg.ival >= param_values_len) {
+					return EXPR_PYLIKE_FATAL_ERROR;
+				}
+				stack[sp++] = param_values[op->arg.ival];
+				break;
+			case OPCODE_FUNC1:
+			{
+				const double arg = stack[sp - 1];
+				stack[sp - 1] = op->arg.func1(arg);
+				/* like Python's math module, treat results out of range of finite arguments as errors */
+				if (!isfinite(stack[sp - 1]) && isfinite(arg)) {
+					return EXPR_PYLIKE_MATH_ERROR;
+				}
+				break;
+			}
+			case OPCODE_FUNC2:
+			{
+				const double arg1 = stack[sp - 2], arg2 = stack[sp - 1];
+				stack[sp - 2] = op->arg.func2(arg1, arg2);
+				sp--;
+				if (!isfinite(stack[sp - 1]) && isfinite(arg1) && isfinite(arg2)) {
+					return EXPR_PYLIKE_MATH_ERROR;
+				}
+				break;
+			}
+			case OPCODE_MIN:
+			case OPCODE_MAX:
+			{
+				double val = stack[sp - op->arg.ival];
+				int i;
+				for (i = sp - op->arg.ival + 1; i < sp; i++) {
+					/* Python keeps the first of equal values, and compares NaN the same way */
+					if ((op->opcode == OPCODE_MIN) ? (stack[i] < val) : (stack[i] > val)) {
+						val = stack[i];
+					}
+				}
+				sp -= op->arg.ival - 1;
+				stack[sp - 1] = val;
+				break;
+			}
+			case OPCODE_NEG:
+				stack[sp - 1] = -stack[sp - 1];
+				break;
+			case OPCODE_NOT:
+				stack[sp - 1] = (stack[sp - 1] != 0.0) ? 0.0 : 1.0;
+				break;
+			case OPCODE_ADD:
+				stack[sp - 2] = stack[sp - 2] + stack[sp - 1];
+				sp--;
+				break;
+			case OPCODE_SUB:
+				stack[sp - 2] = stack[sp - 2] - stack[sp - 1];
+				sp--;
+				break;
+			case OPCODE_MUL:
+				stack[sp - 2] = stack[sp - 2] * stack[sp - 1];
+				sp--;
+				break;
+			case OPCODE_DIV:
+			case OPCODE_FLOORDIV:
+			case OPCODE_MOD:
+			{
+				const double a = stack[sp - 2], b = stack[sp - 1];
+				double mod, div;
+
+				if (b == 0.0) {
+					return EXPR_PYLIKE_DIV_BY_ZERO;
+				}
+
+				if (op->opcode == OPCODE_DIV) {
+					stack[sp - 2] = a / b;
+					sp--;
+					break;
+				}
+
+				/* same as float_divmod() in Python's floatobject.c */
+				mod = fmod(a, b);
+				div = (a - mod) / b;
+				if (mod != 0.0) {
+					if ((b < 0.0) != (mod < 0.0)) {
+						mod += b;
+						div -= 1.0;
+					}
+				}
+				else {
+					mod = copysign(0.0, b);
+				}
+
+				if (op->opcode == OPCODE_MOD) {
+					stack[sp - 2] = mod;
+				}
+				else if (div != 0.0) {
+					double floordiv = floor(div);
+					if (div - floordiv > 0.5) {
+						floordiv += 1.0;
+					}
+					stack[sp - 2] = floordiv;
+				}
+				else {
+					stack[sp - 2] = copysign(0.0, a / b);
+				}
+				sp--;
+				break;
+			}
+			case OPCODE_POW:
+			{
+				const double a = stack[sp - 2], b = stack[sp - 1];
+				if (a == 0.0 && b < 0.0) {
+					return EXPR_PYLIKE_DIV_BY_ZERO;
+				}
+				stack[sp - 2] = pow(a, b);
+				sp--;
+				/* overflow, and negative numbers to fractional powers (complex in Python) */
+				if (!isfinite(stack[sp - 1]) && isfinite(a) && isfinite(b)) {
+					return EXPR_PYLIKE_MATH_ERROR;
+				}
+				break;
+			}
+			case OPCODE_EQ:
+				stack[sp - 2] = (stack[sp - 2] == stack[sp - 1]) ? 1.0 : 0.0;
+				sp--;
+				break;
+			case OPCODE_NE:
+				stack[sp - 2] = (stack[sp - 2] != stack[sp - 1]) ? 1.0 : 0.0;
+				sp--;
+				break;
+			case OPCODE_LT:
+				stack[sp - 2] = (stack[sp - 2] < stack[sp - 1]) ? 1.0 : 0.0;
+				sp--;
+				break;
+			case OPCODE_LE:
+				stack[sp - 2] = (stack[sp - 2] <= stack[sp - 1]) ? 1.0 : 0.0;
+				sp--;
+				break;
+			case OPCODE_GT:
+				stack[sp - 2] = (stack[sp - 2] > stack[sp - 1]) ? 1.0 : 0.0;
+				sp--;
+				break;
+			case OPCODE_GE:
+				stack[sp - 2] = (stack[sp - 2] >= stack[sp - 1]) ? 1.0 : 0.0;
+				sp--;
+				break;
+			case OPCODE_JMP:
+				pc += op->jmp_offset - 1;
+				break;
+			case OPCODE_JMP_ELSE:
+				if (stack[--sp] == 0.0) {
+					pc += op->jmp_offset - 1;
+				}
+				break;
+			case OPCODE_JMP_OR:
+			case OPCODE_JMP_AND:
+				if ((stack[sp - 1] != 0.0) == (op->opcode == OPCODE_JMP_OR)) {
+					pc += op->jmp_offset - 1;
+				}
+				else {
+					sp--;
+				}
+				break;
+			default:
+				BLI_assert(0);
+				return EXPR_PYLIKE_FATAL_ERROR;
+		}
+	}
+
+	BLI_assert(sp == 1 && pc == expr->ops_count);
+
+	*r_result = stack[0];
+	return EXPR_PYLIKE_SUCCESS;
+}
+
+/* -------------------------------------------------------------------- */
+/* Built-in Operations */
+
+static double op_radians(double arg)
+{
+	return arg * M_PI / 180.0;
+}
+
+static double op_degrees(double arg)
+{
+	return arg * 180.0 / M_PI;
+}
+
+static double op_log2arg(double arg, double base)
+{
+	return log(arg) / log(base);
+}
+
+typedef struct BuiltinConstDef {
+	const char *name;
+	double value;
+} BuiltinConstDef;
+
+static const BuiltinConstDef builtin_consts[] = {
+	{"pi", M_PI},
+	{"e", M_E},
+	{NULL, 0.0}
+};
+
+typedef struct BuiltinOpDef {
+	const char *name;
+	/* functions with one or two arguments, or min and max with any number of at least two */
+	eOpCode op;
+	UnaryOpFunc func1;
+	BinaryOpFunc func2;
+} BuiltinOpDef;
+
+static const BuiltinOpDef builtin_ops[] = {
+	{"radians", OPCODE_FUNC1, op_radians, NULL},
+	{"degrees", OPCODE_FUNC1, op_degrees, NULL},
+	{"abs", OPCODE_FUNC1, fabs, NULL},
+	{"fabs", OPCODE_FUNC1, fabs, NULL},
+	{"floor", OPCODE_FUNC1, floor, NULL},
+	{"ceil", OPCODE_FUNC1, ceil, NULL},
+	{"trunc", OPCODE_FUNC1, trunc, NULL},
+	{"sin", OPCODE_FUNC1, sin, NULL},
+	{"cos", OPCODE_FUNC1, cos, NULL},
+	{"tan", OPCODE_FUNC1, tan, NULL},
+	{"asin", OPCODE_FUNC1, asin, NULL},
+	{"acos", OPCODE_FUNC1, acos, NULL},
+	{"atan", OPCODE_FUNC1, atan, NULL},
+	{"atan2", OPCODE_FUNC2, NULL, atan2},
+	{"exp", OPCODE_FUNC1, exp, NULL},
+	{"log", OPCODE_FUNC1, log, NULL},
+	{"log", OPCODE_FUNC2, NULL, op_log2arg},
+	{"log10", OPCODE_FUNC1, log10, NULL},
+	{"sqrt", OPCODE_FUNC1, sqrt, NULL},
+	{"pow", OPCODE_FUNC2, NULL, pow},
+	{"fmod", OPCODE_FUNC2, NULL, fmod},
+	{"hypot", OPCODE_FUNC2, NULL, hypot},
+	{"copysign", OPCODE_FUNC2, NULL, copysign},
+	{"min", OPCODE_MIN, NULL, NULL},
+	{"max", OPCODE_MAX, NULL, NULL},
+	{NULL, OPCODE_CONST, NULL, NULL}
+};
+
+/* -------------------------------------------------------------------- */
+/* Expression Parser State */
+
+enum {
+	TOKEN_END = 0,
+	/* single character operators use their character as token */
+	TOKEN_NUMBER = 256,
+	TOKEN_ID,
+	TOKEN_EQ,
+	TOKEN_NE,
+	TOKEN_LE,
+	TOKEN_GE,
+	TOKEN_FLOORDIV,
+	TOKEN_POW,
+	TOKEN_AND,
+	TOKEN_OR,
+	TOKEN_NOT,
+	TOKEN_IF,
+	TOKEN_ELSE,
+	TOKEN_ERROR,
+};
+
+typedef struct ExprParseState {
+	int param_names_len;
+	const char **param_names;
+
+	/* current token */
+	const char *cur;
+	int token;
+	char *tokenbuf;
+	double tokenval;
+
+	/* operation buffer */
+	int ops_count, max_ops;
+	ExprOp *ops;
+
+	/* stack space needed by the operations */
+	int stack_ptr, max_stack;
+} ExprParseState;
+
+/* add an operation, changing the stack by 'stack_delta' values */
+static ExprOp *parse_add_op(ExprParseState *state, eOpCode code, int stack_delta)
+{
+	ExprOp *op;
+
+	if (state->ops_count >= state->max_ops) {
+		state->max_ops *= 2;
+		state->ops = MEM_reallocN(state->ops, sizeof(*state->ops) * (size_t)state->max_ops);
+	}
+
+	op = &state->ops[state->ops_count++];
+	memset(op, 0, sizeof(*op));
+	op->opcode = code;
+
+	state->stack_ptr += stack_delta;
+	state->max_stack = max_ii(state->max_stack, state->stack_ptr);
+
+	return op;
+}
+
+/* add a jump, returning its index to set the target later with parse_set_jump */
+static int parse_add_jump(ExprParseState *state, eOpCode code)
+{
+	parse_add_op(state, code, (code == OPCODE_JMP_ELSE) ? -1 : 0);
+	return state->ops_count - 1;
+}
+
+/* make the jump go to the next operation added */
+static void parse_set_jump(ExprParseState *state, int jump)
+{
+	state->ops[jump].jmp_offset = state->ops_count - jump;
+}
+
+/* -------------------------------------------------------------------- */
+/* Tokenizer */
+
+static bool is_identifier_char(char ch)
+{
+	return isalnum((unsigned char)ch) || ch == '_';
+}
+
+static int parse_number_token(ExprParseState *state)
+{
+	const char *start = state->cur, *cur = state->cur;
+	bool is_float = false;
+	size_t len;
+
+	while (isdigit((unsigned char)*cur)) {
+		cur++;
+	}
+
+	if (*cur == '.') {
+		is_float = true;
+		cur++;
+		while (isdigit((unsigned char)*cur)) {
+			cur++;
+		}
+	}
+
+	if (ELEM(*cur, 'e', 'E')) {
+		is_float = true;
+		cur++;
+		if (ELEM(*cur, '+', '-')) {
+			cur++;
+		}
+		if (!isdigit((unsigned char)*cur)) {
+			return TOKEN_ERROR;
+		}
+		while (isdigit((unsigned char)*cur)) {
+			cur++;
+		}
+	}
+
+	/* hexadecimal, complex numbers and such are left to Python */
+	if (is_identifier_char(*cur) || *cur == '.') {
+		return TOKEN_ERROR;
+	}
+
+	len = (size_t)(cur - start);
+
+	/* Python doesn't allow leading zeros in (non-zero) integers */
+	if (!is_float && start[0] == '0' && strspn(start, "0") != len) {
+		return TOKEN_ERROR;
+	}
+
+	memcpy(state->tokenbuf, start, len);
+	state->tokenbuf[len] = '\0';
+	state->tokenval = strtod(state->tokenbuf, NULL);
+	state->cur = cur;
+
+	return TOKEN_NUMBER;
+}
+
+static bool parse_next_token(ExprParseState *state)
+{
+	static const struct { const char *name; int token; } keywords[] = {
+		{"and", TOKEN_AND}, {"or", TOKEN_OR}, {"not", TOKEN_NOT}, {"if", TOKEN_IF}, {"else", TOKEN_ELSE},
+		{NULL, TOKEN_END}
+	};
+	static const struct { const char str[3]; int token; } operators[] = {
+		{"==", TOKEN_EQ}, {"!=", TOKEN_NE}, {"<=", TOKEN_LE}, {">=", TOKEN_GE}, {"//", TOKEN_FLOORDIV},
+		{"**", TOKEN_POW},
+		{"+", '+'}, {"-", '-'}, {"*", '*'}, {"/", '/'}, {"%", '%'}, {"<", '<'}, {">", '>'},
+		{"(", '('}, {")", ')'}, {",", ','},
+		{"", TOKEN_END}
+	};
+	int i;
+
+	/* skip white space, newlines aren't allowed in Python expressions */
+	while (ELEM(*state->cur, ' ', '\t')) {
+		state->cur++;
+	}
+
+	if (*state->cur == '\0') {
+		state->token = TOKEN_END;
+		return true;
+	}
+
+	/* numbers */
+	if (isdigit((unsigned char)*state->cur) || (*state->cur == '.' && isdigit((unsigned char)state->cur[1]))) {
+		state->token = parse_number_token(state);
+		return state->token != TOKEN_ERROR;
+	}
+
+	/* identifiers and keywords */
+	if (isalpha((unsigned char)*state->cur) || *state->cur == '_') {
+		char *out = state->tokenbuf;
+
+		while (is_identifier_char(*state->cur)) {
+			*out++ = *state->cur++;
+		}
+		*out = '\0';
+
+		if (STREQ(state->tokenbuf, "True") || STREQ(state->tokenbuf, "False")) {
+			state->token = TOKEN_NUMBER;
+			state->tokenval = STREQ(state->tokenbuf, "True") ? 1.0 : 0.0;
+			return true;
+		}
+
+		state->token = TOKEN_ID;
+		for (i = 0; keywords[i].name; i++) {
+			if (STREQ(state->tokenbuf, keywords[i].name)) {
+				state->token = keywords[i].token;
+				break;
+			}
+		}
+		return true;
+	}
+
+	/* operators, two character ones first */
+	for (i = 0; operators[i].str[0]; i++) {
+		const size_t len = strlen(operators[i].str);
+		if (STREQLEN(state->cur, operators[i].str, len)) {
+			state->cur += len;
+			state->token = operators[i].token;
+			return true;
+		}
+	}
+
+	state->token = TOKEN_ERROR;
+	return false;
+}
+
+/* -------------------------------------------------------------------- */
+/* Recursive Descent Parser
+ *
+ * From the lowest to the highest priority like Python's grammar:
+ *
+ *   expr    := or_expr ['if' or_expr 'else' expr]
+ *   or_expr := and_expr ('or' and_expr)*
+ *   and_expr := not_expr ('and' not_expr)*
+ *   not_expr := 'not' not_expr | cmp_expr
+ *   cmp_expr := arith [cmpop arith]
+ *   arith := term (('+' | '-') term)*
+ *   term := unary (('*' | '/' | '//' | '%') unary)*
+ *   unary := ('+' | '-') unary | power
+ *   power := primary ['**' unary]
+ *   primary := number | name | name '(' expr (',' expr)* ')' | '(' expr ')'
+ */
+
+static bool parse_expr(ExprParseState *state);
+static bool parse_unary(ExprParseState *state);
+
+static bool parse_call(ExprParseState *state, const char *name)
+{
+	int i, args = 0;
+
+	/* calling a parameter is an error in Python */
+	for (i = 0; i < state->param_names_len; i++) {
+		if (state->param_names[i] && STREQ(name, state->param_names[i])) {
+			return false;
+		}
+	}
+
+	if (!parse_next_token(state)) {
+		return false;
+	}
+
+	if (state->token != ')') {
+		while (true) {
+			if (!parse_expr(state)) {
+				return false;
+			}
+			args++;
+
+			if (state->token == ')') {
+				break;
+			}
+			if (state->token != ',' || !parse_next_token(state)) {
+				return false;
+			}
+		}
+	}
+
+	for (i = 0; builtin_ops[i].name; i++) {
+		const BuiltinOpDef *def = &builtin_ops[i];
+
+		if (!STREQ(name, def->name)) {
+			continue;
+		}
+
+		if (ELEM(def->op, OPCODE_MIN, OPCODE_MAX)) {
+			if (args >= 2) {
+				parse_add_op(state, def->op, 1 - args)->arg.ival = args;
+				return parse_next_token(state);
+			}
+		}
+		else if (args == ((def->op == OPCODE_FUNC1) ? 1 : 2)) {
+			ExprOp *op = parse_add_op(state, def->op, 1 - args);
+
+			if (def->op == OPCODE_FUNC1) {
+				op->arg.func1 = def->func1;
+			}
+			else {
+				op->arg.func2 = def->func2;
+			}
+			return parse_next_token(state);
+		}
+	}
+
+	return false;
+}
+
+static bool parse_primary(ExprParseState *state)
+{
+	int i;
+
+	switch (state->token) {
+		case TOKEN_NUMBER:
+			parse_add_op(state, OPCODE_CONST, 1)->arg.dval = state->tokenval;
+			return parse_next_token(state);
+
+		case TOKEN_ID:
+		{
+			/* the name is overwritten by the next token */
+			const size_t name_len = strlen(state->tokenbuf) + 1;
+			char *name = BLI_array_alloca(name, name_len);
+
+			memcpy(name, state->tokenbuf, name_len);
+
+			if (!parse_next_token(state)) {
+				return false;
+			}
+
+			if (state->token == '(') {
+				return parse_call(state, name);
+			}
+
+			/* parameters override the built-in constants, like the locals of a Python expression */
+			for (i = 0; i < state->param_names_len; i++) {
+				if (state->param_names[i] && STREQ(name, state->param_names[i])) {
+					parse_add_op(state, OPCODE_PARAMETER, 1)->arg.ival = i;
+					return true;
+				}
+			}
+
+			for (i = 0; builtin_consts[i].name; i++) {
+				if (STREQ(name, builtin_consts[i].name)) {
+					parse_add_op(state, OPCODE_CONST, 1)->arg.dval = builtin_consts[i].value;
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		case '(':
+			return (parse_next_token(state) &&
+			        parse_expr(state) &&
+			        state->token == ')' &&
+			        parse_next_token(state));
+
+		default:
+			return false;
+	}
+}
+
+static bool parse_power(ExprParseState *state)
+{
+	if (!parse_primary(state)) {
+		return false;
+	}
+
+	if (state->token == TOKEN_POW) {
+		if (!parse_next_token(state) || !parse_unary(state)) {
+			return false;
+		}
+		parse_add_op(state, OPCODE_POW, -1);
+	}
+
+	return true;
+}
+
+static bool parse_unary(ExprParseState *state)
+{
+	if (ELEM(state->token, '+', '-')) {
+		const bool negate = (state->token == '-');
+
+		if (!parse_next_token(state) || !parse_unary(state)) {
+			return false;
+		}
+		if (negate) {
+			parse_add_op(state, OPCODE_NEG, 0);
+		}
+		return true;
+	}
+
+	return parse_power(state);
+}
+
+static bool parse_term(ExprParseState *state)
+{
+	if (!parse_unary(state)) {
+		return false;
+	}
+
+	while (ELEM(state->token, '*', '/', TOKEN_FLOORDIV, '%')) {
+		const int token = state->token;
+
+		if (!parse_next_token(state) || !parse_unary(state)) {
+			return false;
+		}
+		parse_add_op(state,
+		             (token == '*') ? OPCODE_MUL :
+		             (token == '/') ? OPCODE_DIV :
+		             (token == '%') ? OPCODE_MOD : OPCODE_FLOORDIV,
+		             -1);
+	}
+
+	return true;
+}
+
+static bool parse_arith(ExprParseState *state)
+{
+	if (!parse_term(state)) {
+		return false;
+	}
+
+	while (ELEM(state->token, '+', '-')) {
+		const int token = state->token;
+
+		if (!parse_next_token(state) || !parse_term(state)) {
+			return false;
+		}
+		parse_add_op(state, (token == '+') ? OPCODE_ADD : OPCODE_SUB, -1);
+	}
+
+	return true;
+}
+
+static bool parse_cmp(ExprParseState *state)
+{
+	static const struct { int token; eOpCode op; } cmp_ops[] = {
+		{TOKEN_EQ, OPCODE_EQ}, {TOKEN_NE, OPCODE_NE}, {'<', OPCODE_LT}, {TOKEN_LE, OPCODE_LE},
+		{'>', OPCODE_GT}, {TOKEN_GE, OPCODE_GE},
+		{TOKEN_END, OPCODE_CONST}
+	};
+	int i;
+
+	if (!parse_arith(state)) {
+		return false;
+	}
+
+	for (i = 0; cmp_ops[i].token != TOKEN_END; i++) {
+		if (state->token == cmp_ops[i].token) {
+			if (!parse_next_token(state) || !parse_arith(state)) {
+				return false;
+			}
+			parse_add_op(state, cmp_ops[i].op, -1);
+
+			/* chained comparisons are left to Python */
+			for (i = 0; cmp_ops[i].token != TOKEN_END; i++) {
+				if (state->token == cmp_ops[i].token) {
+					return false;
+				}
+			}
+			return true;
+		}
+	}
+
+	return true;
+}
+
+static bool parse_not(ExprParseState *state)
+{
+	if (state->token == TOKEN_NOT) {
+		if (!parse_next_token(state) || !parse_not(state)) {
+			return false;
+		}
+		parse_add_op(state, OPCODE_NOT, 0);
+		return true;
+	}
+
+	return parse_cmp(state);
+}
+
+static bool parse_and(ExprParseState *state)
+{
+	if (!parse_not(state)) {
+		return false;
+	}
+
+	while (state->token == TOKEN_AND) {
+		const int jump = parse_add_jump(state, OPCODE_JMP_AND);
+
+		/* the left value is popped when the right one is evaluated */
+		state->stack_ptr--;
+
+		if (!parse_next_token(state) || !parse_not(state)) {
+			return false;
+		}
+		parse_set_jump(state, jump);
+	}
+
+	return true;
+}
+
+static bool parse_or(ExprParseState *state)
+{
+	if (!parse_and(state)) {
+		return false;
+	}
+
+	while (state->token == TOKEN_OR) {
+		const int jump = parse_add_jump(state, OPCODE_JMP_OR);
+
+		state->stack_ptr--;
+
+		if (!parse_next_token(state) || !parse_and(state)) {
+			return false;
+		}
+		parse_set_jump(state, jump);
+	}
+
+	return true;
+}
+
+static bool parse_expr(ExprParseState *state)
+{
+	/* the true value is parsed before the condition, but it's only evaluated after it */
+	const int start = state->ops_count;
+	int value_count, jump_else, jump_end;
+	ExprOp *value_ops;
+
+	if (!parse_or(state)) {
+		return false;
+	}
+
+	if (state->token != TOKEN_IF) {
+		return true;
+	}
+
+	value_count = state->ops_count - start;
+
+	if (!parse_next_token(state) || !parse_or(state)) {
+		return false;
+	}
+
+	jump_else = parse_add_jump(state, OPCODE_JMP_ELSE);
+
+	/* move the value after the condition and its jump, the jump offsets are relative so they remain valid */
+	value_ops = BLI_array_alloca(value_ops, (size_t)value_count);
+	memcpy(value_ops, &state->ops[start], sizeof(*value_ops) * (size_t)value_count);
+	memmove(&state->ops[start], &state->ops[start + value_count],
+	        sizeof(*value_ops) * (size_t)(state->ops_count - start - value_count));
+	memcpy(&state->ops[state->ops_count - value_count], value_ops, sizeof(*value_ops) * (size_t)value_count);
+	jump_else -= value_count;
+
+	jump_end = parse_add_jump(state, OPCODE_JMP);
+	parse_set_jump(state, jump_else);
+
+	/* only one of the values is on the stack */
+	state->stack_ptr--;
+
+	if (state->token != TOKEN_ELSE || !parse_next_token(state) || !parse_expr(state)) {
+		return false;
+	}
+
+	parse_set_jump(state, jump_end);
+
+	return true;
+}
+
+/* -------------------------------------------------------------------- */
+/* Main Parsing Function */
+
+/**
+ * Parse a Python-like expression.
+ *
+ * \param param_names  Names of the parameters the expression can use, earlier names hide later ones.
+ * \return The parsed expression, which is never NULL,
+ * use #BLI_expr_pylike_is_valid to check if it's supported.
+ */
+ExprPyLike_Parsed *BLI_expr_pylike_parse(const char *expression, const char **param_names, int param_names_len)
+{
+	ExprParseState state = {0};
+	ExprPyLike_Parsed *expr = MEM_callocN(sizeof(*expr), __func__);
+
+	state.param_names_len = param_names_len;
+	state.param_names = param_names;
+
+	state.cur = expression;
+	state.tokenbuf = MEM_mallocN(strlen(expression) + 1, __func__);
+
+	state.max_ops = 16;
+	state.ops = MEM_mallocN(sizeof(*state.ops) * (size_t)state.max_ops, __func__);
+
+	if (parse_next_token(&state) && parse_expr(&state) && state.token == TOKEN_END) {
+		BLI_assert(state.stack_ptr == 1);
+
+		expr->ops_count = state.ops_count;
+		expr->max_stack = state.max_stack;
+		expr->ops = state.ops;
+	}
+	else {
+		MEM_freeN(state.ops);
+	}
+
+	MEM_freeN(state.tokenbuf);
+
+	return expr;
+}
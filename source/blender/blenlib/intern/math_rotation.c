@@ -30,6 +30,10 @@
 #include <assert.h>
 #include "BLI_math.h"
 
+#ifdef __SSE__
+#  include <xmmintrin.h>
+#endif
+
 #include "BLI_strict_flags.h"
 
 /******************************** Quaternions ********************************/
@@ -1825,6 +1829,32 @@ void add_weighted_dq_dq(DualQuat *dqsum, const DualQuat *dq, float weight)
 		weight = -weight;
 	}
 
+#ifdef __SSE__
+	{
+		/* this runs for every bone influencing every vertex when skinning,
+		 * the quaternions and the columns of the scale matrix fit a register each */
+		__m128 weight_r = _mm_set1_ps(weight);
+
+		/* interpolate rotation and translation */
+		_mm_storeu_ps(dqsum->quat, _mm_add_ps(_mm_loadu_ps(dqsum->quat), _mm_mul_ps(_mm_loadu_ps(dq->quat), weight_r)));
+		_mm_storeu_ps(dqsum->trans, _mm_add_ps(_mm_loadu_ps(dqsum->trans), _mm_mul_ps(_mm_loadu_ps(dq->trans), weight_r)));
+
+		/* interpolate scale - but only if needed */
+		if (dq->scale_weight) {
+			int i;
+
+			if (flipped) /* we don't want negative weights for scaling */
+				weight = -weight;
+
+			weight_r = _mm_set1_ps(weight);
+			for (i = 0; i < 4; i++) {
+				_mm_storeu_ps(dqsum->scale[i],
+				              _mm_add_ps(_mm_loadu_ps(dqsum->scale[i]), _mm_mul_ps(_mm_loadu_ps(dq->scale[i]), weight_r)));
+			}
+			dqsum->scale_weight += weight;
+		}
+	}
+#else
 	/* interpolate rotation and translation */
 	dqsum->quat[0] += weight * dq->quat[0];
 	dqsum->quat[1] += weight * dq->quat[1];
@@ -1848,6 +1878,7 @@ void add_weighted_dq_dq(DualQuat *dqsum, const DualQuat *dq, float weight)
 		add_m4_m4m4(dqsum->scale, dqsum->scale, wmat);
 		dqsum->scale_weight += weight;
 	}
+#endif
 }
 
 void normalize_dq(DualQuat *dq, float totweight)
@@ -32,6 +32,10 @@
 
 #include <math.h>
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 #include "BLI_noise.h"
 
 /* local */
@@ -314,6 +318,104 @@ static float newPerlinU(float x, float y, float z)
 }
 
 
+#ifdef __SSE2__
+/* SSE2 versions of the improved perlin functions above, evaluating 4 points at once.
+ * Operations are done in the same order so results match the scalar version. */
+
+static __m128 lerp_v4(__m128 t, __m128 a, __m128 b)
+{
+	return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+}
+
+static __m128 npfade_v4(__m128 t)
+{
+	const __m128 t3 = _mm_mul_ps(_mm_mul_ps(t, t), t);
+	return _mm_mul_ps(t3, _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)),
+	                                                            _mm_set1_ps(15.0f))),
+	                                 _mm_set1_ps(10.0f)));
+}
+
+static __m128 select_v4(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static __m128 grad_v4(__m128i hash_val, __m128 x, __m128 y, __m128 z)
+{
+	const __m128i h = _mm_and_si128(hash_val, _mm_set1_epi32(15));
+	const __m128 h_lt_8 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(8)));
+	const __m128 h_lt_4 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4)));
+	const __m128 h_12_14 = _mm_castsi128_ps(_mm_or_si128(_mm_cmpeq_epi32(h, _mm_set1_epi32(12)),
+	                                                     _mm_cmpeq_epi32(h, _mm_set1_epi32(14))));
+	/* move the low bits into the sign bit to negate */
+	const __m128 u_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), 31));
+	const __m128 v_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), 30));
+	const __m128 u = select_v4(h_lt_8, x, y);
+	const __m128 v = select_v4(h_lt_4, y, select_v4(h_12_14, x, z));
+	return _mm_add_ps(_mm_xor_ps(u, u_sign), _mm_xor_ps(v, v_sign));
+}
+
+static __m128 floor_v4(__m128 x)
+{
+	/* floats beyond 2^23 are integers already and may not fit in an int */
+	const __m128 is_small = _mm_cmplt_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), x), _mm_set1_ps(8388608.0f));
+	const __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+	return select_v4(is_small, _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x), _mm_set1_ps(1.0f))), x);
+}
+
+static __m128 newPerlin_v4(__m128 x, __m128 y, __m128 z)
+{
+	const __m128 one = _mm_set1_ps(1.0f);
+	int X[4], Y[4], Z[4];
+	int AA[4], AB[4], BA[4], BB[4];
+	__m128 u = floor_v4(x), v = floor_v4(y), w = floor_v4(z);
+	__m128 x1, y1, z1;
+	int i;
+
+	_mm_storeu_si128((__m128i *)X, _mm_cvttps_epi32(u));
+	_mm_storeu_si128((__m128i *)Y, _mm_cvttps_epi32(v));
+	_mm_storeu_si128((__m128i *)Z, _mm_cvttps_epi32(w));
+
+	/* hashing the cube corners needs table lookups, do it per lane */
+	for (i = 0; i < 4; i++) {
+		const int A = hash[(X[i] & 255)    ] + (Y[i] & 255);
+		const int B = hash[(X[i] & 255) + 1] + (Y[i] & 255);
+		AA[i] = hash[A] + (Z[i] & 255);  AB[i] = hash[A + 1] + (Z[i] & 255);
+		BA[i] = hash[B] + (Z[i] & 255);  BB[i] = hash[B + 1] + (Z[i] & 255);
+	}
+
+	x = _mm_sub_ps(x, u);
+	y = _mm_sub_ps(y, v);
+	z = _mm_sub_ps(z, w);
+	x1 = _mm_sub_ps(x, one);
+	y1 = _mm_sub_ps(y, one);
+	z1 = _mm_sub_ps(z, one);
+	u = npfade_v4(x);
+	v = npfade_v4(y);
+	w = npfade_v4(z);
+
+#define HASH_V4(arr, ofs) \
+	_mm_set_epi32(hash[arr[3] + ofs], hash[arr[2] + ofs], hash[arr[1] + ofs], hash[arr[0] + ofs])
+
+	return lerp_v4(w, lerp_v4(v, lerp_v4(u, grad_v4(HASH_V4(AA, 0), x,  y,  z),
+	                                        grad_v4(HASH_V4(BA, 0), x1, y,  z)),
+	                             lerp_v4(u, grad_v4(HASH_V4(AB, 0), x,  y1, z),
+	                                        grad_v4(HASH_V4(BB, 0), x1, y1, z))),
+	                  lerp_v4(v, lerp_v4(u, grad_v4(HASH_V4(AA, 1), x,  y,  z1),
+	                                        grad_v4(HASH_V4(BA, 1), x1, y,  z1)),
+	                             lerp_v4(u, grad_v4(HASH_V4(AB, 1), x,  y1, z1),
+	                                        grad_v4(HASH_V4(BB, 1), x1, y1, z1))));
+
+#undef HASH_V4
+}
+
+static __m128 newPerlinU_v4(__m128 x, __m128 y, __m128 z)
+{
+	const __m128 half = _mm_set1_ps(0.5f);
+	return _mm_add_ps(half, _mm_mul_ps(half, newPerlin_v4(x, y, z)));
+}
+#endif  /* __SSE2__ */
+
 /**************************/
 /* END OF IMPROVED PERLIN */
 /**************************/
@@ -1425,50 +1527,73 @@ void cellNoiseV(float x, float y, float z, float ca[3])
 /* end cellnoise */
 /*****************/
 
-/* newnoise: generic noise function for use with different noisebases */
-float BLI_gNoise(float noisesize, float x, float y, float z, int hard, int noisebasis)
+typedef float (*NoiseFunc)(float x, float y, float z);
+
+/* newnoise: unsigned noise basis used by BLI_gNoise()/BLI_gTurbulence(),
+ * r_ofs is added to the coordinates */
+static NoiseFunc noise_basis_unsigned_get(int noisebasis, float *r_ofs)
 {
-	float (*noisefunc)(float, float, float);
+	*r_ofs = 0.0f;
 
 	switch (noisebasis) {
 		case 1:
-			noisefunc = orgPerlinNoiseU;
-			break;
+			return orgPerlinNoiseU;
 		case 2:
-			noisefunc = newPerlinU;
-			break;
+			return newPerlinU;
 		case 3:
-			noisefunc = voronoi_F1;
-			break;
+			return voronoi_F1;
 		case 4:
-			noisefunc = voronoi_F2;
-			break;
+			return voronoi_F2;
 		case 5:
-			noisefunc = voronoi_F3;
-			break;
+			return voronoi_F3;
 		case 6:
-			noisefunc = voronoi_F4;
-			break;
+			return voronoi_F4;
 		case 7:
-			noisefunc = voronoi_F1F2;
-			break;
+			return voronoi_F1F2;
 		case 8:
-			noisefunc = voronoi_Cr;
-			break;
+			return voronoi_Cr;
 		case 14:
-			noisefunc = cellNoiseU;
-			break;
+			return cellNoiseU;
 		case 0:
 		default:
-		{
-			noisefunc = orgBlenderNoise;
 			/* add one to make return value same as BLI_hnoise */
-			x += 1;
-			y += 1;
-			z += 1;
-			break;
-		}
+			*r_ofs = 1.0f;
+			return orgBlenderNoise;
 	}
+}
+
+static float gnoise_scaled(NoiseFunc noisefunc, float x, float y, float z, int hard)
+{
+	if (hard) return fabsf(2.0f * noisefunc(x, y, z) - 1.0f);
+	return noisefunc(x, y, z);
+}
+
+static float gturbulence_scaled(NoiseFunc noisefunc, float x, float y, float z, int oct, int hard)
+{
+	float sum, t, amp = 1, fscale = 1;
+	int i;
+
+	sum = 0;
+	for (i = 0; i <= oct; i++, amp *= 0.5f, fscale *= 2.0f) {
+		t = noisefunc(fscale * x, fscale * y, fscale * z);
+		if (hard) t = fabsf(2.0f * t - 1.0f);
+		sum += t * amp;
+	}
+
+	sum *= ((float)(1 << oct) / (float)((1 << (oct + 1)) - 1));
+
+	return sum;
+}
+
+/* newnoise: generic noise function for use with different noisebases */
+float BLI_gNoise(float noisesize, float x, float y, float z, int hard, int noisebasis)
+{
+	float ofs;
+	NoiseFunc noisefunc = noise_basis_unsigned_get(noisebasis, &ofs);
+
+	x += ofs;
+	y += ofs;
+	z += ofs;
 
 	if (noisesize != 0.0f) {
 		noisesize = 1.0f / noisesize;
@@ -1476,54 +1601,19 @@ float BLI_gNoise(float noisesize, float x, float y, float z, int hard, int noise
 		y *= noisesize;
 		z *= noisesize;
 	}
-	
-	if (hard) return fabsf(2.0f * noisefunc(x, y, z) - 1.0f);
-	return noisefunc(x, y, z);
+
+	return gnoise_scaled(noisefunc, x, y, z, hard);
 }
 
 /* newnoise: generic turbulence function for use with different noisebasis */
 float BLI_gTurbulence(float noisesize, float x, float y, float z, int oct, int hard, int noisebasis)
 {
-	float (*noisefunc)(float, float, float);
-	float sum, t, amp = 1, fscale = 1;
-	int i;
-	
-	switch (noisebasis) {
-		case 1:
-			noisefunc = orgPerlinNoiseU;
-			break;
-		case 2:
-			noisefunc = newPerlinU;
-			break;
-		case 3:
-			noisefunc = voronoi_F1;
-			break;
-		case 4:
-			noisefunc = voronoi_F2;
-			break;
-		case 5:
-			noisefunc = voronoi_F3;
-			break;
-		case 6:
-			noisefunc = voronoi_F4;
-			break;
-		case 7:
-			noisefunc = voronoi_F1F2;
-			break;
-		case 8:
-			noisefunc = voronoi_Cr;
-			break;
-		case 14:
-			noisefunc = cellNoiseU;
-			break;
-		case 0:
-		default:
-			noisefunc = orgBlenderNoise;
-			x += 1;
-			y += 1;
-			z += 1;
-			break;
-	}
+	float ofs;
+	NoiseFunc noisefunc = noise_basis_unsigned_get(noisebasis, &ofs);
+
+	x += ofs;
+	y += ofs;
+	z += ofs;
 
 	if (noisesize != 0.0f) {
 		noisesize = 1.0f / noisesize;
@@ -1532,17 +1622,126 @@ float BLI_gTurbulence(float noisesize, float x, float y, float z, int oct, int h
 		z *= noisesize;
 	}
 
-	sum = 0;
-	for (i = 0; i <= oct; i++, amp *= 0.5f, fscale *= 2.0f) {
-		t = noisefunc(fscale * x, fscale * y, fscale * z);
-		if (hard) t = fabsf(2.0f * t - 1.0f);
-		sum += t * amp;
+	return gturbulence_scaled(noisefunc, x, y, z, oct, hard);
+}
+
+#ifdef __SSE2__
+/* load up to 4 points as offset and scaled coordinate lanes, padding with the last point */
+static void noise_load_v4(const float (*co)[3], int co_len, float ofs, float scale,
+                          __m128 *r_x, __m128 *r_y, __m128 *r_z)
+{
+	float lanes[3][4];
+	int i, j;
+
+	for (i = 0; i < 4; i++) {
+		const float *p = co[(i < co_len) ? i : co_len - 1];
+		for (j = 0; j < 3; j++) {
+			lanes[j][i] = p[j] + ofs;
+		}
 	}
-	
-	sum *= ((float)(1 << oct) / (float)((1 << (oct + 1)) - 1));
 
-	return sum;
+	*r_x = _mm_mul_ps(_mm_loadu_ps(lanes[0]), _mm_set1_ps(scale));
+	*r_y = _mm_mul_ps(_mm_loadu_ps(lanes[1]), _mm_set1_ps(scale));
+	*r_z = _mm_mul_ps(_mm_loadu_ps(lanes[2]), _mm_set1_ps(scale));
+}
+
+static __m128 fabs_v4(__m128 a)
+{
+	return _mm_andnot_ps(_mm_set1_ps(-0.0f), a);
+}
+
+static void noise_store_v4(__m128 values, int co_len, float *r_values)
+{
+	float lanes[4];
+	int i;
+
+	_mm_storeu_ps(lanes, values);
+	for (i = 0; i < 4 && i < co_len; i++) {
+		r_values[i] = lanes[i];
+	}
+}
+#endif  /* __SSE2__ */
+
+/**
+ * Batched #BLI_gNoise, evaluating \a co_len points into \a r_values.
+ * The noise basis is only resolved once, improved perlin is evaluated 4 points at a time with SSE2.
+ */
+void BLI_gNoise_array(float noisesize, const float (*co)[3], const int co_len, int hard, int noisebasis,
+                      float *r_values)
+{
+	float ofs;
+	NoiseFunc noisefunc = noise_basis_unsigned_get(noisebasis, &ofs);
+	const float scale = (noisesize != 0.0f) ? 1.0f / noisesize : 1.0f;
+	int i;
+
+#ifdef __SSE2__
+	if (noisefunc == newPerlinU) {
+		for (i = 0; i < co_len; i += 4) {
+			__m128 x, y, z, t;
+
+			noise_load_v4(&co[i], co_len - i, ofs, scale, &x, &y, &z);
+			t = newPerlinU_v4(x, y, z);
+			if (hard) {
+				t = fabs_v4(_mm_sub_ps(_mm_mul_ps(_mm_set1_ps(2.0f), t), _mm_set1_ps(1.0f)));
+			}
+			noise_store_v4(t, co_len - i, &r_values[i]);
+		}
+		return;
+	}
+#endif
+
+	for (i = 0; i < co_len; i++) {
+		r_values[i] = gnoise_scaled(noisefunc,
+		                            (co[i][0] + ofs) * scale, (co[i][1] + ofs) * scale, (co[i][2] + ofs) * scale,
+		                            hard);
+	}
+}
+
+/**
+ * Batched #BLI_gTurbulence, evaluating \a co_len points into \a r_values.
+ * The noise basis is only resolved once, improved perlin is evaluated 4 points at a time with SSE2.
+ */
+void BLI_gTurbulence_array(float noisesize, const float (*co)[3], const int co_len, int oct, int hard, int noisebasis,
+                           float *r_values)
+{
+	float ofs;
+	NoiseFunc noisefunc = noise_basis_unsigned_get(noisebasis, &ofs);
+	const float scale = (noisesize != 0.0f) ? 1.0f / noisesize : 1.0f;
+	int i;
+
+#ifdef __SSE2__
+	if (noisefunc == newPerlinU) {
+		const __m128 norm = _mm_set1_ps((float)(1 << oct) / (float)((1 << (oct + 1)) - 1));
+
+		for (i = 0; i < co_len; i += 4) {
+			__m128 x, y, z, sum = _mm_setzero_ps();
+			float amp = 1, fscale = 1;
+			int j;
 
+			noise_load_v4(&co[i], co_len - i, ofs, scale, &x, &y, &z);
+
+			for (j = 0; j <= oct; j++, amp *= 0.5f, fscale *= 2.0f) {
+				const __m128 fscale_v4 = _mm_set1_ps(fscale);
+				__m128 t = newPerlinU_v4(_mm_mul_ps(fscale_v4, x),
+				                         _mm_mul_ps(fscale_v4, y),
+				                         _mm_mul_ps(fscale_v4, z));
+				if (hard) {
+					t = fabs_v4(_mm_sub_ps(_mm_mul_ps(_mm_set1_ps(2.0f), t), _mm_set1_ps(1.0f)));
+				}
+				sum = _mm_add_ps(sum, _mm_mul_ps(t, _mm_set1_ps(amp)));
+			}
+
+			noise_store_v4(_mm_mul_ps(sum, norm), co_len - i, &r_values[i]);
+		}
+		return;
+	}
+#endif
+
+	for (i = 0; i < co_len; i++) {
+		r_values[i] = gturbulence_scaled(noisefunc,
+		                                 (co[i][0] + ofs) * scale, (co[i][1] + ofs) * scale, (co[i][2] + ofs) * scale,
+		                                 oct, hard);
+	}
 }
 
 
@@ -0,0 +1,576 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/blenlib/intern/ohash.c
+ *  \ingroup bli
+ *
+ * A (pointer -> pointer) open addressing hash table, for keys which are pointers
+ * or integers stored in pointers (see #SET_INT_IN_POINTER).
+ *
+ * Unlike #GHash, keys can only be compared by value, there are no hash and compare callbacks,
+ * and entries are stored in the buckets array itself instead of being allocated and chained.
+ * Lookups walk over consecutive buckets, which is much more cache friendly for big tables.
+ *
+ * Keys are hashed by a multiplication, taking the high bits for a power of two number of buckets.
+ * Hashes which keep consecutive keys (indices, items of an array) in consecutive buckets
+ * would be faster to look up, but form long series of used buckets with linear probing,
+ * which makes insertion very slow.
+ *
+ * Colliding keys use linear probing with 'Robin Hood' hashing:
+ * an inserted entry takes the place of entries which are closer to their own bucket,
+ * which keeps the probe lengths short, and lets lookups of missing keys stop early.
+ * Removal shifts the following entries back, so there are no tombstones.
+ *
+ * #OHashEntry.dist
+ * - ``0`` means the bucket is empty.
+ * - otherwise it's the distance to the bucket of the key, plus one.
+ *
+ * \note Pointers returned by #BLI_ohash_lookup_p and #BLI_ohash_ensure_p
+ * are only valid until the table is modified again.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_sys_types.h"  /* for intptr_t support */
+#include "BLI_utildefines.h"
+
+#include "BLI_ohash.h"
+#include "BLI_strict_flags.h"
+
+#define OHASH_BUCKET_BIT_MIN 3
+#define OHASH_BUCKET_BIT_MAX 30  /* About 1G of buckets... */
+
+/**
+ * \note Robin Hood hashing copes well with much higher loads,
+ * but a quarter of free buckets keeps lookups of missing keys quick.
+ */
+#define OHASH_LIMIT_GROW(_nbkt)   (((_nbkt) * 3) / 4)
+
+/***/
+
+/* the first members must match _oh_Entry in the header */
+typedef struct OHashEntry {
+	void *key;
+	void *val;
+	unsigned int dist;
+} OHashEntry;
+
+struct OHash {
+	OHashEntry *buckets;
+	unsigned int nbuckets;
+	unsigned int limit_grow;
+	unsigned int bucket_bit;
+	unsigned int nentries;
+};
+
+/* -------------------------------------------------------------------- */
+/* OHash API */
+
+/** \name Internal Utility API
+ * \{ */
+
+/**
+ * Fibonacci hashing, the multiplication spreads consecutive integers and aligned pointers
+ * over the high bits, which pick the bucket.
+ *
+ * Doubling the number of buckets keeps the order of the keys, so resizing writes the new buckets in order.
+ */
+BLI_INLINE unsigned int ohash_bucket_index(const OHash *oh, const void *key)
+{
+	const uint64_t hash = (uint64_t)(uintptr_t)key * (uint64_t)0x9E3779B97F4A7C15;
+	return (unsigned int)(hash >> (64 - oh->bucket_bit));
+}
+
+BLI_INLINE unsigned int ohash_bucket_next(const OHash *oh, const unsigned int bucket_index)
+{
+	return (bucket_index + 1) & (oh->nbuckets - 1);
+}
+
+static OHashEntry *ohash_buckets_alloc(const unsigned int nbuckets)
+{
+	return MEM_callocN(sizeof(OHashEntry) * nbuckets, __func__);
+}
+
+/**
+ * Insert a key which is not in the table yet, without growing it.
+ * \return the entry with the new key.
+ */
+static OHashEntry *ohash_insert_entry(OHash *oh, void *key, void *val)
+{
+	OHashEntry entry = {key, val, 1};
+	OHashEntry *entry_key = NULL;
+	unsigned int bucket_index = ohash_bucket_index(oh, key);
+
+	for (;; bucket_index = ohash_bucket_next(oh, bucket_index), entry.dist++) {
+		OHashEntry *e = &oh->buckets[bucket_index];
+
+		if (e->dist == 0) {
+			*e = entry;
+			return entry_key ? entry_key : e;
+		}
+		else if (e->dist < entry.dist) {
+			/* take the place of an entry closer to its bucket, and move on inserting that one */
+			SWAP(OHashEntry, *e, entry);
+			if (entry_key == NULL) {
+				entry_key = e;
+			}
+		}
+	}
+}
+
+static void ohash_buckets_resize(OHash *oh, const unsigned int bucket_bit)
+{
+	OHashEntry *buckets_old = oh->buckets;
+	const unsigned int nbuckets_old = oh->buckets ? oh->nbuckets : 0;
+	const unsigned int nbuckets_new = 1u << bucket_bit;
+	unsigned int i;
+
+	oh->buckets = ohash_buckets_alloc(nbuckets_new);
+	oh->nbuckets = nbuckets_new;
+	oh->bucket_bit = bucket_bit;
+	oh->limit_grow = OHASH_LIMIT_GROW(nbuckets_new);
+
+	if (buckets_old) {
+		for (i = 0; i < nbuckets_old; i++) {
+			if (buckets_old[i].dist != 0) {
+				ohash_insert_entry(oh, buckets_old[i].key, buckets_old[i].val);
+			}
+		}
+		MEM_freeN(buckets_old);
+	}
+}
+
+/**
+ * Smallest number of bucket bits which can hold \a nentries.
+ */
+static unsigned int ohash_bucket_bit_for_size(const unsigned int nentries)
+{
+	unsigned int bucket_bit = OHASH_BUCKET_BIT_MIN;
+
+	while ((bucket_bit < OHASH_BUCKET_BIT_MAX) && (nentries > OHASH_LIMIT_GROW(1u << bucket_bit))) {
+		bucket_bit++;
+	}
+	return bucket_bit;
+}
+
+/**
+ * Grow the table so \a nentries fit in it, never shrinks.
+ */
+BLI_INLINE void ohash_buckets_expand(OHash *oh, const unsigned int nentries)
+{
+	if (UNLIKELY(nentries > oh->limit_grow)) {
+		ohash_buckets_resize(oh, ohash_bucket_bit_for_size(nentries));
+	}
+}
+
+BLI_INLINE OHashEntry *ohash_lookup_entry(OHash *oh, const void *key)
+{
+	unsigned int bucket_index = ohash_bucket_index(oh, key);
+	unsigned int dist;
+
+	/* an entry closer to its bucket than we are to ours means the key can't be further */
+	for (dist = 1; oh->buckets[bucket_index].dist >= dist; dist++) {
+		OHashEntry *e = &oh->buckets[bucket_index];
+		if (e->key == key) {
+			return e;
+		}
+		bucket_index = ohash_bucket_next(oh, bucket_index);
+	}
+	return NULL;
+}
+
+/**
+ * Move the entries following \a e back by one bucket, until one is in its own bucket (or empty).
+ */
+static void ohash_remove_entry(OHash *oh, OHashEntry *e)
+{
+	unsigned int bucket_index = (unsigned int)(e - oh->buckets);
+	unsigned int bucket_index_next = ohash_bucket_next(oh, bucket_index);
+
+	while (oh->buckets[bucket_index_next].dist > 1) {
+		oh->buckets[bucket_index] = oh->buckets[bucket_index_next];
+		oh->buckets[bucket_index].dist--;
+		bucket_index = bucket_index_next;
+		bucket_index_next = ohash_bucket_next(oh, bucket_index);
+	}
+	oh->buckets[bucket_index].dist = 0;
+
+	oh->nentries--;
+}
+
+static void ohash_free_values(OHash *oh, OHashValFreeFP valfreefp)
+{
+	unsigned int i;
+
+	for (i = 0; i < oh->nbuckets; i++) {
+		if (oh->buckets[i].dist != 0) {
+			valfreefp(oh->buckets[i].val);
+		}
+	}
+}
+
+/** \} */
+
+
+/** \name Public API
+ * \{ */
+
+/**
+ * Creates a new, empty OHash.
+ * Keys are pointers, or integers stored in pointers (see #SET_INT_IN_POINTER).
+ *
+ * \param info A string identifier for debugging, used for the memory allocation.
+ * \param nentries_reserve  Optionally reserve the number of members that the hash will hold.
+ * Use this to avoid resizing buckets if the size is known or can be closely approximated.
+ * \return  An empty OHash.
+ */
+OHash *BLI_ohash_new_ex(const char *info,
+                        const unsigned int nentries_reserve)
+{
+	OHash *oh = MEM_mallocN(sizeof(*oh), info);
+
+	oh->buckets = NULL;
+	oh->nentries = 0;
+	ohash_buckets_resize(oh, ohash_bucket_bit_for_size(nentries_reserve));
+
+	return oh;
+}
+
+/**
+ * Wraps #BLI_ohash_new_ex with zero entries reserved.
+ */
+OHash *BLI_ohash_new(const char *info)
+{
+	return BLI_ohash_new_ex(info, 0);
+}
+
+/**
+ * Reserve given amount of entries (resize \a oh accordingly if needed).
+ */
+void BLI_ohash_reserve(OHash *oh, const unsigned int nentries_reserve)
+{
+	ohash_buckets_expand(oh, nentries_reserve);
+}
+
+/**
+ * \return size of the OHash.
+ */
+unsigned int BLI_ohash_size(OHash *oh)
+{
+	return oh->nentries;
+}
+
+/**
+ * Insert a key/value pair into the \a oh.
+ *
+ * \note Duplicates are not checked,
+ * the caller is expected to ensure elements are unique.
+ */
+void BLI_ohash_insert(OHash *oh, void *key, void *val)
+{
+	BLI_assert(ohash_lookup_entry(oh, key) == NULL);
+
+	ohash_buckets_expand(oh, oh->nentries + 1);
+	ohash_insert_entry(oh, key, val);
+	oh->nentries++;
+}
+
+/**
+ * Inserts a new value to a key that may already be in ohash.
+ *
+ * Avoids #BLI_ohash_remove, #BLI_ohash_insert calls (double lookups)
+ *
+ * \returns true if a new key has been added.
+ */
+bool BLI_ohash_reinsert(OHash *oh, void *key, void *val, OHashValFreeFP valfreefp)
+{
+	OHashEntry *e = ohash_lookup_entry(oh, key);
+
+	if (e) {
+		if (valfreefp) {
+			valfreefp(e->val);
+		}
+		e->val = val;
+		return false;
+	}
+	else {
+		BLI_ohash_insert(oh, key, val);
+		return true;
+	}
+}
+
+/**
+ * Lookup the value of \a key in \a oh.
+ *
+ * \note When NULL is a valid value, use #BLI_ohash_lookup_p to differentiate a missing key
+ * from a key with a NULL value. (Avoids calling #BLI_ohash_haskey before #BLI_ohash_lookup)
+ */
+void *BLI_ohash_lookup(OHash *oh, const void *key)
+{
+	OHashEntry *e = ohash_lookup_entry(oh, key);
+	return e ? e->val : NULL;
+}
+
+/**
+ * A version of #BLI_ohash_lookup which accepts a fallback argument.
+ */
+void *BLI_ohash_lookup_default(OHash *oh, const void *key, void *val_default)
+{
+	OHashEntry *e = ohash_lookup_entry(oh, key);
+	return e ? e->val : val_default;
+}
+
+/**
+ * Lookup a pointer to the value of \a key in \a oh.
+ *
+ * \returns the pointer to value for \a key or NULL.
+ *
+ * \note This has 2 main benefits over #BLI_ohash_lookup.
+ * - A NULL return always means that \a key isn't in \a oh.
+ * - The value can be modified in-place without further function calls (faster).
+ */
+void **BLI_ohash_lookup_p(OHash *oh, const void *key)
+{
+	OHashEntry *e = ohash_lookup_entry(oh, key);
+	return e ? &e->val : NULL;
+}
+
+/**
+ * Ensure \a key is exists in \a oh.
+ *
+ * This handles the common situation where the caller needs ensure a key is added to \a oh,
+ * constructing a new value in the case the key isn't found.
+ * Otherwise use the existing value.
+ *
+ * Such situations typically incur multiple lookups, however this function
+ * avoids them by ensuring the key is added,
+ * returning a pointer to the value so it can be used or initialized by the caller.
+ *
+ * \returns true when the value didn't need to be added.
+ * (when false, the caller _must_ initialize the value).
+ */
+bool BLI_ohash_ensure_p(OHash *oh, void *key, void ***r_val)
+{
+	OHashEntry *e = ohash_lookup_entry(oh, key);
+	const bool haskey = (e != NULL);
+
+	if (!haskey) {
+		ohash_buckets_expand(oh, oh->nentries + 1);
+		e = ohash_insert_entry(oh, key, NULL);
+		oh->nentries++;
+	}
+
+	*r_val = &e->val;
+	return haskey;
+}
+
+/**
+ * Remove \a key from \a oh, or return false if the key wasn't found.
+ *
+ * \param key  The key to remove.
+ * \param valfreefp  Optional callback to free the value.
+ * \return true if \a key was removed from \a oh.
+ */
+bool BLI_ohash_remove(OHash *oh, const void *key, OHashValFreeFP valfreefp)
+{
+	OHashEntry *e = ohash_lookup_entry(oh, key);
+
+	if (e) {
+		if (valfreefp) {
+			valfreefp(e->val);
+		}
+		ohash_remove_entry(oh, e);
+		return true;
+	}
+	else {
+		return false;
+	}
+}
+
+/**
+ * Remove \a key from \a oh, returning the value or NULL if the key wasn't found.
+ *
+ * \param key  The key to remove.
+ * \return the value of \a key int \a oh or NULL.
+ */
+void *BLI_ohash_popkey(OHash *oh, const void *key)
+{
+	OHashEntry *e = ohash_lookup_entry(oh, key);
+
+	if (e) {
+		void *val = e->val;
+		ohash_remove_entry(oh, e);
+		return val;
+	}
+	else {
+		return NULL;
+	}
+}
+
+/**
+ * \return true if the \a key is in \a oh.
+ */
+bool BLI_ohash_haskey(OHash *oh, const void *key)
+{
+	return (ohash_lookup_entry(oh, key) != NULL);
+}
+
+/**
+ * Reset \a oh clearing all entries.
+ *
+ * \param valfreefp  Optional callback to free the value.
+ * \param nentries_reserve  Optionally reserve the number of members that the hash will hold.
+ */
+void BLI_ohash_clear_ex(OHash *oh, OHashValFreeFP valfreefp,
+                        const unsigned int nentries_reserve)
+{
+	if (valfreefp) {
+		ohash_free_values(oh, valfreefp);
+	}
+
+	MEM_freeN(oh->buckets);
+	oh->buckets = NULL;
+	oh->nentries = 0;
+	ohash_buckets_resize(oh, ohash_bucket_bit_for_size(nentries_reserve));
+}
+
+/**
+ * Wraps #BLI_ohash_clear_ex with zero entries reserved.
+ */
+void BLI_ohash_clear(OHash *oh, OHashValFreeFP valfreefp)
+{
+	BLI_ohash_clear_ex(oh, valfreefp, 0);
+}
+
+/**
+ * Frees the OHash and its members.
+ *
+ * \param oh  The OHash to free.
+ * \param valfreefp  Optional callback to free the value.
+ */
+void BLI_ohash_free(OHash *oh, OHashValFreeFP valfreefp)
+{
+	if (valfreefp) {
+		ohash_free_values(oh, valfreefp);
+	}
+
+	MEM_freeN(oh->buckets);
+	MEM_freeN(oh);
+}
+
+/** \} */
+
+
+/* -------------------------------------------------------------------- */
+/* OHash Iterator API */
+
+/** \name Iterator API
+ *
+ * \note The table must not be modified while iterating over it.
+ * \{ */
+
+static void ohashIterator_find(OHashIterator *ohi)
+{
+	for (; ohi->curBucket < ohi->oh->nbuckets; ohi->curBucket++) {
+		OHashEntry *e = &ohi->oh->buckets[ohi->curBucket];
+		if (e->dist != 0) {
+			ohi->curEntry = e;
+			return;
+		}
+	}
+	ohi->curEntry = NULL;
+}
+
+/**
+ * Init an already allocated OHashIterator. The hash table must not
+ * be mutated while the iterator is in use, and the iterator will
+ * step through the elements in no particular order.
+ *
+ * \param ohi The OHashIterator to initialize.
+ * \param oh The OHash to iterate over.
+ */
+void BLI_ohashIterator_init(OHashIterator *ohi, OHash *oh)
+{
+	ohi->oh = oh;
+	ohi->curBucket = 0;
+	ohashIterator_find(ohi);
+}
+
+/**
+ * Steps the iterator to the next index.
+ *
+ * \param ohi The iterator.
+ */
+void BLI_ohashIterator_step(OHashIterator *ohi)
+{
+	if (ohi->curEntry) {
+		ohi->curBucket++;
+		ohashIterator_find(ohi);
+	}
+}
+
+/** \} */
+
+
+/** \name Debugging & Introspection
+ * \{ */
+
+/**
+ * Measure how well the hash function performs,
+ * the average number of buckets visited to find a key (the lower the better, 1.0 at best).
+ *
+ * \param r_load The load of the table (number of entries / number of buckets).
+ * \param r_prob_max The biggest distance of a key from its bucket.
+ */
+double BLI_ohash_calc_quality_ex(OHash *oh, double *r_load, int *r_prob_max)
+{
+	uint64_t sum = 0;
+	unsigned int dist_max = 0;
+	unsigned int i;
+
+	for (i = 0; i < oh->nbuckets; i++) {
+		const unsigned int dist = oh->buckets[i].dist;
+		if (dist != 0) {
+			sum += dist;
+			if (dist > dist_max) {
+				dist_max = dist;
+			}
+		}
+	}
+
+	if (r_load) {
+		*r_load = (double)oh->nentries / (double)oh->nbuckets;
+	}
+	if (r_prob_max) {
+		*r_prob_max = (int)dist_max;
+	}
+
+	return oh->nentries ? (double)sum / (double)oh->nentries : 0.0;
+}
+
+double BLI_ohash_calc_quality(OHash *oh)
+{
+	return BLI_ohash_calc_quality_ex(oh, NULL, NULL);
+}
+
+/** \} */
@@ -35,11 +35,18 @@
  *
  * - avoid intersection tests when there are no convex points (USE_CONVEX_SKIP).
  *
+ * - use a sweep-line (monotone partition) for large concave polygons (USE_SWEEP),
+ *   since ear clipping degrades badly with tens of thousands of vertices.
+ *
  * \note
  *
  * No globals - keep threadsafe.
  */
 
+#include <stdlib.h>
+
+#include "MEM_guardedalloc.h"
+
 #include "BLI_utildefines.h"
 #include "BLI_math.h"
 
@@ -59,6 +66,12 @@
 
 #ifdef USE_CONVEX_SKIP
 #  define USE_KDTREE
+#  define USE_SWEEP
+#endif
+
+#ifdef USE_SWEEP
+/* concave polygons with at least this many vertices use the sweep-line */
+#  define SWEEP_COORDS_MIN 4096
 #endif
 
 /* disable in production, it can fail on near zero area ngons */
@@ -462,6 +475,700 @@ static bool kdtree2d_isect_tri(
 #endif  /* USE_KDTREE */
 
 
+#ifdef USE_SWEEP
+/**
+ * Sweep-line triangulation, used instead of ear clipping for concave polygons
+ * with many vertices, where ear clipping gets too slow.
+ *
+ * The polygon is split into y-monotone parts by adding diagonals at split & merge vertices,
+ * each part is then triangulated in linear time, giving O(n log n) overall,
+ * see: "Computational Geometry: Algorithms and Applications", chapter 3.
+ *
+ * - Vertices are ordered by Y then X, so horizontal edges need no special handling.
+ * - Edges crossing the sweep line are kept in a treap (ordered left to right),
+ *   only for searching the edge left of a vertex.
+ * - The result is checked: self intersecting or degenerate polygons
+ *   return false, so the caller falls back to ear clipping.
+ *
+ * Vertices are referenced by their position in the (counter-clockwise) polygon,
+ * edge 'i' goes from vertex 'i' to 'i + 1'.
+ */
+
+#define SWEEP_UNSET ((unsigned int)-1)
+
+/* allow for float precision, when checking triangles which should be counter-clockwise */
+#define SWEEP_FLIP_EPS 1e-5f
+
+enum {
+	SWEEP_START = 0,
+	SWEEP_END,
+	SWEEP_SPLIT,
+	SWEEP_MERGE,
+	/* regular vertices, on the left or right of the polygon interior */
+	SWEEP_REGULAR_LEFT,
+	SWEEP_REGULAR_RIGHT,
+};
+
+/* use for sorting */
+typedef struct SweepVert {
+	float co[2];
+	unsigned int v;
+} SweepVert;
+
+typedef struct SweepNode {
+	unsigned int parent, child[2];
+	unsigned int prio;
+	bool is_active;
+} SweepNode;
+
+typedef struct PolySweep {
+	const float (*coords)[2];
+	unsigned int coords_tot;
+	/* counter-clockwise vertices (coords index) */
+	unsigned int *verts;
+
+	/* vertex aligned */
+	unsigned char *vert_types;
+	/* first diagonal half-edge leaving each vertex */
+	unsigned int *vert_diags;
+
+	/* edge aligned */
+	unsigned int *helpers;
+	SweepNode *nodes;
+	unsigned int root;
+
+	unsigned int (*diags)[2];
+	unsigned int diags_tot;
+	/* next diagonal half-edge leaving the same vertex */
+	unsigned int *diags_next;
+} PolySweep;
+
+BLI_INLINE const float *sweep_co(const PolySweep *ps, const unsigned int v)
+{
+	return ps->coords[ps->verts[v]];
+}
+
+/**
+ * Total ordering for the sweep, top to bottom, then left to right.
+ */
+static bool sweep_is_above(const PolySweep *ps, const unsigned int v_a, const unsigned int v_b)
+{
+	const float *co_a = sweep_co(ps, v_a);
+	const float *co_b = sweep_co(ps, v_b);
+
+	if (co_a[1] != co_b[1]) {
+		return (co_a[1] > co_b[1]);
+	}
+	else if (co_a[0] != co_b[0]) {
+		return (co_a[0] < co_b[0]);
+	}
+	else {
+		return (v_a < v_b);
+	}
+}
+
+static int sweep_vert_cmp(const void *a_p, const void *b_p)
+{
+	const SweepVert *a = a_p;
+	const SweepVert *b = b_p;
+
+	if      (a->co[1] > b->co[1]) return -1;
+	else if (a->co[1] < b->co[1]) return  1;
+	else if (a->co[0] < b->co[0]) return -1;
+	else if (a->co[0] > b->co[0]) return  1;
+	else if (a->v     < b->v)     return -1;
+	else if (a->v     > b->v)     return  1;
+	else                          return  0;
+}
+
+BLI_INLINE unsigned int sweep_v_next(const PolySweep *ps, const unsigned int v)
+{
+	return (v + 1 == ps->coords_tot) ? 0 : v + 1;
+}
+
+BLI_INLINE unsigned int sweep_v_prev(const PolySweep *ps, const unsigned int v)
+{
+	return (v == 0) ? ps->coords_tot - 1 : v - 1;
+}
+
+/**
+ * \return true when edge \a e is left of vertex \a v (which must be within its vertical range).
+ */
+static bool sweep_edge_is_left(const PolySweep *ps, const unsigned int e, const unsigned int v)
+{
+	unsigned int v_upper = e, v_lower = sweep_v_next(ps, e);
+
+	if (sweep_is_above(ps, v_lower, v_upper)) {
+		SWAP(unsigned int, v_upper, v_lower);
+	}
+	return (area_tri_signed_v2_alt_2x(sweep_co(ps, v_upper), sweep_co(ps, v_lower), sweep_co(ps, v)) > 0.0f);
+}
+
+/* -------------------------------------------------------------------- */
+/* Treap of edges crossing the sweep line */
+
+static unsigned int sweep_hash_uint(unsigned int x)
+{
+	x ^= x >> 16;
+	x *= 0x85ebca6bu;
+	x ^= x >> 13;
+	x *= 0xc2b2ae35u;
+	x ^= x >> 16;
+	return x;
+}
+
+static void sweep_node_rotate_up(PolySweep *ps, const unsigned int n)
+{
+	SweepNode *nodes = ps->nodes;
+	const unsigned int n_parent = nodes[n].parent;
+	const unsigned int n_grandparent = nodes[n_parent].parent;
+	const int side = (nodes[n_parent].child[1] == n);
+	const unsigned int n_inner = nodes[n].child[!side];
+
+	nodes[n_parent].child[side] = n_inner;
+	if (n_inner != SWEEP_UNSET) {
+		nodes[n_inner].parent = n_parent;
+	}
+	nodes[n].child[!side] = n_parent;
+	nodes[n_parent].parent = n;
+	nodes[n].parent = n_grandparent;
+
+	if (n_grandparent == SWEEP_UNSET) {
+		ps->root = n;
+	}
+	else {
+		nodes[n_grandparent].child[nodes[n_grandparent].child[1] == n_parent] = n;
+	}
+}
+
+/**
+ * Insert edge \a e, its upper vertex \a v is the current sweep position.
+ */
+static void sweep_edge_insert(PolySweep *ps, const unsigned int e, const unsigned int v)
+{
+	SweepNode *nodes = ps->nodes;
+	unsigned int *link = &ps->root;
+	unsigned int n_parent = SWEEP_UNSET;
+
+	while (*link != SWEEP_UNSET) {
+		n_parent = *link;
+		link = &nodes[n_parent].child[sweep_edge_is_left(ps, n_parent, v)];
+	}
+
+	*link = e;
+	nodes[e].parent = n_parent;
+	nodes[e].child[0] = nodes[e].child[1] = SWEEP_UNSET;
+	nodes[e].is_active = true;
+
+	while ((nodes[e].parent != SWEEP_UNSET) && (nodes[nodes[e].parent].prio < nodes[e].prio)) {
+		sweep_node_rotate_up(ps, e);
+	}
+}
+
+static void sweep_edge_remove(PolySweep *ps, const unsigned int e)
+{
+	SweepNode *nodes = ps->nodes;
+	unsigned int n_parent;
+
+	/* rotate down until it's a leaf */
+	while ((nodes[e].child[0] != SWEEP_UNSET) || (nodes[e].child[1] != SWEEP_UNSET)) {
+		const unsigned int n_neg = nodes[e].child[0];
+		const unsigned int n_pos = nodes[e].child[1];
+		sweep_node_rotate_up(
+		        ps,
+		        (n_neg == SWEEP_UNSET) ? n_pos :
+		        (n_pos == SWEEP_UNSET) ? n_neg :
+		        (nodes[n_neg].prio > nodes[n_pos].prio) ? n_neg : n_pos);
+	}
+
+	n_parent = nodes[e].parent;
+	if (n_parent == SWEEP_UNSET) {
+		ps->root = SWEEP_UNSET;
+	}
+	else {
+		nodes[n_parent].child[nodes[n_parent].child[1] == e] = SWEEP_UNSET;
+	}
+	nodes[e].parent = SWEEP_UNSET;
+	nodes[e].is_active = false;
+}
+
+/**
+ * \return the edge directly left of vertex \a v.
+ */
+static unsigned int sweep_edge_find_left(const PolySweep *ps, const unsigned int v)
+{
+	const SweepNode *nodes = ps->nodes;
+	unsigned int n = ps->root;
+	unsigned int e_left = SWEEP_UNSET;
+
+	while (n != SWEEP_UNSET) {
+		if (sweep_edge_is_left(ps, n, v)) {
+			e_left = n;
+			n = nodes[n].child[1];
+		}
+		else {
+			n = nodes[n].child[0];
+		}
+	}
+	return e_left;
+}
+
+/* -------------------------------------------------------------------- */
+/* Monotone partition */
+
+static bool sweep_diag_add(PolySweep *ps, const unsigned int v_a, const unsigned int v_b)
+{
+	/* a simple polygon never needs more */
+	if (UNLIKELY((ps->diags_tot == ps->coords_tot - 3) ||
+	             (v_a == v_b) ||
+	             (sweep_v_next(ps, v_a) == v_b) ||
+	             (sweep_v_prev(ps, v_a) == v_b)))
+	{
+		return false;
+	}
+
+	ps->diags[ps->diags_tot][0] = v_a;
+	ps->diags[ps->diags_tot][1] = v_b;
+	ps->diags_tot += 1;
+	return true;
+}
+
+BLI_INLINE bool sweep_helper_is_merge(const PolySweep *ps, const unsigned int e)
+{
+	return (ps->vert_types[ps->helpers[e]] == SWEEP_MERGE);
+}
+
+static void sweep_vert_types_calc(PolySweep *ps)
+{
+	unsigned int v;
+
+	for (v = 0; v < ps->coords_tot; v++) {
+		const unsigned int v_prev = sweep_v_prev(ps, v);
+		const unsigned int v_next = sweep_v_next(ps, v);
+		const bool is_prev_above = sweep_is_above(ps, v_prev, v);
+		const bool is_next_above = sweep_is_above(ps, v_next, v);
+		unsigned char type;
+
+		if (is_prev_above == is_next_above) {
+			const bool is_convex = (area_tri_signed_v2_alt_2x(
+			        sweep_co(ps, v_prev), sweep_co(ps, v), sweep_co(ps, v_next)) > 0.0f);
+			if (is_prev_above) {
+				type = is_convex ? SWEEP_END : SWEEP_MERGE;
+			}
+			else {
+				type = is_convex ? SWEEP_START : SWEEP_SPLIT;
+			}
+		}
+		else {
+			/* going down the boundary, the interior is to the right */
+			type = is_prev_above ? SWEEP_REGULAR_LEFT : SWEEP_REGULAR_RIGHT;
+		}
+		ps->vert_types[v] = type;
+	}
+}
+
+/**
+ * Handle vertex \a v, the sweep line has reached it.
+ */
+static bool sweep_vert_event(PolySweep *ps, const unsigned int v)
+{
+	const unsigned int e_prev = sweep_v_prev(ps, v);
+	const unsigned int e_next = v;
+	unsigned int e_left;
+	const unsigned char type = ps->vert_types[v];
+
+	/* edge ending at this vertex */
+	if (ELEM(type, SWEEP_END, SWEEP_MERGE, SWEEP_REGULAR_LEFT)) {
+		if (UNLIKELY(!ps->nodes[e_prev].is_active)) {
+			return false;
+		}
+		if (sweep_helper_is_merge(ps, e_prev)) {
+			if (!sweep_diag_add(ps, v, ps->helpers[e_prev])) {
+				return false;
+			}
+		}
+		sweep_edge_remove(ps, e_prev);
+	}
+
+	/* edge left of this vertex */
+	if (ELEM(type, SWEEP_SPLIT, SWEEP_MERGE, SWEEP_REGULAR_RIGHT)) {
+		e_left = sweep_edge_find_left(ps, v);
+		if (UNLIKELY(e_left == SWEEP_UNSET)) {
+			return false;
+		}
+		if ((type == SWEEP_SPLIT) || sweep_helper_is_merge(ps, e_left)) {
+			if (!sweep_diag_add(ps, v, ps->helpers[e_left])) {
+				return false;
+			}
+		}
+		ps->helpers[e_left] = v;
+	}
+
+	/* edge starting at this vertex */
+	if (ELEM(type, SWEEP_START, SWEEP_SPLIT, SWEEP_REGULAR_LEFT)) {
+		sweep_edge_insert(ps, e_next, v);
+		ps->helpers[e_next] = v;
+	}
+
+	return true;
+}
+
+/* -------------------------------------------------------------------- */
+/* Monotone polygon triangulation */
+
+/**
+ * Half-edges are indexed by edge, followed by both directions of each diagonal.
+ */
+static void sweep_half_edge_verts(
+        const PolySweep *ps, const unsigned int h,
+        unsigned int *r_v_src, unsigned int *r_v_dst)
+{
+	if (h < ps->coords_tot) {
+		*r_v_src = h;
+		*r_v_dst = sweep_v_next(ps, h);
+	}
+	else {
+		const unsigned int d = (h - ps->coords_tot) / 2;
+		const unsigned int side = (h - ps->coords_tot) & 1;
+		*r_v_src = ps->diags[d][side];
+		*r_v_dst = ps->diags[d][side ^ 1];
+	}
+}
+
+static double sweep_angle(const PolySweep *ps, const unsigned int v_src, const unsigned int v_dst)
+{
+	const float *co_src = sweep_co(ps, v_src);
+	const float *co_dst = sweep_co(ps, v_dst);
+	return atan2((double)co_dst[1] - (double)co_src[1], (double)co_dst[0] - (double)co_src[0]);
+}
+
+/**
+ * \return the half-edge following \a h around the face to its left.
+ */
+static unsigned int sweep_half_edge_next(const PolySweep *ps, const unsigned int h)
+{
+	unsigned int v_src, v_dst;
+	unsigned int h_iter, h_best;
+	double angle_back, angle_best;
+
+	sweep_half_edge_verts(ps, h, &v_src, &v_dst);
+
+	/* the common case */
+	if (ps->vert_diags[v_dst] == SWEEP_UNSET) {
+		return v_dst;
+	}
+
+	/* take the first edge clockwise from the way back */
+	angle_back = sweep_angle(ps, v_dst, v_src);
+	h_best = SWEEP_UNSET;
+	angle_best = 0.0;
+
+	for (h_iter = v_dst; h_iter != SWEEP_UNSET; ) {
+		unsigned int v_iter_src, v_iter_dst;
+		double angle;
+
+		sweep_half_edge_verts(ps, h_iter, &v_iter_src, &v_iter_dst);
+		angle = angle_back - sweep_angle(ps, v_iter_src, v_iter_dst);
+		if (angle <= 0.0) {
+			angle += M_PI * 2.0;
+		}
+		if ((h_best == SWEEP_UNSET) || (angle < angle_best)) {
+			h_best = h_iter;
+			angle_best = angle;
+		}
+
+		h_iter = (h_iter < ps->coords_tot) ?
+		         ps->vert_diags[v_dst] : ps->diags_next[h_iter - ps->coords_tot];
+	}
+
+	return h_best;
+}
+
+/**
+ * Add a counter-clockwise triangle, written clockwise to match ear clipping.
+ */
+static bool sweep_tri_add(
+        const PolySweep *ps, PolyFill *pf,
+        const unsigned int v_a, const unsigned int v_b, const unsigned int v_c)
+{
+	const float *co_a = sweep_co(ps, v_a);
+	const float *co_b = sweep_co(ps, v_b);
+	const float *co_c = sweep_co(ps, v_c);
+	const float area = area_tri_signed_v2_alt_2x(co_a, co_b, co_c);
+	unsigned int *tri;
+
+	if (UNLIKELY(pf->tris_tot == ps->coords_tot - 2)) {
+		return false;
+	}
+
+	/* flipped, allowing for precision of (near) co-linear vertices */
+	if (UNLIKELY(area < 0.0f)) {
+		if ((area * area) > (SQUARE(SWEEP_FLIP_EPS) * len_squared_v2v2(co_a, co_b) * len_squared_v2v2(co_a, co_c))) {
+			return false;
+		}
+	}
+
+	tri = pf->tris[pf->tris_tot++];
+	tri[0] = ps->verts[v_a];
+	tri[1] = ps->verts[v_c];
+	tri[2] = ps->verts[v_b];
+	return true;
+}
+
+/**
+ * Triangulate a y-monotone polygon.
+ *
+ * \param face: Counter-clockwise vertices.
+ * \param r_verts, r_chains, r_stack: Buffers, at least \a face_len long.
+ */
+static bool sweep_face_triangulate(
+        const PolySweep *ps, PolyFill *pf,
+        const unsigned int *face, const unsigned int face_len,
+        unsigned int *r_verts, bool *r_chains, unsigned int *r_stack)
+{
+	/* left chain as true */
+	bool *chains = r_chains;
+	unsigned int *verts = r_verts;
+	unsigned int *stack = r_stack;
+	unsigned int stack_len;
+	unsigned int i_top = 0, i_bottom = 0;
+	unsigned int left_len, left_step, right_step;
+	unsigned int i, j;
+
+	if (face_len == 3) {
+		return sweep_tri_add(ps, pf, face[0], face[1], face[2]);
+	}
+
+	for (i = 1; i < face_len; i++) {
+		if (sweep_is_above(ps, face[i], face[i_top])) {
+			i_top = i;
+		}
+		if (sweep_is_above(ps, face[i_bottom], face[i])) {
+			i_bottom = i;
+		}
+	}
+
+	/* merge both chains top to bottom, counter-clockwise from the top is the left chain */
+	left_len = (i_bottom + face_len - i_top) % face_len;
+	left_step = right_step = 1;
+	verts[0] = face[i_top];
+	chains[0] = true;
+	for (i = 1; i < face_len; i++) {
+		const unsigned int v_left = (left_step <= left_len) ?
+		        face[(i_top + left_step) % face_len] : SWEEP_UNSET;
+		const unsigned int v_right = (right_step < face_len - left_len) ?
+		        face[(i_top + face_len - right_step) % face_len] : SWEEP_UNSET;
+		unsigned int v_chain_prev;
+
+		if ((v_right == SWEEP_UNSET) || ((v_left != SWEEP_UNSET) && sweep_is_above(ps, v_left, v_right))) {
+			v_chain_prev = face[(i_top + left_step - 1) % face_len];
+			verts[i] = v_left;
+			chains[i] = true;
+			left_step++;
+		}
+		else {
+			v_chain_prev = face[(i_top + face_len - right_step + 1) % face_len];
+			verts[i] = v_right;
+			chains[i] = false;
+			right_step++;
+		}
+
+		/* not monotone */
+		if (UNLIKELY(!sweep_is_above(ps, v_chain_prev, verts[i]))) {
+			return false;
+		}
+	}
+
+	stack[0] = verts[0];
+	stack[1] = verts[1];
+	stack_len = 2;
+
+	for (i = 2; i < face_len - 1; i++) {
+		const unsigned int v = verts[i];
+		/* chain of the stack (excluding its first vertex) */
+		const bool chain_stack = chains[i - 1];
+
+		if (chains[i] != chain_stack) {
+			for (j = stack_len - 1; j > 0; j--) {
+				if (!(chains[i] ?
+				      sweep_tri_add(ps, pf, stack[j], stack[j - 1], v) :
+				      sweep_tri_add(ps, pf, stack[j - 1], stack[j], v)))
+				{
+					return false;
+				}
+			}
+			stack[0] = verts[i - 1];
+			stack[1] = v;
+			stack_len = 2;
+		}
+		else {
+			unsigned int v_last = stack[--stack_len];
+			while (stack_len) {
+				const unsigned int v_top = stack[stack_len - 1];
+				const float area = chains[i] ?
+				        area_tri_signed_v2_alt_2x(sweep_co(ps, v_top), sweep_co(ps, v_last), sweep_co(ps, v)) :
+				        area_tri_signed_v2_alt_2x(sweep_co(ps, v), sweep_co(ps, v_last), sweep_co(ps, v_top));
+				if (area <= 0.0f) {
+					break;
+				}
+				if (!(chains[i] ?
+				      sweep_tri_add(ps, pf, v_top, v_last, v) :
+				      sweep_tri_add(ps, pf, v, v_last, v_top)))
+				{
+					return false;
+				}
+				v_last = v_top;
+				stack_len--;
+			}
+			stack[stack_len++] = v_last;
+			stack[stack_len++] = v;
+		}
+	}
+
+	/* the bottom vertex connects to the whole stack */
+	{
+		const unsigned int v = verts[face_len - 1];
+		const bool chain_stack = chains[face_len - 2];
+		for (j = stack_len - 1; j > 0; j--) {
+			if (!(chain_stack ?
+			      sweep_tri_add(ps, pf, stack[j - 1], stack[j], v) :
+			      sweep_tri_add(ps, pf, stack[j], stack[j - 1], v)))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/**
+ * \return false when the polygon couldn't be triangulated, \a pf is then left as it was (besides tris content).
+ */
+static bool polyfill_sweep_calc(PolyFill *pf)
+{
+	const unsigned int coords_tot = pf->coords_tot;
+	MemArena *arena = BLI_memarena_new(BLI_MEMARENA_STD_BUFSIZE, __func__);
+	PolySweep ps;
+	SweepVert *sweep_verts;
+	unsigned int *face, *buf_verts, *buf_stack;
+	bool *buf_chains, *half_edges_done;
+	unsigned int half_edges_tot;
+	unsigned int i, v;
+	bool ok = true;
+
+#ifdef DEBUG_TIME
+	TIMEIT_START(polyfill2d_sweep);
+#endif
+
+	ps.coords = pf->coords;
+	ps.coords_tot = coords_tot;
+	ps.verts = BLI_memarena_alloc(arena, sizeof(*ps.verts) * coords_tot);
+	ps.vert_types = BLI_memarena_alloc(arena, sizeof(*ps.vert_types) * coords_tot);
+	ps.vert_diags = BLI_memarena_alloc(arena, sizeof(*ps.vert_diags) * coords_tot);
+	ps.helpers = BLI_memarena_alloc(arena, sizeof(*ps.helpers) * coords_tot);
+	ps.nodes = BLI_memarena_alloc(arena, sizeof(*ps.nodes) * coords_tot);
+	ps.root = SWEEP_UNSET;
+	ps.diags = BLI_memarena_alloc(arena, sizeof(*ps.diags) * (coords_tot - 3));
+	ps.diags_next = BLI_memarena_alloc(arena, sizeof(*ps.diags_next) * (coords_tot - 3) * 2);
+	ps.diags_tot = 0;
+
+	/* ear clipping order is clockwise, reverse it */
+	for (i = 0; i < coords_tot; i++) {
+		ps.verts[coords_tot - 1 - i] = pf->indices[i].index;
+	}
+
+	for (i = 0; i < coords_tot; i++) {
+		ps.nodes[i].parent = ps.nodes[i].child[0] = ps.nodes[i].child[1] = SWEEP_UNSET;
+		ps.nodes[i].prio = sweep_hash_uint(i);
+		ps.nodes[i].is_active = false;
+		ps.vert_diags[i] = SWEEP_UNSET;
+	}
+
+	sweep_vert_types_calc(&ps);
+
+	/* sweep top to bottom, adding diagonals */
+	sweep_verts = BLI_memarena_alloc(arena, sizeof(*sweep_verts) * coords_tot);
+	for (v = 0; v < coords_tot; v++) {
+		copy_v2_v2(sweep_verts[v].co, sweep_co(&ps, v));
+		sweep_verts[v].v = v;
+	}
+	qsort(sweep_verts, coords_tot, sizeof(*sweep_verts), sweep_vert_cmp);
+
+	for (i = 0; i < coords_tot; i++) {
+		if (!sweep_vert_event(&ps, sweep_verts[i].v)) {
+			ok = false;
+			goto finally;
+		}
+	}
+
+	/* link diagonal half-edges to their vertices */
+	for (i = 0; i < ps.diags_tot * 2; i++) {
+		v = ps.diags[i / 2][i & 1];
+		ps.diags_next[i] = ps.vert_diags[v];
+		ps.vert_diags[v] = coords_tot + i;
+	}
+
+	/* walk around each monotone polygon and triangulate it */
+	half_edges_tot = coords_tot + ps.diags_tot * 2;
+	half_edges_done = BLI_memarena_calloc(arena, sizeof(*half_edges_done) * half_edges_tot);
+	face = BLI_memarena_alloc(arena, sizeof(*face) * coords_tot);
+	buf_verts = BLI_memarena_alloc(arena, sizeof(*buf_verts) * coords_tot);
+	buf_chains = BLI_memarena_alloc(arena, sizeof(*buf_chains) * coords_tot);
+	buf_stack = BLI_memarena_alloc(arena, sizeof(*buf_stack) * coords_tot);
+
+	pf->tris_tot = 0;
+
+	for (i = 0; i < half_edges_tot; i++) {
+		unsigned int face_len = 0;
+		unsigned int h = i;
+
+		if (half_edges_done[i]) {
+			continue;
+		}
+
+		do {
+			unsigned int v_src, v_dst;
+
+			if (UNLIKELY(half_edges_done[h] || (face_len == coords_tot))) {
+				ok = false;
+				goto finally;
+			}
+			half_edges_done[h] = true;
+
+			sweep_half_edge_verts(&ps, h, &v_src, &v_dst);
+			face[face_len++] = v_src;
+			h = sweep_half_edge_next(&ps, h);
+		} while (h != i);
+
+		if (UNLIKELY((face_len < 3) ||
+		             !sweep_face_triangulate(&ps, pf, face, face_len, buf_verts, buf_chains, buf_stack)))
+		{
+			ok = false;
+			goto finally;
+		}
+	}
+
+	if (pf->tris_tot != coords_tot - 2) {
+		ok = false;
+	}
+
+finally:
+	BLI_memarena_free(arena);
+
+	if (!ok) {
+		pf->tris_tot = 0;
+	}
+
+#ifdef DEBUG_TIME
+	TIMEIT_END(polyfill2d_sweep);
+#endif
+	return ok;
+}
+
+#endif  /* USE_SWEEP */
+
+
 static unsigned int *pf_tri_add(PolyFill *pf)
 {
 	return pf->tris[pf->tris_tot++];
@@ -860,6 +1567,14 @@ static void polyfill_calc(
 	pf_triangulate(pf);
 }
 
+#ifdef USE_SWEEP
+static bool polyfill_sweep_use(const PolyFill *pf)
+{
+	/* convex polygons are fast to ear clip */
+	return ((pf->coords_tot >= SWEEP_COORDS_MIN) && (pf->coords_tot_concave != 0));
+}
+#endif
+
 void BLI_polyfill_calc_arena(
         const float (*coords)[2],
         const unsigned int coords_tot,
@@ -882,18 +1597,23 @@ void BLI_polyfill_calc_arena(
 	        /* cache */
 	        indices);
 
+#ifdef USE_SWEEP
+	if (!(polyfill_sweep_use(&pf) && polyfill_sweep_calc(&pf)))
+#endif
+	{
 #ifdef USE_KDTREE
-	if (pf.coords_tot_concave) {
-		pf.kdtree.nodes = BLI_memarena_alloc(arena, sizeof(*pf.kdtree.nodes) * pf.coords_tot_concave);
-		pf.kdtree.nodes_map = memset(BLI_memarena_alloc(arena, sizeof(*pf.kdtree.nodes_map) * coords_tot),
-		                             0xff, sizeof(*pf.kdtree.nodes_map) * coords_tot);
-	}
-	else {
-		pf.kdtree.totnode = 0;
-	}
+		if (pf.coords_tot_concave) {
+			pf.kdtree.nodes = BLI_memarena_alloc(arena, sizeof(*pf.kdtree.nodes) * pf.coords_tot_concave);
+			pf.kdtree.nodes_map = memset(BLI_memarena_alloc(arena, sizeof(*pf.kdtree.nodes_map) * coords_tot),
+			                             0xff, sizeof(*pf.kdtree.nodes_map) * coords_tot);
+		}
+		else {
+			pf.kdtree.totnode = 0;
+		}
 #endif
 
-	polyfill_calc(&pf);
+		polyfill_calc(&pf);
+	}
 
 	/* indices are no longer needed,
 	 * caller can clear arena */
@@ -923,18 +1643,23 @@ void BLI_polyfill_calc(
 	        /* cache */
 	        indices);
 
+#ifdef USE_SWEEP
+	if (!(polyfill_sweep_use(&pf) && polyfill_sweep_calc(&pf)))
+#endif
+	{
 #ifdef USE_KDTREE
-	if (pf.coords_tot_concave) {
-		pf.kdtree.nodes = BLI_array_alloca(pf.kdtree.nodes, pf.coords_tot_concave);
-		pf.kdtree.nodes_map = memset(BLI_array_alloca(pf.kdtree.nodes_map, coords_tot),
-		                             0xff, sizeof(*pf.kdtree.nodes_map) * coords_tot);
-	}
-	else {
-		pf.kdtree.totnode = 0;
-	}
+		if (pf.coords_tot_concave) {
+			pf.kdtree.nodes = BLI_array_alloca(pf.kdtree.nodes, pf.coords_tot_concave);
+			pf.kdtree.nodes_map = memset(BLI_array_alloca(pf.kdtree.nodes_map, coords_tot),
+			                             0xff, sizeof(*pf.kdtree.nodes_map) * coords_tot);
+		}
+		else {
+			pf.kdtree.totnode = 0;
+		}
 #endif
 
-	polyfill_calc(&pf);
+		polyfill_calc(&pf);
+	}
 
 #ifdef DEBUG_TIME
 	TIMEIT_END(polyfill2d);
@@ -30,6 +30,7 @@
 
 #include "BLI_listbase.h"
 #include "BLI_math.h"
+#include "BLI_mempool.h"
 #include "BLI_task.h"
 #include "BLI_threads.h"
 
@@ -67,15 +68,29 @@ struct TaskPool {
 	bool run_in_background;
 };
 
+typedef struct TaskQueue {
+	ListBase list;
+	ThreadMutex mutex;
+} TaskQueue;
+
 struct TaskScheduler {
 	pthread_t *threads;
 	struct TaskThread *task_threads;
 	int num_threads;
 	bool background_thread_only;
 
-	ListBase queue;
-	ThreadMutex queue_mutex;
-	ThreadCondition queue_cond;
+	/* Tasks pushed by a worker thread go to its own queue, others to the shared queue,
+	 * so workers running many small tasks don't all contend for a single lock.
+	 * Workers without tasks in their own queue take them from the shared queue,
+	 * or steal them from the queues of other workers. */
+	TaskQueue queue;
+	TaskQueue *thread_queues;
+
+	/* Idle workers wait for new tasks, pushing only locks to notify them when some are waiting. */
+	size_t num_pushed;
+	size_t num_waiting;
+	ThreadMutex wait_mutex;
+	ThreadCondition wait_cond;
 
 	volatile bool do_exit;
 };
@@ -126,59 +141,134 @@ static void task_pool_num_increase(TaskPool *pool)
 	BLI_mutex_unlock(&pool->num_mutex);
 }
 
-static bool task_scheduler_thread_wait_pop(TaskScheduler *scheduler, Task **task)
+/* Reserve one of the threads a pool may use, tasks are taken from different queues at once
+ * so the check and increment of the running tasks has to be atomic. */
+static bool task_pool_thread_claim(TaskPool *pool)
 {
-	bool found_task = false;
-	BLI_mutex_lock(&scheduler->queue_mutex);
+	size_t running;
 
-	while (!scheduler->queue.first && !scheduler->do_exit)
-		BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
-
-	do {
-		Task *current_task;
+	if (pool->num_threads == 0) {
+		atomic_add_z(&pool->currently_running_tasks, 1);
+		return true;
+	}
 
-		/* Assuming we can only have a void queue in 'exit' case here seems logical (we should only be here after
-		 * our worker thread has been woken up from a condition_wait(), which only happens after a new task was
-		 * added to the queue), but it is wrong.
-		 * Waiting on condition may wake up the thread even if condition is not signaled (spurious wake-ups), and some
-		 * race condition may also empty the queue **after** condition has been signaled, but **before** awoken thread
-		 * reaches this point...
-		 * See http://stackoverflow.com/questions/8594591
-		 *
-		 * So we only abort here if do_exit is set.
-		 */
-		if (scheduler->do_exit) {
-			BLI_mutex_unlock(&scheduler->queue_mutex);
-			return false;
+	while ((running = pool->currently_running_tasks) < pool->num_threads) {
+		if (atomic_cas_z(&pool->currently_running_tasks, running, running + 1) == running) {
+			return true;
 		}
+	}
+	return false;
+}
+
+static void task_queue_init(TaskQueue *queue)
+{
+	BLI_listbase_clear(&queue->list);
+	BLI_mutex_init(&queue->mutex);
+}
+
+static void task_queue_end(TaskQueue *queue)
+{
+	Task *task;
 
-		for (current_task = scheduler->queue.first;
-		     current_task != NULL;
-		     current_task = current_task->next)
-		{
-			TaskPool *pool = current_task->pool;
+	/* delete leftover tasks */
+	for (task = queue->list.first; task; task = task->next) {
+		task_data_free(task, 0);
+	}
+	BLI_freelistN(&queue->list);
+
+	BLI_mutex_end(&queue->mutex);
+}
+
+/* Take the first task which may run now from the queue, only from the given pool when it's set. */
+static Task *task_queue_pop(TaskScheduler *scheduler, TaskQueue *queue, TaskPool *pool)
+{
+	Task *task;
 
-			if (scheduler->background_thread_only && !pool->run_in_background) {
+	/* unlocked check, a task pushed just now is found by the next attempt */
+	if (queue->list.first == NULL) {
+		return NULL;
+	}
+
+	BLI_mutex_lock(&queue->mutex);
+
+	for (task = queue->list.first; task; task = task->next) {
+		if (pool) {
+			if (task->pool != pool) {
 				continue;
 			}
+		}
+		else if (scheduler->background_thread_only && !task->pool->run_in_background) {
+			continue;
+		}
 
-			if (pool->num_threads == 0 ||
-			    pool->currently_running_tasks < pool->num_threads)
-			{
-				*task = current_task;
-				found_task = true;
-				atomic_add_z(&pool->currently_running_tasks, 1);
-				BLI_remlink(&scheduler->queue, *task);
-				break;
-			}
+		if (task_pool_thread_claim(task->pool)) {
+			BLI_remlink(&queue->list, task);
+			break;
 		}
-		if (!found_task)
-			BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
-	} while (!found_task);
+	}
+
+	BLI_mutex_unlock(&queue->mutex);
+
+	return task;
+}
+
+/* Find a task, in the own queue of the thread first (NULL when it's not a worker thread),
+ * then in the shared queue and finally in the queues of the other workers. */
+static Task *task_scheduler_pop(TaskScheduler *scheduler, TaskQueue *queue_own, TaskPool *pool)
+{
+	Task *task;
+	int i, steal_start;
+
+	if (queue_own && (task = task_queue_pop(scheduler, queue_own, pool))) {
+		return task;
+	}
+
+	if ((task = task_queue_pop(scheduler, &scheduler->queue, pool))) {
+		return task;
+	}
+
+	/* start with the next worker, so thieves spread over the queues */
+	steal_start = queue_own ? (int)(queue_own - scheduler->thread_queues) + 1 : 0;
+	for (i = 0; i < scheduler->num_threads; i++) {
+		TaskQueue *queue = &scheduler->thread_queues[(steal_start + i) % scheduler->num_threads];
+
+		if (queue != queue_own && (task = task_queue_pop(scheduler, queue, pool))) {
+			return task;
+		}
+	}
 
-	BLI_mutex_unlock(&scheduler->queue_mutex);
+	return NULL;
+}
+
+static bool task_scheduler_thread_wait_pop(TaskScheduler *scheduler, TaskQueue *queue_own, Task **task)
+{
+	while (!scheduler->do_exit) {
+		const size_t num_pushed = atomic_add_z(&scheduler->num_pushed, 0);
 
-	return true;
+		if ((*task = task_scheduler_pop(scheduler, queue_own, NULL))) {
+			return true;
+		}
+
+		BLI_mutex_lock(&scheduler->wait_mutex);
+
+		/* Only wait when nothing was pushed since looking for tasks. The waiting count increases before
+		 * checking, and task_scheduler_push() increases the pushed count before checking for waiting
+		 * threads, so either we see the new task or it notifies us.
+		 *
+		 * Waiting on condition may wake up the thread even if condition is not signaled (spurious wake-ups),
+		 * which only means looking for tasks again.
+		 * See http://stackoverflow.com/questions/8594591
+		 */
+		atomic_add_z(&scheduler->num_waiting, 1);
+		if (!scheduler->do_exit && atomic_add_z(&scheduler->num_pushed, 0) == num_pushed) {
+			BLI_condition_wait(&scheduler->wait_cond, &scheduler->wait_mutex);
+		}
+		atomic_sub_z(&scheduler->num_waiting, 1);
+
+		BLI_mutex_unlock(&scheduler->wait_mutex);
+	}
+
+	return false;
 }
 
 static void *task_scheduler_thread_run(void *thread_p)
@@ -186,10 +276,11 @@ static void *task_scheduler_thread_run(void *thread_p)
 	TaskThread *thread = (TaskThread *) thread_p;
 	TaskScheduler *scheduler = thread->scheduler;
 	int thread_id = thread->id;
+	TaskQueue *queue_own = &scheduler->thread_queues[thread_id - 1];
 	Task *task;
 
 	/* keep popping off tasks */
-	while (task_scheduler_thread_wait_pop(scheduler, &task)) {
+	while (task_scheduler_thread_wait_pop(scheduler, queue_own, &task)) {
 		TaskPool *pool = task->pool;
 
 		/* run task */
@@ -214,9 +305,9 @@ TaskScheduler *BLI_task_scheduler_create(int num_threads)
 	 * threads, so we keep track of the number of users. */
 	scheduler->do_exit = false;
 
-	BLI_listbase_clear(&scheduler->queue);
-	BLI_mutex_init(&scheduler->queue_mutex);
-	BLI_condition_init(&scheduler->queue_cond);
+	task_queue_init(&scheduler->queue);
+	BLI_mutex_init(&scheduler->wait_mutex);
+	BLI_condition_init(&scheduler->wait_cond);
 
 	if (num_threads == 0) {
 		/* automatic number of threads will be main thread + num cores */
@@ -239,6 +330,11 @@ TaskScheduler *BLI_task_scheduler_create(int num_threads)
 		scheduler->num_threads = num_threads;
 		scheduler->threads = MEM_callocN(sizeof(pthread_t) * num_threads, "TaskScheduler threads");
 		scheduler->task_threads = MEM_callocN(sizeof(TaskThread) * num_threads, "TaskScheduler task threads");
+		scheduler->thread_queues = MEM_callocN(sizeof(TaskQueue) * num_threads, "TaskScheduler thread queues");
+
+		for (i = 0; i < num_threads; i++) {
+			task_queue_init(&scheduler->thread_queues[i]);
+		}
 
 		for (i = 0; i < num_threads; i++) {
 			TaskThread *thread = &scheduler->task_threads[i];
@@ -256,13 +352,11 @@ TaskScheduler *BLI_task_scheduler_create(int num_threads)
 
 void BLI_task_scheduler_free(TaskScheduler *scheduler)
 {
-	Task *task;
-
 	/* stop all waiting threads */
-	BLI_mutex_lock(&scheduler->queue_mutex);
+	BLI_mutex_lock(&scheduler->wait_mutex);
 	scheduler->do_exit = true;
-	BLI_condition_notify_all(&scheduler->queue_cond);
-	BLI_mutex_unlock(&scheduler->queue_mutex);
+	BLI_condition_notify_all(&scheduler->wait_cond);
+	BLI_mutex_unlock(&scheduler->wait_mutex);
 
 	/* delete threads */
 	if (scheduler->threads) {
@@ -281,15 +375,21 @@ void BLI_task_scheduler_free(TaskScheduler *scheduler)
 		MEM_freeN(scheduler->task_threads);
 	}
 
-	/* delete leftover tasks */
-	for (task = scheduler->queue.first; task; task = task->next) {
-		task_data_free(task, 0);
+	/* delete queues and leftover tasks */
+	if (scheduler->thread_queues) {
+		int i;
+
+		for (i = 0; i < scheduler->num_threads; i++) {
+			task_queue_end(&scheduler->thread_queues[i]);
+		}
+
+		MEM_freeN(scheduler->thread_queues);
 	}
-	BLI_freelistN(&scheduler->queue);
+	task_queue_end(&scheduler->queue);
 
 	/* delete mutex/condition */
-	BLI_mutex_end(&scheduler->queue_mutex);
-	BLI_condition_end(&scheduler->queue_cond);
+	BLI_mutex_end(&scheduler->wait_mutex);
+	BLI_condition_end(&scheduler->wait_cond);
 
 	MEM_freeN(scheduler);
 }
@@ -299,42 +399,95 @@ int BLI_task_scheduler_num_threads(TaskScheduler *scheduler)
 	return scheduler->num_threads + 1;
 }
 
+/* The own queue of the calling thread, NULL when it isn't one of the workers. */
+static TaskQueue *task_scheduler_thread_queue(TaskScheduler *scheduler)
+{
+	const pthread_t thread_id = pthread_self();
+	int i;
+
+	for (i = 0; i < scheduler->num_threads; i++) {
+		if (pthread_equal(scheduler->threads[i], thread_id)) {
+			return &scheduler->thread_queues[i];
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Index of the calling thread, in the [0, #BLI_task_scheduler_num_threads) range.
+ * Worker threads get 1 and up, any other thread (usually the one waiting on a pool) gets 0,
+ * so tasks can use it to pick their thread-local scratch buffers.
+ */
+int BLI_task_scheduler_thread_id(TaskScheduler *scheduler)
+{
+	TaskQueue *queue_own = task_scheduler_thread_queue(scheduler);
+
+	return queue_own ? (int)(queue_own - scheduler->thread_queues) + 1 : 0;
+}
+
 static void task_scheduler_push(TaskScheduler *scheduler, Task *task, TaskPriority priority)
 {
+	TaskQueue *queue = task_scheduler_thread_queue(scheduler);
+
+	if (queue == NULL) {
+		queue = &scheduler->queue;
+	}
+
 	task_pool_num_increase(task->pool);
 
 	/* add task to queue */
-	BLI_mutex_lock(&scheduler->queue_mutex);
+	BLI_mutex_lock(&queue->mutex);
 
 	if (priority == TASK_PRIORITY_HIGH)
-		BLI_addhead(&scheduler->queue, task);
+		BLI_addhead(&queue->list, task);
 	else
-		BLI_addtail(&scheduler->queue, task);
+		BLI_addtail(&queue->list, task);
+
+	BLI_mutex_unlock(&queue->mutex);
 
-	BLI_condition_notify_one(&scheduler->queue_cond);
-	BLI_mutex_unlock(&scheduler->queue_mutex);
+	/* wake up a waiting worker, see task_scheduler_thread_wait_pop() */
+	atomic_add_z(&scheduler->num_pushed, 1);
+	if (atomic_add_z(&scheduler->num_waiting, 0) != 0) {
+		BLI_mutex_lock(&scheduler->wait_mutex);
+		BLI_condition_notify_one(&scheduler->wait_cond);
+		BLI_mutex_unlock(&scheduler->wait_mutex);
+	}
 }
 
-static void task_scheduler_clear(TaskScheduler *scheduler, TaskPool *pool)
+static size_t task_queue_clear(TaskQueue *queue, TaskPool *pool)
 {
 	Task *task, *nexttask;
 	size_t done = 0;
 
-	BLI_mutex_lock(&scheduler->queue_mutex);
+	BLI_mutex_lock(&queue->mutex);
 
 	/* free all tasks from this pool from the queue */
-	for (task = scheduler->queue.first; task; task = nexttask) {
+	for (task = queue->list.first; task; task = nexttask) {
 		nexttask = task->next;
 
 		if (task->pool == pool) {
 			task_data_free(task, 0);
-			BLI_freelinkN(&scheduler->queue, task);
+			BLI_freelinkN(&queue->list, task);
 
 			done++;
 		}
 	}
 
-	BLI_mutex_unlock(&scheduler->queue_mutex);
+	BLI_mutex_unlock(&queue->mutex);
+
+	return done;
+}
+
+static void task_scheduler_clear(TaskScheduler *scheduler, TaskPool *pool)
+{
+	size_t done;
+	int i;
+
+	done = task_queue_clear(&scheduler->queue, pool);
+	for (i = 0; i < scheduler->num_threads; i++) {
+		done += task_queue_clear(&scheduler->thread_queues[i], pool);
+	}
 
 	/* notify done */
 	task_pool_num_decrease(pool, done);
@@ -445,43 +598,26 @@ void BLI_task_pool_push(
 void BLI_task_pool_work_and_wait(TaskPool *pool)
 {
 	TaskScheduler *scheduler = pool->scheduler;
+	TaskQueue *queue_own = task_scheduler_thread_queue(scheduler);
 
 	BLI_mutex_lock(&pool->num_mutex);
 
 	while (pool->num != 0) {
-		Task *task, *work_task = NULL;
-		bool found_task = false;
+		Task *work_task;
 
 		BLI_mutex_unlock(&pool->num_mutex);
 
-		BLI_mutex_lock(&scheduler->queue_mutex);
-
 		/* find task from this pool. if we get a task from another pool,
 		 * we can get into deadlock */
-
-		if (pool->num_threads == 0 ||
-		    pool->currently_running_tasks < pool->num_threads)
-		{
-			for (task = scheduler->queue.first; task; task = task->next) {
-				if (task->pool == pool) {
-					work_task = task;
-					found_task = true;
-					BLI_remlink(&scheduler->queue, task);
-					break;
-				}
-			}
-		}
-
-		BLI_mutex_unlock(&scheduler->queue_mutex);
+		work_task = task_scheduler_pop(scheduler, queue_own, pool);
 
 		/* if found task, do it, otherwise wait until other tasks are done */
-		if (found_task) {
+		if (work_task) {
 			/* run task */
-			atomic_add_z(&pool->currently_running_tasks, 1);
 			work_task->run(pool, work_task->taskdata, 0);
 
 			/* delete task */
-			task_data_free(task, 0);
+			task_data_free(work_task, 0);
 			MEM_freeN(work_task);
 
 			/* notify pool task was done */
@@ -492,7 +628,7 @@ void BLI_task_pool_work_and_wait(TaskPool *pool)
 		if (pool->num == 0)
 			break;
 
-		if (!found_task)
+		if (!work_task)
 			BLI_condition_wait(&pool->num_cond, &pool->num_mutex);
 	}
 
@@ -563,12 +699,13 @@ size_t BLI_task_pool_tasks_done(TaskPool *pool)
  *
  * Main functions:
  * - #BLI_task_parallel_range
+ * - #BLI_task_parallel_range_reduce (per-task data, joined when done)
+ * - #BLI_task_parallel_mempool (#BLI_mempool - iterate over mempools)
  *
  * TODO:
  * - #BLI_task_parallel_foreach_listbase (#ListBase - double linked list)
  * - #BLI_task_parallel_foreach_link (#Link - single linked list)
  * - #BLI_task_parallel_foreach_ghash/gset (#GHash/#GSet - hash & set)
- * - #BLI_task_parallel_foreach_mempool (#BLI_mempool - iterate over mempools)
  *
  * Possible improvements:
  *
@@ -586,6 +723,10 @@ typedef struct ParallelRangeState {
 	size_t userdata_chunk_size;
 	TaskParallelRangeFunc func;
 
+	/* only for BLI_task_parallel_range_reduce(), one userdata_chunk per task, kept over all its chunks */
+	char *userdata_chunk_array;
+	TaskParallelRangeFuncInit func_init;
+
 	int iter;
 	int chunk_size;
 	SpinLock lock;
@@ -607,12 +748,27 @@ BLI_INLINE bool parallel_range_next_iter_get(
 	return result;
 }
 
-static void parallel_range_func(
-        TaskPool * __restrict pool,
-        void *UNUSED(taskdata),
-        int UNUSED(threadid))
+static void parallel_range_func_reduce(ParallelRangeState * __restrict state, const int task_index)
+{
+	void *userdata_chunk = state->userdata_chunk_array + (size_t)task_index * state->userdata_chunk_size;
+	int iter, count;
+
+	memcpy(userdata_chunk, state->userdata_chunk, state->userdata_chunk_size);
+	if (state->func_init) {
+		state->func_init(state->userdata, userdata_chunk);
+	}
+
+	while (parallel_range_next_iter_get(state, &iter, &count)) {
+		int i;
+
+		for (i = 0; i < count; ++i) {
+			state->func(state->userdata, userdata_chunk, iter + i);
+		}
+	}
+}
+
+static void parallel_range_func_copy(ParallelRangeState * __restrict state)
 {
-	ParallelRangeState * __restrict state = BLI_task_pool_userdata(pool);
 	int iter, count;
 
 	const bool use_userdata_chunk = (state->userdata_chunk_size != 0) && (state->userdata_chunk != NULL);
@@ -633,6 +789,21 @@ static void parallel_range_func(
 	MALLOCA_FREE(userdata_chunk, state->userdata_chunk_size);
 }
 
+static void parallel_range_func(
+        TaskPool * __restrict pool,
+        void *taskdata,
+        int UNUSED(threadid))
+{
+	ParallelRangeState * __restrict state = BLI_task_pool_userdata(pool);
+
+	if (state->userdata_chunk_array) {
+		parallel_range_func_reduce(state, GET_INT_FROM_POINTER(taskdata));
+	}
+	else {
+		parallel_range_func_copy(state);
+	}
+}
+
 /**
  * This function allows to parallelized for loops in a similar way to OpenMP's 'parallel for' statement.
  *
@@ -701,6 +872,8 @@ void BLI_task_parallel_range_ex(
 	state.userdata_chunk = userdata_chunk;
 	state.userdata_chunk_size = userdata_chunk_size;
 	state.func = func;
+	state.userdata_chunk_array = NULL;
+	state.func_init = NULL;
 	state.iter = start;
 	if (use_dynamic_scheduling) {
 		state.chunk_size = 32;
@@ -736,6 +909,185 @@ void BLI_task_parallel_range(
 	BLI_task_parallel_range_ex(start, stop, userdata, NULL, 0, func, (stop - start) > 64, false);
 }
 
+/**
+ * A variant of \a BLI_task_parallel_range_ex for reductions (sums, bounds...), without any locking in \a func.
+ *
+ * Every task gets its own copy of \a userdata_chunk, kept over all the iterations it runs
+ * (similar to OpenMP's reduction clause). When the loop is done, the copies are joined back into
+ * \a userdata_chunk from the calling thread, one after the other.
+ *
+ * \param userdata_chunk Initial value of the per-task data, receives the result of the reduction.
+ * \param func_init Optional, called once for every copy of \a userdata_chunk, before its first iteration.
+ * \param func_reduce Optional, joins a copy (\a userdata_chunk) into the result (\a userdata_chunk_join).
+ * \param func_finalize Optional, called for every copy after it was joined, to free its allocations.
+ * \param chunk_size Number of iterations a task takes at once, 0 to split the range in a few chunks per thread.
+ */
+void BLI_task_parallel_range_reduce(
+        int start, int stop,
+        void *userdata,
+        void *userdata_chunk,
+        const size_t userdata_chunk_size,
+        TaskParallelRangeFunc func,
+        TaskParallelRangeFuncInit func_init,
+        TaskParallelRangeFuncReduce func_reduce,
+        TaskParallelRangeFuncFinalize func_finalize,
+        const int chunk_size,
+        const bool use_threading)
+{
+	TaskScheduler *task_scheduler;
+	TaskPool *task_pool;
+	ParallelRangeState state;
+	size_t userdata_chunk_array_size;
+	int i, num_threads, num_tasks;
+
+	BLI_assert(start < stop);
+	BLI_assert(userdata_chunk != NULL && userdata_chunk_size != 0);
+
+	task_scheduler = BLI_task_scheduler_get();
+	num_threads = BLI_task_scheduler_num_threads(task_scheduler);
+
+	if (chunk_size > 0) {
+		state.chunk_size = chunk_size;
+	}
+	else {
+		state.chunk_size = max_ii(1, (stop - start) / (num_threads * 4));
+	}
+
+	/* one task per thread, they pull chunks until the range is done */
+	num_tasks = use_threading ? min_ii(num_threads, (stop - start + state.chunk_size - 1) / state.chunk_size) : 1;
+
+	userdata_chunk_array_size = userdata_chunk_size * (size_t)num_tasks;
+
+	BLI_spin_init(&state.lock);
+	state.start = start;
+	state.stop = stop;
+	state.userdata = userdata;
+	state.userdata_chunk = userdata_chunk;
+	state.userdata_chunk_size = userdata_chunk_size;
+	state.func = func;
+	state.userdata_chunk_array = MALLOCA(userdata_chunk_array_size);
+	state.func_init = func_init;
+	state.iter = start;
+
+	if (num_tasks == 1) {
+		/* If it's not enough data to be crunched, don't bother with tasks at all,
+		 * do everything from the calling thread. */
+		parallel_range_func_reduce(&state, 0);
+	}
+	else {
+		task_pool = BLI_task_pool_create(task_scheduler, &state);
+
+		for (i = 0; i < num_tasks; i++) {
+			BLI_task_pool_push(task_pool,
+			                   parallel_range_func,
+			                   SET_INT_IN_POINTER(i), false,
+			                   TASK_PRIORITY_HIGH);
+		}
+
+		BLI_task_pool_work_and_wait(task_pool);
+		BLI_task_pool_free(task_pool);
+	}
+
+	for (i = 0; i < num_tasks; i++) {
+		void *userdata_chunk_task = state.userdata_chunk_array + (size_t)i * userdata_chunk_size;
+
+		if (func_reduce) {
+			func_reduce(userdata, userdata_chunk, userdata_chunk_task);
+		}
+		if (func_finalize) {
+			func_finalize(userdata, userdata_chunk_task);
+		}
+	}
+
+	MALLOCA_FREE(state.userdata_chunk_array, userdata_chunk_array_size);
+
+	BLI_spin_end(&state.lock);
+}
+
 #undef MALLOCA
 #undef MALLOCA_FREE
 
+typedef struct ParallelMempoolState {
+	void *userdata;
+	TaskParallelMempoolFunc func;
+} ParallelMempoolState;
+
+static void parallel_mempool_func(
+        TaskPool * __restrict pool,
+        void *taskdata,
+        int UNUSED(threadid))
+{
+	ParallelMempoolState * __restrict state = BLI_task_pool_userdata(pool);
+	BLI_mempool_iter *iter = taskdata;
+	void *item;
+
+	while ((item = BLI_mempool_iterstep_threadsafe(iter))) {
+		state->func(state->userdata, item);
+	}
+}
+
+/**
+ * This function allows to parallelize for loops over a mempool, chunks of the mempool
+ * are handed out to the tasks as they run out of items.
+ *
+ * \param mempool The iterable BLI_mempool to loop over.
+ * \param userdata Common userdata passed to all instances of \a func.
+ * \param func Callback function.
+ * \param use_threading If \a true, actually split-execute loop in threads, else just do a sequential for loop
+ *                      (allows caller to use any kind of test to switch on parallelization or not).
+ *
+ * \note There is no static scheduling here, since the items of a mempool can't be indexed.
+ */
+void BLI_task_parallel_mempool(
+        BLI_mempool *mempool,
+        void *userdata,
+        TaskParallelMempoolFunc func,
+        const bool use_threading)
+{
+	TaskScheduler *task_scheduler;
+	TaskPool *task_pool;
+	ParallelMempoolState state;
+	BLI_mempool_iter *mempool_iterators;
+	int i, num_threads, num_tasks;
+
+	if (BLI_mempool_count(mempool) == 0) {
+		return;
+	}
+
+	if (!use_threading) {
+		BLI_mempool_iter iter;
+		void *item;
+
+		BLI_mempool_iternew(mempool, &iter);
+		while ((item = BLI_mempool_iterstep(&iter))) {
+			func(userdata, item);
+		}
+		return;
+	}
+
+	task_scheduler = BLI_task_scheduler_get();
+	task_pool = BLI_task_pool_create(task_scheduler, &state);
+	num_threads = BLI_task_scheduler_num_threads(task_scheduler);
+
+	/* The number of tasks only limits the parallelism,
+	 * the load is balanced by the tasks claiming chunks on demand. */
+	num_tasks = num_threads * 2;
+
+	state.userdata = userdata;
+	state.func = func;
+
+	mempool_iterators = BLI_mempool_iter_threadsafe_create(mempool, (unsigned int)num_tasks);
+
+	for (i = 0; i < num_tasks; i++) {
+		BLI_task_pool_push(task_pool,
+		                   parallel_mempool_func,
+		                   &mempool_iterators[i], false,
+		                   TASK_PRIORITY_HIGH);
+	}
+
+	BLI_task_pool_work_and_wait(task_pool);
+	BLI_task_pool_free(task_pool);
+
+	BLI_mempool_iter_threadsafe_free(mempool_iterators);
+}
+
@@ -0,0 +1,252 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/blenlib/intern/trace.c
+ *  \ingroup bli
+ *
+ * Recording of timed regions, see BLI_trace.h.
+ *
+ * Every thread gets its own ring buffer on the first region it records,
+ * so recording only takes a lock once per thread. Buffers are kept in a global list
+ * until #BLI_trace_exit, also when their thread finished.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "BLI_utildefines.h"
+#include "BLI_fileops.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+
+#include "BLI_trace.h"  /* own include */
+
+#include "PIL_time.h"
+
+#include "BLI_strict_flags.h"
+
+/* regions kept per thread, older ones are overwritten */
+#define TRACE_RING_SIZE (1u << 16)
+
+typedef struct TraceEvent {
+	const char *name;
+	double start, end;
+} TraceEvent;
+
+typedef struct TraceBuffer {
+	struct TraceBuffer *next;
+	TraceEvent events[TRACE_RING_SIZE];
+	/* total number of recorded events, the ring position is (num_events % TRACE_RING_SIZE) */
+	unsigned int num_events;
+	int thread_id;
+	bool is_main;
+} TraceBuffer;
+
+static struct {
+	bool is_enabled;
+	char filepath[1024];
+	double start_time;
+
+	pthread_key_t buffer_key;
+	SpinLock lock;
+	TraceBuffer *buffers;
+	int num_buffers;
+} g_trace = {false};
+
+/**
+ * Enable tracing, regions recorded from now on are written to \a filepath by #BLI_trace_exit.
+ */
+void BLI_trace_init(const char *filepath)
+{
+	if (g_trace.is_enabled) {
+		return;
+	}
+
+	BLI_strncpy(g_trace.filepath, filepath, sizeof(g_trace.filepath));
+	g_trace.start_time = PIL_check_seconds_timer();
+
+	pthread_key_create(&g_trace.buffer_key, NULL);
+	BLI_spin_init(&g_trace.lock);
+	g_trace.buffers = NULL;
+	g_trace.num_buffers = 0;
+
+	g_trace.is_enabled = true;
+}
+
+/**
+ * Write the trace file and free all buffers, no other thread may be recording at this point.
+ */
+void BLI_trace_exit(void)
+{
+	TraceBuffer *buffer, *buffer_next;
+
+	if (!g_trace.is_enabled) {
+		return;
+	}
+
+	g_trace.is_enabled = false;
+
+	if (g_trace.filepath[0]) {
+		if (BLI_trace_write(g_trace.filepath)) {
+			printf("Trace written to '%s'\n", g_trace.filepath);
+		}
+		else {
+			printf("Error: failed to write trace to '%s'\n", g_trace.filepath);
+		}
+	}
+
+	for (buffer = g_trace.buffers; buffer; buffer = buffer_next) {
+		buffer_next = buffer->next;
+		free(buffer);
+	}
+	g_trace.buffers = NULL;
+
+	BLI_spin_end(&g_trace.lock);
+	pthread_key_delete(g_trace.buffer_key);
+}
+
+bool BLI_trace_is_enabled(void)
+{
+	return g_trace.is_enabled;
+}
+
+/**
+ * \return the start time to pass to #BLI_trace_end, zero when tracing is disabled.
+ */
+double BLI_trace_begin(void)
+{
+	return g_trace.is_enabled ? PIL_check_seconds_timer() : 0.0;
+}
+
+static TraceBuffer *trace_buffer_ensure(void)
+{
+	TraceBuffer *buffer = pthread_getspecific(g_trace.buffer_key);
+
+	if (buffer == NULL) {
+		/* not guarded-alloc, regions are recorded from threads without threaded malloc too */
+		buffer = malloc(sizeof(*buffer));
+		if (buffer == NULL) {
+			return NULL;
+		}
+		buffer->num_events = 0;
+		buffer->is_main = BLI_thread_is_main() != 0;
+
+		BLI_spin_lock(&g_trace.lock);
+		buffer->thread_id = g_trace.num_buffers++;
+		buffer->next = g_trace.buffers;
+		g_trace.buffers = buffer;
+		BLI_spin_unlock(&g_trace.lock);
+
+		pthread_setspecific(g_trace.buffer_key, buffer);
+	}
+
+	return buffer;
+}
+
+/**
+ * Record a region which started at \a start (from #BLI_trace_begin) and ends now.
+ *
+ * \param name: Must be a static string, only the pointer is stored.
+ */
+void BLI_trace_end(const char *name, const double start)
+{
+	TraceBuffer *buffer;
+	TraceEvent *event;
+
+	if (start == 0.0 || !g_trace.is_enabled) {
+		return;
+	}
+
+	if (!(buffer = trace_buffer_ensure())) {
+		return;
+	}
+
+	event = &buffer->events[buffer->num_events % TRACE_RING_SIZE];
+	event->name = name;
+	event->start = start;
+	event->end = PIL_check_seconds_timer();
+	buffer->num_events++;
+}
+
+static void trace_write_string(FILE *f, const char *str)
+{
+	fputc('"', f);
+	for (; *str; str++) {
+		if (ELEM(*str, '"', '\\')) {
+			fputc('\\', f);
+		}
+		fputc(*str, f);
+	}
+	fputc('"', f);
+}
+
+/**
+ * Write all recorded regions as a Chrome trace file (JSON), times are in microseconds
+ * since #BLI_trace_init.
+ */
+bool BLI_trace_write(const char *filepath)
+{
+	TraceBuffer *buffer;
+	FILE *f;
+	bool is_first = true;
+
+	if (!(f = BLI_fopen(filepath, "w"))) {
+		return false;
+	}
+
+	fprintf(f, "{\"traceEvents\":[\n");
+
+	BLI_spin_lock(&g_trace.lock);
+
+	for (buffer = g_trace.buffers; buffer; buffer = buffer->next) {
+		const unsigned int num_kept = MIN2(buffer->num_events, TRACE_RING_SIZE);
+		unsigned int i;
+
+		fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+		        is_first ? "" : ",\n", buffer->thread_id);
+		if (buffer->is_main) {
+			trace_write_string(f, "Main");
+		}
+		else {
+			fprintf(f, "\"Thread %d\"", buffer->thread_id);
+		}
+		fprintf(f, "}}");
+		is_first = false;
+
+		/* oldest event first */
+		for (i = buffer->num_events - num_kept; i < buffer->num_events; i++) {
+			const TraceEvent *event = &buffer->events[i % TRACE_RING_SIZE];
+
+			fprintf(f, ",\n{\"name\":");
+			trace_write_string(f, event->name);
+			fprintf(f, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+			        buffer->thread_id,
+			        (event->start - g_trace.start_time) * 1e6,
+			        (event->end - event->start) * 1e6);
+		}
+	}
+
+	BLI_spin_unlock(&g_trace.lock);
+
+	fprintf(f, "\n]}\n");
+
+	return (fclose(f) == 0);
+}
@@ -38,6 +38,8 @@ typedef struct {
 	
 	char *buf;
 	unsigned int ident, size;
+	/* hash of buf, to find unchanged data which moved */
+	unsigned int hash;
 	
 } MemFileChunk;
 
@@ -52,6 +54,7 @@ extern void memfile_chunk_add(MemFile *compare, MemFile *current, const char *bu
 /* exports */
 extern void BLO_memfile_free(MemFile *memfile);
 extern void BLO_memfile_merge(MemFile *first, MemFile *second);
+extern bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename);
 
 #endif
 
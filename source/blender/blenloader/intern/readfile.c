@@ -45,10 +45,12 @@
 #include "BLI_utildefines.h"
 #ifndef WIN32
 #  include <unistd.h> // for read close
+#  include <sys/mman.h> // for mmap munmap
 #else
 #  include <io.h> // for open close read
 #  include "winsock2.h"
 #  include "BLI_winstuff.h"
+#  include "mmap_win.h"
 #endif
 
 /* allow readfile to use deprecated functionality */
@@ -107,7 +109,9 @@
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
 #include "BLI_threads.h"
+#include "BLI_task.h"
 #include "BLI_mempool.h"
+#include "BLI_ohash.h"
 
 #include "BLT_translation.h"
 
@@ -219,10 +223,11 @@ typedef struct OldNew {
 } OldNew;
 
 typedef struct OldNewMap {
+	/* in insertion order, for the functions going over all entries */
 	OldNew *entries;
 	int nentries, entriessize;
-	int sorted;
-	int lasthit;
+	/* old address -> index in entries */
+	OHash *map;
 } OldNewMap;
 
 
@@ -271,30 +276,28 @@ static OldNewMap *oldnewmap_new(void)
 	
 	onm->entriessize = 1024;
 	onm->entries = MEM_mallocN(sizeof(*onm->entries)*onm->entriessize, "OldNewMap.entries");
+	onm->map = BLI_ohash_new_ex("OldNewMap.map", (unsigned int)onm->entriessize);
 	
 	return onm;
 }
 
-static int verg_oldnewmap(const void *v1, const void *v2)
+/* make room for \a nentries more entries, avoids growing the map while inserting them */
+static void oldnewmap_reserve(OldNewMap *onm, int nentries)
 {
-	const struct OldNew *x1=v1, *x2=v2;
+	nentries += onm->nentries;
 	
-	if (x1->old > x2->old) return 1;
-	else if (x1->old < x2->old) return -1;
-	return 0;
-}
-
-
-static void oldnewmap_sort(FileData *fd) 
-{
-	qsort(fd->libmap->entries, fd->libmap->nentries, sizeof(OldNew), verg_oldnewmap);
-	fd->libmap->sorted = 1;
+	if (nentries > onm->entriessize) {
+		onm->entriessize = nentries;
+		onm->entries = MEM_reallocN(onm->entries, sizeof(*onm->entries) * onm->entriessize);
+	}
+	BLI_ohash_reserve(onm->map, (unsigned int)nentries);
 }
 
 /* nr is zero for data, and ID code for libdata */
 static void oldnewmap_insert(OldNewMap *onm, void *oldaddr, void *newaddr, int nr) 
 {
 	OldNew *entry;
+	void **index_p;
 	
 	if (oldaddr==NULL || newaddr==NULL) return;
 	
@@ -303,6 +306,10 @@ static void oldnewmap_insert(OldNewMap *onm, void *oldaddr, void *newaddr, int n
 		onm->entries = MEM_reallocN(onm->entries, sizeof(*onm->entries) * onm->entriessize);
 	}
 
+	/* when an old address is inserted twice, lookups find the last one */
+	(void)BLI_ohash_ensure_p(onm->map, oldaddr, &index_p);
+	*index_p = SET_INT_IN_POINTER(onm->nentries);
+
 	entry = &onm->entries[onm->nentries++];
 	entry->old = oldaddr;
 	entry->newp = newaddr;
@@ -314,77 +321,27 @@ void blo_do_versions_oldnewmap_insert(OldNewMap *onm, void *oldaddr, void *newad
 	oldnewmap_insert(onm, oldaddr, newaddr, nr);
 }
 
-/**
- * Do a full search (no state).
- *
- * \param lasthit: Use as a reference position to avoid a full search
- * from either end of the array, giving more efficient lookups.
- *
- * \note This would seem an ideal case for hash or btree lookups.
- * However the data is written in-order, using the \a lasthit will normally avoid calling this function.
- * Creating a btree/hash structure adds overhead for the common-case to optimize the corner-case
- * (since most entries will never be retrieved).
- * So just keep full lookups as a fall-back.
- */
-static int oldnewmap_lookup_entry_full(const OldNewMap *onm, const void *addr, int lasthit)
+static OldNew *oldnewmap_lookup_entry(const OldNewMap *onm, const void *addr)
 {
-	const int nentries = onm->nentries;
-	const OldNew *entries = onm->entries;
-	int i;
-
-	/* search relative to lasthit where possible */
-	if (lasthit >= 0 && lasthit < nentries) {
-
-		/* search forwards */
-		i = lasthit;
-		while (++i != nentries) {
-			if (entries[i].old == addr) {
-				return i;
-			}
-		}
-
-		/* search backwards */
-		i = lasthit + 1;
-		while (i--) {
-			if (entries[i].old == addr) {
-				return i;
-			}
-		}
-	}
-	else {
-		/* search backwards (full) */
-		i = nentries;
-		while (i--) {
-			if (entries[i].old == addr) {
-				return i;
-			}
-		}
+	void **index_p = BLI_ohash_lookup_p(onm->map, addr);
+	
+	if (index_p) {
+		OldNew *entry = &onm->entries[GET_INT_FROM_POINTER(*index_p)];
+		BLI_assert(entry->old == addr);
+		return entry;
 	}
-
-	return -1;
+	
+	return NULL;
 }
 
 static void *oldnewmap_lookup_and_inc(OldNewMap *onm, void *addr, bool increase_users) 
 {
-	int i;
+	OldNew *entry;
 	
 	if (addr == NULL) return NULL;
 	
-	if (onm->lasthit < onm->nentries-1) {
-		OldNew *entry = &onm->entries[++onm->lasthit];
-		
-		if (entry->old == addr) {
-			if (increase_users)
-				entry->nr++;
-			return entry->newp;
-		}
-	}
-	
-	i = oldnewmap_lookup_entry_full(onm, addr, onm->lasthit);
-	if (i != -1) {
-		OldNew *entry = &onm->entries[i];
-		BLI_assert(entry->old == addr);
-		onm->lasthit = i;
+	entry = oldnewmap_lookup_entry(onm, addr);
+	if (entry) {
 		if (increase_users)
 			entry->nr++;
 		return entry->newp;
@@ -396,35 +353,18 @@ static void *oldnewmap_lookup_and_inc(OldNewMap *onm, void *addr, bool increase_
 /* for libdata, nr has ID code, no increment */
 static void *oldnewmap_liblookup(OldNewMap *onm, void *addr, void *lib)
 {
+	OldNew *entry;
+	
 	if (addr == NULL) {
 		return NULL;
 	}
 
-	/* lasthit works fine for non-libdata, linking there is done in same sequence as writing */
-	if (onm->sorted) {
-		OldNew entry_s, *entry;
-
-		entry_s.old = addr;
-
-		entry = bsearch(&entry_s, onm->entries, onm->nentries, sizeof(OldNew), verg_oldnewmap);
-		if (entry) {
-			ID *id = entry->newp;
+	entry = oldnewmap_lookup_entry(onm, addr);
+	if (entry) {
+		ID *id = entry->newp;
 
-			if (id && (!lib || id->lib)) {
-				return id;
-			}
-		}
-	}
-	else {
-		/* note, this can be a bottle neck when loading some files */
-		const int i = oldnewmap_lookup_entry_full(onm, addr, -1);
-		if (i != -1) {
-			OldNew *entry = &onm->entries[i];
-			ID *id = entry->newp;
-			BLI_assert(entry->old == addr);
-			if (id && (!lib || id->lib)) {
-				return id;
-			}
+		if (id && (!lib || id->lib)) {
+			return id;
 		}
 	}
 
@@ -447,11 +387,12 @@ static void oldnewmap_free_unused(OldNewMap *onm)
 static void oldnewmap_clear(OldNewMap *onm) 
 {
 	onm->nentries = 0;
-	onm->lasthit = 0;
+	BLI_ohash_clear(onm->map, NULL);
 }
 
 static void oldnewmap_free(OldNewMap *onm) 
 {
+	BLI_ohash_free(onm->map, NULL);
 	MEM_freeN(onm->entries);
 	MEM_freeN(onm);
 }
@@ -770,13 +711,32 @@ static BHeadN *get_bhead(FileData *fd)
 			/* bhead now contains the (converted) bhead structure. Now read
 			 * the associated data and put everything in a BHeadN (creative naming !)
 			 */
-			if (!fd->eof) {
+			if (!fd->eof && fd->mmap_buffer && !(fd->flags & FD_FLAGS_SWITCH_ENDIAN)) {
+				/* data of memory mapped files is used in place, so finding blocks only touches their headers.
+				 * Not when the endianness is switched, that is done in place and the mapping is read-only. */
+				if ((size_t)bhead.len <= fd->mmap_size - fd->mmap_seek) {
+					new_bhead = MEM_mallocN(sizeof(BHeadN), "new_bhead");
+					new_bhead->next = new_bhead->prev = NULL;
+					new_bhead->data_reconstructed = NULL;
+					new_bhead->data = (char *)fd->mmap_buffer + fd->mmap_seek;
+					new_bhead->bhead = bhead;
+
+					fd->mmap_seek += (size_t)bhead.len;
+					fd->seek += bhead.len;
+				}
+				else {
+					fd->eof = 1;
+				}
+			}
+			else if (!fd->eof) {
 				new_bhead = MEM_mallocN(sizeof(BHeadN) + bhead.len, "new_bhead");
 				if (new_bhead) {
 					new_bhead->next = new_bhead->prev = NULL;
+					new_bhead->data_reconstructed = NULL;
+					new_bhead->data = (char *)(new_bhead + 1);
 					new_bhead->bhead = bhead;
 					
-					readsize = fd->read(fd, new_bhead + 1, bhead.len);
+					readsize = fd->read(fd, new_bhead->data, bhead.len);
 					
 					if (readsize != bhead.len) {
 						fd->eof = 1;
@@ -858,7 +818,7 @@ BHead *blo_nextbhead(FileData *fd, BHead *thisblock)
 /* Warning! Caller's responsability to ensure given bhead **is** and ID one! */
 const char *bhead_id_name(const FileData *fd, const BHead *bhead)
 {
-	return (const char *)POINTER_OFFSET(bhead, sizeof(*bhead) + fd->id_name_offs);
+	return (const char *)POINTER_OFFSET(BHEAD_DATA(bhead), fd->id_name_offs);
 }
 
 static void decode_blender_header(FileData *fd)
@@ -911,10 +871,10 @@ static int read_file_dna(FileData *fd)
 		if (bhead->code == DNA1) {
 			const bool do_endian_swap = (fd->flags & FD_FLAGS_SWITCH_ENDIAN) != 0;
 			
-			fd->filesdna = DNA_sdna_from_data(&bhead[1], bhead->len, do_endian_swap);
+			fd->filesdna = DNA_sdna_from_data(BHEAD_DATA(bhead), bhead->len, do_endian_swap);
 			if (fd->filesdna) {
 				fd->compflags = DNA_struct_get_compareflags(fd->filesdna, fd->memsdna);
-				/* used to retrieve ID names from (bhead+1) */
+				/* used to retrieve ID names from the data of ID blocks */
 				fd->id_name_offs = DNA_elem_offset(fd->filesdna, "ID", "char", "name[]");
 			}
 			
@@ -935,7 +895,7 @@ static int *read_file_thumbnail(FileData *fd)
 	for (bhead = blo_firstbhead(fd); bhead; bhead = blo_nextbhead(fd, bhead)) {
 		if (bhead->code == TEST) {
 			const bool do_endian_swap = (fd->flags & FD_FLAGS_SWITCH_ENDIAN) != 0;
-			int *data = (int *)(bhead + 1);
+			int *data = (int *)BHEAD_DATA(bhead);
 
 			if (bhead->len < (2 * sizeof(int))) {
 				break;
@@ -1001,6 +961,19 @@ static int fd_read_from_memory(FileData *filedata, void *buffer, unsigned int si
 	return (readsize);
 }
 
+static int fd_read_from_mmap(FileData *filedata, void *buffer, unsigned int size)
+{
+	/* don't read more bytes then there are available in the mapping,
+	 * offsets are size_t since uncompressed files can be larger than 2GB */
+	const size_t readsize = MIN2((size_t)size, filedata->mmap_size - filedata->mmap_seek);
+	
+	memcpy(buffer, filedata->mmap_buffer + filedata->mmap_seek, readsize);
+	filedata->mmap_seek += readsize;
+	filedata->seek += (int)readsize;
+	
+	return (int)readsize;
+}
+
 static int fd_read_from_memfile(FileData *filedata, void *buffer, unsigned int size)
 {
 	static unsigned int seek = (1<<30);	/* the current position */
@@ -1102,9 +1075,74 @@ static FileData *blo_decode_and_check(FileData *fd, ReportList *reports)
 
 /* cannot be called with relative paths anymore! */
 /* on each new library added, it now checks for the current FileData and expands relativeness */
+/**
+ * Map an uncompressed file into memory, so blocks are copied straight from the page cache
+ * instead of going through zlib's buffer and a read call for every block.
+ *
+ * \return NULL when the file is compressed or can't be mapped, the caller then falls back to #BLI_gzopen.
+ */
+static FileData *blo_openblenderfile_mmap(const char *filepath)
+{
+	FileData *fd = NULL;
+	unsigned char magic[2];
+	size_t size;
+	void *mem;
+	int file;
+
+	file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+	if (file == -1) {
+		return NULL;
+	}
+
+	size = BLI_file_descriptor_size(file);
+
+	/* gzip files start with 0x1f 0x8b, those are read through zlib */
+	if ((size == (size_t)-1) || (size < sizeof(magic)) ||
+#ifdef WIN32
+	    /* mmap_win passes the size as a 32 bit DWORD */
+	    (size > UINT_MAX) ||
+#endif
+	    (read(file, magic, sizeof(magic)) != sizeof(magic)) ||
+	    (magic[0] == 0x1f && magic[1] == 0x8b))
+	{
+		close(file);
+		return NULL;
+	}
+
+	mem = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+	/* the mapping stays valid after closing the file */
+	close(file);
+
+	if (mem == MAP_FAILED || mem == NULL) {
+		return NULL;
+	}
+
+#ifdef MADV_SEQUENTIAL
+	/* blocks are read front to back, let the kernel read ahead */
+	madvise(mem, size, MADV_SEQUENTIAL);
+#endif
+
+	fd = filedata_new();
+	fd->mmap_buffer = mem;
+	fd->mmap_size = size;
+	fd->read = fd_read_from_mmap;
+
+	return fd;
+}
+
 FileData *blo_openblenderfile(const char *filepath, ReportList *reports)
 {
 	gzFile gzfile;
+	FileData *fd;
+
+	fd = blo_openblenderfile_mmap(filepath);
+	if (fd) {
+		/* needed for library_append and read_libraries */
+		BLI_strncpy(fd->relabase, filepath, sizeof(fd->relabase));
+
+		return blo_decode_and_check(fd, reports);
+	}
+
 	errno = 0;
 	gzfile = BLI_gzopen(filepath, "rb");
 	
@@ -1114,7 +1152,7 @@ FileData *blo_openblenderfile(const char *filepath, ReportList *reports)
 		return NULL;
 	}
 	else {
-		FileData *fd = filedata_new();
+		fd = filedata_new();
 		fd->gzfiledes = gzfile;
 		fd->read = fd_read_gzip_from_file;
 		
@@ -1242,6 +1280,8 @@ FileData *blo_openblendermemfile(MemFile *memfile, ReportList *reports)
 void blo_freefiledata(FileData *fd)
 {
 	if (fd) {
+		BHeadN *bheadn;
+
 		if (fd->filedes != -1) {
 			close(fd->filedes);
 		}
@@ -1261,7 +1301,12 @@ void blo_freefiledata(FileData *fd)
 			fd->buffer = NULL;
 		}
 		
-		// Free all BHeadN data blocks
+		// Free all BHeadN data blocks, and the reconstructed data nobody took
+		for (bheadn = fd->listbase.first; bheadn; bheadn = bheadn->next) {
+			if (bheadn->data_reconstructed) {
+				MEM_freeN(bheadn->data_reconstructed);
+			}
+		}
 		BLI_freelistN(&fd->listbase);
 		
 		if (fd->memsdna)
@@ -1294,6 +1339,12 @@ void blo_freefiledata(FileData *fd)
 		}
 #endif
 
+		/* last, block data and the file SDNA may point into it */
+		if (fd->mmap_buffer) {
+			munmap((void *)fd->mmap_buffer, fd->mmap_size);
+			fd->mmap_buffer = NULL;
+		}
+
 		MEM_freeN(fd);
 	}
 }
@@ -1418,31 +1469,6 @@ static void *newdataadr(FileData *fd, void *adr)		/* only direct databocks */
 	return oldnewmap_lookup_and_inc(fd->datamap, adr, true);
 }
 
-/* This is a special version of newdataadr() which allows us to keep lasthit of
- * map unchanged. In certain cases this makes file loading time significantly
- * faster.
- *
- * Use this function in cases like restoring pointer from one list element to
- * another list element, but keep lasthit value so we can continue restoring
- * pointers efficiently.
- *
- * Example of this could be found in direct_link_fcurves() which restores the
- * fcurve group pointer and keeps lasthit optimal for linking all further
- * fcurves.
- */
-static void *newdataadr_ex(FileData *fd, void *adr, bool increase_lasthit)		/* only direct databocks */
-{
-	if (increase_lasthit) {
-		return newdataadr(fd, adr);
-	}
-	else {
-		int lasthit = fd->datamap->lasthit;
-		void *newadr = newdataadr(fd, adr);
-		fd->datamap->lasthit = lasthit;
-		return newadr;
-	}
-}
-
 static void *newdataadr_no_us(FileData *fd, void *adr)		/* only direct databocks */
 {
 	return oldnewmap_lookup_and_inc(fd->datamap, adr, false);
@@ -1827,7 +1853,7 @@ static void switch_endian_structs(struct SDNA *filesdna, BHead *bhead)
 	int blocksize, nblocks;
 	char *data;
 	
-	data = (char *)(bhead+1);
+	data = BHEAD_DATA(bhead);
 	blocksize = filesdna->typelens[ filesdna->structs[bhead->SDNAnr][0] ];
 	
 	nblocks = bhead->nr;
@@ -1843,17 +1869,26 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 	void *temp = NULL;
 	
 	if (bh->len) {
+		BHeadN *bheadn = BHEADN_FROM_BHEAD(bh);
+
+		/* already done by read_structs_reconstruct_threaded */
+		if (bheadn->data_reconstructed) {
+			temp = bheadn->data_reconstructed;
+			bheadn->data_reconstructed = NULL;
+			return temp;
+		}
+
 		/* switch is based on file dna */
 		if (bh->SDNAnr && (fd->flags & FD_FLAGS_SWITCH_ENDIAN))
 			switch_endian_structs(fd->filesdna, bh);
 		
 		if (fd->compflags[bh->SDNAnr]) {	/* flag==0: doesn't exist anymore */
 			if (fd->compflags[bh->SDNAnr] == 2) {
-				temp = DNA_struct_reconstruct(fd->memsdna, fd->filesdna, fd->compflags, bh->SDNAnr, bh->nr, (bh+1));
+				temp = DNA_struct_reconstruct(fd->memsdna, fd->filesdna, fd->compflags, bh->SDNAnr, bh->nr, BHEAD_DATA(bh));
 			}
 			else {
 				temp = MEM_mallocN(bh->len, blockname);
-				memcpy(temp, (bh+1), bh->len);
+				memcpy(temp, BHEAD_DATA(bh), bh->len);
 			}
 		}
 	}
@@ -1861,6 +1896,58 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 	return temp;
 }
 
+typedef struct ReconstructStructsData {
+	FileData *fd;
+	BHeadN **bheads;
+} ReconstructStructsData;
+
+static void read_structs_reconstruct_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	ReconstructStructsData *data = userdata;
+	BHeadN *bheadn = data->bheads[i];
+
+	bheadn->data_reconstructed = read_struct(data->fd, &bheadn->bhead, "reconstruct");
+}
+
+/**
+ * Files written with another DNA need every changed struct converted with #DNA_struct_reconstruct,
+ * which is what makes opening old files slow. The conversion of a block only depends on the two SDNA's,
+ * so do it for all data blocks at once with multiple threads, #read_struct then hands out the result.
+ *
+ * Linking the data (direct_link_*, do_versions) stays serial, it goes through the shared old-new maps.
+ */
+static void read_structs_reconstruct_threaded(FileData *fd)
+{
+	ReconstructStructsData data;
+	BHeadN **bheads = NULL;
+	BHead *bhead;
+	int bheads_len = 0, bheads_alloc = 0;
+
+	for (bhead = blo_firstbhead(fd); bhead; bhead = blo_nextbhead(fd, bhead)) {
+		if ((bhead->code == DATA) && bhead->len && (fd->compflags[bhead->SDNAnr] == 2)) {
+			if (bheads_len == bheads_alloc) {
+				bheads_alloc = bheads_alloc ? bheads_alloc * 2 : 1024;
+				bheads = MEM_reallocN(bheads, sizeof(*bheads) * (size_t)bheads_alloc);
+			}
+			bheads[bheads_len++] = BHEADN_FROM_BHEAD(bhead);
+		}
+		else if (bhead->code == ENDB) {
+			break;
+		}
+	}
+
+	if (bheads) {
+		data.fd = fd;
+		data.bheads = bheads;
+
+		/* block sizes differ a lot, use dynamic scheduling */
+		BLI_task_parallel_range_ex(0, bheads_len, &data, NULL, 0, read_structs_reconstruct_cb,
+		                           bheads_len > 64, true);
+
+		MEM_freeN(bheads);
+	}
+}
+
 typedef void (*link_list_cb)(FileData *fd, void *data);
 
 static void link_list_ex(FileData *fd, ListBase *lb, link_list_cb callback)		/* only direct data */
@@ -2419,7 +2506,7 @@ static void direct_link_fcurves(FileData *fd, ListBase *list)
 		fcu->rna_path = newdataadr(fd, fcu->rna_path);
 		
 		/* group */
-		fcu->grp = newdataadr_ex(fd, fcu->grp, false);
+		fcu->grp = newdataadr(fd, fcu->grp);
 		
 		/* clear disabled flag - allows disabled drivers to be tried again ([#32155]),
 		 * but also means that another method for "reviving disabled F-Curves" exists
@@ -2434,6 +2521,7 @@ static void direct_link_fcurves(FileData *fd, ListBase *list)
 			
 			/* compiled expression data will need to be regenerated (old pointer may still be set here) */
 			driver->expr_comp = NULL;
+			driver->expr_simple = NULL;
 			
 			/* give the driver a fresh chance - the operating environment may be different now 
 			 * (addons, etc. may be different) so the driver namespace may be sane now [#32155]
@@ -4935,6 +5023,7 @@ static void direct_link_modifiers(FileData *fd, ListBase *lb)
 	
 	for (md=lb->first; md; md=md->next) {
 		md->error = NULL;
+		md->stack_cache = NULL;
 		md->scene = NULL;
 		
 		/* if modifiers disappear, or for upward compatibility */
@@ -7811,8 +7900,17 @@ static const char *dataname(short id_code)
 
 static BHead *read_data_into_oldnewmap(FileData *fd, BHead *bhead, const char *allocname)
 {
+	BHead *bhead_iter;
+	int data_len = 0;
+	
 	bhead = blo_nextbhead(fd, bhead);
 	
+	/* size the map up front instead of growing it while inserting */
+	for (bhead_iter = bhead; bhead_iter && bhead_iter->code == DATA; bhead_iter = blo_nextbhead(fd, bhead_iter)) {
+		data_len++;
+	}
+	oldnewmap_reserve(fd->datamap, data_len);
+	
 	while (bhead && bhead->code==DATA) {
 		void *data;
 #if 0
@@ -8197,8 +8295,6 @@ static void do_versions_after_linking(FileData *fd, Library *lib, Main *main)
 
 static void lib_link_all(FileData *fd, Main *main)
 {
-	oldnewmap_sort(fd);
-	
 	/* No load UI for undo memfiles */
 	if (fd->memfile == NULL) {
 		lib_link_windowmanager(fd, main);
@@ -8349,6 +8445,11 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 		}
 	}
 
+	/* undo files are always written with the current DNA */
+	if (fd->memfile == NULL) {
+		read_structs_reconstruct_threaded(fd);
+	}
+
 	while (bhead) {
 		switch (bhead->code) {
 		case DATA:
@@ -58,6 +58,10 @@ typedef struct FileData {
 	// variables needed for reading from memfile (undo)
 	struct MemFile *memfile;
 
+	// variables needed for reading from a memory mapped (uncompressed) file
+	const char *mmap_buffer;
+	size_t mmap_size, mmap_seek;
+
 	// variables needed for reading from file
 	int filedes;
 	gzFile gzfiledes;
@@ -107,9 +111,17 @@ typedef struct FileData {
 
 typedef struct BHeadN {
 	struct BHeadN *next, *prev;
+	/* data already reconstructed by read_structs_reconstruct_threaded, handed out by read_struct */
+	void *data_reconstructed;
+	/* the block data, following bhead or in the memory mapped file */
+	char *data;
 	struct BHead bhead;
 } BHeadN;
 
+#define BHEADN_FROM_BHEAD(bh) ((BHeadN *)POINTER_OFFSET(bh, -offsetof(BHeadN, bhead)))
+/* use instead of (bhead + 1) */
+#define BHEAD_DATA(bh) (BHEADN_FROM_BHEAD(bh)->data)
+
 
 #define FD_FLAGS_SWITCH_ENDIAN             (1 << 0)
 #define FD_FLAGS_FILE_POINTSIZE_IS_4       (1 << 1)
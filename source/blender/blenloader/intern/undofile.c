@@ -30,16 +30,32 @@
  *  \ingroup blenloader
  */
 
+#ifndef _GNU_SOURCE
+/* Needed for O_NOFOLLOW on some platforms. */
+#  define _GNU_SOURCE 1
+#endif
+
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <math.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#ifndef _WIN32
+#  include <unistd.h>
+#else
+#  include <io.h>
+#endif
 
 #include "MEM_guardedalloc.h"
 
 #include "DNA_listBase.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_utildefines.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_ohash.h"
 
 #include "BLO_undofile.h"
 
@@ -63,20 +79,31 @@ void BLO_memfile_free(MemFile *memfile)
 void BLO_memfile_merge(MemFile *first, MemFile *second)
 {
 	MemFileChunk *fc, *sc;
+	OHash *shared = BLI_ohash_new(__func__);
+	
+	/* chunks of 'second' can share data with any chunk of 'first' (see memfile_chunk_add),
+	 * one of them takes over the ownership of the data */
+	for (sc = second->chunks.first; sc; sc = sc->next) {
+		if (sc->ident) {
+			void **sc_p;
+			if (!BLI_ohash_ensure_p(shared, sc->buf, &sc_p)) {
+				*sc_p = sc;
+			}
+		}
+	}
 	
-	fc = first->chunks.first;
-	sc = second->chunks.first;
-	while (fc || sc) {
-		if (fc && sc) {
-			if (sc->ident) {
+	for (fc = first->chunks.first; fc; fc = fc->next) {
+		if (fc->ident == 0) {
+			sc = BLI_ohash_lookup(shared, fc->buf);
+			if (sc) {
 				sc->ident = 0;
 				fc->ident = 1;
 			}
 		}
-		if (fc) fc = fc->next;
-		if (sc) sc = sc->next;
 	}
 	
+	BLI_ohash_free(shared, NULL);
+	
 	BLO_memfile_free(first);
 }
 
@@ -94,18 +121,47 @@ static int my_memcmp(const int *mem1, const int *mem2, const int len)
 	return 0;
 }
 
+/* the memfile being compared with while writing, see memfile_chunk_add */
+static MemFileChunk *compchunk = NULL;
+/* content hash -> chunk of the compare memfile */
+static OHash *compchunk_hash = NULL;
+
+static void memfile_compare_begin(MemFile *compare)
+{
+	MemFileChunk *chunk;
+	
+	compchunk = compare->chunks.first;
+	compchunk_hash = BLI_ohash_new_ex(__func__, (unsigned int)BLI_listbase_count(&compare->chunks));
+	
+	for (chunk = compare->chunks.first; chunk; chunk = chunk->next) {
+		void **chunk_p;
+		if (!BLI_ohash_ensure_p(compchunk_hash, SET_UINT_IN_POINTER(chunk->hash), &chunk_p)) {
+			*chunk_p = chunk;
+		}
+	}
+}
+
+static void memfile_compare_end(void)
+{
+	compchunk = NULL;
+	if (compchunk_hash) {
+		BLI_ohash_free(compchunk_hash, NULL);
+		compchunk_hash = NULL;
+	}
+}
+
 void memfile_chunk_add(MemFile *compare, MemFile *current, const char *buf, unsigned int size)
 {
-	static MemFileChunk *compchunk = NULL;
 	MemFileChunk *curchunk;
 	
 	/* this function inits when compare != NULL or when current == NULL  */
 	if (compare) {
-		compchunk = compare->chunks.first;
+		memfile_compare_end();
+		memfile_compare_begin(compare);
 		return;
 	}
 	if (current == NULL) {
-		compchunk = NULL;
+		memfile_compare_end();
 		return;
 	}
 	
@@ -115,17 +171,34 @@ void memfile_chunk_add(MemFile *compare, MemFile *current, const char *buf, unsi
 	curchunk->ident = 0;
 	BLI_addtail(&current->chunks, curchunk);
 	
-	/* we compare compchunk with buf */
+	/* we compare compchunk with buf, this finds data unchanged since the last write */
 	if (compchunk) {
 		if (compchunk->size == curchunk->size) {
 			if (my_memcmp((int *)compchunk->buf, (const int *)buf, size / 4) == 0) {
 				curchunk->buf = compchunk->buf;
+				curchunk->hash = compchunk->hash;
 				curchunk->ident = 1;
 			}
 		}
 		compchunk = compchunk->next;
 	}
 	
+	if (curchunk->buf == NULL) {
+		curchunk->hash = BLI_hash_mm2((const unsigned char *)buf, size, 0);
+		
+		/* the data may be unchanged but moved, when data before it was added, removed or reordered,
+		 * look it up by its content and continue comparing in order from there */
+		if (compchunk_hash) {
+			MemFileChunk *chunk = BLI_ohash_lookup(compchunk_hash, SET_UINT_IN_POINTER(curchunk->hash));
+			
+			if (chunk && (chunk->size == size) && (memcmp(chunk->buf, buf, size) == 0)) {
+				curchunk->buf = chunk->buf;
+				curchunk->ident = 1;
+				compchunk = chunk->next;
+			}
+		}
+	}
+	
 	/* not equal... */
 	if (curchunk->buf == NULL) {
 		curchunk->buf = MEM_mallocN(size, "Chunk buffer");
@@ -134,3 +207,48 @@ void memfile_chunk_add(MemFile *compare, MemFile *current, const char *buf, unsi
 	}
 }
 
+/**
+ * Write \a memfile to \a filename, it only reads the memfile,
+ * so this can run in another thread while the memfile isn't freed.
+ *
+ * \note This is currently used for autosave and 'quit.blend', where _not_ following symlinks is OK,
+ * however if this is ever executed explicitly by the user, we may want to allow writing to symlinks.
+ */
+bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename)
+{
+	MemFileChunk *chunk;
+	int file, oflags;
+
+	oflags = O_BINARY | O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_NOFOLLOW
+	/* use O_NOFOLLOW to avoid writing to a symlink - use 'O_EXCL' (CVE-2008-1103) */
+	oflags |= O_NOFOLLOW;
+#else
+	/* TODO(sergey): How to deal with symlinks on windows? */
+#  ifndef _MSC_VER
+#    warning "Symbolic links will be followed on undo save, possibly causing CVE-2008-1103"
+#  endif
+#endif
+	file = BLI_open(filename,  oflags, 0666);
+
+	if (file == -1) {
+		fprintf(stderr, "Unable to save '%s': %s\n",
+		        filename, errno ? strerror(errno) : "Unknown error opening file");
+		return false;
+	}
+
+	for (chunk = memfile->chunks.first; chunk; chunk = chunk->next) {
+		if (write(file, chunk->buf, chunk->size) != chunk->size) {
+			break;
+		}
+	}
+	
+	close(file);
+	
+	if (chunk) {
+		fprintf(stderr, "Unable to save '%s': %s\n",
+		        filename, errno ? strerror(errno) : "Unknown error writing file");
+		return false;
+	}
+	return true;
+}
@@ -1050,4 +1050,30 @@ void blo_do_versions_270(FileData *fd, Library *UNUSED(lib), Main *main)
 			}
 		}
 	}
+
+	{
+		if (!DNA_struct_elem_find(fd->filesdna, "SubsurfModifierData", "float", "dicing_rate")) {
+			for (Object *ob = main->object.first; ob; ob = ob->id.next) {
+				for (ModifierData *md = ob->modifiers.first; md; md = md->next) {
+					if (md->type == eModifierType_Subsurf) {
+						SubsurfModifierData *smd = (SubsurfModifierData *)md;
+						smd->dicing_rate = 1.0f;
+					}
+				}
+			}
+		}
+
+		if (!DNA_struct_elem_find(fd->filesdna, "BooleanModifierData", "char", "solver")) {
+			for (Object *ob = main->object.first; ob; ob = ob->id.next) {
+				for (ModifierData *md = ob->modifiers.first; md; md = md->next) {
+					if (md->type == eModifierType_Boolean) {
+						BooleanModifierData *bmd = (BooleanModifierData *)md;
+						bmd->solver = (bmd->bm_flag & eBooleanModifierBMeshFlag_Enabled) ?
+						              eBooleanModifierSolver_BMesh : eBooleanModifierSolver_Carve;
+						bmd->bm_flag &= ~eBooleanModifierBMeshFlag_Enabled;
+					}
+				}
+			}
+		}
+	}
 }
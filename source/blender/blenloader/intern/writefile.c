@@ -143,6 +143,8 @@
 #include "BLI_blenlib.h"
 #include "BLI_linklist.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "BKE_action.h"
 #include "BKE_blender.h"
@@ -189,6 +191,7 @@
 typedef enum {
 	WW_WRAP_NONE = 1,
 	WW_WRAP_ZLIB,
+	WW_WRAP_ZLIB_THREADED,
 } eWriteWrapType;
 
 typedef struct WriteWrap WriteWrap;
@@ -202,6 +205,7 @@ struct WriteWrap {
 	union {
 		int file_handle;
 		gzFile gz_handle;
+		struct ZlibThreaded *zlib_threaded;
 	} _user_data;
 };
 
@@ -229,7 +233,18 @@ static bool ww_close_none(WriteWrap *ww)
 }
 static size_t ww_write_none(WriteWrap *ww, const char *buf, size_t buf_len)
 {
-	return write(FILE_HANDLE(ww), buf, buf_len);
+	size_t buf_done = 0;
+
+	/* write() may write less than asked for (large arrays are written in one go), continue with the rest */
+	while (buf_done != buf_len) {
+		const ssize_t len = write(FILE_HANDLE(ww), buf + buf_done, MIN2(buf_len - buf_done, (size_t)INT_MAX));
+		if (len <= 0) {
+			break;
+		}
+		buf_done += (size_t)len;
+	}
+
+	return buf_done;
 }
 #undef FILE_HANDLE
 
@@ -261,6 +276,192 @@ static size_t ww_write_zlib(WriteWrap *ww, const char *buf, size_t buf_len)
 }
 #undef FILE_HANDLE
 
+/* zlib, compressing blocks with multiple threads
+ *
+ * Every block is compressed into a gzip member of its own.
+ * Concatenated members are a valid gzip file, which gzread reads as one stream,
+ * so these files open with the regular gzip reader (and older versions of Blender). */
+
+#define WW_ZLIB_BLOCK_SIZE (1 << 20)
+
+typedef struct ZlibBlock {
+	struct ZlibThreaded *zt;
+	char *in, *out;
+	size_t in_len, out_len, out_size;
+	bool done, error;
+} ZlibBlock;
+
+typedef struct ZlibThreaded {
+	int file_handle;
+	TaskPool *pool;
+	ThreadMutex mutex;
+	ThreadCondition cond;
+
+	/* ring of blocks, the blocks_busy blocks from block_first on are being compressed or
+	 * wait to be written, the block after them is being filled */
+	ZlibBlock *blocks;
+	int blocks_len;
+	int block_first, blocks_busy;
+	bool error;
+} ZlibThreaded;
+
+#define FILE_HANDLE(ww) \
+	(ww)->_user_data.zlib_threaded
+
+static void ww_zlib_threaded_compress_task(TaskPool *__restrict UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	ZlibBlock *block = taskdata;
+	ZlibThreaded *zt = block->zt;
+	z_stream strm = {NULL};
+	bool error = true;
+
+	/* window bits + 16 writes a gzip header and trailer, level 1 as for ww_open_zlib */
+	if (deflateInit2(&strm, 1, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK) {
+		const size_t out_size = deflateBound(&strm, (uLong)block->in_len);
+
+		if (block->out_size < out_size) {
+			MEM_SAFE_FREE(block->out);
+			block->out = MEM_mallocN(out_size, __func__);
+			block->out_size = out_size;
+		}
+
+		strm.next_in = (Bytef *)block->in;
+		strm.avail_in = (uInt)block->in_len;
+		strm.next_out = (Bytef *)block->out;
+		strm.avail_out = (uInt)block->out_size;
+
+		if (deflate(&strm, Z_FINISH) == Z_STREAM_END) {
+			block->out_len = strm.total_out;
+			error = false;
+		}
+		deflateEnd(&strm);
+	}
+
+	BLI_mutex_lock(&zt->mutex);
+	block->error = error;
+	block->done = true;
+	BLI_condition_notify_all(&zt->cond);
+	BLI_mutex_unlock(&zt->mutex);
+}
+
+/* wait for the oldest block to be compressed and write it */
+static void ww_zlib_threaded_write_first(ZlibThreaded *zt)
+{
+	ZlibBlock *block = &zt->blocks[zt->block_first];
+
+	BLI_mutex_lock(&zt->mutex);
+	while (!block->done) {
+		BLI_condition_wait(&zt->cond, &zt->mutex);
+	}
+	BLI_mutex_unlock(&zt->mutex);
+
+	if (block->error || (write(zt->file_handle, block->out, block->out_len) != block->out_len)) {
+		zt->error = true;
+	}
+
+	block->in_len = 0;
+	block->done = false;
+	zt->block_first = (zt->block_first + 1) % zt->blocks_len;
+	zt->blocks_busy--;
+}
+
+static ZlibBlock *ww_zlib_threaded_block_fill(ZlibThreaded *zt)
+{
+	return &zt->blocks[(zt->block_first + zt->blocks_busy) % zt->blocks_len];
+}
+
+static void ww_zlib_threaded_block_push(ZlibThreaded *zt)
+{
+	BLI_task_pool_push(zt->pool, ww_zlib_threaded_compress_task, ww_zlib_threaded_block_fill(zt),
+	                   false, TASK_PRIORITY_HIGH);
+	zt->blocks_busy++;
+
+	/* make room for the next block */
+	if (zt->blocks_busy == zt->blocks_len) {
+		ww_zlib_threaded_write_first(zt);
+	}
+}
+
+static bool ww_open_zlib_threaded(WriteWrap *ww, const char *filepath)
+{
+	TaskScheduler *scheduler = BLI_task_scheduler_get();
+	ZlibThreaded *zt;
+	int file, i;
+
+	file = BLI_open(filepath, O_BINARY + O_WRONLY + O_CREAT + O_TRUNC, 0666);
+
+	if (file == -1) {
+		return false;
+	}
+
+	zt = MEM_callocN(sizeof(*zt), __func__);
+	zt->file_handle = file;
+	zt->pool = BLI_task_pool_create(scheduler, NULL);
+	BLI_mutex_init(&zt->mutex);
+	BLI_condition_init(&zt->cond);
+
+	/* enough blocks to keep all threads busy while the oldest one is written */
+	zt->blocks_len = (BLI_task_scheduler_num_threads(scheduler) + 1) * 2;
+	zt->blocks = MEM_callocN(sizeof(*zt->blocks) * (size_t)zt->blocks_len, __func__);
+	for (i = 0; i < zt->blocks_len; i++) {
+		zt->blocks[i].zt = zt;
+		zt->blocks[i].in = MEM_mallocN(WW_ZLIB_BLOCK_SIZE, __func__);
+	}
+
+	FILE_HANDLE(ww) = zt;
+	return true;
+}
+static bool ww_close_zlib_threaded(WriteWrap *ww)
+{
+	ZlibThreaded *zt = FILE_HANDLE(ww);
+	bool ok;
+	int i;
+
+	if (ww_zlib_threaded_block_fill(zt)->in_len) {
+		ww_zlib_threaded_block_push(zt);
+	}
+	while (zt->blocks_busy) {
+		ww_zlib_threaded_write_first(zt);
+	}
+
+	BLI_task_pool_work_and_wait(zt->pool);
+	BLI_task_pool_free(zt->pool);
+	BLI_condition_end(&zt->cond);
+	BLI_mutex_end(&zt->mutex);
+
+	for (i = 0; i < zt->blocks_len; i++) {
+		MEM_freeN(zt->blocks[i].in);
+		MEM_SAFE_FREE(zt->blocks[i].out);
+	}
+	MEM_freeN(zt->blocks);
+
+	ok = (close(zt->file_handle) != -1) && !zt->error;
+	MEM_freeN(zt);
+
+	return ok;
+}
+static size_t ww_write_zlib_threaded(WriteWrap *ww, const char *buf, size_t buf_len)
+{
+	ZlibThreaded *zt = FILE_HANDLE(ww);
+	size_t buf_done = 0;
+
+	while (buf_done != buf_len) {
+		ZlibBlock *block = ww_zlib_threaded_block_fill(zt);
+		const size_t len = MIN2(buf_len - buf_done, WW_ZLIB_BLOCK_SIZE - block->in_len);
+
+		memcpy(block->in + block->in_len, buf + buf_done, len);
+		block->in_len += len;
+		buf_done += len;
+
+		if (block->in_len == WW_ZLIB_BLOCK_SIZE) {
+			ww_zlib_threaded_block_push(zt);
+		}
+	}
+
+	return zt->error ? 0 : buf_len;
+}
+#undef FILE_HANDLE
+
 /* --- end compression types --- */
 
 static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
@@ -275,6 +476,13 @@ static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
 			r_ww->write = ww_write_zlib;
 			break;
 		}
+		case WW_WRAP_ZLIB_THREADED:
+		{
+			r_ww->open  = ww_open_zlib_threaded;
+			r_ww->close = ww_close_zlib_threaded;
+			r_ww->write = ww_write_zlib_threaded;
+			break;
+		}
 		default:
 		{
 			r_ww->open  = ww_open_none;
@@ -377,19 +585,25 @@ static void mywrite(WriteData *wd, const void *adr, int len)
 	wd->tot+= len;
 	
 	/* if we have a single big chunk, write existing data in
-	 * buffer and write out big chunk in smaller pieces */
+	 * buffer and write out big chunk straight from its memory */
 	if (len>MYWRITE_MAX_CHUNK) {
 		if (wd->count) {
 			writedata_do_write(wd, wd->buf, wd->count);
 			wd->count= 0;
 		}
 
-		do {
-			int writelen= MIN2(len, MYWRITE_MAX_CHUNK);
-			writedata_do_write(wd, adr, writelen);
-			adr = (const char *)adr + writelen;
-			len -= writelen;
-		} while (len > 0);
+		/* undo compares memfiles by chunk, keep those small so a change only duplicates a part of the array */
+		if (wd->current) {
+			do {
+				int writelen= MIN2(len, MYWRITE_MAX_CHUNK);
+				writedata_do_write(wd, adr, writelen);
+				adr = (const char *)adr + writelen;
+				len -= writelen;
+			} while (len > 0);
+		}
+		else {
+			writedata_do_write(wd, adr, len);
+		}
 
 		return;
 	}
@@ -441,6 +655,11 @@ static int endwrite(WriteData *wd)
 		wd->count= 0;
 	}
 	
+	/* this ends comparing */
+	if (wd->current) {
+		memfile_chunk_add(NULL, NULL, NULL, 0);
+	}
+	
 	err= wd->error;
 	writedata_free(wd);
 
@@ -472,6 +691,12 @@ static void writestruct_at_address(WriteData *wd, int filecode, const char *stru
 
 	if (bh.len==0) return;
 
+	/* for undo, start every ID in a new chunk so its chunks stay the same
+	 * when the data written before it changes size (see memfile_chunk_add) */
+	if (wd->current && (filecode != DATA)) {
+		mywrite(wd, MYWRITE_FLUSH, 0);
+	}
+
 	mywrite(wd, &bh, sizeof(BHead));
 	mywrite(wd, data, bh.len);
 }
@@ -3838,7 +4063,7 @@ int BLO_write_file(
 	BLI_snprintf(tempname, sizeof(tempname), "%s@", filepath);
 
 	if (write_flags & G_FILE_COMPRESS) {
-		ww_type = WW_WRAP_ZLIB;
+		ww_type = (BLI_system_thread_count() > 1) ? WW_WRAP_ZLIB_THREADED : WW_WRAP_ZLIB;
 	}
 	else {
 		ww_type = WW_WRAP_NONE;
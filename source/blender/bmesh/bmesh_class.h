@@ -384,7 +384,7 @@ typedef bool (*BMLoopFilterFunc)(const BMLoop *, void *user_data);
 #define BM_LOOP_RADIAL_MAX 10000
 #define BM_NGON_MAX 100000
 
-/* setting zero so we can catch bugs in OpenMP/BMesh */
+/* setting zero so we can catch threading bugs in BMesh */
 #ifdef DEBUG
 #  define BM_OMP_LIMIT 0
 #else
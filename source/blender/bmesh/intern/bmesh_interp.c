@@ -165,6 +165,9 @@ void BM_data_interp_face_vert_edge(
 	} while ((l_iter = l_iter->radial_next) != e->l);
 }
 
+/* upper bound of the weights (source times destination loops) interpolated in one batch */
+#define BM_FACE_INTERP_CHUNK_WEIGHTS 4096
+
 /**
  * \brief Data Interp From Face
  *
@@ -177,10 +180,14 @@ void BM_face_interp_from_face_ex(
         BMesh *bm, BMFace *f_dst, const BMFace *f_src, const bool do_vertex,
         const void **blocks_l, const void **blocks_v, float (*cos_2d)[2], float axis_mat[3][3])
 {
+	/* interpolate the loops in chunks, bounding the size of the weight array for large faces */
+	const int chunk_len = min_ii(f_dst->len, max_ii(1, BM_FACE_INTERP_CHUNK_WEIGHTS / f_src->len));
 	BMLoop *l_iter;
 	BMLoop *l_first;
 
-	float *w = BLI_array_alloca(w, f_src->len);
+	float *w = BLI_array_alloca(w, f_src->len * chunk_len);
+	void **blocks_l_dst = BLI_array_alloca(blocks_l_dst, chunk_len);
+	void **blocks_v_dst = do_vertex ? BLI_array_alloca(blocks_v_dst, chunk_len) : NULL;
 	float co[2];
 	int i;
 
@@ -192,12 +199,20 @@ void BM_face_interp_from_face_ex(
 	l_iter = l_first = BM_FACE_FIRST_LOOP(f_dst);
 	do {
 		mul_v2_m3v3(co, axis_mat, l_iter->v->co);
-		interp_weights_poly_v2(w, cos_2d, f_src->len, co);
-		CustomData_bmesh_interp(&bm->ldata, blocks_l, w, NULL, f_src->len, l_iter->head.data);
+		interp_weights_poly_v2(&w[i * f_src->len], cos_2d, f_src->len, co);
+		blocks_l_dst[i] = l_iter->head.data;
 		if (do_vertex) {
-			CustomData_bmesh_interp(&bm->vdata, blocks_v, w, NULL, f_src->len, l_iter->v->head.data);
+			blocks_v_dst[i] = l_iter->v->head.data;
 		}
-	} while (i++, (l_iter = l_iter->next) != l_first);
+
+		if (++i == chunk_len || l_iter->next == l_first) {
+			CustomData_bmesh_interp_array(&bm->ldata, blocks_l, w, f_src->len, blocks_l_dst, i);
+			if (do_vertex) {
+				CustomData_bmesh_interp_array(&bm->vdata, blocks_v, w, f_src->len, blocks_v_dst, i);
+			}
+			i = 0;
+		}
+	} while ((l_iter = l_iter->next) != l_first);
 }
 
 void BM_face_interp_from_face(BMesh *bm, BMFace *f_dst, const BMFace *f_src, const bool do_vertex)
@@ -30,6 +30,7 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "bmesh.h"
@@ -315,6 +316,35 @@ int BM_iter_mesh_count_flag(const char itype, BMesh *bm, const char hflag, const
 	return count;
 }
 
+/**
+ * \brief Parallel Iterator
+ *
+ * Calls \a func for every element of the mesh, using threads when \a use_threading is set.
+ * Only the iterators over all elements of the mesh are supported,
+ * since they are the only ones going over contiguous storage (the mempool chunks).
+ *
+ * \note \a func must only write to the element it's given, the order of the calls is undefined.
+ */
+void BM_iter_parallel(
+        BMesh *bm, const char itype, TaskParallelMempoolFunc func, void *userdata,
+        const bool use_threading)
+{
+	switch (itype) {
+		case BM_VERTS_OF_MESH:
+			BLI_task_parallel_mempool(bm->vpool, userdata, func, use_threading);
+			break;
+		case BM_EDGES_OF_MESH:
+			BLI_task_parallel_mempool(bm->epool, userdata, func, use_threading);
+			break;
+		case BM_FACES_OF_MESH:
+			BLI_task_parallel_mempool(bm->fpool, userdata, func, use_threading);
+			break;
+		default:
+			BLI_assert(0);
+			break;
+	}
+}
+
 /**
  * Notes on iterator implementation:
  *
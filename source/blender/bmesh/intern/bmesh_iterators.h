@@ -213,6 +213,13 @@ int     BMO_iter_elem_count_flag(BMesh *bm, const char itype, void *data, const
 int     BM_iter_mesh_count(const char itype, BMesh *bm);
 int     BM_iter_mesh_count_flag(const char itype, BMesh *bm, const char hflag, const bool value);
 
+/* only available when BLI_task.h is included before bmesh.h */
+#ifdef __BLI_TASK_H__
+void    BM_iter_parallel(
+        BMesh *bm, const char itype, TaskParallelMempoolFunc func, void *userdata,
+        const bool use_threading);
+#endif
+
 /* private for bmesh_iterators_inline.c */
 
 #define BMITER_CB_DEF(name) \
@@ -35,6 +35,7 @@
 #include "BLI_listbase.h"
 #include "BLI_math.h"
 #include "BLI_stack.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_cdderivedmesh.h"
@@ -64,6 +65,25 @@ static void bm_mempool_init(BMesh *bm, const BMAllocTemplate *allocsize)
 #endif
 }
 
+static void bm_mesh_elem_toolflags_ensure_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	BMesh *bm = userdata;
+	const char iter_types[3] = {BM_VERTS_OF_MESH,
+	                            BM_EDGES_OF_MESH,
+	                            BM_FACES_OF_MESH};
+	BLI_mempool *toolflagpools[3] = {bm->vtoolflagpool,
+	                                 bm->etoolflagpool,
+	                                 bm->ftoolflagpool};
+
+	BLI_mempool *toolflagpool = toolflagpools[i];
+	BMIter iter;
+	BMElemF *ele;
+
+	BM_ITER_MESH (ele, &iter, bm, iter_types[i]) {
+		ele->oflags = BLI_mempool_calloc(toolflagpool);
+	}
+}
+
 void BM_mesh_elem_toolflags_ensure(BMesh *bm)
 {
 	if (bm->vtoolflagpool && bm->etoolflagpool && bm->ftoolflagpool) {
@@ -74,37 +94,10 @@ void BM_mesh_elem_toolflags_ensure(BMesh *bm)
 	bm->etoolflagpool = BLI_mempool_create(sizeof(BMFlagLayer), bm->totedge, 512, BLI_MEMPOOL_NOP);
 	bm->ftoolflagpool = BLI_mempool_create(sizeof(BMFlagLayer), bm->totface, 512, BLI_MEMPOOL_NOP);
 
-#pragma omp parallel sections if (bm->totvert + bm->totedge + bm->totface >= BM_OMP_LIMIT)
-	{
-#pragma omp section
-		{
-			BLI_mempool *toolflagpool = bm->vtoolflagpool;
-			BMIter iter;
-			BMElemF *ele;
-			BM_ITER_MESH (ele, &iter, bm, BM_VERTS_OF_MESH) {
-				ele->oflags = BLI_mempool_calloc(toolflagpool);
-			}
-		}
-#pragma omp section
-		{
-			BLI_mempool *toolflagpool = bm->etoolflagpool;
-			BMIter iter;
-			BMElemF *ele;
-			BM_ITER_MESH (ele, &iter, bm, BM_EDGES_OF_MESH) {
-				ele->oflags = BLI_mempool_calloc(toolflagpool);
-			}
-		}
-#pragma omp section
-		{
-			BLI_mempool *toolflagpool = bm->ftoolflagpool;
-			BMIter iter;
-			BMElemF *ele;
-			BM_ITER_MESH (ele, &iter, bm, BM_FACES_OF_MESH) {
-				ele->oflags = BLI_mempool_calloc(toolflagpool);
-			}
-		}
-	}
-
+	/* one task per element type, the pools can't be allocated from by multiple threads */
+	BLI_task_parallel_range_ex(
+	        0, 3, bm, NULL, 0, bm_mesh_elem_toolflags_ensure_cb,
+	        bm->totvert + bm->totedge + bm->totface >= BM_OMP_LIMIT, false);
 
 	bm->totflags = 1;
 }
@@ -277,91 +270,113 @@ void BM_mesh_free(BMesh *bm)
 /**
  * Helpers for #BM_mesh_normals_update and #BM_verts_calc_normal_vcos
  */
-static void bm_mesh_edges_calc_vectors(BMesh *bm, float (*edgevec)[3], const float (*vcos)[3])
+typedef struct BMEdgesCalcVectorsData {
+	const float (*vcos)[3];
+	float (*edgevec)[3];
+} BMEdgesCalcVectorsData;
+
+static void bm_mesh_edges_calc_vectors_cb(void *userdata, void *item)
 {
-	BMIter eiter;
-	BMEdge *e;
-	int index;
+	BMEdgesCalcVectorsData *data = userdata;
+	BMEdge *e = item;
+
+	if (e->l) {
+		const float *v1_co = data->vcos ? data->vcos[BM_elem_index_get(e->v1)] : e->v1->co;
+		const float *v2_co = data->vcos ? data->vcos[BM_elem_index_get(e->v2)] : e->v2->co;
+		float *e_vec = data->edgevec[BM_elem_index_get(e)];
 
-	if (vcos) {
-		BM_mesh_elem_index_ensure(bm, BM_VERT);
+		sub_v3_v3v3(e_vec, v2_co, v1_co);
+		normalize_v3(e_vec);
 	}
+	else {
+		/* the edge vector will not be needed when the edge has no radial */
+	}
+}
 
-	BM_ITER_MESH_INDEX (e, &eiter, bm, BM_EDGES_OF_MESH, index) {
-		BM_elem_index_set(e, index); /* set_inline */
+static void bm_mesh_edges_calc_vectors(BMesh *bm, float (*edgevec)[3], const float (*vcos)[3])
+{
+	BMEdgesCalcVectorsData data;
 
-		if (e->l) {
-			const float *v1_co = vcos ? vcos[BM_elem_index_get(e->v1)] : e->v1->co;
-			const float *v2_co = vcos ? vcos[BM_elem_index_get(e->v2)] : e->v2->co;
-			sub_v3_v3v3(edgevec[index], v2_co, v1_co);
-			normalize_v3(edgevec[index]);
-		}
-		else {
-			/* the edge vector will not be needed when the edge has no radial */
+	BM_mesh_elem_index_ensure(bm, (vcos) ? (BM_EDGE | BM_VERT) : BM_EDGE);
+
+	data.vcos = vcos;
+	data.edgevec = edgevec;
+
+	BM_iter_parallel(bm, BM_EDGES_OF_MESH, bm_mesh_edges_calc_vectors_cb, &data, bm->totedge >= BM_OMP_LIMIT);
+}
+
+typedef struct BMVertsCalcNormalsData {
+	const float (*edgevec)[3];
+	const float (*fnos)[3];
+	const float (*vcos)[3];
+	float (*vnos)[3];
+} BMVertsCalcNormalsData;
+
+static void bm_mesh_verts_calc_normals_cb(void *userdata, void *item)
+{
+	BMVertsCalcNormalsData *data = userdata;
+	BMVert *v = item;
+	float *v_no = data->vnos ? data->vnos[BM_elem_index_get(v)] : v->no;
+	BMIter liter;
+	BMLoop *l;
+
+	zero_v3(v_no);
+
+	/* add weighted face normals to the vertex,
+	 * gathering them per vertex so no other thread writes to it */
+	BM_ITER_ELEM (l, &liter, v, BM_LOOPS_OF_VERT) {
+		const float *f_no = data->fnos ? data->fnos[BM_elem_index_get(l->f)] : l->f->no;
+		const float *e1diff, *e2diff;
+		float dotprod;
+		float fac;
+
+		/* calculate the dot product of the two edges that
+		 * meet at the loop's vertex */
+		e1diff = data->edgevec[BM_elem_index_get(l->prev->e)];
+		e2diff = data->edgevec[BM_elem_index_get(l->e)];
+		dotprod = dot_v3v3(e1diff, e2diff);
+
+		/* edge vectors are calculated from e->v1 to e->v2, so
+		 * adjust the dot product if one but not both loops
+		 * actually runs from from e->v2 to e->v1 */
+		if ((l->prev->e->v1 == l->prev->v) ^ (l->e->v1 == l->v)) {
+			dotprod = -dotprod;
 		}
+
+		fac = saacos(-dotprod);
+
+		/* accumulate weighted face normal into the vertex's normal */
+		madd_v3_v3fl(v_no, f_no, fac);
+	}
+
+	/* normalize the accumulated vertex normal */
+	if (UNLIKELY(normalize_v3(v_no) == 0.0f)) {
+		const float *v_co = data->vcos ? data->vcos[BM_elem_index_get(v)] : v->co;
+		normalize_v3_v3(v_no, v_co);
 	}
-	bm->elem_index_dirty &= ~BM_EDGE;
 }
 
 static void bm_mesh_verts_calc_normals(
         BMesh *bm, const float (*edgevec)[3], const float (*fnos)[3],
         const float (*vcos)[3], float (*vnos)[3])
 {
-	BM_mesh_elem_index_ensure(bm, (vnos) ? (BM_EDGE | BM_VERT) : BM_EDGE);
+	BMVertsCalcNormalsData data;
 
-	/* add weighted face normals to vertices */
-	{
-		BMIter fiter;
-		BMFace *f;
-		int i;
-
-		BM_ITER_MESH_INDEX (f, &fiter, bm, BM_FACES_OF_MESH, i) {
-			BMLoop *l_first, *l_iter;
-			const float *f_no = fnos ? fnos[i] : f->no;
-
-			l_iter = l_first = BM_FACE_FIRST_LOOP(f);
-			do {
-				const float *e1diff, *e2diff;
-				float dotprod;
-				float fac;
-				float *v_no = vnos ? vnos[BM_elem_index_get(l_iter->v)] : l_iter->v->no;
-
-				/* calculate the dot product of the two edges that
-				 * meet at the loop's vertex */
-				e1diff = edgevec[BM_elem_index_get(l_iter->prev->e)];
-				e2diff = edgevec[BM_elem_index_get(l_iter->e)];
-				dotprod = dot_v3v3(e1diff, e2diff);
-
-				/* edge vectors are calculated from e->v1 to e->v2, so
-				 * adjust the dot product if one but not both loops
-				 * actually runs from from e->v2 to e->v1 */
-				if ((l_iter->prev->e->v1 == l_iter->prev->v) ^ (l_iter->e->v1 == l_iter->v)) {
-					dotprod = -dotprod;
-				}
+	BM_mesh_elem_index_ensure(bm, BM_EDGE | ((vnos || vcos) ? BM_VERT : 0) | ((fnos) ? BM_FACE : 0));
 
-				fac = saacos(-dotprod);
+	data.edgevec = edgevec;
+	data.fnos = fnos;
+	data.vcos = vcos;
+	data.vnos = vnos;
 
-				/* accumulate weighted face normal into the vertex's normal */
-				madd_v3_v3fl(v_no, f_no, fac);
-			} while ((l_iter = l_iter->next) != l_first);
-		}
-	}
+	BM_iter_parallel(bm, BM_VERTS_OF_MESH, bm_mesh_verts_calc_normals_cb, &data, bm->totvert >= BM_OMP_LIMIT);
+}
 
+static void bm_mesh_faces_calc_normals_cb(void *UNUSED(userdata), void *item)
+{
+	BMFace *f = item;
 
-	/* normalize the accumulated vertex normals */
-	{
-		BMIter viter;
-		BMVert *v;
-		int i;
-
-		BM_ITER_MESH_INDEX (v, &viter, bm, BM_VERTS_OF_MESH, i) {
-			float *v_no = vnos ? vnos[i] : v->no;
-			if (UNLIKELY(normalize_v3(v_no) == 0.0f)) {
-				const float *v_co = vcos ? vcos[i] : v->co;
-				normalize_v3_v3(v_no, v_co);
-			}
-		}
-	}
+	BM_face_normal_update(f);
 }
 
 /**
@@ -373,47 +388,87 @@ void BM_mesh_normals_update(BMesh *bm)
 {
 	float (*edgevec)[3] = MEM_mallocN(sizeof(*edgevec) * bm->totedge, __func__);
 
-#pragma omp parallel sections if (bm->totvert + bm->totedge + bm->totface >= BM_OMP_LIMIT)
-	{
-#pragma omp section
-		{
-			/* calculate all face normals */
-			BMIter fiter;
-			BMFace *f;
-			int i;
-
-			BM_ITER_MESH_INDEX (f, &fiter, bm, BM_FACES_OF_MESH, i) {
-				BM_elem_index_set(f, i); /* set_inline */
-				BM_face_normal_update(f);
-			}
-			bm->elem_index_dirty &= ~BM_FACE;
+	/* calculate all face normals */
+	BM_iter_parallel(bm, BM_FACES_OF_MESH, bm_mesh_faces_calc_normals_cb, NULL, bm->totface >= BM_OMP_LIMIT);
+
+	/* Compute normalized direction vectors for each edge.
+	 * Directions will be used for calculating the weights of the face normals on the vertex normals.
+	 */
+	bm_mesh_edges_calc_vectors(bm, edgevec, NULL);
+
+	/* Add weighted face normals to vertices, and normalize vert normals. */
+	bm_mesh_verts_calc_normals(bm, (const float(*)[3])edgevec, NULL, NULL, NULL);
+	MEM_freeN(edgevec);
+}
+
+/**
+ * \brief BMesh Compute Normals of Modified Vertices
+ *
+ * Updates the face normals around \a verts and the vertex normals of those faces,
+ * for when only some vertices moved (edit-mode transform for e.g.).
+ * Falls back to #BM_mesh_normals_update when a large part of the mesh moved.
+ */
+void BM_mesh_normals_update_verts(BMesh *bm, BMVert **verts, const int verts_len)
+{
+	BLI_LINKSTACK_DECLARE(faces, BMFace *);
+	BLI_LINKSTACK_DECLARE(verts_update, BMVert *);
+	BMFace *f;
+	BMVert *v;
+	int i;
+
+	if (verts_len > bm->totvert / 4) {
+		BM_mesh_normals_update(bm);
+		return;
+	}
+
+	BLI_LINKSTACK_INIT(faces);
+	BLI_LINKSTACK_INIT(verts_update);
+
+	/* tag the faces which need an update, the internal tag is cleared again when they are popped */
+	for (i = 0; i < verts_len; i++) {
+		BMIter fiter;
+
+		v = verts[i];
+		if (!BM_elem_flag_test(v, BM_ELEM_INTERNAL_TAG)) {
+			BM_elem_flag_enable(v, BM_ELEM_INTERNAL_TAG);
+			BLI_LINKSTACK_PUSH(verts_update, v);
 		}
-#pragma omp section
-		{
-			/* Zero out vertex normals */
-			BMIter viter;
-			BMVert *v;
-			int i;
-
-			BM_ITER_MESH_INDEX (v, &viter, bm, BM_VERTS_OF_MESH, i) {
-				BM_elem_index_set(v, i); /* set_inline */
-				zero_v3(v->no);
+
+		BM_ITER_ELEM (f, &fiter, v, BM_FACES_OF_VERT) {
+			if (!BM_elem_flag_test(f, BM_ELEM_INTERNAL_TAG)) {
+				BM_elem_flag_enable(f, BM_ELEM_INTERNAL_TAG);
+				BLI_LINKSTACK_PUSH(faces, f);
 			}
-			bm->elem_index_dirty &= ~BM_VERT;
 		}
-#pragma omp section
-		{
-			/* Compute normalized direction vectors for each edge.
-			 * Directions will be used for calculating the weights of the face normals on the vertex normals.
-			 */
-			bm_mesh_edges_calc_vectors(bm, edgevec, NULL);
+	}
+
+	/* all normals of these faces changed, and with them the normals of their vertices */
+	while ((f = BLI_LINKSTACK_POP(faces))) {
+		BMLoop *l_iter, *l_first;
+
+		BM_elem_flag_disable(f, BM_ELEM_INTERNAL_TAG);
+		BM_face_normal_update(f);
+
+		l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+		do {
+			if (!BM_elem_flag_test(l_iter->v, BM_ELEM_INTERNAL_TAG)) {
+				BM_elem_flag_enable(l_iter->v, BM_ELEM_INTERNAL_TAG);
+				BLI_LINKSTACK_PUSH(verts_update, l_iter->v);
+			}
+		} while ((l_iter = l_iter->next) != l_first);
+	}
+
+	while ((v = BLI_LINKSTACK_POP(verts_update))) {
+		BM_elem_flag_disable(v, BM_ELEM_INTERNAL_TAG);
+
+		/* matches #BM_mesh_normals_update for vertices without faces */
+		if (!BM_vert_calc_normal(v, v->no) || UNLIKELY(is_zero_v3(v->no))) {
+			normalize_v3_v3(v->no, v->co);
 		}
 	}
-	/* end omp */
 
-	/* Add weighted face normals to vertices, and normalize vert normals. */
-	bm_mesh_verts_calc_normals(bm, (const float(*)[3])edgevec, NULL, NULL, NULL);
-	MEM_freeN(edgevec);
+	BLI_LINKSTACK_FREE(faces);
+	BLI_LINKSTACK_FREE(verts_update);
 }
 
 /**
@@ -1021,24 +1076,21 @@ void bmesh_edit_end(BMesh *bm, BMOpTypeFlag type_flag)
 	}
 }
 
-void BM_mesh_elem_index_ensure(BMesh *bm, const char htype)
-{
-	const char htype_needed = bm->elem_index_dirty & htype;
-
-#ifdef DEBUG
-	BM_ELEM_INDEX_VALIDATE(bm, "Should Never Fail!", __func__);
-#endif
-
-	if (htype_needed == 0) {
-		goto finally;
-	}
+/* one task per element type for #BM_mesh_elem_index_ensure & #BM_mesh_elem_table_ensure,
+ * numbering the elements follows their order so each type is done by a single thread */
+typedef struct BMElemIndexData {
+	BMesh *bm;
+	char htype;
+} BMElemIndexData;
 
-	/* skip if we only need to operate on one element */
-#pragma omp parallel sections if ((!ELEM(htype_needed, BM_VERT, BM_EDGE, BM_FACE, BM_LOOP, BM_FACE | BM_LOOP)) && \
-	                              (bm->totvert + bm->totedge + bm->totface >= BM_OMP_LIMIT))
-	{
-#pragma omp section
+static void bm_mesh_elem_index_ensure_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	BMElemIndexData *data = userdata;
+	BMesh *bm = data->bm;
+	const char htype = data->htype;
 
+	switch (i) {
+		case 0:
 		{
 			if (htype & BM_VERT) {
 				if (bm->elem_index_dirty & BM_VERT) {
@@ -1055,9 +1107,9 @@ void BM_mesh_elem_index_ensure(BMesh *bm, const char htype)
 					// printf("%s: skipping vert index calc!\n", __func__);
 				}
 			}
+			break;
 		}
-
-#pragma omp section
+		case 1:
 		{
 			if (htype & BM_EDGE) {
 				if (bm->elem_index_dirty & BM_EDGE) {
@@ -1074,9 +1126,9 @@ void BM_mesh_elem_index_ensure(BMesh *bm, const char htype)
 					// printf("%s: skipping edge index calc!\n", __func__);
 				}
 			}
+			break;
 		}
-
-#pragma omp section
+		case 2:
 		{
 			if (htype & (BM_FACE | BM_LOOP)) {
 				if (bm->elem_index_dirty & (BM_FACE | BM_LOOP)) {
@@ -1113,9 +1165,33 @@ void BM_mesh_elem_index_ensure(BMesh *bm, const char htype)
 					// printf("%s: skipping face/loop index calc!\n", __func__);
 				}
 			}
+			break;
 		}
 	}
+}
+
+void BM_mesh_elem_index_ensure(BMesh *bm, const char htype)
+{
+	const char htype_needed = bm->elem_index_dirty & htype;
+	BMElemIndexData data;
+
+#ifdef DEBUG
+	BM_ELEM_INDEX_VALIDATE(bm, "Should Never Fail!", __func__);
+#endif
+
+	if (htype_needed == 0) {
+		goto finally;
+	}
+
+	data.bm = bm;
+	data.htype = htype;
 
+	/* skip threading if we only need to operate on one element */
+	BLI_task_parallel_range_ex(
+	        0, 3, &data, NULL, 0, bm_mesh_elem_index_ensure_cb,
+	        (!ELEM(htype_needed, BM_VERT, BM_EDGE, BM_FACE, BM_LOOP, BM_FACE | BM_LOOP)) &&
+	        (bm->totvert + bm->totedge + bm->totface >= BM_OMP_LIMIT),
+	        false);
 
 finally:
 	bm->elem_index_dirty &= ~htype;
@@ -1238,12 +1314,38 @@ bool BM_mesh_elem_table_check(BMesh *bm)
 
 
 
+static void bm_mesh_elem_table_ensure_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	BMElemIndexData *data = userdata;
+	BMesh *bm = data->bm;
+	const char htype_needed = data->htype;
+
+	switch (i) {
+		case 0:
+			if (htype_needed & BM_VERT) {
+				BM_iter_as_array(bm, BM_VERTS_OF_MESH, NULL, (void **)bm->vtable, bm->totvert);
+			}
+			break;
+		case 1:
+			if (htype_needed & BM_EDGE) {
+				BM_iter_as_array(bm, BM_EDGES_OF_MESH, NULL, (void **)bm->etable, bm->totedge);
+			}
+			break;
+		case 2:
+			if (htype_needed & BM_FACE) {
+				BM_iter_as_array(bm, BM_FACES_OF_MESH, NULL, (void **)bm->ftable, bm->totface);
+			}
+			break;
+	}
+}
+
 void BM_mesh_elem_table_ensure(BMesh *bm, const char htype)
 {
 	/* assume if the array is non-null then its valid and no need to recalc */
 	const char htype_needed = (((bm->vtable && ((bm->elem_table_dirty & BM_VERT) == 0)) ? 0 : BM_VERT) |
 	                           ((bm->etable && ((bm->elem_table_dirty & BM_EDGE) == 0)) ? 0 : BM_EDGE) |
 	                           ((bm->ftable && ((bm->elem_table_dirty & BM_FACE) == 0)) ? 0 : BM_FACE)) & htype;
+	BMElemIndexData data;
 
 	BLI_assert((htype & ~BM_ALL_NOLOOP) == 0);
 
@@ -1288,29 +1390,15 @@ void BM_mesh_elem_table_ensure(BMesh *bm, const char htype)
 		}
 	}
 
-	/* skip if we only need to operate on one element */
-#pragma omp parallel sections if ((!ELEM(htype_needed, BM_VERT, BM_EDGE, BM_FACE)) && \
-	                              (bm->totvert + bm->totedge + bm->totface >= BM_OMP_LIMIT))
-	{
-#pragma omp section
-		{
-			if (htype_needed & BM_VERT) {
-				BM_iter_as_array(bm, BM_VERTS_OF_MESH, NULL, (void **)bm->vtable, bm->totvert);
-			}
-		}
-#pragma omp section
-		{
-			if (htype_needed & BM_EDGE) {
-				BM_iter_as_array(bm, BM_EDGES_OF_MESH, NULL, (void **)bm->etable, bm->totedge);
-			}
-		}
-#pragma omp section
-		{
-			if (htype_needed & BM_FACE) {
-				BM_iter_as_array(bm, BM_FACES_OF_MESH, NULL, (void **)bm->ftable, bm->totface);
-			}
-		}
-	}
+	data.bm = bm;
+	data.htype = htype_needed;
+
+	/* skip threading if we only need to operate on one element */
+	BLI_task_parallel_range_ex(
+	        0, 3, &data, NULL, 0, bm_mesh_elem_table_ensure_cb,
+	        (!ELEM(htype_needed, BM_VERT, BM_EDGE, BM_FACE)) &&
+	        (bm->totvert + bm->totedge + bm->totface >= BM_OMP_LIMIT),
+	        false);
 
 finally:
 	/* Only clear dirty flags when all the pointers and data are actually valid.
@@ -1437,6 +1525,42 @@ int BM_mesh_elem_count(BMesh *bm, const char htype)
 	}
 }
 
+typedef struct BMVertCoordsData {
+	float (*r_vcos)[3];
+	float (*r_vnos)[3];
+} BMVertCoordsData;
+
+static void bm_mesh_vert_coords_get_cb(void *userdata, void *item)
+{
+	BMVertCoordsData *data = userdata;
+	BMVert *v = item;
+	const int index = BM_elem_index_get(v);
+
+	if (data->r_vcos) {
+		copy_v3_v3(data->r_vcos[index], v->co);
+	}
+	if (data->r_vnos) {
+		copy_v3_v3(data->r_vnos[index], v->no);
+	}
+}
+
+/**
+ * Copy the vertex coordinates and/or normals into contiguous arrays (either may be NULL),
+ * ordered by the vertex indices, for loops which read them many times.
+ * The arrays must be #BMesh.totvert long, and are only valid until the vertices are modified.
+ */
+void BM_mesh_vert_coords_get(BMesh *bm, float (*r_vcos)[3], float (*r_vnos)[3])
+{
+	BMVertCoordsData data;
+
+	BM_mesh_elem_index_ensure(bm, BM_VERT);
+
+	data.r_vcos = r_vcos;
+	data.r_vnos = r_vnos;
+
+	BM_iter_parallel(bm, BM_VERTS_OF_MESH, bm_mesh_vert_coords_get_cb, &data, bm->totvert >= BM_OMP_LIMIT);
+}
+
 /**
  * Special case: Python uses custom-data layers to hold PyObject references.
  * These have to be kept in-place, else the PyObject's we point to, wont point back to us.
@@ -39,6 +39,7 @@ void   BM_mesh_data_free(BMesh *bm);
 void   BM_mesh_clear(BMesh *bm);
 
 void BM_mesh_normals_update(BMesh *bm);
+void BM_mesh_normals_update_verts(BMesh *bm, BMVert **verts, const int verts_len);
 void BM_verts_calc_normal_vcos(BMesh *bm, const float (*fnos)[3], const float (*vcos)[3], float (*vnos)[3]);
 void BM_loops_calc_normal_vcos(
         BMesh *bm, const float (*vcos)[3], const float (*vnos)[3], const float (*pnos)[3],
@@ -77,6 +78,8 @@ BMFace *BM_face_at_index_find_or_table(BMesh *bm, const int index);
 
 int  BM_mesh_elem_count(BMesh *bm, const char htype);
 
+void BM_mesh_vert_coords_get(BMesh *bm, float (*r_vcos)[3], float (*r_vnos)[3]);
+
 void BM_mesh_remap(
         BMesh *bm,
         const unsigned int *vert_idx,
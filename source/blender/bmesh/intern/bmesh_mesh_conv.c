@@ -86,6 +86,7 @@
 #include "BLI_listbase.h"
 #include "BLI_alloca.h"
 #include "BLI_math_vector.h"
+#include "BLI_task.h"
 
 #include "BKE_mesh.h"
 #include "BKE_customdata.h"
@@ -216,6 +217,109 @@ static BMFace *bm_face_create_from_mpoly(
 	return BM_face_create(bm, verts, edges, mp->totloop, NULL, BM_CREATE_SKIP_CD);
 }
 
+/* Elements are created on a single thread (the element pools and the disk & radial cycles
+ * aren't thread safe), with their custom-data blocks allocated, after which the data of
+ * every element is filled in independently. */
+typedef struct BMFromMeData {
+	BMesh *bm;
+	Mesh *me;
+	BMVert **vtable;
+	BMEdge **etable;
+	BMFace **ftable;
+
+	int cd_vert_bweight_offset;
+	int cd_edge_bweight_offset;
+	int cd_edge_crease_offset;
+	int cd_shape_keyindex_offset;
+
+	bool calc_face_normal;
+} BMFromMeData;
+
+static void bm_from_me_vert_data_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	BMFromMeData *data = userdata;
+	BMesh *bm = data->bm;
+	Mesh *me = data->me;
+	const MVert *mvert = &me->mvert[i];
+	BMVert *v = data->vtable[i];
+
+	normal_short_to_float_v3(v->no, mvert->no);
+
+	/* Copy Custom Data */
+	CustomData_to_bmesh_block(&me->vdata, &bm->vdata, i, &v->head.data, true);
+
+	if (data->cd_vert_bweight_offset != -1) {
+		BM_ELEM_CD_SET_FLOAT(v, data->cd_vert_bweight_offset, (float)mvert->bweight / 255.0f);
+	}
+
+	/* set shapekey data */
+	if (me->key) {
+		KeyBlock *block;
+		int j;
+
+		/* set shape key original index */
+		if (data->cd_shape_keyindex_offset != -1) {
+			BM_ELEM_CD_SET_INT(v, data->cd_shape_keyindex_offset, i);
+		}
+
+		for (block = me->key->block.first, j = 0; block; block = block->next, j++) {
+			float *co = CustomData_bmesh_get_n(&bm->vdata, v->head.data, CD_SHAPEKEY, j);
+
+			if (co) {
+				copy_v3_v3(co, ((float *)block->data) + 3 * i);
+			}
+		}
+	}
+}
+
+static void bm_from_me_edge_data_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	BMFromMeData *data = userdata;
+	BMesh *bm = data->bm;
+	Mesh *me = data->me;
+	const MEdge *medge = &me->medge[i];
+	BMEdge *e = data->etable[i];
+
+	/* Copy Custom Data */
+	CustomData_to_bmesh_block(&me->edata, &bm->edata, i, &e->head.data, true);
+
+	if (data->cd_edge_bweight_offset != -1) {
+		BM_ELEM_CD_SET_FLOAT(e, data->cd_edge_bweight_offset, (float)medge->bweight / 255.0f);
+	}
+	if (data->cd_edge_crease_offset != -1) {
+		BM_ELEM_CD_SET_FLOAT(e, data->cd_edge_crease_offset, (float)medge->crease / 255.0f);
+	}
+}
+
+static void bm_from_me_face_data_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	BMFromMeData *data = userdata;
+	BMesh *bm = data->bm;
+	Mesh *me = data->me;
+	const MPoly *mp = &me->mpoly[i];
+	BMFace *f = data->ftable[i];
+	BMLoop *l_iter, *l_first;
+	int j;
+
+	/* skipped bad face */
+	if (f == NULL) {
+		return;
+	}
+
+	j = mp->loopstart;
+	l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+	do {
+		CustomData_to_bmesh_block(&me->ldata, &bm->ldata, j++, &l_iter->head.data, true);
+	} while ((l_iter = l_iter->next) != l_first);
+
+	/* Copy Custom Data */
+	CustomData_to_bmesh_block(&me->pdata, &bm->pdata, i, &f->head.data, true);
+
+	if (data->calc_face_normal) {
+		BM_face_normal_update(f);
+	}
+}
+
 
 /**
  * \brief Mesh -> BMesh
@@ -233,15 +337,11 @@ void BM_mesh_bm_from_me(
 	KeyBlock *actkey, *block;
 	BMVert *v, **vtable = NULL;
 	BMEdge *e, **etable = NULL;
-	BMFace *f;
+	BMFace *f, **ftable = NULL;
+	BMFromMeData data;
 	float (*keyco)[3] = NULL;
 	int totuv, totloops, i, j;
 
-	int cd_vert_bweight_offset;
-	int cd_edge_bweight_offset;
-	int cd_edge_crease_offset;
-	int cd_shape_keyindex_offset;
-
 	/* free custom data */
 	/* this isnt needed in most cases but do just incase */
 	CustomData_free(&bm->vdata, bm->totvert);
@@ -324,10 +424,14 @@ void BM_mesh_bm_from_me(
 
 	BM_mesh_cd_flag_apply(bm, me->cd_flag);
 
-	cd_vert_bweight_offset = CustomData_get_offset(&bm->vdata, CD_BWEIGHT);
-	cd_edge_bweight_offset = CustomData_get_offset(&bm->edata, CD_BWEIGHT);
-	cd_edge_crease_offset  = CustomData_get_offset(&bm->edata, CD_CREASE);
-	cd_shape_keyindex_offset = me->key ? CustomData_get_offset(&bm->vdata, CD_SHAPE_KEYINDEX) : -1;
+	data.bm = bm;
+	data.me = me;
+	data.vtable = vtable;
+	data.cd_vert_bweight_offset = CustomData_get_offset(&bm->vdata, CD_BWEIGHT);
+	data.cd_edge_bweight_offset = CustomData_get_offset(&bm->edata, CD_BWEIGHT);
+	data.cd_edge_crease_offset  = CustomData_get_offset(&bm->edata, CD_CREASE);
+	data.cd_shape_keyindex_offset = me->key ? CustomData_get_offset(&bm->vdata, CD_SHAPE_KEYINDEX) : -1;
+	data.calc_face_normal = calc_face_normal;
 
 	for (i = 0, mvert = me->mvert; i < me->totvert; i++, mvert++) {
 		v = vtable[i] = BM_vert_create(bm, keyco && set_key ? keyco[i] : mvert->co, NULL, BM_CREATE_SKIP_CD);
@@ -341,36 +445,23 @@ void BM_mesh_bm_from_me(
 			BM_vert_select_set(bm, v, true);
 		}
 
-		normal_short_to_float_v3(v->no, mvert->no);
-
-		/* Copy Custom Data */
-		CustomData_to_bmesh_block(&me->vdata, &bm->vdata, i, &v->head.data, true);
-
-		if (cd_vert_bweight_offset != -1) BM_ELEM_CD_SET_FLOAT(v, cd_vert_bweight_offset, (float)mvert->bweight / 255.0f);
-
-		/* set shapekey data */
-		if (me->key) {
-			/* set shape key original index */
-			if (cd_shape_keyindex_offset != -1) BM_ELEM_CD_SET_INT(v, cd_shape_keyindex_offset, i);
-
-			for (block = me->key->block.first, j = 0; block; block = block->next, j++) {
-				float *co = CustomData_bmesh_get_n(&bm->vdata, v->head.data, CD_SHAPEKEY, j);
-
-				if (co) {
-					copy_v3_v3(co, ((float *)block->data) + 3 * i);
-				}
-			}
-		}
+		/* filled in by 'bm_from_me_vert_data_cb' */
+		CustomData_bmesh_alloc_block(&bm->vdata, &v->head.data);
 	}
 
 	bm->elem_index_dirty &= ~BM_VERT; /* added in order, clear dirty flag */
 
+	BLI_task_parallel_range_ex(
+	        0, me->totvert, &data, NULL, 0, bm_from_me_vert_data_cb,
+	        me->totvert >= BM_OMP_LIMIT, false);
+
 	if (!me->totedge) {
 		MEM_freeN(vtable);
 		return;
 	}
 
 	etable = MEM_mallocN(sizeof(void **) * me->totedge, "mesh to bmesh etable");
+	data.etable = etable;
 
 	medge = me->medge;
 	for (i = 0; i < me->totedge; i++, medge++) {
@@ -385,24 +476,29 @@ void BM_mesh_bm_from_me(
 			BM_edge_select_set(bm, e, true);
 		}
 
-		/* Copy Custom Data */
-		CustomData_to_bmesh_block(&me->edata, &bm->edata, i, &e->head.data, true);
-
-		if (cd_edge_bweight_offset != -1) BM_ELEM_CD_SET_FLOAT(e, cd_edge_bweight_offset, (float)medge->bweight / 255.0f);
-		if (cd_edge_crease_offset  != -1) BM_ELEM_CD_SET_FLOAT(e, cd_edge_crease_offset,  (float)medge->crease  / 255.0f);
-
+		/* filled in by 'bm_from_me_edge_data_cb' */
+		CustomData_bmesh_alloc_block(&bm->edata, &e->head.data);
 	}
 
 	bm->elem_index_dirty &= ~BM_EDGE; /* added in order, clear dirty flag */
 
+	BLI_task_parallel_range_ex(
+	        0, me->totedge, &data, NULL, 0, bm_from_me_edge_data_cb,
+	        me->totedge >= BM_OMP_LIMIT, false);
+
+	if (me->totpoly) {
+		ftable = MEM_mallocN(sizeof(void **) * me->totpoly, "mesh to bmesh ftable");
+		data.ftable = ftable;
+	}
+
 	mloop = me->mloop;
 	mp = me->mpoly;
 	for (i = 0, totloops = 0; i < me->totpoly; i++, mp++) {
 		BMLoop *l_iter;
 		BMLoop *l_first;
 
-		f = bm_face_create_from_mpoly(mp, mloop + mp->loopstart,
-		                              bm, vtable, etable);
+		f = ftable[i] = bm_face_create_from_mpoly(mp, mloop + mp->loopstart,
+		                                          bm, vtable, etable);
 
 		if (UNLIKELY(f == NULL)) {
 			printf("%s: Warning! Bad face in mesh"
@@ -425,60 +521,44 @@ void BM_mesh_bm_from_me(
 		f->mat_nr = mp->mat_nr;
 		if (i == me->act_face) bm->act_face = f;
 
-		j = mp->loopstart;
 		l_iter = l_first = BM_FACE_FIRST_LOOP(f);
 		do {
-			/* don't use 'j' since we may have skipped some faces, hence some loops. */
+			/* don't use the 'MLoop' index since we may have skipped some faces, hence some loops. */
 			BM_elem_index_set(l_iter, totloops++); /* set_ok */
 
-			/* Save index of correspsonding MLoop */
-			CustomData_to_bmesh_block(&me->ldata, &bm->ldata, j++, &l_iter->head.data, true);
+			CustomData_bmesh_alloc_block(&bm->ldata, &l_iter->head.data);
 		} while ((l_iter = l_iter->next) != l_first);
 
-		/* Copy Custom Data */
-		CustomData_to_bmesh_block(&me->pdata, &bm->pdata, i, &f->head.data, true);
-
-		if (calc_face_normal) {
-			BM_face_normal_update(f);
-		}
+		/* filled in by 'bm_from_me_face_data_cb', along with the loops */
+		CustomData_bmesh_alloc_block(&bm->pdata, &f->head.data);
 	}
 
 	bm->elem_index_dirty &= ~(BM_FACE | BM_LOOP); /* added in order, clear dirty flag */
 
-	if (me->mselect && me->totselect != 0) {
+	if (me->totpoly) {
+		BLI_task_parallel_range_ex(
+		        0, me->totpoly, &data, NULL, 0, bm_from_me_face_data_cb,
+		        me->totpoly >= BM_OMP_LIMIT, false);
+	}
 
-		BMVert **vert_array = MEM_mallocN(sizeof(BMVert *) * bm->totvert, "VSelConv");
-		BMEdge **edge_array = MEM_mallocN(sizeof(BMEdge *) * bm->totedge, "ESelConv");
-		BMFace **face_array = MEM_mallocN(sizeof(BMFace *) * bm->totface, "FSelConv");
+	if (me->mselect && me->totselect != 0) {
 		MSelect *msel;
 
-#pragma omp parallel sections if (bm->totvert + bm->totedge + bm->totface >= BM_OMP_LIMIT)
-		{
-#pragma omp section
-			{ BM_iter_as_array(bm, BM_VERTS_OF_MESH, NULL, (void **)vert_array, bm->totvert); }
-#pragma omp section
-			{ BM_iter_as_array(bm, BM_EDGES_OF_MESH, NULL, (void **)edge_array, bm->totedge); }
-#pragma omp section
-			{ BM_iter_as_array(bm, BM_FACES_OF_MESH, NULL, (void **)face_array, bm->totface); }
-		}
+		BM_mesh_elem_table_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
 
 		for (i = 0, msel = me->mselect; i < me->totselect; i++, msel++) {
 			switch (msel->type) {
 				case ME_VSEL:
-					BM_select_history_store(bm, (BMElem *)vert_array[msel->index]);
+					BM_select_history_store(bm, (BMElem *)bm->vtable[msel->index]);
 					break;
 				case ME_ESEL:
-					BM_select_history_store(bm, (BMElem *)edge_array[msel->index]);
+					BM_select_history_store(bm, (BMElem *)bm->etable[msel->index]);
 					break;
 				case ME_FSEL:
-					BM_select_history_store(bm, (BMElem *)face_array[msel->index]);
+					BM_select_history_store(bm, (BMElem *)bm->ftable[msel->index]);
 					break;
 			}
 		}
-
-		MEM_freeN(vert_array);
-		MEM_freeN(edge_array);
-		MEM_freeN(face_array);
 	}
 	else {
 		me->totselect = 0;
@@ -490,6 +570,9 @@ void BM_mesh_bm_from_me(
 
 	MEM_freeN(vtable);
 	MEM_freeN(etable);
+	if (ftable) {
+		MEM_freeN(ftable);
+	}
 }
 
 
@@ -568,21 +651,123 @@ BLI_INLINE void bmesh_quick_edgedraw_flag(MEdge *med, BMEdge *e)
 	}
 }
 
+/* The element indices are set beforehand, so every element (and the loops of every face)
+ * maps to a known position in the mesh arrays and can be written independently. */
+typedef struct BMToMeData {
+	BMesh *bm;
+	Mesh *me;
+
+	int cd_vert_bweight_offset;
+	int cd_edge_bweight_offset;
+	int cd_edge_crease_offset;
+} BMToMeData;
+
+static void bm_to_me_vert_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	BMToMeData *data = userdata;
+	BMesh *bm = data->bm;
+	Mesh *me = data->me;
+	BMVert *v = bm->vtable[i];
+	MVert *mvert = &me->mvert[i];
+
+	copy_v3_v3(mvert->co, v->co);
+	normal_float_to_short_v3(mvert->no, v->no);
+
+	mvert->flag = BM_vert_flag_to_mflag(v);
+
+	/* copy over customdat */
+	CustomData_from_bmesh_block(&bm->vdata, &me->vdata, v->head.data, i);
+
+	if (data->cd_vert_bweight_offset != -1) {
+		mvert->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, data->cd_vert_bweight_offset);
+	}
+
+	BM_CHECK_ELEMENT(v);
+}
+
+static void bm_to_me_edge_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	BMToMeData *data = userdata;
+	BMesh *bm = data->bm;
+	Mesh *me = data->me;
+	BMEdge *e = bm->etable[i];
+	MEdge *med = &me->medge[i];
+
+	med->v1 = BM_elem_index_get(e->v1);
+	med->v2 = BM_elem_index_get(e->v2);
+
+	med->flag = BM_edge_flag_to_mflag(e);
+
+	/* copy over customdata */
+	CustomData_from_bmesh_block(&bm->edata, &me->edata, e->head.data, i);
+
+	bmesh_quick_edgedraw_flag(med, e);
+
+	if (data->cd_edge_crease_offset  != -1) {
+		med->crease  = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, data->cd_edge_crease_offset);
+	}
+	if (data->cd_edge_bweight_offset != -1) {
+		med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, data->cd_edge_bweight_offset);
+	}
+
+	BM_CHECK_ELEMENT(e);
+}
+
+static void bm_to_me_face_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	BMToMeData *data = userdata;
+	BMesh *bm = data->bm;
+	Mesh *me = data->me;
+	BMFace *f = bm->ftable[i];
+	MPoly *mpoly = &me->mpoly[i];
+	BMLoop *l_iter, *l_first;
+	int j;
+
+	l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+
+	mpoly->loopstart = BM_elem_index_get(l_first);
+	mpoly->totloop = f->len;
+	mpoly->mat_nr = f->mat_nr;
+	mpoly->flag = BM_face_flag_to_mflag(f);
+
+	j = mpoly->loopstart;
+	do {
+		MLoop *mloop = &me->mloop[j];
+
+		mloop->e = BM_elem_index_get(l_iter->e);
+		mloop->v = BM_elem_index_get(l_iter->v);
+
+		/* copy over customdata */
+		CustomData_from_bmesh_block(&bm->ldata, &me->ldata, l_iter->head.data, j);
+
+		j++;
+		BM_CHECK_ELEMENT(l_iter);
+		BM_CHECK_ELEMENT(l_iter->e);
+		BM_CHECK_ELEMENT(l_iter->v);
+	} while ((l_iter = l_iter->next) != l_first);
+
+	/* copy over customdata */
+	CustomData_from_bmesh_block(&bm->pdata, &me->pdata, f->head.data, i);
+
+	BM_CHECK_ELEMENT(f);
+}
+
 void BM_mesh_bm_to_me(BMesh *bm, Mesh *me, bool do_tessface)
 {
 	MLoop *mloop;
 	MPoly *mpoly;
 	MVert *mvert, *oldverts;
-	MEdge *med, *medge;
-	BMVert *v, *eve;
-	BMEdge *e;
-	BMFace *f;
+	MEdge *medge;
+	BMVert *eve;
 	BMIter iter;
+	BMToMeData data;
 	int i, j, ototvert;
 
-	const int cd_vert_bweight_offset = CustomData_get_offset(&bm->vdata, CD_BWEIGHT);
-	const int cd_edge_bweight_offset = CustomData_get_offset(&bm->edata, CD_BWEIGHT);
-	const int cd_edge_crease_offset  = CustomData_get_offset(&bm->edata, CD_CREASE);
+	data.bm = bm;
+	data.me = me;
+	data.cd_vert_bweight_offset = CustomData_get_offset(&bm->vdata, CD_BWEIGHT);
+	data.cd_edge_bweight_offset = CustomData_get_offset(&bm->edata, CD_BWEIGHT);
+	data.cd_edge_crease_offset  = CustomData_get_offset(&bm->edata, CD_CREASE);
 
 	ototvert = me->totvert;
 
@@ -644,83 +829,29 @@ void BM_mesh_bm_to_me(BMesh *bm, Mesh *me, bool do_tessface)
 	/* this is called again, 'dotess' arg is used there */
 	BKE_mesh_update_customdata_pointers(me, 0);
 
-	i = 0;
-	BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
-		copy_v3_v3(mvert->co, v->co);
-		normal_float_to_short_v3(mvert->no, v->no);
-
-		mvert->flag = BM_vert_flag_to_mflag(v);
+	/* vertex & edge indices are always written, they are what the hooks below are remapped to */
+	bm->elem_index_dirty |= BM_VERT | BM_EDGE;
+	BM_mesh_elem_index_ensure(bm, BM_VERT | BM_EDGE | BM_LOOP | BM_FACE);
+	BM_mesh_elem_table_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
 
-		BM_elem_index_set(v, i); /* set_inline */
-
-		/* copy over customdat */
-		CustomData_from_bmesh_block(&bm->vdata, &me->vdata, v->head.data, i);
-
-		if (cd_vert_bweight_offset != -1) mvert->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, cd_vert_bweight_offset);
-
-		i++;
-		mvert++;
-
-		BM_CHECK_ELEMENT(v);
+	if (bm->totvert) {
+		BLI_task_parallel_range_ex(
+		        0, bm->totvert, &data, NULL, 0, bm_to_me_vert_cb,
+		        bm->totvert >= BM_OMP_LIMIT, false);
 	}
-	bm->elem_index_dirty &= ~BM_VERT;
-
-	med = medge;
-	i = 0;
-	BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
-		med->v1 = BM_elem_index_get(e->v1);
-		med->v2 = BM_elem_index_get(e->v2);
-
-		med->flag = BM_edge_flag_to_mflag(e);
-
-		BM_elem_index_set(e, i); /* set_inline */
-
-		/* copy over customdata */
-		CustomData_from_bmesh_block(&bm->edata, &me->edata, e->head.data, i);
-
-		bmesh_quick_edgedraw_flag(med, e);
-
-		if (cd_edge_crease_offset  != -1) med->crease  = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_crease_offset);
-		if (cd_edge_bweight_offset != -1) med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_bweight_offset);
-
-		i++;
-		med++;
-		BM_CHECK_ELEMENT(e);
+	if (bm->totedge) {
+		BLI_task_parallel_range_ex(
+		        0, bm->totedge, &data, NULL, 0, bm_to_me_edge_cb,
+		        bm->totedge >= BM_OMP_LIMIT, false);
+	}
+	if (bm->totface) {
+		BLI_task_parallel_range_ex(
+		        0, bm->totface, &data, NULL, 0, bm_to_me_face_cb,
+		        bm->totface >= BM_OMP_LIMIT, false);
 	}
-	bm->elem_index_dirty &= ~BM_EDGE;
-
-	i = 0;
-	j = 0;
-	BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
-		BMLoop *l_iter, *l_first;
-		mpoly->loopstart = j;
-		mpoly->totloop = f->len;
-		mpoly->mat_nr = f->mat_nr;
-		mpoly->flag = BM_face_flag_to_mflag(f);
-
-		l_iter = l_first = BM_FACE_FIRST_LOOP(f);
-		do {
-			mloop->e = BM_elem_index_get(l_iter->e);
-			mloop->v = BM_elem_index_get(l_iter->v);
-
-			/* copy over customdata */
-			CustomData_from_bmesh_block(&bm->ldata, &me->ldata, l_iter->head.data, j);
-
-			j++;
-			mloop++;
-			BM_CHECK_ELEMENT(l_iter);
-			BM_CHECK_ELEMENT(l_iter->e);
-			BM_CHECK_ELEMENT(l_iter->v);
-		} while ((l_iter = l_iter->next) != l_first);
-
-		if (f == bm->act_face) me->act_face = i;
-
-		/* copy over customdata */
-		CustomData_from_bmesh_block(&bm->pdata, &me->pdata, f->head.data, i);
 
-		i++;
-		mpoly++;
-		BM_CHECK_ELEMENT(f);
+	if (bm->act_face) {
+		me->act_face = BM_elem_index_get(bm->act_face);
 	}
 
 	/* patch hook indices and vertex parents */
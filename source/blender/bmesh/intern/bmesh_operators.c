@@ -34,6 +34,7 @@
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
 #include "BLI_listbase.h"
+#include "BLI_task.h"
 
 #include "BLT_translation.h"
 
@@ -582,6 +583,19 @@ int BMO_mesh_disabled_flag_count(BMesh *bm, const char htype, const short oflag)
 	return bmo_mesh_flag_count(bm, htype, oflag, false);
 }
 
+typedef struct BMOFlagDisableData {
+	BMesh *bm;
+	short oflag;
+} BMOFlagDisableData;
+
+static void bmo_mesh_flag_disable_all_cb(void *userdata, void *item)
+{
+	BMOFlagDisableData *data = userdata;
+	BMElemF *ele = item;
+
+	BMO_elem_flag_disable(data->bm, ele, data->oflag);
+}
+
 void BMO_mesh_flag_disable_all(BMesh *bm, BMOperator *UNUSED(op), const char htype, const short oflag)
 {
 	const char iter_types[3] = {BM_VERTS_OF_MESH,
@@ -590,16 +604,16 @@ void BMO_mesh_flag_disable_all(BMesh *bm, BMOperator *UNUSED(op), const char hty
 
 	const char flag_types[3] = {BM_VERT, BM_EDGE, BM_FACE};
 
-	BMElemF *ele;
+	BMOFlagDisableData data;
 	int i;
 
-#pragma omp parallel for schedule(static) if (bm->totvert + bm->totedge + bm->totface >= BM_OMP_LIMIT)
+	data.bm = bm;
+	data.oflag = oflag;
+
 	for (i = 0; i < 3; i++) {
 		if (htype & flag_types[i]) {
-			BMIter iter;
-			BM_ITER_MESH (ele, &iter, bm, iter_types[i]) {
-				BMO_elem_flag_disable(bm, ele, oflag);
-			}
+			BM_iter_parallel(bm, iter_types[i], bmo_mesh_flag_disable_all_cb, &data,
+			                 BM_iter_mesh_count(iter_types[i], bm) >= BM_OMP_LIMIT);
 		}
 	}
 }
@@ -1190,6 +1204,60 @@ void BMO_slot_buffer_flag_disable(
  * all operators have been executed. This would
  * save a lot of realloc potentially.
  */
+/* one task per element type for the flag layer functions below,
+ * each type has its own pool which only supports a single thread allocating */
+typedef struct BMOFlagLayerData {
+	BMesh *bm;
+	/* bytes copied from the old flags, the rest of a calloc'ed layer stays zero */
+	size_t copy_size;
+	bool use_calloc;
+} BMOFlagLayerData;
+
+static void bmo_flag_layer_copy_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	BMOFlagLayerData *data = userdata;
+	BMesh *bm = data->bm;
+	const char iter_types[3] = {BM_VERTS_OF_MESH,
+	                            BM_EDGES_OF_MESH,
+	                            BM_FACES_OF_MESH};
+	BLI_mempool *newpools[3] = {bm->vtoolflagpool,
+	                            bm->etoolflagpool,
+	                            bm->ftoolflagpool};
+
+	BLI_mempool *newpool = newpools[i];
+	BMIter iter;
+	BMElemF *ele;
+	int index;
+
+	/* now go through and memcpy all the flags. Loops don't get a flag layer at this time.. */
+	BM_ITER_MESH_INDEX (ele, &iter, bm, iter_types[i], index) {
+		void *oldflags = ele->oflags;
+		ele->oflags = data->use_calloc ? BLI_mempool_calloc(newpool) : BLI_mempool_alloc(newpool);
+		memcpy(ele->oflags, oldflags, data->copy_size);
+		BM_elem_index_set(ele, index); /* set_inline */
+		BM_ELEM_API_FLAG_CLEAR((BMElemF *)ele);
+	}
+}
+
+static void bmo_flag_layer_clear_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	BMesh *bm = userdata;
+	const char iter_types[3] = {BM_VERTS_OF_MESH,
+	                            BM_EDGES_OF_MESH,
+	                            BM_FACES_OF_MESH};
+	const BMFlagLayer zero_flag = {0};
+	const int totflags_offset = bm->totflags - 1;
+
+	BMIter iter;
+	BMElemF *ele;
+	int index;
+
+	BM_ITER_MESH_INDEX (ele, &iter, bm, iter_types[i], index) {
+		ele->oflags[totflags_offset] = zero_flag;
+		BM_elem_index_set(ele, index); /* set_inline */
+	}
+}
+
 static void bmo_flag_layer_alloc(BMesh *bm)
 {
 	/* set the index values since we are looping over all data anyway,
@@ -1202,64 +1270,21 @@ static void bmo_flag_layer_alloc(BMesh *bm)
 	/* store memcpy size for reuse */
 	const size_t old_totflags_size = (bm->totflags * sizeof(BMFlagLayer));
 
+	BMOFlagLayerData data;
+
 	bm->totflags++;
 
 	bm->vtoolflagpool = BLI_mempool_create(sizeof(BMFlagLayer) * bm->totflags, bm->totvert, 512, BLI_MEMPOOL_NOP);
 	bm->etoolflagpool = BLI_mempool_create(sizeof(BMFlagLayer) * bm->totflags, bm->totedge, 512, BLI_MEMPOOL_NOP);
 	bm->ftoolflagpool = BLI_mempool_create(sizeof(BMFlagLayer) * bm->totflags, bm->totface, 512, BLI_MEMPOOL_NOP);
 
-#pragma omp parallel sections if (bm->totvert + bm->totedge + bm->totface >= BM_OMP_LIMIT)
-	{
-#pragma omp section
-		{
-			BMIter iter;
-			BMElemF *ele;
-			int i;
-
-			BLI_mempool *newpool = bm->vtoolflagpool;
-
-			/* now go through and memcpy all the flags. Loops don't get a flag layer at this time.. */
-			BM_ITER_MESH_INDEX (ele, &iter, bm, BM_VERTS_OF_MESH, i) {
-				void *oldflags = ele->oflags;
-				ele->oflags = BLI_mempool_calloc(newpool);
-				memcpy(ele->oflags, oldflags, old_totflags_size);
-				BM_elem_index_set(ele, i); /* set_inline */
-				BM_ELEM_API_FLAG_CLEAR((BMElemF *)ele);
-			}
-		}
-#pragma omp section
-		{
-			BMIter iter;
-			BMElemF *ele;
-			int i;
-
-			BLI_mempool *newpool = bm->etoolflagpool;
-
-			BM_ITER_MESH_INDEX (ele, &iter, bm, BM_EDGES_OF_MESH, i) {
-				void *oldflags = ele->oflags;
-				ele->oflags = BLI_mempool_calloc(newpool);
-				memcpy(ele->oflags, oldflags, old_totflags_size);
-				BM_elem_index_set(ele, i); /* set_inline */
-				BM_ELEM_API_FLAG_CLEAR((BMElemF *)ele);
-			}
-		}
-#pragma omp section
-		{
-			BMIter iter;
-			BMElemF *ele;
-			int i;
-
-			BLI_mempool *newpool = bm->ftoolflagpool;
-
-			BM_ITER_MESH_INDEX (ele, &iter, bm, BM_FACES_OF_MESH, i) {
-				void *oldflags = ele->oflags;
-				ele->oflags = BLI_mempool_calloc(newpool);
-				memcpy(ele->oflags, oldflags, old_totflags_size);
-				BM_elem_index_set(ele, i); /* set_inline */
-				BM_ELEM_API_FLAG_CLEAR((BMElemF *)ele);
-			}
-		}
-	}
+	data.bm = bm;
+	data.copy_size = old_totflags_size;
+	data.use_calloc = true;
+
+	BLI_task_parallel_range_ex(
+	        0, 3, &data, NULL, 0, bmo_flag_layer_copy_cb,
+	        bm->totvert + bm->totedge + bm->totface >= BM_OMP_LIMIT, false);
 
 	BLI_mempool_destroy(voldpool);
 	BLI_mempool_destroy(eoldpool);
@@ -1280,6 +1305,8 @@ static void bmo_flag_layer_free(BMesh *bm)
 	/* store memcpy size for reuse */
 	const size_t new_totflags_size = ((bm->totflags - 1) * sizeof(BMFlagLayer));
 
+	BMOFlagLayerData data;
+
 	/* de-increment the totflags first.. */
 	bm->totflags--;
 
@@ -1287,58 +1314,13 @@ static void bmo_flag_layer_free(BMesh *bm)
 	bm->etoolflagpool = BLI_mempool_create(new_totflags_size, bm->totedge, 512, BLI_MEMPOOL_NOP);
 	bm->ftoolflagpool = BLI_mempool_create(new_totflags_size, bm->totface, 512, BLI_MEMPOOL_NOP);
 
-#pragma omp parallel sections if (bm->totvert + bm->totedge + bm->totface >= BM_OMP_LIMIT)
-	{
-#pragma omp section
-		{
-			BMIter iter;
-			BMElemF *ele;
-			int i;
-
-			BLI_mempool *newpool = bm->vtoolflagpool;
-
-			/* now go through and memcpy all the flag */
-			BM_ITER_MESH_INDEX (ele, &iter, bm, BM_VERTS_OF_MESH, i) {
-				void *oldflags = ele->oflags;
-				ele->oflags = BLI_mempool_alloc(newpool);
-				memcpy(ele->oflags, oldflags, new_totflags_size);
-				BM_elem_index_set(ele, i); /* set_inline */
-				BM_ELEM_API_FLAG_CLEAR((BMElemF *)ele);
-			}
-		}
-#pragma omp section
-		{
-			BMIter iter;
-			BMElemF *ele;
-			int i;
-
-			BLI_mempool *newpool = bm->etoolflagpool;
-
-			BM_ITER_MESH_INDEX (ele, &iter, bm, BM_EDGES_OF_MESH, i) {
-				void *oldflags = ele->oflags;
-				ele->oflags = BLI_mempool_alloc(newpool);
-				memcpy(ele->oflags, oldflags, new_totflags_size);
-				BM_elem_index_set(ele, i); /* set_inline */
-				BM_ELEM_API_FLAG_CLEAR((BMElemF *)ele);
-			}
-		}
-#pragma omp section
-		{
-			BMIter iter;
-			BMElemF *ele;
-			int i;
-
-			BLI_mempool *newpool = bm->ftoolflagpool;
-
-			BM_ITER_MESH_INDEX (ele, &iter, bm, BM_FACES_OF_MESH, i) {
-				void *oldflags = ele->oflags;
-				ele->oflags = BLI_mempool_alloc(newpool);
-				memcpy(ele->oflags, oldflags, new_totflags_size);
-				BM_elem_index_set(ele, i); /* set_inline */
-				BM_ELEM_API_FLAG_CLEAR((BMElemF *)ele);
-			}
-		}
-	}
+	data.bm = bm;
+	data.copy_size = new_totflags_size;
+	data.use_calloc = false;
+
+	BLI_task_parallel_range_ex(
+	        0, 3, &data, NULL, 0, bmo_flag_layer_copy_cb,
+	        bm->totvert + bm->totedge + bm->totface >= BM_OMP_LIMIT, false);
 
 	BLI_mempool_destroy(voldpool);
 	BLI_mempool_destroy(eoldpool);
@@ -1351,44 +1333,9 @@ static void bmo_flag_layer_clear(BMesh *bm)
 {
 	/* set the index values since we are looping over all data anyway,
 	 * may save time later on */
-	const BMFlagLayer zero_flag = {0};
-
-	const int totflags_offset = bm->totflags - 1;
-
-#pragma omp parallel sections if (bm->totvert + bm->totedge + bm->totface >= BM_OMP_LIMIT)
-	{
-		/* now go through and memcpy all the flag */
-#pragma omp section
-		{
-			BMIter iter;
-			BMElemF *ele;
-			int i;
-			BM_ITER_MESH_INDEX (ele, &iter, bm, BM_VERTS_OF_MESH, i) {
-				ele->oflags[totflags_offset] = zero_flag;
-				BM_elem_index_set(ele, i); /* set_inline */
-			}
-		}
-#pragma omp section
-		{
-			BMIter iter;
-			BMElemF *ele;
-			int i;
-			BM_ITER_MESH_INDEX (ele, &iter, bm, BM_EDGES_OF_MESH, i) {
-				ele->oflags[totflags_offset] = zero_flag;
-				BM_elem_index_set(ele, i); /* set_inline */
-			}
-		}
-#pragma omp section
-		{
-			BMIter iter;
-			BMElemF *ele;
-			int i;
-			BM_ITER_MESH_INDEX (ele, &iter, bm, BM_FACES_OF_MESH, i) {
-				ele->oflags[totflags_offset] = zero_flag;
-				BM_elem_index_set(ele, i); /* set_inline */
-			}
-		}
-	}
+	BLI_task_parallel_range_ex(
+	        0, 3, bm, NULL, 0, bmo_flag_layer_clear_cb,
+	        bm->totvert + bm->totedge + bm->totface >= BM_OMP_LIMIT, false);
 
 	bm->elem_index_dirty &= ~(BM_VERT | BM_EDGE | BM_FACE);
 }
@@ -30,8 +30,11 @@
 
 #include "BLI_math.h"
 #include "BLI_alloca.h"
+#include "BLI_kdtree.h"
+#include "BLI_sort_utils.h"
 #include "BLI_stackdefines.h"
 #include "BLI_stack.h"
+#include "BLI_task.h"
 
 #include "BKE_customdata.h"
 
@@ -582,6 +585,74 @@ void bmo_collapse_uvs_exec(BMesh *bm, BMOperator *op)
 
 }
 
+/**
+ * Vertices closer than the merge distance, found for every vertex of the sorted array in parallel.
+ * Only vertices after it in the array are stored, in order, so the matching below
+ * gives the same results as testing every pair of vertices.
+ */
+typedef struct FindDoublesData {
+	BMVert **verts;
+	KDTree *tree;
+	float dist;
+	float dist_sq;
+
+	/* per vertex, the range in 'doubles' */
+	int *doubles_offset;
+	int *doubles_len;
+	int *doubles;
+} FindDoublesData;
+
+typedef struct FindDoublesSearch {
+	const FindDoublesData *data;
+	int index;
+	int len;
+	int *r_doubles;
+} FindDoublesSearch;
+
+static bool bmesh_find_doubles_search_cb(void *user_data, int index, const float co[3], float UNUSED(dist_sq))
+{
+	FindDoublesSearch *search = user_data;
+	const FindDoublesData *data = search->data;
+
+	/* use the same test as comparing the vertices directly,
+	 * the tree is searched with a slightly larger range */
+	if ((index > search->index) &&
+	    compare_len_squared_v3v3(data->verts[search->index]->co, co, data->dist_sq))
+	{
+		if (search->r_doubles) {
+			search->r_doubles[search->len] = index;
+		}
+		search->len++;
+	}
+	return true;
+}
+
+static void bmesh_find_doubles_count_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	FindDoublesData *data = userdata;
+	FindDoublesSearch search = {data, i, 0, NULL};
+
+	BLI_kdtree_range_search_cb(data->tree, data->verts[i]->co, data->dist, bmesh_find_doubles_search_cb, &search);
+	data->doubles_len[i] = search.len;
+}
+
+static void bmesh_find_doubles_fill_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	FindDoublesData *data = userdata;
+	FindDoublesSearch search = {data, i, 0, NULL};
+
+	if (data->doubles_len[i] == 0) {
+		return;
+	}
+
+	search.r_doubles = &data->doubles[data->doubles_offset[i]];
+	BLI_kdtree_range_search_cb(data->tree, data->verts[i]->co, data->dist, bmesh_find_doubles_search_cb, &search);
+	BLI_assert(search.len == data->doubles_len[i]);
+
+	/* the tree doesn't return them in order */
+	qsort(search.r_doubles, search.len, sizeof(int), BLI_sortutil_cmp_int);
+}
+
 static void bmesh_find_doubles_common(
         BMesh *bm, BMOperator *op,
         BMOperator *optarget, BMOpSlot *optarget_slot)
@@ -589,11 +660,13 @@ static void bmesh_find_doubles_common(
 	BMVert  **verts;
 	int       verts_len;
 
+	FindDoublesData data;
+	int doubles_tot;
+
 	int i, j, keepvert = 0;
 
 	const float dist  = BMO_slot_float_get(op->slots_in, "dist");
 	const float dist_sq = dist * dist;
-	const float dist3 = ((float)M_SQRT3 + 0.00005f) * dist;   /* Just above sqrt(3) */
 
 	/* Test whether keep_verts arg exists and is non-empty */
 	if (BMO_slot_exists(op->slots_in, "keep_verts")) {
@@ -604,7 +677,15 @@ static void bmesh_find_doubles_common(
 	/* get the verts as an array we can sort */
 	verts = BMO_slot_as_arrayN(op->slots_in, "verts", &verts_len);
 
-	/* sort by vertex coordinates added together */
+	if (verts_len == 0) {
+		if (verts) {
+			MEM_freeN(verts);
+		}
+		return;
+	}
+
+	/* sort by vertex coordinates added together,
+	 * the vertices are matched in this order */
 	qsort(verts, verts_len, sizeof(BMVert *), vergaverco);
 
 	/* Flag keep_verts */
@@ -612,50 +693,95 @@ static void bmesh_find_doubles_common(
 		BMO_slot_buffer_flag_enable(bm, op->slots_in, "keep_verts", BM_VERT, VERT_KEEP);
 	}
 
+	data.verts = verts;
+	data.tree = BLI_kdtree_new(verts_len);
+	/* the tree's own range test may differ in the last bit, the exact test is done by the callback */
+	data.dist = dist * 1.001f + FLT_EPSILON;
+	data.dist_sq = dist_sq;
+
+	for (i = 0; i < verts_len; i++) {
+		BLI_kdtree_insert(data.tree, i, verts[i]->co);
+	}
+	BLI_kdtree_balance(data.tree);
+
+	data.doubles_len = MEM_mallocN(sizeof(*data.doubles_len) * verts_len, __func__);
+	data.doubles_offset = MEM_mallocN(sizeof(*data.doubles_offset) * verts_len, __func__);
+
+	BLI_task_parallel_range_ex(
+	        0, verts_len, &data, NULL, 0, bmesh_find_doubles_count_cb,
+	        verts_len >= BM_OMP_LIMIT, false);
+
+	doubles_tot = 0;
 	for (i = 0; i < verts_len; i++) {
+		data.doubles_offset[i] = doubles_tot;
+		doubles_tot += data.doubles_len[i];
+	}
+
+	data.doubles = NULL;
+	if (doubles_tot) {
+		data.doubles = MEM_mallocN(sizeof(*data.doubles) * doubles_tot, __func__);
+		BLI_task_parallel_range_ex(
+		        0, verts_len, &data, NULL, 0, bmesh_find_doubles_fill_cb,
+		        verts_len >= BM_OMP_LIMIT, false);
+	}
+
+	BLI_kdtree_free(data.tree);
+
+	for (i = 0; i < verts_len && doubles_tot; i++) {
 		BMVert *v_check = verts[i];
+		const int *doubles;
+		int doubles_len;
 
 		if (BMO_elem_flag_test(bm, v_check, VERT_DOUBLE | VERT_TARGET)) {
 			continue;
 		}
 
-		for (j = i + 1; j < verts_len; j++) {
-			BMVert *v_other = verts[j];
+		doubles = &data.doubles[data.doubles_offset[i]];
+		doubles_len = data.doubles_len[i];
+
+		for (j = 0; j < doubles_len; j++) {
+			BMVert *v_other = verts[doubles[j]];
 
 			/* a match has already been found, (we could check which is best, for now don't) */
 			if (BMO_elem_flag_test(bm, v_other, VERT_DOUBLE | VERT_TARGET)) {
 				continue;
 			}
 
-			/* Compare sort values of the verts using 3x tolerance (allowing for the tolerance
-			 * on each of the three axes). This avoids the more expensive length comparison
-			 * for most vertex pairs. */
-			if ((v_other->co[0] + v_other->co[1] + v_other->co[2]) -
-			    (v_check->co[0] + v_check->co[1] + v_check->co[2]) > dist3)
-			{
-				break;
-			}
-
 			if (keepvert) {
 				if (BMO_elem_flag_test(bm, v_other, VERT_KEEP) == BMO_elem_flag_test(bm, v_check, VERT_KEEP))
 					continue;
 			}
 
-			if (compare_len_squared_v3v3(v_check->co, v_other->co, dist_sq)) {
+			/* If one vert is marked as keep, make sure it will be the target */
+			if (BMO_elem_flag_test(bm, v_other, VERT_KEEP)) {
+				const int index_other = doubles[j];
 
-				/* If one vert is marked as keep, make sure it will be the target */
-				if (BMO_elem_flag_test(bm, v_other, VERT_KEEP)) {
-					SWAP(BMVert *, v_check, v_other);
-				}
+				BMO_elem_flag_enable(bm, v_check, VERT_DOUBLE);
+				BMO_elem_flag_enable(bm, v_other, VERT_TARGET);
 
-				BMO_elem_flag_enable(bm, v_other, VERT_DOUBLE);
-				BMO_elem_flag_enable(bm, v_check, VERT_TARGET);
+				BMO_slot_map_elem_insert(optarget, optarget_slot, v_check, v_other);
 
-				BMO_slot_map_elem_insert(optarget, optarget_slot, v_other, v_check);
+				/* the remaining vertices are merged into the kept one,
+				 * all vertices after it which are close to it come after it in its own list */
+				v_check = v_other;
+				doubles = &data.doubles[data.doubles_offset[index_other]];
+				doubles_len = data.doubles_len[index_other];
+				j = -1;
+				continue;
 			}
+
+			BMO_elem_flag_enable(bm, v_other, VERT_DOUBLE);
+			BMO_elem_flag_enable(bm, v_check, VERT_TARGET);
+
+			BMO_slot_map_elem_insert(optarget, optarget_slot, v_other, v_check);
 		}
 	}
 
+	MEM_freeN(data.doubles_len);
+	MEM_freeN(data.doubles_offset);
+	if (data.doubles) {
+		MEM_freeN(data.doubles);
+	}
 	MEM_freeN(verts);
 }
 
@@ -40,6 +40,7 @@
 #include "BLI_gsqueue.h"
 #include "BLI_math.h"
 #include "BLI_memarena.h"
+#include "BLI_task.h"
 
 #include "BKE_customdata.h"
 #include "BKE_deform.h"
@@ -171,6 +172,7 @@ typedef struct BevVert {
 	EdgeHalf *edges;        /* array of size edgecount; CCW order from vertex normal side */
 	BMEdge **wire_edges;	/* array of size wirecount of wire edges */
 	VMesh *vmesh;           /* mesh structure for replacing vertex */
+	VMesh *vmesh_adj;       /* subdivided mesh for M_ADJ, calculated in parallel before building the geometry */
 } BevVert;
 
 /* Bevel parameters and state */
@@ -179,6 +181,8 @@ typedef struct BevelParams {
 	 * GHash: (key=(BMVert *), value=(BevVert *)) */
 	GHash    *vert_hash;
 	MemArena *mem_arena;    /* use for all allocs while bevel runs, if we need to free we can switch to mempool */
+	MemArena **adj_mem_arenas; /* one per BevVert.vmesh_adj, so these can be allocated from threads */
+	int adj_mem_arenas_len;
 	ProfileSpacing pro_spacing; /* parameter values for evenly spaced profiles */
 
 	float offset;           /* blender units to offset each side of a beveled edge */
@@ -2782,6 +2786,74 @@ static float snap_face_dist_squared(float *co, BMFace *f, BMEdge **r_snap_e, flo
  * Given that the boundary is built and the boundary BMVerts have been made,
  * calculate the positions of the interior mesh points for the M_ADJ pattern,
  * using cubic subdivision, then make the BMVerts and the new faces. */
+/* The subdivided mesh used by bevel_build_rings, this only reads the bevel data and allocates from bp->mem_arena */
+static VMesh *adj_vmesh_calc(BevelParams *bp, BevVert *bv)
+{
+	BoundVert *vpipe = pipe_test(bv);
+
+	if (vpipe)
+		return pipe_adj_vmesh(bp, bv, vpipe);
+	else if (tri_corner_test(bp, bv))
+		return tri_corner_adj_vmesh(bp, bv);
+	else
+		return adj_vmesh(bp, bv);
+}
+
+typedef struct BevelAdjVMeshData {
+	BevelParams *bp;
+	BevVert **bevverts;
+} BevelAdjVMeshData;
+
+static void bevel_calc_adj_vmesh_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	BevelAdjVMeshData *data = userdata;
+	BevelParams bp_thread = *data->bp;
+	BevVert *bv = data->bevverts[i];
+
+	/* the shared arena can't be used from threads */
+	bp_thread.mem_arena = BLI_memarena_new(MEM_SIZE_OPTIMAL(1 << 12), __func__);
+	BLI_memarena_use_calloc(bp_thread.mem_arena);
+	data->bp->adj_mem_arenas[i] = bp_thread.mem_arena;
+
+	bv->vmesh_adj = adj_vmesh_calc(&bp_thread, bv);
+}
+
+/* Calculate the subdivided meshes of all vertices which get M_ADJ patterns in parallel,
+ * the subdivision is the most expensive part of large bevels,
+ * and does not depend on the geometry built for other vertices. */
+static void bevel_calc_adj_vmeshes(BevelParams *bp, BMesh *bm)
+{
+	BevelAdjVMeshData data;
+	BMIter iter;
+	BMVert *v;
+	BevVert *bv;
+	int bevverts_len = 0;
+
+	data.bp = bp;
+	data.bevverts = MEM_mallocN(sizeof(*data.bevverts) * BLI_ghash_size(bp->vert_hash), __func__);
+
+	BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
+		if (BM_elem_flag_test(v, BM_ELEM_TAG)) {
+			bv = find_bevvert(bp, v);
+			/* matches the vertices build_vmesh makes rings for, two welded ends use M_NONE */
+			if (bv && bv->vmesh->mesh_kind == M_ADJ && !(bv->selcount == 2 && bv->vmesh->count == 2)) {
+				data.bevverts[bevverts_len++] = bv;
+			}
+		}
+	}
+
+	if (bevverts_len) {
+		bp->adj_mem_arenas = MEM_callocN(sizeof(*bp->adj_mem_arenas) * bevverts_len, __func__);
+		bp->adj_mem_arenas_len = bevverts_len;
+
+		BLI_task_parallel_range_ex(
+		        0, bevverts_len, &data, NULL, 0, bevel_calc_adj_vmesh_cb,
+		        bevverts_len * bp->seg * bp->seg >= BM_OMP_LIMIT, true);
+	}
+
+	MEM_freeN(data.bevverts);
+}
+
 static void bevel_build_rings(BevelParams *bp, BMesh *bm, BevVert *bv)
 {
 	int n, ns, ns2, odd, i, j, k, ring;
@@ -2791,7 +2863,6 @@ static void bevel_build_rings(BevelParams *bp, BMesh *bm, BevVert *bv)
 	BMFace *f, *f2;
 	BMEdge *bme, *bme1, *bme2, *bme3;
 	EdgeHalf *e;
-	BoundVert *vpipe;
 	int mat_nr = bp->mat_nr;
 
 	n = bv->vmesh->count;
@@ -2800,14 +2871,7 @@ static void bevel_build_rings(BevelParams *bp, BMesh *bm, BevVert *bv)
 	odd = ns % 2;
 	BLI_assert(n >= 3 && ns > 1);
 
-	vpipe = pipe_test(bv);
-
-	if (vpipe)
-		vm1 = pipe_adj_vmesh(bp, bv, vpipe);
-	else if (tri_corner_test(bp, bv))
-		vm1 = tri_corner_adj_vmesh(bp, bv);
-	else
-		vm1 = adj_vmesh(bp, bv);
+	vm1 = bv->vmesh_adj ? bv->vmesh_adj : adj_vmesh_calc(bp, bv);
 
 	/* copy final vmesh into bv->vmesh, make BMVerts and BMFaces */
 	vm = bv->vmesh;
@@ -4235,6 +4299,7 @@ void BM_mesh_bevel(
 		}
 
 		/* Build the meshes around vertices, now that positions are final */
+		bevel_calc_adj_vmeshes(&bp, bm);
 		BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
 			if (BM_elem_flag_test(v, BM_ELEM_TAG)) {
 				bv = find_bevvert(&bp, v);
@@ -4270,5 +4335,12 @@ void BM_mesh_bevel(
 		/* primary free */
 		BLI_ghash_free(bp.vert_hash, NULL, NULL);
 		BLI_memarena_free(bp.mem_arena);
+		if (bp.adj_mem_arenas) {
+			int i;
+			for (i = 0; i < bp.adj_mem_arenas_len; i++) {
+				BLI_memarena_free(bp.adj_mem_arenas[i]);
+			}
+			MEM_freeN(bp.adj_mem_arenas);
+		}
 	}
 }
@@ -945,6 +945,48 @@ static int isect_bvhtree_point_v3(
 	return num_isect;
 }
 
+struct IsectOverlapUserData {
+	BMLoop *(*looptris)[3];
+	float eps_margin;
+};
+
+/**
+ * \return true when all corners of \a tri_b are further than \a eps from the plane of \a tri_a, on the same side.
+ */
+static bool tri_tri_plane_separated(BMLoop **tri_a, BMLoop **tri_b, const float eps)
+{
+	float plane[4];
+	float side[3];
+	int i;
+
+	normal_tri_v3(plane, tri_a[0]->v->co, tri_a[1]->v->co, tri_a[2]->v->co);
+	if (UNLIKELY(is_zero_v3(plane))) {
+		return false;
+	}
+	plane[3] = -dot_v3v3(plane, tri_a[0]->v->co);
+
+	for (i = 0; i < 3; i++) {
+		side[i] = dot_v3v3(plane, tri_b[i]->v->co) + plane[3];
+	}
+
+	return ((side[0] > eps && side[1] > eps && side[2] > eps) ||
+	        (side[0] < -eps && side[1] < -eps && side[2] < -eps));
+}
+
+/**
+ * Runs from the threads of #BLI_bvhtree_overlap,
+ * removes the pairs of overlapping bounds which can't touch, before the (single threaded) #bm_isect_tri_tri.
+ */
+static bool bm_isect_overlap_cb(void *userdata, int index_a, int index_b, int UNUSED(thread))
+{
+	struct IsectOverlapUserData *data = userdata;
+	BMLoop **tri_a = data->looptris[index_a];
+	BMLoop **tri_b = data->looptris[index_b];
+
+	return !(tri_tri_plane_separated(tri_a, tri_b, data->eps_margin) ||
+	         tri_tri_plane_separated(tri_b, tri_a, data->eps_margin));
+}
+
 #endif  /* USE_BVH */
 
 /**
@@ -1088,7 +1130,10 @@ bool BM_mesh_intersect(
 		tree_b = tree_a;
 	}
 
-	overlap = BLI_bvhtree_overlap(tree_b, tree_a, &tree_overlap_tot, NULL, NULL);
+	{
+		struct IsectOverlapUserData overlap_data = {looptris, s.epsilon.eps_margin};
+		overlap = BLI_bvhtree_overlap(tree_b, tree_a, &tree_overlap_tot, bm_isect_overlap_cb, &overlap_data);
+	}
 
 	if (overlap) {
 		unsigned int i;
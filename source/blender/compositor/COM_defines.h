@@ -111,4 +111,9 @@ typedef enum OrderOfChunks {
 
 #define COM_BLUR_BOKEH_PIXELS 512
 
+/**
+ * @brief memory used by the BufferCache to keep results between executions, in bytes
+ */
+#define COM_BUFFER_CACHE_LIMIT ((size_t)512 * 1024 * 1024)
+
 #endif  /* __COM_DEFINES_H__ */
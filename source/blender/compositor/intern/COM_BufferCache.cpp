@@ -0,0 +1,334 @@
+/*
+ * Copyright 2015, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <map>
+#include <string.h>
+#include <typeinfo>
+
+#include "COM_BufferCache.h"
+#include "COM_ReadBufferOperation.h"
+#include "COM_SetColorOperation.h"
+#include "COM_SetValueOperation.h"
+#include "COM_SetVectorOperation.h"
+
+extern "C" {
+#  include "BLI_hash_mm2a.h"
+#  include "BLI_utildefines.h"
+#  include "BKE_node.h"
+#  include "DNA_color_types.h"
+#  include "DNA_scene_types.h"
+#  include "RE_pipeline.h"
+}
+
+#include "MEM_guardedalloc.h"
+
+typedef struct BufferCacheEntry {
+	MemoryBuffer *buffer;
+	DataType datatype;
+	size_t size;
+	/** @brief the last execution using this entry */
+	unsigned int generation;
+} BufferCacheEntry;
+
+typedef std::map<unsigned int, BufferCacheEntry> BufferCacheMap;
+typedef std::map<NodeOperation *, unsigned int> OperationKeyMap;
+
+static BufferCacheMap g_entries;
+static size_t g_mem_used = 0;
+static unsigned int g_generation = 0;
+
+static void hash_bytes(BLI_HashMurmur2A *mm2, const void *data, size_t len)
+{
+	BLI_hash_mm2a_add(mm2, (const unsigned char *)data, len);
+}
+
+static void hash_float(BLI_HashMurmur2A *mm2, float value)
+{
+	hash_bytes(mm2, &value, sizeof(value));
+}
+
+static void hash_string(BLI_HashMurmur2A *mm2, const char *str)
+{
+	hash_bytes(mm2, str, strlen(str) + 1);
+}
+
+/* the curves are allocated separately, and localized trees copy them to new addresses */
+static void hash_curvemapping(BLI_HashMurmur2A *mm2, const CurveMapping *cumap)
+{
+	BLI_hash_mm2a_add_int(mm2, cumap->flag);
+	hash_bytes(mm2, &cumap->clipr, sizeof(cumap->clipr));
+	hash_bytes(mm2, cumap->black, sizeof(cumap->black));
+	hash_bytes(mm2, cumap->white, sizeof(cumap->white));
+
+	for (int i = 0; i < 4; i++) {
+		const CurveMap *cuma = &cumap->cm[i];
+		BLI_hash_mm2a_add_int(mm2, cuma->totpoint);
+		BLI_hash_mm2a_add_int(mm2, cuma->flag);
+		hash_bytes(mm2, cuma->ext_in, sizeof(cuma->ext_in));
+		hash_bytes(mm2, cuma->ext_out, sizeof(cuma->ext_out));
+		if (cuma->curve) {
+			hash_bytes(mm2, cuma->curve, sizeof(CurveMapPoint) * cuma->totpoint);
+		}
+	}
+}
+
+/* returns false when the result of the node can change without its settings changing */
+static bool hash_node(BLI_HashMurmur2A *mm2, const bNode *node)
+{
+	/* data-blocks like images and movie clips are not part of the node settings,
+	 * except for render layers, which are only replaced by rendering */
+	if (node->id && node->type != CMP_NODE_R_LAYERS) {
+		return false;
+	}
+	/* reads the scene camera */
+	if (node->type == CMP_NODE_DEFOCUS) {
+		return false;
+	}
+
+	BLI_hash_mm2a_add_int(mm2, node->type);
+	BLI_hash_mm2a_add_int(mm2, node->custom1);
+	BLI_hash_mm2a_add_int(mm2, node->custom2);
+	hash_float(mm2, node->custom3);
+	hash_float(mm2, node->custom4);
+
+	if (node->type == CMP_NODE_R_LAYERS) {
+		/* a render result loaded from another file can have the same settings */
+		Scene *scene = (Scene *)node->id;
+		Render *re = (scene) ? RE_GetRender(scene->id.name) : NULL;
+		RenderResult *rr = (re) ? RE_AcquireResultRead(re) : NULL;
+		hash_bytes(mm2, &rr, sizeof(rr));
+		if (re) {
+			RE_ReleaseResult(re);
+		}
+	}
+
+	if (node->storage) {
+		if (STREQ(node->typeinfo->storagename, "CurveMapping")) {
+			hash_curvemapping(mm2, (const CurveMapping *)node->storage);
+		}
+		else {
+			hash_bytes(mm2, node->storage, MEM_allocN_len(node->storage));
+		}
+	}
+
+	for (bNodeSocket *sock = (bNodeSocket *)node->inputs.first; sock; sock = sock->next) {
+		if (sock->default_value) {
+			hash_bytes(mm2, sock->default_value, MEM_allocN_len(sock->default_value));
+		}
+	}
+
+	return true;
+}
+
+static unsigned int hash_operation(NodeOperation *operation, OperationKeyMap &keys)
+{
+	OperationKeyMap::const_iterator it = keys.find(operation);
+	if (it != keys.end()) {
+		return it->second;
+	}
+
+	BLI_HashMurmur2A mm2;
+	BLI_hash_mm2a_init(&mm2, 0);
+	bool cacheable = true;
+
+	hash_string(&mm2, typeid(*operation).name());
+	BLI_hash_mm2a_add_int(&mm2, operation->getWidth());
+	BLI_hash_mm2a_add_int(&mm2, operation->getHeight());
+
+	const bNode *node = operation->getbNode();
+	if (node && !hash_node(&mm2, node)) {
+		cacheable = false;
+	}
+
+	if (operation->isSetOperation()) {
+		if (SetValueOperation *value = dynamic_cast<SetValueOperation *>(operation)) {
+			hash_float(&mm2, value->getValue());
+		}
+		else if (SetColorOperation *color = dynamic_cast<SetColorOperation *>(operation)) {
+			hash_float(&mm2, color->getChannel1());
+			hash_float(&mm2, color->getChannel2());
+			hash_float(&mm2, color->getChannel3());
+			hash_float(&mm2, color->getChannel4());
+		}
+		else if (SetVectorOperation *vector = dynamic_cast<SetVectorOperation *>(operation)) {
+			hash_float(&mm2, vector->getX());
+			hash_float(&mm2, vector->getY());
+			hash_float(&mm2, vector->getZ());
+			hash_float(&mm2, vector->getW());
+		}
+		else {
+			cacheable = false;
+		}
+	}
+
+	if (operation->isReadBufferOperation()) {
+		ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
+		unsigned int key = hash_operation(readOperation->getMemoryProxy()->getWriteBufferOperation(), keys);
+		cacheable = cacheable && key != 0;
+		BLI_hash_mm2a_add_int(&mm2, key);
+	}
+
+	for (unsigned int index = 0; index < operation->getNumberOfInputSockets() && cacheable; index++) {
+		NodeOperationInput *input = operation->getInputSocket(index);
+		unsigned int key = 0;
+		if (input->isConnected()) {
+			key = hash_operation(&input->getLink()->getOperation(), keys);
+			cacheable = key != 0;
+		}
+		BLI_hash_mm2a_add_int(&mm2, key);
+	}
+
+	unsigned int key = 0;
+	if (cacheable) {
+		key = BLI_hash_mm2a_end(&mm2);
+		/* 0 is reserved for results which can't be cached */
+		if (key == 0) {
+			key = 1;
+		}
+	}
+	keys[operation] = key;
+	return key;
+}
+
+unsigned int BufferCache::getKey(const CompositorContext &context, WriteBufferOperation *operation)
+{
+	OperationKeyMap keys;
+	unsigned int key = hash_operation(operation, keys);
+	if (key == 0) {
+		return 0;
+	}
+
+	BLI_HashMurmur2A mm2;
+	BLI_hash_mm2a_init(&mm2, key);
+
+	const RenderData *rd = context.getRenderData();
+	BLI_hash_mm2a_add_int(&mm2, rd->xsch);
+	BLI_hash_mm2a_add_int(&mm2, rd->ysch);
+	BLI_hash_mm2a_add_int(&mm2, rd->size);
+	BLI_hash_mm2a_add_int(&mm2, rd->mode);
+	BLI_hash_mm2a_add_int(&mm2, rd->sfra);
+	BLI_hash_mm2a_add_int(&mm2, rd->efra);
+	hash_float(&mm2, rd->xasp);
+	hash_float(&mm2, rd->yasp);
+	hash_bytes(&mm2, &rd->border, sizeof(rd->border));
+
+	BLI_hash_mm2a_add_int(&mm2, context.getFramenumber());
+	BLI_hash_mm2a_add_int(&mm2, context.getQuality());
+	BLI_hash_mm2a_add_int(&mm2, context.isFastCalculation());
+	hash_string(&mm2, context.getViewName() ? context.getViewName() : "");
+
+	const ColorManagedViewSettings *viewSettings = context.getViewSettings();
+	if (viewSettings) {
+		hash_string(&mm2, viewSettings->look);
+		hash_string(&mm2, viewSettings->view_transform);
+		hash_float(&mm2, viewSettings->exposure);
+		hash_float(&mm2, viewSettings->gamma);
+	}
+	const ColorManagedDisplaySettings *displaySettings = context.getDisplaySettings();
+	if (displaySettings) {
+		hash_string(&mm2, displaySettings->display_device);
+	}
+
+	key = BLI_hash_mm2a_end(&mm2);
+	return (key == 0) ? 1 : key;
+}
+
+static void free_entry(BufferCacheEntry &entry)
+{
+	delete entry.buffer;
+	g_mem_used -= entry.size;
+}
+
+/* free the entries not used since the given generation */
+static void free_unused(unsigned int generation)
+{
+	BufferCacheMap::iterator it = g_entries.begin();
+	while (it != g_entries.end()) {
+		if (it->second.generation < generation) {
+			free_entry(it->second);
+			g_entries.erase(it++);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+void BufferCache::begin()
+{
+	g_generation++;
+}
+
+void BufferCache::end()
+{
+	free_unused(g_generation);
+}
+
+MemoryBuffer *BufferCache::find(unsigned int key, DataType datatype, rcti *rect)
+{
+	BufferCacheMap::iterator it = g_entries.find(key);
+	if (it == g_entries.end()) {
+		return NULL;
+	}
+
+	BufferCacheEntry &entry = it->second;
+	if (entry.datatype != datatype || !BLI_rcti_compare(entry.buffer->getRect(), rect)) {
+		return NULL;
+	}
+
+	entry.generation = g_generation;
+	return entry.buffer;
+}
+
+void BufferCache::add(unsigned int key, DataType datatype, MemoryBuffer *buffer)
+{
+	/* restored from the cache by this execution, keys include everything the content depends on */
+	BufferCacheMap::iterator it = g_entries.find(key);
+	if (it != g_entries.end()) {
+		it->second.generation = g_generation;
+		return;
+	}
+
+	size_t size = sizeof(float) * buffer->getWidth() * buffer->getHeight() * buffer->get_num_channels();
+	if (g_mem_used + size > COM_BUFFER_CACHE_LIMIT) {
+		/* make room by dropping what the previous executions left behind */
+		free_unused(g_generation);
+		if (g_mem_used + size > COM_BUFFER_CACHE_LIMIT) {
+			return;
+		}
+	}
+
+	BufferCacheEntry entry;
+	entry.buffer = new MemoryBuffer(datatype, buffer->getRect());
+	entry.buffer->copyContentFrom(buffer);
+	entry.datatype = datatype;
+	entry.size = size;
+	entry.generation = g_generation;
+
+	g_entries[key] = entry;
+	g_mem_used += size;
+}
+
+void BufferCache::clear()
+{
+	for (BufferCacheMap::iterator it = g_entries.begin(); it != g_entries.end(); ++it) {
+		delete it->second.buffer;
+	}
+	g_entries.clear();
+	g_mem_used = 0;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2015, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _COM_BufferCache_h_
+#define _COM_BufferCache_h_
+
+#include "COM_CompositorContext.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_WriteBufferOperation.h"
+
+/**
+ * @brief cache of the results of execution groups between compositor executions
+ *
+ * The buffers are keyed by a hash of the node settings and operations leading to them,
+ * so after tweaking a node only the groups depending on it have to be calculated again.
+ * Buffers which are not used by an execution are freed when it finishes.
+ * The cache is only used while editing, all calls happen with the compositor mutex locked.
+ * @ingroup Memory
+ */
+class BufferCache {
+public:
+	/**
+	 * @brief determine the key of the buffer written by a WriteBufferOperation
+	 * @return the key, or 0 when the result can not be cached
+	 */
+	static unsigned int getKey(const CompositorContext &context, WriteBufferOperation *operation);
+
+	/**
+	 * @brief start a compositor execution
+	 */
+	static void begin();
+
+	/**
+	 * @brief finish a compositor execution, frees the buffers which were not used by it
+	 * @note not called for cancelled executions, so their buffers can still be used by the next one
+	 */
+	static void end();
+
+	/**
+	 * @brief find the cached buffer of a key
+	 * @return the buffer, or NULL when it is not cached or has a different size or type
+	 */
+	static MemoryBuffer *find(unsigned int key, DataType datatype, rcti *rect);
+
+	/**
+	 * @brief store a copy of a buffer when it fits in COM_BUFFER_CACHE_LIMIT
+	 */
+	static void add(unsigned int key, DataType datatype, MemoryBuffer *buffer);
+
+	/**
+	 * @brief free all cached buffers
+	 */
+	static void clear();
+};
+
+#endif
@@ -140,6 +140,26 @@ void ExecutionGroup::initExecution()
 
 }
 
+void ExecutionGroup::setExecuted()
+{
+	for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+		this->m_chunkExecutionStates[index] = COM_ES_EXECUTED;
+	}
+}
+
+bool ExecutionGroup::isExecuted() const
+{
+	if (this->m_numberOfChunks == 0) {
+		return false;
+	}
+	for (unsigned int index = 0; index < this->m_numberOfChunks; index++) {
+		if (this->m_chunkExecutionStates[index] != COM_ES_EXECUTED) {
+			return false;
+		}
+	}
+	return true;
+}
+
 void ExecutionGroup::deinitExecution()
 {
 	if (this->m_chunkExecutionStates != NULL) {
@@ -203,7 +223,9 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
 	NodeOperation *operation = this->getOutputOperation();
 	float centerX = 0.5;
 	float centerY = 0.5;
-	OrderOfChunks chunkorder = COM_ORDER_OF_CHUNKS_DEFAULT;
+	/* outputs which are not looked at while they progress are calculated in scanline order,
+	 * consecutive chunks then share most of their upstream areas of interest */
+	OrderOfChunks chunkorder = COM_TO_TOP_DOWN;
 
 	if (operation->isViewerOperation()) {
 		ViewerOperation *viewer = (ViewerOperation *)operation;
@@ -239,7 +261,7 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
 				chunkOrders[index].determineDistance(hotspots, 1);
 			}
 
-			std::sort(&chunkOrders[0], &chunkOrders[this->m_numberOfChunks - 1]);
+			std::sort(&chunkOrders[0], &chunkOrders[this->m_numberOfChunks]);
 			for (index = 0; index < this->m_numberOfChunks; index++) {
 				chunkOrder[index] = chunkOrders[index].getChunkNumber();
 			}
@@ -339,6 +361,7 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
 		}
 
 		WorkScheduler::finish();
+		graph->freeConsumedBuffers();
 
 		if (bTree->test_break && bTree->test_break(bTree->tbh)) {
 			breaked = true;
@@ -470,9 +493,10 @@ bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area
 	maxxchunk = min_ii(maxxchunk, (int)m_numberOfXChunks);
 	maxychunk = min_ii(maxychunk, (int)m_numberOfYChunks);
 
+	/* row by row, like the buffers are laid out */
 	bool result = true;
-	for (indexx = minxchunk; indexx < maxxchunk; indexx++) {
-		for (indexy = minychunk; indexy < maxychunk; indexy++) {
+	for (indexy = minychunk; indexy < maxychunk; indexy++) {
+		for (indexx = minxchunk; indexx < maxxchunk; indexx++) {
 			if (!scheduleChunkWhenPossible(graph, indexx, indexy)) {
 				result = false;
 			}
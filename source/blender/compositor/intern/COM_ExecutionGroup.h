@@ -399,6 +399,17 @@ public:
 
 	void setChunksize(int chunksize) { this->m_chunkSize = chunksize; }
 
+	/**
+	 * @brief mark all chunks as executed
+	 * @note used when the result of the group is restored from the BufferCache
+	 */
+	void setExecuted();
+
+	/**
+	 * @brief have all chunks of this ExecutionGroup been executed
+	 */
+	bool isExecuted() const;
+
 	/**
 	 * @brief get the Render priority of this ExecutionGroup
 	 * @see ExecutionSystem.execute
@@ -22,6 +22,9 @@
 
 #include "COM_ExecutionSystem.h"
 
+#include <algorithm>
+#include <map>
+
 #include "PIL_time.h"
 #include "BLI_utildefines.h"
 extern "C" {
@@ -30,6 +33,7 @@ extern "C" {
 
 #include "BLT_translation.h"
 
+#include "COM_BufferCache.h"
 #include "COM_Converter.h"
 #include "COM_NodeOperationBuilder.h"
 #include "COM_NodeOperation.h"
@@ -174,6 +178,14 @@ void ExecutionSystem::execute()
 		executionGroup->initExecution();
 	}
 
+	this->m_cacheKeys.clear();
+	if (!this->m_context.isRendering()) {
+		restoreCachedBuffers();
+	}
+	determineBufferReaders();
+	/* the inputs of restored groups are not needed */
+	freeConsumedBuffers();
+
 	WorkScheduler::start(this->m_context);
 
 	executeGroups(COM_PRIORITY_HIGH);
@@ -185,6 +197,12 @@ void ExecutionSystem::execute()
 	WorkScheduler::finish();
 	WorkScheduler::stop();
 
+	if (!this->m_cacheKeys.empty() && !editingtree->test_break(editingtree->tbh)) {
+		for (index = 0; index < this->m_groups.size(); index++) {
+			storeCachedBuffer(index);
+		}
+	}
+
 	editingtree->stats_draw(editingtree->sdh, IFACE_("Compositing | De-initializing execution"));
 	for (index = 0; index < this->m_operations.size(); index++) {
 		NodeOperation *operation = this->m_operations[index];
@@ -196,6 +214,100 @@ void ExecutionSystem::execute()
 	}
 }
 
+void ExecutionSystem::restoreCachedBuffers()
+{
+	for (unsigned int index = 0; index < this->m_groups.size(); index++) {
+		ExecutionGroup *group = this->m_groups[index];
+		NodeOperation *operation = group->getOutputOperation();
+		unsigned int key = 0;
+
+		if (operation->isWriteBufferOperation()) {
+			WriteBufferOperation *writeOperation = (WriteBufferOperation *)operation;
+			key = BufferCache::getKey(this->m_context, writeOperation);
+			if (key != 0) {
+				MemoryProxy *memoryProxy = writeOperation->getMemoryProxy();
+				MemoryBuffer *buffer = memoryProxy->getBuffer();
+				MemoryBuffer *cached = BufferCache::find(key, memoryProxy->getDataType(), buffer->getRect());
+				if (cached) {
+					buffer->copyContentFrom(cached);
+					group->setExecuted();
+				}
+			}
+		}
+		this->m_cacheKeys.push_back(key);
+	}
+}
+
+void ExecutionSystem::storeCachedBuffer(unsigned int index)
+{
+	ExecutionGroup *group = this->m_groups[index];
+	if (this->m_cacheKeys.empty() || this->m_cacheKeys[index] == 0 || !group->isExecuted()) {
+		return;
+	}
+
+	WriteBufferOperation *writeOperation = (WriteBufferOperation *)group->getOutputOperation();
+	MemoryProxy *memoryProxy = writeOperation->getMemoryProxy();
+	if (memoryProxy->getBuffer()) {
+		BufferCache::add(this->m_cacheKeys[index], memoryProxy->getDataType(), memoryProxy->getBuffer());
+	}
+}
+
+void ExecutionSystem::determineBufferReaders()
+{
+	std::map<ExecutionGroup *, unsigned int> groupIndices;
+	unsigned int index;
+
+	for (index = 0; index < this->m_groups.size(); index++) {
+		groupIndices[this->m_groups[index]] = index;
+	}
+
+	this->m_bufferReaders.clear();
+	this->m_bufferReaders.resize(this->m_groups.size());
+	for (index = 0; index < this->m_groups.size(); index++) {
+		ExecutionGroup *group = this->m_groups[index];
+		vector<MemoryProxy *> memoryProxies;
+		group->determineDependingMemoryProxies(&memoryProxies);
+
+		for (unsigned int proxyIndex = 0; proxyIndex < memoryProxies.size(); proxyIndex++) {
+			Groups &readers = this->m_bufferReaders[groupIndices[memoryProxies[proxyIndex]->getExecutor()]];
+			if (std::find(readers.begin(), readers.end(), group) == readers.end()) {
+				readers.push_back(group);
+			}
+		}
+	}
+}
+
+void ExecutionSystem::freeConsumedBuffers()
+{
+	const bNodeTree *editingtree = this->m_context.getbNodeTree();
+
+	for (unsigned int index = 0; index < this->m_groups.size(); index++) {
+		Groups &readers = this->m_bufferReaders[index];
+		if (readers.empty()) {
+			continue;
+		}
+
+		bool consumed = true;
+		for (unsigned int readerIndex = 0; readerIndex < readers.size(); readerIndex++) {
+			if (!readers[readerIndex]->isExecuted()) {
+				consumed = false;
+				break;
+			}
+		}
+
+		if (consumed) {
+			/* chunks cut short by a break are also marked as executed */
+			if (!editingtree->test_break(editingtree->tbh)) {
+				storeCachedBuffer(index);
+			}
+
+			WriteBufferOperation *writeOperation = (WriteBufferOperation *)this->m_groups[index]->getOutputOperation();
+			writeOperation->getMemoryProxy()->free();
+			readers.clear();
+		}
+	}
+}
+
 void ExecutionSystem::executeGroups(CompositorPriority priority)
 {
 	unsigned int index;
@@ -131,6 +131,18 @@ private:
 	 */
 	Groups m_groups;
 
+	/**
+	 * @brief BufferCache key of the result of every group, 0 when it can't be cached
+	 * @note empty when the cache is not used
+	 */
+	vector<unsigned int> m_cacheKeys;
+
+	/**
+	 * @brief the groups reading the buffer written by every group
+	 * cleared when the buffer got freed
+	 */
+	vector<Groups> m_bufferReaders;
+
 private: //methods
 	/**
 	 * find all execution group with output nodes
@@ -142,6 +154,21 @@ private: //methods
 	 */
 	void findOutputExecutionGroup(vector<ExecutionGroup *> *result) const;
 
+	/**
+	 * @brief take the results of groups from the BufferCache and determine m_cacheKeys
+	 */
+	void restoreCachedBuffers();
+
+	/**
+	 * @brief store the result of a group in the BufferCache when it is fully executed
+	 */
+	void storeCachedBuffer(unsigned int index);
+
+	/**
+	 * @brief determine m_bufferReaders
+	 */
+	void determineBufferReaders();
+
 public:
 	/**
 	 * @brief Create a new ExecutionSystem and initialize it with the
@@ -174,6 +201,12 @@ public:
 	 */
 	const CompositorContext &getContext() const { return this->m_context; }
 
+	/**
+	 * @brief free the buffers of which all readers are fully executed
+	 * @note called between batches of scheduled chunks, when no chunks are executing
+	 */
+	void freeConsumedBuffers();
+
 private:
 	void executeGroups(CompositorPriority priority);
 
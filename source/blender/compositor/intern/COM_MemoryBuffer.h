@@ -134,6 +134,19 @@ public:
 	 * @note buffer should already be available in memory
 	 */
 	float *getBuffer() { return this->m_buffer; }
+
+	/**
+	 * @brief get the data of a pixel of this MemoryBuffer
+	 * @note pixel should be inside the rect of this buffer
+	 * @param x the x-coordinate of the pixel in image space
+	 * @param y the y-coordinate of the pixel in image space
+	 */
+	inline float *getPixel(int x, int y)
+	{
+		BLI_assert(x >= this->m_rect.xmin && x < this->m_rect.xmax &&
+		           y >= this->m_rect.ymin && y < this->m_rect.ymax);
+		return &this->m_buffer[((y - this->m_rect.ymin) * this->m_width + x - this->m_rect.xmin) * this->m_num_channels];
+	}
 	
 	/**
 	 * @brief after execution the state will be set to available by calling this method
@@ -41,6 +41,7 @@ NodeOperation::NodeOperation()
 	this->m_isResolutionSet = false;
 	this->m_openCL = false;
 	this->m_btree = NULL;
+	this->m_bnode = NULL;
 }
 
 NodeOperation::~NodeOperation()
@@ -142,6 +143,14 @@ SocketReader *NodeOperation::getInputSocketReader(unsigned int inputSocketIndex)
 	return this->getInputSocket(inputSocketIndex)->getReader();
 }
 
+MemoryBuffer *NodeOperation::readInputRect(unsigned int inputSocketIndex, rcti *rect)
+{
+	NodeOperationInput *input = this->getInputSocket(inputSocketIndex);
+	MemoryBuffer *buffer = new MemoryBuffer(input->getDataType(), rect);
+	input->getReader()->readRect(buffer, rect);
+	return buffer;
+}
+
 NodeOperation *NodeOperation::getInputOperation(unsigned int inputSocketIndex)
 {
 	NodeOperationInput *input = getInputSocket(inputSocketIndex);
@@ -121,6 +121,11 @@ private:
 	 */
 	const bNodeTree *m_btree;
 
+	/**
+	 * @brief the node this operation was created for, NULL for operations added by the compositor itself
+	 */
+	const bNode *m_bnode;
+
 	/**
 	 * @brief set to truth when resolution for this operation is set
 	 */
@@ -166,6 +171,8 @@ public:
 	virtual int isSingleThreaded() { return false; }
 
 	void setbNodeTree(const bNodeTree *tree) { this->m_btree = tree; }
+	void setbNode(const bNode *node) { this->m_bnode = node; }
+	const bNode *getbNode() const { return this->m_bnode; }
 	virtual void initExecution();
 	
 	/**
@@ -315,6 +322,13 @@ protected:
 	SocketReader *getInputSocketReader(unsigned int inputSocketindex);
 	NodeOperation *getInputOperation(unsigned int inputSocketindex);
 
+	/**
+	 * @brief calculate a rectangle of an input into a new temporarily MemoryBuffer
+	 * @note the caller is responsible for deleting the buffer
+	 * @see SocketReader.executeRect
+	 */
+	MemoryBuffer *readInputRect(unsigned int inputSocketindex, rcti *rect);
+
 	void deinitMutex();
 	void initMutex();
 	void lockMutex();
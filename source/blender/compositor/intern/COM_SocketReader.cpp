@@ -21,5 +21,19 @@
  */
 
 #include "COM_SocketReader.h"
+#include "COM_MemoryBuffer.h"
 
+void SocketReader::executeRect(MemoryBuffer *output, rcti *rect)
+{
+	const int num_channels = output->get_num_channels();
+	float color[4];
 
+	for (int y = rect->ymin; y < rect->ymax; y++) {
+		float *out = output->getPixel(rect->xmin, y);
+		for (int x = rect->xmin; x < rect->xmax; x++) {
+			executePixelSampled(color, x, y, COM_PS_NEAREST);
+			memcpy(out, color, sizeof(float) * num_channels);
+			out += num_channels;
+		}
+	}
+}
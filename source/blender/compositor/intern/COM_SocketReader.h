@@ -95,6 +95,17 @@ protected:
 	                                  float /*x*/, float /*y*/,
 	                                  float /*dx*/[2], float /*dy*/[2]) {}
 
+	/**
+	 * @brief calculate all pixels of a rectangle at once
+	 * @note this method is called for non-complex
+	 * Operations overriding this read their inputs with readRect into temporary buffers
+	 * and process them in a tight loop, avoiding a chain of virtual calls per pixel.
+	 * The default implementation calls executePixelSampled for every pixel.
+	 * @param output the buffer to store the result, covering at least the rectangle
+	 * @param rect the rectangle to calculate in image space
+	 */
+	virtual void executeRect(MemoryBuffer *output, rcti *rect);
+
 public:
 	inline void readSampled(float result[4], float x, float y, PixelSampler sampler) {
 		executePixelSampled(result, x, y, sampler);
@@ -105,6 +116,9 @@ public:
 	inline void readFiltered(float result[4], float x, float y, float dx[2], float dy[2]) {
 		executePixelFiltered(result, x, y, dx, dy);
 	}
+	inline void readRect(MemoryBuffer *output, rcti *rect) {
+		executeRect(output, rect);
+	}
 
 	virtual void *initializeTileData(rcti * /*rect*/) { return 0; }
 	virtual void deinitializeTileData(rcti * /*rect*/, void * /*data*/) {}
@@ -31,6 +31,7 @@ extern "C" {
 #include "BKE_scene.h"
 
 #include "COM_compositor.h"
+#include "COM_BufferCache.h"
 #include "COM_ExecutionSystem.h"
 #include "COM_WorkScheduler.h"
 #include "clew.h"
@@ -42,6 +43,7 @@ static bool is_compositorMutex_init = false;
 static void intern_freeCompositorCaches()
 {
 	deintializeDistortionCache();
+	BufferCache::clear();
 }
 
 void COM_execute(RenderData *rd, Scene *scene, bNodeTree *editingtree, int rendering,
@@ -81,6 +83,12 @@ void COM_execute(RenderData *rd, Scene *scene, bNodeTree *editingtree, int rende
 	editingtree->progress(editingtree->prh, 0.0);
 	editingtree->stats_draw(editingtree->sdh, IFACE_("Compositing"));
 
+	/* render layers get new results, cached buffers are only used while editing */
+	if (rendering) {
+		BufferCache::clear();
+	}
+	BufferCache::begin();
+
 	bool twopass = (editingtree->flag & NTREE_TWO_PASS) > 0 && !rendering;
 	/* initialize execution system */
 	if (twopass) {
@@ -101,6 +109,10 @@ void COM_execute(RenderData *rd, Scene *scene, bNodeTree *editingtree, int rende
 	system->execute();
 	delete system;
 
+	if (!editingtree->test_break(editingtree->tbh)) {
+		BufferCache::end();
+	}
+
 	BLI_mutex_unlock(&s_compositorMutex);
 }
 
@@ -54,3 +54,47 @@ void AlphaOverPremultiplyOperation::executePixelSampled(float output[4], float x
 	}
 }
 
+void AlphaOverPremultiplyOperation::executeRect(MemoryBuffer *output, rcti *rect)
+{
+	MemoryBuffer *inputValue = this->readInputRect(0, rect);
+	MemoryBuffer *inputColor1 = this->readInputRect(1, rect);
+	MemoryBuffer *inputOverColor = this->readInputRect(2, rect);
+
+	for (int y = rect->ymin; y < rect->ymax; y++) {
+		const float *value = inputValue->getPixel(rect->xmin, y);
+		const float *color1 = inputColor1->getPixel(rect->xmin, y);
+		const float *overColor = inputOverColor->getPixel(rect->xmin, y);
+		float *out = output->getPixel(rect->xmin, y);
+		for (int x = rect->xmin; x < rect->xmax; x++) {
+			/* Zero alpha values should still permit an add of RGB data */
+			if (overColor[3] < 0.0f) {
+				copy_v4_v4(out, color1);
+			}
+			else if (value[0] == 1.0f && overColor[3] >= 1.0f) {
+				copy_v4_v4(out, overColor);
+			}
+			else {
+				float mul = 1.0f - value[0] * overColor[3];
+#ifdef __SSE2__
+				const __m128 result = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(mul), _mm_loadu_ps(color1)),
+				                                 _mm_mul_ps(_mm_set1_ps(value[0]), _mm_loadu_ps(overColor)));
+				_mm_storeu_ps(out, result);
+#else
+				out[0] = (mul * color1[0]) + value[0] * overColor[0];
+				out[1] = (mul * color1[1]) + value[0] * overColor[1];
+				out[2] = (mul * color1[2]) + value[0] * overColor[2];
+				out[3] = (mul * color1[3]) + value[0] * overColor[3];
+#endif
+			}
+
+			value += COM_NUM_CHANNELS_VALUE;
+			color1 += COM_NUM_CHANNELS_COLOR;
+			overColor += COM_NUM_CHANNELS_COLOR;
+			out += COM_NUM_CHANNELS_COLOR;
+		}
+	}
+
+	delete inputValue;
+	delete inputColor1;
+	delete inputOverColor;
+}
@@ -23,11 +23,16 @@
 #include "COM_BokehBlurOperation.h"
 #include "BLI_math.h"
 #include "COM_OpenCLDevice.h"
+#include "COM_FFTConvolution.h"
+#include "MEM_guardedalloc.h"
 
 extern "C" {
 #  include "RE_pipeline.h"
 }
 
+/* from this radius in pixels on FFT convolution is faster than sampling the bokeh per pixel */
+#define BOKEH_BLUR_FFT_MIN_RADIUS 16
+
 BokehBlurOperation::BokehBlurOperation() : NodeOperation()
 {
 	this->addInputSocket(COM_DT_COLOR);
@@ -43,6 +48,8 @@ BokehBlurOperation::BokehBlurOperation() : NodeOperation()
 	this->m_inputProgram = NULL;
 	this->m_inputBokehProgram = NULL;
 	this->m_inputBoundingBoxReader = NULL;
+	this->m_useFFT = false;
+	this->m_convolved = NULL;
 }
 
 void *BokehBlurOperation::initializeTileData(rcti * /*rect*/)
@@ -52,6 +59,9 @@ void *BokehBlurOperation::initializeTileData(rcti * /*rect*/)
 		updateSize();
 	}
 	void *buffer = getInputOperation(0)->initializeTileData(NULL);
+	if (this->m_useFFT && !this->m_convolved) {
+		this->m_convolved = createConvolvedBuffer((MemoryBuffer *)buffer);
+	}
 	unlockMutex();
 	return buffer;
 }
@@ -72,6 +82,79 @@ void BokehBlurOperation::initExecution()
 	this->m_bokehMidY = height / 2.0f;
 	this->m_bokehDimension = dimension / 2.0f;
 	QualityStepHelper::initExecution(COM_QH_INCREASE);
+
+	/* only when the size is known before the areas of interest are determined,
+	 * the convolution needs the whole input */
+	const float max_dim = max(this->getWidth(), this->getHeight());
+	this->m_useFFT = this->m_sizeavailable && getStep() == 1 &&
+	                 (int)(this->m_size * max_dim / 100.0f) >= BOKEH_BLUR_FFT_MIN_RADIUS;
+	this->m_convolved = NULL;
+}
+
+MemoryBuffer *BokehBlurOperation::createConvolvedBuffer(MemoryBuffer *input)
+{
+	const int width = input->getWidth();
+	const int height = input->getHeight();
+	const float max_dim = max(this->getWidth(), this->getHeight());
+	const int pixelSize = this->m_size * max_dim / 100.0f;
+	const int kernelSize = 2 * pixelSize + 1;
+	const float m = this->m_bokehDimension / pixelSize;
+	int x, y, ch;
+
+	/* kernel(kx, ky) weights the input at offset (pixelSize - kx, pixelSize - ky),
+	 * like in executePixel the offset of pixelSize itself is not included */
+	float *kernel = (float *)MEM_callocN(sizeof(float) * kernelSize * kernelSize * COM_NUM_CHANNELS_COLOR, __func__);
+	for (y = 1; y < kernelSize; y++) {
+		for (x = 1; x < kernelSize; x++) {
+			float u = this->m_bokehMidX - (pixelSize - x) * m;
+			float v = this->m_bokehMidY - (pixelSize - y) * m;
+			this->m_inputBokehProgram->readSampled(&kernel[(y * kernelSize + x) * COM_NUM_CHANNELS_COLOR], u, v, COM_PS_NEAREST);
+		}
+	}
+
+	MemoryBuffer *result = new MemoryBuffer(COM_DT_COLOR, input->getRect());
+	float *buffer = result->getBuffer();
+	convolve_fft(buffer, input->getBuffer(), width, height, COM_NUM_CHANNELS_COLOR,
+	             kernel, kernelSize, kernelSize, COM_NUM_CHANNELS_COLOR);
+
+	/* executePixel only adds up the bokeh inside the image, look the sums up from a summed area table */
+	const int tableSize = kernelSize + 1;
+	double *table = (double *)MEM_callocN(sizeof(double) * tableSize * tableSize * COM_NUM_CHANNELS_COLOR, __func__);
+	for (y = 0; y < kernelSize; y++) {
+		for (x = 0; x < kernelSize; x++) {
+			const float *weight = &kernel[(y * kernelSize + x) * COM_NUM_CHANNELS_COLOR];
+			double *sum = &table[((y + 1) * tableSize + x + 1) * COM_NUM_CHANNELS_COLOR];
+			const double *left = sum - COM_NUM_CHANNELS_COLOR;
+			const double *below = sum - tableSize * COM_NUM_CHANNELS_COLOR;
+			const double *corner = below - COM_NUM_CHANNELS_COLOR;
+			for (ch = 0; ch < COM_NUM_CHANNELS_COLOR; ch++) {
+				sum[ch] = weight[ch] + left[ch] + below[ch] - corner[ch];
+			}
+		}
+	}
+
+	for (y = 0; y < height; y++) {
+		/* inclusive kernel rows of the offsets inside the image */
+		const int kymin = pixelSize + 1 - min(pixelSize, height - y);
+		const int kymax = min(2 * pixelSize, pixelSize + y);
+		for (x = 0; x < width; x++) {
+			const int kxmin = pixelSize + 1 - min(pixelSize, width - x);
+			const int kxmax = min(2 * pixelSize, pixelSize + x);
+			const double *a = &table[((kymax + 1) * tableSize + kxmax + 1) * COM_NUM_CHANNELS_COLOR];
+			const double *b = &table[((kymax + 1) * tableSize + kxmin) * COM_NUM_CHANNELS_COLOR];
+			const double *c = &table[(kymin * tableSize + kxmax + 1) * COM_NUM_CHANNELS_COLOR];
+			const double *d = &table[(kymin * tableSize + kxmin) * COM_NUM_CHANNELS_COLOR];
+			float *color = &buffer[(y * width + x) * COM_NUM_CHANNELS_COLOR];
+			for (ch = 0; ch < COM_NUM_CHANNELS_COLOR; ch++) {
+				const float multiplier = (float)(a[ch] - b[ch] - c[ch] + d[ch]);
+				color[ch] = color[ch] * (1.0f / multiplier);
+			}
+		}
+	}
+
+	MEM_freeN(table);
+	MEM_freeN(kernel);
+	return result;
 }
 
 void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
@@ -81,7 +164,10 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 	float bokeh[4];
 
 	this->m_inputBoundingBoxReader->readSampled(tempBoundingBox, x, y, COM_PS_NEAREST);
-	if (tempBoundingBox[0] > 0.0f) {
+	if (tempBoundingBox[0] > 0.0f && this->m_convolved) {
+		this->m_convolved->read(output, x, y);
+	}
+	else if (tempBoundingBox[0] > 0.0f) {
 		float multiplier_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
 		MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
 		float *buffer = inputBuffer->getBuffer();
@@ -137,6 +223,10 @@ void BokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 void BokehBlurOperation::deinitExecution()
 {
 	deinitMutex();
+	if (this->m_convolved) {
+		delete this->m_convolved;
+		this->m_convolved = NULL;
+	}
 	this->m_inputProgram = NULL;
 	this->m_inputBokehProgram = NULL;
 	this->m_inputBoundingBoxReader = NULL;
@@ -148,7 +238,13 @@ bool BokehBlurOperation::determineDependingAreaOfInterest(rcti *input, ReadBuffe
 	rcti bokehInput;
 	const float max_dim = max(this->getWidth(), this->getHeight());
 
-	if (this->m_sizeavailable) {
+	if (this->m_useFFT) {
+		newInput.xmin = 0;
+		newInput.xmax = this->getWidth();
+		newInput.ymin = 0;
+		newInput.ymax = this->getHeight();
+	}
+	else if (this->m_sizeavailable) {
 		newInput.xmax = input->xmax + (this->m_size * max_dim / 100.0f);
 		newInput.xmin = input->xmin - (this->m_size * max_dim / 100.0f);
 		newInput.ymax = input->ymax + (this->m_size * max_dim / 100.0f);
@@ -37,6 +37,13 @@ private:
 	float m_bokehMidX;
 	float m_bokehMidY;
 	float m_bokehDimension;
+
+	/**
+	 * @brief large blurs are calculated at once for the whole image by FFT convolution
+	 */
+	bool m_useFFT;
+	MemoryBuffer *m_convolved;
+	MemoryBuffer *createConvolvedBuffer(MemoryBuffer *input);
 public:
 	BokehBlurOperation();
 
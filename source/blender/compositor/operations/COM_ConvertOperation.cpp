@@ -58,6 +58,24 @@ void ConvertValueToColorOperation::executePixelSampled(float output[4], float x,
 	output[3] = 1.0f;
 }
 
+void ConvertValueToColorOperation::executeRect(MemoryBuffer *output, rcti *rect)
+{
+	MemoryBuffer *input = this->readInputRect(0, rect);
+
+	for (int y = rect->ymin; y < rect->ymax; y++) {
+		const float *in = input->getPixel(rect->xmin, y);
+		float *out = output->getPixel(rect->xmin, y);
+		for (int x = rect->xmin; x < rect->xmax; x++) {
+			out[0] = out[1] = out[2] = in[0];
+			out[3] = 1.0f;
+			in += COM_NUM_CHANNELS_VALUE;
+			out += COM_NUM_CHANNELS_COLOR;
+		}
+	}
+
+	delete input;
+}
+
 
 /* ******** Color to Value ******** */
 
@@ -74,6 +92,23 @@ void ConvertColorToValueOperation::executePixelSampled(float output[4], float x,
 	output[0] = (inputColor[0] + inputColor[1] + inputColor[2]) / 3.0f;
 }
 
+void ConvertColorToValueOperation::executeRect(MemoryBuffer *output, rcti *rect)
+{
+	MemoryBuffer *input = this->readInputRect(0, rect);
+
+	for (int y = rect->ymin; y < rect->ymax; y++) {
+		const float *in = input->getPixel(rect->xmin, y);
+		float *out = output->getPixel(rect->xmin, y);
+		for (int x = rect->xmin; x < rect->xmax; x++) {
+			out[0] = (in[0] + in[1] + in[2]) / 3.0f;
+			in += COM_NUM_CHANNELS_COLOR;
+			out += COM_NUM_CHANNELS_VALUE;
+		}
+	}
+
+	delete input;
+}
+
 
 /* ******** Color to BW ******** */
 
@@ -90,6 +125,23 @@ void ConvertColorToBWOperation::executePixelSampled(float output[4], float x, fl
 	output[0] = IMB_colormanagement_get_luminance(inputColor);
 }
 
+void ConvertColorToBWOperation::executeRect(MemoryBuffer *output, rcti *rect)
+{
+	MemoryBuffer *input = this->readInputRect(0, rect);
+
+	for (int y = rect->ymin; y < rect->ymax; y++) {
+		const float *in = input->getPixel(rect->xmin, y);
+		float *out = output->getPixel(rect->xmin, y);
+		for (int x = rect->xmin; x < rect->xmax; x++) {
+			out[0] = IMB_colormanagement_get_luminance(in);
+			in += COM_NUM_CHANNELS_COLOR;
+			out += COM_NUM_CHANNELS_VALUE;
+		}
+	}
+
+	delete input;
+}
+
 
 /* ******** Color to Vector ******** */
 
@@ -0,0 +1,40 @@
+/*
+ * Copyright 2011, Blender Foundation.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor:
+ *		Jeroen Bakker
+ *		Monique Dewanchand
+ */
+
+#ifndef _COM_FFTConvolution_h
+#define _COM_FFTConvolution_h
+
+/**
+ * @brief convolve the channels of an image with a kernel using the fast Hartley transform
+ *
+ * Gives the result of a direct convolution where pixels outside the image are zero,
+ * at a cost which hardly depends on the size of the kernel:
+ * dst(x, y) = sum of image(i, j) * kernel(x - i + kernelWidth / 2, y - j + kernelHeight / 2)
+ *
+ * @param dst the result, laid out like image, channels which are not convolved are set to zero
+ * @param numChannels the number of interleaved channels of image, dst and kernel
+ * @param convolveChannels the number of channels to convolve, each with its own kernel channel
+ */
+void convolve_fft(float *dst, const float *image, int imageWidth, int imageHeight, int numChannels,
+                  const float *kernel, int kernelWidth, int kernelHeight, int convolveChannels);
+
+#endif
@@ -129,6 +129,47 @@ void MixAddOperation::executePixelSampled(float output[4], float x, float y, Pix
 	clampIfNeeded(output);
 }
 
+void MixAddOperation::executeRect(MemoryBuffer *output, rcti *rect)
+{
+	MemoryBuffer *inputValue = this->readInputRect(0, rect);
+	MemoryBuffer *inputColor1 = this->readInputRect(1, rect);
+	MemoryBuffer *inputColor2 = this->readInputRect(2, rect);
+	const bool valueAlphaMultiply = this->useValueAlphaMultiply();
+
+	for (int y = rect->ymin; y < rect->ymax; y++) {
+		const float *value_in = inputValue->getPixel(rect->xmin, y);
+		const float *color1 = inputColor1->getPixel(rect->xmin, y);
+		const float *color2 = inputColor2->getPixel(rect->xmin, y);
+		float *out = output->getPixel(rect->xmin, y);
+		for (int x = rect->xmin; x < rect->xmax; x++) {
+			float value = value_in[0];
+			if (valueAlphaMultiply) {
+				value *= color2[3];
+			}
+#ifdef __SSE2__
+			const __m128 fac = _mm_set_ps(0.0f, value, value, value);
+			__m128 result = _mm_add_ps(_mm_loadu_ps(color1), _mm_mul_ps(fac, _mm_loadu_ps(color2)));
+			_mm_storeu_ps(out, clampIfNeeded(result));
+#else
+			out[0] = color1[0] + value * color2[0];
+			out[1] = color1[1] + value * color2[1];
+			out[2] = color1[2] + value * color2[2];
+			out[3] = color1[3];
+			clampIfNeeded(out);
+#endif
+
+			value_in += COM_NUM_CHANNELS_VALUE;
+			color1 += COM_NUM_CHANNELS_COLOR;
+			color2 += COM_NUM_CHANNELS_COLOR;
+			out += COM_NUM_CHANNELS_COLOR;
+		}
+	}
+
+	delete inputValue;
+	delete inputColor1;
+	delete inputColor2;
+}
+
 /* ******** Mix Blend Operation ******** */
 
 MixBlendOperation::MixBlendOperation() : MixBaseOperation()
@@ -160,6 +201,49 @@ void MixBlendOperation::executePixelSampled(float output[4], float x, float y, P
 	clampIfNeeded(output);
 }
 
+void MixBlendOperation::executeRect(MemoryBuffer *output, rcti *rect)
+{
+	MemoryBuffer *inputValue = this->readInputRect(0, rect);
+	MemoryBuffer *inputColor1 = this->readInputRect(1, rect);
+	MemoryBuffer *inputColor2 = this->readInputRect(2, rect);
+	const bool valueAlphaMultiply = this->useValueAlphaMultiply();
+
+	for (int y = rect->ymin; y < rect->ymax; y++) {
+		const float *value_in = inputValue->getPixel(rect->xmin, y);
+		const float *color1 = inputColor1->getPixel(rect->xmin, y);
+		const float *color2 = inputColor2->getPixel(rect->xmin, y);
+		float *out = output->getPixel(rect->xmin, y);
+		for (int x = rect->xmin; x < rect->xmax; x++) {
+			float value = value_in[0];
+			if (valueAlphaMultiply) {
+				value *= color2[3];
+			}
+#ifdef __SSE2__
+			const __m128 fac = _mm_set_ps(0.0f, value, value, value);
+			const __m128 facm = _mm_set_ps(1.0f, 1.0f - value, 1.0f - value, 1.0f - value);
+			__m128 result = _mm_add_ps(_mm_mul_ps(facm, _mm_loadu_ps(color1)), _mm_mul_ps(fac, _mm_loadu_ps(color2)));
+			_mm_storeu_ps(out, clampIfNeeded(result));
+#else
+			float valuem = 1.0f - value;
+			out[0] = valuem * (color1[0]) + value * (color2[0]);
+			out[1] = valuem * (color1[1]) + value * (color2[1]);
+			out[2] = valuem * (color1[2]) + value * (color2[2]);
+			out[3] = color1[3];
+			clampIfNeeded(out);
+#endif
+
+			value_in += COM_NUM_CHANNELS_VALUE;
+			color1 += COM_NUM_CHANNELS_COLOR;
+			color2 += COM_NUM_CHANNELS_COLOR;
+			out += COM_NUM_CHANNELS_COLOR;
+		}
+	}
+
+	delete inputValue;
+	delete inputColor1;
+	delete inputColor2;
+}
+
 /* ******** Mix Burn Operation ******** */
 
 MixBurnOperation::MixBurnOperation() : MixBaseOperation()
@@ -623,6 +707,49 @@ void MixMultiplyOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+void MixMultiplyOperation::executeRect(MemoryBuffer *output, rcti *rect)
+{
+	MemoryBuffer *inputValue = this->readInputRect(0, rect);
+	MemoryBuffer *inputColor1 = this->readInputRect(1, rect);
+	MemoryBuffer *inputColor2 = this->readInputRect(2, rect);
+	const bool valueAlphaMultiply = this->useValueAlphaMultiply();
+
+	for (int y = rect->ymin; y < rect->ymax; y++) {
+		const float *value_in = inputValue->getPixel(rect->xmin, y);
+		const float *color1 = inputColor1->getPixel(rect->xmin, y);
+		const float *color2 = inputColor2->getPixel(rect->xmin, y);
+		float *out = output->getPixel(rect->xmin, y);
+		for (int x = rect->xmin; x < rect->xmax; x++) {
+			float value = value_in[0];
+			if (valueAlphaMultiply) {
+				value *= color2[3];
+			}
+#ifdef __SSE2__
+			const __m128 fac = _mm_set_ps(0.0f, value, value, value);
+			const __m128 facm = _mm_set_ps(1.0f, 1.0f - value, 1.0f - value, 1.0f - value);
+			__m128 result = _mm_mul_ps(_mm_loadu_ps(color1), _mm_add_ps(facm, _mm_mul_ps(fac, _mm_loadu_ps(color2))));
+			_mm_storeu_ps(out, clampIfNeeded(result));
+#else
+			float valuem = 1.0f - value;
+			out[0] = color1[0] * (valuem + value * color2[0]);
+			out[1] = color1[1] * (valuem + value * color2[1]);
+			out[2] = color1[2] * (valuem + value * color2[2]);
+			out[3] = color1[3];
+			clampIfNeeded(out);
+#endif
+
+			value_in += COM_NUM_CHANNELS_VALUE;
+			color1 += COM_NUM_CHANNELS_COLOR;
+			color2 += COM_NUM_CHANNELS_COLOR;
+			out += COM_NUM_CHANNELS_COLOR;
+		}
+	}
+
+	delete inputValue;
+	delete inputColor1;
+	delete inputColor2;
+}
+
 /* ******** Mix Ovelray Operation ******** */
 
 MixOverlayOperation::MixOverlayOperation() : MixBaseOperation()
@@ -806,6 +933,47 @@ void MixSubtractOperation::executePixelSampled(float output[4], float x, float y
 	clampIfNeeded(output);
 }
 
+void MixSubtractOperation::executeRect(MemoryBuffer *output, rcti *rect)
+{
+	MemoryBuffer *inputValue = this->readInputRect(0, rect);
+	MemoryBuffer *inputColor1 = this->readInputRect(1, rect);
+	MemoryBuffer *inputColor2 = this->readInputRect(2, rect);
+	const bool valueAlphaMultiply = this->useValueAlphaMultiply();
+
+	for (int y = rect->ymin; y < rect->ymax; y++) {
+		const float *value_in = inputValue->getPixel(rect->xmin, y);
+		const float *color1 = inputColor1->getPixel(rect->xmin, y);
+		const float *color2 = inputColor2->getPixel(rect->xmin, y);
+		float *out = output->getPixel(rect->xmin, y);
+		for (int x = rect->xmin; x < rect->xmax; x++) {
+			float value = value_in[0];
+			if (valueAlphaMultiply) {
+				value *= color2[3];
+			}
+#ifdef __SSE2__
+			const __m128 fac = _mm_set_ps(0.0f, value, value, value);
+			__m128 result = _mm_sub_ps(_mm_loadu_ps(color1), _mm_mul_ps(fac, _mm_loadu_ps(color2)));
+			_mm_storeu_ps(out, clampIfNeeded(result));
+#else
+			out[0] = color1[0] - value * (color2[0]);
+			out[1] = color1[1] - value * (color2[1]);
+			out[2] = color1[2] - value * (color2[2]);
+			out[3] = color1[3];
+			clampIfNeeded(out);
+#endif
+
+			value_in += COM_NUM_CHANNELS_VALUE;
+			color1 += COM_NUM_CHANNELS_COLOR;
+			color2 += COM_NUM_CHANNELS_COLOR;
+			out += COM_NUM_CHANNELS_COLOR;
+		}
+	}
+
+	delete inputValue;
+	delete inputColor1;
+	delete inputColor2;
+}
+
 /* ******** Mix Value Operation ******** */
 
 MixValueOperation::MixValueOperation() : MixBaseOperation()
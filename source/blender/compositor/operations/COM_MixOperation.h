@@ -24,6 +24,10 @@
 #define _COM_MixBaseOperation_h
 #include "COM_NodeOperation.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 
 /**
  * All this programs converts an input color to an output value.
@@ -50,6 +54,16 @@ protected:
 			CLAMP(color[3], 0.0f, 1.0f);
 		}
 	}
+
+#ifdef __SSE2__
+	inline __m128 clampIfNeeded(__m128 color)
+	{
+		if (m_useClamp) {
+			color = _mm_min_ps(_mm_max_ps(color, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+		}
+		return color;
+	}
+#endif
 	
 public:
 	/**
@@ -84,12 +98,14 @@ class MixAddOperation : public MixBaseOperation {
 public:
 	MixAddOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRect(MemoryBuffer *output, rcti *rect);
 };
 
 class MixBlendOperation : public MixBaseOperation {
 public:
 	MixBlendOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRect(MemoryBuffer *output, rcti *rect);
 };
 
 class MixBurnOperation : public MixBaseOperation {
@@ -156,6 +172,7 @@ class MixMultiplyOperation : public MixBaseOperation {
 public:
 	MixMultiplyOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRect(MemoryBuffer *output, rcti *rect);
 };
 
 class MixOverlayOperation : public MixBaseOperation {
@@ -186,6 +203,7 @@ class MixSubtractOperation : public MixBaseOperation {
 public:
 	MixSubtractOperation();
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	void executeRect(MemoryBuffer *output, rcti *rect);
 };
 
 class MixValueOperation : public MixBaseOperation {
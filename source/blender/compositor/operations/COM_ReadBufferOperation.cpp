@@ -74,6 +74,47 @@ void ReadBufferOperation::executePixelSampled(float output[4], float x, float y,
 	}
 }
 
+void ReadBufferOperation::executeRect(MemoryBuffer *output, rcti *rect)
+{
+	const int num_channels = output->get_num_channels();
+	BLI_assert(num_channels == (int)m_buffer->get_num_channels());
+
+	if (m_single_value) {
+		/* write buffer has a single value stored at (0,0) */
+		const float *value = m_buffer->getBuffer();
+		for (int y = rect->ymin; y < rect->ymax; y++) {
+			float *out = output->getPixel(rect->xmin, y);
+			for (int x = rect->xmin; x < rect->xmax; x++) {
+				memcpy(out, value, sizeof(float) * num_channels);
+				out += num_channels;
+			}
+		}
+		return;
+	}
+
+	/* same as nearest sampling, pixels outside of the buffer are zero */
+	rcti *buffer_rect = m_buffer->getRect();
+	rcti isect;
+	if (!BLI_rcti_isect(rect, buffer_rect, &isect)) {
+		BLI_rcti_init(&isect, rect->xmin, rect->xmin, rect->ymin, rect->ymin);
+	}
+	for (int y = rect->ymin; y < rect->ymax; y++) {
+		float *out = output->getPixel(rect->xmin, y);
+		if (y < isect.ymin || y >= isect.ymax) {
+			memset(out, 0, sizeof(float) * num_channels * BLI_rcti_size_x(rect));
+			continue;
+		}
+		const int num_before = isect.xmin - rect->xmin;
+		const int num_inside = BLI_rcti_size_x(&isect);
+		const int num_after = rect->xmax - isect.xmax;
+		memset(out, 0, sizeof(float) * num_channels * num_before);
+		out += num_channels * num_before;
+		memcpy(out, m_buffer->getPixel(isect.xmin, y), sizeof(float) * num_channels * num_inside);
+		out += num_channels * num_inside;
+		memset(out, 0, sizeof(float) * num_channels * num_after);
+	}
+}
+
 void ReadBufferOperation::executePixelExtend(float output[4], float x, float y, PixelSampler sampler,
                                              MemoryBufferExtend extend_x, MemoryBufferExtend extend_y)
 {
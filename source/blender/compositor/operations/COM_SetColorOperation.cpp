@@ -34,6 +34,17 @@ void SetColorOperation::executePixelSampled(float output[4],
 	copy_v4_v4(output, this->m_color);
 }
 
+void SetColorOperation::executeRect(MemoryBuffer *output, rcti *rect)
+{
+	for (int y = rect->ymin; y < rect->ymax; y++) {
+		float *out = output->getPixel(rect->xmin, y);
+		for (int x = rect->xmin; x < rect->xmax; x++) {
+			copy_v4_v4(out, this->m_color);
+			out += COM_NUM_CHANNELS_COLOR;
+		}
+	}
+}
+
 void SetColorOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
 {
 	resolution[0] = preferredResolution[0];
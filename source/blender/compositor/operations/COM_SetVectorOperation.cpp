@@ -37,6 +37,19 @@ void SetVectorOperation::executePixelSampled(float output[4],
 	output[2] = this->m_z;
 }
 
+void SetVectorOperation::executeRect(MemoryBuffer *output, rcti *rect)
+{
+	for (int y = rect->ymin; y < rect->ymax; y++) {
+		float *out = output->getPixel(rect->xmin, y);
+		for (int x = rect->xmin; x < rect->xmax; x++) {
+			out[0] = this->m_x;
+			out[1] = this->m_y;
+			out[2] = this->m_z;
+			out += COM_NUM_CHANNELS_VECTOR;
+		}
+	}
+}
+
 void SetVectorOperation::determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2])
 {
 	resolution[0] = preferredResolution[0];
@@ -22,6 +22,10 @@
 
 #include "COM_VectorBlurOperation.h"
 #include "BLI_math.h"
+extern "C" {
+#  include "BLI_task.h"
+#  include "BLI_threads.h"
+}
 
 #include "MEM_guardedalloc.h"
 
@@ -106,6 +110,42 @@ bool VectorBlurOperation::determineDependingAreaOfInterest(rcti * /*input*/, Rea
 	}
 }
 
+typedef struct VectorBlurStrips {
+	NodeBlurData *blurdata;
+	int width, height;
+	int stripHeight, overlap;
+	float *data, *image, *speed, *z;
+} VectorBlurStrips;
+
+/* calculate the rows of one strip, from the strip and the rows around it which can move into it */
+static void vector_blur_strip(void *userdata, void * /*userdata_chunk*/, int strip)
+{
+	VectorBlurStrips *strips = (VectorBlurStrips *)userdata;
+	const int width = strips->width;
+	const int ymin = strip * strips->stripHeight;
+	const int ymax = min(ymin + strips->stripHeight, strips->height);
+	const int inputYmin = max(ymin - strips->overlap, 0);
+	const int inputYmax = min(ymax + strips->overlap, strips->height);
+	const int inputHeight = inputYmax - inputYmin;
+
+	/* the speed buffer gets modified */
+	float *speed = (float *)MEM_mallocN(sizeof(float) * width * inputHeight * COM_NUM_CHANNELS_COLOR, __func__);
+	memcpy(speed, &strips->speed[inputYmin * width * COM_NUM_CHANNELS_COLOR],
+	       sizeof(float) * width * inputHeight * COM_NUM_CHANNELS_COLOR);
+	float *result = (float *)MEM_mallocN(sizeof(float) * width * inputHeight * COM_NUM_CHANNELS_COLOR, __func__);
+
+	RE_zbuf_accumulate_vecblur(strips->blurdata, width, inputHeight, result,
+	                           &strips->image[inputYmin * width * COM_NUM_CHANNELS_COLOR], speed,
+	                           &strips->z[inputYmin * width]);
+
+	memcpy(&strips->data[ymin * width * COM_NUM_CHANNELS_COLOR],
+	       &result[(ymin - inputYmin) * width * COM_NUM_CHANNELS_COLOR],
+	       sizeof(float) * width * (ymax - ymin) * COM_NUM_CHANNELS_COLOR);
+
+	MEM_freeN(result);
+	MEM_freeN(speed);
+}
+
 void VectorBlurOperation::generateVectorBlur(float *data, MemoryBuffer *inputImage, MemoryBuffer *inputSpeed, MemoryBuffer *inputZ)
 {
 	NodeBlurData blurdata;
@@ -114,6 +154,34 @@ void VectorBlurOperation::generateVectorBlur(float *data, MemoryBuffer *inputIma
 	blurdata.minspeed = this->m_settings->minspeed;
 	blurdata.curved = this->m_settings->curved;
 	blurdata.fac = this->m_settings->fac;
-	RE_zbuf_accumulate_vecblur(&blurdata, this->getWidth(), this->getHeight(), data, inputImage->getBuffer(), inputSpeed->getBuffer(), inputZ->getBuffer());
-	return;
+
+	/* with a maximum speed pixels only move a limited distance, so the image can be split
+	 * in strips which are blurred in parallel, each with the rows which can move into it */
+	const int width = this->getWidth();
+	const int height = this->getHeight();
+	int numStrips = 1;
+	int overlap = 0;
+	if (blurdata.maxspeed) {
+		/* vertex speeds are averaged with the neighbours, two rows extra */
+		overlap = (int)ceilf(blurdata.fac * blurdata.maxspeed) + 2;
+		numStrips = min(BLI_system_thread_count(), height / max(2 * overlap, 1));
+	}
+
+	if (numStrips <= 1) {
+		RE_zbuf_accumulate_vecblur(&blurdata, width, height, data, inputImage->getBuffer(), inputSpeed->getBuffer(), inputZ->getBuffer());
+		return;
+	}
+
+	VectorBlurStrips strips;
+	strips.blurdata = &blurdata;
+	strips.width = width;
+	strips.height = height;
+	strips.stripHeight = (height + numStrips - 1) / numStrips;
+	strips.overlap = overlap;
+	strips.data = data;
+	strips.image = inputImage->getBuffer();
+	strips.speed = inputSpeed->getBuffer();
+	strips.z = inputZ->getBuffer();
+
+	BLI_task_parallel_range(0, numStrips, &strips, vector_blur_strip);
 }
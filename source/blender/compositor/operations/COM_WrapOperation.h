@@ -32,6 +32,8 @@ public:
 	WrapOperation(DataType datetype);
 	bool determineDependingAreaOfInterest(rcti *input, ReadBufferOperation *readOperation, rcti *output);
 	void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+	/* wrapping is done per pixel, don't use the copy of ReadBufferOperation */
+	void executeRect(MemoryBuffer *output, rcti *rect) { NodeOperation::executeRect(output, rect); }
 
 	void setWrapping(int wrapping_type);
 	float getWrappedOriginalXPos(float x);
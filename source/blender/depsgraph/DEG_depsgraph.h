@@ -114,6 +114,14 @@ void DEG_graph_id_tag_update(struct Main *bmain,
 void DEG_graph_data_tag_update(Depsgraph *graph, const struct PointerRNA *ptr);
 void DEG_graph_property_tag_update(Depsgraph *graph, const struct PointerRNA *ptr, const struct PropertyRNA *prop);
 
+/* Tag node(s) depending on the given property in all the dependency graphs.
+ *
+ * For custom (ID) properties only the drivers reading them are tagged.
+ */
+void DEG_property_tag_update(struct Main *bmain,
+                             const struct PointerRNA *ptr,
+                             const struct PropertyRNA *prop);
+
 /* Tag given ID for an update in all the dependency graphs. */
 void DEG_id_tag_update(struct ID *id, short flag);
 void DEG_id_tag_update_ex(struct Main *bmain,
@@ -85,6 +85,35 @@ void DEG_stats_simple(const struct Depsgraph *graph,
                       size_t *r_operations,
                       size_t *r_relations);
 
+/* ************************************************ */
+/* Evaluation Profiling */
+
+typedef struct DepsgraphProfileOperation {
+	struct ID *id;
+	char name[256];          /* owner and identifier of the operation */
+	int thread;              /* task scheduler thread which evaluated it */
+	double start_time;       /* seconds since the start of the evaluation */
+	double duration;         /* seconds */
+	bool is_critical;        /* operation is part of the critical path */
+} DepsgraphProfileOperation;
+
+/* Record timing of every operation during evaluation. */
+void DEG_debug_profiling_set(struct Depsgraph *graph, bool use_profiling);
+bool DEG_debug_profiling_get(const struct Depsgraph *graph);
+
+/* Operations evaluated by the last update ordered by their start time,
+ * together with the wall time of the update and the length of the critical
+ * path, the longest chain of dependent operations. Returns the number of
+ * operations, the array is to be freed with MEM_freeN.
+ */
+int DEG_debug_profile_operations(const struct Depsgraph *graph,
+                                 DepsgraphProfileOperation **r_operations,
+                                 double *r_duration,
+                                 double *r_critical_path);
+
+/* Write the profile of the last update as a tab separated table. */
+void DEG_debug_profile_write(const struct Depsgraph *graph, FILE *stream);
+
 /* ************************************************ */
 /* Diagram-Based Graph Debugging */
 
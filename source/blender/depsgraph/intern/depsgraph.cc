@@ -63,7 +63,10 @@ static DEG_EditorUpdateScenePreCb deg_editor_update_scene_pre_cb = NULL;
 Depsgraph::Depsgraph()
   : root_node(NULL),
     need_update(false),
-    layers(0)
+    layers(0),
+    use_profiling(false),
+    profile_start_time(0.0),
+    profile_duration(0.0)
 {
 	BLI_spin_init(&lock);
 }
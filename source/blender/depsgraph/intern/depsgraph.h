@@ -195,6 +195,15 @@ struct Depsgraph {
 	/* Visible layers bitfield, used for skipping invisible objects updates. */
 	int layers;
 
+	/* Profiling .......................... */
+
+	/* Record timing of every operation during evaluation. */
+	bool use_profiling;
+
+	/* Start time and wall time of the last evaluation, in seconds. */
+	double profile_start_time;
+	double profile_duration;
+
 	// XXX: additional stuff like eval contexts, mempools for allocating nodes from, etc.
 };
 
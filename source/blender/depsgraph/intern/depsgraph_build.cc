@@ -165,7 +165,10 @@ void DEG_add_special_eval_flag(Depsgraph *graph, ID *id, short flag)
 		BLI_assert(!"ID should always be valid");
 		return;
 	}
+	/* Relations of objects might be built from multiple threads. */
+	BLI_spin_lock(&graph->lock);
 	id_node->eval_flags |= flag;
+	BLI_spin_unlock(&graph->lock);
 }
 
 /* ********************** */
@@ -240,9 +240,27 @@ struct RNAPathKey
 	PropertyRNA *prop;
 };
 
+/* Relation collected by a builder running in a worker thread, added to the
+ * graph once all threads are done.
+ */
+struct DepsgraphPendingRelation
+{
+	DepsNode *from;
+	DepsNode *to;
+	eDepsRelation_Type type;
+	const char *description;
+	bool is_time;
+};
+
+typedef vector<DepsgraphPendingRelation> DepsgraphRelationBuffer;
+
 struct DepsgraphRelationBuilder
 {
-	DepsgraphRelationBuilder(Depsgraph *graph);
+	/* When a buffer is given relations are collected in it instead of being
+	 * added to the graph, which allows building from multiple threads.
+	 */
+	DepsgraphRelationBuilder(Depsgraph *graph,
+	                         DepsgraphRelationBuffer *relation_buffer = NULL);
 
 	template <typename KeyFrom, typename KeyTo>
 	void add_relation(const KeyFrom &key_from, const KeyTo &key_to,
@@ -257,6 +275,7 @@ struct DepsgraphRelationBuilder
 	                              eDepsRelation_Type type, const char *description);
 
 	void build_scene(Main *bmain, Scene *scene);
+	void build_scene_objects(Main *bmain, Scene *scene);
 	void build_group(Main *bmain, Scene *scene, Object *object, Group *group);
 	void build_object(Main *bmain, Scene *scene, Object *ob);
 	void build_object_parent(Object *ob);
@@ -299,8 +318,14 @@ protected:
 
 	bool needs_animdata_node(ID *id);
 
+	/* Tag ID as handled, returns true if it was handled already. */
+	bool id_tag_test_and_set(ID *id);
+
+	void add_buffered_relations(const DepsgraphRelationBuffer &relations);
+
 private:
 	Depsgraph *m_graph;
+	DepsgraphRelationBuffer *m_relation_buffer;
 };
 
 struct DepsNodeHandle
@@ -39,6 +39,8 @@
 extern "C" {
 #include "BLI_blenlib.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_action_types.h"
@@ -70,6 +72,7 @@ extern "C" {
 #include "BKE_curve.h"
 #include "BKE_effect.h"
 #include "BKE_fcurve.h"
+#include "BKE_global.h"
 #include "BKE_group.h"
 #include "BKE_key.h"
 #include "BKE_library.h"
@@ -122,8 +125,10 @@ RNAPathKey::RNAPathKey(ID *id, const char *path) :
 	}
 }
 
-DepsgraphRelationBuilder::DepsgraphRelationBuilder(Depsgraph *graph) :
-    m_graph(graph)
+DepsgraphRelationBuilder::DepsgraphRelationBuilder(Depsgraph *graph,
+                                                   DepsgraphRelationBuffer *relation_buffer) :
+    m_graph(graph),
+    m_relation_buffer(relation_buffer)
 {
 }
 
@@ -209,7 +214,13 @@ void DepsgraphRelationBuilder::add_time_relation(TimeSourceDepsNode *timesrc,
                                                  const char *description)
 {
 	if (timesrc && node_to) {
-		m_graph->add_new_relation(timesrc, node_to, DEPSREL_TYPE_TIME, description);
+		if (m_relation_buffer) {
+			DepsgraphPendingRelation rel = {timesrc, node_to, DEPSREL_TYPE_TIME, description, true};
+			m_relation_buffer->push_back(rel);
+		}
+		else {
+			m_graph->add_new_relation(timesrc, node_to, DEPSREL_TYPE_TIME, description);
+		}
 	}
 	else {
 		DEG_DEBUG_PRINTF("add_time_relation(%p = %s, %p = %s, %s) Failed\n",
@@ -226,7 +237,13 @@ void DepsgraphRelationBuilder::add_operation_relation(
         const char *description)
 {
 	if (node_from && node_to) {
-		m_graph->add_new_relation(node_from, node_to, type, description);
+		if (m_relation_buffer) {
+			DepsgraphPendingRelation rel = {node_from, node_to, type, description, false};
+			m_relation_buffer->push_back(rel);
+		}
+		else {
+			m_graph->add_new_relation(node_from, node_to, type, description);
+		}
 	}
 	else {
 		DEG_DEBUG_PRINTF("add_operation_relation(%p = %s, %p = %s, %d, %s) Failed\n",
@@ -236,22 +253,129 @@ void DepsgraphRelationBuilder::add_operation_relation(
 	}
 }
 
-/* **** Functions to build relations between entities  **** */
+bool DepsgraphRelationBuilder::id_tag_test_and_set(ID *id)
+{
+	/* Builders running in parallel share tags of IDs used by several objects. */
+	if (m_relation_buffer) {
+		BLI_spin_lock(&m_graph->lock);
+	}
+	bool done = (id->tag & LIB_TAG_DOIT) != 0;
+	id->tag |= LIB_TAG_DOIT;
+	if (m_relation_buffer) {
+		BLI_spin_unlock(&m_graph->lock);
+	}
+	return done;
+}
 
-void DepsgraphRelationBuilder::build_scene(Main *bmain, Scene *scene)
+void DepsgraphRelationBuilder::add_buffered_relations(
+        const DepsgraphRelationBuffer &relations)
 {
-	/* LIB_TAG_DOIT is used to indicate whether node for given ID was already
-	 * created or not.
-	 */
-	BKE_main_id_tag_all(bmain, false);
+	for (DepsgraphRelationBuffer::const_iterator it = relations.begin();
+	     it != relations.end();
+	     ++it)
+	{
+		const DepsgraphPendingRelation &rel = *it;
+		if (rel.is_time) {
+			m_graph->add_new_relation(rel.from, rel.to, DEPSREL_TYPE_TIME, rel.description);
+		}
+		else {
+			m_graph->add_new_relation((OperationDepsNode *)rel.from,
+			                          (OperationDepsNode *)rel.to,
+			                          rel.type,
+			                          rel.description);
+		}
+	}
+}
 
-	if (scene->set) {
-		// TODO: link set to scene, especially our timesource...
+/* ******************************** */
+/* Parallel build of object relations */
+
+/* Number of objects handled by a single task. */
+#define DEG_RELATIONS_TASK_SIZE 64
+
+struct DepsgraphRelationsTask {
+	Depsgraph *graph;
+	Main *bmain;
+	Scene *scene;
+	Object **objects;
+	int num_objects;
+	DepsgraphRelationBuffer relations;
+};
+
+static void deg_relations_task_run(TaskPool *UNUSED(pool),
+                                   void *taskdata,
+                                   int UNUSED(threadid))
+{
+	DepsgraphRelationsTask *task = (DepsgraphRelationsTask *)taskdata;
+	DepsgraphRelationBuilder builder(task->graph, &task->relations);
+	for (int i = 0; i < task->num_objects; ++i) {
+		builder.build_object(task->bmain, task->scene, task->objects[i]);
 	}
+}
+
+/* Objects only look up nodes while building their relations, so they can be
+ * handled in parallel with every task collecting relations in its own
+ * buffer. Buffers are merged in order, keeping the graph deterministic.
+ *
+ * Particle systems gather effectors (which might evaluate guide curves),
+ * proxies and dupli-groups build other objects, such objects are handled
+ * serially afterwards.
+ */
+void DepsgraphRelationBuilder::build_scene_objects(Main *bmain, Scene *scene)
+{
+	vector<Object *> parallel_objects;
+	vector<Base *> serial_bases;
 
-	/* scene objects */
 	for (Base *base = (Base *)scene->base.first; base; base = base->next) {
 		Object *ob = base->object;
+		if (ob->particlesystem.first || ob->proxy || ob->dup_group) {
+			serial_bases.push_back(base);
+		}
+		else {
+			parallel_objects.push_back(ob);
+		}
+	}
+
+	TaskScheduler *task_scheduler = BLI_task_scheduler_get();
+	const int num_objects = parallel_objects.size();
+	const bool use_threading = (num_objects > DEG_RELATIONS_TASK_SIZE) &&
+	                           (BLI_task_scheduler_num_threads(task_scheduler) > 1) &&
+	                           (G.debug & G_DEBUG_DEPSGRAPH_NO_THREADS) == 0;
+
+	if (use_threading) {
+		const int num_tasks = (num_objects + DEG_RELATIONS_TASK_SIZE - 1) / DEG_RELATIONS_TASK_SIZE;
+		vector<DepsgraphRelationsTask> tasks(num_tasks);
+		TaskPool *task_pool = BLI_task_pool_create(task_scheduler, NULL);
+
+		for (int i = 0; i < num_tasks; ++i) {
+			DepsgraphRelationsTask *task = &tasks[i];
+			int first = i * DEG_RELATIONS_TASK_SIZE;
+			task->graph = m_graph;
+			task->bmain = bmain;
+			task->scene = scene;
+			task->objects = &parallel_objects[first];
+			task->num_objects = MIN2(DEG_RELATIONS_TASK_SIZE, num_objects - first);
+			BLI_task_pool_push(task_pool, deg_relations_task_run, task, false, TASK_PRIORITY_LOW);
+		}
+
+		BLI_task_pool_work_and_wait(task_pool);
+		BLI_task_pool_free(task_pool);
+
+		for (int i = 0; i < num_tasks; ++i) {
+			add_buffered_relations(tasks[i].relations);
+		}
+	}
+	else {
+		for (int i = 0; i < num_objects; ++i) {
+			build_object(bmain, scene, parallel_objects[i]);
+		}
+	}
+
+	for (vector<Base *>::const_iterator it = serial_bases.begin();
+	     it != serial_bases.end();
+	     ++it)
+	{
+		Object *ob = (*it)->object;
 
 		/* object itself */
 		build_object(bmain, scene, ob);
@@ -272,6 +396,23 @@ void DepsgraphRelationBuilder::build_scene(Main *bmain, Scene *scene)
 			build_group(bmain, scene, ob, ob->dup_group);
 		}
 	}
+}
+
+/* **** Functions to build relations between entities  **** */
+
+void DepsgraphRelationBuilder::build_scene(Main *bmain, Scene *scene)
+{
+	/* LIB_TAG_DOIT is used to indicate whether node for given ID was already
+	 * created or not.
+	 */
+	BKE_main_id_tag_all(bmain, false);
+
+	if (scene->set) {
+		// TODO: link set to scene, especially our timesource...
+	}
+
+	/* scene objects */
+	build_scene_objects(bmain, scene);
 
 	/* rigidbody */
 	if (scene->rigidbody_world) {
@@ -305,7 +446,7 @@ void DepsgraphRelationBuilder::build_group(Main *bmain,
                                            Group *group)
 {
 	ID *group_id = &group->id;
-	bool group_done = (group_id->tag & LIB_TAG_DOIT) != 0;
+	bool group_done = id_tag_test_and_set(group_id);
 	OperationKey object_local_transform_key(&object->id,
 	                                        DEPSNODE_TYPE_TRANSFORM,
 	                                        DEG_OPCODE_TRANSFORM_LOCAL);
@@ -322,7 +463,6 @@ void DepsgraphRelationBuilder::build_group(Main *bmain,
 		             DEPSREL_TYPE_TRANSFORM,
 		             "Dupligroup");
 	}
-	group_id->tag |= LIB_TAG_DOIT;
 }
 
 void DepsgraphRelationBuilder::build_object(Main *bmain, Scene *scene, Object *ob)
@@ -910,10 +1050,9 @@ void DepsgraphRelationBuilder::build_driver(ID *id, FCurve *fcu)
 void DepsgraphRelationBuilder::build_world(World *world)
 {
 	ID *world_id = &world->id;
-	if (world_id->tag & LIB_TAG_DOIT) {
+	if (id_tag_test_and_set(world_id)) {
 		return;
 	}
-	world_id->tag |= LIB_TAG_DOIT;
 
 	build_animdata(world_id);
 
@@ -1631,10 +1770,9 @@ void DepsgraphRelationBuilder::build_obdata_geom(Main *bmain, Scene *scene, Obje
 		}
 	}
 
-	if (obdata->tag & LIB_TAG_DOIT) {
+	if (id_tag_test_and_set(obdata)) {
 		return;
 	}
-	obdata->tag |= LIB_TAG_DOIT;
 
 	/* Link object data evaluation node to exit operation. */
 	OperationKey obdata_geom_eval_key(obdata, DEPSNODE_TYPE_GEOMETRY, DEG_OPCODE_PLACEHOLDER, "Geometry Eval");
@@ -1718,10 +1856,9 @@ void DepsgraphRelationBuilder::build_camera(Object *ob)
 {
 	Camera *cam = (Camera *)ob->data;
 	ID *camera_id = &cam->id;
-	if (camera_id->tag & LIB_TAG_DOIT) {
+	if (id_tag_test_and_set(camera_id)) {
 		return;
 	}
-	camera_id->tag |= LIB_TAG_DOIT;
 
 	ComponentKey parameters_key(camera_id, DEPSNODE_TYPE_PARAMETERS);
 
@@ -1744,10 +1881,9 @@ void DepsgraphRelationBuilder::build_lamp(Object *ob)
 {
 	Lamp *la = (Lamp *)ob->data;
 	ID *lamp_id = &la->id;
-	if (lamp_id->tag & LIB_TAG_DOIT) {
+	if (id_tag_test_and_set(lamp_id)) {
 		return;
 	}
-	lamp_id->tag |= LIB_TAG_DOIT;
 
 	ComponentKey parameters_key(lamp_id, DEPSNODE_TYPE_PARAMETERS);
 
@@ -1794,9 +1930,8 @@ void DepsgraphRelationBuilder::build_nodetree(ID *owner, bNodeTree *ntree)
 			}
 			else if (bnode->type == NODE_GROUP) {
 				bNodeTree *group_ntree = (bNodeTree *)bnode->id;
-				if ((group_ntree->id.tag & LIB_TAG_DOIT) == 0) {
+				if (!id_tag_test_and_set(&group_ntree->id)) {
 					build_nodetree(owner, group_ntree);
-					group_ntree->id.tag |= LIB_TAG_DOIT;
 				}
 				OperationKey group_parameters_key(&group_ntree->id,
 				                                  DEPSNODE_TYPE_PARAMETERS,
@@ -1821,10 +1956,9 @@ void DepsgraphRelationBuilder::build_nodetree(ID *owner, bNodeTree *ntree)
 void DepsgraphRelationBuilder::build_material(ID *owner, Material *ma)
 {
 	ID *ma_id = &ma->id;
-	if (ma_id->tag & LIB_TAG_DOIT) {
+	if (id_tag_test_and_set(ma_id)) {
 		return;
 	}
-	ma_id->tag |= LIB_TAG_DOIT;
 
 	/* animation */
 	build_animdata(ma_id);
@@ -1840,10 +1974,9 @@ void DepsgraphRelationBuilder::build_material(ID *owner, Material *ma)
 void DepsgraphRelationBuilder::build_texture(ID *owner, Tex *tex)
 {
 	ID *tex_id = &tex->id;
-	if (tex_id->tag & LIB_TAG_DOIT) {
+	if (id_tag_test_and_set(tex_id)) {
 		return;
 	}
-	tex_id->tag |= LIB_TAG_DOIT;
 
 	/* texture itself */
 	build_animdata(tex_id);
@@ -32,8 +32,11 @@
 
 //#include <stdlib.h>
 #include <string.h>
+#include <algorithm>
 
 extern "C" {
+#include "MEM_guardedalloc.h"
+
 #include "BLI_utildefines.h"
 #include "BLI_listbase.h"
 #include "BLI_ghash.h"
@@ -56,6 +59,9 @@ extern "C" {
 #include "depsnode_operation.h"
 #include "depsgraph_intern.h"
 
+#include "depsgraph_util_map.h"
+#include "depsgraph_util_set.h"
+
 /* ****************** */
 /* Graphviz Debugging */
 
@@ -1208,3 +1214,181 @@ void DEG_stats_simple(const Depsgraph *graph, size_t *r_outer,
 	}
 }
 
+/* ******************** */
+/* Evaluation Profiling */
+
+void DEG_debug_profiling_set(Depsgraph *graph, bool use_profiling)
+{
+	graph->use_profiling = use_profiling;
+}
+
+bool DEG_debug_profiling_get(const Depsgraph *graph)
+{
+	return graph->use_profiling;
+}
+
+static bool deg_profile_operation_cmp(const DepsgraphProfileOperation &a,
+                                      const DepsgraphProfileOperation &b)
+{
+	return a.start_time < b.start_time;
+}
+
+/* Longest chain of dependent operations weighted by their duration in the
+ * last evaluation, operations which were not evaluated take no time.
+ * Evaluated operations along the chain are added to the given set.
+ */
+static double deg_profile_critical_path(const Depsgraph *graph,
+                                        unordered_set<const OperationDepsNode *> &r_critical)
+{
+	const size_t num_operations = graph->operations.size();
+	unordered_map<const OperationDepsNode *, size_t> indices;
+	vector<size_t> num_pending(num_operations, 0);
+	vector<double> start(num_operations, 0.0);
+	vector<double> finish(num_operations, 0.0);
+	vector<size_t> prev(num_operations, num_operations);
+	vector<size_t> stack;
+
+	for (size_t i = 0; i < num_operations; ++i) {
+		indices[graph->operations[i]] = i;
+	}
+
+	for (size_t i = 0; i < num_operations; ++i) {
+		const OperationDepsNode *node = graph->operations[i];
+		for (OperationDepsNode::Relations::const_iterator it_rel = node->inlinks.begin();
+		     it_rel != node->inlinks.end();
+		     ++it_rel)
+		{
+			DepsRelation *rel = *it_rel;
+			if (rel->from->type == DEPSNODE_TYPE_OPERATION &&
+			    (rel->flag & DEPSREL_FLAG_CYCLIC) == 0)
+			{
+				++num_pending[i];
+			}
+		}
+		if (num_pending[i] == 0) {
+			stack.push_back(i);
+		}
+	}
+
+	/* Operations are visited in topological order. */
+	size_t last = num_operations;
+	while (!stack.empty()) {
+		size_t i = stack.back();
+		stack.pop_back();
+
+		const OperationDepsNode *node = graph->operations[i];
+		const double duration = (node->eval_thread != -1) ? node->eval_duration : 0.0;
+		finish[i] = start[i] + duration;
+		if (last == num_operations || finish[i] > finish[last]) {
+			last = i;
+		}
+
+		for (OperationDepsNode::Relations::const_iterator it_rel = node->outlinks.begin();
+		     it_rel != node->outlinks.end();
+		     ++it_rel)
+		{
+			DepsRelation *rel = *it_rel;
+			if (rel->to->type != DEPSNODE_TYPE_OPERATION ||
+			    (rel->flag & DEPSREL_FLAG_CYCLIC) != 0)
+			{
+				continue;
+			}
+			size_t j = indices[(OperationDepsNode *)rel->to];
+			if (finish[i] > start[j]) {
+				start[j] = finish[i];
+				prev[j] = i;
+			}
+			if (--num_pending[j] == 0) {
+				stack.push_back(j);
+			}
+		}
+	}
+
+	if (last == num_operations) {
+		return 0.0;
+	}
+
+	for (size_t i = last; i != num_operations; i = prev[i]) {
+		const OperationDepsNode *node = graph->operations[i];
+		if (node->eval_thread != -1) {
+			r_critical.insert(node);
+		}
+	}
+
+	return finish[last];
+}
+
+int DEG_debug_profile_operations(const Depsgraph *graph,
+                                 DepsgraphProfileOperation **r_operations,
+                                 double *r_duration,
+                                 double *r_critical_path)
+{
+	unordered_set<const OperationDepsNode *> critical;
+	double critical_path = deg_profile_critical_path(graph, critical);
+	vector<DepsgraphProfileOperation> operations;
+
+	for (Depsgraph::OperationNodes::const_iterator it = graph->operations.begin();
+	     it != graph->operations.end();
+	     ++it)
+	{
+		const OperationDepsNode *node = *it;
+		if (node->eval_thread == -1) {
+			continue;
+		}
+
+		DepsgraphProfileOperation op;
+		op.id = node->owner->owner->id;
+		BLI_strncpy(op.name, node->full_identifier().c_str(), sizeof(op.name));
+		op.thread = node->eval_thread;
+		op.start_time = node->eval_start_time;
+		op.duration = node->eval_duration;
+		op.is_critical = critical.find(node) != critical.end();
+		operations.push_back(op);
+	}
+
+	std::sort(operations.begin(), operations.end(), deg_profile_operation_cmp);
+
+	if (r_operations) {
+		*r_operations = NULL;
+		if (!operations.empty()) {
+			*r_operations = (DepsgraphProfileOperation *)MEM_mallocN(
+			        sizeof(DepsgraphProfileOperation) * operations.size(),
+			        "Depsgraph Profile Operations");
+			memcpy(*r_operations, &operations[0],
+			       sizeof(DepsgraphProfileOperation) * operations.size());
+		}
+	}
+	if (r_duration) *r_duration = graph->profile_duration;
+	if (r_critical_path) *r_critical_path = critical_path;
+
+	return operations.size();
+}
+
+void DEG_debug_profile_write(const Depsgraph *graph, FILE *f)
+{
+	DepsgraphProfileOperation *operations;
+	double duration, critical_path;
+	int num_operations = DEG_debug_profile_operations(graph,
+	                                                  &operations,
+	                                                  &duration,
+	                                                  &critical_path);
+
+	fprintf(f, "# %d operations, evaluation %.3f ms, critical path %.3f ms\n",
+	        num_operations, duration * 1000.0, critical_path * 1000.0);
+	fprintf(f, "ID\tOperation\tThread\tStart (ms)\tDuration (ms)\tCritical\n");
+
+	for (int i = 0; i < num_operations; ++i) {
+		const DepsgraphProfileOperation *op = &operations[i];
+		fprintf(f, "%s\t%s\t%d\t%.3f\t%.3f\t%d\n",
+		        op->id->name,
+		        op->name,
+		        op->thread,
+		        op->start_time * 1000.0,
+		        op->duration * 1000.0,
+		        op->is_critical ? 1 : 0);
+	}
+
+	if (operations) {
+		MEM_freeN(operations);
+	}
+}
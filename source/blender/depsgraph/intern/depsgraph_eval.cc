@@ -30,6 +30,8 @@
  * Evaluation engine entrypoints for Depsgraph Engine.
  */
 
+#include <algorithm>
+
 #include "MEM_guardedalloc.h"
 
 #include "PIL_time.h"
@@ -119,10 +121,10 @@ void DEG_evaluation_context_free(EvaluationContext *eval_ctx)
 /* Evaluation Entrypoints */
 
 /* Forward declarations. */
-static void schedule_children(TaskPool *pool,
-                              Depsgraph *graph,
-                              OperationDepsNode *node,
-                              const int layers);
+static OperationDepsNode *schedule_children(TaskPool *pool,
+                                            Depsgraph *graph,
+                                            OperationDepsNode *node,
+                                            const int layers);
 
 struct DepsgraphEvalState {
 	EvaluationContext *eval_ctx;
@@ -130,13 +132,10 @@ struct DepsgraphEvalState {
 	int layers;
 };
 
-static void deg_task_run_func(TaskPool *pool,
-                              void *taskdata,
-                              int UNUSED(threadid))
+static void deg_task_eval_node(DepsgraphEvalState *state,
+                               OperationDepsNode *node,
+                               int threadid)
 {
-	DepsgraphEvalState *state = (DepsgraphEvalState *)BLI_task_pool_userdata(pool);
-	OperationDepsNode *node = (OperationDepsNode *)taskdata;
-
 	if (!node->is_noop()) {
 		/* Get context. */
 		// TODO: who initialises this? "Init" operations aren't able to initialise it!!!
@@ -159,9 +158,29 @@ static void deg_task_run_func(TaskPool *pool,
 		DepsgraphDebug::task_completed(state->graph,
 		                               node,
 		                               end_time - start_time);
+
+		if (state->graph->use_profiling) {
+			node->eval_start_time = start_time - state->graph->profile_start_time;
+			node->eval_duration = end_time - start_time;
+			node->eval_thread = threadid;
+		}
 	}
+}
 
-	schedule_children(pool, state->graph, node, state->layers);
+static void deg_task_run_func(TaskPool *pool,
+                              void *taskdata,
+                              int threadid)
+{
+	DepsgraphEvalState *state = (DepsgraphEvalState *)BLI_task_pool_userdata(pool);
+	OperationDepsNode *node = (OperationDepsNode *)taskdata;
+
+	/* Evaluate chains of operations on this thread, without a task for each
+	 * of them.
+	 */
+	while (node != NULL) {
+		deg_task_eval_node(state, node, threadid);
+		node = schedule_children(pool, state->graph, node, state->layers);
+	}
 }
 
 static void calculate_pending_parents(Depsgraph *graph, int layers)
@@ -212,7 +231,7 @@ static void calculate_eval_priority(OperationDepsNode *node)
 		/* XXX standard cost of a node, could be estimated somewhat later on */
 		const float cost = 1.0f;
 		/* NOOP nodes have no cost */
-		node->eval_priority = node->is_noop() ? cost : 0.0f;
+		node->eval_priority = node->is_noop() ? 0.0f : cost;
 
 		for (OperationDepsNode::Relations::const_iterator it = node->outlinks.begin();
 		     it != node->outlinks.end();
@@ -230,6 +249,27 @@ static void calculate_eval_priority(OperationDepsNode *node)
 	}
 }
 
+/* Operations which have other updates waiting on them go first, the
+ * priority of an operation includes the cost of all its dependents.
+ */
+static TaskPriority deg_task_priority(const OperationDepsNode *node)
+{
+	return (node->eval_priority > 1.0f) ? TASK_PRIORITY_HIGH : TASK_PRIORITY_LOW;
+}
+
+/* Choose which of two ready operations continues on the current thread:
+ * NOOPs take no time so they are always handled inline, otherwise the one
+ * with most work depending on it.
+ */
+static bool deg_continue_with(const OperationDepsNode *node,
+                              const OperationDepsNode *other)
+{
+	if (node->is_noop() != other->is_noop()) {
+		return node->is_noop();
+	}
+	return node->eval_priority > other->eval_priority;
+}
+
 static void schedule_graph(TaskPool *pool,
                            Depsgraph *graph,
                            const int layers)
@@ -245,18 +285,24 @@ static void schedule_graph(TaskPool *pool,
 		    node->num_links_pending == 0 &&
 		    (id_node->layers & layers) != 0)
 		{
-			BLI_task_pool_push(pool, deg_task_run_func, node, false, TASK_PRIORITY_LOW);
+			BLI_task_pool_push(pool, deg_task_run_func, node, false, deg_task_priority(node));
 			node->scheduled = true;
 		}
 	}
 	BLI_spin_unlock(&graph->lock);
 }
 
-static void schedule_children(TaskPool *pool,
-                              Depsgraph *graph,
-                              OperationDepsNode *node,
-                              const int layers)
+/* Schedule children which became ready after evaluating the node. One of
+ * them is returned instead of being pushed, to be evaluated by the calling
+ * thread right away.
+ */
+static OperationDepsNode *schedule_children(TaskPool *pool,
+                                            Depsgraph *graph,
+                                            OperationDepsNode *node,
+                                            const int layers)
 {
+	OperationDepsNode *next = NULL;
+
 	for (OperationDepsNode::Relations::const_iterator it = node->outlinks.begin();
 	     it != node->outlinks.end();
 	     ++it)
@@ -286,11 +332,20 @@ static void schedule_children(TaskPool *pool,
 				BLI_spin_unlock(&graph->lock);
 
 				if (need_schedule) {
-					BLI_task_pool_push(pool, deg_task_run_func, child, false, TASK_PRIORITY_LOW);
+					if (next == NULL) {
+						next = child;
+						continue;
+					}
+					if (deg_continue_with(child, next)) {
+						std::swap(child, next);
+					}
+					BLI_task_pool_push(pool, deg_task_run_func, child, false, deg_task_priority(child));
 				}
 			}
 		}
 	}
+
+	return next;
 }
 
 /**
@@ -338,6 +393,10 @@ void DEG_evaluate_on_refresh_ex(EvaluationContext *eval_ctx,
 	{
 		OperationDepsNode *node = *it;
 		node->done = 0;
+		if (graph->use_profiling) {
+			node->eval_duration = 0.0;
+			node->eval_thread = -1;
+		}
 	}
 
 	/* Calculate priority for operation nodes. */
@@ -351,11 +410,19 @@ void DEG_evaluate_on_refresh_ex(EvaluationContext *eval_ctx,
 
 	DepsgraphDebug::eval_begin(eval_ctx);
 
+	if (graph->use_profiling) {
+		graph->profile_start_time = PIL_check_seconds_timer();
+	}
+
 	schedule_graph(task_pool, graph, layers);
 
 	BLI_task_pool_work_and_wait(task_pool);
 	BLI_task_pool_free(task_pool);
 
+	if (graph->use_profiling) {
+		graph->profile_duration = PIL_check_seconds_timer() - graph->profile_start_time;
+	}
+
 	DepsgraphDebug::eval_end(eval_ctx);
 
 	/* Clear any uncleared tags - just in case. */
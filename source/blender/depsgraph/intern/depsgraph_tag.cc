@@ -51,6 +51,8 @@ extern "C" {
 #undef new
 
 #include "DEG_depsgraph.h"
+
+#include "RNA_access.h"
 } /* extern "C" */
 
 #include "depsgraph_debug.h"
@@ -145,6 +147,47 @@ void depsgraph_legacy_handle_update_tag(Main *bmain, ID *id, short flag)
 }
 #endif
 
+/* Custom (ID) properties are not evaluated by any operation, the only nodes
+ * reading them are drivers. Tag those drivers directly, so the operations of
+ * the component owning the property are not re-evaluated.
+ *
+ * Returns false if the drivers can not be found.
+ */
+bool id_property_tag_drivers(Depsgraph *graph,
+                             const PointerRNA *ptr,
+                             const PropertyRNA *prop)
+{
+	DepsNode *node = graph->find_node_from_pointer(ptr, prop);
+	if (node == NULL || node->tclass != DEPSNODE_CLASS_COMPONENT) {
+		return false;
+	}
+	ComponentDepsNode *comp_node = (ComponentDepsNode *)node;
+	for (ComponentDepsNode::OperationMap::const_iterator it = comp_node->operations.begin();
+	     it != comp_node->operations.end();
+	     ++it)
+	{
+		OperationDepsNode *op_node = it->second;
+		if (op_node->opcode == DEG_OPCODE_DRIVER) {
+			/* Relations from a driver go to the data it drives. */
+			continue;
+		}
+		for (OperationDepsNode::Relations::const_iterator rel_it = op_node->outlinks.begin();
+		     rel_it != op_node->outlinks.end();
+		     ++rel_it)
+		{
+			DepsRelation *rel = *rel_it;
+			if (!ELEM(rel->type, DEPSREL_TYPE_DRIVER, DEPSREL_TYPE_DRIVER_TARGET)) {
+				continue;
+			}
+			OperationDepsNode *to_node = (OperationDepsNode *)rel->to;
+			if (to_node->opcode == DEG_OPCODE_DRIVER) {
+				to_node->tag_update(graph);
+			}
+		}
+	}
+	return true;
+}
+
 }  /* namespace */
 
 /* Tag all nodes in ID-block for update.
@@ -177,6 +220,19 @@ void DEG_graph_property_tag_update(Depsgraph *graph,
                                    const PointerRNA *ptr,
                                    const PropertyRNA *prop)
 {
+	if (RNA_property_is_idprop((PropertyRNA *)prop)) {
+		if (id_property_tag_drivers(graph, ptr, prop)) {
+			return;
+		}
+		/* Property is not addressable in the graph, play safe and
+		 * re-evaluate everything it might affect.
+		 */
+		IDDepsNode *id_node = graph->find_id_node((ID *)ptr->id.data);
+		if (id_node != NULL) {
+			id_node->tag_update(graph);
+		}
+		return;
+	}
 	DepsNode *node = graph->find_node_from_pointer(ptr, prop);
 	if (node) {
 		node->tag_update(graph);
@@ -187,6 +243,28 @@ void DEG_graph_property_tag_update(Depsgraph *graph,
 	}
 }
 
+/* Tag given property for an update in all the dependency graphs. */
+void DEG_property_tag_update(Main *bmain,
+                             const PointerRNA *ptr,
+                             const PropertyRNA *prop)
+{
+	ID *id = (ID *)ptr->id.data;
+	if (id == NULL) {
+		return;
+	}
+	DEG_DEBUG_PRINTF("%s: id=%s\n", __func__, id->name);
+	/* Render engines still check the ID for changes. */
+	lib_id_recalc_tag(bmain, id);
+	for (Scene *scene = (Scene *)bmain->scene.first;
+	     scene != NULL;
+	     scene = (Scene *)scene->id.next)
+	{
+		if (scene->depsgraph) {
+			DEG_graph_property_tag_update(scene->depsgraph, ptr, prop);
+		}
+	}
+}
+
 /* Tag given ID for an update in all the dependency graphs. */
 void DEG_id_tag_update(ID *id, short flag)
 {
@@ -353,9 +431,15 @@ void DEG_graph_flush_updates(Main *bmain, Depsgraph *graph)
 		/* TODO(sergey): For until incremental updates are possible
 		 * witin a component at least we tag the whole component
 		 * for update.
+		 *
+		 * Drivers are an exception, they don't depend on each other
+		 * within the component and all their inputs are explicit
+		 * relations, so only the drivers reached here are evaluated.
 		 */
 		ComponentDepsNode *component = node->owner;
-		if ((component->flags & DEPSCOMP_FULLY_SCHEDULED) == 0) {
+		if (node->opcode != DEG_OPCODE_DRIVER &&
+		    (component->flags & DEPSCOMP_FULLY_SCHEDULED) == 0)
+		{
 			for (ComponentDepsNode::OperationMap::iterator it = component->operations.begin();
 			     it != node->owner->operations.end();
 			     ++it)
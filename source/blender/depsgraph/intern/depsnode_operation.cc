@@ -56,7 +56,10 @@ const char *DEG_OPNAMES[] = {
 
 OperationDepsNode::OperationDepsNode() :
     eval_priority(0.0f),
-    flag(0)
+    flag(0),
+    eval_start_time(0.0),
+    eval_duration(0.0),
+    eval_thread(-1)
 {
 }
 
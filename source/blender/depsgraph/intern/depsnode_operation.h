@@ -82,6 +82,14 @@ struct OperationDepsNode : public DepsNode {
 
 	int flag;                     /* (eDepsOperation_Flag) extra settings affecting evaluation */
 
+	/* Timing of the last evaluation, only recorded when the graph has
+	 * profiling enabled. Start time is relative to the start of evaluation,
+	 * thread is -1 when the operation was not evaluated.
+	 */
+	double eval_start_time;
+	double eval_duration;
+	int eval_thread;
+
 	DEG_DEPSNODE_DECLARE;
 };
 
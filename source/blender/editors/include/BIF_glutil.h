@@ -153,6 +153,9 @@ void glaDrawPixelsAuto(float x, float y, int img_w, int img_h, int format, int t
 
 
 void glaDrawPixelsTexScaled(float x, float y, int img_w, int img_h, int format, int type, int zoomfilter, void *rect, float scaleX, float scaleY);
+void glaDrawPixelsTexScaled_clipping(float x, float y, int img_w, int img_h, int format, int type, int zoomfilter,
+                                     void *rect, float scaleX, float scaleY,
+                                     float clip_min_x, float clip_min_y, float clip_max_x, float clip_max_y);
 
 /* 2D Drawing Assistance */
 
@@ -210,6 +213,9 @@ void bgl_get_mats(bglMats *mats);
 
 /* **** Color management helper functions for GLSL display/transform ***** */
 
+/* Image draw method from the user preferences, with automatic resolved to GLSL or 2D texture */
+int glaImageDrawMethod(void);
+
 /* Draw imbuf on a screen, preferably using GLSL display transform */
 void glaDrawImBuf_glsl(struct ImBuf *ibuf, float x, float y, int zoomfilter,
                        struct ColorManagedViewSettings *view_settings,
@@ -218,6 +224,14 @@ void glaDrawImBuf_glsl(struct ImBuf *ibuf, float x, float y, int zoomfilter,
 /* Draw imbuf on a screen, preferably using GLSL display transform */
 void glaDrawImBuf_glsl_ctx(const struct bContext *C, struct ImBuf *ibuf, float x, float y, int zoomfilter);
 
+/* Same as above, only drawing the part of the image which overlaps the clipping rectangle */
+void glaDrawImBuf_glsl_clipping(struct ImBuf *ibuf, float x, float y, int zoomfilter,
+                                struct ColorManagedViewSettings *view_settings,
+                                struct ColorManagedDisplaySettings *display_settings,
+                                float clip_min_x, float clip_min_y, float clip_max_x, float clip_max_y);
+void glaDrawImBuf_glsl_ctx_clipping(const struct bContext *C, struct ImBuf *ibuf, float x, float y, int zoomfilter,
+                                    float clip_min_x, float clip_min_y, float clip_max_x, float clip_max_y);
+
 void glaDrawBorderCorners(const struct rcti *border, float zoomx, float zoomy);
 
 #endif /* __BIF_GLUTIL_H__ */
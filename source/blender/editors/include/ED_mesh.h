@@ -77,6 +77,7 @@ void           EDBM_verts_mirror_cache_end(struct BMEditMesh *em);
 
 void EDBM_mesh_ensure_valid_dm_hack(struct Scene *scene, struct BMEditMesh *em);
 void EDBM_mesh_normals_update(struct BMEditMesh *em);
+void EDBM_mesh_normals_update_verts(struct BMEditMesh *em, struct BMVert **verts, const int verts_len);
 void EDBM_mesh_clear(struct BMEditMesh *em);
 
 void EDBM_selectmode_to_scene(struct bContext *C);
@@ -2681,9 +2681,6 @@ void init_userdef_do_versions(void)
 	if (U.pixelsize == 0.0f)
 		U.pixelsize = 1.0f;
 	
-	if (U.image_draw_method == 0)
-		U.image_draw_method = IMAGE_DRAW_METHOD_2DTEXTURE;
-	
 	// keep the following until the new audaspace is default to be built with
 #ifdef WITH_SYSTEM_AUDASPACE
 	// we default to the first audio device
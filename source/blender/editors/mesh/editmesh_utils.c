@@ -38,6 +38,7 @@
 #include "BLI_math.h"
 #include "BLI_alloca.h"
 #include "BLI_buffer.h"
+#include "BLI_ghash.h"
 #include "BLI_kdtree.h"
 #include "BLI_listbase.h"
 
@@ -129,6 +130,12 @@ void EDBM_mesh_normals_update(BMEditMesh *em)
 	BM_mesh_normals_update(em->bm);
 }
 
+/* only update the normals around vertices which moved */
+void EDBM_mesh_normals_update_verts(BMEditMesh *em, BMVert **verts, const int verts_len)
+{
+	BM_mesh_normals_update_verts(em->bm, verts, verts_len);
+}
+
 void EDBM_mesh_clear(BMEditMesh *em)
 {
 	/* clear bmesh */
@@ -517,6 +524,111 @@ typedef struct UndoMesh {
 	int shapenr;
 } UndoMesh;
 
+/* Most edits only change some of the layers (selection, coordinates...),
+ * so layers which are the same as in the last pushed step are shared instead of stored again.
+ * Shared layers use CD_FLAG_NOFREE and are freed when the last step using them is freed. */
+static UndoMesh *um_last = NULL;
+static GHash *um_shared_layers = NULL;  /* layer data -> number of undo steps using it */
+
+static void undomesh_customdata_share(CustomData *cdata, CustomData *cdata_last, const int totelem)
+{
+	int i;
+
+	for (i = 0; i < cdata->totlayer && i < cdata_last->totlayer; i++) {
+		CustomDataLayer *layer = &cdata->layers[i];
+		CustomDataLayer *layer_last = &cdata_last->layers[i];
+		void **users_p;
+
+		if ((layer->type != layer_last->type) ||
+		    !STREQ(layer->name, layer_last->name) ||
+		    (layer->data == NULL) || (layer_last->data == NULL) ||
+		    (layer->flag & CD_FLAG_NOFREE))
+		{
+			continue;
+		}
+
+		/* referenced for other reasons than sharing */
+		if ((layer_last->flag & CD_FLAG_NOFREE) &&
+		    (um_shared_layers == NULL || BLI_ghash_lookup_p(um_shared_layers, layer_last->data) == NULL))
+		{
+			continue;
+		}
+
+		/* layers with their own allocations for every element can't compare equal,
+		 * since they're allocated again by every conversion */
+		if (memcmp(layer->data, layer_last->data, (size_t)CustomData_sizeof(layer->type) * totelem) != 0) {
+			continue;
+		}
+
+		if (um_shared_layers == NULL) {
+			um_shared_layers = BLI_ghash_ptr_new(__func__);
+		}
+		if (!BLI_ghash_ensure_p(um_shared_layers, layer_last->data, &users_p)) {
+			*users_p = SET_INT_IN_POINTER(1);
+		}
+		*users_p = SET_INT_IN_POINTER(GET_INT_FROM_POINTER(*users_p) + 1);
+
+		MEM_freeN(layer->data);
+		layer->data = layer_last->data;
+		layer->flag |= CD_FLAG_NOFREE;
+		layer_last->flag |= CD_FLAG_NOFREE;
+	}
+}
+
+static void undomesh_customdata_unshare(CustomData *cdata)
+{
+	int i;
+
+	if (um_shared_layers == NULL) {
+		return;
+	}
+
+	for (i = 0; i < cdata->totlayer; i++) {
+		CustomDataLayer *layer = &cdata->layers[i];
+		void **users_p;
+
+		if ((layer->flag & CD_FLAG_NOFREE) &&
+		    (users_p = BLI_ghash_lookup_p(um_shared_layers, layer->data)))
+		{
+			const int users = GET_INT_FROM_POINTER(*users_p) - 1;
+
+			if (users == 0) {
+				BLI_ghash_remove(um_shared_layers, layer->data, NULL, NULL);
+				MEM_freeN(layer->data);
+			}
+			else {
+				*users_p = SET_INT_IN_POINTER(users);
+			}
+			layer->data = NULL;
+		}
+	}
+
+	if (BLI_ghash_size(um_shared_layers) == 0) {
+		BLI_ghash_free(um_shared_layers, NULL, NULL);
+		um_shared_layers = NULL;
+	}
+}
+
+static void undomesh_share(UndoMesh *um, UndoMesh *um_prev)
+{
+	Mesh *me = &um->me, *me_prev = &um_prev->me;
+
+	if (me->totvert == me_prev->totvert) {
+		undomesh_customdata_share(&me->vdata, &me_prev->vdata, me->totvert);
+	}
+	if (me->totedge == me_prev->totedge) {
+		undomesh_customdata_share(&me->edata, &me_prev->edata, me->totedge);
+	}
+	if (me->totloop == me_prev->totloop) {
+		undomesh_customdata_share(&me->ldata, &me_prev->ldata, me->totloop);
+	}
+	if (me->totpoly == me_prev->totpoly) {
+		undomesh_customdata_share(&me->pdata, &me_prev->pdata, me->totpoly);
+	}
+
+	BKE_mesh_update_customdata_pointers(me, false);
+}
+
 /* undo simply makes copies of a bmesh */
 static void *editbtMesh_to_undoMesh(void *emv, void *obdata)
 {
@@ -535,6 +647,11 @@ static void *editbtMesh_to_undoMesh(void *emv, void *obdata)
 	um->selectmode = em->selectmode;
 	um->shapenr = em->bm->shapenr;
 
+	if (um_last) {
+		undomesh_share(um, um_last);
+	}
+	um_last = um;
+
 	return um;
 }
 
@@ -594,6 +711,15 @@ static void undoMesh_to_editbtMesh(void *umv, void *em_v, void *obdata)
 static void free_undo(void *me_v)
 {
 	Mesh *me = me_v;
+
+	if (me_v == um_last) {
+		um_last = NULL;
+	}
+	undomesh_customdata_unshare(&me->vdata);
+	undomesh_customdata_unshare(&me->edata);
+	undomesh_customdata_unshare(&me->ldata);
+	undomesh_customdata_unshare(&me->pdata);
+
 	if (me->key) {
 		BKE_key_free(me->key);
 		MEM_freeN(me->key);
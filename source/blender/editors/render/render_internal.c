@@ -569,7 +569,7 @@ static void image_rect_update(void *rjv, RenderResult *rr, volatile rcti *renrec
 		 */
 		if (rr->do_exr_tile ||
 		    ibuf->channels == 1 ||
-		    U.image_draw_method != IMAGE_DRAW_METHOD_GLSL)
+		    glaImageDrawMethod() != IMAGE_DRAW_METHOD_GLSL)
 		{
 			image_buffer_rect_update(rj, rr, ibuf, &rj->iuser, renrect, viewname);
 		}
@@ -1524,7 +1524,7 @@ void render_view3d_draw(RenderEngine *engine, const bContext *C)
 		}
 
 		/* If user decided not to use GLSL, fallback to glaDrawPixelsAuto */
-		force_fallback |= (U.image_draw_method != IMAGE_DRAW_METHOD_GLSL);
+		force_fallback |= (glaImageDrawMethod() != IMAGE_DRAW_METHOD_GLSL);
 
 		/* Try using GLSL display transform. */
 		if (force_fallback == false) {
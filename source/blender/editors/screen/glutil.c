@@ -372,7 +372,11 @@ static int get_cached_work_texture(int *r_w, int *r_h)
 	return texid;
 }
 
-void glaDrawPixelsTexScaled(float x, float y, int img_w, int img_h, int format, int type, int zoomfilter, void *rect, float scaleX, float scaleY)
+/* Same as glaDrawPixelsTexScaled, but only uploads and draws the parts of the image which
+ * overlap the clipping rectangle (in the same space as x and y), no clipping when it's empty */
+void glaDrawPixelsTexScaled_clipping(float x, float y, int img_w, int img_h, int format, int type, int zoomfilter,
+                                     void *rect, float scaleX, float scaleY,
+                                     float clip_min_x, float clip_min_y, float clip_max_x, float clip_max_y)
 {
 	unsigned char *uc_rect = (unsigned char *) rect;
 	const float *f_rect = (float *)rect;
@@ -451,6 +455,16 @@ void glaDrawPixelsTexScaled(float x, float y, int img_w, int img_h, int format,
 			/* check if we already got these because we always get 2 more when doing seamless*/
 			if (subpart_w <= seamless || subpart_h <= seamless)
 				continue;
+
+			if (clip_min_x < clip_max_x && clip_min_y < clip_max_y) {
+				if (rast_x + (float)(subpart_w - offset_right) * xzoom * scaleX < clip_min_x ||
+				    rast_y + (float)(subpart_h - offset_top) * yzoom * scaleY < clip_min_y ||
+				    rast_x + (float)offset_left * xzoom > clip_max_x ||
+				    rast_y + (float)offset_bot * yzoom > clip_max_y)
+				{
+					continue;
+				}
+			}
 			
 			if (type == GL_FLOAT) {
 				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, subpart_w, subpart_h, format, GL_FLOAT, &f_rect[((size_t)subpart_y) * offset_y * img_w * components + subpart_x * offset_x * components]);
@@ -501,6 +515,12 @@ void glaDrawPixelsTexScaled(float x, float y, int img_w, int img_h, int format,
 #endif
 }
 
+void glaDrawPixelsTexScaled(float x, float y, int img_w, int img_h, int format, int type, int zoomfilter, void *rect, float scaleX, float scaleY)
+{
+	glaDrawPixelsTexScaled_clipping(x, y, img_w, img_h, format, type, zoomfilter, rect, scaleX, scaleY,
+	                                0.0f, 0.0f, 0.0f, 0.0f);
+}
+
 void glaDrawPixelsTex(float x, float y, int img_w, int img_h, int format, int type, int zoomfilter, void *rect)
 {
 	glaDrawPixelsTexScaled(x, y, img_w, img_h, format, type, zoomfilter, rect, 1.0f, 1.0f);
@@ -927,10 +947,23 @@ void bglFlush(void)
 
 /* **** Color management helper functions for GLSL display/transform ***** */
 
-/* Draw given image buffer on a screen using GLSL for display transform */
-void glaDrawImBuf_glsl(ImBuf *ibuf, float x, float y, int zoomfilter,
-                       ColorManagedViewSettings *view_settings,
-                       ColorManagedDisplaySettings *display_settings)
+/* Automatic draw method does display transform on the GPU whenever OCIO has GLSL support,
+ * so the CPU side only has to convert pixels for saving and when GLSL setup fails */
+int glaImageDrawMethod(void)
+{
+	if (U.image_draw_method == IMAGE_DRAW_METHOD_AUTO) {
+		return IMB_colormanagement_support_glsl_draw(NULL) ? IMAGE_DRAW_METHOD_GLSL : IMAGE_DRAW_METHOD_2DTEXTURE;
+	}
+
+	return U.image_draw_method;
+}
+
+/* Draw given image buffer on a screen using GLSL for display transform,
+ * only the parts of the image which overlap the clipping rectangle are drawn (no clipping when it's empty) */
+void glaDrawImBuf_glsl_clipping(ImBuf *ibuf, float x, float y, int zoomfilter,
+                                ColorManagedViewSettings *view_settings,
+                                ColorManagedDisplaySettings *display_settings,
+                                float clip_min_x, float clip_min_y, float clip_max_x, float clip_max_y)
 {
 	bool force_fallback = false;
 	bool need_fallback = true;
@@ -943,7 +976,7 @@ void glaDrawImBuf_glsl(ImBuf *ibuf, float x, float y, int zoomfilter,
 	force_fallback |= ibuf->channels == 1;
 
 	/* If user decided not to use GLSL, fallback to glaDrawPixelsAuto */
-	force_fallback |= (U.image_draw_method != IMAGE_DRAW_METHOD_GLSL);
+	force_fallback |= (glaImageDrawMethod() != IMAGE_DRAW_METHOD_GLSL);
 
 	/* Try to draw buffer using GLSL display transform */
 	if (force_fallback == false) {
@@ -980,14 +1013,16 @@ void glaDrawImBuf_glsl(ImBuf *ibuf, float x, float y, int zoomfilter,
 					BLI_assert(!"Incompatible number of channels for GLSL display");
 
 				if (format != 0) {
-					glaDrawPixelsTex(x, y, ibuf->x, ibuf->y, format, GL_FLOAT,
-					                 zoomfilter, ibuf->rect_float);
+					glaDrawPixelsTexScaled_clipping(x, y, ibuf->x, ibuf->y, format, GL_FLOAT,
+					                                zoomfilter, ibuf->rect_float, 1.0f, 1.0f,
+					                                clip_min_x, clip_min_y, clip_max_x, clip_max_y);
 				}
 			}
 			else if (ibuf->rect) {
 				/* ibuf->rect is always RGBA */
-				glaDrawPixelsTex(x, y, ibuf->x, ibuf->y, GL_RGBA, GL_UNSIGNED_BYTE,
-				                 zoomfilter, ibuf->rect);
+				glaDrawPixelsTexScaled_clipping(x, y, ibuf->x, ibuf->y, GL_RGBA, GL_UNSIGNED_BYTE,
+				                                zoomfilter, ibuf->rect, 1.0f, 1.0f,
+				                                clip_min_x, clip_min_y, clip_max_x, clip_max_y);
 			}
 
 			IMB_colormanagement_finish_glsl_draw();
@@ -1000,25 +1035,62 @@ void glaDrawImBuf_glsl(ImBuf *ibuf, float x, float y, int zoomfilter,
 	if (need_fallback) {
 		unsigned char *display_buffer;
 		void *cache_handle;
+		float xzoom = glaGetOneFloat(GL_ZOOM_X), yzoom = glaGetOneFloat(GL_ZOOM_Y);
+		bool use_clipping = clip_min_x < clip_max_x && clip_min_y < clip_max_y && xzoom > 0.0f && yzoom > 0.0f;
+		rcti rect;
+
+		if (use_clipping) {
+			/* only transform the visible pixels of the image, with a border for texture filtering */
+			rect.xmin = (int)floorf((clip_min_x - x) / xzoom) - 1;
+			rect.ymin = (int)floorf((clip_min_y - y) / yzoom) - 1;
+			rect.xmax = (int)ceilf((clip_max_x - x) / xzoom) + 1;
+			rect.ymax = (int)ceilf((clip_max_y - y) / yzoom) + 1;
+		}
 
-		display_buffer = IMB_display_buffer_acquire(ibuf, view_settings, display_settings, &cache_handle);
+		display_buffer = IMB_display_buffer_acquire_rect(ibuf, view_settings, display_settings,
+		                                                 use_clipping ? &rect : NULL, &cache_handle);
 
-		if (display_buffer)
-			glaDrawPixelsAuto(x, y, ibuf->x, ibuf->y, GL_RGBA, GL_UNSIGNED_BYTE,
-			                  zoomfilter, display_buffer);
+		if (display_buffer) {
+			if (U.image_draw_method != IMAGE_DRAW_METHOD_DRAWPIXELS) {
+				glColor4f(1.0, 1.0, 1.0, 1.0);
+				glaDrawPixelsTexScaled_clipping(x, y, ibuf->x, ibuf->y, GL_RGBA, GL_UNSIGNED_BYTE,
+				                                zoomfilter, display_buffer, 1.0f, 1.0f,
+				                                clip_min_x, clip_min_y, clip_max_x, clip_max_y);
+			}
+			else {
+				/* only draws the pixels inside of the scissor box already */
+				glaDrawPixelsSafe(x, y, ibuf->x, ibuf->y, ibuf->x, GL_RGBA, GL_UNSIGNED_BYTE, display_buffer);
+			}
+		}
 
 		IMB_display_buffer_release(cache_handle);
 	}
 }
 
-void glaDrawImBuf_glsl_ctx(const bContext *C, ImBuf *ibuf, float x, float y, int zoomfilter)
+/* Draw given image buffer on a screen using GLSL for display transform */
+void glaDrawImBuf_glsl(ImBuf *ibuf, float x, float y, int zoomfilter,
+                       ColorManagedViewSettings *view_settings,
+                       ColorManagedDisplaySettings *display_settings)
+{
+	glaDrawImBuf_glsl_clipping(ibuf, x, y, zoomfilter, view_settings, display_settings,
+	                           0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+void glaDrawImBuf_glsl_ctx_clipping(const bContext *C, ImBuf *ibuf, float x, float y, int zoomfilter,
+                                    float clip_min_x, float clip_min_y, float clip_max_x, float clip_max_y)
 {
 	ColorManagedViewSettings *view_settings;
 	ColorManagedDisplaySettings *display_settings;
 
 	IMB_colormanagement_display_settings_from_ctx(C, &view_settings, &display_settings);
 
-	glaDrawImBuf_glsl(ibuf, x, y, zoomfilter, view_settings, display_settings);
+	glaDrawImBuf_glsl_clipping(ibuf, x, y, zoomfilter, view_settings, display_settings,
+	                           clip_min_x, clip_min_y, clip_max_x, clip_max_y);
+}
+
+void glaDrawImBuf_glsl_ctx(const bContext *C, ImBuf *ibuf, float x, float y, int zoomfilter)
+{
+	glaDrawImBuf_glsl_ctx_clipping(C, ibuf, x, y, zoomfilter, 0.0f, 0.0f, 0.0f, 0.0f);
 }
 
 void cpack(unsigned int x)
@@ -105,6 +105,8 @@
 #include "bmesh.h"
 //#include "bmesh_tools.h"
 
+#include "atomic_ops.h"
+
 #include "paint_intern.h"
 
 /* Defines and Structs */
@@ -311,7 +313,7 @@ typedef struct ProjPaintState {
 	int thread_tot;
 	int bucketMin[2];
 	int bucketMax[2];
-	int context_bucket_x, context_bucket_y; /* must lock threads while accessing these */
+	uint32_t context_bucket_index; /* next bucket to hand out (offset from bucketMin), only change atomically */
 
 	struct CurveMapping *cavity_curve;
 	BlurKernel *blurkernel;
@@ -4073,8 +4075,7 @@ static bool project_bucket_iter_init(ProjPaintState *ps, const float mval_f[2])
 			return 0;
 		}
 
-		ps->context_bucket_x = ps->bucketMin[0];
-		ps->context_bucket_y = ps->bucketMin[1];
+		ps->context_bucket_index = 0;
 	}
 	else { /* reproject: PROJ_SRC_* */
 		ps->bucketMin[0] = 0;
@@ -4083,8 +4084,7 @@ static bool project_bucket_iter_init(ProjPaintState *ps, const float mval_f[2])
 		ps->bucketMax[0] = ps->buckets_x;
 		ps->bucketMax[1] = ps->buckets_y;
 
-		ps->context_bucket_x = 0;
-		ps->context_bucket_y = 0;
+		ps->context_bucket_index = 0;
 	}
 	return 1;
 }
@@ -4095,35 +4095,26 @@ static bool project_bucket_iter_next(
         rctf *bucket_bounds, const float mval[2])
 {
 	const int diameter = 2 * ps->brush_size;
+	const int bucket_len_x = ps->bucketMax[0] - ps->bucketMin[0];
+	const uint32_t bucket_tot = (uint32_t)(bucket_len_x * (ps->bucketMax[1] - ps->bucketMin[1]));
+	uint32_t i;
 
-	if (ps->thread_tot > 1)
-		BLI_lock_thread(LOCK_CUSTOM1);
-
-	//printf("%d %d\n", ps->context_bucket_x, ps->context_bucket_y);
-
-	for (; ps->context_bucket_y < ps->bucketMax[1]; ps->context_bucket_y++) {
-		for (; ps->context_bucket_x < ps->bucketMax[0]; ps->context_bucket_x++) {
-
-			/* use bucket_bounds for project_bucket_isect_circle and project_bucket_init*/
-			project_bucket_bounds(ps, ps->context_bucket_x, ps->context_bucket_y, bucket_bounds);
-
-			if ((ps->source != PROJ_SRC_VIEW) ||
-			    project_bucket_isect_circle(mval, (float)(diameter * diameter), bucket_bounds))
-			{
-				*bucket_index = ps->context_bucket_x + (ps->context_bucket_y * ps->buckets_x);
-				ps->context_bucket_x++;
+	/* buckets are handed out in order, each thread takes the next index without locking */
+	while ((i = atomic_add_uint32(&ps->context_bucket_index, 1) - 1) < bucket_tot) {
+		const int bucket_x = ps->bucketMin[0] + (int)(i % (uint32_t)bucket_len_x);
+		const int bucket_y = ps->bucketMin[1] + (int)(i / (uint32_t)bucket_len_x);
 
-				if (ps->thread_tot > 1)
-					BLI_unlock_thread(LOCK_CUSTOM1);
+		/* use bucket_bounds for project_bucket_isect_circle and project_bucket_init*/
+		project_bucket_bounds(ps, bucket_x, bucket_y, bucket_bounds);
 
-				return 1;
-			}
+		if ((ps->source != PROJ_SRC_VIEW) ||
+		    project_bucket_isect_circle(mval, (float)(diameter * diameter), bucket_bounds))
+		{
+			*bucket_index = bucket_x + (bucket_y * ps->buckets_x);
+			return 1;
 		}
-		ps->context_bucket_x = ps->bucketMin[0];
 	}
 
-	if (ps->thread_tot > 1)
-		BLI_unlock_thread(LOCK_CUSTOM1);
 	return 0;
 }
 
@@ -99,25 +99,6 @@
 #include <stdlib.h>
 #include <string.h>
 
-#ifdef _OPENMP
-#include <omp.h>
-#endif
-
-#if defined(__APPLE__) && defined _OPENMP
-#include <sys/sysctl.h>
-
-#include "BLI_threads.h"
-
-/* Query how many cores not counting HT aka physical cores we've got. */
-static int system_physical_thread_count(void)
-{
-	int pcount;
-	size_t pcount_len = sizeof(pcount);
-	sysctlbyname("hw.physicalcpu", &pcount, &pcount_len, NULL, 0);
-	return pcount;
-}
-#endif  /* __APPLE__ */
-
 /** \name Tool Capabilities
  *
  * Avoid duplicate checks, internal logic only,
@@ -201,7 +182,7 @@ typedef struct StrokeCache {
 	float initial_mouse[2];
 
 	/* Pre-allocated temporary storage used during smoothing */
-	int num_threads, init_num_threads;
+	int num_threads;
 	float (**tmpgrid_co)[3], (**tmprow_co)[3];
 	float **tmpgrid_mask, **tmprow_mask;
 
@@ -419,58 +400,112 @@ static bool sculpt_stroke_is_dynamic_topology(
 	        SCULPT_TOOL_HAS_DYNTOPO(brush->sculpt_tool));
 }
 
+/* Shared by all the tasks of a threaded loop over the PBVH nodes,
+ * the fields after 'totnode' are only used by some of the brushes. */
+typedef struct SculptThreadedTaskData {
+	Sculpt *sd;
+	Object *ob;
+	Brush *brush;
+	PBVHNode **nodes;
+	int totnode;
+
+	float strength;
+	bool smooth_mask;
+	bool flip;
+	bool use_orco;
+
+	SculptProjectVector *spvc;
+	const float *offset;
+	const float *grab_delta;
+	const float *cono;
+	const float *area_no;
+	const float *area_no_sp;
+	const float *area_co;
+	float (*mat)[4];
+	float (*vertCos)[3];
+
+	float flippedbstrength;
+	float angle;
+	float lim;
+
+	ThreadMutex mutex;
+} SculptThreadedTaskData;
+
+/* Run \a func for all the nodes of \a data, threaded when there are enough of them. */
+static void sculpt_task_parallel_nodes(
+        Sculpt *sd, SculptThreadedTaskData *data, TaskParallelRangeFunc func, const bool use_threading)
+{
+	if (data->totnode == 0) {
+		return;
+	}
+
+	BLI_task_parallel_range_ex(
+	        0, data->totnode, data, NULL, 0, func,
+	        use_threading && (sd->flags & SCULPT_USE_OPENMP) && data->totnode > SCULPT_OMP_LIMIT, false);
+}
+
 /*** paint mesh ***/
 
-static void paint_mesh_restore_co(Sculpt *sd, Object *ob)
+static void paint_mesh_restore_co_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
 {
-	SculptSession *ss = ob->sculpt;
-	const Brush *brush = BKE_paint_brush(&sd->paint);
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
 
-	PBVHNode **nodes;
-	int n, totnode;
+	SculptUndoNode *unode;
+	SculptUndoType type = (data->brush->sculpt_tool == SCULPT_TOOL_MASK ? SCULPT_UNDO_MASK : SCULPT_UNDO_COORDS);
 
-	BKE_pbvh_search_gather(ss->pbvh, NULL, NULL, &nodes, &totnode);
+	if (ss->bm) {
+		unode = sculpt_undo_push_node(data->ob, data->nodes[n], type);
+	}
+	else {
+		unode = sculpt_undo_get_node(data->nodes[n]);
+	}
+	if (unode) {
+		PBVHVertexIter vd;
+		SculptOrigVertData orig_data;
 
-	/* Disable OpenMP when dynamic-topology is enabled. Otherwise, new
-	 * entries might be inserted by sculpt_undo_push_node() into the
-	 * GHash used internally by BM_log_original_vert_co() by a
-	 * different thread. [#33787] */
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && !ss->bm && totnode > SCULPT_OMP_LIMIT)
-	for (n = 0; n < totnode; n++) {
-		SculptUndoNode *unode;
-		SculptUndoType type = (brush->sculpt_tool == SCULPT_TOOL_MASK ?
-		                       SCULPT_UNDO_MASK : SCULPT_UNDO_COORDS);
+		sculpt_orig_vert_data_unode_init(&orig_data, data->ob, unode);
 
-		if (ss->bm) {
-			unode = sculpt_undo_push_node(ob, nodes[n], type);
-		}
-		else {
-			unode = sculpt_undo_get_node(nodes[n]);
+		BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+		{
+			sculpt_orig_vert_data_update(&orig_data, &vd);
+
+			if (orig_data.unode->type == SCULPT_UNDO_COORDS) {
+				copy_v3_v3(vd.co, orig_data.co);
+				if (vd.no) copy_v3_v3_short(vd.no, orig_data.no);
+				else normal_short_to_float_v3(vd.fno, orig_data.no);
+			}
+			else if (orig_data.unode->type == SCULPT_UNDO_MASK) {
+				*vd.mask = orig_data.mask;
+			}
+			if (vd.mvert) vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
 		}
-		if (unode) {
-			PBVHVertexIter vd;
-			SculptOrigVertData orig_data;
+		BKE_pbvh_vertex_iter_end;
 
-			sculpt_orig_vert_data_unode_init(&orig_data, ob, unode);
-		
-			BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
-			{
-				sculpt_orig_vert_data_update(&orig_data, &vd);
+		BKE_pbvh_node_mark_update(data->nodes[n]);
+	}
+}
 
-				if (orig_data.unode->type == SCULPT_UNDO_COORDS) {
-					copy_v3_v3(vd.co, orig_data.co);
-					if (vd.no) copy_v3_v3_short(vd.no, orig_data.no);
-					else normal_short_to_float_v3(vd.fno, orig_data.no);
-				}
-				else if (orig_data.unode->type == SCULPT_UNDO_MASK) {
-					*vd.mask = orig_data.mask;
-				}
-				if (vd.mvert) vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
-			}
-			BKE_pbvh_vertex_iter_end;
+static void paint_mesh_restore_co(Sculpt *sd, Object *ob)
+{
+	SculptSession *ss = ob->sculpt;
+	Brush *brush = BKE_paint_brush(&sd->paint);
 
-			BKE_pbvh_node_mark_update(nodes[n]);
-		}
+	PBVHNode **nodes;
+	int totnode;
+
+	BKE_pbvh_search_gather(ss->pbvh, NULL, NULL, &nodes, &totnode);
+
+	{
+		SculptThreadedTaskData data = {
+			.sd = sd, .ob = ob, .brush = brush, .nodes = nodes, .totnode = totnode,
+		};
+
+		/* Disable threading when dynamic-topology is enabled. Otherwise, new
+		 * entries might be inserted by sculpt_undo_push_node() into the
+		 * GHash used internally by BM_log_original_vert_co() by a
+		 * different thread. [#33787] */
+		sculpt_task_parallel_nodes(sd, &data, paint_mesh_restore_co_task_cb, !ss->bm);
 	}
 
 	if (nodes)
@@ -785,25 +820,29 @@ typedef struct SculptCalcAreaData {
 	int totnode;
 	bool has_bm_orco;
 
-	/* 0=towards view, 1=flipped */
-	float (*area_co)[3];
-	float (*area_no)[3];
-	int *count;
-
-	ThreadMutex mutex;
+	bool use_area_co;
+	bool use_area_no;
 } SculptCalcAreaData;
 
-static void calc_area_normal_and_centr_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+/* per-task sums, 0=towards view, 1=flipped */
+typedef struct SculptCalcAreaChunk {
+	float area_co[2][3];
+	float area_no[2][3];
+	int count[2];
+} SculptCalcAreaChunk;
+
+static void calc_area_normal_and_centr_task_cb(void *userdata, void *userdata_chunk, int n)
 {
 	SculptCalcAreaData *data = userdata;
+	SculptCalcAreaChunk *chunk = userdata_chunk;
 	SculptSession *ss = data->ob->sculpt;
 	PBVHVertexIter vd;
 	SculptBrushTest test;
 	SculptUndoNode *unode;
 
-	float private_co[2][3] = {{0.0f}};
-	float private_no[2][3] = {{0.0f}};
-	int   private_count[2] = {0};
+	float (*private_co)[3] = chunk->area_co;
+	float (*private_no)[3] = chunk->area_no;
+	int    *private_count = chunk->count;
 	bool use_original;
 
 	unode = sculpt_undo_push_node(data->ob, data->nodes[n], SCULPT_UNDO_COORDS);
@@ -840,9 +879,9 @@ static void calc_area_normal_and_centr_task_cb(void *userdata, void *UNUSED(user
 				normal_tri_v3(no, UNPACK3(co_tri));
 
 				flip_index = (dot_v3v3(ss->cache->view_normal, no) <= 0.0f);
-				if (data->area_co)
+				if (data->use_area_co)
 					add_v3_v3(private_co[flip_index], co);
-				if (data->area_no)
+				if (data->use_area_no)
 					add_v3_v3(private_no[flip_index], no);
 				private_count[flip_index] += 1;
 			}
@@ -887,35 +926,44 @@ static void calc_area_normal_and_centr_task_cb(void *userdata, void *UNUSED(user
 				}
 
 				flip_index = (dot_v3v3(ss->cache->view_normal, no) <= 0.0f);
-				if (data->area_co)
+				if (data->use_area_co)
 					add_v3_v3(private_co[flip_index], co);
-				if (data->area_no)
+				if (data->use_area_no)
 					add_v3_v3(private_no[flip_index], no);
 				private_count[flip_index] += 1;
 			}
 		}
 		BKE_pbvh_vertex_iter_end;
 	}
+}
 
-	BLI_mutex_lock(&data->mutex);
+static void calc_area_normal_and_centr_reduce(void *UNUSED(userdata), void *userdata_chunk_join, void *userdata_chunk)
+{
+	SculptCalcAreaChunk *join = userdata_chunk_join;
+	SculptCalcAreaChunk *chunk = userdata_chunk;
 
 	/* for flatten center */
-	if (data->area_co) {
-		add_v3_v3(data->area_co[0], private_co[0]);
-		add_v3_v3(data->area_co[1], private_co[1]);
-	}
+	add_v3_v3(join->area_co[0], chunk->area_co[0]);
+	add_v3_v3(join->area_co[1], chunk->area_co[1]);
 
 	/* for area normal */
-	if (data->area_no) {
-		add_v3_v3(data->area_no[0], private_no[0]);
-		add_v3_v3(data->area_no[1], private_no[1]);
-	}
+	add_v3_v3(join->area_no[0], chunk->area_no[0]);
+	add_v3_v3(join->area_no[1], chunk->area_no[1]);
 
 	/* weights */
-	data->count[0] += private_count[0];
-	data->count[1] += private_count[1];
+	join->count[0] += chunk->count[0];
+	join->count[1] += chunk->count[1];
+}
 
-	BLI_mutex_unlock(&data->mutex);
+static void calc_area_normal_and_centr(
+        Sculpt *sd, SculptCalcAreaData *data, SculptCalcAreaChunk *r_chunk)
+{
+	memset(r_chunk, 0, sizeof(*r_chunk));
+
+	BLI_task_parallel_range_reduce(
+	        0, data->totnode, data, r_chunk, sizeof(*r_chunk),
+	        calc_area_normal_and_centr_task_cb, NULL, calc_area_normal_and_centr_reduce, NULL, 1,
+	        ((sd->flags & SCULPT_USE_OPENMP) && data->totnode > SCULPT_OMP_LIMIT));
 }
 
 static void calc_area_center(
@@ -928,26 +976,19 @@ static void calc_area_center(
 	const bool has_bm_orco = ss->bm && sculpt_stroke_is_dynamic_topology(ss, brush);
 	int n;
 
-	/* 0=towards view, 1=flipped */
-	float area_co[2][3] = {{0.0f}};
-
-	int count[2] = {0};
+	SculptCalcAreaChunk area;
 
 	SculptCalcAreaData data = {
 		.sd = sd, .ob = ob, .nodes = nodes, .totnode = totnode, .has_bm_orco = has_bm_orco,
-		.area_co = area_co, .area_no = NULL, .count = count,
+		.use_area_co = true, .use_area_no = false,
 	};
-	BLI_mutex_init(&data.mutex);
-
-	BLI_task_parallel_range_ex(0, totnode, &data, NULL, 0, calc_area_normal_and_centr_task_cb,
-	                           ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT), false);
 
-	BLI_mutex_end(&data.mutex);
+	calc_area_normal_and_centr(sd, &data, &area);
 
 	/* for flatten center */
-	for (n = 0; n < ARRAY_SIZE(area_co); n++) {
-		if (count[n] != 0) {
-			mul_v3_v3fl(r_area_co, area_co[n], 1.0f / count[n]);
+	for (n = 0; n < ARRAY_SIZE(area.area_co); n++) {
+		if (area.count[n] != 0) {
+			mul_v3_v3fl(r_area_co, area.area_co[n], 1.0f / area.count[n]);
 			break;
 		}
 	}
@@ -967,25 +1008,18 @@ static void calc_area_normal(
 	const bool has_bm_orco = ss->bm && sculpt_stroke_is_dynamic_topology(ss, brush);
 	int n;
 
-	/* 0=towards view, 1=flipped */
-	float area_no[2][3] = {{0.0f}};
-
-	int count[2] = {0};
+	SculptCalcAreaChunk area;
 
 	SculptCalcAreaData data = {
 		.sd = sd, .ob = ob, .nodes = nodes, .totnode = totnode, .has_bm_orco = has_bm_orco,
-		.area_co = NULL, .area_no = area_no, .count = count,
+		.use_area_co = false, .use_area_no = true,
 	};
-	BLI_mutex_init(&data.mutex);
-
-	BLI_task_parallel_range_ex(0, totnode, &data, NULL, 0, calc_area_normal_and_centr_task_cb,
-	                           ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT), false);
 
-	BLI_mutex_end(&data.mutex);
+	calc_area_normal_and_centr(sd, &data, &area);
 
 	/* for area normal */
-	for (n = 0; n < ARRAY_SIZE(area_no); n++) {
-		if (normalize_v3_v3(r_area_no, area_no[n]) != 0.0f) {
+	for (n = 0; n < ARRAY_SIZE(area.area_no); n++) {
+		if (normalize_v3_v3(r_area_no, area.area_no[n]) != 0.0f) {
 			break;
 		}
 	}
@@ -1003,27 +1037,19 @@ static void calc_area_normal_and_center(
 	const bool has_bm_orco = ss->bm && sculpt_stroke_is_dynamic_topology(ss, brush);
 	int n;
 
-	/* 0=towards view, 1=flipped */
-	float area_co[2][3] = {{0.0f}};
-	float area_no[2][3] = {{0.0f}};
-
-	int count[2] = {0};
+	SculptCalcAreaChunk area;
 
 	SculptCalcAreaData data = {
 		.sd = sd, .ob = ob, .nodes = nodes, .totnode = totnode, .has_bm_orco = has_bm_orco,
-		.area_co = area_co, .area_no = area_no, .count = count,
+		.use_area_co = true, .use_area_no = true,
 	};
-	BLI_mutex_init(&data.mutex);
-
-	BLI_task_parallel_range_ex(0, totnode, &data, NULL, 0, calc_area_normal_and_centr_task_cb,
-	                           ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT), false);
 
-	BLI_mutex_end(&data.mutex);
+	calc_area_normal_and_centr(sd, &data, &area);
 
 	/* for flatten center */
-	for (n = 0; n < ARRAY_SIZE(area_co); n++) {
-		if (count[n] != 0) {
-			mul_v3_v3fl(r_area_co, area_co[n], 1.0f / count[n]);
+	for (n = 0; n < ARRAY_SIZE(area.area_co); n++) {
+		if (area.count[n] != 0) {
+			mul_v3_v3fl(r_area_co, area.area_co[n], 1.0f / area.count[n]);
 			break;
 		}
 	}
@@ -1032,8 +1058,8 @@ static void calc_area_normal_and_center(
 	}
 
 	/* for area normal */
-	for (n = 0; n < ARRAY_SIZE(area_no); n++) {
-		if (normalize_v3_v3(r_area_no, area_no[n]) != 0.0f) {
+	for (n = 0; n < ARRAY_SIZE(area.area_no); n++) {
+		if (normalize_v3_v3(r_area_no, area.area_no[n]) != 0.0f) {
 			break;
 		}
 	}
@@ -1191,11 +1217,8 @@ static float tex_strength(SculptSession *ss, Brush *br,
 			x += br->mtex.ofs[0];
 			y += br->mtex.ofs[1];
 
-#ifdef _OPENMP
-			thread_num = omp_get_thread_num();
-#else
-			thread_num = 0;
-#endif
+			/* may run from any of the sculpt tasks, the texture needs to know which one */
+			thread_num = BLI_task_scheduler_thread_id(BLI_task_scheduler_get());
 			avg = paint_get_tex_pixel(&br->mtex, x, y, ss->tex_pool, thread_num);
 
 			avg += br->texture_sample_bias;
@@ -1634,11 +1657,8 @@ static void do_multires_smooth_brush(Sculpt *sd, SculptSession *ss, PBVHNode *no
 
 	grid_hidden = BKE_pbvh_grid_hidden(ss->pbvh);
 
-#ifdef _OPENMP
-	thread_num = omp_get_thread_num();
-#else
-	thread_num = 0;
-#endif
+	/* the buffers are per thread, see sculpt_threaded_data_init() */
+	thread_num = BLI_task_scheduler_thread_id(BLI_task_scheduler_get());
 	tmpgrid_co = ss->cache->tmpgrid_co[thread_num];
 	tmprow_co = ss->cache->tmprow_co[thread_num];
 	tmpgrid_mask = ss->cache->tmpgrid_mask[thread_num];
@@ -1753,6 +1773,26 @@ static void do_multires_smooth_brush(Sculpt *sd, SculptSession *ss, PBVHNode *no
 	}
 }
 
+static void smooth_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+
+	switch (BKE_pbvh_type(ss->pbvh)) {
+		case PBVH_GRIDS:
+			do_multires_smooth_brush(data->sd, ss, data->nodes[n], data->strength,
+			                         data->smooth_mask);
+			break;
+		case PBVH_FACES:
+			do_mesh_smooth_brush(data->sd, ss, data->nodes[n], data->strength,
+			                     data->smooth_mask);
+			break;
+		case PBVH_BMESH:
+			do_bmesh_smooth_brush(data->sd, ss, data->nodes[n], data->strength, data->smooth_mask);
+			break;
+	}
+}
+
 static void smooth(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode,
                    float bstrength, int smooth_mask)
 {
@@ -1760,9 +1800,14 @@ static void smooth(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode,
 	const int max_iterations = 4;
 	const float fract = 1.0f / max_iterations;
 	PBVHType type = BKE_pbvh_type(ss->pbvh);
-	int iteration, n, count;
+	int iteration, count;
 	float last;
 
+	SculptThreadedTaskData data = {
+		.sd = sd, .ob = ob, .nodes = nodes, .totnode = totnode,
+		.smooth_mask = smooth_mask != 0,
+	};
+
 	CLAMP(bstrength, 0, 1);
 
 	count = (int)(bstrength * max_iterations);
@@ -1774,24 +1819,9 @@ static void smooth(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode,
 	}
 
 	for (iteration = 0; iteration <= count; ++iteration) {
-		float strength = (iteration != count) ? 1.0f : last;
+		data.strength = (iteration != count) ? 1.0f : last;
 
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT)
-		for (n = 0; n < totnode; n++) {
-			switch (type) {
-				case PBVH_GRIDS:
-					do_multires_smooth_brush(sd, ss, nodes[n], strength,
-					                         smooth_mask);
-					break;
-				case PBVH_FACES:
-					do_mesh_smooth_brush(sd, ss, nodes[n], strength,
-					                     smooth_mask);
-					break;
-				case PBVH_BMESH:
-					do_bmesh_smooth_brush(sd, ss, nodes[n], strength, smooth_mask);
-					break;
-			}
-		}
+		sculpt_task_parallel_nodes(sd, &data, smooth_task_cb, true);
 
 		if (ss->multires)
 			multires_stitch_grids(ob);
@@ -1804,38 +1834,45 @@ static void do_smooth_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnod
 	smooth(sd, ob, nodes, totnode, ss->cache->bstrength, false);
 }
 
-static void do_mask_brush_draw(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
+static void do_mask_brush_draw_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
 {
-	SculptSession *ss = ob->sculpt;
-	Brush *brush = BKE_paint_brush(&sd->paint);
-	float bstrength = ss->cache->bstrength;
-	int n;
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = ss->cache->bstrength;
 
-	/* threaded loop over nodes */
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT)
-	for (n = 0; n < totnode; n++) {
-		PBVHVertexIter vd;
-		SculptBrushTest test;
+	PBVHVertexIter vd;
+	SculptBrushTest test;
 
-		sculpt_brush_test_init(ss, &test);
+	sculpt_brush_test_init(ss, &test);
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
-		{
-			if (sculpt_brush_test(&test, vd.co)) {
-				float fade = tex_strength(ss, brush, vd.co, test.dist,
-				                          vd.no, vd.fno, 0);
+	BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+	{
+		if (sculpt_brush_test(&test, vd.co)) {
+			float fade = tex_strength(ss, brush, vd.co, test.dist,
+			                          vd.no, vd.fno, 0);
 
-				(*vd.mask) += fade * bstrength;
-				CLAMP(*vd.mask, 0, 1);
+			(*vd.mask) += fade * bstrength;
+			CLAMP(*vd.mask, 0, 1);
 
-				if (vd.mvert)
-					vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
-			}
-			BKE_pbvh_vertex_iter_end;
+			if (vd.mvert)
+				vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
 		}
+		BKE_pbvh_vertex_iter_end;
 	}
 }
 
+static void do_mask_brush_draw(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
+{
+	Brush *brush = BKE_paint_brush(&sd->paint);
+
+	SculptThreadedTaskData data = {
+		.sd = sd, .ob = ob, .brush = brush, .nodes = nodes, .totnode = totnode,
+	};
+
+	sculpt_task_parallel_nodes(sd, &data, do_mask_brush_draw_task_cb, true);
+}
+
 static void do_mask_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
 	SculptSession *ss = ob->sculpt;
@@ -1851,13 +1888,43 @@ static void do_mask_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 	}
 }
 
+static void do_draw_brush_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float *offset = data->offset;
+
+	PBVHVertexIter vd;
+	SculptBrushTest test;
+	float (*proxy)[3];
+
+	proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
+
+	sculpt_brush_test_init(ss, &test);
+
+	BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+	{
+		if (sculpt_brush_test(&test, vd.co)) {
+			/* offset vertex */
+			float fade = tex_strength(ss, brush, vd.co, test.dist, vd.no,
+			                          vd.fno, vd.mask ? *vd.mask : 0.0f);
+
+			mul_v3_v3fl(proxy[vd.i], offset, fade);
+
+			if (vd.mvert)
+				vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
+		}
+	}
+	BKE_pbvh_vertex_iter_end;
+}
+
 static void do_draw_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
 	SculptSession *ss = ob->sculpt;
 	Brush *brush = BKE_paint_brush(&sd->paint);
 	float offset[3];
 	float bstrength = ss->cache->bstrength;
-	int n;
 
 	/* offset with as much as possible factored in already */
 	mul_v3_v3fl(offset, ss->cache->sculpt_normal_symm, ss->cache->radius);
@@ -1865,31 +1932,56 @@ static void do_draw_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 	mul_v3_fl(offset, bstrength);
 
 	/* threaded loop over nodes */
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT)
-	for (n = 0; n < totnode; n++) {
-		PBVHVertexIter vd;
-		SculptBrushTest test;
-		float (*proxy)[3];
+	SculptThreadedTaskData data = {
+		.sd = sd, .ob = ob, .brush = brush, .nodes = nodes, .totnode = totnode,
+		.offset = offset,
+	};
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+	sculpt_task_parallel_nodes(sd, &data, do_draw_brush_task_cb, true);
+}
 
-		sculpt_brush_test_init(ss, &test);
+static void do_crease_brush_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	SculptProjectVector *spvc = data->spvc;
+	const float flippedbstrength = data->flippedbstrength;
+	const float *offset = data->offset;
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
-		{
-			if (sculpt_brush_test(&test, vd.co)) {
-				/* offset vertex */
-				float fade = tex_strength(ss, brush, vd.co, test.dist, vd.no,
-				                          vd.fno, vd.mask ? *vd.mask : 0.0f);
+	PBVHVertexIter vd;
+	SculptBrushTest test;
+	float (*proxy)[3];
 
-				mul_v3_v3fl(proxy[vd.i], offset, fade);
+	proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
-				if (vd.mvert)
-					vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
-			}
+	sculpt_brush_test_init(ss, &test);
+
+	BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+	{
+		if (sculpt_brush_test(&test, vd.co)) {
+			/* offset vertex */
+			const float fade = tex_strength(ss, brush, vd.co, test.dist,
+			                                vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
+			float val1[3];
+			float val2[3];
+
+			/* first we pinch */
+			sub_v3_v3v3(val1, test.location, vd.co);
+			mul_v3_fl(val1, fade * flippedbstrength);
+
+			sculpt_project_v3(spvc, val1, val1);
+
+			/* then we draw */
+			mul_v3_v3fl(val2, offset, fade);
+
+			add_v3_v3v3(proxy[vd.i], val1, val2);
+
+			if (vd.mvert)
+				vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
 		}
-		BKE_pbvh_vertex_iter_end;
 	}
+	BKE_pbvh_vertex_iter_end;
 }
 
 static void do_crease_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
@@ -1901,7 +1993,6 @@ static void do_crease_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnod
 	float bstrength = ss->cache->bstrength;
 	float flippedbstrength, crease_correction;
 	float brush_alpha;
-	int n;
 
 	SculptProjectVector spvc;
 
@@ -1926,86 +2017,101 @@ static void do_crease_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnod
 	sculpt_project_v3_cache_init(&spvc, ss->cache->sculpt_normal_symm);
 
 	/* threaded loop over nodes */
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT)
-	for (n = 0; n < totnode; n++) {
-		PBVHVertexIter vd;
-		SculptBrushTest test;
-		float (*proxy)[3];
+	SculptThreadedTaskData data = {
+		.sd = sd, .ob = ob, .brush = brush, .nodes = nodes, .totnode = totnode,
+		.spvc = &spvc, .offset = offset, .flippedbstrength = flippedbstrength,
+	};
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+	sculpt_task_parallel_nodes(sd, &data, do_crease_brush_task_cb, true);
+}
 
-		sculpt_brush_test_init(ss, &test);
+static void do_pinch_brush_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = ss->cache->bstrength;
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
-		{
-			if (sculpt_brush_test(&test, vd.co)) {
-				/* offset vertex */
-				const float fade = tex_strength(ss, brush, vd.co, test.dist,
-				                                vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
-				float val1[3];
-				float val2[3];
+	PBVHVertexIter vd;
+	SculptBrushTest test;
+	float (*proxy)[3];
 
-				/* first we pinch */
-				sub_v3_v3v3(val1, test.location, vd.co);
-				mul_v3_fl(val1, fade * flippedbstrength);
+	proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
-				sculpt_project_v3(&spvc, val1, val1);
+	sculpt_brush_test_init(ss, &test);
 
-				/* then we draw */
-				mul_v3_v3fl(val2, offset, fade);
+	BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+	{
+		if (sculpt_brush_test(&test, vd.co)) {
+			float fade = bstrength * tex_strength(ss, brush, vd.co, test.dist, vd.no,
+			                                      vd.fno, vd.mask ? *vd.mask : 0.0f);
+			float val[3];
 
-				add_v3_v3v3(proxy[vd.i], val1, val2);
+			sub_v3_v3v3(val, test.location, vd.co);
+			mul_v3_v3fl(proxy[vd.i], val, fade);
 
-				if (vd.mvert)
-					vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
-			}
+			if (vd.mvert)
+				vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
 		}
-		BKE_pbvh_vertex_iter_end;
 	}
+	BKE_pbvh_vertex_iter_end;
 }
 
 static void do_pinch_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
-	SculptSession *ss = ob->sculpt;
 	Brush *brush = BKE_paint_brush(&sd->paint);
-	float bstrength = ss->cache->bstrength;
-	int n;
 
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT)
-	for (n = 0; n < totnode; n++) {
-		PBVHVertexIter vd;
-		SculptBrushTest test;
-		float (*proxy)[3];
+	SculptThreadedTaskData data = {
+		.sd = sd, .ob = ob, .brush = brush, .nodes = nodes, .totnode = totnode,
+	};
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+	sculpt_task_parallel_nodes(sd, &data, do_pinch_brush_task_cb, true);
+}
 
-		sculpt_brush_test_init(ss, &test);
+static void do_grab_brush_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = ss->cache->bstrength;
+	const float *grab_delta = data->grab_delta;
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
-		{
-			if (sculpt_brush_test(&test, vd.co)) {
-				float fade = bstrength * tex_strength(ss, brush, vd.co, test.dist, vd.no,
-				                                      vd.fno, vd.mask ? *vd.mask : 0.0f);
-				float val[3];
+	PBVHVertexIter vd;
+	SculptBrushTest test;
+	SculptOrigVertData orig_data;
+	float (*proxy)[3];
 
-				sub_v3_v3v3(val, test.location, vd.co);
-				mul_v3_v3fl(proxy[vd.i], val, fade);
+	sculpt_orig_vert_data_init(&orig_data, data->ob, data->nodes[n]);
 
-				if (vd.mvert)
-					vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
-			}
+	proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
+
+	sculpt_brush_test_init(ss, &test);
+
+	BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+	{
+		sculpt_orig_vert_data_update(&orig_data, &vd);
+
+		if (sculpt_brush_test(&test, orig_data.co)) {
+			const float fade = bstrength * tex_strength(ss, brush,
+			                                            orig_data.co,
+			                                            test.dist,
+			                                            orig_data.no,
+			                                            NULL, vd.mask ? *vd.mask : 0.0f);
+
+			mul_v3_v3fl(proxy[vd.i], grab_delta, fade);
+
+			if (vd.mvert)
+				vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
 		}
-		BKE_pbvh_vertex_iter_end;
 	}
+	BKE_pbvh_vertex_iter_end;
 }
 
 static void do_grab_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
 	SculptSession *ss = ob->sculpt;
 	Brush *brush = BKE_paint_brush(&sd->paint);
-	float bstrength = ss->cache->bstrength;
 	float grab_delta[3];
-	int n;
 	float len;
 
 	copy_v3_v3(grab_delta, ss->cache->grab_delta_symmetry);
@@ -2018,78 +2124,94 @@ static void do_grab_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 		add_v3_v3(grab_delta, ss->cache->sculpt_normal_symm);
 	}
 
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT)
-	for (n = 0; n < totnode; n++) {
-		PBVHVertexIter vd;
-		SculptBrushTest test;
-		SculptOrigVertData orig_data;
-		float (*proxy)[3];
+	SculptThreadedTaskData data = {
+		.sd = sd, .ob = ob, .brush = brush, .nodes = nodes, .totnode = totnode,
+		.grab_delta = grab_delta,
+	};
 
-		sculpt_orig_vert_data_init(&orig_data, ob, nodes[n]);
+	sculpt_task_parallel_nodes(sd, &data, do_grab_brush_task_cb, true);
+}
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+static void do_nudge_brush_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = ss->cache->bstrength;
+	const float *cono = data->cono;
 
-		sculpt_brush_test_init(ss, &test);
+	PBVHVertexIter vd;
+	SculptBrushTest test;
+	float (*proxy)[3];
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
-		{
-			sculpt_orig_vert_data_update(&orig_data, &vd);
+	proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
-			if (sculpt_brush_test(&test, orig_data.co)) {
-				const float fade = bstrength * tex_strength(ss, brush,
-				                                            orig_data.co,
-				                                            test.dist,
-				                                            orig_data.no,
-				                                            NULL, vd.mask ? *vd.mask : 0.0f);
+	sculpt_brush_test_init(ss, &test);
 
-				mul_v3_v3fl(proxy[vd.i], grab_delta, fade);
+	BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+	{
+		if (sculpt_brush_test(&test, vd.co)) {
+			const float fade = bstrength * tex_strength(ss, brush, vd.co, test.dist,
+			                                            vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
 
-				if (vd.mvert)
-					vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
-			}
-		}
-		BKE_pbvh_vertex_iter_end;
+			mul_v3_v3fl(proxy[vd.i], cono, fade);
+
+			if (vd.mvert)
+				vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
+		}
 	}
+	BKE_pbvh_vertex_iter_end;
 }
 
 static void do_nudge_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
 	SculptSession *ss = ob->sculpt;
 	Brush *brush = BKE_paint_brush(&sd->paint);
-	float bstrength = ss->cache->bstrength;
 	float grab_delta[3];
 	float tmp[3], cono[3];
-	int n;
 
 	copy_v3_v3(grab_delta, ss->cache->grab_delta_symmetry);
 
 	cross_v3_v3v3(tmp, ss->cache->sculpt_normal_symm, grab_delta);
 	cross_v3_v3v3(cono, tmp, ss->cache->sculpt_normal_symm);
 
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT)
-	for (n = 0; n < totnode; n++) {
-		PBVHVertexIter vd;
-		SculptBrushTest test;
-		float (*proxy)[3];
+	SculptThreadedTaskData data = {
+		.sd = sd, .ob = ob, .brush = brush, .nodes = nodes, .totnode = totnode,
+		.cono = cono,
+	};
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+	sculpt_task_parallel_nodes(sd, &data, do_nudge_brush_task_cb, true);
+}
 
-		sculpt_brush_test_init(ss, &test);
+static void do_snake_hook_brush_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = ss->cache->bstrength;
+	const float *grab_delta = data->grab_delta;
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
-		{
-			if (sculpt_brush_test(&test, vd.co)) {
-				const float fade = bstrength * tex_strength(ss, brush, vd.co, test.dist,
-				                                            vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
+	PBVHVertexIter vd;
+	SculptBrushTest test;
+	float (*proxy)[3];
 
-				mul_v3_v3fl(proxy[vd.i], cono, fade);
+	proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
-				if (vd.mvert)
-					vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
-			}
+	sculpt_brush_test_init(ss, &test);
+
+	BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+	{
+		if (sculpt_brush_test(&test, vd.co)) {
+			const float fade = bstrength * tex_strength(ss, brush, vd.co, test.dist,
+			                                            vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
+
+			mul_v3_v3fl(proxy[vd.i], grab_delta, fade);
+
+			if (vd.mvert)
+				vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
 		}
-		BKE_pbvh_vertex_iter_end;
 	}
+	BKE_pbvh_vertex_iter_end;
 }
 
 static void do_snake_hook_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
@@ -2098,7 +2220,6 @@ static void do_snake_hook_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int to
 	Brush *brush = BKE_paint_brush(&sd->paint);
 	float bstrength = ss->cache->bstrength;
 	float grab_delta[3];
-	int n;
 	float len;
 
 	copy_v3_v3(grab_delta, ss->cache->grab_delta_symmetry);
@@ -2114,126 +2235,192 @@ static void do_snake_hook_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int to
 		add_v3_v3(grab_delta, ss->cache->sculpt_normal_symm);
 	}
 
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT)
-	for (n = 0; n < totnode; n++) {
-		PBVHVertexIter vd;
-		SculptBrushTest test;
-		float (*proxy)[3];
+	SculptThreadedTaskData data = {
+		.sd = sd, .ob = ob, .brush = brush, .nodes = nodes, .totnode = totnode,
+		.grab_delta = grab_delta,
+	};
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+	sculpt_task_parallel_nodes(sd, &data, do_snake_hook_brush_task_cb, true);
+}
 
-		sculpt_brush_test_init(ss, &test);
+static void do_thumb_brush_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = ss->cache->bstrength;
+	const float *cono = data->cono;
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
-		{
-			if (sculpt_brush_test(&test, vd.co)) {
-				const float fade = bstrength * tex_strength(ss, brush, vd.co, test.dist,
-				                                            vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
+	PBVHVertexIter vd;
+	SculptBrushTest test;
+	SculptOrigVertData orig_data;
+	float (*proxy)[3];
 
-				mul_v3_v3fl(proxy[vd.i], grab_delta, fade);
+	sculpt_orig_vert_data_init(&orig_data, data->ob, data->nodes[n]);
 
-				if (vd.mvert)
-					vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
-			}
+	proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
+
+	sculpt_brush_test_init(ss, &test);
+
+	BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+	{
+		sculpt_orig_vert_data_update(&orig_data, &vd);
+
+		if (sculpt_brush_test(&test, orig_data.co)) {
+			const float fade = bstrength * tex_strength(ss, brush,
+			                                            orig_data.co,
+			                                            test.dist,
+			                                            orig_data.no,
+			                                            NULL, vd.mask ? *vd.mask : 0.0f);
+
+			mul_v3_v3fl(proxy[vd.i], cono, fade);
+
+			if (vd.mvert)
+				vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
 		}
-		BKE_pbvh_vertex_iter_end;
 	}
+	BKE_pbvh_vertex_iter_end;
 }
 
 static void do_thumb_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
 	SculptSession *ss = ob->sculpt;
 	Brush *brush = BKE_paint_brush(&sd->paint);
-	float bstrength = ss->cache->bstrength;
 	float grab_delta[3];
 	float tmp[3], cono[3];
-	int n;
 
 	copy_v3_v3(grab_delta, ss->cache->grab_delta_symmetry);
 
 	cross_v3_v3v3(tmp, ss->cache->sculpt_normal_symm, grab_delta);
 	cross_v3_v3v3(cono, tmp, ss->cache->sculpt_normal_symm);
 
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT)
-	for (n = 0; n < totnode; n++) {
-		PBVHVertexIter vd;
-		SculptBrushTest test;
-		SculptOrigVertData orig_data;
-		float (*proxy)[3];
+	SculptThreadedTaskData data = {
+		.sd = sd, .ob = ob, .brush = brush, .nodes = nodes, .totnode = totnode,
+		.cono = cono,
+	};
 
-		sculpt_orig_vert_data_init(&orig_data, ob, nodes[n]);
+	sculpt_task_parallel_nodes(sd, &data, do_thumb_brush_task_cb, true);
+}
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+static void do_rotate_brush_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = ss->cache->bstrength;
+	const float angle = data->angle;
 
-		sculpt_brush_test_init(ss, &test);
+	PBVHVertexIter vd;
+	SculptBrushTest test;
+	SculptOrigVertData orig_data;
+	float (*proxy)[3];
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
-		{
-			sculpt_orig_vert_data_update(&orig_data, &vd);
+	sculpt_orig_vert_data_init(&orig_data, data->ob, data->nodes[n]);
 
-			if (sculpt_brush_test(&test, orig_data.co)) {
-				const float fade = bstrength * tex_strength(ss, brush,
-				                                            orig_data.co,
-				                                            test.dist,
-				                                            orig_data.no,
-				                                            NULL, vd.mask ? *vd.mask : 0.0f);
+	proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
-				mul_v3_v3fl(proxy[vd.i], cono, fade);
+	sculpt_brush_test_init(ss, &test);
 
-				if (vd.mvert)
-					vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
-			}
+	BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+	{
+		sculpt_orig_vert_data_update(&orig_data, &vd);
+
+		if (sculpt_brush_test(&test, orig_data.co)) {
+			float vec[3], rot[3][3];
+			const float fade = bstrength * tex_strength(ss, brush,
+			                                            orig_data.co,
+			                                            test.dist,
+			                                            orig_data.no,
+			                                            NULL, vd.mask ? *vd.mask : 0.0f);
+
+			sub_v3_v3v3(vec, orig_data.co, ss->cache->location);
+			axis_angle_normalized_to_mat3(rot, ss->cache->sculpt_normal_symm, angle * fade);
+			mul_v3_m3v3(proxy[vd.i], rot, vec);
+			add_v3_v3(proxy[vd.i], ss->cache->location);
+			sub_v3_v3(proxy[vd.i], orig_data.co);
+
+			if (vd.mvert)
+				vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
 		}
-		BKE_pbvh_vertex_iter_end;
 	}
+	BKE_pbvh_vertex_iter_end;
 }
 
 static void do_rotate_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
 	SculptSession *ss = ob->sculpt;
 	Brush *brush = BKE_paint_brush(&sd->paint);
-	float bstrength = ss->cache->bstrength;
-	int n;
 	static const int flip[8] = { 1, -1, -1, 1, -1, 1, 1, -1 };
 	float angle = ss->cache->vertex_rotation * flip[ss->cache->mirror_symmetry_pass];
 
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT)
-	for (n = 0; n < totnode; n++) {
-		PBVHVertexIter vd;
-		SculptBrushTest test;
-		SculptOrigVertData orig_data;
-		float (*proxy)[3];
+	SculptThreadedTaskData data = {
+		.sd = sd, .ob = ob, .brush = brush, .nodes = nodes, .totnode = totnode,
+		.angle = angle,
+	};
 
-		sculpt_orig_vert_data_init(&orig_data, ob, nodes[n]);
+	sculpt_task_parallel_nodes(sd, &data, do_rotate_brush_task_cb, true);
+}
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+static void do_layer_brush_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	SculptThreadedTaskData *data = userdata;
+	Sculpt *sd = data->sd;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = ss->cache->bstrength;
+	const float *offset = data->offset;
+	const float lim = data->lim;
 
-		sculpt_brush_test_init(ss, &test);
+	PBVHVertexIter vd;
+	SculptBrushTest test;
+	SculptOrigVertData orig_data;
+	float *layer_disp;
+	/* XXX: layer brush needs conversion to proxy but its more complicated */
+	/* proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co; */
+	
+	sculpt_orig_vert_data_init(&orig_data, data->ob, data->nodes[n]);
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
-		{
-			sculpt_orig_vert_data_update(&orig_data, &vd);
+	BLI_mutex_lock(&data->mutex);
+	layer_disp = BKE_pbvh_node_layer_disp_get(ss->pbvh, data->nodes[n]);
+	BLI_mutex_unlock(&data->mutex);
+	
+	sculpt_brush_test_init(ss, &test);
 
-			if (sculpt_brush_test(&test, orig_data.co)) {
-				float vec[3], rot[3][3];
-				const float fade = bstrength * tex_strength(ss, brush,
-				                                            orig_data.co,
-				                                            test.dist,
-				                                            orig_data.no,
-				                                            NULL, vd.mask ? *vd.mask : 0.0f);
+	BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+	{
+		sculpt_orig_vert_data_update(&orig_data, &vd);
 
-				sub_v3_v3v3(vec, orig_data.co, ss->cache->location);
-				axis_angle_normalized_to_mat3(rot, ss->cache->sculpt_normal_symm, angle * fade);
-				mul_v3_m3v3(proxy[vd.i], rot, vec);
-				add_v3_v3(proxy[vd.i], ss->cache->location);
-				sub_v3_v3(proxy[vd.i], orig_data.co);
+		if (sculpt_brush_test(&test, orig_data.co)) {
+			const float fade = bstrength * tex_strength(ss, brush, vd.co, test.dist,
+			                                            vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
+			float *disp = &layer_disp[vd.i];
+			float val[3];
 
-				if (vd.mvert)
-					vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
+			*disp += fade;
+
+			/* Don't let the displacement go past the limit */
+			if ((lim < 0 && *disp < lim) || (lim >= 0 && *disp > lim))
+				*disp = lim;
+
+			mul_v3_v3fl(val, offset, *disp);
+
+			if (!ss->multires && !ss->bm && ss->layer_co && (brush->flag & BRUSH_PERSISTENT)) {
+				int index = vd.vert_indices[vd.i];
+
+				/* persistent base */
+				add_v3_v3(val, ss->layer_co[index]);
+			}
+			else {
+				add_v3_v3(val, orig_data.co);
 			}
+
+			sculpt_clip(sd, ss, vd.co, val);
+
+			if (vd.mvert)
+				vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
 		}
-		BKE_pbvh_vertex_iter_end;
 	}
+	BKE_pbvh_vertex_iter_end;
 }
 
 static void do_layer_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
@@ -2243,105 +2430,66 @@ static void do_layer_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode
 	float bstrength = ss->cache->bstrength;
 	float offset[3];
 	float lim = brush->height;
-	int n;
 
 	if (bstrength < 0)
 		lim = -lim;
 
 	mul_v3_v3v3(offset, ss->cache->scale, ss->cache->sculpt_normal_symm);
 
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT)
-	for (n = 0; n < totnode; n++) {
-		PBVHVertexIter vd;
-		SculptBrushTest test;
-		SculptOrigVertData orig_data;
-		float *layer_disp;
-		/* XXX: layer brush needs conversion to proxy but its more complicated */
-		/* proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co; */
-		
-		sculpt_orig_vert_data_init(&orig_data, ob, nodes[n]);
-
-#pragma omp critical
-		{
-			layer_disp = BKE_pbvh_node_layer_disp_get(ss->pbvh, nodes[n]);
-		}
-		
-		sculpt_brush_test_init(ss, &test);
-
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
-		{
-			sculpt_orig_vert_data_update(&orig_data, &vd);
+	SculptThreadedTaskData data = {
+		.sd = sd, .ob = ob, .brush = brush, .nodes = nodes, .totnode = totnode,
+		.offset = offset, .lim = lim,
+	};
 
-			if (sculpt_brush_test(&test, orig_data.co)) {
-				const float fade = bstrength * tex_strength(ss, brush, vd.co, test.dist,
-				                                            vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
-				float *disp = &layer_disp[vd.i];
-				float val[3];
+	BLI_mutex_init(&data.mutex);
+	sculpt_task_parallel_nodes(sd, &data, do_layer_brush_task_cb, true);
+	BLI_mutex_end(&data.mutex);
+}
 
-				*disp += fade;
+static void do_inflate_brush_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = ss->cache->bstrength;
 
-				/* Don't let the displacement go past the limit */
-				if ((lim < 0 && *disp < lim) || (lim >= 0 && *disp > lim))
-					*disp = lim;
+	PBVHVertexIter vd;
+	SculptBrushTest test;
+	float (*proxy)[3];
 
-				mul_v3_v3fl(val, offset, *disp);
+	proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
-				if (!ss->multires && !ss->bm && ss->layer_co && (brush->flag & BRUSH_PERSISTENT)) {
-					int index = vd.vert_indices[vd.i];
+	sculpt_brush_test_init(ss, &test);
 
-					/* persistent base */
-					add_v3_v3(val, ss->layer_co[index]);
-				}
-				else {
-					add_v3_v3(val, orig_data.co);
-				}
+	BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+	{
+		if (sculpt_brush_test(&test, vd.co)) {
+			const float fade = bstrength * tex_strength(ss, brush, vd.co, test.dist,
+			                                            vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
+			float val[3];
 
-				sculpt_clip(sd, ss, vd.co, val);
+			if (vd.fno) copy_v3_v3(val, vd.fno);
+			else normal_short_to_float_v3(val, vd.no);
+			
+			mul_v3_fl(val, fade * ss->cache->radius);
+			mul_v3_v3v3(proxy[vd.i], val, ss->cache->scale);
 
-				if (vd.mvert)
-					vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
-			}
+			if (vd.mvert)
+				vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
 		}
-		BKE_pbvh_vertex_iter_end;
 	}
+	BKE_pbvh_vertex_iter_end;
 }
 
 static void do_inflate_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
-	SculptSession *ss = ob->sculpt;
 	Brush *brush = BKE_paint_brush(&sd->paint);
-	float bstrength = ss->cache->bstrength;
-	int n;
 
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT)
-	for (n = 0; n < totnode; n++) {
-		PBVHVertexIter vd;
-		SculptBrushTest test;
-		float (*proxy)[3];
-
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
-
-		sculpt_brush_test_init(ss, &test);
-
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
-		{
-			if (sculpt_brush_test(&test, vd.co)) {
-				const float fade = bstrength * tex_strength(ss, brush, vd.co, test.dist,
-				                                            vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
-				float val[3];
-
-				if (vd.fno) copy_v3_v3(val, vd.fno);
-				else normal_short_to_float_v3(val, vd.no);
-				
-				mul_v3_fl(val, fade * ss->cache->radius);
-				mul_v3_v3v3(proxy[vd.i], val, ss->cache->scale);
+	SculptThreadedTaskData data = {
+		.sd = sd, .ob = ob, .brush = brush, .nodes = nodes, .totnode = totnode,
+	};
 
-				if (vd.mvert)
-					vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
-			}
-		}
-		BKE_pbvh_vertex_iter_end;
-	}
+	sculpt_task_parallel_nodes(sd, &data, do_inflate_brush_task_cb, true);
 }
 
 static void calc_sculpt_plane(
@@ -2469,12 +2617,52 @@ static float get_offset(Sculpt *sd, SculptSession *ss)
 	return rv;
 }
 
+static void do_flatten_brush_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = ss->cache->bstrength;
+	const float *area_no = data->area_no;
+	const float *area_co = data->area_co;
+
+	PBVHVertexIter vd;
+	SculptBrushTest test;
+	float (*proxy)[3];
+
+	proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
+
+	sculpt_brush_test_init(ss, &test);
+
+	BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+	{
+		if (sculpt_brush_test_sq(&test, vd.co)) {
+			float intr[3];
+			float val[3];
+
+			point_plane_project(intr, vd.co, area_no, area_co);
+
+			sub_v3_v3v3(val, intr, vd.co);
+
+			if (plane_trim(ss->cache, brush, val)) {
+				const float fade = bstrength * tex_strength(ss, brush, vd.co, sqrtf(test.dist),
+				                                            vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
+
+				mul_v3_v3fl(proxy[vd.i], val, fade);
+
+				if (vd.mvert)
+					vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
+			}
+		}
+	}
+	BKE_pbvh_vertex_iter_end;
+}
+
 static void do_flatten_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 {
 	SculptSession *ss = ob->sculpt;
 	Brush *brush = BKE_paint_brush(&sd->paint);
 
-	float bstrength = ss->cache->bstrength;
 	const float radius = ss->cache->radius;
 
 	float area_no[3];
@@ -2484,7 +2672,6 @@ static void do_flatten_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totno
 
 	float displace;
 
-	int n;
 
 	float temp[3];
 
@@ -2496,19 +2683,36 @@ static void do_flatten_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totno
 	mul_v3_fl(temp, displace);
 	add_v3_v3(area_co, temp);
 
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT)
-	for (n = 0; n < totnode; n++) {
-		PBVHVertexIter vd;
-		SculptBrushTest test;
-		float (*proxy)[3];
+	SculptThreadedTaskData data = {
+		.sd = sd, .ob = ob, .brush = brush, .nodes = nodes, .totnode = totnode,
+		.area_no = area_no, .area_co = area_co,
+	};
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+	sculpt_task_parallel_nodes(sd, &data, do_flatten_brush_task_cb, true);
+}
 
-		sculpt_brush_test_init(ss, &test);
+static void do_clay_brush_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const bool flip = data->flip;
+	const float bstrength = data->strength;
+	const float *area_no = data->area_no;
+	const float *area_co = data->area_co;
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
-		{
-			if (sculpt_brush_test_sq(&test, vd.co)) {
+	PBVHVertexIter vd;
+	SculptBrushTest test;
+	float (*proxy)[3];
+
+	proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
+
+	sculpt_brush_test_init(ss, &test);
+
+	BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+	{
+		if (sculpt_brush_test_sq(&test, vd.co)) {
+			if (plane_point_side_flip(vd.co, area_no, area_co, flip)) {
 				float intr[3];
 				float val[3];
 
@@ -2517,6 +2721,8 @@ static void do_flatten_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totno
 				sub_v3_v3v3(val, intr, vd.co);
 
 				if (plane_trim(ss->cache, brush, val)) {
+					/* note, the normal from the vertices is ignored,
+					 * causes glitch with planes, see: T44390 */
 					const float fade = bstrength * tex_strength(ss, brush, vd.co, sqrtf(test.dist),
 					                                            vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
 
@@ -2527,8 +2733,8 @@ static void do_flatten_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totno
 				}
 			}
 		}
-		BKE_pbvh_vertex_iter_end;
 	}
+	BKE_pbvh_vertex_iter_end;
 }
 
 static void do_clay_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
@@ -2545,7 +2751,6 @@ static void do_clay_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 	float area_no[3];
 	float area_co[3];
 
-	int n;
 
 	float temp[3];
 
@@ -2568,43 +2773,61 @@ static void do_clay_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 
 	/* add_v3_v3v3(p, ss->cache->location, area_no); */
 
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT)
-	for (n = 0; n < totnode; n++) {
-		PBVHVertexIter vd;
-		SculptBrushTest test;
-		float (*proxy)[3];
+	SculptThreadedTaskData data = {
+		.sd = sd, .ob = ob, .brush = brush, .nodes = nodes, .totnode = totnode,
+		.area_no = area_no, .area_co = area_co,
+		.flip = flip, .strength = bstrength,
+	};
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+	sculpt_task_parallel_nodes(sd, &data, do_clay_brush_task_cb, true);
+}
 
-		sculpt_brush_test_init(ss, &test);
+static void do_clay_strips_brush_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const bool flip = data->flip;
+	const float bstrength = data->strength;
+	const float *area_no_sp = data->area_no_sp;
+	const float *area_co = data->area_co;
+	float (*mat)[4] = data->mat;
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
-		{
-			if (sculpt_brush_test_sq(&test, vd.co)) {
-				if (plane_point_side_flip(vd.co, area_no, area_co, flip)) {
-					float intr[3];
-					float val[3];
+	PBVHVertexIter vd;
+	SculptBrushTest test;
+	float (*proxy)[3];
+
+	proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
-					point_plane_project(intr, vd.co, area_no, area_co);
+	sculpt_brush_test_init(ss, &test);
 
-					sub_v3_v3v3(val, intr, vd.co);
+	BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+	{
+		if (sculpt_brush_test_cube(&test, vd.co, mat)) {
+			if (plane_point_side_flip(vd.co, area_no_sp, area_co, flip)) {
+				float intr[3];
+				float val[3];
 
-					if (plane_trim(ss->cache, brush, val)) {
-						/* note, the normal from the vertices is ignored,
-						 * causes glitch with planes, see: T44390 */
-						const float fade = bstrength * tex_strength(ss, brush, vd.co, sqrtf(test.dist),
-						                                            vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
+				point_plane_project(intr, vd.co, area_no_sp, area_co);
 
-						mul_v3_v3fl(proxy[vd.i], val, fade);
+				sub_v3_v3v3(val, intr, vd.co);
 
-						if (vd.mvert)
-							vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
-					}
+				if (plane_trim(ss->cache, brush, val)) {
+					/* note, the normal from the vertices is ignored,
+					 * causes glitch with planes, see: T44390 */
+					const float fade = bstrength * tex_strength(ss, brush, vd.co,
+					                                            ss->cache->radius * test.dist,
+					                                            vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
+
+					mul_v3_v3fl(proxy[vd.i], val, fade);
+
+					if (vd.mvert)
+						vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
 				}
 			}
 		}
-		BKE_pbvh_vertex_iter_end;
 	}
+	BKE_pbvh_vertex_iter_end;
 }
 
 static void do_clay_strips_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
@@ -2622,7 +2845,6 @@ static void do_clay_strips_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int t
 	float area_no[3];     /* geometry normal */
 	float area_co[3];
 
-	int n;
 
 	float temp[3];
 	float mat[4][4];
@@ -2671,44 +2893,57 @@ static void do_clay_strips_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int t
 	mul_m4_m4m4(tmat, mat, scale);
 	invert_m4_m4(mat, tmat);
 
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT)
-	for (n = 0; n < totnode; n++) {
-		PBVHVertexIter vd;
-		SculptBrushTest test;
-		float (*proxy)[3];
+	SculptThreadedTaskData data = {
+		.sd = sd, .ob = ob, .brush = brush, .nodes = nodes, .totnode = totnode,
+		.area_no_sp = area_no_sp, .area_co = area_co, .mat = mat,
+		.flip = flip, .strength = bstrength,
+	};
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+	sculpt_task_parallel_nodes(sd, &data, do_clay_strips_brush_task_cb, true);
+}
 
-		sculpt_brush_test_init(ss, &test);
+static void do_fill_brush_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = ss->cache->bstrength;
+	const float *area_no = data->area_no;
+	const float *area_co = data->area_co;
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
-		{
-			if (sculpt_brush_test_cube(&test, vd.co, mat)) {
-				if (plane_point_side_flip(vd.co, area_no_sp, area_co, flip)) {
-					float intr[3];
-					float val[3];
+	PBVHVertexIter vd;
+	SculptBrushTest test;
+	float (*proxy)[3];
+
+	proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
-					point_plane_project(intr, vd.co, area_no_sp, area_co);
+	sculpt_brush_test_init(ss, &test);
 
-					sub_v3_v3v3(val, intr, vd.co);
+	BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+	{
+		if (sculpt_brush_test_sq(&test, vd.co)) {
+			if (plane_point_side(vd.co, area_no, area_co)) {
+				float intr[3];
+				float val[3];
 
-					if (plane_trim(ss->cache, brush, val)) {
-						/* note, the normal from the vertices is ignored,
-						 * causes glitch with planes, see: T44390 */
-						const float fade = bstrength * tex_strength(ss, brush, vd.co,
-						                                            ss->cache->radius * test.dist,
-						                                            vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
+				point_plane_project(intr, vd.co, area_no, area_co);
 
-						mul_v3_v3fl(proxy[vd.i], val, fade);
+				sub_v3_v3v3(val, intr, vd.co);
 
-						if (vd.mvert)
-							vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
-					}
+				if (plane_trim(ss->cache, brush, val)) {
+					const float fade = bstrength * tex_strength(ss, brush, vd.co,
+					                                            sqrtf(test.dist),
+					                                            vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
+
+					mul_v3_v3fl(proxy[vd.i], val, fade);
+
+					if (vd.mvert)
+						vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
 				}
 			}
 		}
-		BKE_pbvh_vertex_iter_end;
 	}
+	BKE_pbvh_vertex_iter_end;
 }
 
 static void do_fill_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
@@ -2716,7 +2951,6 @@ static void do_fill_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 	SculptSession *ss = ob->sculpt;
 	Brush *brush = BKE_paint_brush(&sd->paint);
 
-	float bstrength = ss->cache->bstrength;
 	const float radius = ss->cache->radius;
 
 	float area_no[3];
@@ -2725,7 +2959,6 @@ static void do_fill_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 
 	float displace;
 
-	int n;
 
 	float temp[3];
 
@@ -2737,42 +2970,56 @@ static void do_fill_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
 	mul_v3_fl(temp, displace);
 	add_v3_v3(area_co, temp);
 
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT)
-	for (n = 0; n < totnode; n++) {
-		PBVHVertexIter vd;
-		SculptBrushTest test;
-		float (*proxy)[3];
+	SculptThreadedTaskData data = {
+		.sd = sd, .ob = ob, .brush = brush, .nodes = nodes, .totnode = totnode,
+		.area_no = area_no, .area_co = area_co,
+	};
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+	sculpt_task_parallel_nodes(sd, &data, do_fill_brush_task_cb, true);
+}
 
-		sculpt_brush_test_init(ss, &test);
+static void do_scrape_brush_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float bstrength = ss->cache->bstrength;
+	const float *area_no = data->area_no;
+	const float *area_co = data->area_co;
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
-		{
-			if (sculpt_brush_test_sq(&test, vd.co)) {
-				if (plane_point_side(vd.co, area_no, area_co)) {
-					float intr[3];
-					float val[3];
+	PBVHVertexIter vd;
+	SculptBrushTest test;
+	float (*proxy)[3];
 
-					point_plane_project(intr, vd.co, area_no, area_co);
+	proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
-					sub_v3_v3v3(val, intr, vd.co);
+	sculpt_brush_test_init(ss, &test);
 
-					if (plane_trim(ss->cache, brush, val)) {
-						const float fade = bstrength * tex_strength(ss, brush, vd.co,
-						                                            sqrtf(test.dist),
-						                                            vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
+	BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+	{
+		if (sculpt_brush_test_sq(&test, vd.co)) {
+			if (!plane_point_side(vd.co, area_no, area_co)) {
+				float intr[3];
+				float val[3];
 
-						mul_v3_v3fl(proxy[vd.i], val, fade);
+				point_plane_project(intr, vd.co, area_no, area_co);
 
-						if (vd.mvert)
-							vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
-					}
+				sub_v3_v3v3(val, intr, vd.co);
+
+				if (plane_trim(ss->cache, brush, val)) {
+					const float fade = bstrength * tex_strength(ss, brush, vd.co,
+					                                            sqrtf(test.dist),
+					                                            vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
+
+					mul_v3_v3fl(proxy[vd.i], val, fade);
+
+					if (vd.mvert)
+						vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
 				}
 			}
 		}
-		BKE_pbvh_vertex_iter_end;
 	}
+	BKE_pbvh_vertex_iter_end;
 }
 
 static void do_scrape_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode)
@@ -2780,7 +3027,6 @@ static void do_scrape_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnod
 	SculptSession *ss = ob->sculpt;
 	Brush *brush = BKE_paint_brush(&sd->paint);
 
-	float bstrength = ss->cache->bstrength;
 	const float radius = ss->cache->radius;
 
 	float area_no[3];
@@ -2789,7 +3035,6 @@ static void do_scrape_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnod
 
 	float displace;
 
-	int n;
 
 	float temp[3];
 
@@ -2801,42 +3046,41 @@ static void do_scrape_brush(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnod
 	mul_v3_fl(temp, displace);
 	add_v3_v3(area_co, temp);
 
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT)
-	for (n = 0; n < totnode; n++) {
-		PBVHVertexIter vd;
-		SculptBrushTest test;
-		float (*proxy)[3];
+	SculptThreadedTaskData data = {
+		.sd = sd, .ob = ob, .brush = brush, .nodes = nodes, .totnode = totnode,
+		.area_no = area_no, .area_co = area_co,
+	};
 
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
+	sculpt_task_parallel_nodes(sd, &data, do_scrape_brush_task_cb, true);
+}
 
-		sculpt_brush_test_init(ss, &test);
+static void do_gravity_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Brush *brush = data->brush;
+	const float *offset = data->offset;
 
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
-		{
-			if (sculpt_brush_test_sq(&test, vd.co)) {
-				if (!plane_point_side(vd.co, area_no, area_co)) {
-					float intr[3];
-					float val[3];
+	PBVHVertexIter vd;
+	SculptBrushTest test;
+	float (*proxy)[3];
 
-					point_plane_project(intr, vd.co, area_no, area_co);
+	proxy = BKE_pbvh_node_add_proxy(ss->pbvh, data->nodes[n])->co;
 
-					sub_v3_v3v3(val, intr, vd.co);
+	sculpt_brush_test_init(ss, &test);
 
-					if (plane_trim(ss->cache, brush, val)) {
-						const float fade = bstrength * tex_strength(ss, brush, vd.co,
-						                                            sqrtf(test.dist),
-						                                            vd.no, vd.fno, vd.mask ? *vd.mask : 0.0f);
+	BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE) {
+		if (sculpt_brush_test_sq(&test, vd.co)) {
+			const float fade = tex_strength(ss, brush, vd.co, sqrtf(test.dist), vd.no,
+			                                vd.fno, vd.mask ? *vd.mask : 0.0f);
 
-						mul_v3_v3fl(proxy[vd.i], val, fade);
+			mul_v3_v3fl(proxy[vd.i], offset, fade);
 
-						if (vd.mvert)
-							vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
-					}
-				}
-			}
+			if (vd.mvert)
+				vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
 		}
-		BKE_pbvh_vertex_iter_end;
 	}
+	BKE_pbvh_vertex_iter_end;
 }
 
 static void do_gravity(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode, float bstrength)
@@ -2845,7 +3089,6 @@ static void do_gravity(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode, fl
 	Brush *brush = BKE_paint_brush(&sd->paint);
 
 	float offset[3]/*, area_no[3]*/;
-	int n;
 	float gravity_vector[3];
 
 	mul_v3_v3fl(gravity_vector, ss->cache->gravity_direction, -ss->cache->radius_squared);
@@ -2855,29 +3098,12 @@ static void do_gravity(Sculpt *sd, Object *ob, PBVHNode **nodes, int totnode, fl
 	mul_v3_fl(offset, bstrength);
 
 	/* threaded loop over nodes */
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT)
-	for (n = 0; n < totnode; n++) {
-		PBVHVertexIter vd;
-		SculptBrushTest test;
-		float (*proxy)[3];
-
-		proxy = BKE_pbvh_node_add_proxy(ss->pbvh, nodes[n])->co;
-
-		sculpt_brush_test_init(ss, &test);
-
-		BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE) {
-			if (sculpt_brush_test_sq(&test, vd.co)) {
-				const float fade = tex_strength(ss, brush, vd.co, sqrtf(test.dist), vd.no,
-				                                vd.fno, vd.mask ? *vd.mask : 0.0f);
-
-				mul_v3_v3fl(proxy[vd.i], offset, fade);
+	SculptThreadedTaskData data = {
+		.sd = sd, .ob = ob, .brush = brush, .nodes = nodes, .totnode = totnode,
+		.offset = offset,
+	};
 
-				if (vd.mvert)
-					vd.mvert->flag |= ME_VERT_PBVH_UPDATE;
-			}
-		}
-		BKE_pbvh_vertex_iter_end;
-	}
+	sculpt_task_parallel_nodes(sd, &data, do_gravity_task_cb, true);
 }
 
 
@@ -2987,12 +3213,21 @@ static void sculpt_topology_update(Sculpt *sd, Object *ob, Brush *brush, Unified
 	}
 }
 
+static void do_brush_action_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	SculptThreadedTaskData *data = userdata;
+
+	sculpt_undo_push_node(data->ob, data->nodes[n],
+	                      data->brush->sculpt_tool == SCULPT_TOOL_MASK ? SCULPT_UNDO_MASK : SCULPT_UNDO_COORDS);
+	BKE_pbvh_node_mark_update(data->nodes[n]);
+}
+
 static void do_brush_action(Sculpt *sd, Object *ob, Brush *brush, UnifiedPaintSettings *ups)
 {
 	SculptSession *ss = ob->sculpt;
 	SculptSearchSphereData data;
 	PBVHNode **nodes = NULL;
-	int n, totnode;
+	int totnode;
 
 	/* Build a list of all nodes that are potentially within the brush's area of influence */
 	data.ss = ss;
@@ -3005,13 +3240,11 @@ static void do_brush_action(Sculpt *sd, Object *ob, Brush *brush, UnifiedPaintSe
 	if (totnode) {
 		float location[3];
 
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT)
-		for (n = 0; n < totnode; n++) {
-			sculpt_undo_push_node(ob, nodes[n],
-			                      brush->sculpt_tool == SCULPT_TOOL_MASK ?
-			                      SCULPT_UNDO_MASK : SCULPT_UNDO_COORDS);
-			BKE_pbvh_node_mark_update(nodes[n]);
-		}
+		SculptThreadedTaskData task_data = {
+			.sd = sd, .ob = ob, .brush = brush, .nodes = nodes, .totnode = totnode,
+		};
+
+		sculpt_task_parallel_nodes(sd, &task_data, do_brush_action_task_cb, true);
 
 		if (sculpt_brush_needs_normal(brush))
 			update_sculpt_normal(sd, ob, nodes, totnode);
@@ -3123,12 +3356,60 @@ static void sculpt_flush_pbvhvert_deform(Object *ob, PBVHVertexIter *vd)
 		copy_v3_v3(me->mvert[index].co, newco);
 }
 
+static void sculpt_combine_proxies_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Sculpt *sd = data->sd;
+	Object *ob = data->ob;
+	const bool use_orco = data->use_orco;
+
+	PBVHVertexIter vd;
+	PBVHProxyNode *proxies;
+	int proxy_count;
+	float (*orco)[3] = NULL;
+
+	if (use_orco && !ss->bm)
+		orco = sculpt_undo_push_node(data->ob, data->nodes[n], SCULPT_UNDO_COORDS)->co;
+
+	BKE_pbvh_node_get_proxies(data->nodes[n], &proxies, &proxy_count);
+
+	BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+	{
+		float val[3];
+		int p;
+
+		if (use_orco) {
+			if (ss->bm) {
+				copy_v3_v3(val,
+				           BM_log_original_vert_co(ss->bm_log,
+				           vd.bm_vert));
+			}
+			else
+				copy_v3_v3(val, orco[vd.i]);
+		}
+		else
+			copy_v3_v3(val, vd.co);
+
+		for (p = 0; p < proxy_count; p++)
+			add_v3_v3(val, proxies[p].co[vd.i]);
+
+		sculpt_clip(sd, ss, vd.co, val);
+
+		if (ss->modifiers_active)
+			sculpt_flush_pbvhvert_deform(ob, &vd);
+	}
+	BKE_pbvh_vertex_iter_end;
+
+	BKE_pbvh_node_free_proxies(data->nodes[n]);
+}
+
 static void sculpt_combine_proxies(Sculpt *sd, Object *ob)
 {
 	SculptSession *ss = ob->sculpt;
 	Brush *brush = BKE_paint_brush(&sd->paint);
 	PBVHNode **nodes;
-	int totnode, n;
+	int totnode;
 
 	BKE_pbvh_gather_proxies(ss->pbvh, &nodes, &totnode);
 
@@ -3136,51 +3417,13 @@ static void sculpt_combine_proxies(Sculpt *sd, Object *ob)
 	if (ss->cache->supports_gravity ||
 	    (sculpt_tool_is_proxy_used(brush->sculpt_tool) == false))
 	{
-		/* these brushes start from original coordinates */
-		const bool use_orco = ELEM(brush->sculpt_tool, SCULPT_TOOL_GRAB,
-		                           SCULPT_TOOL_ROTATE, SCULPT_TOOL_THUMB);
+		SculptThreadedTaskData data = {
+			.sd = sd, .ob = ob, .brush = brush, .nodes = nodes, .totnode = totnode,
+			/* these brushes start from original coordinates */
+			.use_orco = ELEM(brush->sculpt_tool, SCULPT_TOOL_GRAB, SCULPT_TOOL_ROTATE, SCULPT_TOOL_THUMB),
+		};
 
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT)
-		for (n = 0; n < totnode; n++) {
-			PBVHVertexIter vd;
-			PBVHProxyNode *proxies;
-			int proxy_count;
-			float (*orco)[3] = NULL;
-
-			if (use_orco && !ss->bm)
-				orco = sculpt_undo_push_node(ob, nodes[n], SCULPT_UNDO_COORDS)->co;
-
-			BKE_pbvh_node_get_proxies(nodes[n], &proxies, &proxy_count);
-
-			BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
-			{
-				float val[3];
-				int p;
-
-				if (use_orco) {
-					if (ss->bm) {
-						copy_v3_v3(val,
-						           BM_log_original_vert_co(ss->bm_log,
-						           vd.bm_vert));
-					}
-					else
-						copy_v3_v3(val, orco[vd.i]);
-				}
-				else
-					copy_v3_v3(val, vd.co);
-
-				for (p = 0; p < proxy_count; p++)
-					add_v3_v3(val, proxies[p].co[vd.i]);
-
-				sculpt_clip(sd, ss, vd.co, val);
-
-				if (ss->modifiers_active)
-					sculpt_flush_pbvhvert_deform(ob, &vd);
-			}
-			BKE_pbvh_vertex_iter_end;
-
-			BKE_pbvh_node_free_proxies(nodes[n]);
-		}
+		sculpt_task_parallel_nodes(sd, &data, sculpt_combine_proxies_task_cb, true);
 	}
 
 	if (nodes)
@@ -3206,6 +3449,27 @@ static void sculpt_update_keyblock(Object *ob)
 	}
 }
 
+static void sculpt_flush_stroke_deform_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	SculptThreadedTaskData *data = userdata;
+	SculptSession *ss = data->ob->sculpt;
+	Object *ob = data->ob;
+	float (*vertCos)[3] = data->vertCos;
+
+	PBVHVertexIter vd;
+
+	BKE_pbvh_vertex_iter_begin(ss->pbvh, data->nodes[n], vd, PBVH_ITER_UNIQUE)
+	{
+		sculpt_flush_pbvhvert_deform(ob, &vd);
+
+		if (vertCos) {
+			int index = vd.vert_indices[vd.i];
+			copy_v3_v3(vertCos[index], ss->orig_cos[index]);
+		}
+	}
+	BKE_pbvh_vertex_iter_end;
+}
+
 /* flush displacement from deformed PBVH to original layer */
 static void sculpt_flush_stroke_deform(Sculpt *sd, Object *ob)
 {
@@ -3216,7 +3480,7 @@ static void sculpt_flush_stroke_deform(Sculpt *sd, Object *ob)
 		/* this brushes aren't using proxies, so sculpt_combine_proxies() wouldn't
 		 * propagate needed deformation to original base */
 
-		int n, totnode;
+		int totnode;
 		Mesh *me = (Mesh *)ob->data;
 		PBVHNode **nodes;
 		float (*vertCos)[3] = NULL;
@@ -3233,20 +3497,13 @@ static void sculpt_flush_stroke_deform(Sculpt *sd, Object *ob)
 
 		BKE_pbvh_search_gather(ss->pbvh, NULL, NULL, &nodes, &totnode);
 
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT)
-		for (n = 0; n < totnode; n++) {
-			PBVHVertexIter vd;
-
-			BKE_pbvh_vertex_iter_begin(ss->pbvh, nodes[n], vd, PBVH_ITER_UNIQUE)
-			{
-				sculpt_flush_pbvhvert_deform(ob, &vd);
+		{
+			SculptThreadedTaskData data = {
+				.sd = sd, .ob = ob, .brush = brush, .nodes = nodes, .totnode = totnode,
+				.vertCos = vertCos,
+			};
 
-				if (vertCos) {
-					int index = vd.vert_indices[vd.i];
-					copy_v3_v3(vertCos[index], ss->orig_cos[index]);
-				}
-			}
-			BKE_pbvh_vertex_iter_end;
+			sculpt_task_parallel_nodes(sd, &data, sculpt_flush_stroke_deform_task_cb, true);
 		}
 
 		if (vertCos) {
@@ -3564,36 +3821,19 @@ static void sculpt_init_mirror_clipping(Object *ob, SculptSession *ss)
 	}
 }
 
-static void sculpt_omp_start(Sculpt *sd, SculptSession *ss)
+static void sculpt_threaded_data_init(Sculpt *sd, SculptSession *ss)
 {
 	StrokeCache *cache = ss->cache;
 
-#ifdef _OPENMP
-
-#if defined(__APPLE__)
-	cache->init_num_threads = BLI_system_thread_count();
-#else
-	cache->init_num_threads = omp_get_max_threads();
-#endif
-	/* If using OpenMP then create a number of threads two times the
-	 * number of processor cores.
-	 * Justification: Empirically I've found that two threads per
-	 * processor gives higher throughput. */
+	/* Node loops run in the task scheduler threads plus the calling one,
+	 * the smoothing buffers are indexed by BLI_task_scheduler_thread_id(). */
 	if (sd->flags & SCULPT_USE_OPENMP) {
-#if defined(__APPLE__)
-		cache->num_threads = system_physical_thread_count();
-#else
-		cache->num_threads = 2 * omp_get_num_procs();
-#endif
+		cache->num_threads = BLI_task_scheduler_num_threads(BLI_task_scheduler_get());
 	}
 	else {
 		cache->num_threads = 1;
 	}
-	omp_set_num_threads(cache->num_threads);
-#else
-	(void)sd;
-	cache->num_threads = 1;
-#endif
+
 	if (ss->multires) {
 		int i, gridsize, array_mem_size;
 		BKE_pbvh_node_get_grids(ss->pbvh, NULL, NULL, NULL, NULL,
@@ -3618,12 +3858,8 @@ static void sculpt_omp_start(Sculpt *sd, SculptSession *ss)
 	}
 }
 
-static void sculpt_omp_done(SculptSession *ss)
+static void sculpt_threaded_data_free(SculptSession *ss)
 {
-#ifdef _OPENMP
-	omp_set_num_threads(ss->cache->init_num_threads);
-#endif
-
 	if (ss->multires) {
 		int i;
 
@@ -3802,7 +4038,7 @@ static void sculpt_update_cache_invariants(bContext *C, Sculpt *sd, SculptSessio
 		
 #undef PIXEL_INPUT_THRESHHOLD
 	
-	sculpt_omp_start(sd, ss);
+	sculpt_threaded_data_init(sd, ss);
 }
 
 static void sculpt_update_brush_delta(UnifiedPaintSettings *ups, Object *ob, Brush *brush)
@@ -4198,8 +4434,11 @@ static void sculpt_flush_update(bContext *C)
 
 	if (mmd)
 		multires_mark_as_modified(ob, MULTIRES_COORDS_MODIFIED);
-	if (ob->derivedFinal) /* VBO no longer valid */
-		GPU_drawobject_free(ob->derivedFinal);
+	if (ob->derivedFinal) {
+		/* only the coords and normals of the VBO changed */
+		GPU_drawobject_tag_buffer_dirty(ob->derivedFinal, GPU_BUFFER_VERTEX);
+		GPU_drawobject_tag_buffer_dirty(ob->derivedFinal, GPU_BUFFER_NORMAL);
+	}
 
 	if (ss->kb || ss->modifiers_active) {
 		DAG_id_tag_update(&ob->id, OB_RECALC_DATA);
@@ -4344,7 +4583,7 @@ static void sculpt_stroke_done(const bContext *C, struct PaintStroke *UNUSED(str
 	SculptSession *ss = ob->sculpt;
 	Sculpt *sd = CTX_data_tool_settings(C)->sculpt;
 
-	sculpt_omp_done(ss);
+	sculpt_threaded_data_free(ss);
 
 	/* Finished */
 	if (ss->cache) {
@@ -113,6 +113,11 @@ typedef struct SculptUndoNode {
 
 	/* shape keys */
 	char shapeName[sizeof(((KeyBlock *)0))->name];
+
+	/* coords or mask, once the step is done (see sculpt_undo_pack) */
+	void *packed;
+	unsigned int packed_len;
+	unsigned int packed_hash[2];  /* values the delta applies to, values it gives */
 } SculptUndoNode;
 
 SculptUndoNode *sculpt_undo_push_node(Object *ob, PBVHNode *node, SculptUndoType type);
@@ -124,7 +129,7 @@ void sculpt_vertcos_to_key(Object *ob, KeyBlock *kb, float (*vertCos)[3]);
 
 void sculpt_update_object_bounding_box(struct Object *ob);
 
-/* Setting zero so we can catch bugs in OpenMP/sculpt. */
+/* Setting zero so we can catch bugs in threaded sculpt code. */
 #ifdef DEBUG
 #  define SCULPT_OMP_LIMIT 0
 #else
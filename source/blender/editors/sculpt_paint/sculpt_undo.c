@@ -33,6 +33,9 @@
  */
 
 #include <stddef.h>
+#include <string.h>
+
+#include "zlib.h"
 
 #include "MEM_guardedalloc.h"
 
@@ -41,6 +44,8 @@
 #include "BLI_string.h"
 #include "BLI_listbase.h"
 #include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "DNA_meshdata_types.h"
@@ -265,7 +270,181 @@ static int sculpt_undo_restore_mask(bContext *C, DerivedMesh *dm, SculptUndoNode
 	return 1;
 }
 
-static void sculpt_undo_bmesh_restore_generic(bContext *C,
+/* -------------------------------------------------------------------- */
+/* Packed undo nodes
+ *
+ * Once a step is done, the coordinates or masks of a node are stored as
+ * the XOR of their bits with the current values. Vertices the stroke didn't
+ * move give zero words and small moves only change the low mantissa bits,
+ * so the words are split into byte planes and deflated.
+ *
+ * XOR is its own inverse, undo and redo apply the same delta. The values
+ * on both sides of it are hashed, so the delta is never applied to values
+ * it wasn't made from (the node is skipped like any other mismatch). */
+
+static int sculpt_undo_packed_elem_len(const SculptUndoNode *unode)
+{
+	return (unode->type == SCULPT_UNDO_COORDS) ? 3 : 1;
+}
+
+static bool sculpt_undo_can_pack(const SculptSession *ss, const SculptUndoNode *unode)
+{
+	if (ss->bm || !unode->node || !unode->totvert) {
+		return false;
+	}
+
+	switch (unode->type) {
+		case SCULPT_UNDO_COORDS:
+			/* the original coords of deformed meshes and shape keys aren't the node's coords */
+			return (unode->co && !unode->orig_co && unode->shapeName[0] == '\0');
+		case SCULPT_UNDO_MASK:
+			return (unode->mask != NULL);
+		default:
+			return false;
+	}
+}
+
+/* Copy the values restored by the node from the mesh or grids,
+ * or into them when \a to_mesh is set */
+static void sculpt_undo_packed_values_copy(SculptSession *ss, DerivedMesh *dm, SculptUndoNode *unode,
+                                           float *values, const bool to_mesh)
+{
+	const bool is_co = (unode->type == SCULPT_UNDO_COORDS);
+	const int elem_len = sculpt_undo_packed_elem_len(unode);
+	const size_t elem_size = sizeof(float) * (size_t)elem_len;
+	int i, j;
+
+	if (unode->maxvert) {
+		for (i = 0; i < unode->totvert; i++, values += elem_len) {
+			const int vi = unode->index[i];
+			float *v = is_co ? ss->mvert[vi].co : &ss->vmask[vi];
+
+			if (to_mesh) {
+				memcpy(v, values, elem_size);
+				ss->mvert[vi].flag |= ME_VERT_PBVH_UPDATE;
+			}
+			else {
+				memcpy(values, v, elem_size);
+			}
+		}
+	}
+	else {
+		CCGElem **grids = dm->getGridData(dm);
+		const int gridsize = dm->getGridSize(dm);
+		CCGKey key;
+
+		dm->getGridKey(dm, &key);
+
+		for (j = 0; j < unode->totgrid; j++) {
+			CCGElem *grid = grids[unode->grids[j]];
+
+			for (i = 0; i < gridsize * gridsize; i++, values += elem_len) {
+				float *v = is_co ? CCG_elem_offset_co(&key, grid, i) : CCG_elem_offset_mask(&key, grid, i);
+
+				if (to_mesh) memcpy(v, values, elem_size);
+				else memcpy(values, v, elem_size);
+			}
+		}
+	}
+}
+
+/**
+ * Replace the node's coords or mask by their delta from \a values (the current ones).
+ *
+ * \return false when deflating doesn't save anything, the node is left as it was.
+ */
+static bool sculpt_undo_pack(SculptUndoNode *unode, const float *values)
+{
+	float *data = (unode->type == SCULPT_UNDO_COORDS) ? (float *)unode->co : unode->mask;
+	const size_t totval = (size_t)unode->totvert * (size_t)sculpt_undo_packed_elem_len(unode);
+	const size_t size = totval * sizeof(float);
+	unsigned char *planes = MEM_mallocN(size, __func__);
+	uLongf packed_len = compressBound((uLong)size);
+	void *packed = MEM_mallocN(packed_len, __func__);
+	size_t k;
+
+	for (k = 0; k < totval; k++) {
+		unsigned int a, b;
+		memcpy(&a, &data[k], sizeof(a));
+		memcpy(&b, &values[k], sizeof(b));
+		a ^= b;
+		planes[k] = (unsigned char)a;
+		planes[k + totval] = (unsigned char)(a >> 8);
+		planes[k + totval * 2] = (unsigned char)(a >> 16);
+		planes[k + totval * 3] = (unsigned char)(a >> 24);
+	}
+
+	if ((compress2(packed, &packed_len, planes, (uLong)size, Z_BEST_SPEED) != Z_OK) ||
+	    (packed_len >= size))
+	{
+		MEM_freeN(packed);
+		MEM_freeN(planes);
+		return false;
+	}
+
+	unode->packed = MEM_reallocN(packed, packed_len);
+	unode->packed_len = (unsigned int)packed_len;
+	unode->packed_hash[0] = BLI_hash_mm2((const unsigned char *)values, size, 0);
+	unode->packed_hash[1] = BLI_hash_mm2((const unsigned char *)data, size, 0);
+
+	MEM_freeN(planes);
+	return true;
+}
+
+static int sculpt_undo_restore_packed(bContext *C, DerivedMesh *dm, SculptUndoNode *unode)
+{
+	Object *ob = CTX_data_active_object(C);
+	SculptSession *ss = ob->sculpt;
+	const size_t totval = (size_t)unode->totvert * (size_t)sculpt_undo_packed_elem_len(unode);
+	const size_t size = totval * sizeof(float);
+	unsigned char *planes;
+	float *values;
+	uLongf len = (uLongf)size;
+	int ret = 0;
+
+	if (unode->maxvert) {
+		if ((unode->type == SCULPT_UNDO_COORDS) ? (ss->kb || ss->modifiers_active) : !ss->vmask) {
+			/* the delta is from the mesh's own values */
+			return 0;
+		}
+	}
+	else if (!dm->getGridData) {
+		return 0;
+	}
+
+	values = MEM_mallocN(size, __func__);
+	sculpt_undo_packed_values_copy(ss, dm, unode, values, false);
+
+	if (BLI_hash_mm2((const unsigned char *)values, size, 0) == unode->packed_hash[0]) {
+		planes = MEM_mallocN(size, __func__);
+
+		if ((uncompress(planes, &len, unode->packed, unode->packed_len) == Z_OK) && (len == size)) {
+			size_t k;
+
+			for (k = 0; k < totval; k++) {
+				unsigned int a;
+				memcpy(&a, &values[k], sizeof(a));
+				a ^= ((unsigned int)planes[k] |
+				      ((unsigned int)planes[k + totval] << 8) |
+				      ((unsigned int)planes[k + totval * 2] << 16) |
+				      ((unsigned int)planes[k + totval * 3] << 24));
+				memcpy(&values[k], &a, sizeof(a));
+			}
+
+			sculpt_undo_packed_values_copy(ss, dm, unode, values, true);
+			SWAP(unsigned int, unode->packed_hash[0], unode->packed_hash[1]);
+			ret = 1;
+		}
+
+		MEM_freeN(planes);
+	}
+
+	MEM_freeN(values);
+
+	return ret;
+}
+
+static void sculpt_undo_bmesh_restore_generic(bContext *UNUSED(C),
                                               SculptUndoNode *unode,
                                               Object *ob,
                                               SculptSession *ss)
@@ -283,15 +462,9 @@ static void sculpt_undo_bmesh_restore_generic(bContext *C,
 		int i, totnode;
 		PBVHNode **nodes;
 
-#ifdef _OPENMP
-		Sculpt *sd = CTX_data_tool_settings(C)->sculpt;
-#else
-		(void)C;
-#endif
-
 		BKE_pbvh_search_gather(ss->pbvh, NULL, NULL, &nodes, &totnode);
 
-#pragma omp parallel for schedule(guided) if ((sd->flags & SCULPT_USE_OPENMP) && totnode > SCULPT_OMP_LIMIT)
+		/* only sets a flag, not worth threading */
 		for (i = 0; i < totnode; i++) {
 			BKE_pbvh_node_mark_redraw(nodes[i]);
 		}
@@ -440,6 +613,12 @@ static void sculpt_undo_restore(bContext *C, ListBase *lb)
 			}
 		}
 
+		if (unode->packed) {
+			if (sculpt_undo_restore_packed(C, dm, unode))
+				update = true;
+			continue;
+		}
+
 		switch (unode->type) {
 			case SCULPT_UNDO_COORDS:
 				if (sculpt_undo_restore_coords(C, dm, unode))
@@ -495,8 +674,14 @@ static void sculpt_undo_restore(bContext *C, ListBase *lb)
 			sculpt_update_object_bounding_box(ob);
 		}
 
-		/* for non-PBVH drawing, need to recreate VBOs */
-		GPU_drawobject_free(ob->derivedFinal);
+		/* for non-PBVH drawing, need to recreate VBOs (hiding changes what gets drawn) */
+		if (rebuild) {
+			GPU_drawobject_free(ob->derivedFinal);
+		}
+		else {
+			GPU_drawobject_tag_buffer_dirty(ob->derivedFinal, GPU_BUFFER_VERTEX);
+			GPU_drawobject_tag_buffer_dirty(ob->derivedFinal, GPU_BUFFER_NORMAL);
+		}
 	}
 }
 
@@ -527,6 +712,8 @@ static void sculpt_undo_free(ListBase *lb)
 		}
 		if (unode->mask)
 			MEM_freeN(unode->mask);
+		if (unode->packed)
+			MEM_freeN(unode->packed);
 
 		if (unode->bm_entry) {
 			BM_log_entry_drop(unode->bm_entry);
@@ -878,6 +1065,80 @@ SculptUndoNode *sculpt_undo_push_node(Object *ob, PBVHNode *node,
 	return unode;
 }
 
+typedef struct SculptUndoPackData {
+	SculptSession *ss;
+	SculptUndoNode **unodes;
+} SculptUndoPackData;
+
+static void sculpt_undo_pack_task_cb(void *userdata, void *UNUSED(userdata_chunk), int n)
+{
+	SculptUndoPackData *data = userdata;
+	SculptUndoNode *unode = data->unodes[n];
+	const int elem_len = sculpt_undo_packed_elem_len(unode);
+	float *values = MEM_mallocN(sizeof(float) * (size_t)(unode->totvert * elem_len), __func__);
+	PBVHVertexIter vd;
+
+	BKE_pbvh_vertex_iter_begin(data->ss->pbvh, unode->node, vd, PBVH_ITER_ALL)
+	{
+		/* same order as the node stored them in */
+		if (vd.i < unode->totvert) {
+			if (unode->type == SCULPT_UNDO_COORDS) copy_v3_v3(&values[vd.i * 3], vd.co);
+			else values[vd.i] = *vd.mask;
+		}
+	}
+	BKE_pbvh_vertex_iter_end;
+
+	sculpt_undo_pack(unode, values);
+
+	MEM_freeN(values);
+}
+
+/* Pack the coords and masks of the step, the buffers aren't read once it's done */
+static void sculpt_undo_pack_nodes(SculptSession *ss, ListBase *lb)
+{
+	SculptUndoNode **unodes;
+	SculptUndoNode *unode;
+	int totnode = 0, n;
+
+	for (unode = lb->first; unode; unode = unode->next) {
+		if (sculpt_undo_can_pack(ss, unode))
+			totnode++;
+	}
+
+	if (totnode == 0)
+		return;
+
+	unodes = MEM_mallocN(sizeof(*unodes) * totnode, __func__);
+	n = 0;
+	for (unode = lb->first; unode; unode = unode->next) {
+		if (sculpt_undo_can_pack(ss, unode))
+			unodes[n++] = unode;
+	}
+
+	{
+		SculptUndoPackData data = {.ss = ss, .unodes = unodes};
+
+		BLI_task_parallel_range_ex(
+		        0, totnode, &data, NULL, 0, sculpt_undo_pack_task_cb,
+		        totnode > 1, false);
+	}
+
+	for (n = 0; n < totnode; n++) {
+		unode = unodes[n];
+
+		if (unode->packed) {
+			float **data_p = (unode->type == SCULPT_UNDO_COORDS) ? (float **)&unode->co : &unode->mask;
+			const size_t size = MEM_allocN_len(*data_p);
+
+			MEM_freeN(*data_p);
+			*data_p = NULL;
+			undo_paint_push_count_alloc(UNDO_PAINT_MESH, -(int)(size - unode->packed_len));
+		}
+	}
+
+	MEM_freeN(unodes);
+}
+
 void sculpt_undo_push_begin(const char *name)
 {
 	ED_undo_paint_push_begin(UNDO_PAINT_MESH, name,
@@ -887,8 +1148,13 @@ void sculpt_undo_push_begin(const char *name)
 void sculpt_undo_push_end(const bContext *C)
 {
 	ListBase *lb = undo_paint_push_get_list(UNDO_PAINT_MESH);
+	Object *ob = CTX_data_active_object(C);
 	SculptUndoNode *unode;
 
+	if (ob && ob->sculpt && ob->sculpt->pbvh) {
+		sculpt_undo_pack_nodes(ob->sculpt, lb);
+	}
+
 	/* we don't need normals in the undo stack */
 	for (unode = lb->first; unode; unode = unode->next) {
 		if (unode->no) {
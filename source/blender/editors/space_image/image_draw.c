@@ -527,7 +527,9 @@ static void draw_image_buffer(const bContext *C, SpaceImage *sima, ARegion *ar,
 		}
 
 		if ((sima->flag & (SI_SHOW_R | SI_SHOW_G | SI_SHOW_B)) == 0) {
-			glaDrawImBuf_glsl_ctx(C, ibuf, x, y, GL_NEAREST);
+			/* zoomed in huge images only need the visible part to be uploaded and color managed */
+			glaDrawImBuf_glsl_ctx_clipping(C, ibuf, x, y, GL_NEAREST,
+			                               0.0f, 0.0f, ar->winx, ar->winy);
 		}
 		else {
 			unsigned char *display_buffer;
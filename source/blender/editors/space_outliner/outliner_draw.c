@@ -1432,6 +1432,9 @@ static void outliner_draw_tree_element(
 		int xmax = ar->v2d.cur.xmax;
 		unsigned char alpha = 128;
 		
+		/* the icon row and open/close icon need the contents */
+		outliner_tree_element_contents_ensure(soops, te);
+
 		if ((tselem->flag & TSE_TEXTBUT) && (*te_edit == NULL)) {
 			*te_edit = te;
 		}
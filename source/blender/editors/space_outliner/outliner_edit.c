@@ -403,6 +403,7 @@ static int outliner_count_levels(SpaceOops *soops, ListBase *lb, const int curle
 	
 	for (te = lb->first; te; te = te->next) {
 		
+		outliner_tree_element_contents_ensure(soops, te);
 		lev = outliner_count_levels(soops, &te->subtree, curlevel + 1);
 		if (lev > level) level = lev;
 	}
@@ -419,6 +420,7 @@ int outliner_has_one_flag(SpaceOops *soops, ListBase *lb, short flag, const int
 		tselem = TREESTORE(te);
 		if (tselem->flag & flag) return curlevel;
 		
+		outliner_tree_element_contents_ensure(soops, te);
 		level = outliner_has_one_flag(soops, &te->subtree, flag, curlevel + 1);
 		if (level) return level;
 	}
@@ -434,6 +436,7 @@ void outliner_set_flag(SpaceOops *soops, ListBase *lb, short flag, short set)
 		tselem = TREESTORE(te);
 		if (set == 0) tselem->flag &= ~flag;
 		else tselem->flag |= flag;
+		outliner_tree_element_contents_ensure(soops, te);
 		outliner_set_flag(soops, &te->subtree, flag, set);
 	}
 }
@@ -951,6 +954,7 @@ static void outliner_openclose_level(SpaceOops *soops, ListBase *lb, int curleve
 			if (curlevel >= level) tselem->flag |= TSE_CLOSED;
 		}
 		
+		outliner_tree_element_contents_ensure(soops, te);
 		outliner_openclose_level(soops, &te->subtree, curlevel + 1, level, open);
 	}
 }
@@ -67,6 +67,8 @@ typedef struct TreeElement {
 #define TE_ICONROW      2
 #define TE_LAZY_CLOSED  4
 #define TE_FREE_NAME    8
+/* object contents not built yet, see outliner_tree_element_contents_ensure() */
+#define TE_CONTENTS_DEFERRED  16
 
 /* button events */
 #define OL_NAMEBUTTON       1
@@ -134,6 +136,7 @@ TreeElement *outliner_find_id(struct SpaceOops *soops, ListBase *lb, struct ID *
 struct ID *outliner_search_back(SpaceOops *soops, TreeElement *te, short idcode);
 
 void outliner_build_tree(struct Main *mainvar, struct Scene *scene, struct SpaceOops *soops);
+void outliner_tree_element_contents_ensure(struct SpaceOops *soops, TreeElement *te);
 
 /* outliner_draw.c ---------------------------------------------- */
 
@@ -635,7 +635,12 @@ static void outliner_add_id_contents(SpaceOops *soops, TreeElement *te, TreeStor
 		}
 		case ID_OB:
 		{
-			outliner_add_object_contents(soops, te, tselem, (Object *)id);
+			/* collapsed objects only get their contents when they are drawn,
+			 * searching needs the full tree to filter on */
+			if (TSELEM_OPEN(tselem, soops) || SEARCHING_OUTLINER(soops))
+				outliner_add_object_contents(soops, te, tselem, (Object *)id);
+			else
+				te->flag |= TE_CONTENTS_DEFERRED;
 			break;
 		}
 		case ID_ME:
@@ -1492,6 +1497,24 @@ static void outliner_sort(SpaceOops *soops, ListBase *lb)
 	}
 }
 
+/* Build the contents of an object element whose building was deferred while it was collapsed,
+ * child objects added by the hierarchy stay after the contents, as in a full build */
+void outliner_tree_element_contents_ensure(SpaceOops *soops, TreeElement *te)
+{
+	if (te->flag & TE_CONTENTS_DEFERRED) {
+		TreeStoreElem *tselem = TREESTORE(te);
+		ListBase children = te->subtree;
+
+		te->flag &= ~TE_CONTENTS_DEFERRED;
+
+		BLI_listbase_clear(&te->subtree);
+		outliner_add_object_contents(soops, te, tselem, (Object *)tselem->id);
+		BLI_movelisttolist(&te->subtree, &children);
+
+		outliner_sort(soops, &te->subtree);
+	}
+}
+
 /* Filtering ----------------------------------------------- */
 
 static bool outliner_filter_has_name(TreeElement *te, const char *name, int flags)
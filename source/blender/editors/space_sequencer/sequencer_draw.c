@@ -208,6 +208,8 @@ static void drawseqwave(const bContext *C, SpaceSeq *sseq, Scene *scene, Sequenc
 		bSound *sound = seq->sound;
 		
 		SoundWaveform *waveform;
+		const float *data;
+		int level, data_length;
 		
 		if (!sound->spinlock) {
 			sound->spinlock = MEM_mallocN(sizeof(SpinLock), "sound_spinlock");
@@ -241,8 +243,16 @@ static void drawseqwave(const bContext *C, SpaceSeq *sseq, Scene *scene, Sequenc
 		endsample = ceil((seq->startofs + seq->anim_startofs + seq->enddisp - seq->startdisp) / FPS * SOUND_WAVE_SAMPLES_PER_SECOND);
 		samplestep = (endsample - startsample) * stepsize / (x2 - x1);
 
-		if (length > floor((waveform->length - startsample) / samplestep))
-			length = floor((waveform->length - startsample) / samplestep);
+		/* use a lower resolution when zoomed out, so each pixel only looks at a few samples */
+		for (level = 0; (level + 1 < waveform->levels) && (samplestep >= 4.0f); level++) {
+			startsample *= 0.5f;
+			samplestep *= 0.5f;
+		}
+		data = waveform->levels ? waveform->level_data[level] : waveform->data;
+		data_length = waveform->levels ? waveform->level_length[level] : waveform->length;
+
+		if (length > floor((data_length - startsample) / samplestep))
+			length = floor((data_length - startsample) / samplestep);
 
 		glColor4f(1.0f, 1.0f, 1.0f, 0.5);
 		glEnable(GL_BLEND);
@@ -251,23 +261,23 @@ static void drawseqwave(const bContext *C, SpaceSeq *sseq, Scene *scene, Sequenc
 			float sampleoffset = startsample + i * samplestep;
 			pos = sampleoffset;
 
-			value1 = waveform->data[pos * 3];
-			value2 = waveform->data[pos * 3 + 1];
+			value1 = data[pos * 3];
+			value2 = data[pos * 3 + 1];
 
 			if (samplestep > 1.0f) {
-				for (j = pos + 1; (j < waveform->length) && (j < pos + samplestep); j++) {
-					if (value1 > waveform->data[j * 3])
-						value1 = waveform->data[j * 3];
+				for (j = pos + 1; (j < data_length) && (j < pos + samplestep); j++) {
+					if (value1 > data[j * 3])
+						value1 = data[j * 3];
 
-					if (value2 < waveform->data[j * 3 + 1])
-						value2 = waveform->data[j * 3 + 1];
+					if (value2 < data[j * 3 + 1])
+						value2 = data[j * 3 + 1];
 				}
 			}
 			else {
 				/* use simple linear interpolation */
 				float f = sampleoffset - pos;
-				value1 = (1.0f - f) * value1 + f * waveform->data[pos * 3 + 3];
-				value2 = (1.0f - f) * value2 + f * waveform->data[pos * 3 + 4];
+				value1 = (1.0f - f) * value1 + f * data[pos * 3 + 3];
+				value2 = (1.0f - f) * value2 + f * data[pos * 3 + 4];
 			}
 
 			glVertex2f(x1 + i * stepsize, ymid + value1 * yscale);
@@ -1237,7 +1247,7 @@ void draw_image_seq(const bContext *C, Scene *scene, ARegion *ar, SpaceSeq *sseq
 	else {
 		bool force_fallback = false;
 
-		force_fallback |= (U.image_draw_method != IMAGE_DRAW_METHOD_GLSL);
+		force_fallback |= (glaImageDrawMethod() != IMAGE_DRAW_METHOD_GLSL);
 		force_fallback |= (ibuf->dither != 0.0f);
 
 		if (force_fallback) {
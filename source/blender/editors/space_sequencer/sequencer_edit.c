@@ -38,6 +38,8 @@
 #include "BLI_fileops.h"
 #include "BLI_ghash.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_timecode.h"
 #include "BLI_utildefines.h"
 
@@ -142,23 +144,103 @@ static void proxy_freejob(void *pjv)
 	MEM_freeN(pj);
 }
 
+typedef struct ProxyQueue {
+	SpinLock spin;
+	LinkData *link;
+	int done, tot;
+	short *stop;
+	short *do_update;
+	float *progress;
+} ProxyQueue;
+
+static struct SeqIndexBuildContext *proxy_queue_next(ProxyQueue *queue)
+{
+	struct SeqIndexBuildContext *context = NULL;
+
+	BLI_spin_lock(&queue->spin);
+	while (!*queue->stop && queue->link) {
+		struct SeqIndexBuildContext *link_context = queue->link->data;
+
+		queue->link = queue->link->next;
+
+		if (BKE_sequencer_proxy_rebuild_is_threadsafe(link_context)) {
+			context = link_context;
+			break;
+		}
+	}
+	BLI_spin_unlock(&queue->spin);
+
+	return context;
+}
+
+static void proxy_task_func(TaskPool * __restrict pool, void *UNUSED(taskdata), int UNUSED(threadid))
+{
+	ProxyQueue *queue = (ProxyQueue *)BLI_task_pool_userdata(pool);
+	struct SeqIndexBuildContext *context;
+
+	while ((context = proxy_queue_next(queue))) {
+		/* progress of a single movie isn't shown when several are built at once */
+		short do_update;
+		float progress;
+
+		BKE_sequencer_proxy_rebuild(context, queue->stop, &do_update, &progress);
+
+		BLI_spin_lock(&queue->spin);
+		queue->done++;
+		*queue->progress = (float)queue->done / (float)queue->tot;
+		*queue->do_update = true;
+		BLI_spin_unlock(&queue->spin);
+	}
+}
+
 /* only this runs inside thread */
 static void proxy_startjob(void *pjv, short *stop, short *do_update, float *progress)
 {
 	ProxyJob *pj = pjv;
+	TaskScheduler *task_scheduler = BLI_task_scheduler_get();
+	TaskPool *task_pool;
+	ProxyQueue queue;
 	LinkData *link;
+	int i, tot_thread = BLI_task_scheduler_num_threads(task_scheduler);
+
+	/* movies are decoded and encoded in parallel, one movie per thread */
+	BLI_spin_init(&queue.spin);
+	queue.link = pj->queue.first;
+	queue.done = 0;
+	queue.tot = 0;
+	queue.stop = stop;
+	queue.do_update = do_update;
+	queue.progress = progress;
 
 	for (link = pj->queue.first; link; link = link->next) {
+		if (BKE_sequencer_proxy_rebuild_is_threadsafe(link->data)) {
+			queue.tot++;
+		}
+	}
+
+	if (queue.tot) {
+		task_pool = BLI_task_pool_create(task_scheduler, &queue);
+		for (i = 0; i < min_ii(tot_thread, queue.tot); i++) {
+			BLI_task_pool_push(task_pool, proxy_task_func, NULL, false, TASK_PRIORITY_LOW);
+		}
+		BLI_task_pool_work_and_wait(task_pool);
+		BLI_task_pool_free(task_pool);
+	}
+
+	BLI_spin_end(&queue.spin);
+
+	for (link = pj->queue.first; link && !*stop; link = link->next) {
 		struct SeqIndexBuildContext *context = link->data;
 
-		BKE_sequencer_proxy_rebuild(context, stop, do_update, progress);
-		
-		if (*stop) {
-			pj->stop = 1;
-			fprintf(stderr,  "Canceling proxy rebuild on users request...\n");
-			break;
+		if (!BKE_sequencer_proxy_rebuild_is_threadsafe(context)) {
+			BKE_sequencer_proxy_rebuild(context, stop, do_update, progress);
 		}
 	}
+
+	if (*stop) {
+		pj->stop = 1;
+		fprintf(stderr,  "Canceling proxy rebuild on users request...\n");
+	}
 }
 
 static void proxy_endjob(void *pjv)
@@ -2093,7 +2093,7 @@ static void draw_dupli_objects_color(
 		savedlod = dob->ob->currentlod;
 
 #ifdef WITH_GAMEENGINE
-		if (rv3d->rflag & RV3D_IS_GAME_ENGINE) {
+		if (rv3d->rflag & RV3D_USE_LOD) {
 			BKE_object_lod_update(dob->ob, rv3d->viewinv[3]);
 		}
 #endif
@@ -3857,10 +3857,14 @@ static void view3d_main_region_draw_objects(const bContext *C, Scene *scene, Vie
 	else
 		view3d_main_region_setup_view(scene, v3d, ar, NULL, NULL);
 
-	rv3d->rflag &= ~RV3D_IS_GAME_ENGINE;
+	rv3d->rflag &= ~(RV3D_IS_GAME_ENGINE | RV3D_USE_LOD);
 #ifdef WITH_GAMEENGINE
 	if (STREQ(scene->r.engine, RE_engine_id_BLENDER_GAME)) {
 		rv3d->rflag |= RV3D_IS_GAME_ENGINE;
+	}
+
+	if ((rv3d->rflag & RV3D_IS_GAME_ENGINE) || (v3d->flag3 & V3D_SHOW_LOD)) {
+		rv3d->rflag |= RV3D_USE_LOD;
 
 		/* Make sure LoDs are up to date */
 		update_lods(scene, rv3d->viewinv[3]);
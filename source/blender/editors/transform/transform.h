@@ -97,6 +97,8 @@ typedef struct TransSnap {
 	void  (*targetSnap)(struct TransInfo *);
 	/* Get the transform distance between two points (used by Closest snap) */
 	float  (*distance)(struct TransInfo *, const float p1[3], const float p2[3]);
+	/* objects to snap to, gathered once per transform */
+	struct SnapObjectCache *object_cache;
 } TransSnap;
 
 typedef struct TransCon {
@@ -437,6 +439,8 @@ typedef struct TransInfo {
 	float       zfac;           /* use for 3d view */
 	struct Object *obedit;
 	float          obedit_mat[3][3]; /* normalized editmode matrix (T_EDIT only) */
+	struct BMVert **obedit_verts; /* edit-mesh vertices moved by the transform, to update their normals */
+	int            obedit_verts_len;
 	void		*draw_handle_apply;
 	void		*draw_handle_view;
 	void		*draw_handle_pixel;
@@ -660,6 +664,7 @@ void applyProject(TransInfo *t);
 void applyGridAbsolute(TransInfo *t);
 void applySnapping(TransInfo *t, float *vec);
 void resetSnapping(TransInfo *t);
+void freeSnapping(TransInfo *t);
 eRedrawFlag handleSnapping(TransInfo *t, const struct wmEvent *event);
 void drawSnapping(const struct bContext *C, TransInfo *t);
 bool usingSnappingNormal(TransInfo *t);
@@ -2442,6 +2442,10 @@ static void createTransEditVerts(TransInfo *t)
 		}
 	}
 
+	/* mirrored vertices are moved too */
+	t->obedit_verts = MEM_mallocN(sizeof(*t->obedit_verts) * t->total * (mirror ? 2 : 1), "TransObData verts");
+	t->obedit_verts_len = 0;
+
 	BM_ITER_MESH_INDEX (eve, &iter, bm, BM_VERTS_OF_MESH, a) {
 		if (!BM_elem_flag_test(eve, BM_ELEM_HIDDEN)) {
 			if (prop_mode || BM_elem_flag_test(eve, BM_ELEM_SELECT)) {
@@ -2498,8 +2502,10 @@ static void createTransEditVerts(TransInfo *t)
 					BMVert *vmir = EDBM_verts_mirror_get(em, eve); //t->obedit, em, eve, tob->iloc, a);
 					if (vmir && vmir != eve) {
 						tob->extra = vmir;
+						t->obedit_verts[t->obedit_verts_len++] = vmir;
 					}
 				}
+				t->obedit_verts[t->obedit_verts_len++] = eve;
 				tob++;
 			}
 		}
@@ -770,7 +770,12 @@ static void recalcData_objects(TransInfo *t)
 
 			DAG_id_tag_update(t->obedit->data, 0);  /* sets recalc flags */
 			
-			EDBM_mesh_normals_update(em);
+			if (t->obedit_verts) {
+				EDBM_mesh_normals_update_verts(em, t->obedit_verts, t->obedit_verts_len);
+			}
+			else {
+				EDBM_mesh_normals_update(em);
+			}
 			BKE_editmesh_tessface_calc(em);
 		}
 		else if (t->obedit->type == OB_ARMATURE) { /* no recalc flag, does pose */
@@ -1469,6 +1474,12 @@ void postTrans(bContext *C, TransInfo *t)
 	}
 	
 	BLI_freelistN(&t->tsnap.points);
+	freeSnapping(t);
+
+	if (t->obedit_verts) {
+		MEM_freeN(t->obedit_verts);
+		t->obedit_verts = NULL;
+	}
 
 	if (t->ext) MEM_freeN(t->ext);
 	if (t->data2d) {
@@ -115,6 +115,9 @@ static float ResizeBetween(TransInfo *t, const float p1[3], const float p2[3]);
 static bool snapNodeTest(View2D *v2d, bNode *node, SnapSelect snap_select);
 static NodeBorder snapNodeBorder(int snap_node_mode);
 
+typedef struct SnapObjectCache SnapObjectCache;
+static void snap_object_cache_free(SnapObjectCache *cache);
+
 #if 0
 int BIF_snappingSupported(Object *obedit)
 {
@@ -459,6 +462,14 @@ void applySnapping(TransInfo *t, float *vec)
 	}
 }
 
+void freeSnapping(TransInfo *t)
+{
+	if (t->tsnap.object_cache) {
+		snap_object_cache_free(t->tsnap.object_cache);
+		t->tsnap.object_cache = NULL;
+	}
+}
+
 void resetSnapping(TransInfo *t)
 {
 	t->tsnap.status = 0;
@@ -1977,41 +1988,16 @@ static bool snapObject(
 	return retval;
 }
 
-static bool snapObjectsRay(
-        Scene *scene, View3D *v3d, ARegion *ar, Base *base_act, Object *obedit,
-        const float mval[2], SnapSelect snap_select, const short snap_to,
-        const float ray_start[3], const float ray_normal[3], const float ray_origin[3], float *ray_depth,
-        /* return args */
-        float r_loc[3], float r_no[3], float *r_dist_px, int *r_index,
-        Object **r_ob, float r_obmat[4][4])
+typedef void (*SnapObjectCandidateFn)(
+        Object *ob, float obmat[4][4], bool use_obedit, void *userdata);
+
+/* Calls fn for all objects (and their duplis) that can be snapped to, besides the edit object
+ * and the active object in particle edit mode, which get their own exceptions. */
+static void snap_objects_foreach_candidate(
+        Scene *scene, View3D *v3d, Base *base_act, Object *obedit, SnapSelect snap_select,
+        SnapObjectCandidateFn fn, void *userdata)
 {
 	Base *base;
-	bool retval = false;
-
-	if (snap_select == SNAP_ALL && obedit) {
-		Object *ob = obedit;
-
-		retval |= snapObject(
-		        scene, ar, ob, ob->obmat, true,
-		        mval, snap_to,
-		        ray_start, ray_normal, ray_origin, ray_depth,
-		        r_loc, r_no, r_dist_px, r_index, r_ob, r_obmat);
-	}
-
-	/* Need an exception for particle edit because the base is flagged with BA_HAS_RECALC_DATA
-	 * which makes the loop skip it, even the derived mesh will never change
-	 *
-	 * To solve that problem, we do it first as an exception. 
-	 * */
-	base = base_act;
-	if (base && base->object && base->object->mode & OB_MODE_PARTICLE_EDIT) {
-		Object *ob = base->object;
-		retval |= snapObject(
-		        scene, ar, ob, ob->obmat, false,
-		        mval, snap_to,
-		        ray_start, ray_normal, ray_origin, ray_depth,
-		        r_loc, r_no, r_dist_px, r_index, r_ob, r_obmat);
-	}
 
 	for (base = FIRSTBASE; base != NULL; base = base->next) {
 		if ((BASE_VISIBLE_BGMODE(v3d, scene, base)) &&
@@ -2038,28 +2024,252 @@ static bool snapObjectsRay(
 					bool use_obedit_dupli = (obedit && dupli_ob->ob->data == obedit->data);
 					Object *dupli_snap = (use_obedit_dupli) ? obedit : dupli_ob->ob;
 
-					retval |= snapObject(
-					        scene, ar, dupli_snap, dupli_ob->mat, use_obedit_dupli,
-					        mval, snap_to,
-					        ray_start, ray_normal, ray_origin, ray_depth,
-					        r_loc, r_no, r_dist_px, r_index, r_ob, r_obmat);
+					fn(dupli_snap, dupli_ob->mat, use_obedit_dupli, userdata);
 				}
 				
 				free_object_duplilist(lb);
 			}
 
-			retval |= snapObject(
-			        scene, ar, ob_snap, ob->obmat, use_obedit,
-			        mval, snap_to,
-			        ray_start, ray_normal, ray_origin, ray_depth,
-			        r_loc, r_no, r_dist_px, r_index, r_ob, r_obmat);
+			fn(ob_snap, ob->obmat, use_obedit, userdata);
 		}
 	}
+}
+
+/* Objects that can be snapped to during one transform, gathered on first use. The objects
+ * which are not transformed don't move meanwhile, so their bounds go in a tree which the
+ * view ray picks the candidates from, instead of testing every object on each mouse move. */
+typedef struct SnapObjectCandidate {
+	Object *ob;
+	float obmat[4][4];
+	bool use_obedit;
+} SnapObjectCandidate;
+
+struct SnapObjectCache {
+	SnapSelect snap_select;
+	SnapObjectCandidate *candidates;
+	int candidates_len, candidates_alloc;
+	/* world space bounds of the first tree_len candidates (meshes),
+	 * the others have no bounds test of their own and are always tried */
+	BVHTree *tree;
+	int tree_len;
+};
+
+/* Bounds of a mesh candidate in world space, as least as large as the ones snapDerivedMesh() tests. */
+static bool snap_object_cache_candidate_bounds(const SnapObjectCandidate *cand, float r_co[8][3])
+{
+	BoundBox *bb, bb_temp, bb_scaled;
+	int i;
+
+	if (cand->ob->type != OB_MESH || cand->use_obedit) {
+		return false;
+	}
+
+	bb = BKE_object_boundbox_get(cand->ob);
+	if (bb == NULL) {
+		return false;
+	}
+
+	bb = BKE_boundbox_ensure_minimum_dimensions(bb, &bb_temp, 1e-1f);
+	BKE_boundbox_scale(&bb_scaled, bb, 1.0f + 1e-1f);
+
+	for (i = 0; i < 8; i++) {
+		mul_v3_m4v3(r_co[i], (float (*)[4])cand->obmat, bb_scaled.vec[i]);
+	}
+
+	return true;
+}
+
+static void snap_object_cache_add_cb(Object *ob, float obmat[4][4], bool use_obedit, void *userdata)
+{
+	SnapObjectCache *cache = userdata;
+	SnapObjectCandidate *cand;
+
+	if (!ELEM(ob->type, OB_MESH, OB_ARMATURE, OB_CURVE, OB_EMPTY, OB_CAMERA)) {
+		return;
+	}
+
+	if (cache->candidates_len == cache->candidates_alloc) {
+		cache->candidates_alloc = max_ii(cache->candidates_alloc * 2, 64);
+		cache->candidates = MEM_reallocN(cache->candidates, sizeof(*cache->candidates) * cache->candidates_alloc);
+	}
+
+	cand = &cache->candidates[cache->candidates_len++];
+	cand->ob = ob;
+	copy_m4_m4(cand->obmat, obmat);
+	cand->use_obedit = use_obedit;
+}
+
+static void snap_object_cache_free(SnapObjectCache *cache)
+{
+	if (cache->tree) {
+		BLI_bvhtree_free(cache->tree);
+	}
+	MEM_SAFE_FREE(cache->candidates);
+	MEM_freeN(cache);
+}
+
+static SnapObjectCache *snap_object_cache_create(
+        Scene *scene, View3D *v3d, Base *base_act, Object *obedit, SnapSelect snap_select)
+{
+	SnapObjectCache *cache = MEM_callocN(sizeof(*cache), __func__);
+	SnapObjectCandidate *candidates_sorted;
+	float (*bounds)[8][3];
+	bool *in_tree;
+	int i, i_tree, i_other;
+
+	cache->snap_select = snap_select;
+
+	snap_objects_foreach_candidate(scene, v3d, base_act, obedit, snap_select, snap_object_cache_add_cb, cache);
+
+	if (cache->candidates_len == 0) {
+		return cache;
+	}
+
+	/* order candidates with bounds first, keeping their order otherwise */
+	bounds = MEM_mallocN(sizeof(*bounds) * cache->candidates_len, __func__);
+	in_tree = MEM_mallocN(sizeof(*in_tree) * cache->candidates_len, __func__);
+	candidates_sorted = MEM_mallocN(sizeof(*candidates_sorted) * cache->candidates_len, __func__);
+
+	for (i = 0, i_tree = 0; i < cache->candidates_len; i++) {
+		in_tree[i] = snap_object_cache_candidate_bounds(&cache->candidates[i], bounds[i_tree]);
+		if (in_tree[i]) {
+			candidates_sorted[i_tree++] = cache->candidates[i];
+		}
+	}
+	for (i = 0, i_other = i_tree; i < cache->candidates_len; i++) {
+		if (!in_tree[i]) {
+			candidates_sorted[i_other++] = cache->candidates[i];
+		}
+	}
+
+	MEM_freeN(in_tree);
+	MEM_freeN(cache->candidates);
+	cache->candidates = candidates_sorted;
+	cache->candidates_alloc = cache->candidates_len;
+	cache->tree_len = i_tree;
+
+	if (cache->tree_len) {
+		cache->tree = BLI_bvhtree_new(cache->tree_len, 0.0f, 4, 6);
+		for (i = 0; i < cache->tree_len; i++) {
+			BLI_bvhtree_insert(cache->tree, i, &bounds[i][0][0], 8);
+		}
+		BLI_bvhtree_balance(cache->tree);
+	}
+
+	MEM_freeN(bounds);
+
+	return cache;
+}
+
+/* Arguments shared by all objects snapped to for one ray. */
+typedef struct SnapObjectsRayData {
+	Scene *scene;
+	ARegion *ar;
+	const float *mval;
+	short snap_to;
+	const float *ray_start, *ray_normal, *ray_origin;
+	float *ray_depth;
+
+	float *r_loc, *r_no, *r_dist_px;
+	int *r_index;
+	Object **r_ob;
+	float (*r_obmat)[4];
+
+	bool retval;
+} SnapObjectsRayData;
+
+static void snap_objects_ray_candidate_cb(Object *ob, float obmat[4][4], bool use_obedit, void *userdata)
+{
+	SnapObjectsRayData *data = userdata;
+
+	data->retval |= snapObject(
+	        data->scene, data->ar, ob, obmat, use_obedit,
+	        data->mval, data->snap_to,
+	        data->ray_start, data->ray_normal, data->ray_origin, data->ray_depth,
+	        data->r_loc, data->r_no, data->r_dist_px, data->r_index, data->r_ob, data->r_obmat);
+}
+
+typedef struct SnapObjectsRayTreeData {
+	SnapObjectsRayData *data;
+	SnapObjectCache *cache;
+} SnapObjectsRayTreeData;
+
+static void snap_objects_ray_tree_cb(
+        void *userdata, int index, const BVHTreeRay *UNUSED(ray), BVHTreeRayHit *UNUSED(hit))
+{
+	SnapObjectsRayTreeData *tree_data = userdata;
+	SnapObjectCandidate *cand = &tree_data->cache->candidates[index];
+
+	snap_objects_ray_candidate_cb(cand->ob, cand->obmat, cand->use_obedit, tree_data->data);
+}
+
+static bool snapObjectsRay(
+        Scene *scene, View3D *v3d, ARegion *ar, Base *base_act, Object *obedit, SnapObjectCache *cache,
+        const float mval[2], SnapSelect snap_select, const short snap_to,
+        const float ray_start[3], const float ray_normal[3], const float ray_origin[3], float *ray_depth,
+        /* return args */
+        float r_loc[3], float r_no[3], float *r_dist_px, int *r_index,
+        Object **r_ob, float r_obmat[4][4])
+{
+	SnapObjectsRayData data;
+	Base *base;
+
+	data.scene = scene;
+	data.ar = ar;
+	data.mval = mval;
+	data.snap_to = snap_to;
+	data.ray_start = ray_start;
+	data.ray_normal = ray_normal;
+	data.ray_origin = ray_origin;
+	data.ray_depth = ray_depth;
+	data.r_loc = r_loc;
+	data.r_no = r_no;
+	data.r_dist_px = r_dist_px;
+	data.r_index = r_index;
+	data.r_ob = r_ob;
+	data.r_obmat = r_obmat;
+	data.retval = false;
+
+	if (snap_select == SNAP_ALL && obedit) {
+		snap_objects_ray_candidate_cb(obedit, obedit->obmat, true, &data);
+	}
+
+	/* Need an exception for particle edit because the base is flagged with BA_HAS_RECALC_DATA
+	 * which makes the loop skip it, even the derived mesh will never change
+	 *
+	 * To solve that problem, we do it first as an exception. 
+	 * */
+	base = base_act;
+	if (base && base->object && base->object->mode & OB_MODE_PARTICLE_EDIT) {
+		snap_objects_ray_candidate_cb(base->object, base->object->obmat, false, &data);
+	}
+
+	if (cache) {
+		SnapObjectCandidate *cand;
+		int i;
+
+		BLI_assert(cache->snap_select == snap_select);
+
+		if (cache->tree) {
+			SnapObjectsRayTreeData tree_data = {&data, cache};
+
+			BLI_bvhtree_ray_cast_all(cache->tree, ray_start, ray_normal, 0.0f,
+			                         snap_objects_ray_tree_cb, &tree_data);
+		}
+
+		for (i = cache->tree_len, cand = &cache->candidates[i]; i < cache->candidates_len; i++, cand++) {
+			snap_objects_ray_candidate_cb(cand->ob, cand->obmat, cand->use_obedit, &data);
+		}
+	}
+	else {
+		snap_objects_foreach_candidate(scene, v3d, base_act, obedit, snap_select,
+		                               snap_objects_ray_candidate_cb, &data);
+	}
 	
-	return retval;
+	return data.retval;
 }
 static bool snapObjects(
-        Scene *scene, View3D *v3d, ARegion *ar, Base *base_act, Object *obedit,
+        Scene *scene, View3D *v3d, ARegion *ar, Base *base_act, Object *obedit, SnapObjectCache *cache,
         const float mval[2], SnapSelect snap_select, const short snap_to,
         float *ray_depth,
         float r_loc[3], float r_no[3], float *r_dist_px, int *r_index)
@@ -2071,7 +2281,7 @@ static bool snapObjects(
 	}
 
 	return snapObjectsRay(
-	        scene, v3d, ar, base_act, obedit,
+	        scene, v3d, ar, base_act, obedit, cache,
 	        mval, snap_select, snap_to,
 	        ray_start, ray_normal, ray_orgigin, ray_depth,
 	        r_loc, r_no, r_dist_px, r_index, NULL, NULL);
@@ -2093,8 +2303,16 @@ bool snapObjectsTransform(
 		base_act = t->scene->basact;
 	}
 
+	if (t->tsnap.object_cache && t->tsnap.object_cache->snap_select != snap_select) {
+		snap_object_cache_free(t->tsnap.object_cache);
+		t->tsnap.object_cache = NULL;
+	}
+	if (t->tsnap.object_cache == NULL) {
+		t->tsnap.object_cache = snap_object_cache_create(t->scene, t->view, base_act, obedit, snap_select);
+	}
+
 	return snapObjects(
-	        t->scene, t->view, t->ar, base_act, obedit,
+	        t->scene, t->view, t->ar, base_act, obedit, t->tsnap.object_cache,
 	        mval, snap_select, t->scene->toolsettings->snap_mode,
 	        &ray_dist,
 	        r_loc, r_no, r_dist_px, NULL);
@@ -2112,7 +2330,7 @@ bool snapObjectsContext(
 	float ray_dist = TRANSFORM_DIST_MAX_RAY;
 
 	return snapObjects(
-	        scene, v3d, ar, scene->basact, obedit,
+	        scene, v3d, ar, scene->basact, obedit, NULL,
 	        mval, snap_select, scene->toolsettings->snap_mode,
 	        &ray_dist,
 	        r_loc, r_no, r_dist_px, NULL);
@@ -2125,7 +2343,7 @@ bool snapObjectsEx(
         float r_loc[3], float r_no[3], float *r_dist_px)
 {
 	return snapObjects(
-	        scene, v3d, ar, base_act, obedit,
+	        scene, v3d, ar, base_act, obedit, NULL,
 	        mval, snap_select, snap_to,
 	        ray_depth,
 	        r_loc, r_no, r_dist_px, NULL);
@@ -2138,7 +2356,7 @@ bool snapObjectsRayEx(
         Object **r_ob, float r_obmat[4][4])
 {
 	return snapObjectsRay(
-	        scene, v3d, ar, base_act, obedit,
+	        scene, v3d, ar, base_act, obedit, NULL,
 	        mval, snap_select, snap_to,
 	        ray_start, ray_normal, ray_start, ray_depth,
 	        r_loc, r_no, r_dist_px, r_index,
@@ -45,6 +45,7 @@
 #include "../winged_edge/WFillGrid.h"
 
 #include "BKE_global.h"
+#include "BLI_task.h"
 
 namespace Freestyle {
 
@@ -396,6 +397,24 @@ static int computeVisibility(ViewMap *viewMap, FEdge *fe, G& grid, real epsilon,
 	return qi;
 }
 
+// The ViewEdges only read the grid and write their own data, so their visibility is
+// computed in parallel, in batches so that progress and cancel are still handled from this thread.
+template <typename G>
+struct ViewEdgeVisibilityData {
+	ViewMap *viewMap;
+	vector<ViewEdge*> *vedges;
+	G *grid;
+	real epsilon;
+	unsigned start;
+};
+
+template <typename G, void (*computeEdge)(ViewMap *, ViewEdge *, G&, real)>
+static void computeVisibilityTask(void *userdata, void * /*userdata_chunk*/, int i)
+{
+	ViewEdgeVisibilityData<G> *data = (ViewEdgeVisibilityData<G> *)userdata;
+	computeEdge(data->viewMap, (*data->vedges)[data->start + i], *data->grid, data->epsilon);
+}
+
 // computeCumulativeVisibility returns the lowest x such that the majority of FEdges have QI <= x
 //
 // This was probably the original intention of the "normal" algorithm on which computeDetailedVisibility is based.
@@ -405,196 +424,202 @@ static int computeVisibility(ViewMap *viewMap, FEdge *fe, G& grid, real epsilon,
 // 6 occluders have QI <= 22.
 
 template <typename G, typename I>
-static void computeCumulativeVisibility(ViewMap *ioViewMap, G& grid, real epsilon, RenderMonitor *iRenderMonitor)
+static void computeCumulativeVisibilityEdge(ViewMap *ioViewMap, ViewEdge *ve, G& grid, real epsilon)
 {
-	vector<ViewEdge*>& vedges = ioViewMap->ViewEdges();
-
 	FEdge *fe, *festart;
 	int nSamples = 0;
 	vector<WFace*> wFaces;
 	WFace *wFace = NULL;
-	unsigned cnt = 0;
-	unsigned cntStep = (unsigned)ceil(0.01f * vedges.size());
 	unsigned tmpQI = 0;
 	unsigned qiClasses[256];
 	unsigned maxIndex, maxCard;
 	unsigned qiMajority;
-	for (vector<ViewEdge*>::iterator ve = vedges.begin(), veend = vedges.end(); ve != veend; ve++) {
-		if (iRenderMonitor) {
-			if (iRenderMonitor->testBreak())
-				break;
-			if (cnt % cntStep == 0) {
-				stringstream ss;
-				ss << "Freestyle: Visibility computations " << (100 * cnt / vedges.size()) << "%";
-				iRenderMonitor->setInfo(ss.str());
-				iRenderMonitor->progress((float)cnt / vedges.size());
-			}
-			cnt++;
-		}
+
+#if LOGGING
+	if (_global.debug & G_DEBUG_FREESTYLE) {
+		cout << "Processing ViewEdge " << ve->getId() << endl;
+	}
+#endif
+	// Find an edge to test
+	if (!ve->isInImage()) {
+		// This view edge has been proscenium culled
+		ve->setQI(255);
+		ve->setaShape(0);
 #if LOGGING
 		if (_global.debug & G_DEBUG_FREESTYLE) {
-			cout << "Processing ViewEdge " << (*ve)->getId() << endl;
+			cout << "\tCulled." << endl;
 		}
 #endif
-		// Find an edge to test
-		if (!(*ve)->isInImage()) {
-			// This view edge has been proscenium culled
-			(*ve)->setQI(255);
-			(*ve)->setaShape(0);
+		return;
+	}
+
+	// Test edge
+	festart = ve->fedgeA();
+	fe = ve->fedgeA();
+	qiMajority = 0;
+	do {
+		if (fe != NULL && fe->isInImage()) {
+			qiMajority++;
+		}
+		fe = fe->nextEdge();
+	} while (fe && fe != festart);
+
+	if (qiMajority == 0) {
+		// There are no occludable FEdges on this ViewEdge
+		// This should be impossible.
+		if (_global.debug & G_DEBUG_FREESTYLE) {
+			cout << "View Edge in viewport without occludable FEdges: " << ve->getId() << endl;
+		}
+		// We can recover from this error:
+		// Treat this edge as fully visible with no occludee
+		ve->setQI(0);
+		ve->setaShape(0);
+		return;
+	}
+	else {
+		++qiMajority;
+		qiMajority >>= 1;
+	}
 #if LOGGING
-			if (_global.debug & G_DEBUG_FREESTYLE) {
-				cout << "\tCulled." << endl;
-			}
+	if (_global.debug & G_DEBUG_FREESTYLE) {
+		cout << "\tqiMajority: " << qiMajority << endl;
+	}
 #endif
-			continue;
-		}
 
-		// Test edge
-		festart = (*ve)->fedgeA();
-		fe = (*ve)->fedgeA();
-		qiMajority = 0;
-		do {
-			if (fe != NULL && fe->isInImage()) {
-				qiMajority++;
-			}
-			fe = fe->nextEdge();
-		} while (fe && fe != festart);
+	tmpQI = 0;
+	maxIndex = 0;
+	maxCard = 0;
+	nSamples = 0;
+	memset(qiClasses, 0, 256 * sizeof(*qiClasses));
+	set<ViewShape*> foundOccluders;
 
-		if (qiMajority == 0) {
-			// There are no occludable FEdges on this ViewEdge
-			// This should be impossible.
-			if (_global.debug & G_DEBUG_FREESTYLE) {
-				cout << "View Edge in viewport without occludable FEdges: " << (*ve)->getId() << endl;
-			}
-			// We can recover from this error:
-			// Treat this edge as fully visible with no occludee
-			(*ve)->setQI(0);
-			(*ve)->setaShape(0);
+	fe = ve->fedgeA();
+	do {
+		if (!fe || !fe->isInImage()) {
+			fe = fe->nextEdge();
 			continue;
 		}
-		else {
-			++qiMajority;
-			qiMajority >>= 1;
-		}
+		if ((maxCard < qiMajority)) {
+			//ARB: change &wFace to wFace and use reference in called function
+			tmpQI = computeVisibility<G, I>(ioViewMap, fe, grid, epsilon, ve, &wFace, &foundOccluders);
 #if LOGGING
-		if (_global.debug & G_DEBUG_FREESTYLE) {
-			cout << "\tqiMajority: " << qiMajority << endl;
-		}
+			if (_global.debug & G_DEBUG_FREESTYLE) {
+				cout << "\tFEdge: visibility " << tmpQI << endl;
+			}
 #endif
 
-		tmpQI = 0;
-		maxIndex = 0;
-		maxCard = 0;
-		nSamples = 0;
-		memset(qiClasses, 0, 256 * sizeof(*qiClasses));
-		set<ViewShape*> foundOccluders;
+			//ARB: This is an error condition, not an alert condition.
+			// Some sort of recovery or abort is necessary.
+			if (tmpQI >= 256) {
+				cerr << "Warning: too many occluding levels" << endl;
+				//ARB: Wild guess: instead of aborting or corrupting memory, treat as tmpQI == 255
+				tmpQI = 255;
+			}
 
-		fe = (*ve)->fedgeA();
-		do {
-			if (!fe || !fe->isInImage()) {
-				fe = fe->nextEdge();
-				continue;
+			if (++qiClasses[tmpQI] > maxCard) {
+				maxCard = qiClasses[tmpQI];
+				maxIndex = tmpQI;
 			}
-			if ((maxCard < qiMajority)) {
-				//ARB: change &wFace to wFace and use reference in called function
-				tmpQI = computeVisibility<G, I>(ioViewMap, fe, grid, epsilon, *ve, &wFace, &foundOccluders);
+		}
+		else {
+			//ARB: FindOccludee is redundant if ComputeRayCastingVisibility has been called
+			//ARB: change &wFace to wFace and use reference in called function
+			findOccludee<G, I>(fe, grid, epsilon, ve, &wFace);
 #if LOGGING
-				if (_global.debug & G_DEBUG_FREESTYLE) {
-					cout << "\tFEdge: visibility " << tmpQI << endl;
-				}
+			if (_global.debug & G_DEBUG_FREESTYLE) {
+				cout << "\tFEdge: occludee only (" << (wFace != NULL ? "found" : "not found") << ")" << endl;
+			}
 #endif
+		}
 
-				//ARB: This is an error condition, not an alert condition.
-				// Some sort of recovery or abort is necessary.
-				if (tmpQI >= 256) {
-					cerr << "Warning: too many occluding levels" << endl;
-					//ARB: Wild guess: instead of aborting or corrupting memory, treat as tmpQI == 255
-					tmpQI = 255;
-				}
-
-				if (++qiClasses[tmpQI] > maxCard) {
-					maxCard = qiClasses[tmpQI];
-					maxIndex = tmpQI;
-				}
+		// Store test results
+		if (wFace) {
+			vector<Vec3r> vertices;
+			for (int i = 0, numEdges = wFace->numberOfEdges(); i < numEdges; ++i) {
+				vertices.push_back(Vec3r(wFace->GetVertex(i)->GetVertex()));
 			}
-			else {
-				//ARB: FindOccludee is redundant if ComputeRayCastingVisibility has been called
-				//ARB: change &wFace to wFace and use reference in called function
-				findOccludee<G, I>(fe, grid, epsilon, *ve, &wFace);
+			Polygon3r poly(vertices, wFace->GetNormal());
+			poly.userdata = (void *)wFace;
+			fe->setaFace(poly);
+			wFaces.push_back(wFace);
+			fe->setOccludeeEmpty(false);
 #if LOGGING
-				if (_global.debug & G_DEBUG_FREESTYLE) {
-					cout << "\tFEdge: occludee only (" << (wFace != NULL ? "found" : "not found") << ")" << endl;
-				}
-#endif
+			if (_global.debug & G_DEBUG_FREESTYLE) {
+				cout << "\tFound occludee" << endl;
 			}
-
-			// Store test results
-			if (wFace) {
-				vector<Vec3r> vertices;
-				for (int i = 0, numEdges = wFace->numberOfEdges(); i < numEdges; ++i) {
-					vertices.push_back(Vec3r(wFace->GetVertex(i)->GetVertex()));
-				}
-				Polygon3r poly(vertices, wFace->GetNormal());
-				poly.userdata = (void *)wFace;
-				fe->setaFace(poly);
-				wFaces.push_back(wFace);
-				fe->setOccludeeEmpty(false);
-#if LOGGING
-				if (_global.debug & G_DEBUG_FREESTYLE) {
-					cout << "\tFound occludee" << endl;
-				}
 #endif
-			}
-			else {
-				fe->setOccludeeEmpty(true);
-			}
+		}
+		else {
+			fe->setOccludeeEmpty(true);
+		}
 
-			++nSamples;
-			fe = fe->nextEdge();
-		} while ((maxCard < qiMajority) && (fe) && (fe != festart));
+		++nSamples;
+		fe = fe->nextEdge();
+	} while ((maxCard < qiMajority) && (fe) && (fe != festart));
 
 #if LOGGING
-		if (_global.debug & G_DEBUG_FREESTYLE) {
-			cout << "\tFinished with " << nSamples << " samples, maxCard = " << maxCard << endl;
-		}
+	if (_global.debug & G_DEBUG_FREESTYLE) {
+		cout << "\tFinished with " << nSamples << " samples, maxCard = " << maxCard << endl;
+	}
 #endif
 
-		// ViewEdge
-		// qi --
-		// Find the minimum value that is >= the majority of the QI
-		for (unsigned count = 0, i = 0; i < 256; ++i) {
-			count += qiClasses[i];
-			if (count >= qiMajority) {
-				(*ve)->setQI(i);
-				break;
-			}
-		}
-		// occluders --
-		// I would rather not have to go through the effort of creating this set and then copying out its contents.
-		// Is there a reason why ViewEdge::_Occluders cannot be converted to a set<>?
-		for (set<ViewShape*>::iterator o = foundOccluders.begin(), oend = foundOccluders.end(); o != oend; ++o) {
-			(*ve)->AddOccluder((*o));
+	// ViewEdge
+	// qi --
+	// Find the minimum value that is >= the majority of the QI
+	for (unsigned count = 0, i = 0; i < 256; ++i) {
+		count += qiClasses[i];
+		if (count >= qiMajority) {
+			ve->setQI(i);
+			break;
 		}
+	}
+	// occluders --
+	// I would rather not have to go through the effort of creating this set and then copying out its contents.
+	// Is there a reason why ViewEdge::_Occluders cannot be converted to a set<>?
+	for (set<ViewShape*>::iterator o = foundOccluders.begin(), oend = foundOccluders.end(); o != oend; ++o) {
+		ve->AddOccluder((*o));
+	}
 #if LOGGING
-		if (_global.debug & G_DEBUG_FREESTYLE) {
-			cout << "\tConclusion: QI = " << maxIndex << ", " << (*ve)->occluders_size() << " occluders." << endl;
-		}
+	if (_global.debug & G_DEBUG_FREESTYLE) {
+		cout << "\tConclusion: QI = " << maxIndex << ", " << ve->occluders_size() << " occluders." << endl;
+	}
 #else
-		(void)maxIndex;
+	(void)maxIndex;
 #endif
-		// occludee --
-		if (!wFaces.empty()) {
-			if (wFaces.size() <= (float)nSamples / 2.0f) {
-				(*ve)->setaShape(0);
-			}
-			else {
-				ViewShape *vshape = ioViewMap->viewShape((*wFaces.begin())->GetVertex(0)->shape()->GetId());
-				(*ve)->setaShape(vshape);
-			}
+	// occludee --
+	if (!wFaces.empty()) {
+		if (wFaces.size() <= (float)nSamples / 2.0f) {
+			ve->setaShape(0);
+		}
+		else {
+			ViewShape *vshape = ioViewMap->viewShape((*wFaces.begin())->GetVertex(0)->shape()->GetId());
+			ve->setaShape(vshape);
 		}
+	}
+}
 
-		wFaces.clear();
+template <typename G, typename I>
+static void computeCumulativeVisibility(ViewMap *ioViewMap, G& grid, real epsilon, RenderMonitor *iRenderMonitor)
+{
+	vector<ViewEdge*>& vedges = ioViewMap->ViewEdges();
+	ViewEdgeVisibilityData<G> data = {ioViewMap, &vedges, &grid, epsilon, 0};
+
+	unsigned cnt = 0;
+	unsigned cntStep = (unsigned)ceil(0.01f * vedges.size());
+	for (; cnt < vedges.size(); cnt += cntStep) {
+		if (iRenderMonitor) {
+			if (iRenderMonitor->testBreak())
+				break;
+			stringstream ss;
+			ss << "Freestyle: Visibility computations " << (100 * cnt / vedges.size()) << "%";
+			iRenderMonitor->setInfo(ss.str());
+			iRenderMonitor->progress((float)cnt / vedges.size());
+		}
+		data.start = cnt;
+		BLI_task_parallel_range_ex(0, (int)min(cntStep, (unsigned)vedges.size() - cnt), &data, NULL, 0,
+		                           computeVisibilityTask<G, computeCumulativeVisibilityEdge<G, I> >, true, true);
 	}
+	cnt = min(cnt, (unsigned)vedges.size());
 	if (iRenderMonitor && vedges.size()) {
 		stringstream ss;
 		ss << "Freestyle: Visibility computations " << (100 * cnt / vedges.size()) << "%";
@@ -604,10 +629,8 @@ static void computeCumulativeVisibility(ViewMap *ioViewMap, G& grid, real epsilo
 }
 
 template <typename G, typename I>
-static void computeDetailedVisibility(ViewMap *ioViewMap, G& grid, real epsilon, RenderMonitor *iRenderMonitor)
+static void computeDetailedVisibilityEdge(ViewMap *ioViewMap, ViewEdge *ve, G& grid, real epsilon)
 {
-	vector<ViewEdge*>& vedges = ioViewMap->ViewEdges();
-
 	FEdge *fe, *festart;
 	int nSamples = 0;
 	vector<WFace*> wFaces;
@@ -616,163 +639,174 @@ static void computeDetailedVisibility(ViewMap *ioViewMap, G& grid, real epsilon,
 	unsigned qiClasses[256];
 	unsigned maxIndex, maxCard;
 	unsigned qiMajority;
-	for (vector<ViewEdge*>::iterator ve = vedges.begin(), veend = vedges.end(); ve != veend; ve++) {
-		if (iRenderMonitor && iRenderMonitor->testBreak())
-			break;
+
+#if LOGGING
+	if (_global.debug & G_DEBUG_FREESTYLE) {
+		cout << "Processing ViewEdge " << ve->getId() << endl;
+	}
+#endif
+	// Find an edge to test
+	if (!ve->isInImage()) {
+		// This view edge has been proscenium culled
+		ve->setQI(255);
+		ve->setaShape(0);
 #if LOGGING
 		if (_global.debug & G_DEBUG_FREESTYLE) {
-			cout << "Processing ViewEdge " << (*ve)->getId() << endl;
+			cout << "\tCulled." << endl;
 		}
 #endif
-		// Find an edge to test
-		if (!(*ve)->isInImage()) {
-			// This view edge has been proscenium culled
-			(*ve)->setQI(255);
-			(*ve)->setaShape(0);
+		return;
+	}
+
+	// Test edge
+	festart = ve->fedgeA();
+	fe = ve->fedgeA();
+	qiMajority = 0;
+	do {
+		if (fe != NULL && fe->isInImage()) {
+			qiMajority++;
+		}
+		fe = fe->nextEdge();
+	} while (fe && fe != festart);
+
+	if (qiMajority == 0) {
+		// There are no occludable FEdges on this ViewEdge
+		// This should be impossible.
+		if (_global.debug & G_DEBUG_FREESTYLE) {
+			cout << "View Edge in viewport without occludable FEdges: " << ve->getId() << endl;
+		}
+		// We can recover from this error:
+		// Treat this edge as fully visible with no occludee
+		ve->setQI(0);
+		ve->setaShape(0);
+		return;
+	}
+	else {
+		++qiMajority;
+		qiMajority >>= 1;
+	}
 #if LOGGING
-			if (_global.debug & G_DEBUG_FREESTYLE) {
-				cout << "\tCulled." << endl;
-			}
+	if (_global.debug & G_DEBUG_FREESTYLE) {
+		cout << "\tqiMajority: " << qiMajority << endl;
+	}
 #endif
-			continue;
-		}
 
-		// Test edge
-		festart = (*ve)->fedgeA();
-		fe = (*ve)->fedgeA();
-		qiMajority = 0;
-		do {
-			if (fe != NULL && fe->isInImage()) {
-				qiMajority++;
-			}
-			fe = fe->nextEdge();
-		} while (fe && fe != festart);
+	tmpQI = 0;
+	maxIndex = 0;
+	maxCard = 0;
+	nSamples = 0;
+	memset(qiClasses, 0, 256 * sizeof(*qiClasses));
+	set<ViewShape*> foundOccluders;
 
-		if (qiMajority == 0) {
-			// There are no occludable FEdges on this ViewEdge
-			// This should be impossible.
-			if (_global.debug & G_DEBUG_FREESTYLE) {
-				cout << "View Edge in viewport without occludable FEdges: " << (*ve)->getId() << endl;
-			}
-			// We can recover from this error:
-			// Treat this edge as fully visible with no occludee
-			(*ve)->setQI(0);
-			(*ve)->setaShape(0);
+	fe = ve->fedgeA();
+	do {
+		if (fe == NULL || ! fe->isInImage()) {
+			fe = fe->nextEdge();
 			continue;
 		}
-		else {
-			++qiMajority;
-			qiMajority >>= 1;
-		}
+		if ((maxCard < qiMajority)) {
+			//ARB: change &wFace to wFace and use reference in called function
+			tmpQI = computeVisibility<G, I>(ioViewMap, fe, grid, epsilon, ve, &wFace, &foundOccluders);
 #if LOGGING
-		if (_global.debug & G_DEBUG_FREESTYLE) {
-			cout << "\tqiMajority: " << qiMajority << endl;
-		}
+			if (_global.debug & G_DEBUG_FREESTYLE) {
+				cout << "\tFEdge: visibility " << tmpQI << endl;
+			}
 #endif
 
-		tmpQI = 0;
-		maxIndex = 0;
-		maxCard = 0;
-		nSamples = 0;
-		memset(qiClasses, 0, 256 * sizeof(*qiClasses));
-		set<ViewShape*> foundOccluders;
+			//ARB: This is an error condition, not an alert condition.
+			// Some sort of recovery or abort is necessary.
+			if (tmpQI >= 256) {
+				cerr << "Warning: too many occluding levels" << endl;
+				//ARB: Wild guess: instead of aborting or corrupting memory, treat as tmpQI == 255
+				tmpQI = 255;
+			}
 
-		fe = (*ve)->fedgeA();
-		do {
-			if (fe == NULL || ! fe->isInImage()) {
-				fe = fe->nextEdge();
-				continue;
+			if (++qiClasses[tmpQI] > maxCard) {
+				maxCard = qiClasses[tmpQI];
+				maxIndex = tmpQI;
 			}
-			if ((maxCard < qiMajority)) {
-				//ARB: change &wFace to wFace and use reference in called function
-				tmpQI = computeVisibility<G, I>(ioViewMap, fe, grid, epsilon, *ve, &wFace, &foundOccluders);
+		}
+		else {
+			//ARB: FindOccludee is redundant if ComputeRayCastingVisibility has been called
+			//ARB: change &wFace to wFace and use reference in called function
+			findOccludee<G, I>(fe, grid, epsilon, ve, &wFace);
 #if LOGGING
-				if (_global.debug & G_DEBUG_FREESTYLE) {
-					cout << "\tFEdge: visibility " << tmpQI << endl;
-				}
+			if (_global.debug & G_DEBUG_FREESTYLE) {
+				cout << "\tFEdge: occludee only (" << (wFace != NULL ? "found" : "not found") << ")" << endl;
+			}
 #endif
+		}
 
-				//ARB: This is an error condition, not an alert condition.
-				// Some sort of recovery or abort is necessary.
-				if (tmpQI >= 256) {
-					cerr << "Warning: too many occluding levels" << endl;
-					//ARB: Wild guess: instead of aborting or corrupting memory, treat as tmpQI == 255
-					tmpQI = 255;
-				}
-
-				if (++qiClasses[tmpQI] > maxCard) {
-					maxCard = qiClasses[tmpQI];
-					maxIndex = tmpQI;
-				}
+		// Store test results
+		if (wFace) {
+			vector<Vec3r> vertices;
+			for (int i = 0, numEdges = wFace->numberOfEdges(); i < numEdges; ++i) {
+				vertices.push_back(Vec3r(wFace->GetVertex(i)->GetVertex()));
 			}
-			else {
-				//ARB: FindOccludee is redundant if ComputeRayCastingVisibility has been called
-				//ARB: change &wFace to wFace and use reference in called function
-				findOccludee<G, I>(fe, grid, epsilon, *ve, &wFace);
+			Polygon3r poly(vertices, wFace->GetNormal());
+			poly.userdata = (void *)wFace;
+			fe->setaFace(poly);
+			wFaces.push_back(wFace);
+			fe->setOccludeeEmpty(false);
 #if LOGGING
-				if (_global.debug & G_DEBUG_FREESTYLE) {
-					cout << "\tFEdge: occludee only (" << (wFace != NULL ? "found" : "not found") << ")" << endl;
-				}
-#endif
+			if (_global.debug & G_DEBUG_FREESTYLE) {
+				cout << "\tFound occludee" << endl;
 			}
-
-			// Store test results
-			if (wFace) {
-				vector<Vec3r> vertices;
-				for (int i = 0, numEdges = wFace->numberOfEdges(); i < numEdges; ++i) {
-					vertices.push_back(Vec3r(wFace->GetVertex(i)->GetVertex()));
-				}
-				Polygon3r poly(vertices, wFace->GetNormal());
-				poly.userdata = (void *)wFace;
-				fe->setaFace(poly);
-				wFaces.push_back(wFace);
-				fe->setOccludeeEmpty(false);
-#if LOGGING
-				if (_global.debug & G_DEBUG_FREESTYLE) {
-					cout << "\tFound occludee" << endl;
-				}
 #endif
-			}
-			else {
-				fe->setOccludeeEmpty(true);
-			}
+		}
+		else {
+			fe->setOccludeeEmpty(true);
+		}
 
-			++nSamples;
-			fe = fe->nextEdge();
-		} while ((maxCard < qiMajority) && (fe) && (fe != festart));
+		++nSamples;
+		fe = fe->nextEdge();
+	} while ((maxCard < qiMajority) && (fe) && (fe != festart));
 
 #if LOGGING
-		if (_global.debug & G_DEBUG_FREESTYLE) {
-			cout << "\tFinished with " << nSamples << " samples, maxCard = " << maxCard << endl;
-		}
+	if (_global.debug & G_DEBUG_FREESTYLE) {
+		cout << "\tFinished with " << nSamples << " samples, maxCard = " << maxCard << endl;
+	}
 #endif
 
-		// ViewEdge
-		// qi --
-		(*ve)->setQI(maxIndex);
-		// occluders --
-		// I would rather not have to go through the effort of creating this this set and then copying out its contents.
-		// Is there a reason why ViewEdge::_Occluders cannot be converted to a set<>?
-		for (set<ViewShape*>::iterator o = foundOccluders.begin(), oend = foundOccluders.end(); o != oend; ++o) {
-			(*ve)->AddOccluder((*o));
-		}
+	// ViewEdge
+	// qi --
+	ve->setQI(maxIndex);
+	// occluders --
+	// I would rather not have to go through the effort of creating this this set and then copying out its contents.
+	// Is there a reason why ViewEdge::_Occluders cannot be converted to a set<>?
+	for (set<ViewShape*>::iterator o = foundOccluders.begin(), oend = foundOccluders.end(); o != oend; ++o) {
+		ve->AddOccluder((*o));
+	}
 #if LOGGING
-		if (_global.debug & G_DEBUG_FREESTYLE) {
-			cout << "\tConclusion: QI = " << maxIndex << ", " << (*ve)->occluders_size() << " occluders." << endl;
-		}
+	if (_global.debug & G_DEBUG_FREESTYLE) {
+		cout << "\tConclusion: QI = " << maxIndex << ", " << ve->occluders_size() << " occluders." << endl;
+	}
 #endif
-		// occludee --
-		if (!wFaces.empty()) {
-			if (wFaces.size() <= (float)nSamples / 2.0f) {
-				(*ve)->setaShape(0);
-			}
-			else {
-				ViewShape *vshape = ioViewMap->viewShape((*wFaces.begin())->GetVertex(0)->shape()->GetId());
-				(*ve)->setaShape(vshape);
-			}
+	// occludee --
+	if (!wFaces.empty()) {
+		if (wFaces.size() <= (float)nSamples / 2.0f) {
+			ve->setaShape(0);
 		}
+		else {
+			ViewShape *vshape = ioViewMap->viewShape((*wFaces.begin())->GetVertex(0)->shape()->GetId());
+			ve->setaShape(vshape);
+		}
+	}
+}
 
-		wFaces.clear();
+template <typename G, typename I>
+static void computeDetailedVisibility(ViewMap *ioViewMap, G& grid, real epsilon, RenderMonitor *iRenderMonitor)
+{
+	vector<ViewEdge*>& vedges = ioViewMap->ViewEdges();
+	ViewEdgeVisibilityData<G> data = {ioViewMap, &vedges, &grid, epsilon, 0};
+
+	unsigned cntStep = (unsigned)ceil(0.01f * vedges.size());
+	for (unsigned cnt = 0; cnt < vedges.size(); cnt += cntStep) {
+		if (iRenderMonitor && iRenderMonitor->testBreak())
+			break;
+		data.start = cnt;
+		BLI_task_parallel_range_ex(0, (int)min(cntStep, (unsigned)vedges.size() - cnt), &data, NULL, 0,
+		                           computeVisibilityTask<G, computeDetailedVisibilityEdge<G, I> >, true, true);
 	}
 }
 
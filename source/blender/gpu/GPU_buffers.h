@@ -110,6 +110,9 @@ typedef struct GPUDrawObject {
 	
 	int colType;
 
+	/* (1 << GPUBufferType) of the buffers to fill again when they're next used */
+	unsigned int dirty_buffers;
+
 	GPUBufferMaterial *materials;
 	int totmaterial;
 	
@@ -179,6 +182,8 @@ typedef enum {
 	GPU_BINDING_INDEX = 1,
 } GPUBindingType;
 
+void GPU_drawobject_tag_buffer_dirty(struct DerivedMesh *dm, GPUBufferType type);
+
 /* called before drawing */
 void GPU_vertex_setup(struct DerivedMesh *dm);
 void GPU_normal_setup(struct DerivedMesh *dm);
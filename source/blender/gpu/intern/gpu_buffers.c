@@ -44,6 +44,7 @@
 #include "BLI_utildefines.h"
 #include "BLI_ghash.h"
 #include "BLI_threads.h"
+#include "BLI_trace.h"
 
 #include "DNA_meshdata_types.h"
 
@@ -466,6 +467,14 @@ void GPU_drawobject_free(DerivedMesh *dm)
 	dm->drawObject = NULL;
 }
 
+/* Refill one buffer of the draw object when it's next used (keeping the other buffers),
+ * for changes which don't affect the layout of the draw object, such as moved vertices */
+void GPU_drawobject_tag_buffer_dirty(DerivedMesh *dm, GPUBufferType type)
+{
+	if (dm && dm->drawObject)
+		dm->drawObject->dirty_buffers |= (1u << type);
+}
+
 static GPUBuffer *gpu_try_realloc(GPUBufferPool *pool, GPUBuffer *buffer, size_t size)
 {
 	/* try freeing an entry from the pool
@@ -605,6 +614,7 @@ static size_t gpu_buffer_size_from_type(DerivedMesh *dm, GPUBufferType type)
 static GPUBuffer *gpu_buffer_setup_type(DerivedMesh *dm, GPUBufferType type, GPUBuffer *buf)
 {
 	void *user_data = NULL;
+	double trace_start;
 
 	/* special handling for MCol and UV buffers */
 	if (type == GPU_BUFFER_COLOR) {
@@ -616,7 +626,9 @@ static GPUBuffer *gpu_buffer_setup_type(DerivedMesh *dm, GPUBufferType type, GPU
 			return NULL;
 	}
 
+	trace_start = BLI_trace_begin();
 	buf = gpu_buffer_setup(dm, dm->drawObject, type, user_data, buf);
+	BLI_trace_end("gpu_buffer_setup", trace_start);
 
 	return buf;
 }
@@ -630,6 +642,11 @@ static GPUBuffer *gpu_buffer_setup_common(DerivedMesh *dm, GPUBufferType type, b
 	if (!dm->drawObject)
 		dm->drawObject = dm->gpuObjectNew(dm);
 
+	if (dm->drawObject->dirty_buffers & (1u << type)) {
+		dm->drawObject->dirty_buffers &= ~(1u << type);
+		update = true;
+	}
+
 	buf = gpu_drawobject_buffer_from_type(dm->drawObject, type);
 	if (!(*buf))
 		*buf = gpu_buffer_setup_type(dm, type, NULL);
@@ -1049,6 +1066,22 @@ static void gpu_color_from_mask_quad_copy(const CCGKey *key,
 	out[2] = diffuse_color[2] * mask_color;
 }
 
+/* Map the vertex buffer of a node for writing all of it, the buffer is reused when the size
+ * didn't change and its old storage is orphaned, so the driver doesn't have to wait for
+ * draws which still use it (or copy it) before it can be written */
+static VertexBufferFormat *gpu_pbvh_vert_buf_lock(GPU_PBVH_Buffers *buffers, size_t size)
+{
+	if (buffers->vert_buf && (buffers->vert_buf->size != size)) {
+		GPU_buffer_free(buffers->vert_buf);
+		buffers->vert_buf = NULL;
+	}
+
+	if (buffers->vert_buf == NULL)
+		buffers->vert_buf = GPU_buffer_alloc(size);
+
+	return GPU_buffer_lock_stream(buffers->vert_buf, GPU_BINDING_ARRAY);
+}
+
 void GPU_update_mesh_pbvh_buffers(
         GPU_PBVH_Buffers *buffers, const MVert *mvert,
         const int *vert_indices, int totvert, const float *vmask,
@@ -1077,10 +1110,7 @@ void GPU_update_mesh_pbvh_buffers(
 		copy_v4_v4(buffers->diffuse_color, diffuse_color);
 
 		/* Build VBO */
-		if (buffers->vert_buf)
-			GPU_buffer_free(buffers->vert_buf);
-		buffers->vert_buf = GPU_buffer_alloc(sizeof(VertexBufferFormat) * totelem);
-		vert_data = GPU_buffer_lock(buffers->vert_buf, GPU_BINDING_ARRAY);
+		vert_data = gpu_pbvh_vert_buf_lock(buffers, sizeof(VertexBufferFormat) * totelem);
 
 		if (vert_data) {
 			/* Vertex data is shared if smooth-shaded, but separate
@@ -1657,13 +1687,8 @@ void GPU_update_bmesh_pbvh_buffers(GPU_PBVH_Buffers *buffers,
 
 	copy_v4_v4(buffers->diffuse_color, diffuse_color);
 
-	/* Initialize vertex buffer */
-	if (buffers->vert_buf)
-		GPU_buffer_free(buffers->vert_buf);
-	buffers->vert_buf = GPU_buffer_alloc(sizeof(VertexBufferFormat) * totvert);
-
-	/* Fill vertex buffer */
-	vert_data = GPU_buffer_lock(buffers->vert_buf, GPU_BINDING_ARRAY);
+	/* Initialize and fill vertex buffer */
+	vert_data = gpu_pbvh_vert_buf_lock(buffers, sizeof(VertexBufferFormat) * totvert);
 	if (vert_data) {
 		int v_index = 0;
 
@@ -98,6 +98,21 @@ static char *FUNCTION_PROTOTYPES = NULL;
 static GPUShader *FUNCTION_LIB = NULL;
 #endif
 
+/* Compiled shaders, shared by all passes generating the same code. Materials
+ * often only differ in their uniforms and textures, which are set per pass. */
+typedef struct GPUShaderCacheEntry {
+	char *vertexcode;
+	char *fragmentcode;
+	char *geometrycode;
+	bool use_opensubdiv;
+	unsigned int hash;
+
+	GPUShader *shader;
+	int users;
+} GPUShaderCacheEntry;
+
+static GHash *SHADER_CACHE = NULL;
+
 static int gpu_str_prefix(const char *str, const char *prefix)
 {
 	while (*str && *prefix) {
@@ -282,6 +297,13 @@ void gpu_codegen_exit(void)
 		FUNCTION_HASH = NULL;
 	}
 
+	if (SHADER_CACHE) {
+		/* all passes should be freed by now */
+		BLI_assert(BLI_ghash_size(SHADER_CACHE) == 0);
+		BLI_ghash_free(SHADER_CACHE, NULL, NULL);
+		SHADER_CACHE = NULL;
+	}
+
 	GPU_shader_free_builtin_shaders();
 
 	if (glsl_material_library) {
@@ -1600,11 +1622,102 @@ static void gpu_nodes_prune(ListBase *nodes, GPUNodeLink *outlink)
 	}
 }
 
+/* Shader Cache */
+
+static unsigned int gpu_shader_cache_hash(const void *key)
+{
+	const GPUShaderCacheEntry *entry = key;
+	return entry->hash;
+}
+
+static bool gpu_shader_cache_cmp(const void *a, const void *b)
+{
+	const GPUShaderCacheEntry *entry_a = a;
+	const GPUShaderCacheEntry *entry_b = b;
+
+	return ((entry_a->hash != entry_b->hash) ||
+	        (entry_a->use_opensubdiv != entry_b->use_opensubdiv) ||
+	        !STREQ(entry_a->fragmentcode, entry_b->fragmentcode) ||
+	        !STREQ(entry_a->vertexcode, entry_b->vertexcode) ||
+	        !STREQ(entry_a->geometrycode ? entry_a->geometrycode : "",
+	               entry_b->geometrycode ? entry_b->geometrycode : ""));
+}
+
+/* get a compiled shader for the code, compiling it if no other pass uses it yet */
+static GPUShaderCacheEntry *gpu_shader_cache_acquire(char *vertexcode, char *fragmentcode, char *geometrycode,
+                                                     const bool use_opensubdiv)
+{
+	GPUShaderCacheEntry key, *entry;
+	GPUShader *shader;
+
+	if (!SHADER_CACHE) {
+		SHADER_CACHE = BLI_ghash_new(gpu_shader_cache_hash, gpu_shader_cache_cmp, "GPU shader cache gh");
+	}
+
+	key.vertexcode = vertexcode;
+	key.fragmentcode = fragmentcode;
+	key.geometrycode = geometrycode;
+	key.use_opensubdiv = use_opensubdiv;
+	key.hash = BLI_ghashutil_strhash_p(fragmentcode) ^ BLI_ghashutil_strhash_p(vertexcode);
+	if (geometrycode) {
+		key.hash ^= BLI_ghashutil_strhash_p(geometrycode);
+	}
+
+	entry = BLI_ghash_lookup(SHADER_CACHE, &key);
+	if (entry) {
+		entry->users++;
+		return entry;
+	}
+
+	shader = GPU_shader_create_ex(vertexcode,
+	                              fragmentcode,
+	                              geometrycode,
+	                              glsl_material_library,
+	                              NULL,
+	                              0,
+	                              0,
+	                              0,
+	                              use_opensubdiv ? GPU_SHADER_FLAGS_SPECIAL_OPENSUBDIV
+	                                             : GPU_SHADER_FLAGS_NONE);
+
+	/* failed shaders aren't cached, so they print their errors again when used */
+	if (!shader)
+		return NULL;
+
+	entry = MEM_callocN(sizeof(GPUShaderCacheEntry), "GPUShaderCacheEntry");
+	entry->vertexcode = BLI_strdup(vertexcode);
+	entry->fragmentcode = BLI_strdup(fragmentcode);
+	entry->geometrycode = geometrycode ? BLI_strdup(geometrycode) : NULL;
+	entry->use_opensubdiv = use_opensubdiv;
+	entry->hash = key.hash;
+	entry->shader = shader;
+	entry->users = 1;
+
+	BLI_ghash_insert(SHADER_CACHE, entry, entry);
+
+	return entry;
+}
+
+static void gpu_shader_cache_release(GPUShaderCacheEntry *entry)
+{
+	if (--entry->users > 0)
+		return;
+
+	BLI_ghash_remove(SHADER_CACHE, entry, NULL, NULL);
+
+	GPU_shader_free(entry->shader);
+	MEM_freeN(entry->vertexcode);
+	MEM_freeN(entry->fragmentcode);
+	if (entry->geometrycode)
+		MEM_freeN(entry->geometrycode);
+	MEM_freeN(entry);
+}
+
 GPUPass *GPU_generate_pass(ListBase *nodes, GPUNodeLink *outlink,
 						   GPUVertexAttribs *attribs, int *builtins,
 						   const GPUMatType type, const char *UNUSED(name), const bool use_opensubdiv)
 {
-	GPUShader *shader;
+	GPUShaderCacheEntry *shader_cache_entry;
 	GPUPass *pass;
 	char *vertexcode, *geometrycode, *fragmentcode;
 
@@ -1625,19 +1738,10 @@ GPUPass *GPU_generate_pass(ListBase *nodes, GPUNodeLink *outlink,
 	fragmentcode = code_generate_fragment(nodes, outlink->output);
 	vertexcode = code_generate_vertex(nodes, type);
 	geometrycode = code_generate_geometry(nodes, use_opensubdiv);
-	shader = GPU_shader_create_ex(vertexcode,
-	                              fragmentcode,
-	                              geometrycode,
-	                              glsl_material_library,
-	                              NULL,
-	                              0,
-	                              0,
-	                              0,
-	                              use_opensubdiv ? GPU_SHADER_FLAGS_SPECIAL_OPENSUBDIV
-	                                             : GPU_SHADER_FLAGS_NONE);
+	shader_cache_entry = gpu_shader_cache_acquire(vertexcode, fragmentcode, geometrycode, use_opensubdiv);
 
 	/* failed? */
-	if (!shader) {
+	if (!shader_cache_entry) {
 		if (fragmentcode)
 			MEM_freeN(fragmentcode);
 		if (vertexcode)
@@ -1652,7 +1756,8 @@ GPUPass *GPU_generate_pass(ListBase *nodes, GPUNodeLink *outlink,
 	pass = MEM_callocN(sizeof(GPUPass), "GPUPass");
 
 	pass->output = outlink->output;
-	pass->shader = shader;
+	pass->shader = shader_cache_entry->shader;
+	pass->shader_cache_entry = shader_cache_entry;
 	pass->fragmentcode = fragmentcode;
 	pass->geometrycode = geometrycode;
 	pass->vertexcode = vertexcode;
@@ -1667,7 +1772,7 @@ GPUPass *GPU_generate_pass(ListBase *nodes, GPUNodeLink *outlink,
 
 void GPU_pass_free(GPUPass *pass)
 {
-	GPU_shader_free(pass->shader);
+	gpu_shader_cache_release(pass->shader_cache_entry);
 	gpu_inputs_free(&pass->inputs);
 	if (pass->fragmentcode)
 		MEM_freeN(pass->fragmentcode);
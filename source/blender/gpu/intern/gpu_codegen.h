@@ -160,6 +160,7 @@ struct GPUPass {
 	ListBase inputs;
 	struct GPUOutput *output;
 	struct GPUShader *shader;
+	struct GPUShaderCacheEntry *shader_cache_entry;  /* shader shared with passes generating the same code */
 	char *fragmentcode;
 	char *geometrycode;
 	char *vertexcode;
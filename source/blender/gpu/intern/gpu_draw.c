@@ -1551,7 +1551,7 @@ void GPU_begin_object_materials(View3D *v3d, RegionView3D *rv3d, Scene *scene, O
 #endif
 
 #ifdef WITH_GAMEENGINE
-	if (rv3d->rflag & RV3D_IS_GAME_ENGINE) {
+	if (rv3d->rflag & RV3D_USE_LOD) {
 		ob = BKE_object_lod_matob_get(ob, scene);
 	}
 #endif
@@ -48,6 +48,7 @@ struct EnumPropertyItem;
 struct ImBuf;
 struct Main;
 struct ImageFormatData;
+struct rcti;
 
 struct ColorSpace;
 struct ColorManagedDisplay;
@@ -118,6 +119,9 @@ const char *IMB_colormanagement_get_display_colorspace_name(const struct ColorMa
 unsigned char *IMB_display_buffer_acquire(struct ImBuf *ibuf, const struct ColorManagedViewSettings *view_settings,
                                           const struct ColorManagedDisplaySettings *display_settings, void **cache_handle);
 unsigned char *IMB_display_buffer_acquire_ctx(const struct bContext *C, struct ImBuf *ibuf, void **cache_handle);
+unsigned char *IMB_display_buffer_acquire_rect(struct ImBuf *ibuf, const struct ColorManagedViewSettings *view_settings,
+                                               const struct ColorManagedDisplaySettings *display_settings,
+                                               const struct rcti *rect, void **cache_handle);
 
 void IMB_display_buffer_transform_apply(unsigned char *display_buffer, float *linear_buffer, int width, int height,
                                         int channels, const struct ColorManagedViewSettings *view_settings,
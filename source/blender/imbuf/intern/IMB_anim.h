@@ -115,6 +115,9 @@
 
 #define MAXNUMSTREAMS       50
 
+/* decoded frames kept around the last seek position (ffmpeg only) */
+#define ANIM_GOP_CACHE_SIZE 8
+
 struct _AviMovie;
 struct anim_index;
 
@@ -175,6 +178,14 @@ struct anim {
 	int64_t last_pts;
 	int64_t next_pts;
 	AVPacket next_packet;
+
+	/* frames decoded just before the last fetched ones, so stepping back
+	 * doesn't have to decode the whole GOP again */
+	struct {
+		struct ImBuf *ibuf;
+		int64_t pts, next_pts;
+	} gop_cache[ANIM_GOP_CACHE_SIZE];
+	int gop_cache_next;
 #endif
 
 #ifdef WITH_REDCODE
@@ -67,6 +67,7 @@
 #include "BLI_utildefines.h"
 #include "BLI_string.h"
 #include "BLI_path_util.h"
+#include "BLI_threads.h"
 
 #include "MEM_guardedalloc.h"
 
@@ -519,6 +520,20 @@ static int startffmpeg(struct anim *anim)
 
 	pCodecCtx->workaround_bugs = 1;
 
+	/* decode on all cores, frame threading delays the output by a few packets,
+	 * those are flushed at EOF by ffmpeg_decode_video_frame */
+#ifdef CODEC_CAP_AUTO_THREADS
+	if (pCodec->capabilities & CODEC_CAP_AUTO_THREADS)
+		pCodecCtx->thread_count = 0;
+	else
+#endif
+		pCodecCtx->thread_count = BLI_system_thread_count();
+
+	if (pCodec->capabilities & CODEC_CAP_FRAME_THREADS)
+		pCodecCtx->thread_type = FF_THREAD_FRAME;
+	else if (pCodec->capabilities & CODEC_CAP_SLICE_THREADS)
+		pCodecCtx->thread_type = FF_THREAD_SLICE;
+
 	if (avcodec_open2(pCodecCtx, pCodec, NULL) < 0) {
 		avformat_close_input(&pFormatCtx);
 		return -1;
@@ -765,6 +780,70 @@ static void ffmpeg_postprocess(struct anim *anim)
 	}
 }
 
+/* postprocess the current frame into a new buffer, keeping anim->last_frame */
+static ImBuf *ffmpeg_postprocess_new(struct anim *anim)
+{
+	ImBuf *last_frame = anim->last_frame;
+	ImBuf *ibuf = IMB_allocImBuf(anim->x, anim->y, 32, IB_rect);
+
+	ibuf->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
+
+	anim->last_frame = ibuf;
+	ffmpeg_postprocess(anim);
+	anim->last_frame = last_frame;
+
+	return ibuf;
+}
+
+static void ffmpeg_gop_cache_add(struct anim *anim, ImBuf *ibuf, int64_t pts, int64_t next_pts)
+{
+	int i, slot = anim->gop_cache_next;
+
+	for (i = 0; i < ANIM_GOP_CACHE_SIZE; i++) {
+		if (anim->gop_cache[i].ibuf && anim->gop_cache[i].pts == pts) {
+			slot = i;
+			break;
+		}
+	}
+
+	if (slot == anim->gop_cache_next) {
+		anim->gop_cache_next = (anim->gop_cache_next + 1) % ANIM_GOP_CACHE_SIZE;
+	}
+
+	IMB_refImBuf(ibuf);
+	IMB_freeImBuf(anim->gop_cache[slot].ibuf);
+
+	anim->gop_cache[slot].ibuf = ibuf;
+	anim->gop_cache[slot].pts = pts;
+	anim->gop_cache[slot].next_pts = next_pts;
+}
+
+static ImBuf *ffmpeg_gop_cache_lookup(struct anim *anim, int64_t pts)
+{
+	int i;
+
+	for (i = 0; i < ANIM_GOP_CACHE_SIZE; i++) {
+		if (anim->gop_cache[i].ibuf &&
+		    anim->gop_cache[i].pts <= pts && anim->gop_cache[i].next_pts > pts)
+		{
+			IMB_refImBuf(anim->gop_cache[i].ibuf);
+			return anim->gop_cache[i].ibuf;
+		}
+	}
+
+	return NULL;
+}
+
+static void ffmpeg_gop_cache_free(struct anim *anim)
+{
+	int i;
+
+	for (i = 0; i < ANIM_GOP_CACHE_SIZE; i++) {
+		IMB_freeImBuf(anim->gop_cache[i].ibuf);
+		anim->gop_cache[i].ibuf = NULL;
+	}
+}
+
 /* decode one video frame also considering the packet read into next_packet */
 
 static int ffmpeg_decode_video_frame(struct anim *anim)
@@ -873,6 +952,10 @@ static void ffmpeg_decode_video_frame_scan(
 {
 	/* there seem to exist *very* silly GOP lengths out in the wild... */
 	int count = 1000;
+	/* frames this close to the searched one are kept in the GOP cache */
+	AVStream *v_st = anim->pFormatCtx->streams[anim->videoStream];
+	const int64_t pts_cache_range = (int64_t)(ANIM_GOP_CACHE_SIZE / av_q2d(av_get_r_frame_rate_compat(v_st)) /
+	                                          av_q2d(v_st->time_base));
 
 	av_log(anim->pFormatCtx,
 	       AV_LOG_DEBUG, 
@@ -884,7 +967,25 @@ static void ffmpeg_decode_video_frame_scan(
 		       AV_LOG_DEBUG, 
 		       "  WHILE: pts=%lld in search of %lld\n", 
 		       (long long int)anim->next_pts, (long long int)pts_to_search);
-		if (!ffmpeg_decode_video_frame(anim)) {
+
+		/* next_pts is -1 right after seeking, the frame isn't known then */
+		if (anim->pFrameComplete && anim->next_pts >= 0 &&
+		    pts_to_search - anim->next_pts <= pts_cache_range)
+		{
+			const int64_t pts = anim->next_pts;
+			ImBuf *ibuf = ffmpeg_postprocess_new(anim);
+			const bool ok = ffmpeg_decode_video_frame(anim);
+
+			if (ok) {
+				ffmpeg_gop_cache_add(anim, ibuf, pts, anim->next_pts);
+			}
+			IMB_freeImBuf(ibuf);
+
+			if (!ok) {
+				break;
+			}
+		}
+		else if (!ffmpeg_decode_video_frame(anim)) {
 			break;
 		}
 		count--;
@@ -957,6 +1058,7 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 	AVStream *v_st;
 	int new_frame_index = 0; /* To quiet gcc barking... */
 	int old_frame_index = 0; /* To quiet gcc barking... */
+	ImBuf *ibuf;
 
 	if (anim == NULL) return (0);
 
@@ -1007,6 +1109,13 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 		anim->curposition = position;
 		return anim->last_frame;
 	}
+
+	/* the decoder stays where it is, so curposition isn't changed */
+	ibuf = ffmpeg_gop_cache_lookup(anim, pts_to_search);
+	if (ibuf) {
+		av_log(anim->pFormatCtx, AV_LOG_DEBUG, "FETCH: from GOP cache\n");
+		return ibuf;
+	}
 	 
 	if (position > anim->curposition + 1 &&
 	    anim->preseek &&
@@ -1117,15 +1226,17 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position,
 		       "FETCH: no seek necessary, just continue...\n");
 	}
 
+	ibuf = ffmpeg_postprocess_new(anim);
 	IMB_freeImBuf(anim->last_frame);
-	anim->last_frame = IMB_allocImBuf(anim->x, anim->y, 32, IB_rect);
-	anim->last_frame->rect_colorspace = colormanage_colorspace_get_named(anim->colorspace);
-
-	ffmpeg_postprocess(anim);
+	anim->last_frame = ibuf;
 
 	anim->last_pts = anim->next_pts;
 	
 	ffmpeg_decode_video_frame(anim);
+
+	if (anim->last_pts >= 0 && anim->next_pts > anim->last_pts) {
+		ffmpeg_gop_cache_add(anim, anim->last_frame, anim->last_pts, anim->next_pts);
+	}
 	
 	anim->curposition = position;
 	
@@ -1150,6 +1261,7 @@ static void free_anim_ffmpeg(struct anim *anim)
 		av_free(anim->pFrameDeinterlaced);
 		sws_freeContext(anim->img_convert_ctx);
 		IMB_freeImBuf(anim->last_frame);
+		ffmpeg_gop_cache_free(anim);
 		if (anim->next_packet.stream_index != -1) {
 			av_free_packet(&anim->next_packet);
 		}
@@ -52,11 +52,13 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_bitmap.h"
 #include "BLI_math.h"
 #include "BLI_math_color.h"
 #include "BLI_string.h"
 #include "BLI_threads.h"
 #include "BLI_rect.h"
+#include "BLI_task.h"
 
 #include "BKE_appdir.h"
 #include "BKE_colortools.h"
@@ -72,6 +74,9 @@
 
 #define DISPLAY_BUFFER_CHANNELS 4
 
+/* display buffers are calculated in square tiles of this size, only when they are requested */
+#define DISPLAY_BUFFER_TILE_SIZE 256
+
 /* ** list of all supported color spaces, displays and views */
 static char global_role_scene_linear[MAX_COLORSPACE_NAME];
 static char global_role_color_picking[MAX_COLORSPACE_NAME];
@@ -184,6 +189,14 @@ static struct global_glsl_state {
  *      means keys for color managed buffers could be really simple
  *      and look up in this cache would be fast and independent from
  *      overall amount of color managed images.
+ *
+ *      Cached display buffers are allocated for the whole image, but
+ *      only calculated in tiles of DISPLAY_BUFFER_TILE_SIZE pixels
+ *      which were requested (see IMB_display_buffer_acquire_rect),
+ *      calculated tiles are marked in tiles_valid of the cache data.
+ *      So drawing a zoomed in part of a huge image only transforms
+ *      the visible part of it, and pages of tiles which were never
+ *      requested are not touched.
  */
 
 /* NOTE: ColormanageCacheViewSettings and ColormanageCacheDisplaySettings are
@@ -222,6 +235,7 @@ typedef struct ColormnaageCacheData {
 	float dither;    /* dither value cached buffer is calculated with */
 	CurveMapping *curve_mapping;  /* curve mapping used for cached buffer */
 	int curve_mapping_timestamp;  /* time stamp of curve mapping used for cached buffer */
+	BLI_bitmap *tiles_valid;      /* tiles of the display buffer which were calculated */
 } ColormnaageCacheData;
 
 typedef struct ColormanageCache {
@@ -321,6 +335,16 @@ static void colormanage_settings_to_key(ColormanageCacheKey *key,
 	key->display = display_settings->display;
 }
 
+BLI_INLINE int display_buffer_tiles_x(const ImBuf *ibuf)
+{
+	return (ibuf->x + DISPLAY_BUFFER_TILE_SIZE - 1) / DISPLAY_BUFFER_TILE_SIZE;
+}
+
+BLI_INLINE int display_buffer_tiles_num(const ImBuf *ibuf)
+{
+	return display_buffer_tiles_x(ibuf) * ((ibuf->y + DISPLAY_BUFFER_TILE_SIZE - 1) / DISPLAY_BUFFER_TILE_SIZE);
+}
+
 static ImBuf *colormanage_cache_get_ibuf(ImBuf *ibuf, ColormanageCacheKey *key, void **cache_handle)
 {
 	ImBuf *cache_ibuf;
@@ -429,6 +453,7 @@ static void colormanage_cache_put(ImBuf *ibuf, const ColormanageCacheViewSetting
 	cache_data->flag = view_settings->flag;
 	cache_data->curve_mapping = curve_mapping;
 	cache_data->curve_mapping_timestamp = curve_mapping_timestamp;
+	cache_data->tiles_valid = BLI_BITMAP_NEW(display_buffer_tiles_num(ibuf), "color manage cache tiles");
 
 	colormanage_cachedata_set(cache_ibuf, cache_data);
 
@@ -714,6 +739,9 @@ void colormanage_cache_free(ImBuf *ibuf)
 		struct MovieCache *moviecache = colormanage_moviecache_get(ibuf);
 
 		if (cache_data) {
+			if (cache_data->tiles_valid) {
+				MEM_freeN(cache_data->tiles_valid);
+			}
 			MEM_freeN(cache_data);
 		}
 
@@ -1567,11 +1595,184 @@ static void colormanage_display_buffer_process_ex(ImBuf *ibuf, float *display_bu
 		IMB_colormanagement_processor_free(cm_processor);
 }
 
-static void colormanage_display_buffer_process(ImBuf *ibuf, unsigned char *display_buffer,
-                                               const ColorManagedViewSettings *view_settings,
-                                               const ColorManagedDisplaySettings *display_settings)
+/*********************** Tiled display buffer transform routines *************************/
+
+typedef struct DisplayBufferTilesData {
+	ImBuf *ibuf;
+	unsigned char *display_buffer;
+	ColormanageProcessor *cm_processor;
+
+	const char *byte_colorspace;
+	const char *float_colorspace;
+
+	const int *tiles;
+} DisplayBufferTilesData;
+
+static void display_buffer_tile_func(void *userdata, void *UNUSED(userdata_chunk), int index)
+{
+	DisplayBufferTilesData *data = userdata;
+	ImBuf *ibuf = data->ibuf;
+	const int tiles_x = display_buffer_tiles_x(ibuf);
+	const int xmin = (data->tiles[index] % tiles_x) * DISPLAY_BUFFER_TILE_SIZE;
+	const int ymin = (data->tiles[index] / tiles_x) * DISPLAY_BUFFER_TILE_SIZE;
+	const int width = min_ii(DISPLAY_BUFFER_TILE_SIZE, ibuf->x - xmin);
+	const int height = min_ii(DISPLAY_BUFFER_TILE_SIZE, ibuf->y - ymin);
+	const int channels = ibuf->channels;
+	DisplayBufferThread handle = {NULL};
+	float *buffer = NULL;
+	unsigned char *byte_buffer = NULL;
+	unsigned char *tile_buffer;
+	int y;
+
+	/* copy the tile to contiguous buffers, so it goes through the same transform as whole lines */
+	if (ibuf->rect_float) {
+		buffer = MEM_mallocN(sizeof(float) * channels * width * height, "display buffer tile linear");
+
+		for (y = 0; y < height; y++) {
+			memcpy(buffer + (size_t)y * width * channels,
+			       ibuf->rect_float + ((size_t)(ymin + y) * ibuf->x + xmin) * channels,
+			       sizeof(float) * width * channels);
+		}
+	}
+	else {
+		byte_buffer = MEM_mallocN(sizeof(char) * channels * width * height, "display buffer tile byte");
+
+		for (y = 0; y < height; y++) {
+			memcpy(byte_buffer + (size_t)y * width * channels,
+			       (unsigned char *)ibuf->rect + ((size_t)(ymin + y) * ibuf->x + xmin) * channels,
+			       sizeof(char) * width * channels);
+		}
+	}
+
+	tile_buffer = MEM_mallocN(sizeof(char) * DISPLAY_BUFFER_CHANNELS * width * height, "display buffer tile");
+
+	handle.cm_processor = data->cm_processor;
+	handle.buffer = buffer;
+	handle.byte_buffer = byte_buffer;
+	handle.display_buffer_byte = tile_buffer;
+	handle.width = width;
+	handle.start_line = ymin;
+	handle.tot_line = height;
+	handle.channels = channels;
+	handle.dither = ibuf->dither;
+	handle.is_data = (ibuf->colormanage_flag & IMB_COLORMANAGE_IS_DATA) != 0;
+	handle.byte_colorspace = data->byte_colorspace;
+	handle.float_colorspace = data->float_colorspace;
+
+	do_display_buffer_apply_thread(&handle);
+
+	for (y = 0; y < height; y++) {
+		memcpy(data->display_buffer + ((size_t)(ymin + y) * ibuf->x + xmin) * DISPLAY_BUFFER_CHANNELS,
+		       tile_buffer + (size_t)y * width * DISPLAY_BUFFER_CHANNELS,
+		       sizeof(char) * width * DISPLAY_BUFFER_CHANNELS);
+	}
+
+	if (buffer)
+		MEM_freeN(buffer);
+	if (byte_buffer)
+		MEM_freeN(byte_buffer);
+	MEM_freeN(tile_buffer);
+}
+
+/* range of tiles overlapping the rect (NULL for the whole buffer), max values are exclusive */
+static bool display_buffer_tiles_range(const ImBuf *ibuf, const rcti *rect, rcti *r_tiles)
 {
-	colormanage_display_buffer_process_ex(ibuf, NULL, display_buffer, view_settings, display_settings);
+	rcti image_rect;
+
+	BLI_rcti_init(&image_rect, 0, ibuf->x, 0, ibuf->y);
+
+	if (rect) {
+		if (!BLI_rcti_isect(&image_rect, rect, &image_rect))
+			return false;
+	}
+
+	r_tiles->xmin = image_rect.xmin / DISPLAY_BUFFER_TILE_SIZE;
+	r_tiles->ymin = image_rect.ymin / DISPLAY_BUFFER_TILE_SIZE;
+	r_tiles->xmax = (image_rect.xmax + DISPLAY_BUFFER_TILE_SIZE - 1) / DISPLAY_BUFFER_TILE_SIZE;
+	r_tiles->ymax = (image_rect.ymax + DISPLAY_BUFFER_TILE_SIZE - 1) / DISPLAY_BUFFER_TILE_SIZE;
+
+	return (r_tiles->xmin < r_tiles->xmax && r_tiles->ymin < r_tiles->ymax);
+}
+
+/* calculate tiles of display buffer overlapping rect which weren't calculated yet */
+static void colormanage_display_buffer_tiles_process(ImBuf *ibuf, unsigned char *display_buffer,
+                                                      BLI_bitmap *tiles_valid, const rcti *rect,
+                                                      const ColorManagedViewSettings *view_settings,
+                                                      const ColorManagedDisplaySettings *display_settings)
+{
+	DisplayBufferTilesData data;
+	const int tiles_x = display_buffer_tiles_x(ibuf);
+	rcti tiles_range;
+	int *tiles;
+	int tiles_tot = 0, tile_x, tile_y, i;
+	bool skip_transform = false;
+
+	if (!display_buffer_tiles_range(ibuf, rect, &tiles_range))
+		return;
+
+	tiles = MEM_mallocN(sizeof(int) * BLI_rcti_size_x(&tiles_range) * BLI_rcti_size_y(&tiles_range),
+	                    "display buffer tiles");
+
+	for (tile_y = tiles_range.ymin; tile_y < tiles_range.ymax; tile_y++) {
+		for (tile_x = tiles_range.xmin; tile_x < tiles_range.xmax; tile_x++) {
+			const int tile = tile_y * tiles_x + tile_x;
+
+			if (!BLI_BITMAP_TEST(tiles_valid, tile)) {
+				tiles[tiles_tot++] = tile;
+			}
+		}
+	}
+
+	if (tiles_tot == 0) {
+		MEM_freeN(tiles);
+		return;
+	}
+
+	/* same as colormanage_display_buffer_process_ex, skip the transform
+	 * when the byte buffer already is in the display space
+	 */
+	if (ibuf->rect_float == NULL && ibuf->rect_colorspace) {
+		skip_transform = is_ibuf_rect_in_display_space(ibuf, view_settings, display_settings);
+	}
+
+	data.ibuf = ibuf;
+	data.display_buffer = display_buffer;
+	data.cm_processor = skip_transform ? NULL : IMB_colormanagement_display_processor_new(view_settings,
+	                                                                                       display_settings);
+	data.byte_colorspace = ibuf->rect_colorspace ? ibuf->rect_colorspace->name : global_role_default_byte;
+	data.float_colorspace = ibuf->float_colorspace ? ibuf->float_colorspace->name : NULL;
+	data.tiles = tiles;
+
+	BLI_task_parallel_range_ex(0, tiles_tot, &data, NULL, 0, display_buffer_tile_func, tiles_tot > 1, true);
+
+	for (i = 0; i < tiles_tot; i++) {
+		BLI_BITMAP_ENABLE(tiles_valid, tiles[i]);
+	}
+
+	if (data.cm_processor)
+		IMB_colormanagement_processor_free(data.cm_processor);
+
+	MEM_freeN(tiles);
+}
+
+/* mark tiles which are fully inside of the rect as calculated, max values are exclusive */
+static void colormanage_display_buffer_tiles_validate(ImBuf *ibuf, BLI_bitmap *tiles_valid, const rcti *rect)
+{
+	const int tiles_x = display_buffer_tiles_x(ibuf);
+	int tile_x, tile_y;
+	int xmin = (rect->xmin + DISPLAY_BUFFER_TILE_SIZE - 1) / DISPLAY_BUFFER_TILE_SIZE;
+	int ymin = (rect->ymin + DISPLAY_BUFFER_TILE_SIZE - 1) / DISPLAY_BUFFER_TILE_SIZE;
+	/* tiles at the right and top edge of the image are smaller */
+	int xmax = (rect->xmax >= ibuf->x) ? tiles_x : rect->xmax / DISPLAY_BUFFER_TILE_SIZE;
+	int ymax = (rect->ymax >= ibuf->y) ?
+	           (ibuf->y + DISPLAY_BUFFER_TILE_SIZE - 1) / DISPLAY_BUFFER_TILE_SIZE :
+	           rect->ymax / DISPLAY_BUFFER_TILE_SIZE;
+
+	for (tile_y = max_ii(ymin, 0); tile_y < ymax; tile_y++) {
+		for (tile_x = max_ii(xmin, 0); tile_x < xmax; tile_x++) {
+			BLI_BITMAP_ENABLE(tiles_valid, tile_y * tiles_x + tile_x);
+		}
+	}
 }
 
 /*********************** Threaded processor transform routines *************************/
@@ -2015,11 +2216,18 @@ void IMB_colormanagement_buffer_make_display_space(float *buffer, unsigned char
 /*********************** Public display buffers interfaces *************************/
 
 /* acquire display buffer for given image buffer using specified view and display settings */
-unsigned char *IMB_display_buffer_acquire(ImBuf *ibuf, const ColorManagedViewSettings *view_settings,
-                                          const ColorManagedDisplaySettings *display_settings, void **cache_handle)
+/**
+ * Acquire display buffer for the image buffer, where only the part overlapping \a rect
+ * (max values exclusive, NULL for the whole image) is guaranteed to be calculated.
+ * Other parts of the buffer are only calculated once they are requested.
+ */
+unsigned char *IMB_display_buffer_acquire_rect(ImBuf *ibuf, const ColorManagedViewSettings *view_settings,
+                                               const ColorManagedDisplaySettings *display_settings,
+                                               const rcti *rect, void **cache_handle)
 {
 	unsigned char *display_buffer;
 	size_t buffer_size;
+	ColormnaageCacheData *cache_data;
 	ColormanageCacheViewSettings cache_view_settings;
 	ColormanageCacheDisplaySettings cache_display_settings;
 	ColorManagedViewSettings default_view_settings;
@@ -2082,23 +2290,30 @@ unsigned char *IMB_display_buffer_acquire(ImBuf *ibuf, const ColorManagedViewSet
 
 	display_buffer = colormanage_cache_get(ibuf, &cache_view_settings, &cache_display_settings, cache_handle);
 
-	if (display_buffer) {
-		BLI_unlock_thread(LOCK_COLORMANAGE);
-		return display_buffer;
-	}
+	if (display_buffer == NULL) {
+		/* not cleared, tiles are written once they're requested */
+		buffer_size = DISPLAY_BUFFER_CHANNELS * ((size_t)ibuf->x) * ibuf->y * sizeof(char);
+		display_buffer = MEM_mallocN(buffer_size, "imbuf display buffer");
 
-	buffer_size = DISPLAY_BUFFER_CHANNELS * ((size_t)ibuf->x) * ibuf->y * sizeof(char);
-	display_buffer = MEM_callocN(buffer_size, "imbuf display buffer");
+		colormanage_cache_put(ibuf, &cache_view_settings, &cache_display_settings, display_buffer, cache_handle);
+	}
 
-	colormanage_display_buffer_process(ibuf, display_buffer, applied_view_settings, display_settings);
+	cache_data = colormanage_cachedata_get(*cache_handle);
 
-	colormanage_cache_put(ibuf, &cache_view_settings, &cache_display_settings, display_buffer, cache_handle);
+	colormanage_display_buffer_tiles_process(ibuf, display_buffer, cache_data->tiles_valid, rect,
+	                                         applied_view_settings, display_settings);
 
 	BLI_unlock_thread(LOCK_COLORMANAGE);
 
 	return display_buffer;
 }
 
+unsigned char *IMB_display_buffer_acquire(ImBuf *ibuf, const ColorManagedViewSettings *view_settings,
+                                          const ColorManagedDisplaySettings *display_settings, void **cache_handle)
+{
+	return IMB_display_buffer_acquire_rect(ibuf, view_settings, display_settings, NULL, cache_handle);
+}
+
 /* same as IMB_display_buffer_acquire but gets view and display settings from context */
 unsigned char *IMB_display_buffer_acquire_ctx(const bContext *C, ImBuf *ibuf, void **cache_handle)
 {
@@ -2831,6 +3046,18 @@ void IMB_partial_display_buffer_update(ImBuf *ibuf, const float *linear_buffer,
 			IMB_colormanagement_processor_free(cm_processor);
 		}
 
+		if (cache_handle) {
+			/* tiles covered by the update are up to date now, others keep their state */
+			ColormnaageCacheData *cache_data = colormanage_cachedata_get(cache_handle);
+			rcti rect;
+
+			BLI_rcti_init(&rect, xmin, xmax, ymin, ymax);
+
+			BLI_lock_thread(LOCK_COLORMANAGE);
+			colormanage_display_buffer_tiles_validate(ibuf, cache_data->tiles_valid, &rect);
+			BLI_unlock_thread(LOCK_COLORMANAGE);
+		}
+
 		IMB_display_buffer_release(cache_handle);
 	}
 
@@ -161,10 +161,12 @@ MINLINE void float_to_byte_dither_v4(uchar b[4], const float f[4], DitherContext
 	b[3] = FTOCHAR(f[3]);
 }
 
-/* float to byte pixels, output 4-channel RGBA */
-void IMB_buffer_byte_from_float(uchar *rect_to, const float *rect_from,
-                                int channels_from, float dither, int profile_to, int profile_from, bool predivide,
-                                int width, int height, int stride_to, int stride_from)
+/* float to byte pixels for lines start_line to start_line + tot_line of the buffers,
+ * so parts of the buffer can be converted in parallel with the same dither pattern */
+static void buffer_byte_from_float_lines(uchar *rect_to, const float *rect_from,
+                                         int channels_from, float dither, int profile_to, int profile_from, bool predivide,
+                                         int width, int height, int stride_to, int stride_from,
+                                         int start_line, int tot_line)
 {
 	float tmp[4];
 	int x, y;
@@ -179,7 +181,7 @@ void IMB_buffer_byte_from_float(uchar *rect_to, const float *rect_from,
 	if (dither)
 		di = create_dither_context(dither);
 
-	for (y = 0; y < height; y++) {
+	for (y = start_line; y < start_line + tot_line; y++) {
 		float t = y * inv_height;
 
 		if (channels_from == 1) {
@@ -315,6 +317,15 @@ void IMB_buffer_byte_from_float(uchar *rect_to, const float *rect_from,
 		clear_dither_context(di);
 }
 
+/* float to byte pixels, output 4-channel RGBA */
+void IMB_buffer_byte_from_float(uchar *rect_to, const float *rect_from,
+                                int channels_from, float dither, int profile_to, int profile_from, bool predivide,
+                                int width, int height, int stride_to, int stride_from)
+{
+	buffer_byte_from_float_lines(rect_to, rect_from, channels_from, dither, profile_to, profile_from, predivide,
+	                             width, height, stride_to, stride_from, 0, height);
+}
+
 
 /* float to byte pixels, output 4-channel RGBA */
 void IMB_buffer_byte_from_float_mask(uchar *rect_to, const float *rect_from,
@@ -636,6 +647,91 @@ void IMB_buffer_byte_from_byte(uchar *rect_to, const uchar *rect_from,
 
 /****************************** ImBuf Conversion *****************************/
 
+/* smaller images are converted on the calling thread, not worth the threading overhead */
+#define IMB_CONVERT_THREADED_MIN_PIXELS (256 * 256)
+
+typedef struct ConvertThread {
+	ImBuf *ibuf;
+	float *buffer;
+	int start_line;
+	int tot_line;
+	bool premultiply;
+} ConvertThread;
+
+typedef struct ConvertInitData {
+	ImBuf *ibuf;
+	float *buffer;
+	bool premultiply;
+} ConvertInitData;
+
+static void convert_init_handle(void *handle_v, int start_line, int tot_line, void *init_data_v)
+{
+	ConvertThread *handle = (ConvertThread *) handle_v;
+	ConvertInitData *init_data = (ConvertInitData *) init_data_v;
+
+	handle->ibuf = init_data->ibuf;
+	handle->buffer = init_data->buffer;
+	handle->start_line = start_line;
+	handle->tot_line = tot_line;
+	handle->premultiply = init_data->premultiply;
+}
+
+static void convert_apply_threaded(ImBuf *ibuf, float *buffer, bool premultiply, void *(do_thread) (void *))
+{
+	ConvertInitData init_data;
+
+	init_data.ibuf = ibuf;
+	init_data.buffer = buffer;
+	init_data.premultiply = premultiply;
+
+	if (((size_t)ibuf->x) * ibuf->y < IMB_CONVERT_THREADED_MIN_PIXELS) {
+		ConvertThread handle;
+
+		convert_init_handle(&handle, 0, ibuf->y, &init_data);
+		do_thread(&handle);
+	}
+	else {
+		IMB_processor_apply_threaded(ibuf->y, sizeof(ConvertThread), &init_data,
+		                             convert_init_handle, do_thread);
+	}
+}
+
+static void *do_rect_from_float_thread(void *handle_v)
+{
+	ConvertThread *handle = (ConvertThread *) handle_v;
+	ImBuf *ibuf = handle->ibuf;
+	size_t offset = ((size_t)ibuf->channels) * handle->start_line * ibuf->x;
+
+	/* convert from float's premul alpha to byte's straight alpha */
+	IMB_unpremultiply_rect_float(handle->buffer + offset, ibuf->channels, ibuf->x, handle->tot_line);
+
+	/* convert float to byte */
+	buffer_byte_from_float_lines((unsigned char *) ibuf->rect, handle->buffer, ibuf->channels, ibuf->dither,
+	                             IB_PROFILE_SRGB, IB_PROFILE_SRGB, false, ibuf->x, ibuf->y, ibuf->x, ibuf->x,
+	                             handle->start_line, handle->tot_line);
+
+	return NULL;
+}
+
+static void *do_float_from_rect_thread(void *handle_v)
+{
+	ConvertThread *handle = (ConvertThread *) handle_v;
+	ImBuf *ibuf = handle->ibuf;
+	size_t offset = ((size_t)handle->start_line) * ibuf->x;
+
+	if (handle->premultiply) {
+		/* byte buffer is straight alpha, float should always be premul */
+		IMB_premultiply_rect_float(handle->buffer + offset * ibuf->channels, ibuf->channels, ibuf->x, handle->tot_line);
+	}
+	else {
+		IMB_buffer_float_from_byte(handle->buffer + offset * 4, (unsigned char *) (ibuf->rect + offset),
+		                           IB_PROFILE_SRGB, IB_PROFILE_SRGB, false,
+		                           ibuf->x, handle->tot_line, ibuf->x, ibuf->x);
+	}
+
+	return NULL;
+}
+
 void IMB_rect_from_float(ImBuf *ibuf)
 {
 	float *buffer;
@@ -661,12 +757,8 @@ void IMB_rect_from_float(ImBuf *ibuf)
 	/* first make float buffer in byte space */
 	IMB_colormanagement_transform(buffer, ibuf->x, ibuf->y, ibuf->channels, from_colorspace, ibuf->rect_colorspace->name, true);
 
-	/* convert from float's premul alpha to byte's straight alpha */
-	IMB_unpremultiply_rect_float(buffer, ibuf->channels, ibuf->x, ibuf->y);
-
-	/* convert float to byte */
-	IMB_buffer_byte_from_float((unsigned char *) ibuf->rect, buffer, ibuf->channels, ibuf->dither, IB_PROFILE_SRGB, IB_PROFILE_SRGB,
-	                           false, ibuf->x, ibuf->y, ibuf->x, ibuf->x);
+	/* unpremultiply and convert float to byte */
+	convert_apply_threaded(ibuf, buffer, false, do_rect_from_float_thread);
 
 	MEM_freeN(buffer);
 
@@ -747,15 +839,14 @@ void IMB_float_from_rect(ImBuf *ibuf)
 	}
 
 	/* first, create float buffer in non-linear space */
-	IMB_buffer_float_from_byte(rect_float, (unsigned char *) ibuf->rect, IB_PROFILE_SRGB, IB_PROFILE_SRGB,
-	                           false, ibuf->x, ibuf->y, ibuf->x, ibuf->x);
+	convert_apply_threaded(ibuf, rect_float, false, do_float_from_rect_thread);
 
 	/* then make float be in linear space */
 	IMB_colormanagement_colorspace_to_scene_linear(rect_float, ibuf->x, ibuf->y, ibuf->channels,
 	                                               ibuf->rect_colorspace, false);
 
 	/* byte buffer is straight alpha, float should always be premul */
-	IMB_premultiply_rect_float(rect_float, ibuf->channels, ibuf->x, ibuf->y);
+	convert_apply_threaded(ibuf, rect_float, true, do_float_from_rect_thread);
 
 	if (ibuf->rect_float == NULL) {
 		ibuf->rect_float = rect_float;
@@ -36,6 +36,8 @@
 #include "BLI_string.h"
 #include "BLI_fileops.h"
 #include "BLI_ghash.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "IMB_indexer.h"
 #include "IMB_anim.h"
@@ -540,6 +542,11 @@ static struct proxy_output_ctx *alloc_proxy_output_ffmpeg(
 		rv->c->flags |= CODEC_FLAG_GLOBAL_HEADER;
 	}
 
+	/* JPEG frames are independent, let the encoder use all cores */
+	if (rv->codec->capabilities & (CODEC_CAP_FRAME_THREADS | CODEC_CAP_SLICE_THREADS)) {
+		rv->c->thread_count = BLI_system_thread_count();
+	}
+
 	if (avio_open(&rv->of->pb, fname, AVIO_FLAG_WRITE) < 0) {
 		fprintf(stderr, "Couldn't open outputfile! "
 		        "Proxy not built!\n");
@@ -842,20 +849,42 @@ static void index_rebuild_ffmpeg_finish(FFmpegIndexBuilderContext *context, int
 	MEM_freeN(context);
 }
 
+typedef struct ProxyOutputData {
+	FFmpegIndexBuilderContext *context;
+	AVFrame *in_frame;
+} ProxyOutputData;
+
+static void index_rebuild_ffmpeg_proxy_output_func(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	ProxyOutputData *data = (ProxyOutputData *)userdata;
+
+	add_to_proxy_output_ffmpeg(data->context->proxy_ctx[i], data->in_frame);
+}
+
 static void index_rebuild_ffmpeg_proc_decoded_frame(
 	FFmpegIndexBuilderContext *context, 
 	AVPacket * curr_packet,
 	AVFrame *in_frame)
 {
-	int i;
+	int i, num_outputs = 0;
 	unsigned long long s_pos = context->seek_pos;
 	unsigned long long s_dts = context->seek_pos_dts;
 	unsigned long long pts = av_get_pts_from_frame(context->iFormatCtx, in_frame);
+	ProxyOutputData data;
 
+	/* every proxy size has its own scaler and encoder, they all read the same decoded frame */
 	for (i = 0; i < context->num_proxy_sizes; i++) {
-		add_to_proxy_output_ffmpeg(context->proxy_ctx[i], in_frame);
+		if (context->proxy_ctx[i]) {
+			num_outputs++;
+		}
 	}
 
+	data.context = context;
+	data.in_frame = in_frame;
+
+	BLI_task_parallel_range_ex(0, context->num_proxy_sizes, &data, NULL, 0,
+	                           index_rebuild_ffmpeg_proxy_output_func, num_outputs > 1, false);
+
 	if (!context->start_pts_set) {
 		context->start_pts = pts;
 		context->start_pts_set = true;
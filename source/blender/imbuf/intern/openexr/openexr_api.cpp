@@ -62,6 +62,7 @@ _CRTIMP void __cdecl _invalid_parameter_noinfo(void)
 #include "BLI_blenlib.h"
 #include "BLI_math_color.h"
 #include "BLI_threads.h"
+#include "BLI_task.h"
 
 #include "BKE_idprop.h"
 #include "BKE_image.h"
@@ -93,6 +94,8 @@ _CRTIMP void __cdecl _invalid_parameter_noinfo(void)
 #include <ImfCompressionAttribute.h>
 #include <ImfStringAttribute.h>
 #include <ImfStandardAttributes.h>
+#include <ImfRgbaFile.h>
+#include <ImfPreviewImage.h>
 
 /* multiview/multipart */
 #include <ImfMultiView.h>
@@ -1095,6 +1098,24 @@ void IMB_exr_clear_channels(void *handle)
 	BLI_freelistN(&data->channels);
 }
 
+typedef struct ExrHalfConvertData {
+	const float *rect;
+	half *rect_half;
+	int xstride;
+	int width;
+} ExrHalfConvertData;
+
+static void exr_half_convert_cb(void *userdata, void *UNUSED(userdata_chunk), int y)
+{
+	ExrHalfConvertData *data = (ExrHalfConvertData *)userdata;
+	const float *rect = data->rect + (size_t)y * data->width * data->xstride;
+	half *cur = data->rect_half + (size_t)y * data->width;
+
+	for (int x = 0; x < data->width; x++, rect += data->xstride) {
+		cur[x] = *rect;
+	}
+}
+
 void IMB_exr_write_channels(void *handle)
 {
 	ExrHandle *data = (ExrHandle *)handle;
@@ -1114,11 +1135,17 @@ void IMB_exr_write_channels(void *handle)
 		for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
 			/* Writting starts from last scanline, stride negative. */
 			if (echan->use_half_float) {
-				float *rect = echan->rect;
-				half *cur = current_rect_half;
-				for (size_t i = 0; i < num_pixels; ++i, ++cur) {
-					*cur = rect[i * echan->xstride];
-				}
+				ExrHalfConvertData convert_data;
+				convert_data.rect = echan->rect;
+				convert_data.rect_half = current_rect_half;
+				convert_data.xstride = echan->xstride;
+				convert_data.width = data->width;
+
+				/* Converting many large passes is a good part of the saving time,
+				 * OpenEXR's own threads only do the compression. */
+				BLI_task_parallel_range_ex(0, data->height, &convert_data, NULL, 0, exr_half_convert_cb,
+				                           num_pixels >= 64 * 1024, false);
+
 				half *rect_to_write = current_rect_half + (data->height - 1) * data->width;
 				frameBuffer.insert(echan->name, Slice(Imf::HALF,  (char *)rect_to_write,
 				                                      sizeof(half), -data->width * sizeof(half)));
@@ -2102,6 +2129,97 @@ struct ImBuf *imb_load_openexr(const unsigned char *mem, size_t size, int flags,
 
 }
 
+/* Loads the preview image embedded in the header when there is one, otherwise reads only the scanlines
+ * needed for a nearest-neighbour reduction to max_thumb_size, which skips decoding most of the blocks */
+struct ImBuf *imb_load_filepath_thumbnail_openexr(const char *filepath, const int flags,
+                                                  const size_t max_thumb_size, char colorspace[IM_MAX_SPACE],
+                                                  size_t *r_width, size_t *r_height)
+{
+	struct ImBuf *ibuf = NULL;
+	IStream *stream = NULL;
+	RgbaInputFile *file = NULL;
+
+	try
+	{
+		stream = new IFileStream(filepath);
+		file = new RgbaInputFile(*stream);
+
+		Box2i dw = file->dataWindow();
+		const int source_w = dw.max.x - dw.min.x + 1;
+		const int source_h = dw.max.y - dw.min.y + 1;
+
+		*r_width = source_w;
+		*r_height = source_h;
+
+		if (file->header().hasPreviewImage()) {
+			const PreviewImage &preview = file->header().previewImage();
+			const int preview_w = preview.width();
+			const int preview_h = preview.height();
+
+			/* preview pixels are stored as display referred bytes, top to bottom */
+			colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_BYTE);
+
+			ibuf = IMB_allocImBuf(preview_w, preview_h, 32, IB_rect);
+			for (int y = 0; y < preview_h; y++) {
+				unsigned char *rect = (unsigned char *)(ibuf->rect + (size_t)(preview_h - 1 - y) * preview_w);
+				const PreviewRgba *pixel = preview.pixels() + (size_t)y * preview_w;
+
+				for (int x = 0; x < preview_w; x++, pixel++, rect += 4) {
+					rect[0] = pixel->r;
+					rect[1] = pixel->g;
+					rect[2] = pixel->b;
+					rect[3] = pixel->a;
+				}
+			}
+		}
+		else if (file->channels() & (WRITE_RGB | WRITE_Y)) {
+			const float scale = (float)max_thumb_size / (float)std::max(source_w, source_h);
+			const int dest_w = (scale < 1.0f) ? std::max((int)(source_w * scale), 1) : source_w;
+			const int dest_h = (scale < 1.0f) ? std::max((int)(source_h * scale), 1) : source_h;
+			Array<Rgba> pixels(source_w);
+
+			colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_FLOAT);
+
+			ibuf = IMB_allocImBuf(dest_w, dest_h, 32, IB_rectfloat);
+			ibuf->ftype = IMB_FTYPE_OPENEXR;
+
+			if (flags & IB_alphamode_detect)
+				ibuf->flags |= IB_alphamode_premul;
+
+			/* zero y stride, every scanline we read goes into the same row buffer */
+			file->setFrameBuffer(&pixels[0] - dw.min.x, 1, 0);
+
+			for (int y = 0; y < dest_h; y++) {
+				const int source_y = dw.min.y + std::min((int)(((float)y + 0.5f) * source_h / dest_h), source_h - 1);
+				float *rect_float = ibuf->rect_float + (size_t)(dest_h - 1 - y) * dest_w * 4;
+
+				file->readPixels(source_y);
+
+				for (int x = 0; x < dest_w; x++, rect_float += 4) {
+					const int source_x = std::min((int)(((float)x + 0.5f) * source_w / dest_w), source_w - 1);
+					const Rgba &pixel = pixels[source_x];
+
+					rect_float[0] = pixel.r;
+					rect_float[1] = pixel.g;
+					rect_float[2] = pixel.b;
+					rect_float[3] = pixel.a;
+				}
+			}
+		}
+	}
+	catch (const std::exception& exc)
+	{
+		std::cerr << exc.what() << std::endl;
+		if (ibuf) IMB_freeImBuf(ibuf);
+		ibuf = NULL;
+	}
+
+	delete file;
+	delete stream;
+
+	return ibuf;
+}
+
 void imb_initopenexr(void)
 {
 	int num_threads = BLI_system_thread_count();
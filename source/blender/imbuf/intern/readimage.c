@@ -265,6 +265,51 @@ ImBuf *IMB_testiffname(const char *filepath, int flags)
 	return ibuf;
 }
 
+/* Load an image to make a thumbnail from, using the cheaper reduced loading of the file type when
+ * it has one. The result is at least max_thumb_size large when the image is, r_width/r_height
+ * get the size of the full image. */
+ImBuf *IMB_thumb_load_image(const char *filepath, size_t max_thumb_size, char colorspace[IM_MAX_SPACE],
+                            size_t *r_width, size_t *r_height)
+{
+	const int flags = IB_rect | IB_metadata;
+	const int ftype = IMB_ispic_type(filepath);
+	const ImFileType *type;
+	ImBuf *ibuf = NULL;
+
+	BLI_assert(!BLI_path_is_rel(filepath));
+
+	if (ftype == 0) {
+		return NULL;
+	}
+
+	for (type = IMB_FILE_TYPES; type < IMB_FILE_TYPES_LAST; type++) {
+		if (type->filetype == ftype && type->load_filepath_thumbnail) {
+			char effective_colorspace[IM_MAX_SPACE] = "";
+
+			if (colorspace)
+				BLI_strncpy(effective_colorspace, colorspace, sizeof(effective_colorspace));
+
+			ibuf = type->load_filepath_thumbnail(filepath, flags, max_thumb_size, effective_colorspace,
+			                                     r_width, r_height);
+			if (ibuf) {
+				imb_handle_alpha(ibuf, flags, colorspace, effective_colorspace);
+				BLI_strncpy(ibuf->name, filepath, sizeof(ibuf->name));
+			}
+			break;
+		}
+	}
+
+	if (ibuf == NULL) {
+		ibuf = IMB_loadiffname(filepath, flags, colorspace);
+		if (ibuf) {
+			*r_width = (size_t)ibuf->x;
+			*r_height = (size_t)ibuf->y;
+		}
+	}
+
+	return ibuf;
+}
+
 static void imb_loadtilefile(ImBuf *ibuf, int file, int tx, int ty, unsigned int *rect)
 {
 	const ImFileType *type;
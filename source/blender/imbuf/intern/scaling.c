@@ -31,6 +31,7 @@
  *  \ingroup imbuf
  */
 
+#include <string.h>
 
 #include "BLI_utildefines.h"
 #include "BLI_math_color.h"
@@ -45,6 +46,10 @@
 
 #include "BLI_sys_types.h" // for intptr_t support
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 /************************************************************************/
 /*								SCALING									*/
 /************************************************************************/
@@ -881,6 +886,168 @@ static bool q_scale_linear_interpolation(
 	return true;
 }
 
+#ifdef __SSE2__
+BLI_INLINE __m128 scaledown_load_uchar4(const uchar *rect)
+{
+	const __m128i zero = _mm_setzero_si128();
+	int pixel;
+	__m128i v;
+
+	memcpy(&pixel, rect, sizeof(pixel));
+	v = _mm_unpacklo_epi8(_mm_cvtsi32_si128(pixel), zero);
+	v = _mm_unpacklo_epi16(v, zero);
+	return _mm_cvtepi32_ps(v);
+}
+
+BLI_INLINE void scaledown_store_uchar4(uchar *rect, const __m128 val)
+{
+	/* truncates like the float to uchar conversion of the scalar code */
+	__m128i v = _mm_cvttps_epi32(val);
+	int pixel;
+
+	v = _mm_packs_epi32(v, v);
+	v = _mm_packus_epi16(v, v);
+	pixel = _mm_cvtsi128_si32(v);
+	memcpy(rect, &pixel, sizeof(pixel));
+}
+#endif
+
+/**
+ * Box filter one line of RGBA pixels down to \a newlen pixels, for both the byte and float buffer
+ * when they're not NULL. Pixels of the line are \a stride elements apart, in the source as well
+ * as in the destination, so this works for rows and columns.
+ *
+ * The source pointers are advanced past the pixels which were read.
+ */
+static void scaledown_line(uchar **r_rect, float **r_rectf, uchar *newrect, float *newrectf,
+                           const int newlen, const size_t stride, const float add)
+{
+	uchar *rect = *r_rect;
+	float *rectf = *r_rectf;
+	float sample = 0.0f;
+	int x;
+#ifdef __SSE2__
+	/* all four channels at once, same operations as the scalar code so the result is identical */
+	const __m128 sign_mask = _mm_set1_ps(-0.0f);
+	const __m128 add_v = _mm_set1_ps(add);
+	const __m128 half_v = _mm_set1_ps(0.5f);
+	__m128 val = _mm_setzero_ps(), valf = _mm_setzero_ps();
+	__m128 nval, nvalf, sample_v;
+
+	for (x = newlen; x > 0; x--) {
+		sample_v = _mm_set1_ps(sample);
+		nval = _mm_mul_ps(_mm_xor_ps(val, sign_mask), sample_v);
+		nvalf = _mm_mul_ps(_mm_xor_ps(valf, sign_mask), sample_v);
+
+		sample += add;
+
+		while (sample >= 1.0f) {
+			sample -= 1.0f;
+
+			if (rect) {
+				nval = _mm_add_ps(nval, scaledown_load_uchar4(rect));
+				rect += stride;
+			}
+			if (rectf) {
+				nvalf = _mm_add_ps(nvalf, _mm_loadu_ps(rectf));
+				rectf += stride;
+			}
+		}
+
+		sample_v = _mm_set1_ps(sample);
+
+		if (rect) {
+			val = scaledown_load_uchar4(rect);
+			rect += stride;
+
+			scaledown_store_uchar4(newrect, _mm_add_ps(_mm_div_ps(_mm_add_ps(nval, _mm_mul_ps(sample_v, val)),
+			                                                      add_v), half_v));
+			newrect += stride;
+		}
+		if (rectf) {
+			valf = _mm_loadu_ps(rectf);
+			rectf += stride;
+
+			_mm_storeu_ps(newrectf, _mm_div_ps(_mm_add_ps(nvalf, _mm_mul_ps(sample_v, valf)), add_v));
+			newrectf += stride;
+		}
+
+		sample -= 1.0f;
+	}
+#else
+	float val[4], nval[4], valf[4], nvalf[4];
+
+	val[0] =  val[1] = val[2] = val[3] = 0.0f;
+	valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
+	nval[0] =  nval[1] = nval[2] = nval[3] = 0.0f;
+	nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
+
+	for (x = newlen; x > 0; x--) {
+		if (rect) {
+			nval[0] = -val[0] * sample;
+			nval[1] = -val[1] * sample;
+			nval[2] = -val[2] * sample;
+			nval[3] = -val[3] * sample;
+		}
+		if (rectf) {
+			nvalf[0] = -valf[0] * sample;
+			nvalf[1] = -valf[1] * sample;
+			nvalf[2] = -valf[2] * sample;
+			nvalf[3] = -valf[3] * sample;
+		}
+
+		sample += add;
+
+		while (sample >= 1.0f) {
+			sample -= 1.0f;
+
+			if (rect) {
+				nval[0] += rect[0];
+				nval[1] += rect[1];
+				nval[2] += rect[2];
+				nval[3] += rect[3];
+				rect += stride;
+			}
+			if (rectf) {
+				nvalf[0] += rectf[0];
+				nvalf[1] += rectf[1];
+				nvalf[2] += rectf[2];
+				nvalf[3] += rectf[3];
+				rectf += stride;
+			}
+		}
+
+		if (rect) {
+			val[0] = rect[0]; val[1] = rect[1]; val[2] = rect[2]; val[3] = rect[3];
+			rect += stride;
+
+			newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
+			newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
+			newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
+			newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
+
+			newrect += stride;
+		}
+		if (rectf) {
+			valf[0] = rectf[0]; valf[1] = rectf[1]; valf[2] = rectf[2]; valf[3] = rectf[3];
+			rectf += stride;
+
+			newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
+			newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
+			newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
+			newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
+
+			newrectf += stride;
+		}
+
+		sample -= 1.0f;
+	}
+#endif
+
+	*r_rect = rect;
+	*r_rectf = rectf;
+}
+
 static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
 {
 	const int do_rect = (ibuf->rect != NULL);
@@ -889,13 +1056,11 @@ static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
 
 	uchar *rect, *_newrect, *newrect;
 	float *rectf, *_newrectf, *newrectf;
-	float sample, add, val[4], nval[4], valf[4], nvalf[4];
-	int x, y;
+	float add;
+	int y;
 
 	rectf = _newrectf = newrectf = NULL;
 	rect = _newrect = newrect = NULL;
-	nval[0] =  nval[1] = nval[2] = nval[3] = 0.0f;
-	nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
 
 	if (!do_rect && !do_float) return (ibuf);
 
@@ -923,71 +1088,10 @@ static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
 	}
 		
 	for (y = ibuf->y; y > 0; y--) {
-		sample = 0.0f;
-		val[0] =  val[1] = val[2] = val[3] = 0.0f;
-		valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-		for (x = newx; x > 0; x--) {
-			if (do_rect) {
-				nval[0] = -val[0] * sample;
-				nval[1] = -val[1] * sample;
-				nval[2] = -val[2] * sample;
-				nval[3] = -val[3] * sample;
-			}
-			if (do_float) {
-				nvalf[0] = -valf[0] * sample;
-				nvalf[1] = -valf[1] * sample;
-				nvalf[2] = -valf[2] * sample;
-				nvalf[3] = -valf[3] * sample;
-			}
-			
-			sample += add;
+		scaledown_line(&rect, &rectf, newrect, newrectf, newx, 4, add);
 
-			while (sample >= 1.0f) {
-				sample -= 1.0f;
-				
-				if (do_rect) {
-					nval[0] += rect[0];
-					nval[1] += rect[1];
-					nval[2] += rect[2];
-					nval[3] += rect[3];
-					rect += 4;
-				}
-				if (do_float) {
-					nvalf[0] += rectf[0];
-					nvalf[1] += rectf[1];
-					nvalf[2] += rectf[2];
-					nvalf[3] += rectf[3];
-					rectf += 4;
-				}
-			}
-			
-			if (do_rect) {
-				val[0] = rect[0]; val[1] = rect[1]; val[2] = rect[2]; val[3] = rect[3];
-				rect += 4;
-				
-				newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
-				newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
-				newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
-				newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
-				
-				newrect += 4;
-			}
-			if (do_float) {
-				
-				valf[0] = rectf[0]; valf[1] = rectf[1]; valf[2] = rectf[2]; valf[3] = rectf[3];
-				rectf += 4;
-				
-				newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-				newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-				newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-				newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-				
-				newrectf += 4;
-			}
-			
-			sample -= 1.0f;
-		}
+		if (do_rect) newrect += 4 * newx;
+		if (do_float) newrectf += 4 * newx;
 	}
 
 	if (do_rect) {
@@ -1019,13 +1123,11 @@ static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
 
 	uchar *rect, *_newrect, *newrect;
 	float *rectf, *_newrectf, *newrectf;
-	float sample, add, val[4], nval[4], valf[4], nvalf[4];
-	int x, y, skipx;
+	float add;
+	int x, skipx;
 
 	rectf = _newrectf = newrectf = NULL;
 	rect = _newrect = newrect = NULL;
-	nval[0] =  nval[1] = nval[2] = nval[3] = 0.0f;
-	nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
 
 	if (!do_rect && !do_float) return (ibuf);
 
@@ -1054,71 +1156,7 @@ static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
 			newrectf = _newrectf + x;
 		}
 		
-		sample = 0.0f;
-		val[0] =  val[1] = val[2] = val[3] = 0.0f;
-		valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-		for (y = newy; y > 0; y--) {
-			if (do_rect) {
-				nval[0] = -val[0] * sample;
-				nval[1] = -val[1] * sample;
-				nval[2] = -val[2] * sample;
-				nval[3] = -val[3] * sample;
-			}
-			if (do_float) {
-				nvalf[0] = -valf[0] * sample;
-				nvalf[1] = -valf[1] * sample;
-				nvalf[2] = -valf[2] * sample;
-				nvalf[3] = -valf[3] * sample;
-			}
-			
-			sample += add;
-
-			while (sample >= 1.0f) {
-				sample -= 1.0f;
-				
-				if (do_rect) {
-					nval[0] += rect[0];
-					nval[1] += rect[1];
-					nval[2] += rect[2];
-					nval[3] += rect[3];
-					rect += skipx;
-				}
-				if (do_float) {
-					nvalf[0] += rectf[0];
-					nvalf[1] += rectf[1];
-					nvalf[2] += rectf[2];
-					nvalf[3] += rectf[3];
-					rectf += skipx;
-				}
-			}
-
-			if (do_rect) {
-				val[0] = rect[0]; val[1] = rect[1]; val[2] = rect[2]; val[3] = rect[3];
-				rect += skipx;
-				
-				newrect[0] = ((nval[0] + sample * val[0]) / add + 0.5f);
-				newrect[1] = ((nval[1] + sample * val[1]) / add + 0.5f);
-				newrect[2] = ((nval[2] + sample * val[2]) / add + 0.5f);
-				newrect[3] = ((nval[3] + sample * val[3]) / add + 0.5f);
-				
-				newrect += skipx;
-			}
-			if (do_float) {
-				
-				valf[0] = rectf[0]; valf[1] = rectf[1]; valf[2] = rectf[2]; valf[3] = rectf[3];
-				rectf += skipx;
-				
-				newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-				newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-				newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-				newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-				
-				newrectf += skipx;
-			}
-			
-			sample -= 1.0f;
-		}
+		scaledown_line(&rect, &rectf, newrect, newrectf, newy, (size_t)skipx, add);
 	}
 
 	if (do_rect) {
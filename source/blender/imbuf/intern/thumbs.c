@@ -322,6 +322,7 @@ static ImBuf *thumb_create_ex(
 	short tsize = 128;
 	short ex, ey;
 	float scaledx, scaledy;
+	size_t source_w = 0, source_h = 0;
 	BLI_stat_t info;
 
 	switch (size) {
@@ -364,7 +365,7 @@ static ImBuf *thumb_create_ex(
 				if (img == NULL) {
 					switch (source) {
 						case THB_SOURCE_IMAGE:
-							img = IMB_loadiffname(file_path, IB_rect | IB_metadata, NULL);
+							img = IMB_thumb_load_image(file_path, (size_t)tsize, NULL, &source_w, &source_h);
 							break;
 						case THB_SOURCE_BLEND:
 							img = IMB_thumb_load_blend(file_path, blen_group, blen_id);
@@ -381,8 +382,13 @@ static ImBuf *thumb_create_ex(
 					if (BLI_stat(file_path, &info) != -1) {
 						BLI_snprintf(mtime, sizeof(mtime), "%ld", (long int)info.st_mtime);
 					}
-					BLI_snprintf(cwidth, sizeof(cwidth), "%d", img->x);
-					BLI_snprintf(cheight, sizeof(cheight), "%d", img->y);
+					/* the image may have been loaded reduced already */
+					if (source_w == 0) {
+						source_w = (size_t)img->x;
+						source_h = (size_t)img->y;
+					}
+					BLI_snprintf(cwidth, sizeof(cwidth), "%d", (int)source_w);
+					BLI_snprintf(cheight, sizeof(cheight), "%d", (int)source_h);
 				}
 			}
 			else if (THB_SOURCE_MOVIE == source) {
@@ -110,6 +110,7 @@ typedef struct ModifierData {
 	struct Scene *scene;
 
 	char *error;
+	void *stack_cache;  /* runtime only, result of this modifier kept by mesh_calc_modifiers */
 } ModifierData;
 
 typedef enum {
@@ -117,6 +118,7 @@ typedef enum {
 	eSubsurfModifierFlag_DebugIncr    = (1 << 1),
 	eSubsurfModifierFlag_ControlEdges = (1 << 2),
 	eSubsurfModifierFlag_SubsurfUv    = (1 << 3),
+	eSubsurfModifierFlag_AdaptiveRender = (1 << 4),
 } SubsurfModifierFlag;
 
 /* not a real modifier */
@@ -134,7 +136,8 @@ typedef struct SubsurfModifierData {
 	ModifierData modifier;
 
 	short subdivType, levels, renderLevels, flags;
-	short use_opensubdiv, pad[3];
+	short use_opensubdiv, pad;
+	float dicing_rate;  /* edge length in pixels for eSubsurfModifierFlag_AdaptiveRender */
 
 	void *emCache, *mCache;
 } SubsurfModifierData;
@@ -641,7 +644,8 @@ typedef struct BooleanModifierData {
 
 	struct Object *object;
 	char operation;
-	char bm_flag, pad[2];
+	char solver;
+	char bm_flag, pad;
 	float threshold;
 } BooleanModifierData;
 
@@ -651,9 +655,14 @@ typedef enum {
 	eBooleanModifierOp_Difference = 2,
 } BooleanModifierOp;
 
-/* temp bm_flag (debugging only) */
+typedef enum {
+	eBooleanModifierSolver_Carve    = 0,
+	eBooleanModifierSolver_BMesh    = 1,
+} BooleanSolver;
+
+/* bm_flag, options for eBooleanModifierSolver_BMesh */
 enum {
-	eBooleanModifierBMeshFlag_Enabled                   = (1 << 0),
+	eBooleanModifierBMeshFlag_Enabled                   = (1 << 0),  /* deprecated, now 'solver' */
 	eBooleanModifierBMeshFlag_BMesh_Separate            = (1 << 1),
 	eBooleanModifierBMeshFlag_BMesh_NoDissolve          = (1 << 2),
 	eBooleanModifierBMeshFlag_BMesh_NoConnectRegions    = (1 << 3),
@@ -438,6 +438,7 @@ typedef struct UserDef {
 	char renderdir[1024]; /* FILE_MAX length */
 	/* EXR cache path */
 	char render_cachedir[768];  /* 768 = FILE_MAXDIR */
+	char sequencer_disk_cache_dir[768];  /* 768 = FILE_MAXDIR */
 	char textudir[768];
 	char pythondir[768];
 	char sounddir[768];
@@ -492,6 +493,8 @@ typedef struct UserDef {
 	short dragthreshold;
 	int memcachelimit;
 	int prefetchframes;
+	int sequencer_disk_cache_limit;  /* megabytes, 0 for no limit */
+	int pad3;
 	float pad_rot_angle; /* control the rotation step of the view when PAD2, PAD4, PAD6&PAD8 is use */
 	short frameserverport;
 	short pad4;
@@ -881,7 +884,7 @@ typedef enum eMultiSample_Type {
 } eMultiSample_Type;
 	
 typedef enum eImageDrawMethod {
-	/* IMAGE_DRAW_METHOD_AUTO = 0, */ /* Currently unused */
+	IMAGE_DRAW_METHOD_AUTO = 0,  /* GLSL when supported, 2D texture otherwise */
 	IMAGE_DRAW_METHOD_GLSL = 1,
 	IMAGE_DRAW_METHOD_2DTEXTURE = 2,
 	IMAGE_DRAW_METHOD_DRAWPIXELS = 3,
@@ -266,12 +266,13 @@ typedef struct View3D {
 #define RV3D_CLIPPING				4
 #define RV3D_NAVIGATING				8
 #define RV3D_GPULIGHT_UPDATE		16
-#define RV3D_IS_GAME_ENGINE			32  /* runtime flag, used to check if LoD's should be used */
+#define RV3D_IS_GAME_ENGINE			32  /* runtime flag, used for game engine only display */
 /**
  * Disable zbuffer offset, skip calls to #ED_view3d_polygon_offset.
  * Use when precise surface depth is needed and picking bias isn't, see T45434).
  */
 #define RV3D_ZOFFSET_DISABLED		64
+#define RV3D_USE_LOD				128  /* runtime flag, used to check if LoD's should be used */
 
 /* RegionView3d->viewlock */
 #define RV3D_LOCKED			(1 << 0)
@@ -312,6 +313,7 @@ typedef struct View3D {
 
 /* View3d->flag3 (short) */
 #define V3D_SHOW_WORLD			(1 << 0)
+#define V3D_SHOW_LOD			(1 << 1)
 
 /* View3D->around */
 enum {
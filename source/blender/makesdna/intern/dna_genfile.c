@@ -302,11 +302,13 @@ static short *findstruct_name(SDNA *sdna, const char *str)
 int DNA_struct_find_nr(SDNA *sdna, const char *str)
 {
 	const short *sp = NULL;
+	/* read once, other threads reading the file may change it (see read_structs_reconstruct_threaded) */
+	const int lastfind = sdna->lastfind;
 
-	if (sdna->lastfind < sdna->nr_structs) {
-		sp = sdna->structs[sdna->lastfind];
+	if (lastfind < sdna->nr_structs) {
+		sp = sdna->structs[lastfind];
 		if (strcmp(sdna->types[sp[0]], str) == 0) {
-			return sdna->lastfind;
+			return lastfind;
 		}
 	}
 
@@ -844,6 +844,9 @@ void RNA_property_update(struct bContext *C, PointerRNA *ptr, PropertyRNA *prop)
 void RNA_property_update_main(struct Main *bmain, struct Scene *scene, PointerRNA *ptr, PropertyRNA *prop);
 bool RNA_property_update_check(struct PropertyRNA *prop);
 
+void RNA_property_update_batch_begin(void);
+void RNA_property_update_batch_end(void);
+
 void RNA_property_update_cache_add(PointerRNA *ptr, PropertyRNA *prop);
 void RNA_property_update_cache_flush(struct Main *bmain, struct Scene *scene);
 void RNA_property_update_cache_free(void);
@@ -64,6 +64,8 @@
 #include "BKE_depsgraph.h"
 #include "WM_types.h"
 
+#include "DEG_depsgraph.h"
+
 #include "rna_internal.h"
 
 const PointerRNA PointerRNA_NULL = {{NULL}};
@@ -1663,11 +1665,19 @@ bool RNA_property_path_from_ID_check(PointerRNA *ptr, PropertyRNA *prop)
 }
 
 
+static bool rna_property_update_batch_add(Main *bmain, Scene *scene, PointerRNA *ptr, PropertyRNA *prop);
+
 static void rna_property_update(bContext *C, Main *bmain, Scene *scene, PointerRNA *ptr, PropertyRNA *prop)
 {
 	const bool is_rna = (prop->magic == RNA_MAGIC);
+	PropertyRNA *idprop = is_rna ? NULL : prop;
 	prop = rna_ensure_property(prop);
 
+	/* deferred to the end of the batch */
+	if (rna_property_update_batch_add(bmain, scene, ptr, is_rna ? prop : idprop)) {
+		return;
+	}
+
 	if (is_rna) {
 		if (prop->update) {
 			/* ideally no context would be needed for update, but there's some
@@ -1692,7 +1702,18 @@ static void rna_property_update(bContext *C, Main *bmain, Scene *scene, PointerR
 	if (!is_rna || (prop->flag & PROP_IDPROPERTY)) {
 		/* WARNING! This is so property drivers update the display!
 		 * not especially nice  */
-		DAG_id_tag_update(ptr->id.data, OB_RECALC_OB | OB_RECALC_DATA | OB_RECALC_TIME);
+		if (idprop != NULL
+#ifdef WITH_LEGACY_DEPSGRAPH
+		    && !DEG_depsgraph_use_legacy()
+#endif
+		    )
+		{
+			/* Only re-evaluate the drivers reading the custom property. */
+			DEG_property_tag_update(bmain, ptr, idprop);
+		}
+		else {
+			DAG_id_tag_update(ptr->id.data, OB_RECALC_OB | OB_RECALC_DATA | OB_RECALC_TIME);
+		}
 		WM_main_add_notifier(NC_WINDOW, NULL);
 		/* Not nice as well, but the only way to make sure material preview
 		 * is updated with custom nodes.
@@ -1725,6 +1746,131 @@ void RNA_property_update_main(Main *bmain, Scene *scene, PointerRNA *ptr, Proper
 }
 
 
+/* RNA Update Batches ------------------------ */
+/* While a batch is active (e.g. a script setting many properties) the updates of properties
+ * which don't need the context are deferred until the batch ends.
+ * Each update function then runs once per struct, even when several of its properties were set,
+ * which avoids redundant expensive updates and depsgraph tagging.
+ *
+ * The data whose properties were set must not be freed before the batch ends.
+ */
+
+typedef struct tRnaUpdateBatchElem {
+	struct tRnaUpdateBatchElem *next, *prev;
+
+	Main *bmain;
+	Scene *scene;
+	PointerRNA ptr;
+	UpdateFunc update;
+	int noteflag;
+} tRnaUpdateBatchElem;
+
+static struct {
+	int level;
+	/* the deferred updates in the order they were added */
+	ListBase elems;
+	/* tRnaUpdateBatchElem's, to only add each update once */
+	GSet *elems_set;
+} rna_update_batch = {0};
+
+static unsigned int rna_update_batch_elem_hash(const void *key)
+{
+	const tRnaUpdateBatchElem *elem = key;
+	return (BLI_ghashutil_ptrhash(elem->ptr.data) ^ BLI_ghashutil_ptrhash(elem->update) ^
+	        BLI_ghashutil_uinthash((unsigned int)elem->noteflag));
+}
+
+static bool rna_update_batch_elem_cmp(const void *a, const void *b)
+{
+	const tRnaUpdateBatchElem *elem_a = a, *elem_b = b;
+	return !((elem_a->ptr.data == elem_b->ptr.data) &&
+	         (elem_a->ptr.type == elem_b->ptr.type) &&
+	         (elem_a->update == elem_b->update) &&
+	         (elem_a->noteflag == elem_b->noteflag) &&
+	         (elem_a->bmain == elem_b->bmain) &&
+	         (elem_a->scene == elem_b->scene));
+}
+
+/* returns true when the update of prop is deferred to the end of the batch */
+static bool rna_property_update_batch_add(Main *bmain, Scene *scene, PointerRNA *ptr, PropertyRNA *prop)
+{
+	tRnaUpdateBatchElem *elem;
+
+	if (rna_update_batch.level == 0) {
+		return false;
+	}
+
+	/* ID properties tag drivers, and some updates need the context, they run right away */
+	if ((prop->magic != RNA_MAGIC) || (prop->flag & (PROP_IDPROPERTY | PROP_CONTEXT_UPDATE))) {
+		return false;
+	}
+
+	if ((prop->update == NULL) && (prop->noteflag == 0)) {
+		return true;
+	}
+
+	elem = MEM_callocN(sizeof(*elem), __func__);
+	elem->bmain = bmain;
+	elem->scene = scene;
+	elem->ptr = *ptr;
+	elem->update = prop->update;
+	elem->noteflag = prop->noteflag;
+
+	if (rna_update_batch.elems_set == NULL) {
+		rna_update_batch.elems_set = BLI_gset_new(rna_update_batch_elem_hash, rna_update_batch_elem_cmp, __func__);
+	}
+
+	if (BLI_gset_add(rna_update_batch.elems_set, elem)) {
+		BLI_addtail(&rna_update_batch.elems, elem);
+	}
+	else {
+		MEM_freeN(elem);
+	}
+
+	return true;
+}
+
+/**
+ * Start deferring property updates, batches can be nested.
+ */
+void RNA_property_update_batch_begin(void)
+{
+	rna_update_batch.level++;
+}
+
+/**
+ * End a batch, running the deferred updates when it's the outer one.
+ */
+void RNA_property_update_batch_end(void)
+{
+	tRnaUpdateBatchElem *elem;
+
+	BLI_assert(rna_update_batch.level > 0);
+
+	if (--rna_update_batch.level > 0) {
+		return;
+	}
+
+	/* updates may set properties themselves, those run right away since the batch has ended */
+	while ((elem = BLI_pophead(&rna_update_batch.elems))) {
+		BLI_gset_remove(rna_update_batch.elems_set, elem, NULL);
+
+		if (elem->update) {
+			elem->update(elem->bmain, elem->scene, &elem->ptr);
+		}
+		if (elem->noteflag) {
+			WM_main_add_notifier(elem->noteflag, elem->ptr.id.data);
+		}
+
+		MEM_freeN(elem);
+	}
+
+	if (rna_update_batch.elems_set) {
+		BLI_gset_free(rna_update_batch.elems_set, NULL);
+		rna_update_batch.elems_set = NULL;
+	}
+}
+
 /* RNA Updates Cache ------------------------ */
 /* Overview of RNA Update cache system:
  *
@@ -3450,6 +3596,14 @@ static int rna_raw_access(ReportList *reports, PointerRNA *ptr, PropertyRNA *pro
 
 				size = RNA_raw_type_sizeof(out.type) * arraylen;
 
+				/* tightly packed items, copy them all at once */
+				if (out.stride == size) {
+					if (set) memcpy(outp, inp, (size_t)size * out.len);
+					else memcpy(inp, outp, (size_t)size * out.len);
+
+					return 1;
+				}
+
 				for (a = 0; a < out.len; a++) {
 					if (set) memcpy(outp, inp, size);
 					else memcpy(inp, outp, size);
@@ -55,6 +55,27 @@ static void rna_Depsgraph_debug_graphviz(Depsgraph *graph, const char *filename)
 	fclose(f);
 }
 
+static void rna_Depsgraph_debug_profile(Depsgraph *graph, const char *filename)
+{
+	FILE *f = fopen(filename, "w");
+	if (f == NULL)
+		return;
+
+	DEG_debug_profile_write(graph, f);
+
+	fclose(f);
+}
+
+static int rna_Depsgraph_use_debug_profiling_get(PointerRNA *ptr)
+{
+	return DEG_debug_profiling_get((Depsgraph *)ptr->data);
+}
+
+static void rna_Depsgraph_use_debug_profiling_set(PointerRNA *ptr, int value)
+{
+	DEG_debug_profiling_set((Depsgraph *)ptr->data, value != 0);
+}
+
 static void rna_Depsgraph_debug_rebuild(Depsgraph *UNUSED(graph), Main *bmain)
 {
 	Scene *sce;
@@ -86,6 +107,7 @@ static void rna_def_depsgraph(BlenderRNA *brna)
 	StructRNA *srna;
 	FunctionRNA *func;
 	PropertyRNA *parm;
+	PropertyRNA *prop;
 
 	srna = RNA_def_struct(brna, "Depsgraph", NULL);
 	RNA_def_struct_ui_text(srna, "Dependency Graph", "");
@@ -95,6 +117,20 @@ static void rna_def_depsgraph(BlenderRNA *brna)
 	                                "File in which to store graphviz debug output");
 	RNA_def_property_flag(parm, PROP_REQUIRED);
 
+	prop = RNA_def_property(srna, "use_debug_profiling", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_funcs(prop, "rna_Depsgraph_use_debug_profiling_get",
+	                               "rna_Depsgraph_use_debug_profiling_set");
+	RNA_def_property_clear_flag(prop, PROP_ANIMATABLE);
+	RNA_def_property_ui_text(prop, "Debug Profiling",
+	                         "Record the time every operation takes when the graph is evaluated");
+
+	func = RNA_def_function(srna, "debug_profile", "rna_Depsgraph_debug_profile");
+	RNA_def_function_ui_description(func, "Write timings of the operations evaluated by the last update "
+	                                "and the critical path through them");
+	parm = RNA_def_string_file_path(func, "filename", NULL, FILE_MAX, "File Name",
+	                                "File in which to store the tab separated profile");
+	RNA_def_property_flag(parm, PROP_REQUIRED);
+
 	func = RNA_def_function(srna, "debug_rebuild", "rna_Depsgraph_debug_rebuild");
 	RNA_def_function_flag(func, FUNC_USE_MAIN);
 	RNA_def_property_flag(parm, PROP_REQUIRED);
@@ -55,6 +55,7 @@
 #include "BKE_DerivedMesh.h"
 #include "BKE_displist.h"
 #include "BKE_mesh.h"
+#include "BKE_mesh_import.h"
 #include "BKE_armature.h"
 #include "BKE_lamp.h"
 #include "BKE_library.h"
@@ -291,6 +292,16 @@ static Mesh *rna_Main_meshes_new(Main *bmain, const char *name)
 	return me;
 }
 
+static Mesh *rna_Main_meshes_load(Main *bmain, ReportList *reports, const char *filepath)
+{
+	Mesh *me = BKE_mesh_import(bmain, filepath, reports);
+
+	if (me) {
+		id_us_min(&me->id);
+	}
+	return me;
+}
+
 /* copied from Mesh_getFromObject and adapted to RNA interface */
 /* settings: 1 - preview, 2 - render */
 Mesh *rna_Main_meshes_new_from_object(
@@ -1069,6 +1080,15 @@ void RNA_def_main_meshes(BlenderRNA *brna, PropertyRNA *cprop)
 	parm = RNA_def_pointer(func, "mesh", "Mesh", "", "New mesh data-block");
 	RNA_def_function_return(func, parm);
 
+	func = RNA_def_function(srna, "load", "rna_Main_meshes_load");
+	RNA_def_function_flag(func, FUNC_USE_REPORTS);
+	RNA_def_function_ui_description(func, "Load a new mesh from an OBJ, PLY or STL file into the main database");
+	parm = RNA_def_string_file_path(func, "filepath", "File Path", 0, "", "path of the file to load");
+	RNA_def_property_flag(parm, PROP_REQUIRED);
+	/* return type */
+	parm = RNA_def_pointer(func, "mesh", "Mesh", "", "New mesh data-block");
+	RNA_def_function_return(func, parm);
+
 	func = RNA_def_function(srna, "new_from_object", "rna_Main_meshes_new_from_object");
 	RNA_def_function_ui_description(func, "Add a new mesh created from object with modifiers applied");
 	RNA_def_function_flag(func, FUNC_USE_REPORTS);
@@ -3951,6 +3951,8 @@ static void rna_def_userdef_system(BlenderRNA *brna)
 #endif
 
 	static EnumPropertyItem image_draw_methods[] = {
+		{IMAGE_DRAW_METHOD_AUTO, "AUTO", 0, "Automatic",
+		 "Use GLSL shaders for display transform when supported, 2D texture otherwise"},
 		{IMAGE_DRAW_METHOD_2DTEXTURE, "2DTEXTURE", 0, "2D Texture", "Use CPU for display transform and draw image with 2D texture"},
 		{IMAGE_DRAW_METHOD_GLSL, "GLSL", 0, "GLSL", "Use GLSL shaders for display transform and draw image with 2D texture"},
 		{IMAGE_DRAW_METHOD_DRAWPIXELS, "DRAWPIXELS", 0, "DrawPixels", "Use CPU for display transform and draw image using DrawPixels"},
@@ -4107,6 +4109,13 @@ static void rna_def_userdef_system(BlenderRNA *brna)
 	RNA_def_property_ui_text(prop, "Memory Cache Limit", "Memory cache limit (in megabytes)");
 	RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
 
+	prop = RNA_def_property(srna, "sequencer_disk_cache_limit", PROP_INT, PROP_NONE);
+	RNA_def_property_int_sdna(prop, NULL, "sequencer_disk_cache_limit");
+	RNA_def_property_range(prop, 0, INT_MAX);
+	RNA_def_property_ui_range(prop, 0, 1024 * 1024, 1024, -1);
+	RNA_def_property_ui_text(prop, "Sequencer Disk Cache Limit",
+	                         "Disk space used by the sequencer disk cache (in megabytes), 0 for no limit");
+
 	prop = RNA_def_property(srna, "frame_server_port", PROP_INT, PROP_NONE);
 	RNA_def_property_int_sdna(prop, NULL, "frameserverport");
 	RNA_def_property_range(prop, 0, 32727);
@@ -4588,6 +4597,12 @@ static void rna_def_userdef_filepaths(BlenderRNA *brna)
 	RNA_def_property_string_sdna(prop, NULL, "render_cachedir");
 	RNA_def_property_ui_text(prop, "Render Cache Path", "Where to cache raw render results");
 
+	prop = RNA_def_property(srna, "sequencer_disk_cache_directory", PROP_STRING, PROP_DIRPATH);
+	RNA_def_property_string_sdna(prop, NULL, "sequencer_disk_cache_dir");
+	RNA_def_property_ui_text(prop, "Sequencer Disk Cache Path",
+	                         "Where to keep slow to render sequencer strip frames between sessions, "
+	                         "leave empty to disable the disk cache");
+
 	prop = RNA_def_property(srna, "image_editor", PROP_STRING, PROP_FILEPATH);
 	RNA_def_property_string_sdna(prop, NULL, "image_editor");
 	RNA_def_property_ui_text(prop, "Image Editor", "Path to an image editor");
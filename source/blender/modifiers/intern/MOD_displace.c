@@ -38,8 +38,10 @@
 
 #include "BLI_utildefines.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "BKE_cdderivedmesh.h"
+#include "BKE_image.h"
 #include "BKE_library.h"
 #include "BKE_library_query.h"
 #include "BKE_mesh.h"
@@ -192,23 +194,91 @@ static void updateDepsgraph(ModifierData *md,
 	}
 }
 
+typedef struct DisplaceUserdata {
+	DisplaceModifierData *dmd;
+	struct ImagePool *pool;
+	MDeformVert *dvert;
+	int defgrp_index;
+	int direction;
+	float (*tex_co)[3];
+	float (*vertexCos)[3];
+	MVert *mvert;
+	float (*vert_clnors)[3];
+} DisplaceUserdata;
+
+static void displaceModifier_do_task(void *userdata, void *UNUSED(userdata_chunk), int iter)
+{
+	DisplaceUserdata *data = (DisplaceUserdata *)userdata;
+	DisplaceModifierData *dmd = data->dmd;
+	MDeformVert *dvert = data->dvert;
+	float weight = 1.0f; /* init value unused but some compilers may complain */
+	const float delta_fixed = 1.0f - dmd->midlevel;  /* when no texture is used, we fallback to white */
+	float (*vertexCos)[3] = data->vertexCos;
+	TexResult texres;
+	float strength = dmd->strength;
+	float delta;
+
+	if (dvert) {
+		weight = defvert_find_weight(dvert + iter, data->defgrp_index);
+		if (weight == 0.0f) return;
+	}
+
+	if (dmd->texture) {
+		texres.nor = NULL;
+		BKE_texture_get_value_ex(dmd->modifier.scene, dmd->texture, data->tex_co[iter], &texres, data->pool, false);
+		delta = texres.tin - dmd->midlevel;
+	}
+	else {
+		delta = delta_fixed;  /* (1.0f - dmd->midlevel) */  /* never changes */
+	}
+
+	if (dvert) strength *= weight;
+
+	delta *= strength;
+	CLAMP(delta, -10000, 10000);
+
+	switch (data->direction) {
+		case MOD_DISP_DIR_X:
+			vertexCos[iter][0] += delta;
+			break;
+		case MOD_DISP_DIR_Y:
+			vertexCos[iter][1] += delta;
+			break;
+		case MOD_DISP_DIR_Z:
+			vertexCos[iter][2] += delta;
+			break;
+		case MOD_DISP_DIR_RGB_XYZ:
+			vertexCos[iter][0] += (texres.tr - dmd->midlevel) * strength;
+			vertexCos[iter][1] += (texres.tg - dmd->midlevel) * strength;
+			vertexCos[iter][2] += (texres.tb - dmd->midlevel) * strength;
+			break;
+		case MOD_DISP_DIR_NOR:
+			vertexCos[iter][0] += delta * (data->mvert[iter].no[0] / 32767.0f);
+			vertexCos[iter][1] += delta * (data->mvert[iter].no[1] / 32767.0f);
+			vertexCos[iter][2] += delta * (data->mvert[iter].no[2] / 32767.0f);
+			break;
+		case MOD_DISP_DIR_CLNOR:
+			madd_v3_v3fl(vertexCos[iter], data->vert_clnors[iter], delta);
+			break;
+	}
+}
+
 /* dm must be a CDDerivedMesh */
 static void displaceModifier_do(
         DisplaceModifierData *dmd, Object *ob,
         DerivedMesh *dm, float (*vertexCos)[3], int numVerts)
 {
-	int i;
 	MVert *mvert;
 	MDeformVert *dvert;
 	int direction = dmd->direction;
 	int defgrp_index;
 	float (*tex_co)[3];
-	float weight = 1.0f; /* init value unused but some compilers may complain */
-	const float delta_fixed = 1.0f - dmd->midlevel;  /* when no texture is used, we fallback to white */
 	float (*vert_clnors)[3] = NULL;
+	DisplaceUserdata data = {NULL};
 
 	if (!dmd->texture && dmd->direction == MOD_DISP_DIR_RGB_XYZ) return;
 	if (dmd->strength == 0.0f) return;
+	if (numVerts == 0) return;
 
 	mvert = CDDM_get_verts(dm);
 	modifier_get_vgroup(ob, dm, dmd->defgrp_name, &dvert, &defgrp_index);
@@ -244,54 +314,23 @@ static void displaceModifier_do(
 		}
 	}
 
-	for (i = 0; i < numVerts; i++) {
-		TexResult texres;
-		float strength = dmd->strength;
-		float delta;
-
-		if (dvert) {
-			weight = defvert_find_weight(dvert + i, defgrp_index);
-			if (weight == 0.0f) continue;
-		}
-
-		if (dmd->texture) {
-			texres.nor = NULL;
-			BKE_texture_get_value(dmd->modifier.scene, dmd->texture, tex_co[i], &texres, false);
-			delta = texres.tin - dmd->midlevel;
-		}
-		else {
-			delta = delta_fixed;  /* (1.0f - dmd->midlevel) */  /* never changes */
-		}
+	data.dmd = dmd;
+	data.dvert = dvert;
+	data.defgrp_index = defgrp_index;
+	data.direction = direction;
+	data.tex_co = tex_co;
+	data.vertexCos = vertexCos;
+	data.mvert = mvert;
+	data.vert_clnors = vert_clnors;
+	if (dmd->texture) {
+		data.pool = BKE_image_pool_new();
+		BKE_texture_fetch_images_for_pool(dmd->texture, data.pool);
+	}
+	BLI_task_parallel_range_ex(0, numVerts, &data, NULL, 0, displaceModifier_do_task,
+	                           numVerts > 512, false);
 
-		if (dvert) strength *= weight;
-
-		delta *= strength;
-		CLAMP(delta, -10000, 10000);
-
-		switch (direction) {
-			case MOD_DISP_DIR_X:
-				vertexCos[i][0] += delta;
-				break;
-			case MOD_DISP_DIR_Y:
-				vertexCos[i][1] += delta;
-				break;
-			case MOD_DISP_DIR_Z:
-				vertexCos[i][2] += delta;
-				break;
-			case MOD_DISP_DIR_RGB_XYZ:
-				vertexCos[i][0] += (texres.tr - dmd->midlevel) * strength;
-				vertexCos[i][1] += (texres.tg - dmd->midlevel) * strength;
-				vertexCos[i][2] += (texres.tb - dmd->midlevel) * strength;
-				break;
-			case MOD_DISP_DIR_NOR:
-				vertexCos[i][0] += delta * (mvert[i].no[0] / 32767.0f);
-				vertexCos[i][1] += delta * (mvert[i].no[1] / 32767.0f);
-				vertexCos[i][2] += delta * (mvert[i].no[2] / 32767.0f);
-				break;
-			case MOD_DISP_DIR_CLNOR:
-				madd_v3_v3fl(vertexCos[i], vert_clnors[i], delta);
-				break;
-		}
+	if (data.pool) {
+		BKE_image_pool_free(data.pool);
 	}
 
 	if (tex_co) {
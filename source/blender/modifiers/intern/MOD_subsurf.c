@@ -35,6 +35,7 @@
 
 #include <stddef.h>
 
+#include "DNA_camera_types.h"
 #include "DNA_scene_types.h"
 #include "DNA_object_types.h"
 
@@ -43,8 +44,11 @@
 #endif
 
 #include "BLI_utildefines.h"
+#include "BLI_math.h"
+#include "BLI_rect.h"
 
 
+#include "BKE_camera.h"
 #include "BKE_cdderivedmesh.h"
 #include "BKE_depsgraph.h"
 #include "BKE_scene.h"
@@ -61,6 +65,7 @@ static void initData(ModifierData *md)
 	smd->levels = 1;
 	smd->renderLevels = 2;
 	smd->flags |= eSubsurfModifierFlag_SubsurfUv;
+	smd->dicing_rate = 1.0f;
 }
 
 static void copyData(ModifierData *md, ModifierData *target)
@@ -96,6 +101,65 @@ static bool isDisabled(ModifierData *md, int useRenderParams)
 	return get_render_subsurf_level(&md->scene->r, levels, useRenderParams != 0) == 0;
 }
 
+/**
+ * Render levels for #eSubsurfModifierFlag_AdaptiveRender: every level halves the edges,
+ * stop once they are shorter than the dicing rate in pixels of the render, as seen from the scene camera.
+ * The whole object gets the same level, so there are no cracks between faces.
+ */
+static int subsurf_adaptive_render_levels(SubsurfModifierData *smd, Object *ob, DerivedMesh *dm)
+{
+	Scene *scene = smd->modifier.scene;
+	Object *camera = scene ? scene->camera : NULL;
+	const int numEdges = dm->getNumEdges(dm);
+	CameraParams params;
+	MVert *mvert;
+	MEdge *medge;
+	float min[3], max[3], center[3];
+	float scale, radius, dist, edge_len = 0.0f, edge_px, pixels_per_unit;
+	int winx, winy, i, levels;
+
+	if (camera == NULL || numEdges == 0) {
+		return smd->renderLevels;
+	}
+
+	winx = (scene->r.size * scene->r.xsch) / 100;
+	winy = (scene->r.size * scene->r.ysch) / 100;
+
+	BKE_camera_params_init(&params);
+	BKE_camera_params_from_object(&params, camera);
+	BKE_camera_params_compute_viewplane(&params, winx, winy, scene->r.xasp, scene->r.yasp);
+
+	/* average edge length in world space */
+	mvert = dm->getVertArray(dm);
+	medge = dm->getEdgeArray(dm);
+	for (i = 0; i < numEdges; i++) {
+		edge_len += len_v3v3(mvert[medge[i].v1].co, mvert[medge[i].v2].co);
+	}
+	scale = mat4_to_scale(ob->obmat);
+	edge_len *= scale / (float)numEdges;
+
+	/* the closest the object's bounds get to the camera */
+	INIT_MINMAX(min, max);
+	dm->getMinMax(dm, min, max);
+	mid_v3_v3v3(center, min, max);
+	radius = len_v3v3(min, max) * 0.5f * scale;
+	mul_m4_v3(ob->obmat, center);
+	dist = max_ff(len_v3v3(center, camera->obmat[3]) - radius, params.clipsta);
+
+	/* the viewplane of perspective cameras is at the clipping start distance */
+	pixels_per_unit = (float)winx / BLI_rctf_size_x(&params.viewplane);
+	if (!params.is_ortho) {
+		pixels_per_unit *= params.clipsta / dist;
+	}
+
+	edge_px = edge_len * pixels_per_unit;
+	for (levels = 0; levels < smd->renderLevels && edge_px > smd->dicing_rate; levels++) {
+		edge_px *= 0.5f;
+	}
+
+	return levels;
+}
+
 static DerivedMesh *applyModifier(ModifierData *md, Object *ob,
                                   DerivedMesh *derivedData,
                                   ModifierApplyFlag flag)
@@ -119,10 +183,8 @@ static DerivedMesh *applyModifier(ModifierData *md, Object *ob,
 		subsurf_flags |= SUBSURF_IN_EDIT_MODE;
 
 #ifdef WITH_OPENSUBDIV
-	/* TODO(sergey): Not entirely correct, modifiers on top of subsurf
-	 * could be disabled.
-	 */
-	if (md->next == NULL &&
+	/* disabled modifiers on top of subsurf don't need its result on the CPU */
+	if (modifier_isLastEnabled(md->scene, md, eModifierMode_Realtime) &&
 	    allow_gpu &&
 	    do_cddm_convert == false &&
 	    smd->use_opensubdiv)
@@ -140,7 +202,16 @@ static DerivedMesh *applyModifier(ModifierData *md, Object *ob,
 	}
 #endif
 
-	result = subsurf_make_derived_from_derived(derivedData, smd, NULL, subsurf_flags);
+	if (useRenderParams && (smd->flags & eSubsurfModifierFlag_AdaptiveRender)) {
+		/* render evaluation doesn't use the caches, so a copy with fewer levels can be used */
+		SubsurfModifierData smd_adaptive = *smd;
+
+		smd_adaptive.renderLevels = (short)subsurf_adaptive_render_levels(smd, ob, derivedData);
+		result = subsurf_make_derived_from_derived(derivedData, &smd_adaptive, NULL, subsurf_flags);
+	}
+	else {
+		result = subsurf_make_derived_from_derived(derivedData, smd, NULL, subsurf_flags);
+	}
 	result->cd_flag = derivedData->cd_flag;
 
 	if (do_cddm_convert) {
@@ -163,7 +234,9 @@ static DerivedMesh *applyModifierEM(ModifierData *md, Object *UNUSED(ob),
 	SubsurfFlags ss_flags = (flag & MOD_APPLY_ORCO) ? 0 : (SUBSURF_FOR_EDIT_MODE | SUBSURF_IN_EDIT_MODE);
 #ifdef WITH_OPENSUBDIV
 	const bool allow_gpu = (flag & MOD_APPLY_ALLOW_GPU) != 0;
-	if (md->next == NULL && allow_gpu && smd->use_opensubdiv) {
+	if (allow_gpu && smd->use_opensubdiv &&
+	    modifier_isLastEnabled(md->scene, md, eModifierMode_Realtime | eModifierMode_Editmode))
+	{
 		modifier_setError(md, "OpenSubdiv is not supported in edit mode");
 	}
 #endif
@@ -177,7 +250,7 @@ static bool dependsOnNormals(ModifierData *md)
 {
 #ifdef WITH_OPENSUBDIV
 	SubsurfModifierData *smd = (SubsurfModifierData *) md;
-	if (smd->use_opensubdiv && md->next == NULL) {
+	if (smd->use_opensubdiv && modifier_isLastEnabled(md->scene, md, eModifierMode_Realtime)) {
 		return true;
 	}
 #else
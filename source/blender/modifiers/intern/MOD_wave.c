@@ -34,6 +34,7 @@
 
 
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "DNA_meshdata_types.h"
 #include "DNA_scene_types.h"
@@ -44,6 +45,7 @@
 
 #include "BKE_deform.h"
 #include "BKE_DerivedMesh.h"
+#include "BKE_image.h"
 #include "BKE_library.h"
 #include "BKE_library_query.h"
 #include "BKE_scene.h"
@@ -186,6 +188,117 @@ static CustomDataMask requiredDataMask(Object *UNUSED(ob), ModifierData *md)
 	return dataMask;
 }
 
+typedef struct WaveUserdata {
+	WaveModifierData *wmd;
+	struct ImagePool *pool;
+	float (*vertexCos)[3];
+	float (*tex_co)[3];
+	MVert *mvert;
+	MDeformVert *dvert;
+	int defgrp_index;
+	int wmd_axis;
+	float ctime;
+	float minfac;
+	float lifefac;
+	float falloff;
+	float falloff_inv;
+} WaveUserdata;
+
+static void waveModifier_do_task(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	const WaveUserdata *data = userdata;
+	WaveModifierData *wmd = data->wmd;
+	float falloff_fac = 1.0f; /* when falloff == 0.0f this stays at 1.0f */
+	float *co = data->vertexCos[i];
+	float x = co[0] - wmd->startx;
+	float y = co[1] - wmd->starty;
+	float amplit = 0.0f;
+	float def_weight = 1.0f;
+
+	/* get weights */
+	if (data->dvert) {
+		def_weight = defvert_find_weight(&data->dvert[i], data->defgrp_index);
+
+		/* if this vert isn't in the vgroup, don't deform it */
+		if (def_weight == 0.0f) {
+			return;
+		}
+	}
+
+	switch (data->wmd_axis) {
+		case MOD_WAVE_X | MOD_WAVE_Y:
+			amplit = sqrtf(x * x + y * y);
+			break;
+		case MOD_WAVE_X:
+			amplit = x;
+			break;
+		case MOD_WAVE_Y:
+			amplit = y;
+			break;
+	}
+
+	/* this way it makes nice circles */
+	amplit -= (data->ctime - wmd->timeoffs) * wmd->speed;
+
+	if (wmd->flag & MOD_WAVE_CYCL) {
+		amplit = (float)fmodf(amplit - wmd->width, 2.0f * wmd->width) +
+		         wmd->width;
+	}
+
+	if (data->falloff != 0.0f) {
+		float dist = 0.0f;
+
+		switch (data->wmd_axis) {
+			case MOD_WAVE_X | MOD_WAVE_Y:
+				dist = sqrtf(x * x + y * y);
+				break;
+			case MOD_WAVE_X:
+				dist = fabsf(x);
+				break;
+			case MOD_WAVE_Y:
+				dist = fabsf(y);
+				break;
+		}
+
+		falloff_fac = (1.0f - (dist * data->falloff_inv));
+		CLAMP(falloff_fac, 0.0f, 1.0f);
+	}
+
+	/* GAUSSIAN */
+	if ((falloff_fac != 0.0f) && (amplit > -wmd->width) && (amplit < wmd->width)) {
+		amplit = amplit * wmd->narrow;
+		amplit = (float)(1.0f / expf(amplit * amplit) - data->minfac);
+
+		/*apply texture*/
+		if (wmd->texture) {
+			TexResult texres;
+			texres.nor = NULL;
+			BKE_texture_get_value_ex(wmd->modifier.scene, wmd->texture, data->tex_co[i], &texres, data->pool, false);
+			amplit *= texres.tin;
+		}
+
+		/*apply weight & falloff */
+		amplit *= def_weight * falloff_fac;
+
+		if (data->mvert) {
+			/* move along normals */
+			if (wmd->flag & MOD_WAVE_NORM_X) {
+				co[0] += (data->lifefac * amplit) * data->mvert[i].no[0] / 32767.0f;
+			}
+			if (wmd->flag & MOD_WAVE_NORM_Y) {
+				co[1] += (data->lifefac * amplit) * data->mvert[i].no[1] / 32767.0f;
+			}
+			if (wmd->flag & MOD_WAVE_NORM_Z) {
+				co[2] += (data->lifefac * amplit) * data->mvert[i].no[2] / 32767.0f;
+			}
+		}
+		else {
+			/* move along local z axis */
+			co[2] += data->lifefac * amplit;
+		}
+	}
+}
+
 static void waveModifier_do(WaveModifierData *md, 
                             Scene *scene, Object *ob, DerivedMesh *dm,
                             float (*vertexCos)[3], int numVerts)
@@ -200,7 +313,6 @@ static void waveModifier_do(WaveModifierData *md,
 	float (*tex_co)[3] = NULL;
 	const int wmd_axis = wmd->flag & (MOD_WAVE_X | MOD_WAVE_Y);
 	const float falloff = wmd->falloff;
-	float falloff_fac = 1.0f; /* when falloff == 0.0f this stays at 1.0f */
 
 	if ((wmd->flag & MOD_WAVE_NORM) && (ob->type == OB_MESH))
 		mvert = dm->getVertArray(dm);
@@ -239,100 +351,33 @@ static void waveModifier_do(WaveModifierData *md,
 		modifier_init_texture(wmd->modifier.scene, wmd->texture);
 	}
 
-	if (lifefac != 0.0f) {
+	if (lifefac != 0.0f && numVerts > 0) {
+		WaveUserdata data = {NULL};
+
+		data.wmd = wmd;
+		data.vertexCos = vertexCos;
+		data.tex_co = tex_co;
+		data.mvert = mvert;
+		data.dvert = dvert;
+		data.defgrp_index = defgrp_index;
+		data.wmd_axis = wmd_axis;
+		data.ctime = ctime;
+		data.minfac = minfac;
+		data.lifefac = lifefac;
+		data.falloff = falloff;
 		/* avoid divide by zero checks within the loop */
-		float falloff_inv = falloff ? 1.0f / falloff : 1.0f;
-		int i;
-
-		for (i = 0; i < numVerts; i++) {
-			float *co = vertexCos[i];
-			float x = co[0] - wmd->startx;
-			float y = co[1] - wmd->starty;
-			float amplit = 0.0f;
-			float def_weight = 1.0f;
-
-			/* get weights */
-			if (dvert) {
-				def_weight = defvert_find_weight(&dvert[i], defgrp_index);
-
-				/* if this vert isn't in the vgroup, don't deform it */
-				if (def_weight == 0.0f) {
-					continue;
-				}
-			}
-
-			switch (wmd_axis) {
-				case MOD_WAVE_X | MOD_WAVE_Y:
-					amplit = sqrtf(x * x + y * y);
-					break;
-				case MOD_WAVE_X:
-					amplit = x;
-					break;
-				case MOD_WAVE_Y:
-					amplit = y;
-					break;
-			}
-
-			/* this way it makes nice circles */
-			amplit -= (ctime - wmd->timeoffs) * wmd->speed;
+		data.falloff_inv = falloff ? 1.0f / falloff : 1.0f;
 
-			if (wmd->flag & MOD_WAVE_CYCL) {
-				amplit = (float)fmodf(amplit - wmd->width, 2.0f * wmd->width) +
-				         wmd->width;
-			}
+		if (wmd->texture) {
+			data.pool = BKE_image_pool_new();
+			BKE_texture_fetch_images_for_pool(wmd->texture, data.pool);
+		}
 
-			if (falloff != 0.0f) {
-				float dist = 0.0f;
-
-				switch (wmd_axis) {
-					case MOD_WAVE_X | MOD_WAVE_Y:
-						dist = sqrtf(x * x + y * y);
-						break;
-					case MOD_WAVE_X:
-						dist = fabsf(x);
-						break;
-					case MOD_WAVE_Y:
-						dist = fabsf(y);
-						break;
-				}
-
-				falloff_fac = (1.0f - (dist * falloff_inv));
-				CLAMP(falloff_fac, 0.0f, 1.0f);
-			}
+		BLI_task_parallel_range_ex(0, numVerts, &data, NULL, 0, waveModifier_do_task,
+		                           numVerts > 1000, false);
 
-			/* GAUSSIAN */
-			if ((falloff_fac != 0.0f) && (amplit > -wmd->width) && (amplit < wmd->width)) {
-				amplit = amplit * wmd->narrow;
-				amplit = (float)(1.0f / expf(amplit * amplit) - minfac);
-
-				/*apply texture*/
-				if (wmd->texture) {
-					TexResult texres;
-					texres.nor = NULL;
-					BKE_texture_get_value(wmd->modifier.scene, wmd->texture, tex_co[i], &texres, false);
-					amplit *= texres.tin;
-				}
-
-				/*apply weight & falloff */
-				amplit *= def_weight * falloff_fac;
-
-				if (mvert) {
-					/* move along normals */
-					if (wmd->flag & MOD_WAVE_NORM_X) {
-						co[0] += (lifefac * amplit) * mvert[i].no[0] / 32767.0f;
-					}
-					if (wmd->flag & MOD_WAVE_NORM_Y) {
-						co[1] += (lifefac * amplit) * mvert[i].no[1] / 32767.0f;
-					}
-					if (wmd->flag & MOD_WAVE_NORM_Z) {
-						co[2] += (lifefac * amplit) * mvert[i].no[2] / 32767.0f;
-					}
-				}
-				else {
-					/* move along local z axis */
-					co[2] += lifefac * amplit;
-				}
-			}
+		if (data.pool) {
+			BKE_image_pool_free(data.pool);
 		}
 	}
 
@@ -41,6 +41,7 @@ extern "C" {
 
 #include "BLI_math.h"
 #include "BLI_linklist.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_cloth.h"
@@ -559,6 +560,7 @@ BLI_INLINE void cloth_get_grid_location(Implicit_Data *data, float cell_scale, c
 	add_v3_v3(x, cell_offset);
 }
 
+#if 0 /* neighbor segments are only used by the disabled line rasterizing splat in hair_volume.cpp */
 /* returns next spring forming a continous hair sequence */
 BLI_INLINE LinkNode *hair_spring_next(LinkNode *spring_link)
 {
@@ -645,6 +647,20 @@ static LinkNode *cloth_continuum_add_hair_segments(HairGrid *grid, const float c
 	
 	return next_spring_link;
 }
+#endif
+
+typedef struct ContinuumGridLocationData {
+	Implicit_Data *data;
+	float cell_scale, cell_offset[3];
+	float (*x)[3];
+	float (*v)[3];
+} ContinuumGridLocationData;
+
+static void cloth_continuum_grid_location_cb(void *userdata, void * /*userdata_chunk*/, int i)
+{
+	ContinuumGridLocationData *data = (ContinuumGridLocationData *)userdata;
+	cloth_get_grid_location(data->data, data->cell_scale, data->cell_offset, i, data->x[i], data->v[i]);
+}
 
 static void cloth_continuum_fill_grid(HairGrid *grid, Cloth *cloth)
 {
@@ -661,25 +677,41 @@ static void cloth_continuum_fill_grid(HairGrid *grid, Cloth *cloth)
 		BPH_hair_volume_add_vertex(grid, x, v);
 	}
 #else
+	ContinuumGridLocationData data;
 	LinkNode *link;
-	float cellsize, gmin[3], cell_scale, cell_offset[3];
+	float cellsize, gmin[3];
+	int (*segments)[2];
+	int totseg = 0;
 	
 	/* scale and offset for transforming vertex locations into grid space
 	 * (cell size is 0..1, gmin becomes origin)
 	 */
 	BPH_hair_volume_grid_geometry(grid, &cellsize, NULL, gmin, NULL);
-	cell_scale = cellsize > 0.0f ? 1.0f / cellsize : 0.0f;
-	mul_v3_v3fl(cell_offset, gmin, cell_scale);
-	negate_v3(cell_offset);
+	data.data = cloth->implicit;
+	data.cell_scale = cellsize > 0.0f ? 1.0f / cellsize : 0.0f;
+	mul_v3_v3fl(data.cell_offset, gmin, data.cell_scale);
+	negate_v3(data.cell_offset);
+	
+	data.x = (float (*)[3])MEM_mallocN(sizeof(float[3]) * cloth->mvert_num, "hair grid locations");
+	data.v = (float (*)[3])MEM_mallocN(sizeof(float[3]) * cloth->mvert_num, "hair grid velocities");
+	BLI_task_parallel_range(0, cloth->mvert_num, &data, cloth_continuum_grid_location_cb);
 	
-	link = cloth->springs;
-	while (link) {
+	/* structural springs are the hair segments, splatting doesn't need them in hair order */
+	segments = (int (*)[2])MEM_mallocN(sizeof(int[2]) * max_ii(cloth->numsprings, 1), "hair grid segments");
+	for (link = cloth->springs; link; link = link->next) {
 		ClothSpring *spring = (ClothSpring *)link->link;
-		if (spring->type == CLOTH_SPRING_TYPE_STRUCTURAL)
-			link = cloth_continuum_add_hair_segments(grid, cell_scale, cell_offset, cloth, link);
-		else
-			link = link->next;
+		if (spring->type == CLOTH_SPRING_TYPE_STRUCTURAL) {
+			segments[totseg][0] = spring->kl;
+			segments[totseg][1] = spring->ij;
+			totseg++;
+		}
 	}
+	
+	BPH_hair_volume_add_segments(grid, data.x, data.v, segments, totseg);
+	
+	MEM_freeN(data.x);
+	MEM_freeN(data.v);
+	MEM_freeN(segments);
 #endif
 	BPH_hair_volume_normalize_vertex_grid(grid);
 }
@@ -29,10 +29,13 @@
  *  \ingroup bph
  */
 
+#include <string.h>
+
 #include "MEM_guardedalloc.h"
 
 extern "C" {
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_texture_types.h"
@@ -523,13 +526,10 @@ BLI_INLINE void hair_volume_eval_grid_vertex_sample(HairGridVert *vert, const fl
 	}
 }
 
-/* XXX simplified test implementation using a series of discrete sample along the segment,
- * instead of finding the closest point for all affected grid vertices.
- */
-void BPH_hair_volume_add_segment(HairGrid *grid,
-                                 const float UNUSED(x1[3]), const float UNUSED(v1[3]), const float x2[3], const float v2[3],
-                                 const float x3[3], const float v3[3], const float UNUSED(x4[3]), const float UNUSED(v4[3]),
-                                 const float UNUSED(dir1[3]), const float UNUSED(dir2[3]), const float UNUSED(dir3[3]))
+/* Splat samples along the segment into grid vertices with a z index in [kclip_min, kclip_max]. */
+BLI_INLINE void hair_volume_add_segment_samples(HairGrid *grid,
+                                                const float x2[3], const float v2[3], const float x3[3], const float v3[3],
+                                                int kclip_min, int kclip_max)
 {
 	const float radius = 1.5f;
 	const float dist_scale = grid->inv_cellsize;
@@ -552,8 +552,8 @@ void BPH_hair_volume_add_segment(HairGrid *grid,
 		int imax = min_ii(floor_int(x[0]) + 2, res[0]-1);
 		int jmin = max_ii(floor_int(x[1]) - 2, 0);
 		int jmax = min_ii(floor_int(x[1]) + 2, res[1]-1);
-		int kmin = max_ii(floor_int(x[2]) - 2, 0);
-		int kmax = min_ii(floor_int(x[2]) + 2, res[2]-1);
+		int kmin = max_ii(floor_int(x[2]) - 2, kclip_min);
+		int kmax = min_ii(floor_int(x[2]) + 2, kclip_max);
 		
 		for (k = kmin; k <= kmax; ++k) {
 			for (j = jmin; j <= jmax; ++j) {
@@ -567,6 +567,113 @@ void BPH_hair_volume_add_segment(HairGrid *grid,
 		}
 	}
 }
+
+/* XXX simplified test implementation using a series of discrete sample along the segment,
+ * instead of finding the closest point for all affected grid vertices.
+ */
+void BPH_hair_volume_add_segment(HairGrid *grid,
+                                 const float UNUSED(x1[3]), const float UNUSED(v1[3]), const float x2[3], const float v2[3],
+                                 const float x3[3], const float v3[3], const float UNUSED(x4[3]), const float UNUSED(v4[3]),
+                                 const float UNUSED(dir1[3]), const float UNUSED(dir2[3]), const float UNUSED(dir3[3]))
+{
+	hair_volume_add_segment_samples(grid, x2, v2, x3, v3, 0, grid->res[2] - 1);
+}
+
+/* Number of z slices in a tile for parallel splatting.
+ * Each tile only writes its own grid vertices, so tiles need no locking or private copies of the grid,
+ * and every vertex sums contributions in the same order as with single threaded splatting.
+ */
+#define HAIR_GRID_TILE_SIZE 8
+
+typedef struct HairGridSplatData {
+	HairGrid *grid;
+	const float (*x)[3];
+	const float (*v)[3];
+	const int (*segments)[2];
+	
+	/* segments touching tile t are tile_segments[tile_offset[t]] .. tile_segments[tile_offset[t + 1] - 1] */
+	const int *tile_offset;
+	const int *tile_segments;
+} HairGridSplatData;
+
+/* range of tiles touched by samples of the segment, r_tile_min > r_tile_max if it's outside the grid */
+BLI_INLINE void hair_volume_segment_tile_range(const HairGrid *grid, const float x2[3], const float x3[3],
+                                               int *r_tile_min, int *r_tile_max)
+{
+	const int kmin = max_ii(floor_int(min_ff(x2[2], x3[2])) - 2, 0);
+	const int kmax = min_ii(floor_int(max_ff(x2[2], x3[2])) + 2, grid->res[2] - 1);
+	
+	if (kmin > kmax) {
+		*r_tile_min = 0;
+		*r_tile_max = -1;
+	}
+	else {
+		*r_tile_min = kmin / HAIR_GRID_TILE_SIZE;
+		*r_tile_max = kmax / HAIR_GRID_TILE_SIZE;
+	}
+}
+
+static void hair_volume_add_segments_tile_cb(void *userdata, void * /*userdata_chunk*/, int tile)
+{
+	const HairGridSplatData *data = (const HairGridSplatData *)userdata;
+	HairGrid *grid = data->grid;
+	const int kmin = tile * HAIR_GRID_TILE_SIZE;
+	const int kmax = min_ii(kmin + HAIR_GRID_TILE_SIZE - 1, grid->res[2] - 1);
+	int i;
+	
+	for (i = data->tile_offset[tile]; i < data->tile_offset[tile + 1]; ++i) {
+		const int *seg = data->segments[data->tile_segments[i]];
+		
+		hair_volume_add_segment_samples(grid, data->x[seg[0]], data->v[seg[0]], data->x[seg[1]], data->v[seg[1]],
+		                                kmin, kmax);
+	}
+}
+
+/* Add many segments at once, splatting in parallel.
+ * Segments are index pairs into the \a x (in grid space) and \a v arrays,
+ * the result is the same as calling #BPH_hair_volume_add_segment for each segment in order.
+ */
+void BPH_hair_volume_add_segments(HairGrid *grid, const float (*x)[3], const float (*v)[3],
+                                  const int (*segments)[2], int totseg)
+{
+	const int num_tiles = (grid->res[2] + HAIR_GRID_TILE_SIZE - 1) / HAIR_GRID_TILE_SIZE;
+	int *tile_offset, *tile_segments, *tile_fill;
+	int i, t, tile_min, tile_max;
+	HairGridSplatData data;
+	
+	/* bucket segments by the tiles they touch (counting sort, keeps segment order within tiles) */
+	tile_offset = (int *)MEM_callocN(sizeof(int) * (num_tiles + 1), "hair grid tile offsets");
+	for (i = 0; i < totseg; ++i) {
+		hair_volume_segment_tile_range(grid, x[segments[i][0]], x[segments[i][1]], &tile_min, &tile_max);
+		for (t = tile_min; t <= tile_max; ++t)
+			tile_offset[t + 1]++;
+	}
+	for (t = 0; t < num_tiles; ++t)
+		tile_offset[t + 1] += tile_offset[t];
+	
+	tile_segments = (int *)MEM_mallocN(sizeof(int) * max_ii(tile_offset[num_tiles], 1), "hair grid tile segments");
+	tile_fill = (int *)MEM_mallocN(sizeof(int) * num_tiles, "hair grid tile fill");
+	memcpy(tile_fill, tile_offset, sizeof(int) * num_tiles);
+	for (i = 0; i < totseg; ++i) {
+		hair_volume_segment_tile_range(grid, x[segments[i][0]], x[segments[i][1]], &tile_min, &tile_max);
+		for (t = tile_min; t <= tile_max; ++t)
+			tile_segments[tile_fill[t]++] = i;
+	}
+	MEM_freeN(tile_fill);
+	
+	data.grid = grid;
+	data.x = x;
+	data.v = v;
+	data.segments = segments;
+	data.tile_offset = tile_offset;
+	data.tile_segments = tile_segments;
+	
+	BLI_task_parallel_range_ex(0, num_tiles, &data, NULL, 0, hair_volume_add_segments_tile_cb,
+	                           num_tiles > 1 && totseg > 256, true);
+	
+	MEM_freeN(tile_offset);
+	MEM_freeN(tile_segments);
+}
 #endif
 
 void BPH_hair_volume_normalize_vertex_grid(HairGrid *grid)
@@ -594,6 +701,162 @@ BLI_INLINE float hair_volume_density_divergence(float density, float target_dens
 		return 0.0f;
 }
 
+/* margin tests for indices i, j, k of the grid extended by one cell on each side (resA) */
+#define MARGIN_i0 (i < 1)
+#define MARGIN_j0 (j < 1)
+#define MARGIN_k0 (k < 1)
+#define MARGIN_i1 (i >= resA[0]-1)
+#define MARGIN_j1 (j >= resA[1]-1)
+#define MARGIN_k1 (k >= resA[2]-1)
+
+#define NEIGHBOR_MARGIN_i0 (i < 2)
+#define NEIGHBOR_MARGIN_j0 (j < 2)
+#define NEIGHBOR_MARGIN_k0 (k < 2)
+#define NEIGHBOR_MARGIN_i1 (i >= resA[0]-2)
+#define NEIGHBOR_MARGIN_j1 (j >= resA[1]-2)
+#define NEIGHBOR_MARGIN_k1 (k >= resA[2]-2)
+
+typedef struct HairGridSolveData {
+	HairGridVert *vert_start;
+	int resA[3];
+	int stride0, stride1, stride2;
+	int strideA0, strideA1, strideA2;
+	float flowfac, inv_flowfac;
+	float target_density, target_strength;
+	
+	float *B;
+	const float *p;
+} HairGridSolveData;
+
+/* velocity divergence for slice k of the grid with margin */
+static void hair_volume_divergence_slice_cb(void *userdata, void * /*userdata_chunk*/, int k)
+{
+	const HairGridSolveData *data = (const HairGridSolveData *)userdata;
+	const int *resA = data->resA;
+	const int stride0 = data->stride0, stride1 = data->stride1, stride2 = data->stride2;
+	const int strideA0 = data->strideA0, strideA1 = data->strideA1, strideA2 = data->strideA2;
+	const float flowfac = data->flowfac;
+	const float target_density = data->target_density, target_strength = data->target_strength;
+	HairGridVert *vert_start = data->vert_start;
+	HairGridVert *vert;
+	float *B = data->B;
+	int i, j;
+	
+	for (j = 0; j < resA[1]; ++j) {
+		for (i = 0; i < resA[0]; ++i) {
+			int u = i * strideA0 + j * strideA1 + k * strideA2;
+			bool is_margin = MARGIN_i0 || MARGIN_i1 || MARGIN_j0 || MARGIN_j1 || MARGIN_k0 || MARGIN_k1;
+			
+			if (is_margin) {
+				B[u] = 0.0f;
+				continue;
+			}
+			
+			vert = vert_start + i * stride0 + j * stride1 + k * stride2;
+			
+			const float *v0 = vert->velocity;
+			float dx = 0.0f, dy = 0.0f, dz = 0.0f;
+			if (!NEIGHBOR_MARGIN_i0)
+				dx += v0[0] - (vert - stride0)->velocity[0];
+			if (!NEIGHBOR_MARGIN_i1)
+				dx += (vert + stride0)->velocity[0] - v0[0];
+			if (!NEIGHBOR_MARGIN_j0)
+				dy += v0[1] - (vert - stride1)->velocity[1];
+			if (!NEIGHBOR_MARGIN_j1)
+				dy += (vert + stride1)->velocity[1] - v0[1];
+			if (!NEIGHBOR_MARGIN_k0)
+				dz += v0[2] - (vert - stride2)->velocity[2];
+			if (!NEIGHBOR_MARGIN_k1)
+				dz += (vert + stride2)->velocity[2] - v0[2];
+			
+			float divergence = -0.5f * flowfac * (dx + dy + dz);
+			
+			/* adjustment term for target density */
+			float target = hair_volume_density_divergence(vert->density, target_density, target_strength);
+			
+			/* B vector contains the finite difference approximation of the velocity divergence.
+			 * Note: according to the discretized Navier-Stokes equation the rhs vector
+			 * and resulting pressure gradient should be multiplied by the (inverse) density;
+			 * however, this is already included in the weighting of hair velocities on the grid!
+			 */
+			B[u] = divergence - target;
+			
+#if 0
+			{
+				float wloc[3], loc[3];
+				float col0[3] = {0.0, 0.0, 0.0};
+				float colp[3] = {0.0, 1.0, 1.0};
+				float coln[3] = {1.0, 0.0, 1.0};
+				float col[3];
+				float fac;
+				
+				loc[0] = (float)(i - 1);
+				loc[1] = (float)(j - 1);
+				loc[2] = (float)(k - 1);
+				grid_to_world(grid, wloc, loc);
+				
+				if (divergence > 0.0f) {
+					fac = CLAMPIS(divergence * target_strength, 0.0, 1.0);
+					interp_v3_v3v3(col, col0, colp, fac);
+				}
+				else {
+					fac = CLAMPIS(-divergence * target_strength, 0.0, 1.0);
+					interp_v3_v3v3(col, col0, coln, fac);
+				}
+				if (fac > 0.05f)
+					BKE_sim_debug_data_add_circle(grid->debug_data, wloc, 0.01f, col[0], col[1], col[2], "grid", 5522, i, j, k);
+			}
+#endif
+		}
+	}
+}
+
+/* velocity from the pressure gradient for slice k of the grid with margin */
+static void hair_volume_pressure_gradient_slice_cb(void *userdata, void * /*userdata_chunk*/, int k)
+{
+	const HairGridSolveData *data = (const HairGridSolveData *)userdata;
+	const int *resA = data->resA;
+	const int stride0 = data->stride0, stride1 = data->stride1, stride2 = data->stride2;
+	const int strideA0 = data->strideA0, strideA1 = data->strideA1, strideA2 = data->strideA2;
+	const float inv_flowfac = data->inv_flowfac;
+	HairGridVert *vert_start = data->vert_start;
+	HairGridVert *vert;
+	const float *p = data->p;
+	int i, j;
+	
+	for (j = 0; j < resA[1]; ++j) {
+		for (i = 0; i < resA[0]; ++i) {
+			int u = i * strideA0 + j * strideA1 + k * strideA2;
+			bool is_margin = MARGIN_i0 || MARGIN_i1 || MARGIN_j0 || MARGIN_j1 || MARGIN_k0 || MARGIN_k1;
+			if (is_margin)
+				continue;
+			
+			vert = vert_start + i * stride0 + j * stride1 + k * stride2;
+			if (vert->density > density_threshold) {
+				float p_left   = p[u - strideA0];
+				float p_right  = p[u + strideA0];
+				float p_down   = p[u - strideA1];
+				float p_up     = p[u + strideA1];
+				float p_bottom = p[u - strideA2];
+				float p_top    = p[u + strideA2];
+				
+				/* finite difference estimate of pressure gradient */
+				float dvel[3];
+				dvel[0] = p_right - p_left;
+				dvel[1] = p_up - p_down;
+				dvel[2] = p_top - p_bottom;
+				mul_v3_fl(dvel, -0.5f * inv_flowfac);
+				
+				/* pressure gradient describes velocity delta */
+				add_v3_v3v3(vert->velocity_smooth, vert->velocity, dvel);
+			}
+			else {
+				zero_v3(vert->velocity_smooth);
+			}
+		}
+	}
+}
+
 bool BPH_hair_volume_solve_divergence(HairGrid *grid, float /*dt*/, float target_density, float target_strength)
 {
 	const float flowfac = grid->cellsize;
@@ -612,98 +875,33 @@ bool BPH_hair_volume_solve_divergence(HairGrid *grid, float /*dt*/, float target
 	
 	const int num_cells = res[0] * res[1] * res[2];
 	const int num_cellsA = (res[0] + 2) * (res[1] + 2) * (res[2] + 2);
+	const bool use_threading = num_cellsA > 10000;
 	
 	HairGridVert *vert_start = grid->verts - (stride0 + stride1 + stride2);
 	HairGridVert *vert;
 	int i, j, k;
 	
-#define MARGIN_i0 (i < 1)
-#define MARGIN_j0 (j < 1)
-#define MARGIN_k0 (k < 1)
-#define MARGIN_i1 (i >= resA[0]-1)
-#define MARGIN_j1 (j >= resA[1]-1)
-#define MARGIN_k1 (k >= resA[2]-1)
-
-#define NEIGHBOR_MARGIN_i0 (i < 2)
-#define NEIGHBOR_MARGIN_j0 (j < 2)
-#define NEIGHBOR_MARGIN_k0 (k < 2)
-#define NEIGHBOR_MARGIN_i1 (i >= resA[0]-2)
-#define NEIGHBOR_MARGIN_j1 (j >= resA[1]-2)
-#define NEIGHBOR_MARGIN_k1 (k >= resA[2]-2)
-	
 	BLI_assert(num_cells >= 1);
 	
+	HairGridSolveData data;
+	data.vert_start = vert_start;
+	copy_v3_v3_int(data.resA, resA);
+	data.stride0 = stride0;
+	data.stride1 = stride1;
+	data.stride2 = stride2;
+	data.strideA0 = strideA0;
+	data.strideA1 = strideA1;
+	data.strideA2 = strideA2;
+	data.flowfac = flowfac;
+	data.inv_flowfac = inv_flowfac;
+	data.target_density = target_density;
+	data.target_strength = target_strength;
+	
 	/* Calculate divergence */
 	lVector B(num_cellsA);
-	for (k = 0; k < resA[2]; ++k) {
-		for (j = 0; j < resA[1]; ++j) {
-			for (i = 0; i < resA[0]; ++i) {
-				int u = i * strideA0 + j * strideA1 + k * strideA2;
-				bool is_margin = MARGIN_i0 || MARGIN_i1 || MARGIN_j0 || MARGIN_j1 || MARGIN_k0 || MARGIN_k1;
-				
-				if (is_margin) {
-					B[u] = 0.0f;
-					continue;
-				}
-				
-				vert = vert_start + i * stride0 + j * stride1 + k * stride2;
-				
-				const float *v0 = vert->velocity;
-				float dx = 0.0f, dy = 0.0f, dz = 0.0f;
-				if (!NEIGHBOR_MARGIN_i0)
-					dx += v0[0] - (vert - stride0)->velocity[0];
-				if (!NEIGHBOR_MARGIN_i1)
-					dx += (vert + stride0)->velocity[0] - v0[0];
-				if (!NEIGHBOR_MARGIN_j0)
-					dy += v0[1] - (vert - stride1)->velocity[1];
-				if (!NEIGHBOR_MARGIN_j1)
-					dy += (vert + stride1)->velocity[1] - v0[1];
-				if (!NEIGHBOR_MARGIN_k0)
-					dz += v0[2] - (vert - stride2)->velocity[2];
-				if (!NEIGHBOR_MARGIN_k1)
-					dz += (vert + stride2)->velocity[2] - v0[2];
-				
-				float divergence = -0.5f * flowfac * (dx + dy + dz);
-				
-				/* adjustment term for target density */
-				float target = hair_volume_density_divergence(vert->density, target_density, target_strength);
-				
-				/* B vector contains the finite difference approximation of the velocity divergence.
-				 * Note: according to the discretized Navier-Stokes equation the rhs vector
-				 * and resulting pressure gradient should be multiplied by the (inverse) density;
-				 * however, this is already included in the weighting of hair velocities on the grid!
-				 */
-				B[u] = divergence - target;
-				
-#if 0
-				{
-					float wloc[3], loc[3];
-					float col0[3] = {0.0, 0.0, 0.0};
-					float colp[3] = {0.0, 1.0, 1.0};
-					float coln[3] = {1.0, 0.0, 1.0};
-					float col[3];
-					float fac;
-					
-					loc[0] = (float)(i - 1);
-					loc[1] = (float)(j - 1);
-					loc[2] = (float)(k - 1);
-					grid_to_world(grid, wloc, loc);
-					
-					if (divergence > 0.0f) {
-						fac = CLAMPIS(divergence * target_strength, 0.0, 1.0);
-						interp_v3_v3v3(col, col0, colp, fac);
-					}
-					else {
-						fac = CLAMPIS(-divergence * target_strength, 0.0, 1.0);
-						interp_v3_v3v3(col, col0, coln, fac);
-					}
-					if (fac > 0.05f)
-						BKE_sim_debug_data_add_circle(grid->debug_data, wloc, 0.01f, col[0], col[1], col[2], "grid", 5522, i, j, k);
-				}
-#endif
-			}
-		}
-	}
+	data.B = B.data();
+	BLI_task_parallel_range_ex(0, resA[2], &data, NULL, 0, hair_volume_divergence_slice_cb,
+	                           use_threading, false);
 	
 	/* Main Poisson equation system:
 	 * This is derived from the discretezation of the Poisson equation
@@ -777,39 +975,9 @@ bool BPH_hair_volume_solve_divergence(HairGrid *grid, float /*dt*/, float target
 	
 	if (cg.info() == Eigen::Success) {
 		/* Calculate velocity = grad(p) */
-		for (k = 0; k < resA[2]; ++k) {
-			for (j = 0; j < resA[1]; ++j) {
-				for (i = 0; i < resA[0]; ++i) {
-					int u = i * strideA0 + j * strideA1 + k * strideA2;
-					bool is_margin = MARGIN_i0 || MARGIN_i1 || MARGIN_j0 || MARGIN_j1 || MARGIN_k0 || MARGIN_k1;
-					if (is_margin)
-						continue;
-					
-					vert = vert_start + i * stride0 + j * stride1 + k * stride2;
-					if (vert->density > density_threshold) {
-						float p_left   = p[u - strideA0];
-						float p_right  = p[u + strideA0];
-						float p_down   = p[u - strideA1];
-						float p_up     = p[u + strideA1];
-						float p_bottom = p[u - strideA2];
-						float p_top    = p[u + strideA2];
-						
-						/* finite difference estimate of pressure gradient */
-						float dvel[3];
-						dvel[0] = p_right - p_left;
-						dvel[1] = p_up - p_down;
-						dvel[2] = p_top - p_bottom;
-						mul_v3_fl(dvel, -0.5f * inv_flowfac);
-						
-						/* pressure gradient describes velocity delta */
-						add_v3_v3v3(vert->velocity_smooth, vert->velocity, dvel);
-					}
-					else {
-						zero_v3(vert->velocity_smooth);
-					}
-				}
-			}
-		}
+		data.p = p.data();
+		BLI_task_parallel_range_ex(0, resA[2], &data, NULL, 0, hair_volume_pressure_gradient_slice_cb,
+		                           use_threading, false);
 		
 #if 0
 		{
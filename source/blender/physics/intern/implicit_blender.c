@@ -43,6 +43,7 @@
 
 #include "BLI_math.h"
 #include "BLI_linklist.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_cloth.h"
@@ -60,6 +61,8 @@
 #  define CLOTH_OPENMP_LIMIT 512
 #endif
 
+#define CLOTH_PARALLEL_LIMIT 512
+
 #if 0  /* debug timing */
 #ifdef _WIN32
 #include <windows.h>
@@ -661,6 +664,116 @@ DO_INLINE void mul_bfmatrix_lfvector( float (*to)[3], fmatrix3x3 *from, lfVector
 	
 }
 
+/* A copy of a big matrix as compressed sparse rows of 3x3 blocks, so a product reads the blocks
+ * of a vertex contiguously, and the vertices can be computed in parallel.
+ * The off-diagonal blocks are stored a second time by column, for the symmetric part.
+ * Within a vertex the blocks keep their order, the product is exactly the same as mul_bfmatrix_lfvector. */
+typedef struct BFMatrixCSR {
+	unsigned int vcount;
+	/* all blocks, by row */
+	unsigned int *row_offs, *row_cols;
+	float (*row_m)[3][3];
+	/* off-diagonal blocks, by column */
+	unsigned int *col_offs, *col_rows;
+	float (*col_m)[3][3];
+} BFMatrixCSR;
+
+static void bfmatrix_csr_init(BFMatrixCSR *csr, fmatrix3x3 *matrix)
+{
+	unsigned int vcount = matrix[0].vcount;
+	unsigned int scount = max_ii(1, (int)matrix[0].scount);
+	unsigned int tot = matrix[0].vcount + matrix[0].scount;
+	unsigned int *row_fill, *col_fill;
+	unsigned int i;
+
+	csr->vcount = vcount;
+	csr->row_offs = MEM_callocN(sizeof(*csr->row_offs) * (vcount + 1), "BFMatrixCSR row_offs");
+	csr->row_cols = MEM_mallocN(sizeof(*csr->row_cols) * tot, "BFMatrixCSR row_cols");
+	csr->row_m = MEM_mallocN(sizeof(*csr->row_m) * tot, "BFMatrixCSR row_m");
+	csr->col_offs = MEM_callocN(sizeof(*csr->col_offs) * (vcount + 1), "BFMatrixCSR col_offs");
+	csr->col_rows = MEM_mallocN(sizeof(*csr->col_rows) * scount, "BFMatrixCSR col_rows");
+	csr->col_m = MEM_mallocN(sizeof(*csr->col_m) * scount, "BFMatrixCSR col_m");
+
+	/* count, then offsets */
+	for (i = 0; i < tot; i++) {
+		csr->row_offs[matrix[i].r + 1]++;
+		if (i >= vcount)
+			csr->col_offs[matrix[i].c + 1]++;
+	}
+	for (i = 0; i < vcount; i++) {
+		csr->row_offs[i + 1] += csr->row_offs[i];
+		csr->col_offs[i + 1] += csr->col_offs[i];
+	}
+
+	row_fill = MEM_mallocN(sizeof(*row_fill) * vcount, __func__);
+	col_fill = MEM_mallocN(sizeof(*col_fill) * vcount, __func__);
+	memcpy(row_fill, csr->row_offs, sizeof(*row_fill) * vcount);
+	memcpy(col_fill, csr->col_offs, sizeof(*col_fill) * vcount);
+
+	for (i = 0; i < tot; i++) {
+		unsigned int j = row_fill[matrix[i].r]++;
+		csr->row_cols[j] = matrix[i].c;
+		copy_m3_m3(csr->row_m[j], matrix[i].m);
+
+		if (i >= vcount) {
+			j = col_fill[matrix[i].c]++;
+			csr->col_rows[j] = matrix[i].r;
+			copy_m3_m3(csr->col_m[j], matrix[i].m);
+		}
+	}
+
+	MEM_freeN(row_fill);
+	MEM_freeN(col_fill);
+}
+
+static void bfmatrix_csr_free(BFMatrixCSR *csr)
+{
+	MEM_freeN(csr->row_offs);
+	MEM_freeN(csr->row_cols);
+	MEM_freeN(csr->row_m);
+	MEM_freeN(csr->col_offs);
+	MEM_freeN(csr->col_rows);
+	MEM_freeN(csr->col_m);
+}
+
+typedef struct MulBFMatrixCSRLFVectorData {
+	float (*to)[3];
+	const BFMatrixCSR *csr;
+	lfVector *fLongVector;
+} MulBFMatrixCSRLFVectorData;
+
+static void mul_bfmatrix_csr_lfvector_task_cb(void *userdata, void *UNUSED(userdata_chunk), int v)
+{
+	MulBFMatrixCSRLFVectorData *data = userdata;
+	const BFMatrixCSR *csr = data->csr;
+	lfVector *fLongVector = data->fLongVector;
+	float to_col[3] = {0.0f, 0.0f, 0.0f};
+	float to_row[3] = {0.0f, 0.0f, 0.0f};
+	unsigned int j;
+
+	for (j = csr->col_offs[v]; j < csr->col_offs[v + 1]; j++) {
+		muladd_fmatrix_fvector(to_col, csr->col_m[j], fLongVector[csr->col_rows[j]]);
+	}
+	for (j = csr->row_offs[v]; j < csr->row_offs[v + 1]; j++) {
+		muladd_fmatrix_fvector(to_row, csr->row_m[j], fLongVector[csr->row_cols[j]]);
+	}
+
+	VECADD(data->to[v], to_col, to_row);
+}
+
+/* Same as mul_bfmatrix_lfvector, using the compressed rows of the matrix to run in parallel. */
+static void mul_bfmatrix_csr_lfvector(float (*to)[3], const BFMatrixCSR *csr, lfVector *fLongVector)
+{
+	MulBFMatrixCSRLFVectorData data = {.to = to, .csr = csr, .fLongVector = fLongVector};
+
+	if (csr->vcount == 0)
+		return;
+
+	BLI_task_parallel_range_ex(
+	        0, (int)csr->vcount, &data, NULL, 0, mul_bfmatrix_csr_lfvector_task_cb,
+	        csr->vcount > CLOTH_PARALLEL_LIMIT, false);
+}
+
 /* SPARSE SYMMETRIC sub big matrix with big matrix*/
 /* A -= B * float + C * float --> for big matrix */
 /* VERIFIED */
@@ -872,6 +985,10 @@ static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z,
 	lfVector *q = create_lfvector(numverts);
 	lfVector *s = create_lfvector(numverts);
 	float bnorm2, delta_new, delta_old, delta_target, alpha;
+	BFMatrixCSR lA_csr;
+	
+	/* the structure of A doesn't change during the iterations */
+	bfmatrix_csr_init(&lA_csr, lA);
 	
 	cp_lfvector(ldV, z, numverts);
 	
@@ -882,7 +999,7 @@ static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z,
 	delta_target = conjgrad_epsilon*conjgrad_epsilon * bnorm2;
 	
 	/* r = filter(B - A * dV) */
-	mul_bfmatrix_lfvector(AdV, lA, ldV);
+	mul_bfmatrix_csr_lfvector(AdV, &lA_csr, ldV);
 	sub_lfvector_lfvector(r, lB, AdV, numverts);
 	filter(r, S);
 	
@@ -905,7 +1022,7 @@ static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z,
 #endif
 	
 	while (delta_new > delta_target && conjgrad_loopcount < conjgrad_looplimit) {
-		mul_bfmatrix_lfvector(q, lA, c);
+		mul_bfmatrix_csr_lfvector(q, &lA_csr, c);
 		filter(q, S);
 		
 		alpha = delta_new / dot_lfvector(c, q, numverts);
@@ -937,6 +1054,7 @@ static int cg_filtered(lfVector *ldV, fmatrix3x3 *lA, lfVector *lB, lfVector *z,
 	del_lfvector(c);
 	del_lfvector(q);
 	del_lfvector(s);
+	bfmatrix_csr_free(&lA_csr);
 	// printf("W/O conjgrad_loopcount: %d\n", conjgrad_loopcount);
 
 	result->status = conjgrad_loopcount < conjgrad_looplimit ? BPH_SOLVER_SUCCESS : BPH_SOLVER_NO_CONVERGENCE;
@@ -255,6 +255,41 @@ static PyObject *bpy_escape_identifier(PyObject *UNUSED(self), PyObject *value)
 	return value_escape;
 }
 
+/* nesting level of the batches started from Python, to catch unbalanced calls */
+static int bpy_rna_update_batch_level = 0;
+
+PyDoc_STRVAR(bpy_rna_update_batch_begin_doc,
+".. function:: _rna_update_batch_begin()\n"
+"\n"
+"   Defer property updates until the matching _rna_update_batch_end(),\n"
+"   use :class:`bpy.utils.rna_update_batch` instead.\n"
+);
+static PyObject *bpy_rna_update_batch_begin(PyObject *UNUSED(self))
+{
+	bpy_rna_update_batch_level++;
+	RNA_property_update_batch_begin();
+
+	Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(bpy_rna_update_batch_end_doc,
+".. function:: _rna_update_batch_end()\n"
+"\n"
+"   End a batch started by _rna_update_batch_begin(), running the deferred updates.\n"
+);
+static PyObject *bpy_rna_update_batch_end(PyObject *UNUSED(self))
+{
+	if (bpy_rna_update_batch_level == 0) {
+		PyErr_SetString(PyExc_RuntimeError, "_rna_update_batch_end() called without a batch");
+		return NULL;
+	}
+
+	bpy_rna_update_batch_level--;
+	RNA_property_update_batch_end();
+
+	Py_RETURN_NONE;
+}
+
 static PyMethodDef meth_bpy_script_paths =
 	{"script_paths", (PyCFunction)bpy_script_paths, METH_NOARGS, bpy_script_paths_doc};
 static PyMethodDef meth_bpy_blend_paths =
@@ -265,6 +300,10 @@ static PyMethodDef meth_bpy_resource_path =
 	{"resource_path", (PyCFunction)bpy_resource_path, METH_VARARGS | METH_KEYWORDS, bpy_resource_path_doc};
 static PyMethodDef meth_bpy_escape_identifier =
 	{"escape_identifier", (PyCFunction)bpy_escape_identifier, METH_O, bpy_escape_identifier_doc};
+static PyMethodDef meth_bpy_rna_update_batch_begin =
+	{"_rna_update_batch_begin", (PyCFunction)bpy_rna_update_batch_begin, METH_NOARGS, bpy_rna_update_batch_begin_doc};
+static PyMethodDef meth_bpy_rna_update_batch_end =
+	{"_rna_update_batch_end", (PyCFunction)bpy_rna_update_batch_end, METH_NOARGS, bpy_rna_update_batch_end_doc};
 
 static PyObject *bpy_import_test(const char *modname)
 {
@@ -351,6 +390,8 @@ void BPy_init_modules(void)
 	PyModule_AddObject(mod, meth_bpy_user_resource.ml_name, (PyObject *)PyCFunction_New(&meth_bpy_user_resource, NULL));
 	PyModule_AddObject(mod, meth_bpy_resource_path.ml_name, (PyObject *)PyCFunction_New(&meth_bpy_resource_path, NULL));
 	PyModule_AddObject(mod, meth_bpy_escape_identifier.ml_name, (PyObject *)PyCFunction_New(&meth_bpy_escape_identifier, NULL));
+	PyModule_AddObject(mod, meth_bpy_rna_update_batch_begin.ml_name, (PyObject *)PyCFunction_New(&meth_bpy_rna_update_batch_begin, NULL));
+	PyModule_AddObject(mod, meth_bpy_rna_update_batch_end.ml_name, (PyObject *)PyCFunction_New(&meth_bpy_rna_update_batch_end, NULL));
 
 	/* register funcs (bpy_rna.c) */
 	PyModule_AddObject(mod, meth_bpy_register_class.ml_name, (PyObject *)PyCFunction_New(&meth_bpy_register_class, NULL));
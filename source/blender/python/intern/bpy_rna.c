@@ -4485,6 +4485,90 @@ static bool foreach_compat_buffer(RawPropertyType raw_type, int attr_signed, con
 	return 0;
 }
 
+/* numeric buffers of another type than the property are converted in C, instead of as a Python sequence */
+static bool foreach_convert_buffer_type(const Py_buffer *buf, int tot, RawPropertyType *r_raw_type, bool *r_signed)
+{
+	const char *format = buf->format ? buf->format : "B";
+
+	/* only native single item formats */
+	if (format[0] == '@') {
+		format++;
+	}
+	if (format[0] == '\0' || format[1] != '\0') {
+		return false;
+	}
+
+	switch (format[0]) {
+		case 'b': *r_raw_type = PROP_RAW_CHAR;   *r_signed = true;  break;
+		case 'B': *r_raw_type = PROP_RAW_CHAR;   *r_signed = false; break;
+		case 'h': *r_raw_type = PROP_RAW_SHORT;  *r_signed = true;  break;
+		case 'H': *r_raw_type = PROP_RAW_SHORT;  *r_signed = false; break;
+		case 'i': *r_raw_type = PROP_RAW_INT;    *r_signed = true;  break;
+		case 'I': *r_raw_type = PROP_RAW_INT;    *r_signed = false; break;
+		case 'f': *r_raw_type = PROP_RAW_FLOAT;  *r_signed = true;  break;
+		case 'd': *r_raw_type = PROP_RAW_DOUBLE; *r_signed = true;  break;
+		default:
+			return false;
+	}
+
+	return (buf->itemsize == RNA_raw_type_sizeof(*r_raw_type) && buf->len == (Py_ssize_t)tot * buf->itemsize);
+}
+
+static void foreach_convert_array(void *dst, RawPropertyType dst_type, bool dst_signed,
+                                  const void *src, RawPropertyType src_type, bool src_signed, int tot)
+{
+	int i;
+
+	for (i = 0; i < tot; i++) {
+		double value = 0.0;
+
+		switch (src_type) {
+			case PROP_RAW_CHAR:
+				value = src_signed ? (double)((const signed char *)src)[i] : (double)((const unsigned char *)src)[i];
+				break;
+			case PROP_RAW_SHORT:
+				value = src_signed ? (double)((const short *)src)[i] : (double)((const unsigned short *)src)[i];
+				break;
+			case PROP_RAW_INT:
+				value = src_signed ? (double)((const int *)src)[i] : (double)((const unsigned int *)src)[i];
+				break;
+			case PROP_RAW_FLOAT:
+				value = ((const float *)src)[i];
+				break;
+			case PROP_RAW_DOUBLE:
+				value = ((const double *)src)[i];
+				break;
+			case PROP_RAW_UNSET:
+				BLI_assert(!"Invalid array type - convert");
+				break;
+		}
+
+		switch (dst_type) {
+			case PROP_RAW_CHAR:
+				if (dst_signed) ((signed char *)dst)[i] = (signed char)(int)value;
+				else            ((unsigned char *)dst)[i] = (unsigned char)(int)value;
+				break;
+			case PROP_RAW_SHORT:
+				if (dst_signed) ((short *)dst)[i] = (short)(int)value;
+				else            ((unsigned short *)dst)[i] = (unsigned short)(int)value;
+				break;
+			case PROP_RAW_INT:
+				if (dst_signed) ((int *)dst)[i] = (int)value;
+				else            ((unsigned int *)dst)[i] = (unsigned int)(long long)value;
+				break;
+			case PROP_RAW_FLOAT:
+				((float *)dst)[i] = (float)value;
+				break;
+			case PROP_RAW_DOUBLE:
+				((double *)dst)[i] = value;
+				break;
+			case PROP_RAW_UNSET:
+				BLI_assert(!"Invalid array type - convert");
+				break;
+		}
+	}
+}
+
 static PyObject *foreach_getset(BPy_PropertyRNA *self, PyObject *args, int set)
 {
 	PyObject *item = NULL;
@@ -4511,17 +4595,34 @@ static PyObject *foreach_getset(BPy_PropertyRNA *self, PyObject *args, int set)
 		buffer_is_compat = false;
 		if (PyObject_CheckBuffer(seq)) {
 			Py_buffer buf;
-			PyObject_GetBuffer(seq, &buf, PyBUF_SIMPLE | PyBUF_FORMAT);
+			RawPropertyType buf_type;
+			bool buf_signed;
 
-			/* check if the buffer matches */
+			if (PyObject_GetBuffer(seq, &buf, PyBUF_SIMPLE | PyBUF_FORMAT) == -1) {
+				/* not contiguous, use it as a sequence */
+				PyErr_Clear();
+			}
+			else {
+				/* check if the buffer matches */
 
-			buffer_is_compat = foreach_compat_buffer(raw_type, attr_signed, buf.format);
+				buffer_is_compat = foreach_compat_buffer(raw_type, attr_signed, buf.format);
 
-			if (buffer_is_compat) {
-				ok = RNA_property_collection_raw_set(NULL, &self->ptr, self->prop, attr, buf.buf, raw_type, tot);
-			}
+				if (buffer_is_compat) {
+					ok = RNA_property_collection_raw_set(NULL, &self->ptr, self->prop, attr, buf.buf, raw_type, tot);
+				}
+				/* convert other numbers, except floats which Python doesn't allow to set integers */
+				else if (foreach_convert_buffer_type(&buf, tot, &buf_type, &buf_signed) &&
+				         (ELEM(raw_type, PROP_RAW_FLOAT, PROP_RAW_DOUBLE) ||
+				          !ELEM(buf_type, PROP_RAW_FLOAT, PROP_RAW_DOUBLE)))
+				{
+					array = PyMem_Malloc(size * tot);
+					foreach_convert_array(array, raw_type, attr_signed, buf.buf, buf_type, buf_signed, tot);
+					ok = RNA_property_collection_raw_set(NULL, &self->ptr, self->prop, attr, array, raw_type, tot);
+					buffer_is_compat = true;
+				}
 
-			PyBuffer_Release(&buf);
+				PyBuffer_Release(&buf);
+			}
 		}
 
 		/* could not use the buffer, fallback to sequence */
@@ -4562,17 +4663,33 @@ static PyObject *foreach_getset(BPy_PropertyRNA *self, PyObject *args, int set)
 		buffer_is_compat = false;
 		if (PyObject_CheckBuffer(seq)) {
 			Py_buffer buf;
-			PyObject_GetBuffer(seq, &buf, PyBUF_SIMPLE | PyBUF_FORMAT);
+			RawPropertyType buf_type;
+			bool buf_signed;
+
+			if (PyObject_GetBuffer(seq, &buf, PyBUF_SIMPLE | PyBUF_FORMAT | PyBUF_WRITABLE) == -1) {
+				/* not contiguous or read-only, use it as a sequence */
+				PyErr_Clear();
+			}
+			else {
+				/* check if the buffer matches, TODO - signed/unsigned types */
 
-			/* check if the buffer matches, TODO - signed/unsigned types */
+				buffer_is_compat = foreach_compat_buffer(raw_type, attr_signed, buf.format);
 
-			buffer_is_compat = foreach_compat_buffer(raw_type, attr_signed, buf.format);
+				if (buffer_is_compat) {
+					ok = RNA_property_collection_raw_get(NULL, &self->ptr, self->prop, attr, buf.buf, raw_type, tot);
+				}
+				/* convert to other numbers directly into the buffer */
+				else if (foreach_convert_buffer_type(&buf, tot, &buf_type, &buf_signed)) {
+					array = PyMem_Malloc(size * tot);
+					ok = RNA_property_collection_raw_get(NULL, &self->ptr, self->prop, attr, array, raw_type, tot);
+					if (ok) {
+						foreach_convert_array(buf.buf, buf_type, buf_signed, array, raw_type, attr_signed, tot);
+					}
+					buffer_is_compat = true;
+				}
 
-			if (buffer_is_compat) {
-				ok = RNA_property_collection_raw_get(NULL, &self->ptr, self->prop, attr, buf.buf, raw_type, tot);
+				PyBuffer_Release(&buf);
 			}
-
-			PyBuffer_Release(&buf);
 		}
 
 		/* could not use the buffer, fallback to sequence */
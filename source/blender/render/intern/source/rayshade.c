@@ -40,9 +40,11 @@
 #include "DNA_lamp_types.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_ghash.h"
 #include "BLI_system.h"
 #include "BLI_math.h"
 #include "BLI_rand.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -212,12 +214,10 @@ static int is_raytraceable(Render *re, ObjectInstanceRen *obi)
 }
 
 
-RayObject* makeraytree_object(Render *re, ObjectInstanceRen *obi)
+/* builds the raytree of the object the instance uses, only touches that object so
+ * different objects can be built from several threads at once */
+static void makeraytree_object_build(Render *re, ObjectInstanceRen *obi)
 {
-	/*TODO
-	 * out-of-memory safeproof
-	 * break render
-	 * update render stats */
 	ObjectRen *obr = obi->obr;
 
 	if (obr->raytree == NULL) {
@@ -235,7 +235,7 @@ RayObject* makeraytree_object(Render *re, ObjectInstanceRen *obi)
 		}
 		
 		if (faces == 0)
-			return NULL;
+			return;
 
 		//Create Ray cast accelaration structure
 		raytree = rayobject_create( re,  re->r.raytrace_structure, faces );
@@ -268,6 +268,17 @@ RayObject* makeraytree_object(Render *re, ObjectInstanceRen *obi)
 		else
 			obr->raytree= raytree;
 	}
+}
+
+RayObject* makeraytree_object(Render *re, ObjectInstanceRen *obi)
+{
+	/*TODO
+	 * out-of-memory safeproof
+	 * break render
+	 * update render stats */
+	ObjectRen *obr = obi->obr;
+
+	makeraytree_object_build(re, obi);
 
 	if (obr->raytree) {
 		if ((obi->flag & R_TRANSFORMED) && obi->raytree == NULL) {
@@ -297,6 +308,48 @@ static bool has_special_rayobject(Render *re, ObjectInstanceRen *obi)
 	}
 	return 0;
 }
+typedef struct RaytreeObjectsData {
+	Render *re;
+	ObjectInstanceRen **obis;
+} RaytreeObjectsData;
+
+static void makeraytree_objects_build_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	RaytreeObjectsData *data = userdata;
+
+	makeraytree_object_build(data->re, data->obis[i]);
+}
+
+/*
+ * build the raytrees of all objects which get their own instanced rayobject in parallel,
+ * using the first instance of each object as the serial build does
+ */
+static void makeraytree_objects_build(Render *re)
+{
+	RaytreeObjectsData data;
+	ObjectInstanceRen *obi;
+	GSet *obrs = BLI_gset_ptr_new(__func__);
+	int totobi = 0;
+
+	data.re = re;
+	data.obis = MEM_mallocN(sizeof(*data.obis) * BLI_listbase_count(&re->instancetable), __func__);
+
+	for (obi = re->instancetable.first; obi; obi = obi->next) {
+		if (obi->obr->raytree == NULL && is_raytraceable(re, obi) && has_special_rayobject(re, obi)) {
+			if (BLI_gset_add(obrs, obi->obr))
+				data.obis[totobi++] = obi;
+		}
+	}
+
+	if (totobi) {
+		BLI_task_parallel_range_ex(0, totobi, &data, NULL, 0, makeraytree_objects_build_cb,
+		                           totobi > 1, true);
+	}
+
+	BLI_gset_free(obrs, NULL);
+	MEM_freeN(data.obis);
+}
+
 /*
  * create a single raytrace structure with all faces
  */
@@ -332,6 +385,9 @@ static void makeraytree_single(Render *re)
 		return;
 	}
 	
+	if (special)
+		makeraytree_objects_build(re);
+
 	//Create raytree
 	raytree = re->raytree = rayobject_create( re, re->r.raytrace_structure, faces+special );
 
@@ -43,6 +43,7 @@
 #include "BLI_jitter.h"
 #include "BLI_memarena.h"
 #include "BLI_rand.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_global.h"
@@ -502,8 +503,9 @@ static void compress_deepshadowbuf(Render *re, ShadBuf *shb, APixstr *apixbuf, A
 	//printf("%d -> %d, ratio %f\n", totsample, totsamplec, (float)totsamplec/(float)totsample);
 }
 
-/* create Z tiles (for compression): this system is 24 bits!!! */
-static void compress_shadowbuf(ShadBuf *shb, int *rectz, int square)
+/* create Z tiles (for compression): this system is 24 bits!!!
+ * returns the new sample buffer, adding it to shb->buffers is up to the caller */
+static ShadSampleBuf *compress_shadowbuf(ShadBuf *shb, int *rectz, int square)
 {
 	ShadSampleBuf *shsample;
 	float dist;
@@ -513,7 +515,6 @@ static void compress_shadowbuf(ShadBuf *shb, int *rectz, int square)
 	char *rc, *rcline, *ctile, *zt;
 	
 	shsample= MEM_callocN(sizeof(ShadSampleBuf), "shad sample buf");
-	BLI_addtail(&shb->buffers, shsample);
 	
 	shsample->zbuf= MEM_mallocN(sizeof(uintptr_t)*(size*size)/256, "initshadbuf2");
 	shsample->cbuf= MEM_callocN((size*size)/256, "initshadbuf3");
@@ -613,6 +614,8 @@ static void compress_shadowbuf(ShadBuf *shb, int *rectz, int square)
 	}
 
 	MEM_freeN(rcline);
+
+	return shsample;
 }
 
 /* sets start/end clipping. lar->shb should be initialized */
@@ -716,26 +719,73 @@ static void shadowbuf_autoclip(Render *re, LampRen *lar)
 	}
 }
 
-static void makeflatshadowbuf(Render *re, LampRen *lar, float *jitbuf)
+typedef struct FlatShadowBufData {
+	Render *re;
+	LampRen *lar;
+	float *jitbuf;
+	ShadSampleBuf **shsamples;
+} FlatShadowBufData;
+
+static void makeflatshadowbuf_sample(void *userdata, void *UNUSED(userdata_chunk), int sample)
 {
-	ShadBuf *shb= lar->shb;
-	int *rectz, samples;
+	FlatShadowBufData *data = userdata;
+	Render *re = data->re;
+	LampRen *lar = data->lar;
+	ShadBuf *shb = lar->shb;
+	int *rectz;
+
+	if (re->test_break(re->tbh))
+		return;
 
 	/* zbuffering */
 	rectz= MEM_mapallocN(sizeof(int)*shb->size*shb->size, "makeshadbuf");
-	
-	for (samples=0; samples<shb->totbuf; samples++) {
-		zbuffer_shadow(re, shb->persmat, lar, rectz, shb->size, jitbuf[2*samples], jitbuf[2*samples+1]);
-		/* create Z tiles (for compression): this system is 24 bits!!! */
-		compress_shadowbuf(shb, rectz, lar->mode & LA_SQUARE);
 
-		if (re->test_break(re->tbh))
-			break;
-	}
-	
+	zbuffer_shadow(re, shb->persmat, lar, rectz, shb->size, data->jitbuf[2*sample], data->jitbuf[2*sample+1]);
+	/* create Z tiles (for compression): this system is 24 bits!!! */
+	data->shsamples[sample] = compress_shadowbuf(shb, rectz, lar->mode & LA_SQUARE);
+
 	MEM_freeN(rectz);
 }
 
+/* samples of one lamp are only made in parallel when there are fewer shadow buffers than threads,
+ * otherwise threaded_makeshadowbufs keeps all threads busy already and every sample needs its own z-buffer */
+static bool shadowbuf_use_sample_threads(Render *re, ShadBuf *shb)
+{
+	LampRen *lar;
+	int totshb= 0;
+
+	if (shb->totbuf <= 1 || !G.is_rendering)
+		return false;
+
+	for (lar=re->lampren.first; lar; lar= lar->next)
+		if (lar->shb)
+			totshb++;
+
+	return totshb < re->r.threads;
+}
+
+static void makeflatshadowbuf(Render *re, LampRen *lar, float *jitbuf)
+{
+	ShadBuf *shb= lar->shb;
+	FlatShadowBufData data;
+	int samples;
+
+	data.re = re;
+	data.lar = lar;
+	data.jitbuf = jitbuf;
+	data.shsamples = MEM_callocN(sizeof(*data.shsamples)*shb->totbuf, "makeshadbuf samples");
+
+	BLI_task_parallel_range_ex(0, shb->totbuf, &data, NULL, 0, makeflatshadowbuf_sample,
+	                           shadowbuf_use_sample_threads(re, shb), false);
+
+	/* keep the samples in order, when canceled some may be missing */
+	for (samples=0; samples<shb->totbuf; samples++)
+		if (data.shsamples[samples])
+			BLI_addtail(&shb->buffers, data.shsamples[samples]);
+	
+	MEM_freeN(data.shsamples);
+}
+
 static void makedeepshadowbuf(Render *re, LampRen *lar, float *jitbuf)
 {
 	ShadBuf *shb= lar->shb;
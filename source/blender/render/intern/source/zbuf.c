@@ -3060,8 +3060,13 @@ void RE_zbuf_accumulate_vecblur(NodeBlurData *nbd, int xsize, int ysize, float *
 	
 	/* has to become static, the init-jit calls a random-seed, screwing up texture noise node */
 	if (firsttime) {
-		firsttime= 0;
-		BLI_jitter_init(jit, 256);
+		/* the compositor blurs strips of an image in parallel */
+		BLI_lock_thread(LOCK_CUSTOM1);
+		if (firsttime) {
+			BLI_jitter_init(jit, 256);
+			firsttime= 0;
+		}
+		BLI_unlock_thread(LOCK_CUSTOM1);
 	}
 	
 	memset(newrect, 0, sizeof(float)*xsize*ysize*4);
@@ -44,6 +44,7 @@
 #include "BLI_utildefines.h"
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
+#include "BLI_trace.h"
 
 #include "BKE_context.h"
 #include "BKE_idprop.h"
@@ -481,18 +482,25 @@ void wm_close_and_free_all(bContext *C, ListBase *wmlist)
 void WM_main(bContext *C)
 {
 	while (1) {
+		double trace_start;
 		
 		/* get events from ghost, handle window events, add to window queues */
 		wm_window_process_events(C); 
 		
 		/* per window, all events to the window, screen, area and region handlers */
+		trace_start = BLI_trace_begin();
 		wm_event_do_handlers(C);
+		BLI_trace_end("wm_event_do_handlers", trace_start);
 		
 		/* events have left notes about changes, we handle and cache it */
+		trace_start = BLI_trace_begin();
 		wm_event_do_notifiers(C);
+		BLI_trace_end("wm_event_do_notifiers", trace_start);
 		
 		/* execute cached changes draw */
+		trace_start = BLI_trace_begin();
 		wm_draw_update(C);
+		BLI_trace_end("wm_draw_update", trace_start);
 	}
 }
 
@@ -56,6 +56,7 @@
 #include "BLI_linklist.h"
 #include "BLI_utildefines.h"
 #include "BLI_threads.h"
+#include "BLI_task.h"
 #include "BLI_callbacks.h"
 #include "BLI_system.h"
 #include BLI_SYSTEM_PID_H
@@ -86,6 +87,7 @@
 
 #include "BLO_readfile.h"
 #include "BLO_writefile.h"
+#include "BLO_undofile.h"
 
 #include "RNA_access.h"
 
@@ -1205,6 +1207,55 @@ void wm_autosave_location(char *filepath)
 	BLI_make_file_string("/", filepath, BKE_tempdir_base(), path);
 }
 
+/* Autosave takes a snapshot of the file in memory (as an undo step does),
+ * and writes it to disk from a background thread so large files don't block the UI. */
+static TaskPool *wm_autosave_pool = NULL;
+
+typedef struct AutosaveWriteData {
+	MemFile memfile;
+	char filepath[FILE_MAX];
+} AutosaveWriteData;
+
+static void wm_autosave_write_task(TaskPool *__restrict UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	AutosaveWriteData *data = taskdata;
+
+	BLO_memfile_write_file(&data->memfile, data->filepath);
+	BLO_memfile_free(&data->memfile);
+}
+
+static void wm_autosave_write(Main *bmain, const char *filepath, int fileflags)
+{
+	AutosaveWriteData *data;
+
+	/* the previous autosave is normally done long ago */
+	wm_autosave_write_wait();
+
+	data = MEM_callocN(sizeof(*data), __func__);
+	BLI_strncpy(data->filepath, filepath, sizeof(data->filepath));
+
+	if (BLO_write_file_mem(bmain, NULL, &data->memfile, fileflags) == 0) {
+		BLO_memfile_free(&data->memfile);
+		MEM_freeN(data);
+		return;
+	}
+
+	wm_autosave_pool = BLI_task_pool_create_background(BLI_task_scheduler_get(), NULL);
+	BLI_task_pool_push(wm_autosave_pool, wm_autosave_write_task, data, true, TASK_PRIORITY_LOW);
+}
+
+/**
+ * Wait for the autosave being written in the background, if any.
+ */
+void wm_autosave_write_wait(void)
+{
+	if (wm_autosave_pool) {
+		BLI_task_pool_work_and_wait(wm_autosave_pool);
+		BLI_task_pool_free(wm_autosave_pool);
+		wm_autosave_pool = NULL;
+	}
+}
+
 void WM_autosave_init(wmWindowManager *wm)
 {
 	wm_autosave_timer_ended(wm);
@@ -1233,18 +1284,16 @@ void wm_autosave_timer(const bContext *C, wmWindowManager *wm, wmTimer *UNUSED(w
 
 	wm_autosave_location(filepath);
 
-	if (U.uiflag & USER_GLOBALUNDO) {
-		/* fast save of last undobuffer, now with UI */
-		BKE_undo_save_file(filepath);
-	}
-	else {
-		/*  save as regular blend file */
+	{
 		int fileflags = G.fileflags & ~(G_FILE_COMPRESS | G_FILE_AUTOPLAY | G_FILE_HISTORY);
 
-		ED_editors_flush_edits(C, false);
+		/* with global undo, save the state of the last undo step (as it did when writing the undo buffer) */
+		if ((U.uiflag & USER_GLOBALUNDO) == 0) {
+			ED_editors_flush_edits(C, false);
+		}
 
 		/* no error reporting to console */
-		BLO_write_file(CTX_data_main(C), filepath, fileflags, NULL, NULL);
+		wm_autosave_write(CTX_data_main(C), filepath, fileflags);
 	}
 	/* do timer after file write, just in case file write takes a long time */
 	wm->autosavetimer = WM_event_add_timer(wm, NULL, TIMERAUTOSAVE, U.savetime * 60.0);
@@ -1262,6 +1311,7 @@ void wm_autosave_delete(void)
 {
 	char filename[FILE_MAX];
 	
+	wm_autosave_write_wait();
 	wm_autosave_location(filename);
 
 	if (BLI_exists(filename)) {
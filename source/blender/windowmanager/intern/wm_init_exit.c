@@ -49,6 +49,7 @@
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_threads.h"
+#include "BLI_trace.h"
 #include "BLI_utildefines.h"
 
 #include "BLO_writefile.h"
@@ -576,8 +577,17 @@ void WM_exit_ext(bContext *C, const bool do_python)
 	
 	GHOST_DisposeSystemPaths();
 
+	/* before the task scheduler is freed */
+	wm_autosave_write_wait();
+
+	/* only writes when --debug-trace is used, nothing may be running anymore */
+	BLI_trace_exit();
+
 	BLI_threadapi_exit();
 
+	/* only prints when --debug-memory-profile is used */
+	MEM_print_profile();
+
 	if (MEM_get_memory_blocks_in_use() != 0) {
 		size_t mem_in_use = MEM_get_memory_in_use() + MEM_get_memory_in_use();
 		printf("Error: Not freed memory blocks: %u, total unfreed memory %f MB\n",
@@ -73,6 +73,7 @@ void wm_jobs_timer_ended(wmWindowManager *wm, wmTimer *wt);
 void wm_autosave_timer(const bContext *C, wmWindowManager *wm, wmTimer *wt);
 void wm_autosave_timer_ended(wmWindowManager *wm);
 void wm_autosave_delete(void);
+void wm_autosave_write_wait(void);
 void wm_autosave_read(bContext *C, struct ReportList *reports);
 void wm_autosave_location(char *filepath);
 
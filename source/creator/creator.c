@@ -69,6 +69,7 @@
 #include "BLI_blenlib.h"
 #include "BLI_mempool.h"
 #include "BLI_system.h"
+#include "BLI_trace.h"
 #include BLI_SYSTEM_PID_H
 
 #include "DNA_ID.h"
@@ -303,6 +304,7 @@ static int print_help(int UNUSED(argc), const char **UNUSED(argv), void *data)
 	BLI_argsPrintArgDoc(ba, "--python-console");
 	BLI_argsPrintArgDoc(ba, "--python-exit-code");
 	BLI_argsPrintArgDoc(ba, "--addons");
+	BLI_argsPrintArgDoc(ba, "--addons-render-only");
 
 
 	printf("\n");
@@ -323,7 +325,9 @@ static int print_help(int UNUSED(argc), const char **UNUSED(argv), void *data)
 	BLI_argsPrintArgDoc(ba, "--debug-cycles");
 #endif
 	BLI_argsPrintArgDoc(ba, "--debug-memory");
+	BLI_argsPrintArgDoc(ba, "--debug-memory-profile");
 	BLI_argsPrintArgDoc(ba, "--debug-jobs");
+	BLI_argsPrintArgDoc(ba, "--debug-trace");
 	BLI_argsPrintArgDoc(ba, "--debug-python");
 	BLI_argsPrintArgDoc(ba, "--debug-depsgraph");
 	BLI_argsPrintArgDoc(ba, "--debug-depsgraph-no-threads");
@@ -590,6 +594,39 @@ static int debug_mode_memory(int UNUSED(argc), const char **UNUSED(argv), void *
 	return 0;
 }
 
+static int debug_mode_memory_profile(int argc, const char **argv, void *UNUSED(data))
+{
+	const char *arg_id = "--debug-memory-profile";
+	if (argc > 1) {
+		const char *err_msg = NULL;
+		int value;
+		if (!parse_int_clamp(argv[1], 1, INT_MAX, &value, &err_msg)) {
+			printf("\nError: %s '%s %s'.\n", err_msg, arg_id, argv[1]);
+			return 1;
+		}
+
+		MEM_enable_profile((unsigned int)value);
+
+		return 1;
+	}
+	else {
+		printf("\nError: you must specify the sample rate.\n");
+		return 0;
+	}
+}
+
+static int debug_mode_trace(int argc, const char **argv, void *UNUSED(data))
+{
+	if (argc > 1) {
+		BLI_trace_init(argv[1]);
+		return 1;
+	}
+	else {
+		printf("\nError: you must specify a path for the trace file.\n");
+		return 0;
+	}
+}
+
 static int set_debug_value(int argc, const char **argv, void *UNUSED(data))
 {
 	const char *arg_id = "--debug-value";
@@ -815,6 +852,12 @@ static int set_factory_startup(int UNUSED(argc), const char **UNUSED(argv), void
 	return 0;
 }
 
+static int set_addons_render_only(int UNUSED(argc), const char **UNUSED(argv), void *UNUSED(data))
+{
+	G.addons_render_only = true;
+	return 0;
+}
+
 static int set_env(int argc, const char **argv, void *UNUSED(data))
 {
 	/* "--env-system-scripts" --> "BLENDER_SYSTEM_SCRIPTS" */
@@ -1676,9 +1719,11 @@ static void setupArguments(bContext *C, bArgs *ba, SYS_SystemHandle *syshandle)
 	BLI_argsAdd(ba, 1, NULL, "--debug-cycles", "\n\tEnable debug messages from Cycles", debug_mode_cycles, NULL);
 #endif
 	BLI_argsAdd(ba, 1, NULL, "--debug-memory", "\n\tEnable fully guarded memory allocation and debugging", debug_mode_memory, NULL);
+	BLI_argsAdd(ba, 1, NULL, "--debug-memory-profile", "<rate>\n\tSample one in <rate> allocations, printing memory statistics per allocation name on exit", debug_mode_memory_profile, NULL);
 
 	BLI_argsAdd(ba, 1, NULL, "--debug-value", "<value>\n\tSet debug value of <value> on startup\n", set_debug_value, NULL);
 	BLI_argsAdd(ba, 1, NULL, "--debug-jobs",  "\n\tEnable time profiling for background jobs.", debug_mode_generic, (void *)G_DEBUG_JOBS);
+	BLI_argsAdd(ba, 1, NULL, "--debug-trace", "<file>\n\tRecord timings of event handling, drawing, scene updates and modifiers, written to <file> on exit (Chrome trace JSON)", debug_mode_trace, NULL);
 	BLI_argsAdd(ba, 1, NULL, "--debug-gpu",  "\n\tEnable gpu debug context and information for OpenGL 4.3+.", debug_mode_generic, (void *)G_DEBUG_GPU);
 	BLI_argsAdd(ba, 1, NULL, "--debug-depsgraph", "\n\tEnable debug messages from dependency graph", debug_mode_generic, (void *)G_DEBUG_DEPSGRAPH);
 	BLI_argsAdd(ba, 1, NULL, "--debug-depsgraph-no-threads", "\n\tSwitch dependency graph to a single threaded evaluation", debug_mode_generic, (void *)G_DEBUG_DEPSGRAPH_NO_THREADS);
@@ -1688,6 +1733,7 @@ static void setupArguments(bContext *C, bArgs *ba, SYS_SystemHandle *syshandle)
 
 	BLI_argsAdd(ba, 1, NULL, "--verbose", "<verbose>\n\tSet logging verbosity level.", set_verbosity, NULL);
 
+	BLI_argsAdd(ba, 1, NULL, "--addons-render-only", "\n\tIn background mode, only enable the add-ons needed for rendering (category 'Render' or \"render_required\" in bl_info)", set_addons_render_only, NULL);
 	BLI_argsAdd(ba, 1, NULL, "--factory-startup", "\n\tSkip reading the " STRINGIFY(BLENDER_STARTUP_FILE) " in the users home directory", set_factory_startup, NULL);
 
 	/* TODO, add user env vars? */
@@ -0,0 +1,96 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_concurrent_ghash.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+}
+
+#define TESTCASE_SIZE 100000
+
+/* BLI_threadapi_exit() frees the task scheduler for good, so the tests don't call it. */
+
+typedef struct ConcurrentGHashTestData {
+	ConcurrentGHash *cgh;
+	int *added;
+} ConcurrentGHashTestData;
+
+/* every key is added by two iterations, only one of them may succeed */
+static void concurrent_ghash_add_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	ConcurrentGHashTestData *data = (ConcurrentGHashTestData *)userdata;
+	const int key = i / 2;
+
+	if (BLI_concurrent_ghash_add(data->cgh, SET_INT_IN_POINTER(key), SET_INT_IN_POINTER(i))) {
+		data->added[i] = 1;
+	}
+}
+
+static void concurrent_ghash_lookup_or_add_cb(void *userdata, void *UNUSED(userdata_chunk), int i)
+{
+	ConcurrentGHashTestData *data = (ConcurrentGHashTestData *)userdata;
+	const int key = i / 2;
+	void *val = BLI_concurrent_ghash_lookup_or_add(data->cgh, SET_INT_IN_POINTER(key), SET_INT_IN_POINTER(i));
+
+	data->added[i] = GET_INT_FROM_POINTER(val);
+}
+
+TEST(concurrent_ghash, AddParallel)
+{
+	ConcurrentGHash *cgh = BLI_concurrent_ghash_int_new(__func__);
+	int *added = (int *)MEM_callocN(sizeof(*added) * TESTCASE_SIZE * 2, __func__);
+	ConcurrentGHashTestData data = {cgh, added};
+	int i;
+
+	BLI_threadapi_init();
+
+	BLI_task_parallel_range_ex(0, TESTCASE_SIZE * 2, &data, NULL, 0, concurrent_ghash_add_cb, true, true);
+
+	EXPECT_EQ(TESTCASE_SIZE, BLI_concurrent_ghash_size(cgh));
+
+	for (i = 0; i < TESTCASE_SIZE; i++) {
+		void *val = BLI_concurrent_ghash_lookup(cgh, SET_INT_IN_POINTER(i));
+		const int i_added = GET_INT_FROM_POINTER(val);
+
+		EXPECT_TRUE(ELEM(i_added, i * 2, i * 2 + 1));
+		EXPECT_EQ(1, added[i_added]);
+		EXPECT_EQ(0, added[(i_added == i * 2) ? i * 2 + 1 : i * 2]);
+	}
+
+	BLI_concurrent_ghash_free(cgh, NULL, NULL);
+	MEM_freeN(added);
+}
+
+TEST(concurrent_ghash, LookupOrAddParallel)
+{
+	ConcurrentGHash *cgh = BLI_concurrent_ghash_int_new(__func__);
+	int *added = (int *)MEM_callocN(sizeof(*added) * TESTCASE_SIZE * 2, __func__);
+	ConcurrentGHashTestData data = {cgh, added};
+	int i;
+
+	BLI_threadapi_init();
+
+	BLI_task_parallel_range_ex(0, TESTCASE_SIZE * 2, &data, NULL, 0, concurrent_ghash_lookup_or_add_cb, true, true);
+
+	EXPECT_EQ(TESTCASE_SIZE, BLI_concurrent_ghash_size(cgh));
+
+	/* both iterations of a key got the same value */
+	for (i = 0; i < TESTCASE_SIZE; i++) {
+		EXPECT_EQ(added[i * 2], added[i * 2 + 1]);
+		EXPECT_EQ(added[i * 2], GET_INT_FROM_POINTER(BLI_concurrent_ghash_lookup(cgh, SET_INT_IN_POINTER(i))));
+	}
+
+	for (i = 0; i < TESTCASE_SIZE; i += 2) {
+		EXPECT_TRUE(BLI_concurrent_ghash_remove(cgh, SET_INT_IN_POINTER(i), NULL, NULL));
+		EXPECT_FALSE(BLI_concurrent_ghash_haskey(cgh, SET_INT_IN_POINTER(i)));
+	}
+
+	EXPECT_EQ(TESTCASE_SIZE / 2, BLI_concurrent_ghash_size(cgh));
+
+	BLI_concurrent_ghash_free(cgh, NULL, NULL);
+	MEM_freeN(added);
+}
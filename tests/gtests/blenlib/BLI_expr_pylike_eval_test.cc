@@ -0,0 +1,154 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <math.h>
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_expr_pylike_eval.h"
+#include "BLI_math_base.h"
+}
+
+#define TRUE_VAL 1.0
+#define FALSE_VAL 0.0
+
+static void expr_pylike_parse_fail_test(const char *str)
+{
+	ExprPyLike_Parsed *expr = BLI_expr_pylike_parse(str, NULL, 0);
+
+	EXPECT_FALSE(BLI_expr_pylike_is_valid(expr));
+
+	BLI_expr_pylike_free(expr);
+}
+
+static void expr_pylike_error_test(const char *str, double x, eExprPyLike_EvalStatus error)
+{
+	const char *names[1] = {"x"};
+	ExprPyLike_Parsed *expr = BLI_expr_pylike_parse(str, names, ARRAY_SIZE(names));
+	double result;
+
+	EXPECT_TRUE(BLI_expr_pylike_is_valid(expr));
+	EXPECT_EQ(error, BLI_expr_pylike_eval(expr, &x, 1, &result));
+
+	BLI_expr_pylike_free(expr);
+}
+
+static void expr_pylike_eval_test(const char *str, double x, double value)
+{
+	const char *names[1] = {"x"};
+	ExprPyLike_Parsed *expr = BLI_expr_pylike_parse(str, names, ARRAY_SIZE(names));
+	double result;
+
+	EXPECT_TRUE(BLI_expr_pylike_is_valid(expr));
+	EXPECT_EQ(EXPR_PYLIKE_SUCCESS, BLI_expr_pylike_eval(expr, &x, 1, &result));
+	EXPECT_EQ(value, result);
+
+	BLI_expr_pylike_free(expr);
+}
+
+#define TEST_PARSE_FAIL(name, str) \
+	TEST(expr_pylike_eval, ParseFail_##name) { expr_pylike_parse_fail_test(str); }
+
+TEST_PARSE_FAIL(Empty, "")
+TEST_PARSE_FAIL(ConstHex, "0x0")
+TEST_PARSE_FAIL(ConstOctal, "01")
+TEST_PARSE_FAIL(Tail, "0 0")
+TEST_PARSE_FAIL(ConstFloatExp, "0.5e+")
+TEST_PARSE_FAIL(BadId, "Pi")
+TEST_PARSE_FAIL(Attribute, "math.sin(1)")
+TEST_PARSE_FAIL(BadArgCount0, "sqrt()")
+TEST_PARSE_FAIL(BadArgCount1, "sqrt(1, 2)")
+TEST_PARSE_FAIL(BadArgCountMin, "min(1)")
+TEST_PARSE_FAIL(TrailingComma, "min(1, 2,)")
+TEST_PARSE_FAIL(MissingParen, "(1 + 2")
+TEST_PARSE_FAIL(ChainedCompare, "1 < 2 < 3")
+TEST_PARSE_FAIL(TernaryNoElse, "1 if 2")
+TEST_PARSE_FAIL(Newline, "1 +\n2")
+TEST_PARSE_FAIL(Python, "bpy.data.objects['Cube'].location.x")
+
+#define TEST_EVAL(name, str, x, value) \
+	TEST(expr_pylike_eval, Eval_##name) { expr_pylike_eval_test(str, x, value); }
+
+TEST_EVAL(Const, "1.5", 0.0, 1.5)
+TEST_EVAL(ConstExp, "2e3", 0.0, 2000.0)
+TEST_EVAL(ConstFloat, ".5", 0.0, 0.5)
+TEST_EVAL(ConstZeros, "000", 0.0, 0.0)
+TEST_EVAL(ConstPi, "pi", 0.0, M_PI)
+TEST_EVAL(ConstTrue, "True", 0.0, TRUE_VAL)
+TEST_EVAL(Param, "x", 2.5, 2.5)
+TEST_EVAL(Arith, "x * 2 + 0.5", 3.0, 6.5)
+TEST_EVAL(Priority, "1 + 2 * 3 - 4 / 2", 0.0, 5.0)
+TEST_EVAL(Parens, "(1 + 2) * 3", 0.0, 9.0)
+TEST_EVAL(UnaryMinus, "--x", 2.0, 2.0)
+TEST_EVAL(PowerUnary, "-2 ** 2", 0.0, -4.0)
+TEST_EVAL(PowerRightAssoc, "2 ** 3 ** 2", 0.0, 512.0)
+TEST_EVAL(PowerNegative, "2 ** -1", 0.0, 0.5)
+TEST_EVAL(FloorDiv, "-7 // 2", 0.0, -4.0)
+TEST_EVAL(Mod, "-7 % 3", 0.0, 2.0)
+TEST_EVAL(ModNegative, "7 % -3", 0.0, -2.0)
+TEST_EVAL(Func1, "sin(x / 10)", 5.0, sin(0.5))
+TEST_EVAL(Func2, "atan2(x, 1)", 1.0, atan2(1.0, 1.0))
+TEST_EVAL(LogBase, "log(x, 2)", 8.0, log(8.0) / log(2.0))
+TEST_EVAL(Radians, "radians(180)", 0.0, M_PI)
+TEST_EVAL(Min, "min(3, x, 2)", 1.0, 1.0)
+TEST_EVAL(Max, "max(3, x, 2)", 1.0, 3.0)
+TEST_EVAL(Abs, "abs(x)", -2.0, 2.0)
+TEST_EVAL(Compare, "x >= 1", 1.0, TRUE_VAL)
+TEST_EVAL(CompareFalse, "x != 1", 1.0, FALSE_VAL)
+TEST_EVAL(Not, "not x", 0.0, TRUE_VAL)
+TEST_EVAL(And, "x and 2", 3.0, 2.0)
+TEST_EVAL(AndFalse, "x and 2", 0.0, 0.0)
+TEST_EVAL(Or, "x or 2", 3.0, 3.0)
+TEST_EVAL(OrFalse, "x or 2", 0.0, 2.0)
+TEST_EVAL(AndOr, "0 or x and 4 or 5", 1.0, 4.0)
+TEST_EVAL(NotCompare, "not x < 1", 2.0, TRUE_VAL)
+TEST_EVAL(Ternary, "1 if x > 0 else 2", 1.0, 1.0)
+TEST_EVAL(TernaryElse, "1 if x > 0 else 2", -1.0, 2.0)
+TEST_EVAL(TernaryNested, "1 if x > 1 else 2 if x > 0 else 3", 0.5, 2.0)
+TEST_EVAL(TernaryOr, "x or 3 if x or 0 else 4 or x", 0.0, 4.0)
+TEST_EVAL(TernaryInArgs, "max(1 if x < 0 else 2, 0)", 1.0, 2.0)
+
+/* the value isn't evaluated when the condition is false, so it can't cause errors */
+TEST_EVAL(TernaryLazy, "1 / x if x else 0", 0.0, 0.0)
+TEST_EVAL(OrLazy, "x or 1 / x", 2.0, 2.0)
+
+#define TEST_ERROR(name, str, x, code) \
+	TEST(expr_pylike_eval, Error_##name) { expr_pylike_error_test(str, x, code); }
+
+TEST_ERROR(DivZero, "1 / x", 0.0, EXPR_PYLIKE_DIV_BY_ZERO)
+TEST_ERROR(FloorDivZero, "1 // x", 0.0, EXPR_PYLIKE_DIV_BY_ZERO)
+TEST_ERROR(ModZero, "1 % x", 0.0, EXPR_PYLIKE_DIV_BY_ZERO)
+TEST_ERROR(PowZero, "x ** -1", 0.0, EXPR_PYLIKE_DIV_BY_ZERO)
+TEST_ERROR(SqrtDomain, "sqrt(x)", -1.0, EXPR_PYLIKE_MATH_ERROR)
+TEST_ERROR(LogDomain, "log(x)", 0.0, EXPR_PYLIKE_MATH_ERROR)
+TEST_ERROR(ExpOverflow, "exp(x)", 1000.0, EXPR_PYLIKE_MATH_ERROR)
+TEST_ERROR(PowComplex, "x ** 0.5", -1.0, EXPR_PYLIKE_MATH_ERROR)
+
+TEST(expr_pylike_eval, ParamShadowsConst)
+{
+	const char *names[2] = {"pi", "x"};
+	const double values[2] = {2.0, 3.0};
+	ExprPyLike_Parsed *expr = BLI_expr_pylike_parse("pi * x", names, ARRAY_SIZE(names));
+	double result;
+
+	EXPECT_EQ(EXPR_PYLIKE_SUCCESS, BLI_expr_pylike_eval(expr, values, ARRAY_SIZE(values), &result));
+	EXPECT_EQ(6.0, result);
+
+	/* too few values */
+	EXPECT_EQ(EXPR_PYLIKE_FATAL_ERROR, BLI_expr_pylike_eval(expr, values, 1, &result));
+
+	BLI_expr_pylike_free(expr);
+}
+
+TEST(expr_pylike_eval, ParamCall)
+{
+	const char *names[1] = {"sin"};
+	ExprPyLike_Parsed *expr = BLI_expr_pylike_parse("sin(1)", names, ARRAY_SIZE(names));
+
+	/* calling a float fails in Python */
+	EXPECT_FALSE(BLI_expr_pylike_is_valid(expr));
+
+	BLI_expr_pylike_free(expr);
+}
@@ -9,6 +9,7 @@ extern "C" {
 #include "MEM_guardedalloc.h"
 #include "BLI_utildefines.h"
 #include "BLI_ghash.h"
+#include "BLI_ohash.h"
 #include "BLI_rand.h"
 #include "BLI_string.h"
 #include "PIL_time_utildefines.h"
@@ -32,6 +33,16 @@ extern "C" {
 	       BLI_ghash_size(_gh), q, var, lf, pempty * 100.0, poverloaded * 100.0, bigb); \
 } void (0)
 
+#define PRINTF_OHASH_STATS(_oh) \
+{ \
+	double q, lf; \
+	int bigp; \
+	q = BLI_ohash_calc_quality_ex((_oh), &lf, &bigp); \
+	printf("OHash stats (%u entries):\n\t" \
+	       "Average probe length (the lower the better): %f\n\tLoad: %f\n\tBiggest probe length: %d\n", \
+	       BLI_ohash_size(_oh), q, lf, bigp); \
+} void (0)
+
 
 /* Str: whole text, lines and words from a 'corpus' text. */
 
@@ -413,3 +424,239 @@ TEST(ghash, Int4Murmur2a20000000)
 
 	int4_ghash_tests(ghash, "Int4GHash - Murmur - 20000000", 20000000);
 }
+
+
+/* OHash: the same integer tests, and pointer keys, with the open addressing hash. */
+
+static void int_ohash_tests(OHash *ohash, const char *id, const unsigned int nbr)
+{
+	printf("\n========== STARTING %s ==========\n", id);
+
+	{
+		unsigned int i = nbr;
+
+		TIMEIT_START(int_insert);
+
+#ifdef GHASH_RESERVE
+		BLI_ohash_reserve(ohash, nbr);
+#endif
+
+		while (i--) {
+			BLI_ohash_insert(ohash, SET_UINT_IN_POINTER(i), SET_UINT_IN_POINTER(i));
+		}
+
+		TIMEIT_END(int_insert);
+	}
+
+	PRINTF_OHASH_STATS(ohash);
+
+	{
+		unsigned int i = nbr;
+
+		TIMEIT_START(int_lookup);
+
+		while (i--) {
+			void *v = BLI_ohash_lookup(ohash, SET_UINT_IN_POINTER(i));
+			EXPECT_EQ(i, GET_UINT_FROM_POINTER(v));
+		}
+
+		TIMEIT_END(int_lookup);
+	}
+
+	BLI_ohash_free(ohash, NULL);
+
+	printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(ohash, IntOHash12000)
+{
+	OHash *ohash = BLI_ohash_new(__func__);
+
+	int_ohash_tests(ohash, "IntOHash - OHash - 12000", 12000);
+}
+
+TEST(ohash, IntOHash100000000)
+{
+	OHash *ohash = BLI_ohash_new(__func__);
+
+	int_ohash_tests(ohash, "IntOHash - OHash - 100000000", 100000000);
+}
+
+static void randint_ohash_tests(OHash *ohash, const char *id, const unsigned int nbr)
+{
+	printf("\n========== STARTING %s ==========\n", id);
+
+	unsigned int *data = (unsigned int *)MEM_mallocN(sizeof(*data) * (size_t)nbr, __func__);
+	unsigned int *dt;
+	unsigned int i;
+
+	{
+		RNG *rng = BLI_rng_new(0);
+		for (i = nbr, dt = data; i--; dt++) {
+			*dt = BLI_rng_get_uint(rng);
+		}
+		BLI_rng_free(rng);
+	}
+
+	{
+		TIMEIT_START(int_insert);
+
+#ifdef GHASH_RESERVE
+		BLI_ohash_reserve(ohash, nbr);
+#endif
+
+		/* random keys may be there already, OHash doesn't allow duplicates */
+		for (i = nbr, dt = data; i--; dt++) {
+			BLI_ohash_reinsert(ohash, SET_UINT_IN_POINTER(*dt), SET_UINT_IN_POINTER(*dt), NULL);
+		}
+
+		TIMEIT_END(int_insert);
+	}
+
+	PRINTF_OHASH_STATS(ohash);
+
+	{
+		TIMEIT_START(int_lookup);
+
+		for (i = nbr, dt = data; i--; dt++) {
+			void *v = BLI_ohash_lookup(ohash, SET_UINT_IN_POINTER(*dt));
+			EXPECT_EQ(*dt, GET_UINT_FROM_POINTER(v));
+		}
+
+		TIMEIT_END(int_lookup);
+	}
+
+	BLI_ohash_free(ohash, NULL);
+	MEM_freeN(data);
+
+	printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(ohash, IntRandOHash12000)
+{
+	OHash *ohash = BLI_ohash_new(__func__);
+
+	randint_ohash_tests(ohash, "RandIntOHash - OHash - 12000", 12000);
+}
+
+TEST(ohash, IntRandOHash50000000)
+{
+	OHash *ohash = BLI_ohash_new(__func__);
+
+	randint_ohash_tests(ohash, "RandIntOHash - OHash - 50000000", 50000000);
+}
+
+
+/* Ptr: 20M pointers to the items of an array, like the old to new pointer maps of file reading. */
+
+typedef struct PtrTestItem {
+	void *data[3];
+} PtrTestItem;
+
+static void ptr_ghash_tests(GHash *ghash, const char *id, const unsigned int nbr)
+{
+	printf("\n========== STARTING %s ==========\n", id);
+
+	PtrTestItem *data = (PtrTestItem *)MEM_mallocN(sizeof(*data) * (size_t)nbr, __func__);
+	unsigned int i;
+
+	{
+		TIMEIT_START(ptr_insert);
+
+#ifdef GHASH_RESERVE
+		BLI_ghash_reserve(ghash, nbr);
+#endif
+
+		for (i = 0; i < nbr; i++) {
+			BLI_ghash_insert(ghash, &data[i], SET_UINT_IN_POINTER(i));
+		}
+
+		TIMEIT_END(ptr_insert);
+	}
+
+	PRINTF_GHASH_STATS(ghash);
+
+	{
+		TIMEIT_START(ptr_lookup);
+
+		for (i = 0; i < nbr; i++) {
+			void *v = BLI_ghash_lookup(ghash, &data[i]);
+			EXPECT_EQ(i, GET_UINT_FROM_POINTER(v));
+		}
+
+		TIMEIT_END(ptr_lookup);
+	}
+
+	BLI_ghash_free(ghash, NULL, NULL);
+	MEM_freeN(data);
+
+	printf("========== ENDED %s ==========\n\n", id);
+}
+
+static void ptr_ohash_tests(OHash *ohash, const char *id, const unsigned int nbr)
+{
+	printf("\n========== STARTING %s ==========\n", id);
+
+	PtrTestItem *data = (PtrTestItem *)MEM_mallocN(sizeof(*data) * (size_t)nbr, __func__);
+	unsigned int i;
+
+	{
+		TIMEIT_START(ptr_insert);
+
+#ifdef GHASH_RESERVE
+		BLI_ohash_reserve(ohash, nbr);
+#endif
+
+		for (i = 0; i < nbr; i++) {
+			BLI_ohash_insert(ohash, &data[i], SET_UINT_IN_POINTER(i));
+		}
+
+		TIMEIT_END(ptr_insert);
+	}
+
+	PRINTF_OHASH_STATS(ohash);
+
+	{
+		TIMEIT_START(ptr_lookup);
+
+		for (i = 0; i < nbr; i++) {
+			void *v = BLI_ohash_lookup(ohash, &data[i]);
+			EXPECT_EQ(i, GET_UINT_FROM_POINTER(v));
+		}
+
+		TIMEIT_END(ptr_lookup);
+	}
+
+	BLI_ohash_free(ohash, NULL);
+	MEM_freeN(data);
+
+	printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(ghash, PtrGHash12000)
+{
+	GHash *ghash = BLI_ghash_ptr_new(__func__);
+
+	ptr_ghash_tests(ghash, "PtrGHash - GHash - 12000", 12000);
+}
+
+TEST(ghash, PtrGHash20000000)
+{
+	GHash *ghash = BLI_ghash_ptr_new(__func__);
+
+	ptr_ghash_tests(ghash, "PtrGHash - GHash - 20000000", 20000000);
+}
+
+TEST(ohash, PtrOHash12000)
+{
+	OHash *ohash = BLI_ohash_new(__func__);
+
+	ptr_ohash_tests(ohash, "PtrOHash - OHash - 12000", 12000);
+}
+
+TEST(ohash, PtrOHash20000000)
+{
+	OHash *ohash = BLI_ohash_new(__func__);
+
+	ptr_ohash_tests(ohash, "PtrOHash - OHash - 20000000", 20000000);
+}
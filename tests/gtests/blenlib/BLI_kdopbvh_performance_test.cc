@@ -0,0 +1,189 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+#include "testing/testing_benchmark.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_kdopbvh.h"
+#include "BLI_math.h"
+#include "BLI_rand.h"
+#include "BLI_threads.h"
+}
+
+/* triangles of a displaced grid, similar to the trees built for snapping & ray casting meshes */
+#define GRID_RES 500
+#define TRIS_NUM ((GRID_RES - 1) * (GRID_RES - 1) * 2)
+#define QUERY_NUM 10000
+
+typedef struct BVHBenchData {
+	float (*verts)[3];
+	unsigned int (*tris)[3];
+	float (*queries)[3];
+	float (*dirs)[3];
+	BVHTree *tree;
+	int tree_type;
+} BVHBenchData;
+
+static void bvh_bench_mesh(BVHBenchData *data)
+{
+	RNG *rng = BLI_rng_new(0);
+	int i = 0;
+
+	data->verts = (float (*)[3])MEM_mallocN(sizeof(*data->verts) * GRID_RES * GRID_RES, __func__);
+	data->tris = (unsigned int (*)[3])MEM_mallocN(sizeof(*data->tris) * TRIS_NUM, __func__);
+
+	for (int y = 0; y < GRID_RES; y++) {
+		for (int x = 0; x < GRID_RES; x++) {
+			float *co = data->verts[y * GRID_RES + x];
+			co[0] = (float)x / (float)GRID_RES;
+			co[1] = (float)y / (float)GRID_RES;
+			co[2] = BLI_rng_get_float(rng) * 0.01f;
+		}
+	}
+
+	for (int y = 0; y < GRID_RES - 1; y++) {
+		for (int x = 0; x < GRID_RES - 1; x++) {
+			const unsigned int v = (unsigned int)(y * GRID_RES + x);
+			ARRAY_SET_ITEMS(data->tris[i], v, v + 1, v + GRID_RES + 1);
+			ARRAY_SET_ITEMS(data->tris[i + 1], v, v + GRID_RES + 1, v + GRID_RES);
+			i += 2;
+		}
+	}
+
+	data->queries = (float (*)[3])MEM_mallocN(sizeof(*data->queries) * QUERY_NUM, __func__);
+	data->dirs = (float (*)[3])MEM_mallocN(sizeof(*data->dirs) * QUERY_NUM, __func__);
+	for (i = 0; i < QUERY_NUM; i++) {
+		data->queries[i][0] = BLI_rng_get_float(rng);
+		data->queries[i][1] = BLI_rng_get_float(rng);
+		data->queries[i][2] = 0.1f;
+		BLI_rng_get_float_unit_v3(rng, data->dirs[i]);
+		/* point the rays towards the grid */
+		data->dirs[i][2] = -fabsf(data->dirs[i][2]) - 1.0f;
+		normalize_v3(data->dirs[i]);
+	}
+
+	BLI_rng_free(rng);
+}
+
+static void bvh_bench_mesh_free(BVHBenchData *data)
+{
+	MEM_freeN(data->verts);
+	MEM_freeN(data->tris);
+	MEM_freeN(data->queries);
+	MEM_freeN(data->dirs);
+}
+
+static BVHTree *bvh_bench_build(const BVHBenchData *data)
+{
+	BVHTree *tree = BLI_bvhtree_new(TRIS_NUM, 0.0f, data->tree_type, 6);
+	for (int i = 0; i < TRIS_NUM; i++) {
+		float co[3][3];
+		copy_v3_v3(co[0], data->verts[data->tris[i][0]]);
+		copy_v3_v3(co[1], data->verts[data->tris[i][1]]);
+		copy_v3_v3(co[2], data->verts[data->tris[i][2]]);
+		BLI_bvhtree_insert(tree, i, co[0], 3);
+	}
+	BLI_bvhtree_balance(tree);
+	return tree;
+}
+
+static void bvh_ray_cast_cb(void *userdata, int index, const BVHTreeRay *ray, BVHTreeRayHit *hit)
+{
+	const BVHBenchData *data = (const BVHBenchData *)userdata;
+	const unsigned int *tri = data->tris[index];
+	float dist;
+
+	if (isect_ray_tri_v3(ray->origin, ray->direction,
+	                     data->verts[tri[0]], data->verts[tri[1]], data->verts[tri[2]], &dist, NULL) &&
+	    (dist < hit->dist))
+	{
+		hit->index = index;
+		hit->dist = dist;
+		madd_v3_v3v3fl(hit->co, ray->origin, ray->direction, dist);
+	}
+}
+
+static void bvh_nearest_cb(void *userdata, int index, const float co[3], BVHTreeNearest *nearest)
+{
+	const BVHBenchData *data = (const BVHBenchData *)userdata;
+	const unsigned int *tri = data->tris[index];
+	float co_tri[3];
+	float dist_sq;
+
+	closest_on_tri_to_point_v3(co_tri, co, data->verts[tri[0]], data->verts[tri[1]], data->verts[tri[2]]);
+	dist_sq = len_squared_v3v3(co, co_tri);
+	if (dist_sq < nearest->dist_sq) {
+		nearest->index = index;
+		nearest->dist_sq = dist_sq;
+		copy_v3_v3(nearest->co, co_tri);
+	}
+}
+
+static void bvh_build_bench(void *userdata)
+{
+	BVHBenchData *data = (BVHBenchData *)userdata;
+	BLI_bvhtree_free(bvh_bench_build(data));
+}
+
+static void bvh_ray_cast_bench(void *userdata)
+{
+	BVHBenchData *data = (BVHBenchData *)userdata;
+	int hits = 0;
+
+	for (int i = 0; i < QUERY_NUM; i++) {
+		BVHTreeRayHit hit;
+		hit.index = -1;
+		hit.dist = FLT_MAX;
+		BLI_bvhtree_ray_cast(data->tree, data->queries[i], data->dirs[i], 0.0f, &hit, bvh_ray_cast_cb, data);
+		hits += (hit.index != -1);
+	}
+
+	EXPECT_LT(0, hits);
+}
+
+static void bvh_find_nearest_bench(void *userdata)
+{
+	BVHBenchData *data = (BVHBenchData *)userdata;
+	int found = 0;
+
+	for (int i = 0; i < QUERY_NUM; i++) {
+		BVHTreeNearest nearest;
+		nearest.index = -1;
+		nearest.dist_sq = FLT_MAX;
+		BLI_bvhtree_find_nearest(data->tree, data->queries[i], &nearest, bvh_nearest_cb, data);
+		found += (nearest.index != -1);
+	}
+
+	EXPECT_EQ(QUERY_NUM, found);
+}
+
+static void bvh_bench_template(const int tree_type)
+{
+	BVHBenchData data = {NULL};
+
+	BLI_threadapi_init();
+
+	bvh_bench_mesh(&data);
+	data.tree_type = tree_type;
+
+	testing_benchmark_run("build", bvh_build_bench, &data, BENCHMARK_RUNS_DEFAULT);
+
+	data.tree = bvh_bench_build(&data);
+	testing_benchmark_run("ray_cast", bvh_ray_cast_bench, &data, BENCHMARK_RUNS_DEFAULT);
+	testing_benchmark_run("find_nearest", bvh_find_nearest_bench, &data, BENCHMARK_RUNS_DEFAULT);
+	BLI_bvhtree_free(data.tree);
+
+	bvh_bench_mesh_free(&data);
+}
+
+TEST(kdopbvh, Tree4)
+{
+	bvh_bench_template(4);
+}
+
+TEST(kdopbvh, Tree2)
+{
+	bvh_bench_template(2);
+}
@@ -0,0 +1,121 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+#include "testing/testing_benchmark.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_kdtree.h"
+#include "BLI_rand.h"
+#include "BLI_threads.h"
+}
+
+#define POINTS_NUM 1000000
+#define QUERY_NUM 10000
+
+typedef struct KDTreeBenchData {
+	float (*points)[3];
+	float (*queries)[3];
+	KDTree *tree;
+	KDTreeNearest *nearest;
+} KDTreeBenchData;
+
+static void kdtree_bench_points(float (*co)[3], const int co_len, const unsigned int seed)
+{
+	RNG *rng = BLI_rng_new(seed);
+	for (int i = 0; i < co_len; i++) {
+		co[i][0] = BLI_rng_get_float(rng);
+		co[i][1] = BLI_rng_get_float(rng);
+		co[i][2] = BLI_rng_get_float(rng);
+	}
+	BLI_rng_free(rng);
+}
+
+static KDTree *kdtree_bench_build(const float (*points)[3])
+{
+	KDTree *tree = BLI_kdtree_new(POINTS_NUM);
+	for (int i = 0; i < POINTS_NUM; i++) {
+		BLI_kdtree_insert(tree, i, points[i]);
+	}
+	BLI_kdtree_balance(tree);
+	return tree;
+}
+
+static void kdtree_build_bench(void *userdata)
+{
+	KDTreeBenchData *data = (KDTreeBenchData *)userdata;
+	BLI_kdtree_free(kdtree_bench_build((const float (*)[3])data->points));
+}
+
+static void kdtree_find_nearest_bench(void *userdata)
+{
+	KDTreeBenchData *data = (KDTreeBenchData *)userdata;
+	for (int i = 0; i < QUERY_NUM; i++) {
+		BLI_kdtree_find_nearest(data->tree, data->queries[i], &data->nearest[i]);
+	}
+}
+
+static void kdtree_find_nearest_array_bench(void *userdata)
+{
+	KDTreeBenchData *data = (KDTreeBenchData *)userdata;
+	BLI_kdtree_find_nearest_array(data->tree, (const float (*)[3])data->queries, QUERY_NUM, data->nearest, NULL);
+}
+
+static void kdtree_find_nearest_n_bench(void *userdata)
+{
+	KDTreeBenchData *data = (KDTreeBenchData *)userdata;
+	KDTreeNearest nearest[8];
+	for (int i = 0; i < QUERY_NUM; i++) {
+		BLI_kdtree_find_nearest_n(data->tree, data->queries[i], nearest, ARRAY_SIZE(nearest));
+	}
+}
+
+static void kdtree_range_search_bench(void *userdata)
+{
+	KDTreeBenchData *data = (KDTreeBenchData *)userdata;
+	for (int i = 0; i < QUERY_NUM; i++) {
+		KDTreeNearest *nearest = NULL;
+		if (BLI_kdtree_range_search(data->tree, data->queries[i], &nearest, 0.01f)) {
+			MEM_freeN(nearest);
+		}
+	}
+}
+
+TEST(kdtree, Build)
+{
+	KDTreeBenchData data = {NULL};
+
+	BLI_threadapi_init();
+
+	data.points = (float (*)[3])MEM_mallocN(sizeof(*data.points) * POINTS_NUM, __func__);
+	kdtree_bench_points(data.points, POINTS_NUM, 0);
+
+	testing_benchmark_run("", kdtree_build_bench, &data, BENCHMARK_RUNS_DEFAULT);
+
+	MEM_freeN(data.points);
+}
+
+TEST(kdtree, Query)
+{
+	KDTreeBenchData data = {NULL};
+
+	BLI_threadapi_init();
+
+	data.points = (float (*)[3])MEM_mallocN(sizeof(*data.points) * POINTS_NUM, __func__);
+	data.queries = (float (*)[3])MEM_mallocN(sizeof(*data.queries) * QUERY_NUM, __func__);
+	data.nearest = (KDTreeNearest *)MEM_mallocN(sizeof(*data.nearest) * QUERY_NUM, __func__);
+	kdtree_bench_points(data.points, POINTS_NUM, 0);
+	kdtree_bench_points(data.queries, QUERY_NUM, 1);
+	data.tree = kdtree_bench_build((const float (*)[3])data.points);
+
+	testing_benchmark_run("find_nearest", kdtree_find_nearest_bench, &data, BENCHMARK_RUNS_DEFAULT);
+	testing_benchmark_run("find_nearest_array", kdtree_find_nearest_array_bench, &data, BENCHMARK_RUNS_DEFAULT);
+	testing_benchmark_run("find_nearest_n", kdtree_find_nearest_n_bench, &data, BENCHMARK_RUNS_DEFAULT);
+	testing_benchmark_run("range_search", kdtree_range_search_bench, &data, BENCHMARK_RUNS_DEFAULT);
+
+	BLI_kdtree_free(data.tree);
+	MEM_freeN(data.nearest);
+	MEM_freeN(data.queries);
+	MEM_freeN(data.points);
+}
@@ -0,0 +1,96 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+#include "testing/testing_benchmark.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_mempool.h"
+}
+
+#define ELEM_NUM 1000000
+
+/* size of a BMVert on 64bit, a typical mempool element */
+#define ELEM_SIZE 64
+
+typedef struct MempoolBenchData {
+	void **elems;
+	int chunk_size;
+} MempoolBenchData;
+
+static void mempool_alloc_free_bench(void *userdata)
+{
+	MempoolBenchData *data = (MempoolBenchData *)userdata;
+	BLI_mempool *pool = BLI_mempool_create(ELEM_SIZE, 0, data->chunk_size, BLI_MEMPOOL_NOP);
+
+	for (int i = 0; i < ELEM_NUM; i++) {
+		data->elems[i] = BLI_mempool_alloc(pool);
+	}
+	/* free every other element, then fill the holes again */
+	for (int i = 0; i < ELEM_NUM; i += 2) {
+		BLI_mempool_free(pool, data->elems[i]);
+	}
+	for (int i = 0; i < ELEM_NUM; i += 2) {
+		data->elems[i] = BLI_mempool_alloc(pool);
+	}
+
+	BLI_mempool_destroy(pool);
+}
+
+static void mempool_iter_bench(void *userdata)
+{
+	BLI_mempool *pool = (BLI_mempool *)userdata;
+	BLI_mempool_iter iter;
+	int *elem;
+	int tot = 0;
+
+	BLI_mempool_iternew(pool, &iter);
+	while ((elem = (int *)BLI_mempool_iterstep(&iter))) {
+		tot += *elem;
+	}
+
+	EXPECT_EQ(ELEM_NUM, tot);
+}
+
+static void guardedalloc_alloc_free_bench(void *userdata)
+{
+	MempoolBenchData *data = (MempoolBenchData *)userdata;
+
+	for (int i = 0; i < ELEM_NUM; i++) {
+		data->elems[i] = MEM_mallocN(ELEM_SIZE, __func__);
+	}
+	for (int i = 0; i < ELEM_NUM; i++) {
+		MEM_freeN(data->elems[i]);
+	}
+}
+
+TEST(mempool, AllocFree)
+{
+	MempoolBenchData data;
+	data.elems = (void **)MEM_mallocN(sizeof(void *) * ELEM_NUM, __func__);
+
+	data.chunk_size = 512;
+	testing_benchmark_run("chunk_512", mempool_alloc_free_bench, &data, BENCHMARK_RUNS_DEFAULT);
+	data.chunk_size = 4096;
+	testing_benchmark_run("chunk_4096", mempool_alloc_free_bench, &data, BENCHMARK_RUNS_DEFAULT);
+
+	/* reference, to compare against the general purpose allocator */
+	testing_benchmark_run("guardedalloc", guardedalloc_alloc_free_bench, &data, BENCHMARK_RUNS_DEFAULT);
+
+	MEM_freeN(data.elems);
+}
+
+TEST(mempool, Iter)
+{
+	BLI_mempool *pool = BLI_mempool_create(ELEM_SIZE, 0, 512, BLI_MEMPOOL_ALLOW_ITER);
+
+	for (int i = 0; i < ELEM_NUM; i++) {
+		int *elem = (int *)BLI_mempool_alloc(pool);
+		*elem = 1;
+	}
+
+	testing_benchmark_run("", mempool_iter_bench, pool, BENCHMARK_RUNS_DEFAULT);
+
+	BLI_mempool_destroy(pool);
+}
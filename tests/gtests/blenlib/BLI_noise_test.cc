@@ -0,0 +1,67 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_noise.h"
+}
+
+#define POINTS_NUM 37
+
+static const int noise_bases[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 14};
+
+static void noise_test_points(float co[POINTS_NUM][3])
+{
+	for (int i = 0; i < POINTS_NUM; i++) {
+		co[i][0] = -7.3f + 0.731f * (float)i;
+		co[i][1] = 2.1f - 0.417f * (float)i;
+		co[i][2] = 0.25f * (float)(i % 5) - 1000.3f;
+	}
+}
+
+TEST(noise, NoiseArrayMatchesScalar)
+{
+	float co[POINTS_NUM][3];
+	float values[POINTS_NUM];
+
+	noise_test_points(co);
+
+	for (int b = 0; b < ARRAY_SIZE(noise_bases); b++) {
+		for (int hard = 0; hard < 2; hard++) {
+			BLI_gNoise_array(0.7f, co, POINTS_NUM, hard, noise_bases[b], values);
+			for (int i = 0; i < POINTS_NUM; i++) {
+				EXPECT_FLOAT_EQ(BLI_gNoise(0.7f, co[i][0], co[i][1], co[i][2], hard, noise_bases[b]), values[i]);
+			}
+		}
+	}
+}
+
+TEST(noise, TurbulenceArrayMatchesScalar)
+{
+	float co[POINTS_NUM][3];
+	float values[POINTS_NUM];
+
+	noise_test_points(co);
+
+	for (int b = 0; b < ARRAY_SIZE(noise_bases); b++) {
+		for (int hard = 0; hard < 2; hard++) {
+			/* zero noise size means no scaling */
+			BLI_gTurbulence_array(0.0f, co, POINTS_NUM, 3, hard, noise_bases[b], values);
+			for (int i = 0; i < POINTS_NUM; i++) {
+				EXPECT_FLOAT_EQ(BLI_gTurbulence(0.0f, co[i][0], co[i][1], co[i][2], 3, hard, noise_bases[b]), values[i]);
+			}
+		}
+	}
+}
+
+TEST(noise, TurbulenceArrayPartial)
+{
+	const float co[3][3] = {{0.1f, 0.2f, 0.3f}, {0.2f, 0.3f, 0.1f}, {0.3f, 0.1f, 0.2f}};
+	float values[3];
+
+	BLI_gTurbulence_array(0.5f, co, 3, 2, 0, 2, values);
+	for (int i = 0; i < 3; i++) {
+		EXPECT_FLOAT_EQ(BLI_gTurbulence(0.5f, co[i][0], co[i][1], co[i][2], 2, 0, 2), values[i]);
+	}
+}
@@ -0,0 +1,195 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_ohash.h"
+#include "BLI_rand.h"
+}
+
+#define TESTCASE_SIZE 10000
+
+/* Unique random keys, zero is a valid key too. */
+static void init_keys(unsigned int keys[TESTCASE_SIZE], const int seed)
+{
+	RNG *rng = BLI_rng_new(seed);
+	OHash *ohash = BLI_ohash_new(__func__);
+	int i;
+
+	keys[0] = 0;
+	BLI_ohash_insert(ohash, SET_UINT_IN_POINTER(0), NULL);
+
+	for (i = 1; i < TESTCASE_SIZE; ) {
+		const unsigned int t = BLI_rng_get_uint(rng);
+		if (!BLI_ohash_haskey(ohash, SET_UINT_IN_POINTER(t))) {
+			BLI_ohash_insert(ohash, SET_UINT_IN_POINTER(t), NULL);
+			keys[i++] = t;
+		}
+	}
+
+	BLI_ohash_free(ohash, NULL);
+	BLI_rng_free(rng);
+}
+
+/* Here we simply insert and then lookup all keys, ensuring we do get back the expected stored 'data'. */
+TEST(ohash, InsertLookup)
+{
+	OHash *ohash = BLI_ohash_new(__func__);
+	unsigned int keys[TESTCASE_SIZE], *k;
+	int i;
+
+	init_keys(keys, 0);
+
+	for (i = TESTCASE_SIZE, k = keys; i--; k++) {
+		BLI_ohash_insert(ohash, SET_UINT_IN_POINTER(*k), SET_UINT_IN_POINTER(*k + 1));
+	}
+
+	EXPECT_EQ(TESTCASE_SIZE, BLI_ohash_size(ohash));
+
+	for (i = TESTCASE_SIZE, k = keys; i--; k++) {
+		void *v = BLI_ohash_lookup(ohash, SET_UINT_IN_POINTER(*k));
+		EXPECT_EQ(*k + 1, GET_UINT_FROM_POINTER(v));
+	}
+
+	BLI_ohash_free(ohash, NULL);
+}
+
+/* Remove every other key, the others must still be found, and the removed ones not. */
+TEST(ohash, InsertRemove)
+{
+	OHash *ohash = BLI_ohash_new(__func__);
+	unsigned int keys[TESTCASE_SIZE];
+	int i;
+
+	init_keys(keys, 10);
+
+	for (i = 0; i < TESTCASE_SIZE; i++) {
+		BLI_ohash_insert(ohash, SET_UINT_IN_POINTER(keys[i]), SET_UINT_IN_POINTER(keys[i]));
+	}
+
+	for (i = 0; i < TESTCASE_SIZE; i += 2) {
+		void *v = BLI_ohash_popkey(ohash, SET_UINT_IN_POINTER(keys[i]));
+		EXPECT_EQ(keys[i], GET_UINT_FROM_POINTER(v));
+	}
+
+	EXPECT_EQ(TESTCASE_SIZE / 2, BLI_ohash_size(ohash));
+
+	for (i = 0; i < TESTCASE_SIZE; i++) {
+		void **v_p = BLI_ohash_lookup_p(ohash, SET_UINT_IN_POINTER(keys[i]));
+		if (i % 2) {
+			EXPECT_TRUE(v_p != NULL);
+			EXPECT_EQ(keys[i], GET_UINT_FROM_POINTER(*v_p));
+		}
+		else {
+			EXPECT_TRUE(v_p == NULL);
+		}
+	}
+
+	for (i = 1; i < TESTCASE_SIZE; i += 2) {
+		EXPECT_TRUE(BLI_ohash_remove(ohash, SET_UINT_IN_POINTER(keys[i]), NULL));
+		EXPECT_FALSE(BLI_ohash_remove(ohash, SET_UINT_IN_POINTER(keys[i]), NULL));
+	}
+
+	EXPECT_EQ(0, BLI_ohash_size(ohash));
+
+	BLI_ohash_free(ohash, NULL);
+}
+
+/* Ensure and reinsert only add missing keys. */
+TEST(ohash, EnsureReinsert)
+{
+	OHash *ohash = BLI_ohash_new(__func__);
+	unsigned int keys[TESTCASE_SIZE];
+	int i;
+
+	init_keys(keys, 20);
+
+	for (i = 0; i < TESTCASE_SIZE; i++) {
+		void **v_p;
+		EXPECT_FALSE(BLI_ohash_ensure_p(ohash, SET_UINT_IN_POINTER(keys[i]), &v_p));
+		*v_p = SET_UINT_IN_POINTER(i);
+	}
+
+	for (i = 0; i < TESTCASE_SIZE; i++) {
+		void **v_p;
+		EXPECT_TRUE(BLI_ohash_ensure_p(ohash, SET_UINT_IN_POINTER(keys[i]), &v_p));
+		EXPECT_EQ(i, GET_INT_FROM_POINTER(*v_p));
+		EXPECT_FALSE(BLI_ohash_reinsert(ohash, SET_UINT_IN_POINTER(keys[i]), SET_UINT_IN_POINTER(i + 1), NULL));
+	}
+
+	EXPECT_EQ(TESTCASE_SIZE, BLI_ohash_size(ohash));
+
+	for (i = 0; i < TESTCASE_SIZE; i++) {
+		void *v = BLI_ohash_lookup_default(ohash, SET_UINT_IN_POINTER(keys[i]), NULL);
+		EXPECT_EQ(i + 1, GET_INT_FROM_POINTER(v));
+	}
+
+	BLI_ohash_clear(ohash, NULL);
+	EXPECT_EQ(0, BLI_ohash_size(ohash));
+	EXPECT_TRUE(BLI_ohash_reinsert(ohash, SET_UINT_IN_POINTER(keys[0]), NULL, NULL));
+
+	BLI_ohash_free(ohash, NULL);
+}
+
+/* Iterating visits every key once. */
+TEST(ohash, Iterator)
+{
+	OHash *ohash = BLI_ohash_new_ex(__func__, TESTCASE_SIZE);
+	OHashIterator ohi;
+	unsigned int keys[TESTCASE_SIZE];
+	int i;
+
+	init_keys(keys, 30);
+
+	for (i = 0; i < TESTCASE_SIZE; i++) {
+		BLI_ohash_insert(ohash, SET_UINT_IN_POINTER(keys[i]), SET_INT_IN_POINTER(i));
+	}
+
+	i = 0;
+	OHASH_ITER (ohi, ohash) {
+		const int index = GET_INT_FROM_POINTER(BLI_ohashIterator_getValue(&ohi));
+		EXPECT_EQ(keys[index], GET_UINT_FROM_POINTER(BLI_ohashIterator_getKey(&ohi)));
+		*BLI_ohashIterator_getValue_p(&ohi) = SET_INT_IN_POINTER(-1);
+		i++;
+	}
+
+	EXPECT_EQ(TESTCASE_SIZE, i);
+
+	for (i = 0; i < TESTCASE_SIZE; i++) {
+		EXPECT_EQ(-1, GET_INT_FROM_POINTER(BLI_ohash_lookup(ohash, SET_UINT_IN_POINTER(keys[i]))));
+	}
+
+	BLI_ohash_free(ohash, NULL);
+}
+
+/* Pointer keys, to the items of an array. */
+TEST(ohash, PtrKeys)
+{
+	OHash *ohash = BLI_ohash_new(__func__);
+	unsigned int items[TESTCASE_SIZE];
+	int i;
+
+	for (i = 0; i < TESTCASE_SIZE; i++) {
+		BLI_ohash_insert(ohash, &items[i], SET_INT_IN_POINTER(i));
+	}
+
+	EXPECT_EQ(TESTCASE_SIZE, BLI_ohash_size(ohash));
+
+	for (i = 0; i < TESTCASE_SIZE; i += 3) {
+		EXPECT_TRUE(BLI_ohash_remove(ohash, &items[i], NULL));
+	}
+
+	for (i = 0; i < TESTCASE_SIZE; i++) {
+		void **v_p = BLI_ohash_lookup_p(ohash, &items[i]);
+		if (i % 3) {
+			EXPECT_TRUE(v_p != NULL);
+			EXPECT_EQ(i, GET_INT_FROM_POINTER(*v_p));
+		}
+		else {
+			EXPECT_TRUE(v_p == NULL);
+		}
+	}
+
+	BLI_ohash_free(ohash, NULL);
+}
@@ -0,0 +1,193 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+#include "testing/testing_benchmark.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_edgehash.h"
+#include "BLI_heap.h"
+#include "BLI_math.h"
+#include "BLI_memarena.h"
+#include "BLI_polyfill2d.h"
+#include "BLI_polyfill2d_beautify.h"
+}
+
+typedef struct PolyfillBenchData {
+	float (*coords)[2];
+	unsigned int coords_tot;
+	unsigned int (*tris)[3];
+	MemArena *arena;
+	Heap *heap;
+	EdgeHash *ehash;
+	bool use_beautify;
+} PolyfillBenchData;
+
+/**
+ * Fill \a coords with a circle, when \a zigzag is set every other point is pulled inwards,
+ * giving a concave star where most ears are rejected.
+ */
+static void polyfill_bench_coords(float (*coords)[2], const unsigned int coords_tot, const bool zigzag)
+{
+	for (unsigned int i = 0; i < coords_tot; i++) {
+		const float angle = ((float)i / (float)coords_tot) * (float)(M_PI * 2.0);
+		const float radius = (zigzag && (i & 1)) ? 0.5f : 1.0f;
+		coords[i][0] = cosf(angle) * radius;
+		coords[i][1] = sinf(angle) * radius;
+	}
+}
+
+/**
+ * Fill \a coords with a comb, teeth pointing down along the bottom and up along the top
+ * (\a coords_tot must be a multiple of 8), similar to n-gons from CAD or knife-project.
+ */
+static void polyfill_bench_coords_comb(float (*coords)[2], const unsigned int coords_tot)
+{
+	const unsigned int teeth = coords_tot / 8;
+	unsigned int i = 0;
+	for (unsigned int t = 0; t < teeth; t++) {
+		const float x = (float)(t * 2);
+		ARRAY_SET_ITEMS(coords[i], x, 0.0f); i++;
+		ARRAY_SET_ITEMS(coords[i], x, -1.0f); i++;
+		ARRAY_SET_ITEMS(coords[i], x + 1.0f, -1.0f); i++;
+		ARRAY_SET_ITEMS(coords[i], x + 1.0f, 0.0f); i++;
+	}
+	for (unsigned int t = teeth; t--; ) {
+		const float x = (float)(t * 2);
+		ARRAY_SET_ITEMS(coords[i], x + 2.0f, 1.0f); i++;
+		ARRAY_SET_ITEMS(coords[i], x + 2.0f, 2.0f); i++;
+		ARRAY_SET_ITEMS(coords[i], x + 1.0f, 2.0f); i++;
+		ARRAY_SET_ITEMS(coords[i], x + 1.0f, 1.0f); i++;
+	}
+}
+
+static void polyfill_bench(void *userdata)
+{
+	PolyfillBenchData *data = (PolyfillBenchData *)userdata;
+
+	BLI_polyfill_calc_arena(
+	        (const float (*)[2])data->coords, data->coords_tot, 0, data->tris,
+	        data->arena);
+
+	if (data->use_beautify) {
+		BLI_polyfill_beautify(
+		        (const float (*)[2])data->coords, data->coords_tot, data->tris,
+		        data->arena, data->heap, data->ehash);
+	}
+
+	BLI_memarena_clear(data->arena);
+}
+
+/**
+ * Fill \a coords with a thick spiral, outwards then back inwards,
+ * ears are only found at its ends which is the worst case for ear clipping.
+ */
+static void polyfill_bench_coords_spiral(float (*coords)[2], const unsigned int coords_tot)
+{
+	const unsigned int side_tot = coords_tot / 2;
+	const float turns = 50.0f;
+	for (unsigned int i = 0; i < side_tot; i++) {
+		const float angle = ((float)i / (float)side_tot) * turns * (float)(M_PI * 2.0);
+		const float radius = 1.0f + angle / (float)(M_PI * 2.0);
+		coords[i][0] = cosf(angle) * radius;
+		coords[i][1] = sinf(angle) * radius;
+		coords[coords_tot - 1 - i][0] = cosf(angle) * (radius - 0.5f);
+		coords[coords_tot - 1 - i][1] = sinf(angle) * (radius - 0.5f);
+	}
+}
+
+enum {
+	BENCH_CIRCLE,
+	BENCH_STAR,
+	BENCH_COMB,
+	BENCH_SPIRAL,
+};
+
+static void polyfill_bench_template(const unsigned int coords_tot, const int shape)
+{
+	PolyfillBenchData data = {NULL};
+
+	data.coords_tot = coords_tot;
+	data.coords = (float (*)[2])MEM_mallocN(sizeof(*data.coords) * coords_tot, __func__);
+	data.tris = (unsigned int (*)[3])MEM_mallocN(sizeof(*data.tris) * (coords_tot - 2), __func__);
+	data.arena = BLI_memarena_new(BLI_POLYFILL_ARENA_SIZE, __func__);
+	data.heap = BLI_heap_new_ex(BLI_POLYFILL_ALLOC_NGON_RESERVE);
+	data.ehash = BLI_edgehash_new_ex(__func__, BLI_POLYFILL_ALLOC_NGON_RESERVE);
+
+	if (shape == BENCH_COMB) {
+		polyfill_bench_coords_comb(data.coords, coords_tot);
+	}
+	else if (shape == BENCH_SPIRAL) {
+		polyfill_bench_coords_spiral(data.coords, coords_tot);
+	}
+	else {
+		polyfill_bench_coords(data.coords, coords_tot, shape == BENCH_STAR);
+	}
+
+	data.use_beautify = false;
+	testing_benchmark_run("fill", polyfill_bench, &data, BENCHMARK_RUNS_DEFAULT);
+	data.use_beautify = true;
+	testing_benchmark_run("fill_beautify", polyfill_bench, &data, BENCHMARK_RUNS_DEFAULT);
+
+	BLI_edgehash_free(data.ehash, NULL);
+	BLI_heap_free(data.heap, NULL);
+	BLI_memarena_free(data.arena);
+	MEM_freeN(data.tris);
+	MEM_freeN(data.coords);
+}
+
+TEST(polyfill2d, Circle_1k)
+{
+	polyfill_bench_template(1000, BENCH_CIRCLE);
+}
+
+TEST(polyfill2d, Circle_10k)
+{
+	polyfill_bench_template(10000, BENCH_CIRCLE);
+}
+
+TEST(polyfill2d, Star_1k)
+{
+	polyfill_bench_template(1000, BENCH_STAR);
+}
+
+TEST(polyfill2d, Star_10k)
+{
+	polyfill_bench_template(10000, BENCH_STAR);
+}
+
+TEST(polyfill2d, Star_50k)
+{
+	polyfill_bench_template(50000, BENCH_STAR);
+}
+
+TEST(polyfill2d, Comb_1k)
+{
+	polyfill_bench_template(1000, BENCH_COMB);
+}
+
+TEST(polyfill2d, Comb_10k)
+{
+	polyfill_bench_template(10000, BENCH_COMB);
+}
+
+TEST(polyfill2d, Comb_50k)
+{
+	polyfill_bench_template(50000, BENCH_COMB);
+}
+
+TEST(polyfill2d, Spiral_1k)
+{
+	polyfill_bench_template(1000, BENCH_SPIRAL);
+}
+
+TEST(polyfill2d, Spiral_10k)
+{
+	polyfill_bench_template(10000, BENCH_SPIRAL);
+}
+
+TEST(polyfill2d, Spiral_50k)
+{
+	polyfill_bench_template(50000, BENCH_SPIRAL);
+}
@@ -147,11 +147,12 @@ static void test_polyfill_area(
 {
 	unsigned int i;
 	const float area_tot = area_poly_v2(poly, poly_tot);
-	float       area_tot_tris = 0.0f;
+	/* double, so precision holds for large polygons with many small triangles */
+	double      area_tot_tris = 0.0;
 	const float eps_abs = 0.00001f;
 	const float eps = area_tot > 1.0f ? (area_tot * eps_abs) : eps_abs;
 	for (i = 0; i < tris_tot; i++) {
-		area_tot_tris += area_tri_v2(poly[tris[i][0]], poly[tris[i][1]], poly[tris[i][2]]);
+		area_tot_tris += (double)area_tri_v2(poly[tris[i][0]], poly[tris[i][1]], poly[tris[i][2]]);
 	}
 	EXPECT_NEAR(area_tot, area_tot_tris, eps);
 }
@@ -517,3 +518,143 @@ TEST(polyfill2d, IssueT41986_axis_align)
 
 	TEST_POLYFILL_TEMPLATE_STATIC(poly, false);
 }
+
+
+/* -------------------------------------------------------------------- */
+/* large polygons (concave polygons with over 4096 vertices are filled using a sweep-line) */
+
+static void test_polyfill_template_large(
+        const char *id, bool is_degenerate,
+        float (*poly)[2], const unsigned int poly_tot)
+{
+	const unsigned int tris_tot = POLY_TRI_COUNT(poly_tot);
+	unsigned int (*tris)[3] = (unsigned int (*)[3])MEM_mallocN(sizeof(*tris) * tris_tot, id);
+
+	test_polyfill_template(id, is_degenerate, poly, poly_tot, tris, tris_tot);
+	BLI_array_reverse(poly, poly_tot);
+	test_polyfill_template(id, is_degenerate, poly, poly_tot, tris, tris_tot);
+
+	MEM_freeN(tris);
+}
+
+static float (*test_poly_alloc(const unsigned int poly_tot))[2]
+{
+	return (float (*)[2])MEM_mallocN(sizeof(float[2]) * poly_tot, __func__);
+}
+
+/* a circle with every other point pulled inwards */
+TEST(polyfill2d, LargeStar)
+{
+	const unsigned int poly_tot = 5000;
+	float (*poly)[2] = test_poly_alloc(poly_tot);
+	for (unsigned int i = 0; i < poly_tot; i++) {
+		const float angle = ((float)i / (float)poly_tot) * (float)(M_PI * 2.0);
+		const float radius = (i & 1) ? 0.9f : 1.0f;
+		poly[i][0] = cosf(angle) * radius;
+		poly[i][1] = sinf(angle) * radius;
+	}
+	test_polyfill_template_large(typeid(*this).name(), false, poly, poly_tot);
+	MEM_freeN(poly);
+}
+
+/* a star shaped polygon with uneven radius (many split & merge vertices) */
+TEST(polyfill2d, LargeStarUneven)
+{
+	const unsigned int poly_tot = 5000;
+	float (*poly)[2] = test_poly_alloc(poly_tot);
+	for (unsigned int i = 0; i < poly_tot; i++) {
+		const float angle = ((float)i / (float)poly_tot) * (float)(M_PI * 2.0);
+		const float radius = 0.2f + (float)((i * 7919) % 101) / 100.0f;
+		poly[i][0] = cosf(angle) * radius;
+		poly[i][1] = sinf(angle) * radius;
+	}
+	test_polyfill_template_large(typeid(*this).name(), false, poly, poly_tot);
+	MEM_freeN(poly);
+}
+
+/* axis aligned teeth above and below, lots of horizontal edges */
+TEST(polyfill2d, LargeComb)
+{
+	const unsigned int teeth = 640;
+	const unsigned int poly_tot = teeth * 8;
+	float (*poly)[2] = test_poly_alloc(poly_tot);
+	unsigned int i = 0;
+	for (unsigned int t = 0; t < teeth; t++) {
+		const float x = (float)(t * 2);
+		ARRAY_SET_ITEMS(poly[i], x, 0.0f); i++;
+		ARRAY_SET_ITEMS(poly[i], x, -1.0f); i++;
+		ARRAY_SET_ITEMS(poly[i], x + 1.0f, -1.0f); i++;
+		ARRAY_SET_ITEMS(poly[i], x + 1.0f, 0.0f); i++;
+	}
+	for (unsigned int t = teeth; t--; ) {
+		const float x = (float)(t * 2);
+		ARRAY_SET_ITEMS(poly[i], x + 2.0f, 1.0f); i++;
+		ARRAY_SET_ITEMS(poly[i], x + 2.0f, 2.0f); i++;
+		ARRAY_SET_ITEMS(poly[i], x + 1.0f, 2.0f); i++;
+		ARRAY_SET_ITEMS(poly[i], x + 1.0f, 1.0f); i++;
+	}
+	test_polyfill_template_large(typeid(*this).name(), false, poly, poly_tot);
+	MEM_freeN(poly);
+}
+
+/* a thick spiral, outwards then back inwards */
+TEST(polyfill2d, LargeSpiral)
+{
+	const unsigned int side_tot = 2500;
+	const unsigned int poly_tot = side_tot * 2;
+	const float turns = 10.0f;
+	float (*poly)[2] = test_poly_alloc(poly_tot);
+	for (unsigned int i = 0; i < side_tot; i++) {
+		const float angle = ((float)i / (float)side_tot) * turns * (float)(M_PI * 2.0);
+		const float radius = 1.0f + angle / (float)(M_PI * 2.0);
+		poly[i][0] = cosf(angle) * radius;
+		poly[i][1] = sinf(angle) * radius;
+		poly[poly_tot - 1 - i][0] = cosf(angle) * (radius - 0.5f);
+		poly[poly_tot - 1 - i][1] = sinf(angle) * (radius - 0.5f);
+	}
+	test_polyfill_template_large(typeid(*this).name(), false, poly, poly_tot);
+	MEM_freeN(poly);
+}
+
+/* a square with a notch, its sides split into many co-linear points */
+TEST(polyfill2d, LargeColinear)
+{
+	const unsigned int side_tot = 1100;
+	const unsigned int poly_tot = side_tot * 4 + 1;
+	float (*poly)[2] = test_poly_alloc(poly_tot);
+	unsigned int i = 0;
+	for (unsigned int j = 0; j < side_tot; j++) {
+		const float f = (float)j / (float)side_tot;
+		ARRAY_SET_ITEMS(poly[i], f, 0.0f); i++;
+	}
+	for (unsigned int j = 0; j < side_tot; j++) {
+		const float f = (float)j / (float)side_tot;
+		ARRAY_SET_ITEMS(poly[i], 1.0f, f); i++;
+	}
+	for (unsigned int j = 0; j < side_tot; j++) {
+		const float f = (float)j / (float)side_tot;
+		ARRAY_SET_ITEMS(poly[i], 1.0f - f, 1.0f); i++;
+	}
+	ARRAY_SET_ITEMS(poly[i], 0.0f, 1.0f); i++;
+	ARRAY_SET_ITEMS(poly[i], 0.5f, 0.5f); i++;
+	for (unsigned int j = 1; j < side_tot; j++) {
+		const float f = (float)j / (float)side_tot;
+		ARRAY_SET_ITEMS(poly[i], 0.0f, 0.5f - (f * 0.5f)); i++;
+	}
+	EXPECT_EQ(poly_tot, i);
+	test_polyfill_template_large(typeid(*this).name(), false, poly, poly_tot);
+	MEM_freeN(poly);
+}
+
+/* scattered points, self intersecting so it can't be filled properly (falls back to ear clipping) */
+TEST(polyfill2d, LargeSelfIntersect)
+{
+	const unsigned int poly_tot = 5000;
+	float (*poly)[2] = test_poly_alloc(poly_tot);
+	for (unsigned int i = 0; i < poly_tot; i++) {
+		poly[i][0] = (float)((i * 7919) % 1000) / 1000.0f;
+		poly[i][1] = (float)((i * 104729) % 997) / 997.0f;
+	}
+	test_polyfill_template_large(typeid(*this).name(), true, poly, poly_tot);
+	MEM_freeN(poly);
+}
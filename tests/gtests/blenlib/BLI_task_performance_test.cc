@@ -0,0 +1,124 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+#include "testing/testing_benchmark.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_mempool.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+}
+
+/* Measures scheduling overhead, so the tasks themselves do (almost) nothing. */
+#define TASKS_NUM 100000
+#define RANGE_NUM 1000000
+#define MEMPOOL_NUM 1000000
+
+typedef struct TaskBenchData {
+	TaskScheduler *scheduler;
+	int *values;
+	BLI_mempool *mempool;
+	bool use_threading;
+} TaskBenchData;
+
+static void task_pool_run_cb(TaskPool *__restrict pool, void *taskdata, int UNUSED(threadid))
+{
+	int *values = (int *)BLI_task_pool_userdata(pool);
+	const int i = GET_INT_FROM_POINTER(taskdata);
+	values[i] = i;
+}
+
+static void task_pool_bench(void *userdata)
+{
+	TaskBenchData *data = (TaskBenchData *)userdata;
+	TaskPool *pool = BLI_task_pool_create(data->scheduler, data->values);
+
+	for (int i = 0; i < TASKS_NUM; i++) {
+		BLI_task_pool_push(pool, task_pool_run_cb, SET_INT_IN_POINTER(i), false, TASK_PRIORITY_HIGH);
+	}
+	BLI_task_pool_work_and_wait(pool);
+	BLI_task_pool_free(pool);
+}
+
+static void task_range_cb(void *userdata, void *UNUSED(userdata_chunk), int iter)
+{
+	int *values = (int *)userdata;
+	values[iter] = iter;
+}
+
+static void task_range_bench(void *userdata)
+{
+	TaskBenchData *data = (TaskBenchData *)userdata;
+	BLI_task_parallel_range_ex(0, RANGE_NUM, data->values, NULL, 0, task_range_cb, data->use_threading, false);
+}
+
+static void task_mempool_cb(void *UNUSED(userdata), void *item)
+{
+	int *value = (int *)item;
+	*value += 1;
+}
+
+static void task_mempool_bench(void *userdata)
+{
+	TaskBenchData *data = (TaskBenchData *)userdata;
+	BLI_task_parallel_mempool(data->mempool, NULL, task_mempool_cb, data->use_threading);
+}
+
+TEST(task, PoolPushOverhead)
+{
+	TaskBenchData data = {NULL};
+
+	BLI_threadapi_init();
+
+	data.scheduler = BLI_task_scheduler_create(TASK_SCHEDULER_AUTO_THREADS);
+	data.values = (int *)MEM_mallocN(sizeof(int) * TASKS_NUM, __func__);
+
+	testing_benchmark_run("", task_pool_bench, &data, BENCHMARK_RUNS_DEFAULT);
+
+	EXPECT_EQ(TASKS_NUM - 1, data.values[TASKS_NUM - 1]);
+
+	MEM_freeN(data.values);
+	BLI_task_scheduler_free(data.scheduler);
+}
+
+TEST(task, ParallelRange)
+{
+	TaskBenchData data = {NULL};
+
+	BLI_threadapi_init();
+
+	data.values = (int *)MEM_mallocN(sizeof(int) * RANGE_NUM, __func__);
+
+	data.use_threading = false;
+	testing_benchmark_run("single", task_range_bench, &data, BENCHMARK_RUNS_DEFAULT);
+	data.use_threading = true;
+	testing_benchmark_run("threaded", task_range_bench, &data, BENCHMARK_RUNS_DEFAULT);
+
+	EXPECT_EQ(RANGE_NUM - 1, data.values[RANGE_NUM - 1]);
+
+	MEM_freeN(data.values);
+}
+
+TEST(task, ParallelMempool)
+{
+	TaskBenchData data = {NULL};
+
+	BLI_threadapi_init();
+
+	data.mempool = BLI_mempool_create(sizeof(int), 0, 4096, BLI_MEMPOOL_ALLOW_ITER);
+	for (int i = 0; i < MEMPOOL_NUM; i++) {
+		int *value = (int *)BLI_mempool_alloc(data.mempool);
+		*value = 0;
+	}
+
+	data.use_threading = false;
+	testing_benchmark_run("single", task_mempool_bench, &data, BENCHMARK_RUNS_DEFAULT);
+	data.use_threading = true;
+	testing_benchmark_run("threaded", task_mempool_bench, &data, BENCHMARK_RUNS_DEFAULT);
+
+	EXPECT_EQ(MEMPOOL_NUM, BLI_mempool_count(data.mempool));
+
+	BLI_mempool_destroy(data.mempool);
+}
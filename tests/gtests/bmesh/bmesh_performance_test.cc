@@ -0,0 +1,144 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+#include "testing/testing_benchmark.h"
+
+extern "C" {
+#include "MEM_guardedalloc.h"
+#include "BLI_utildefines.h"
+#include "BLI_math.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+
+#include "BKE_cdderivedmesh.h"
+#include "BKE_DerivedMesh.h"
+#include "BKE_mesh.h"
+#include "BKE_subsurf.h"
+}
+
+#include "bmesh.h"
+
+/* quad grid, 250k faces */
+#define GRID_RES 500
+
+typedef struct BMeshBenchData {
+	BMesh *bm;
+	Mesh *me;
+	SubsurfModifierData *smd;
+} BMeshBenchData;
+
+static BMesh *bmesh_bench_grid(const int res)
+{
+	BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default);
+	BMVert **verts = (BMVert **)MEM_mallocN(sizeof(*verts) * res * res, __func__);
+
+	BM_data_layer_add(bm, &bm->ldata, CD_MLOOPUV);
+
+	for (int y = 0; y < res; y++) {
+		for (int x = 0; x < res; x++) {
+			const float co[3] = {(float)x, (float)y, sinf((float)(x + y) * 0.1f)};
+			verts[y * res + x] = BM_vert_create(bm, co, NULL, BM_CREATE_NOP);
+		}
+	}
+
+	for (int y = 0; y < res - 1; y++) {
+		for (int x = 0; x < res - 1; x++) {
+			BMVert *quad[4] = {
+			    verts[y * res + x],
+			    verts[y * res + x + 1],
+			    verts[(y + 1) * res + x + 1],
+			    verts[(y + 1) * res + x],
+			};
+			BM_face_create_verts(bm, quad, 4, NULL, BM_CREATE_NOP, true);
+		}
+	}
+
+	MEM_freeN(verts);
+	return bm;
+}
+
+static void bmesh_normals_bench(void *userdata)
+{
+	BMeshBenchData *data = (BMeshBenchData *)userdata;
+	BM_mesh_normals_update(data->bm);
+}
+
+static void bmesh_to_mesh_bench(void *userdata)
+{
+	BMeshBenchData *data = (BMeshBenchData *)userdata;
+	BM_mesh_bm_to_me(data->bm, data->me, false);
+}
+
+static void bmesh_from_mesh_bench(void *userdata)
+{
+	BMeshBenchData *data = (BMeshBenchData *)userdata;
+	BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default);
+	BM_mesh_bm_from_me(bm, data->me, true, false, 0);
+	BM_mesh_free(bm);
+}
+
+static void subsurf_bench(void *userdata)
+{
+	BMeshBenchData *data = (BMeshBenchData *)userdata;
+	DerivedMesh *dm = CDDM_from_mesh(data->me);
+	DerivedMesh *result = subsurf_make_derived_from_derived(dm, data->smd, NULL, SUBSURF_USE_RENDER_PARAMS);
+
+	/* force the grids to be evaluated as a regular mesh, as the modifier stack would */
+	DerivedMesh *result_cd = CDDM_copy(result);
+
+	result_cd->release(result_cd);
+	result->release(result);
+	dm->release(dm);
+}
+
+TEST(bmesh_performance, Normals)
+{
+	BMeshBenchData data = {NULL};
+	data.bm = bmesh_bench_grid(GRID_RES);
+
+	testing_benchmark_run("", bmesh_normals_bench, &data, BENCHMARK_RUNS_DEFAULT);
+
+	BM_mesh_free(data.bm);
+}
+
+TEST(bmesh_performance, MeshConversion)
+{
+	BMeshBenchData data = {NULL};
+	Mesh me = {{NULL}};
+
+	data.bm = bmesh_bench_grid(GRID_RES);
+	data.me = &me;
+
+	testing_benchmark_run("bm_to_me", bmesh_to_mesh_bench, &data, BENCHMARK_RUNS_DEFAULT);
+	testing_benchmark_run("bm_from_me", bmesh_from_mesh_bench, &data, BENCHMARK_RUNS_DEFAULT);
+
+	EXPECT_EQ(GRID_RES * GRID_RES, me.totvert);
+	EXPECT_EQ((GRID_RES - 1) * (GRID_RES - 1), me.totpoly);
+
+	BM_mesh_free(data.bm);
+	BKE_mesh_free(&me, false);
+}
+
+TEST(subsurf_performance, CCG)
+{
+	BMeshBenchData data = {NULL};
+	Mesh me = {{NULL}};
+	SubsurfModifierData smd = {{NULL}};
+
+	/* a quarter of the grid, two levels gives the same face count as the other benchmarks */
+	data.bm = bmesh_bench_grid(GRID_RES / 4);
+	data.me = &me;
+	BM_mesh_bm_to_me(data.bm, data.me, false);
+
+	smd.subdivType = ME_CC_SUBSURF;
+	smd.renderLevels = 2;
+	smd.flags = eSubsurfModifierFlag_SubsurfUv;
+	data.smd = &smd;
+
+	testing_benchmark_run("", subsurf_bench, &data, BENCHMARK_RUNS_DEFAULT);
+
+	BM_mesh_free(data.bm);
+	BKE_mesh_free(&me, false);
+}
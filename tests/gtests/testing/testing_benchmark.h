@@ -0,0 +1,70 @@
+/* Apache License, Version 2.0 */
+
+#ifndef __BLENDER_TESTING_BENCHMARK_H__
+#define __BLENDER_TESTING_BENCHMARK_H__
+
+/** \file testing_benchmark.h
+ *
+ * Minimal timing harness for the *_performance_test targets.
+ *
+ * Each benchmark runs once to warm up, then a fixed number of timed runs.
+ * Results go to stdout as one tab separated line per benchmark:
+ *
+ *   BENCHMARK <test_case>.<test> runs=N min=<sec> median=<sec> max=<sec>
+ *
+ * and are also recorded as test properties (in microseconds),
+ * so `--gtest_output=xml:results.xml` gives results which can be compared between builds.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "PIL_time.h"
+}
+
+typedef void (*BenchmarkFunc)(void *userdata);
+
+static inline void testing_benchmark_run(const char *id, BenchmarkFunc func, void *userdata, int runs)
+{
+	std::vector<double> times;
+	times.reserve(runs);
+
+	/* warm up caches and allocators */
+	func(userdata);
+
+	for (int i = 0; i < runs; i++) {
+		const double start = PIL_check_seconds_timer();
+		func(userdata);
+		times.push_back(PIL_check_seconds_timer() - start);
+	}
+
+	std::sort(times.begin(), times.end());
+
+	const double t_min = times.front();
+	const double t_max = times.back();
+	const double t_median = times[runs / 2];
+
+	const ::testing::TestInfo *info = ::testing::UnitTest::GetInstance()->current_test_info();
+	std::string name = std::string(info->test_case_name()) + "." + info->name();
+	if (id && id[0]) {
+		name += std::string("/") + id;
+	}
+
+	printf("BENCHMARK\t%s\truns=%d\tmin=%.6f\tmedian=%.6f\tmax=%.6f\n",
+	       name.c_str(), runs, t_min, t_median, t_max);
+	fflush(stdout);
+
+	const std::string prefix = (id && id[0]) ? std::string(id) + "_" : std::string();
+	::testing::Test::RecordProperty(prefix + "min_us", (int)(t_min * 1e6));
+	::testing::Test::RecordProperty(prefix + "median_us", (int)(t_median * 1e6));
+	::testing::Test::RecordProperty(prefix + "max_us", (int)(t_max * 1e6));
+}
+
+#define BENCHMARK_RUNS_DEFAULT 10
+
+#endif  /* __BLENDER_TESTING_BENCHMARK_H__ */